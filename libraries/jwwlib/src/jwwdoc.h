@@ -918,6 +918,29 @@ public:
 	void AddItem(int No,string& str);
 };
 
+//ファイル全体を読み込んだストリームバッファ
+// Stream buffer over the whole file, read into memory at once, so the small
+// reads of the records are served from memory instead of the file.
+class	JWWFileBuffer : public streambuf
+{
+public:
+	JWWFileBuffer(const string& fName){
+		ifstream f(fName.c_str(), ios::binary | ios::ate);
+		streamoff size = f ? static_cast<streamoff>(f.tellg()) : 0;
+		if(size > 0){
+			data.resize(static_cast<size_t>(size));
+			f.seekg(0);
+			f.read(&data[0], size);
+			data.resize(static_cast<size_t>(f.gcount()));
+		}
+		char* p = data.empty() ? NULL : &data[0];
+		setg(p, p, p + data.size());
+	}
+
+private:
+	vector<char> data;
+};
+
 //JWWファイル入出力クラス
 class	JWWDocument
 {
@@ -927,8 +950,12 @@ private:
 public:
 	JWWDocument(string& iFName, string& oFName){
 		InputFName = iFName;
-		if(iFName.length()>0)
-			ifs = new ifstream(iFName.c_str(),ios::binary);
+		ifsBuf = NULL;
+		if(iFName.length()>0){
+			ifsBuf = new JWWFileBuffer(iFName);
+			ifs = new ifstream();
+			ifs->std::ios::rdbuf(ifsBuf);
+		}
 		else
 			ifs = NULL;
 		OutputFName = oFName;
@@ -942,10 +969,8 @@ public:
 	~JWWDocument(){
 		delete pList;
 		delete pBlockList;
-		if(ifs){
-			ifs->close();
-			delete ifs;
-		}
+		delete ifs;
+		delete ifsBuf;
 		if(ofs){
 			ofs->close();
 			delete ofs;
@@ -954,6 +979,7 @@ public:
 // 各図形のレコードの実体
 	JWWHead	Header;
 	ifstream*	ifs;
+	JWWFileBuffer*	ifsBuf;
 	ofstream*	ofs;
 	jwWORD objCode;
 	jwDWORD Mpoint;
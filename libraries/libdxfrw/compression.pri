@@ -0,0 +1,12 @@
+# compressed dxf files, .dxf.gz and .dxf.zst, with the codecs installed
+unix {
+    CONFIG += link_pkgconfig
+    packagesExist(zlib) {
+        DEFINES += DRW_HAVE_ZLIB
+        PKGCONFIG += zlib
+    }
+    packagesExist(libzstd) {
+        DEFINES += DRW_HAVE_ZSTD
+        PKGCONFIG += libzstd
+    }
+}
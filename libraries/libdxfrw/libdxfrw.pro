@@ -19,6 +19,7 @@ TARGET = $$DLL_NAME
 GENERATED_DIR = ../../generated/lib/libdxfrw
 # Use common project definitions.
 include(../../common.pri)
+include(./compression.pri)
 
 # svg support
 QT -= svg
@@ -39,6 +40,8 @@ SOURCES += \
     src/intern/dwgreader.cpp \
     src/intern/dwgbuffer.cpp \
     src/intern/drw_dbg.cpp \
+    src/intern/drw_mappedfile.cpp \
+    src/intern/drw_compressedfile.cpp \
     src/intern/dwgreader21.cpp \
     src/intern/dwgreader18.cpp \
     src/intern/dwgreader15.cpp \
@@ -67,6 +70,8 @@ HEADERS += \
     src/intern/drw_cptable936.h \
     src/intern/drw_cptable932.h \
     src/intern/drw_dbg.h \
+    src/intern/drw_mappedfile.h \
+    src/intern/drw_compressedfile.h \
     src/intern/dwgreader21.h \
     src/intern/dwgreader18.h \
     src/intern/dwgreader15.h \
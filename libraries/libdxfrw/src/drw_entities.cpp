@@ -970,6 +970,9 @@ bool DRW_Block::parseCode(int code, dxfReader *reader){
     case 70:
         flags = reader->getInt32();
         break;
+    case 1:
+        xrefPath = reader->getUtf8String();
+        break;
     default:
         return DRW_Point::parseCode(code, reader);
     }
@@ -1125,11 +1128,11 @@ void DRW_LWPolyline::applyExtrusion(){
     if (haveExtrusion) {
         calculateAxis(extPoint);
         for (unsigned int i=0; i<vertlist.size(); i++) {
-			auto& vert = vertlist.at(i);
-            DRW_Coord v(vert->x, vert->y, elevation);
+            DRW_Vertex2D& vert = vertlist.at(i);
+            DRW_Coord v(vert.x, vert.y, elevation);
             extrudePoint(extPoint, &v);
-            vert->x = v.x;
-            vert->y = v.y;
+            vert.x = v.x;
+            vert.y = v.y;
         }
     }
 }
@@ -1137,8 +1140,7 @@ void DRW_LWPolyline::applyExtrusion(){
 bool DRW_LWPolyline::parseCode(int code, dxfReader *reader){
     switch (code) {
     case 10: {
-		vertex = std::make_shared<DRW_Vertex2D>();
-        vertlist.push_back(vertex);
+        vertex = &vertlist.emplace_back();
         vertex->x = reader->getDouble();
         break; }
     case 20:
@@ -1231,29 +1233,27 @@ bool DRW_LWPolyline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
 
     if (vertexnum > 0) { //verify if is lwpol without vertex (empty)
         // add vertexes
-		vertex = std::make_shared<DRW_Vertex2D>();
-        vertex->x = buf->getRawDouble();
-        vertex->y = buf->getRawDouble();
-        vertlist.push_back(vertex);
-		auto pv = vertex;
+        vertex = nullptr;
+        DRW_Vertex2D& first = vertlist.emplace_back();
+        first.x = buf->getRawDouble();
+        first.y = buf->getRawDouble();
         for (int i = 1; i< vertexnum; i++){
-			vertex = std::make_shared<DRW_Vertex2D>();
+            DRW_Vertex2D v;
 			if (version < DRW::AC1015) {//14-
-                vertex->x = buf->getRawDouble();
-                vertex->y = buf->getRawDouble();
+                v.x = buf->getRawDouble();
+                v.y = buf->getRawDouble();
             } else {
-//                DRW_Vertex2D *pv = vertlist.back();
-                vertex->x = buf->getDefaultDouble(pv->x);
-                vertex->y = buf->getDefaultDouble(pv->y);
+                const DRW_Vertex2D& pv = vertlist.back();
+                v.x = buf->getDefaultDouble(pv.x);
+                v.y = buf->getDefaultDouble(pv.y);
             }
-            pv = vertex;
-            vertlist.push_back(std::move(vertex));
+            vertlist.push_back(v);
         }
         //add bulges
         for (unsigned int i = 0; i < bulgesnum; i++){
             double bulge = buf->getBitDouble();
             if (vertlist.size()> i)
-                vertlist.at(i)->bulge = bulge;
+                vertlist.at(i).bulge = bulge;
         }
         //add vertexId
         if (version > DRW::AC1021) {//2010+
@@ -1262,7 +1262,7 @@ bool DRW_LWPolyline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
                 //TODO implement vertexId, do not exist in dxf
                 DRW_UNUSED(vertexId);
 //                if (vertlist.size()< i)
-//                    vertlist.at(i)->vertexId = vertexId;
+//                    vertlist.at(i).vertexId = vertexId;
             }
         }
         //add widths
@@ -1270,16 +1270,16 @@ bool DRW_LWPolyline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
             double staW = buf->getBitDouble();
             double endW = buf->getBitDouble();
             if (i < vertlist.size()) {
-                vertlist.at(i)->stawidth = staW;
-                vertlist.at(i)->endwidth = endW;
+                vertlist.at(i).stawidth = staW;
+                vertlist.at(i).endwidth = endW;
             }
         }
     }
     if (DRW_DBGGL == DRW_dbg::Level::Debug){
         DRW_DBG("\nVertex list: ");
 		for (auto& pv: vertlist) {
-            DRW_DBG("\n   x: "); DRW_DBG(pv->x); DRW_DBG(" y: "); DRW_DBG(pv->y); DRW_DBG(" bulge: "); DRW_DBG(pv->bulge);
-            DRW_DBG(" stawidth: "); DRW_DBG(pv->stawidth); DRW_DBG(" endwidth: "); DRW_DBG(pv->endwidth);
+            DRW_DBG("\n   x: "); DRW_DBG(pv.x); DRW_DBG(" y: "); DRW_DBG(pv.y); DRW_DBG(" bulge: "); DRW_DBG(pv.bulge);
+            DRW_DBG(" stawidth: "); DRW_DBG(pv.stawidth); DRW_DBG(" endwidth: "); DRW_DBG(pv.endwidth);
         }
     }
 
@@ -1926,10 +1926,9 @@ bool DRW_Hatch::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
                         spline->knotslist.push_back (buf->getBitDouble());
                     }
                     for (dint32 j = 0; j < spline->ncontrol;++j){
-                        std::shared_ptr<DRW_Coord> crd = std::make_shared<DRW_Coord>(buf->get2RawDouble());
+                        DRW_Coord& crd = spline->controllist.emplace_back(buf->get2RawDouble());
                         if(isRational)
-                            crd->z =  buf->getBitDouble(); //RLZ: investigate how store weight
-                        spline->controllist.push_back(crd);
+                            crd.z =  buf->getBitDouble(); //RLZ: investigate how store weight
                     }
                     if (version > DRW::AC1021) { //2010+
                         spline->nfit = buf->getBitLong();
@@ -1937,8 +1936,7 @@ bool DRW_Hatch::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
                             return false;
                         }
                         for (dint32 j = 0; j < spline->nfit;++j){
-                            std::shared_ptr<DRW_Coord> crd = std::make_shared<DRW_Coord>(buf->get2RawDouble());
-                            spline->fitlist.push_back(crd);
+                            spline->fitlist.push_back(buf->get2RawDouble());
                         }
                         spline->tgStart = buf->get2RawDouble();
                         spline->tgEnd = buf->get2RawDouble();
@@ -2074,8 +2072,7 @@ bool DRW_Spline::parseCode(int code, dxfReader *reader){
         tolfit = reader->getDouble();
         break;
     case 10: {
-        controlpoint = std::make_shared<DRW_Coord>();
-        controllist.push_back(controlpoint);
+        controlpoint = &controllist.emplace_back();
         controlpoint->x = reader->getDouble();
         break; }
     case 20:
@@ -2087,8 +2084,7 @@ bool DRW_Spline::parseCode(int code, dxfReader *reader){
             controlpoint->z = reader->getDouble();
         break;
     case 11: {
-        fitpoint = std::make_shared<DRW_Coord>();
-        fitlist.push_back(fitpoint);
+        fitpoint = &fitlist.emplace_back();
         fitpoint->x = reader->getDouble();
         break; }
     case 21:
@@ -2171,7 +2167,7 @@ bool DRW_Spline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
         return false;
     }
     for (dint32 i= 0; i<ncontrol; ++i){
-        controllist.push_back(std::make_shared<DRW_Coord>(buf->get3BitDouble()));
+        controllist.push_back(buf->get3BitDouble());
         if (weight) {
             DRW_DBG("\n w: ");
             DRW_DBG(buf->getBitDouble()); //RLZ Warning: D (BD or RD)
@@ -2181,7 +2177,7 @@ bool DRW_Spline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
         return false;
     }
     for (dint32 i= 0; i<nfit; ++i)
-        fitlist.push_back(std::make_shared<DRW_Coord>(buf->get3BitDouble()));
+        fitlist.push_back(buf->get3BitDouble());
 
     if (DRW_DBGGL == DRW_dbg::Level::Debug) {
         DRW_DBG("\nknots list: ");
@@ -2190,11 +2186,11 @@ bool DRW_Spline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
         }
         DRW_DBG("\ncontrol point list: ");
         for (auto const& v: controllist) {
-            DRW_DBG("\n"); DRW_DBGPT(v->x, v->y, v->z);
+            DRW_DBG("\n"); DRW_DBGPT(v.x, v.y, v.z);
         }
         DRW_DBG("\nfit point list: ");
         for (auto const& v: fitlist) {
-            DRW_DBG("\n"); DRW_DBGPT(v->x, v->y, v->z);
+            DRW_DBG("\n"); DRW_DBGPT(v.x, v.y, v.z);
         }
     }
 
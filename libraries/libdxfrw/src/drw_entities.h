@@ -475,7 +475,8 @@ protected:
 
 public:
     UTF8STRING name;             /*!< block name, code 2 */
-    int flags;                   /*!< block type, code 70 */
+    int flags;                   /*!< block type, code 70, 4 for external references */
+    UTF8STRING xrefPath;         /*!< path of the referenced drawing of an external reference, code 1 */
 private:
     bool isEnd; //for dwg parsing
 };
@@ -543,25 +544,17 @@ public:
         this->width = p.width;
         this->flags = p.flags;
 		this->extPoint = p.extPoint;
-        for (unsigned i=0; i<p.vertlist.size(); i++)// RLZ ok or new
-		  this->vertlist.push_back(
-					std::make_shared<DRW_Vertex2D>(*p.vertlist.at(i))
-					);
+        this->vertlist = p.vertlist;
     }
 	// TODO rule of 5
 
      void applyExtrusion() override;
     void addVertex (DRW_Vertex2D v) {
-		std::shared_ptr<DRW_Vertex2D> vert = std::make_shared<DRW_Vertex2D>(v);
-        vertlist.push_back(vert);
+        vertlist.push_back(v);
     }
-	std::shared_ptr<DRW_Vertex2D> addVertex () {
-		std::shared_ptr<DRW_Vertex2D> vert = std::make_shared<DRW_Vertex2D>();
-        vert->stawidth = 0;
-        vert->endwidth = 0;
-        vert->bulge = 0;
-        vertlist.push_back(vert);
-        return vert;
+    //! appends a zero vertex, the returned pointer is valid until the next vertex is added
+    DRW_Vertex2D* addVertex () {
+        return &vertlist.emplace_back();
     }
 
 protected:
@@ -575,8 +568,8 @@ public:
     double elevation;         /*!< elevation, code 38 */
     double thickness;         /*!< thickness, code 39 */
     DRW_Coord extPoint;       /*!<  Dir extrusion normal vector, code 210, 220 & 230 */
-	std::shared_ptr<DRW_Vertex2D> vertex;       /*!< current vertex to add data */
-	std::vector<std::shared_ptr<DRW_Vertex2D>> vertlist;  /*!< vertex list */
+    DRW_Vertex2D* vertex = nullptr;       /*!< current vertex to add data, points into vertlist */
+    std::vector<DRW_Vertex2D> vertlist;  /*!< vertex list, stored flat */
 };
 
 //! Class to handle insert entries
@@ -728,19 +721,19 @@ public:
         flags = vertexcount = facecount = 0;
         smoothM = smoothN = curvetype = 0;
     }
-    void addVertex (DRW_Vertex v) {
-        std::shared_ptr<DRW_Vertex> vert = std::make_shared<DRW_Vertex>();
-        vert->basePoint.x = v.basePoint.x;
-        vert->basePoint.y = v.basePoint.y;
-        vert->basePoint.z = v.basePoint.z;
-        vert->stawidth = v.stawidth;
-        vert->endwidth = v.endwidth;
-        vert->bulge = v.bulge;
-        vertlist.push_back(vert);
+    void addVertex (DRW_Vertex const& v) {
+        DRW_Vertex& vert = vertlist.emplace_back();
+        vert.basePoint = v.basePoint;
+        vert.stawidth = v.stawidth;
+        vert.endwidth = v.endwidth;
+        vert.bulge = v.bulge;
     }
-    void appendVertex (std::shared_ptr<DRW_Vertex> const& v) {
+    void appendVertex (DRW_Vertex const& v) {
         vertlist.push_back(v);
     }
+    void appendVertex (std::shared_ptr<DRW_Vertex> const& v) {
+        vertlist.push_back(*v);
+    }
 
 protected:
     bool parseCode(int code, dxfReader *reader) override;
@@ -756,7 +749,7 @@ public:
     int smoothN;             /*!< smooth surface M density, code 74, default 0 */
     int curvetype;           /*!< curves & smooth surface type, code 75, default 0 */
 
-    std::vector<std::shared_ptr<DRW_Vertex>> vertlist;  /*!< vertex list */
+    std::vector<DRW_Vertex> vertlist;  /*!< vertex list, stored flat */
 
 private:
     std::list<duint32>hadlesList; //list of handles, only in 2004+
@@ -810,12 +803,12 @@ public:
 
     std::vector<double> knotslist;           /*!< knots list, code 40 */
     std::vector<double> weightlist;          /*!< weight list, code 41 */
-    std::vector<std::shared_ptr<DRW_Coord>> controllist;  /*!< control points list, code 10, 20 & 30 */
-    std::vector<std::shared_ptr<DRW_Coord>> fitlist;      /*!< fit points list, code 11, 21 & 31 */
+    std::vector<DRW_Coord> controllist;  /*!< control points list, code 10, 20 & 30 */
+    std::vector<DRW_Coord> fitlist;      /*!< fit points list, code 11, 21 & 31 */
 
 private:
-    std::shared_ptr<DRW_Coord> controlpoint;   /*!< current control point to add data */
-    std::shared_ptr<DRW_Coord> fitpoint;       /*!< current fit point to add data */
+    DRW_Coord* controlpoint = nullptr;   /*!< current control point to add data, points into controllist */
+    DRW_Coord* fitpoint = nullptr;       /*!< current fit point to add data, points into fitlist */
 };
 
 //! Class to handle hatch loop
@@ -891,7 +884,7 @@ private:
         arc.reset();
         ellipse.reset();
         spline.reset();
-        plvert.reset();
+        plvert = nullptr;
     }
 
     void addLine() {
@@ -934,7 +927,7 @@ private:
     std::shared_ptr<DRW_Spline> spline;
     std::shared_ptr<DRW_LWPolyline> pline;
     std::shared_ptr<DRW_Point> pt;
-    std::shared_ptr<DRW_Vertex2D> plvert;
+    DRW_Vertex2D* plvert = nullptr;
     bool ispol;
 };
 
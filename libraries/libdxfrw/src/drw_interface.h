@@ -185,6 +185,14 @@ public:
      */
     virtual void addComment(const char* comment) = 0;
 
+    /**
+     * Called regularly while reading entities of a DXF file.
+     * @param position current read position in the file
+     * @param size size of the file
+     * @return false to cancel reading
+     */
+    virtual bool readProgress(unsigned long long /*position*/, unsigned long long /*size*/) {return true;}
+
     /**
      * Called for PLOTSETTINGS object definition.
      */
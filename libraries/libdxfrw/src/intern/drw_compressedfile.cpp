@@ -0,0 +1,303 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2024 LibreCAD (www.librecad.org)                           **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#include "drw_compressedfile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+
+#ifdef DRW_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef DRW_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+// the file is read in chunks of this size
+constexpr size_t chunkSize = 1 << 20;
+// content of uncompressed size unknown is expected to be this times bigger
+constexpr size_t expectedRatio = 8;
+
+bool endsWith(const std::string &text, const std::string &end) {
+    if (text.size() < end.size())
+        return false;
+    return std::equal(end.rbegin(), end.rend(), text.rbegin(), [](char a, char b) {
+        return a == std::tolower(static_cast<unsigned char>(b));
+    });
+}
+
+#if defined(DRW_HAVE_ZLIB) || defined(DRW_HAVE_ZSTD)
+// grows the buffer to take at least another chunk after the used part
+void reserveChunk(std::vector<char> &data, size_t used) {
+    if (data.size() - used < chunkSize)
+        data.resize(std::max(data.size() * 2, used + chunkSize));
+}
+#endif
+}
+
+DRW_Compression::Codec DRW_Compression::detect(const char *head, size_t size) {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(head);
+    if (size >= 2 && 0x1f == bytes[0] && 0x8b == bytes[1])
+        return Codec::Gzip;
+    if (size >= 4 && 0x28 == bytes[0] && 0xb5 == bytes[1] && 0x2f == bytes[2] && 0xfd == bytes[3])
+        return Codec::Zstd;
+    return Codec::None;
+}
+
+DRW_Compression::Codec DRW_Compression::fromFileName(const std::string &fileName) {
+    if (endsWith(fileName, ".gz"))
+        return Codec::Gzip;
+    if (endsWith(fileName, ".zst"))
+        return Codec::Zstd;
+    return Codec::None;
+}
+
+bool DRW_Compression::isAvailable(Codec codec) {
+    switch (codec) {
+    case Codec::None:
+        return true;
+    case Codec::Gzip:
+#ifdef DRW_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case Codec::Zstd:
+#ifdef DRW_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool DRW_CompressedFile::open(const std::string &fileName, DRW_Compression::Codec codec) {
+    m_data.clear();
+    m_size = 0;
+    if (!DRW_Compression::isAvailable(codec) || DRW_Compression::Codec::None == codec)
+        return false;
+    std::ifstream file(fileName.c_str(), std::ios_base::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    file.seekg(0, std::ios::end);
+    const std::streamoff fileSize = file.tellg();
+    if (fileSize <= 0)
+        return false;
+    size_t expected = static_cast<size_t>(fileSize) * expectedRatio;
+#ifdef DRW_HAVE_ZLIB
+    if (DRW_Compression::Codec::Gzip == codec && fileSize >= 18) {
+        // the size modulo 2^32 of the last member, exact for the usual single member files
+        unsigned char trailer[4];
+        file.seekg(-4, std::ios::end);
+        file.read(reinterpret_cast<char *>(trailer), 4);
+        const size_t size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16)
+                            | (static_cast<size_t>(trailer[3]) << 24);
+        if (size >= static_cast<size_t>(fileSize))
+            expected = size + 1;
+    }
+#endif
+    file.clear();
+    file.seekg(0, std::ios::beg);
+
+    std::vector<char> chunk(chunkSize);
+    m_data.resize(std::max(expected, chunkSize));
+    bool complete = false;
+
+#ifdef DRW_HAVE_ZLIB
+    if (DRW_Compression::Codec::Gzip == codec) {
+        z_stream stream {};
+        // gzip header, no zlib header
+        if (Z_OK != inflateInit2(&stream, 15 + 16))
+            return false;
+        bool failed = false;
+        while (!failed && file) {
+            file.read(chunk.data(), chunk.size());
+            stream.next_in = reinterpret_cast<Bytef *>(chunk.data());
+            stream.avail_in = static_cast<uInt>(file.gcount());
+            // a full output may leave decompressed data in the stream
+            bool full = false;
+            while (!failed && (stream.avail_in > 0 || full)) {
+                reserveChunk(m_data, m_size);
+                stream.next_out = reinterpret_cast<Bytef *>(m_data.data() + m_size);
+                stream.avail_out = static_cast<uInt>(std::min<size_t>(m_data.size() - m_size, UINT32_MAX));
+                const uInt available = stream.avail_out;
+                const int ret = inflate(&stream, Z_NO_FLUSH);
+                m_size += available - stream.avail_out;
+                full = 0 == stream.avail_out;
+                if (Z_STREAM_END == ret) {
+                    // concatenated members
+                    complete = true;
+                    inflateReset(&stream);
+                } else if (Z_OK == ret || Z_BUF_ERROR == ret) {
+                    complete = complete && stream.total_in == 0;
+                } else {
+                    failed = true;
+                }
+            }
+        }
+        inflateEnd(&stream);
+        complete = complete && !failed;
+    }
+#endif
+#ifdef DRW_HAVE_ZSTD
+    if (DRW_Compression::Codec::Zstd == codec) {
+        ZSTD_DStream *stream = ZSTD_createDStream();
+        if (nullptr == stream)
+            return false;
+        bool failed = false;
+        size_t pending = 0;
+        while (!failed && file) {
+            file.read(chunk.data(), chunk.size());
+            ZSTD_inBuffer input {chunk.data(), static_cast<size_t>(file.gcount()), 0};
+            // a full output may leave decompressed data in the stream
+            bool full = false;
+            while (!failed && (input.pos < input.size || full)) {
+                reserveChunk(m_data, m_size);
+                ZSTD_outBuffer output {m_data.data() + m_size, m_data.size() - m_size, 0};
+                pending = ZSTD_decompressStream(stream, &output, &input);
+                m_size += output.pos;
+                full = output.pos == output.size;
+                failed = ZSTD_isError(pending);
+            }
+        }
+        ZSTD_freeDStream(stream);
+        // 0 after the end of a frame
+        complete = !failed && 0 == pending;
+    }
+#endif
+    if (!complete || file.bad()) {
+        m_data.clear();
+        m_size = 0;
+        return false;
+    }
+    return true;
+}
+
+struct DRW_CompressingBuffer::State {
+    DRW_Compression::Codec codec {DRW_Compression::Codec::None};
+#ifdef DRW_HAVE_ZLIB
+    z_stream deflate {};
+#endif
+#ifdef DRW_HAVE_ZSTD
+    ZSTD_CCtx *zstd {nullptr};
+#endif
+};
+
+DRW_CompressingBuffer::DRW_CompressingBuffer(std::ostream *sink, DRW_Compression::Codec codec):
+    m_state{std::make_unique<State>()},
+    m_sink{sink},
+    m_input(chunkSize),
+    m_output(chunkSize) {
+    m_state->codec = codec;
+    setp(m_input.data(), m_input.data() + m_input.size());
+    if (nullptr == m_sink || !DRW_Compression::isAvailable(codec))
+        return;
+    switch (codec) {
+    case DRW_Compression::Codec::Gzip:
+#ifdef DRW_HAVE_ZLIB
+        // gzip header, no zlib header
+        m_valid = Z_OK == deflateInit2(&m_state->deflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                                       15 + 16, 8, Z_DEFAULT_STRATEGY);
+#endif
+        break;
+    case DRW_Compression::Codec::Zstd:
+#ifdef DRW_HAVE_ZSTD
+        m_state->zstd = ZSTD_createCCtx();
+        m_valid = nullptr != m_state->zstd;
+#endif
+        break;
+    default:
+        break;
+    }
+}
+
+DRW_CompressingBuffer::~DRW_CompressingBuffer() {
+#ifdef DRW_HAVE_ZLIB
+    if (DRW_Compression::Codec::Gzip == m_state->codec && m_valid)
+        deflateEnd(&m_state->deflate);
+#endif
+#ifdef DRW_HAVE_ZSTD
+    if (nullptr != m_state->zstd)
+        ZSTD_freeCCtx(m_state->zstd);
+#endif
+}
+
+bool DRW_CompressingBuffer::finish() {
+    if (!m_finished) {
+        m_finished = true;
+        m_valid = compress(true) && m_valid;
+        m_sink->flush();
+    }
+    return m_valid && !m_sink->fail();
+}
+
+DRW_CompressingBuffer::int_type DRW_CompressingBuffer::overflow(int_type c) {
+    if (m_finished || !compress(false))
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int DRW_CompressingBuffer::sync() {
+    // no flush of the codec, it would make the compression worse
+    return !m_finished && compress(false) ? 0 : -1;
+}
+
+bool DRW_CompressingBuffer::compress([[maybe_unused]] bool end) {
+    if (!m_valid)
+        return false;
+    [[maybe_unused]] const size_t size = static_cast<size_t>(pptr() - pbase());
+    bool ok = true;
+#ifdef DRW_HAVE_ZLIB
+    if (DRW_Compression::Codec::Gzip == m_state->codec) {
+        z_stream &stream = m_state->deflate;
+        stream.next_in = reinterpret_cast<Bytef *>(pbase());
+        stream.avail_in = static_cast<uInt>(size);
+        int ret = Z_OK;
+        do {
+            stream.next_out = reinterpret_cast<Bytef *>(m_output.data());
+            stream.avail_out = static_cast<uInt>(m_output.size());
+            ret = deflate(&stream, end ? Z_FINISH : Z_NO_FLUSH);
+            if (Z_STREAM_ERROR == ret) {
+                ok = false;
+                break;
+            }
+            m_sink->write(m_output.data(), m_output.size() - stream.avail_out);
+        } while (0 == stream.avail_out || (end && Z_STREAM_END != ret));
+    }
+#endif
+#ifdef DRW_HAVE_ZSTD
+    if (DRW_Compression::Codec::Zstd == m_state->codec) {
+        ZSTD_inBuffer input {pbase(), size, 0};
+        size_t remaining = 0;
+        do {
+            ZSTD_outBuffer output {m_output.data(), m_output.size(), 0};
+            remaining = ZSTD_compressStream2(m_state->zstd, &output, &input,
+                                             end ? ZSTD_e_end : ZSTD_e_continue);
+            if (ZSTD_isError(remaining)) {
+                ok = false;
+                break;
+            }
+            m_sink->write(m_output.data(), output.pos);
+        } while (input.pos < input.size || (end && 0 != remaining));
+    }
+#endif
+    setp(m_input.data(), m_input.data() + m_input.size());
+    return ok && !m_sink->fail();
+}
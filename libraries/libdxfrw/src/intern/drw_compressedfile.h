@@ -0,0 +1,95 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2024 LibreCAD (www.librecad.org)                           **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#ifndef DRW_COMPRESSEDFILE_H
+#define DRW_COMPRESSEDFILE_H
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * Dxf files compressed by gzip (.dxf.gz) or zstd (.dxf.zst). Compressed files are recognized
+ * by their first bytes when read, and by the extension of their name when written.
+ * Each codec is available if the library is built with DRW_HAVE_ZLIB or DRW_HAVE_ZSTD.
+ */
+namespace DRW_Compression {
+enum class Codec {
+    None,
+    Gzip,
+    Zstd
+};
+
+//! the codec of data starting with the given bytes, None for uncompressed data
+Codec detect(const char *head, size_t size);
+//! the codec given by the extension of the file name, None for other names
+Codec fromFileName(const std::string &fileName);
+bool isAvailable(Codec codec);
+}
+
+/**
+ * Whole content of a compressed file in memory. The file is read and decompressed chunk by
+ * chunk, the content is tokenized in place afterwards, like a mapped file. It isn't streamed
+ * into the tokenizer, the records of the entities are parsed in parallel from their ranges in
+ * the buffer, by dxfRW::read.
+ */
+class DRW_CompressedFile {
+public:
+    //! returns false if the file can't be read, or isn't a complete stream of the codec
+    bool open(const std::string &fileName, DRW_Compression::Codec codec);
+
+    const char *data() const {return m_data.data();}
+    size_t size() const {return m_size;}
+
+private:
+    std::vector<char> m_data;
+    size_t m_size {0};
+};
+
+/**
+ * Output stream buffer compressing the data written to it into a sink stream.
+ * finish() must be called after the last data, to complete the compressed stream.
+ */
+class DRW_CompressingBuffer : public std::streambuf {
+public:
+    DRW_CompressingBuffer(std::ostream *sink, DRW_Compression::Codec codec);
+    ~DRW_CompressingBuffer() override;
+
+    DRW_CompressingBuffer(const DRW_CompressingBuffer&) = delete;
+    DRW_CompressingBuffer& operator=(const DRW_CompressingBuffer&) = delete;
+
+    //! false if the codec isn't available, or failed
+    bool isValid() const {return m_valid;}
+    //! compresses the pending data and ends the compressed stream
+    bool finish();
+
+protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+private:
+    //! compresses the data in the put area into the sink
+    bool compress(bool end);
+
+    struct State;
+    std::unique_ptr<State> m_state;
+    std::ostream *m_sink {nullptr};
+    std::vector<char> m_input;
+    std::vector<char> m_output;
+    bool m_valid {false};
+    bool m_finished {false};
+};
+
+#endif // DRW_COMPRESSEDFILE_H
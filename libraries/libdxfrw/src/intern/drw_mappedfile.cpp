@@ -0,0 +1,109 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2024 LibreCAD (www.librecad.org)                           **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#include "drw_mappedfile.h"
+
+#ifdef _WIN32
+#include <cstdint>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+DRW_MappedFile::~DRW_MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool DRW_MappedFile::open(const std::string &fileName) {
+    close();
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (INVALID_HANDLE_VALUE == file)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || 0 == fileSize.QuadPart
+        || static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (nullptr == mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (nullptr == view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const char *>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void DRW_MappedFile::close() {
+    if (nullptr != m_data)
+        UnmapViewOfFile(m_data);
+    if (nullptr != m_mapping)
+        CloseHandle(m_mapping);
+    if (nullptr != m_file)
+        CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+#else
+
+bool DRW_MappedFile::open(const std::string &fileName) {
+    close();
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (0 != fstat(fd, &st) || !S_ISREG(st.st_mode) || 0 == st.st_size) {
+        ::close(fd);
+        return false;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    void *view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after closing the descriptor
+    ::close(fd);
+    if (MAP_FAILED == view)
+        return false;
+
+    // the file is tokenized front to back
+    madvise(view, fileSize, MADV_SEQUENTIAL);
+    m_data = static_cast<const char *>(view);
+    m_size = fileSize;
+    return true;
+}
+
+void DRW_MappedFile::close() {
+    if (nullptr != m_data)
+        munmap(const_cast<char *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
@@ -0,0 +1,48 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2024 LibreCAD (www.librecad.org)                           **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#ifndef DRW_MAPPEDFILE_H
+#define DRW_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Read only memory mapping of a whole file.
+ * The mapping is released by the destructor or close().
+ */
+class DRW_MappedFile {
+public:
+    DRW_MappedFile() = default;
+    ~DRW_MappedFile();
+
+    DRW_MappedFile(const DRW_MappedFile&) = delete;
+    DRW_MappedFile& operator=(const DRW_MappedFile&) = delete;
+
+    //! maps the file, returns false if the file can't be mapped, e.g. when it's empty
+    bool open(const std::string &fileName);
+    void close();
+
+    bool isOpen() const {return nullptr != m_data;}
+    const char *data() const {return m_data;}
+    size_t size() const {return m_size;}
+
+private:
+    const char *m_data {nullptr};
+    size_t m_size {0};
+#ifdef _WIN32
+    void *m_file {nullptr};
+    void *m_mapping {nullptr};
+#endif
+};
+
+#endif // DRW_MAPPEDFILE_H
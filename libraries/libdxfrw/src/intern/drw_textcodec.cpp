@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <cstring>
+#include <functional>
 #include "../drw_base.h"
 #include "drw_cptables.h"
 #include "drw_cptable932.h"
@@ -127,16 +128,51 @@ void DRW_TextCodec::setCodePage(const std::string &c, bool dxfFormat){
         else
             conv.reset( new DRW_ConvUTF16() );//utf16 to utf8
     }
+    asciiCompatible = (nullptr == dynamic_cast<DRW_ConvUTF16*>(conv.get()));
+    clearCache();
+}
+
+namespace {
+//! true if no character needs a conversion, only ascii without \U+ escapes
+bool isPlainAscii(const std::string &s, bool checkEscapes) {
+    const size_t length = s.length();
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = s[i];
+        if (c > 0x7F)
+            return false;
+        if (checkEscapes && c == '\\' && i + 1 < length && s[i+1] == 'U')
+            return false;
+    }
+    return true;
+}
 }
 
 std::string DRW_TextCodec::toUtf8(const std::string &s) {
-    return conv->toUtf8(s);
+    if (asciiCompatible && isPlainAscii(s, true))
+        return s;
+    if (s.length() > cachedLength)
+        return conv->toUtf8(s);
+    CacheEntry &entry = cache[std::hash<std::string>{}(s) % cacheSize];
+    if (entry.text != s || entry.utf8.empty()) {
+        entry.text = s;
+        entry.utf8 = conv->toUtf8(s);
+    }
+    return entry.utf8;
 }
 
 std::string DRW_TextCodec::fromUtf8(const std::string &s) {
+    if (asciiCompatible && isPlainAscii(s, false))
+        return s;
     return conv->fromUtf8(s);
 }
 
+void DRW_TextCodec::clearCache() {
+    for (CacheEntry &entry : cache) {
+        entry.text.clear();
+        entry.utf8.clear();
+    }
+}
+
 std::string DRW_Converter::toUtf8(const std::string &s) {
     std::string result;
     int j = 0;
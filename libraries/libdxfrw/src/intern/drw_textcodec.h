@@ -1,6 +1,7 @@
 #ifndef DRW_TEXTCODEC_H
 #define DRW_TEXTCODEC_H
 
+#include <array>
 #include <string>
 #include <memory>
 #include "../drw_base.h"
@@ -22,11 +23,22 @@ public:
 
 private:
     std::string correctCodePage(const std::string& s);
+    //! converted strings are cached, layer, line type and style names repeat a lot
+    struct CacheEntry {
+        std::string text;
+        std::string utf8;
+    };
+    static constexpr size_t cacheSize = 64;
+    static constexpr size_t cachedLength = 64;
+    void clearCache();
 
 private:
     DRW::Version version{DRW::UNKNOWNV};
     std::string cp;
     std::unique_ptr< DRW_Converter> conv;
+    //! false for utf16, otherwise ascii characters are the same in utf8 and in the code page
+    bool asciiCompatible {true};
+    std::array<CacheEntry, cacheSize> cache;
 };
 
 class DRW_Converter
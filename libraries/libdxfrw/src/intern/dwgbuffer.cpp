@@ -11,6 +11,7 @@
 ******************************************************************************/
 
 
+#include <cstring>
 #include "dwgbuffer.h"
 #include "../libdwgr.h"
 #include "drw_textcodec.h"
@@ -138,15 +139,15 @@ bool dwgCharStream::read(duint8* s, duint64 n){
         isOk = false;
         return false;
     }
-    for (duint64 i=0; i<n; i++){
-        s[i]= stream[pos++];
-    }
+    memcpy(s, stream + pos, n);
+    pos += n;
     return true;
 }
 
-dwgBuffer::dwgBuffer(duint8 *buf, duint64 size, DRW_TextCodec *dc)
+dwgBuffer::dwgBuffer(const duint8 *buf, duint64 size, DRW_TextCodec *dc)
     :decoder{dc}
     ,filestr{new dwgCharStream(buf, size)}
+    ,memStream{static_cast<dwgCharStream*>(filestr.get())}
     ,maxSize{size}
 {}
 
@@ -159,6 +160,7 @@ dwgBuffer::dwgBuffer(std::ifstream *stream, DRW_TextCodec *dc)
 dwgBuffer::dwgBuffer( const dwgBuffer& org )
     :decoder{org.decoder}
     ,filestr{org.filestr->clone()}
+    ,memStream{nullptr != org.memStream ? static_cast<dwgCharStream*>(filestr.get()) : nullptr}
     ,maxSize{filestr->size()}
     ,currByte{org.currByte}
     ,bitPos{org.bitPos}
@@ -166,6 +168,7 @@ dwgBuffer::dwgBuffer( const dwgBuffer& org )
 
 dwgBuffer& dwgBuffer::operator=( const dwgBuffer& org ){
     filestr.reset( org.filestr->clone());
+    memStream = nullptr != org.memStream ? static_cast<dwgCharStream*>(filestr.get()) : nullptr;
     decoder = org.decoder;
     maxSize = filestr->size();
     currByte = org.currByte;
@@ -194,8 +197,8 @@ void dwgBuffer::setBitPos(duint8 pos){
     if (pos>7)
         return;
     if (pos != 0 && bitPos == 0){
-        duint8 buffer;
-        filestr->read (&buffer,1);
+        duint8 buffer {0};
+        readByte(&buffer);
         currByte = buffer;
     }
     if (pos == 0 && bitPos != 0){//reset current byte
@@ -212,17 +215,17 @@ bool dwgBuffer::moveBitPos(dint32 size){
     bitPos = b & 7;
 
     if (bitPos != 0){
-        filestr->read (&currByte,1);
+        readByte(&currByte);
     }
     return filestr->good();
 }
 
 /**Reads one Bit returns a char with value 0/1 (B) **/
 duint8 dwgBuffer::getBit(){
-    duint8 buffer;
+    duint8 buffer {0};
     duint8 ret = 0;
     if (bitPos == 0){
-        filestr->read (&buffer,1);
+        readByte(&buffer);
         currByte = buffer;
     }
 
@@ -241,10 +244,10 @@ bool dwgBuffer::getBoolBit(){
 
 /**Reads two Bits returns a char (BB) **/
 duint8 dwgBuffer::get2Bits(){
-    duint8 buffer;
+    duint8 buffer {0};
     duint8 ret = 0;
     if (bitPos == 0){
-        filestr->read (&buffer,1);
+        readByte(&buffer);
         currByte = buffer;
     }
 
@@ -253,7 +256,7 @@ duint8 dwgBuffer::get2Bits(){
         ret = currByte >>(8 - bitPos);
     else {//read one bit per byte
         ret = currByte << 1;
-        filestr->read (&buffer,1);
+        readByte(&buffer);
         currByte = buffer;
         bitPos = 1;
         ret = ret | currByte >> 7;
@@ -267,10 +270,10 @@ duint8 dwgBuffer::get2Bits(){
 /**Reads thee Bits returns a char (3B) **/
 //RLZ: todo verify this
 duint8 dwgBuffer::get3Bits(){
-    duint8 buffer;
+    duint8 buffer {0};
     duint8 ret = 0;
     if (bitPos == 0){
-        filestr->read (&buffer,1);
+        readByte(&buffer);
         currByte = buffer;
     }
 
@@ -279,7 +282,7 @@ duint8 dwgBuffer::get3Bits(){
         ret = currByte >>(8 - bitPos);
     else {//read one bit per byte
         ret = currByte << 1;
-        filestr->read (&buffer,1);
+        readByte(&buffer);
         currByte = buffer;
         bitPos = 1;
         ret = ret | currByte >> 7;
@@ -346,17 +349,8 @@ double dwgBuffer::getBitDouble(){
     dint8 b = get2Bits();
     if (b == 1)
         return 1.0;
-    else if (b == 0){
-        duint8 buffer[8];
-        if (bitPos != 0) {
-            for (int i = 0; i < 8; i++)
-                buffer[i] = getRawChar8();
-        } else {
-        filestr->read (buffer,8);
-        }
-        double* ret = reinterpret_cast<double*>( buffer );
-        return *ret;
-    }
+    else if (b == 0)
+        return getRawDouble();
     //    if (b == 2)
     return 0.0;
 }
@@ -370,11 +364,32 @@ DRW_Coord dwgBuffer::get3BitDouble(){
     return crd;
 }
 
+/**Reads n raw bytes (n x RC) at once from memory buffers, returns false without
+ * reading for file streams or if less than n bytes are left **/
+bool dwgBuffer::getRawBytesFast(duint8 *buf, duint8 n){
+    if (nullptr == memStream)
+        return false;
+    const duint8 *data = memStream->readData(n);
+    if (nullptr == data)
+        return false;
+    if (bitPos == 0) {
+        memcpy(buf, data, n);
+        return true;
+    }
+    //the high bits of each byte come from the previous one
+    const duint8 rs = 8 - bitPos;
+    for (duint8 i = 0; i < n; ++i) {
+        buf[i] = (currByte << bitPos) | (data[i] >> rs);
+        currByte = data[i];
+    }
+    return true;
+}
+
 /**Reads raw char 8 bits returns a unsigned char (RC) **/
 duint8 dwgBuffer::getRawChar8(){
     duint8 ret=0;
     duint8 buffer=0;
-    filestr->read (&buffer,1);
+    readByte(&buffer);
     if (bitPos == 0)
         return buffer;
     else {
@@ -390,6 +405,8 @@ duint16 dwgBuffer::getRawShort16(){
     duint8 buffer[2]={0,0};
     duint16 ret=0;
 
+    if (getRawBytesFast(buffer, 2))
+        return (buffer[1] << 8) | buffer[0];
     filestr->read (buffer,2);
     if (bitPos == 0) {
         /* no offset directly swap bytes for little-endian */
@@ -409,6 +426,11 @@ duint16 dwgBuffer::getRawShort16(){
 /**Reads raw double IEEE standard 64 bits returns a double (RD) **/
 double dwgBuffer::getRawDouble(){
     duint8 buffer[8];
+    if (getRawBytesFast(buffer, 8)) {
+        double ret;
+        memcpy(&ret, buffer, sizeof(ret));
+        return ret;
+    }
     memset(buffer,0,sizeof(buffer));
     if (bitPos == 0)
         filestr->read (buffer,8);
@@ -431,6 +453,9 @@ DRW_Coord dwgBuffer::get2RawDouble(){
 
 /**Reads raw int 32 bits little-endian order, returns a unsigned (RL) **/
 duint32 dwgBuffer::getRawLong32(){
+    duint8 buffer[4];
+    if (getRawBytesFast(buffer, 4))
+        return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (static_cast<duint32>(buffer[3]) << 24);
     duint16 tmp1 = getRawShort16();
     duint16 tmp2 = getRawShort16();
     duint32 ret = (tmp2 << 16) | (tmp1 & 0x0000FFFF);
@@ -440,6 +465,13 @@ duint32 dwgBuffer::getRawLong32(){
 
 /**Reads raw int 64 bits little-endian order, returns a unsigned long long (RLL) **/
 duint64 dwgBuffer::getRawLong64(){
+    duint8 buffer[8];
+    if (getRawBytesFast(buffer, 8)) {
+        duint64 ret = 0;
+        for (int i = 7; i >= 0; --i)
+            ret = (ret << 8) | buffer[i];
+        return ret;
+    }
     duint32 tmp1 = getRawLong32();
     duint64 tmp2 = getRawLong32();
     duint64 ret = (tmp2 << 32) | (tmp1 & 0x00000000FFFFFFFF);
@@ -449,19 +481,15 @@ duint64 dwgBuffer::getRawLong64(){
 
 /**Reads modular unsigner int, char based, compressed form, little-endian order, returns a unsigned (U-MC) **/
 duint32 dwgBuffer::getUModularChar(){
-    std::vector<duint8> buffer;
     duint32 result =0;
+    int offset = 0;
     for (int i=0; i<4;i++){
         duint8 b= getRawChar8();
-        buffer.push_back(b & 0x7F);
+        result += (b & 0x7F) << offset;
+        offset +=7;
         if (! (b & 0x80))
             break;
     }
-    int offset = 0;
-    for (unsigned int i=0; i<buffer.size();i++){
-        result += buffer[i] << offset;
-        offset +=7;
-    }
 //RLZ: WARNING!!! needed to verify on read handles
     //result = result & 0x7F;
     return result;
@@ -470,24 +498,20 @@ duint32 dwgBuffer::getUModularChar(){
 /**Reads modular int, char based, compressed form, little-endian order, returns a signed int (MC) **/
 dint32 dwgBuffer::getModularChar(){
     bool negative = false;
-    std::vector<dint8> buffer;
     dint32 result =0;
+    int offset = 0;
     for (int i=0; i<4;i++){
         duint8 b= getRawChar8();
-        buffer.push_back(b & 0x7F);
-        if (! (b & 0x80))
+        //the last byte holds the sign
+        if (! (b & 0x80) || i == 3) {
+            if (b & 0x40) {
+                negative = true;
+                b &= 0x3F;
+            }
+            result += (b & 0x7F) << offset;
             break;
-    }
-    dint8 b= buffer.back();
-    if (b & 0x40) {
-        negative = true;
-        buffer.pop_back();
-        buffer.push_back(b & 0x3F);
-    }
-
-    int offset = 0;
-    for (unsigned int i=0; i<buffer.size();i++){
-        result += buffer[i] << offset;
+        }
+        result += (b & 0x7F) << offset;
         offset +=7;
     }
     if (negative)
@@ -498,11 +522,12 @@ dint32 dwgBuffer::getModularChar(){
 /**Reads modular int, short based, compressed form, little-endian order, returns a unsigned (MC) **/
 dint32 dwgBuffer::getModularShort(){
 //    bool negative = false;
-    std::vector<dint16> buffer;
     dint32 result =0;
+    int offset = 0;
     for (int i=0; i<2;i++){
         duint16 b= getRawShort16();
-        buffer.push_back(b & 0x7FFF);
+        result += (b & 0x7FFF) << offset;
+        offset +=15;
         if (! (b & 0x8000))
             break;
     }
@@ -515,11 +540,6 @@ dint32 dwgBuffer::getModularShort(){
         buffer.push_back(b & 0x3F);
     }*/
 
-    int offset = 0;
-    for (unsigned int i=0; i<buffer.size();i++){
-        result += buffer[i] << offset;
-        offset +=15;
-    }
 /*    if (negative)
         result = -result;*/
     return result;
@@ -693,7 +713,8 @@ double dwgBuffer::getDefaultDouble(double d){
     else if (b == 1){
         duint8 buffer[4];
         char *tmp=nullptr;
-        if (bitPos != 0) {
+        if (getRawBytesFast(buffer, 4)) {
+        } else if (bitPos != 0) {
             for (int i = 0; i < 4; i++)
                 buffer[i] = getRawChar8();
         } else {
@@ -707,7 +728,8 @@ double dwgBuffer::getDefaultDouble(double d){
     } else if (b == 2){
         duint8 buffer[6];
         char *tmp=nullptr;
-        if (bitPos != 0) {
+        if (getRawBytesFast(buffer, 6)) {
+        } else if (bitPos != 0) {
             for (int i = 0; i < 6; i++)
                 buffer[i] = getRawChar8();
         } else {
@@ -846,6 +868,18 @@ bool dwgBuffer::getBytes(unsigned char *buf, duint64 size){
     return true;
 }
 
+const duint8 *dwgBuffer::getBytesView(duint64 size, std::vector<duint8> &storage){
+    if (nullptr != memStream && 0 == bitPos) {
+        const duint8 *data = memStream->readData(size);
+        if (nullptr != data)
+            return data;
+    }
+    //not aligned, a file, or not enough data: getBytes sets the error
+    storage.resize(size);
+    getBytes(storage.data(), size);
+    return storage.data();
+}
+
 duint16 dwgBuffer::crc8(duint16 dx,dint32 start,dint32 end){
     duint64 pos = filestr->getPos();
     filestr->setPos(start);
@@ -16,6 +16,7 @@
 #include <fstream>
 #include <sstream>
 #include <memory>
+#include <vector>
 #include "../drw_base.h"
 
 class DRW_Coord;
@@ -32,6 +33,8 @@ public:
     virtual bool setPos(duint64 p) = 0;
     virtual bool good() const = 0;
     virtual dwgBasicStream* clone() const = 0;
+    //! true if a clone can be read in another thread, while this stream is read
+    virtual bool canReadConcurrently() const {return false;}
 };
 
 class dwgFileStream: public dwgBasicStream{
@@ -54,9 +57,11 @@ private:
     duint64 sz{0};
 };
 
+/** Stream over bytes owned elsewhere, a decompressed section or a memory
+ * mapped file. Clones are views of the same bytes, they are never copied. */
 class dwgCharStream: public dwgBasicStream{
 public:
-    dwgCharStream(duint8 *buf, duint64 s)
+    dwgCharStream(const duint8 *buf, duint64 s)
         :stream{buf}
         ,sz{s}
     {}
@@ -66,8 +71,26 @@ public:
     bool setPos(duint64 p) override;
     bool good() const override {return isOk;}
     dwgBasicStream* clone() const override {return new dwgCharStream(stream, sz);}
+    bool canReadConcurrently() const override {return true;}
+    //! non virtual read of a byte, used by dwgBuffer
+    bool readByte(duint8 *b) {
+        if (pos >= sz) {
+            isOk = false;
+            return false;
+        }
+        *b = stream[pos++];
+        return true;
+    }
+    //! skips n bytes and returns a pointer to them, nullptr without change if not available
+    const duint8 *readData(duint64 n) {
+        if (n > sz - pos)
+            return nullptr;
+        const duint8 *data = stream + pos;
+        pos += n;
+        return data;
+    }
 private:
-    duint8 *stream{nullptr};
+    const duint8 *stream{nullptr};
     duint64 sz{0};
     duint64 pos{0};
     bool isOk{true};
@@ -76,7 +99,7 @@ private:
 class dwgBuffer {
 public:
     dwgBuffer(std::ifstream *stream, DRW_TextCodec *decoder = nullptr);
-    dwgBuffer(duint8 *buf, duint64 size, DRW_TextCodec *decoder= nullptr);
+    dwgBuffer(const duint8 *buf, duint64 size, DRW_TextCodec *decoder= nullptr);
     dwgBuffer( const dwgBuffer& org );
     dwgBuffer& operator=( const dwgBuffer& org );
     virtual ~dwgBuffer() = default;
@@ -131,7 +154,11 @@ public:
     duint16 getBERawShort16();  //RS big-endian order
 
     bool isGood() const {return filestr->good();}
+    //! false for files, copies of this buffer share the file position
+    bool canReadConcurrently() const {return filestr->canReadConcurrently();}
     bool getBytes(duint8 *buf, duint64 size);
+    //! next size bytes, pointing into memory buffers when byte aligned, else copied to storage
+    const duint8 *getBytesView(duint64 size, std::vector<duint8> &storage);
     int numRemainingBytes() const {return (maxSize- filestr->getPos());}
 
     duint16 crc8(duint16 dx,dint32 start,dint32 end);
@@ -141,7 +168,15 @@ public:
     DRW_TextCodec *decoder{nullptr};
 
 private:
+    //! reads a byte without a virtual call for memory buffers
+    bool readByte(duint8 *b) {
+        return nullptr != memStream ? memStream->readByte(b) : filestr->read(b, 1);
+    }
+    bool getRawBytesFast(duint8 *buf, duint8 n);
+
     std::unique_ptr<dwgBasicStream> filestr;
+    //! filestr, if it is a memory buffer, else nullptr
+    dwgCharStream *memStream{nullptr};
     duint64 maxSize{0};
     duint8 currByte{0};
     duint8 bitPos{0};
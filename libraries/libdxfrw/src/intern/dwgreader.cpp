@@ -10,11 +10,15 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
 #include "dwgreader.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
@@ -41,6 +45,20 @@ dwgReader::~dwgReader() {
     mapCleanUp(appIdmap);
 }
 
+/**
+ * Replaces the std::ifstream based fileBuf with a view of a read only memory
+ * mapping of the file. Section reads become pointer arithmetic, entities are
+ * parsed in place and the buffer clones used by readDwgEntitiesParallel()
+ * don't share a file position. Without a mapping the stream is kept.
+ */
+void dwgReader::mapFile(const std::string &fileName) {
+    if (!mappedFile.open(fileName))
+        return;
+    DRW_DBG("dwgReader::mapFile, reading a memory mapping of the file\n");
+    fileBuf.reset(new dwgBuffer(reinterpret_cast<const duint8*>(mappedFile.data()),
+                                mappedFile.size()));
+}
+
 void dwgReader::parseAttribs(DRW_Entity* e) {
     if (nullptr == e) {
         return;
@@ -853,9 +871,9 @@ bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
                 if (version > DRW::AC1021) {//2010+
                     bs = dbuf->getUModularChar();
                 }
-                std::vector<duint8> tmpByteStr(size);
-                dbuf->getBytes(tmpByteStr.data(), size);
-                dwgBuffer buff(tmpByteStr.data(), size, &decoder);
+                std::vector<duint8> tmpByteStr;
+                const duint8 *objData = dbuf->getBytesView(size, tmpByteStr);
+                dwgBuffer buff(objData, size, &decoder);
                 dint16 oType = buff.getObjType(version);
                 buff.resetPosition();
                 DRW_DBG(" object type= "); DRW_DBG(oType); DRW_DBG("\n");
@@ -889,9 +907,9 @@ bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
                 if (version > DRW::AC1021) {//2010+
                     bs = dbuf->getUModularChar();
                 }
-                std::vector<duint8> tmpByteStr(size);
-                dbuf->getBytes(tmpByteStr.data(), size);
-                dwgBuffer buff(tmpByteStr.data(), size, &decoder);
+                std::vector<duint8> tmpByteStr;
+                const duint8 *objData = dbuf->getBytesView(size, tmpByteStr);
+                dwgBuffer buff(objData, size, &decoder);
                 dint16 oType = buff.getObjType(version);
                 buff.resetPosition();
                 DRW_DBG(" object type= "); DRW_DBG(oType); DRW_DBG("\n");
@@ -910,9 +928,14 @@ bool dwgReader::readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf){
 }
 
 bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
-    bool ret = true;
-
     DRW_DBG("\nobject map total size= "); DRW_DBG(ObjectMap.size());
+    //debug output is not thread safe
+    if (parallelDecode && DRW_DBGGL != DRW_dbg::Level::Debug
+            && dbuf->canReadConcurrently() && ObjectMap.size() >= minParallelObjects) {
+        return readDwgEntitiesParallel(intfa, dbuf);
+    }
+
+    bool ret = true;
     auto itB=ObjectMap.begin();
     auto itE=ObjectMap.end();
     while (itB != itE) {
@@ -926,32 +949,166 @@ bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
     return ret;
 }
 
+/**
+ * Decodes the objects of ObjectMap on worker threads, each one with its own
+ * copy of dbuf and of the text decoder, then sends the entities in the same
+ * order than readDwgEntities().
+ * Polyline vertices are read while sending, because they are removed from
+ * ObjectMap by their polyline.
+ */
+bool dwgReader::readDwgEntitiesParallel(DRW_Interface& intfa, dwgBuffer *dbuf){
+    struct DecodedObject {
+        objHandle obj;
+        std::unique_ptr<DRW_Entity> entity;
+        bool ok {true};
+    };
+    std::vector<DecodedObject> objects;
+    objects.reserve(ObjectMap.size());
+    for (const auto& item: ObjectMap) {
+        objects.push_back({item.second, nullptr, true});
+    }
+
+    //workers claim chunks of objects, entity sizes differ a lot
+    constexpr size_t chunkSize = 256;
+    std::atomic<size_t> nextChunk {0};
+    auto decode = [&]() {
+        dwgBuffer buf(*dbuf);
+        DRW_TextCodec codec;
+        codec.setVersion(static_cast<DRW::Version>(decoder.getVersion()), false);
+        codec.setCodePage(decoder.getCodePage(), false);
+        for (size_t first = nextChunk.fetch_add(chunkSize); first < objects.size();
+             first = nextChunk.fetch_add(chunkSize)) {
+            const size_t last = std::min(first + chunkSize, objects.size());
+            for (size_t i = first; i < last; ++i) {
+                DecodedObject& decoded = objects[i];
+                decoded.entity = parseDwgEntity(&buf, decoded.obj, &codec, decoded.ok);
+            }
+        }
+    };
+
+    const size_t numChunks = (objects.size() + chunkSize - 1) / chunkSize;
+    const size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numChunks);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numThreads; ++i) {
+        workers.emplace_back(decode);
+    }
+    decode();
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+
+    bool ret = true;
+    for (DecodedObject& decoded: objects) {
+        auto it = ObjectMap.find(decoded.obj.handle);
+        if (it == ObjectMap.end()) {
+            continue; //already read, like vertices of a polyline
+        }
+        if (ret) {
+            // once an entity failed, just clear the ObjectMap
+            ret = decoded.ok && addDwgEntity(decoded.entity.get(), decoded.obj, intfa, dbuf);
+        }
+        decoded.entity.reset();
+        ObjectMap.erase(it);
+    }
+    return ret;
+}
+
+/**
+ * Runs the decompression of the pages of a section, on several threads when
+ * the pages write into separate parts of the section data.
+ * Stops at the first failed page.
+ */
+bool dwgReader::decompressPages(std::vector<dwgPageJob> &jobs){
+    bool parallel = parallelDecode && jobs.size() >= minParallelPages
+            && DRW_DBGGL != DRW_dbg::Level::Debug;
+    if (parallel) {
+        //overlapping pages of a broken file would depend on the order
+        std::vector<const dwgPageJob*> sorted;
+        sorted.reserve(jobs.size());
+        for (const dwgPageJob &job: jobs) {
+            sorted.push_back(&job);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const dwgPageJob *j1, const dwgPageJob *j2) {
+            return j1->out < j2->out;
+        });
+        for (size_t i = 1; i < sorted.size() && parallel; ++i) {
+            parallel = sorted[i-1]->out + sorted[i-1]->size <= sorted[i]->out;
+        }
+    }
+
+    if (!parallel) {
+        for (dwgPageJob &job: jobs) {
+            if (!job.decompress())
+                return false;
+        }
+        return true;
+    }
+
+    std::atomic<size_t> nextJob {0};
+    std::atomic<bool> ret {true};
+    auto decompress = [&]() {
+        for (size_t i = nextJob++; i < jobs.size() && ret; i = nextJob++) {
+            if (!jobs[i].decompress())
+                ret = false;
+        }
+    };
+    const size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), jobs.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numThreads; ++i) {
+        workers.emplace_back(decompress);
+    }
+    decompress();
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+    return ret;
+}
+
 /**
  * Reads a dwg drawing entity (dwg object entity) given its offset in the file
  */
 bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa){
     bool ret = true;
-    duint32 bs = 0;
 
     nextEntLink = prevEntLink = 0;// set to 0 to skip unimplemented entities
+    std::unique_ptr<DRW_Entity> e = parseDwgEntity(dbuf, obj, &decoder, ret);
+    if (ret) {
+        ret = addDwgEntity(e.get(), obj, intfa, dbuf);
+    }
+    return ret;
+}
+
+/**
+ * Decodes a dwg drawing entity given its offset in the file, without sending it.
+ * Only reads the maps of the tables, so it can run on several threads, when each
+ * one uses its own dbuf and codec.
+ * @return the entity, or nullptr for unsupported entities and objects
+ */
+std::unique_ptr<DRW_Entity> dwgReader::parseDwgEntity(dwgBuffer *dbuf, objHandle& obj,
+                                                      DRW_TextCodec *codec, bool &ret){
+    ret = true;
+    duint32 bs = 0;
+
     dbuf->setPosition(obj.loc);
     //verify if position is ok:
     if (!dbuf->isGood()){
         DRW_DBG(" Warning: readDwgEntity, bad location\n");
-        return false;
+        ret = false;
+        return nullptr;
     }
     int size = dbuf->getModularShort();
     if (version > DRW::AC1021) {//2010+
         bs = dbuf->getUModularChar();
     }
-    std::vector<duint8> tmpByteStr(size);
-    dbuf->getBytes(tmpByteStr.data(), size);
+    std::vector<duint8> tmpByteStr;
+    const duint8 *objData = dbuf->getBytesView(size, tmpByteStr);
     //verify if getBytes is ok:
     if (!dbuf->isGood()) {
         DRW_DBG(" Warning: readDwgEntity, bad size\n");
-        return false;
+        ret = false;
+        return nullptr;
     }
-    dwgBuffer buff(tmpByteStr.data(), size, &decoder);
+    dwgBuffer buff(objData, size, codec);
     dint16 oType = buff.getObjType(version);
     buff.resetPosition();
 
@@ -959,7 +1116,8 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
         auto it = classesmap.find(oType);
         if (it == classesmap.end()){//fail, not found in classes set error
             DRW_DBG("Class "); DRW_DBG(oType);DRW_DBG("not found, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
-            return false;
+            ret = false;
+            return nullptr;
         } else {
             DRW_Class *cl = it->second;
             if (cl->dwgType != 0)
@@ -968,201 +1126,236 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
     }
 
     obj.type = oType;
+    std::unique_ptr<DRW_Entity> e;
     switch (oType) {
-        case 17: {
-            DRW_Arc e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addArc(e);
-            }
-            break; }
-        case 18: {
-            DRW_Circle e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addCircle(e);
-            }
-            break; }
-        case 19:{
-            DRW_Line e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addLine(e);
-            }
-            break;}
-        case 27: {
-            DRW_Point e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addPoint(e);
-            }
-            break; }
-        case 35: {
-            DRW_Ellipse e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addEllipse(e);
-            }
-            break; }
+        case 17:
+            e = entryParse<DRW_Arc>(buff, bs, ret);
+            break;
+        case 18:
+            e = entryParse<DRW_Circle>(buff, bs, ret);
+            break;
+        case 19:
+            e = entryParse<DRW_Line>(buff, bs, ret);
+            break;
+        case 27:
+            e = entryParse<DRW_Point>(buff, bs, ret);
+            break;
+        case 35:
+            e = entryParse<DRW_Ellipse>(buff, bs, ret);
+            break;
+        case 7:
+        case 8: //minsert = 8
+            e = entryParse<DRW_Insert>(buff, bs, ret);
+            break;
+        case 77:
+            e = entryParse<DRW_LWPolyline>(buff, bs, ret);
+            break;
+        case 1:
+            e = entryParse<DRW_Text>(buff, bs, ret);
+            break;
+        case 44:
+            e = entryParse<DRW_MText>(buff, bs, ret);
+            break;
+        case 28:
+            e = entryParse<DRW_3Dface>(buff, bs, ret);
+            break;
+        case 20:
+            e = entryParse<DRW_DimOrdinate>(buff, bs, ret);
+            break;
+        case 21:
+            e = entryParse<DRW_DimLinear>(buff, bs, ret);
+            break;
+        case 22:
+            e = entryParse<DRW_DimAligned>(buff, bs, ret);
+            break;
+        case 23:
+            e = entryParse<DRW_DimAngular3p>(buff, bs, ret);
+            break;
+        case 24:
+            e = entryParse<DRW_DimAngular>(buff, bs, ret);
+            break;
+        case 25:
+            e = entryParse<DRW_DimRadial>(buff, bs, ret);
+            break;
+        case 26:
+            e = entryParse<DRW_DimDiametric>(buff, bs, ret);
+            break;
+        case 45:
+            e = entryParse<DRW_Leader>(buff, bs, ret);
+            break;
+        case 31:
+            e = entryParse<DRW_Solid>(buff, bs, ret);
+            break;
+        case 78:
+            e = entryParse<DRW_Hatch>(buff, bs, ret);
+            break;
+        case 32:
+            e = entryParse<DRW_Trace>(buff, bs, ret);
+            break;
+        case 34:
+            e = entryParse<DRW_Viewport>(buff, bs, ret);
+            break;
+        case 36:
+            e = entryParse<DRW_Spline>(buff, bs, ret);
+            break;
+        case 40:
+            e = entryParse<DRW_Ray>(buff, bs, ret);
+            break;
+        case 15:    // pline 2D
+        case 16:    // pline 3D
+        case 29:    // pline PFACE
+            e = entryParse<DRW_Polyline>(buff, bs, ret);
+            break;
+//        case 30: {
+//            DRW_Polyline e;// MESH (not pline)
+//            ENTRY_PARSE(e)
+//            intfa.addRay(e);
+//            break; }
+        case 41:
+            e = entryParse<DRW_Xline>(buff, bs, ret);
+            break;
+        case 101:
+            e = entryParse<DRW_Image>(buff, bs, ret);
+            break;
+
+        default:
+            //not supported or are object, added to remaining map by addDwgEntity()
+            break;
+    }
+    if (!ret){
+        DRW_DBG("Warning: Entity type "); DRW_DBG(oType);DRW_DBG("has failed, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
+    }
+
+    return e;
+}
+
+/**
+ * Sends an entity decoded by parseDwgEntity() to the interface,
+ * objects and unsupported entities (nullptr) are stored in objObjectMap
+ */
+bool dwgReader::addDwgEntity(DRW_Entity *ent, const objHandle& obj, DRW_Interface& intfa, dwgBuffer *dbuf){
+    if (nullptr == ent) {
+        objObjectMap[obj.handle]= obj;
+        return true;
+    }
+    nextEntLink = ent->nextEntLink;
+    prevEntLink = ent->prevEntLink;
+
+    switch (obj.type) {
+        case 17:
+            intfa.addArc(*static_cast<DRW_Arc*>(ent));
+            break;
+        case 18:
+            intfa.addCircle(*static_cast<DRW_Circle*>(ent));
+            break;
+        case 19:
+            intfa.addLine(*static_cast<DRW_Line*>(ent));
+            break;
+        case 27:
+            intfa.addPoint(*static_cast<DRW_Point*>(ent));
+            break;
+        case 35:
+            intfa.addEllipse(*static_cast<DRW_Ellipse*>(ent));
+            break;
         case 7:
         case 8: {//minsert = 8
-            DRW_Insert e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.name = findTableName(DRW::BLOCK_RECORD,
-                                       e.blockRecH.ref);//RLZ: find as block or blockrecord (ps & ps0)
-                intfa.addInsert(e);
-            }
-            break; }
-        case 77: {
-            DRW_LWPolyline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addLWPolyline(e);
-            }
+            auto e = static_cast<DRW_Insert*>(ent);
+            e->name = findTableName(DRW::BLOCK_RECORD,
+                                    e->blockRecH.ref);//RLZ: find as block or blockrecord (ps & ps0)
+            intfa.addInsert(*e);
             break; }
+        case 77:
+            intfa.addLWPolyline(*static_cast<DRW_LWPolyline*>(ent));
+            break;
         case 1: {
-            DRW_Text e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::STYLE, e.styleH.ref);
-                intfa.addText(e);
-            }
+            auto e = static_cast<DRW_Text*>(ent);
+            e->style = findTableName(DRW::STYLE, e->styleH.ref);
+            intfa.addText(*e);
             break; }
         case 44: {
-            DRW_MText e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::STYLE, e.styleH.ref);
-                intfa.addMText(e);
-            }
-            break; }
-        case 28: {
-            DRW_3Dface e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.add3dFace(e);
-            }
+            auto e = static_cast<DRW_MText*>(ent);
+            e->style = findTableName(DRW::STYLE, e->styleH.ref);
+            intfa.addMText(*e);
             break; }
+        case 28:
+            intfa.add3dFace(*static_cast<DRW_3Dface*>(ent));
+            break;
         case 20: {
-            DRW_DimOrdinate e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimOrdinate(&e);
-            }
+            auto e = static_cast<DRW_DimOrdinate*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addDimOrdinate(e);
             break; }
         case 21: {
-            DRW_DimLinear e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimLinear(&e);
-            }
+            auto e = static_cast<DRW_DimLinear*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addDimLinear(e);
             break; }
         case 22: {
-            DRW_DimAligned e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAlign(&e);
-            }
+            auto e = static_cast<DRW_DimAligned*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addDimAlign(e);
             break; }
         case 23: {
-            DRW_DimAngular3p e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAngular3P(&e);
-            }
+            auto e = static_cast<DRW_DimAngular3p*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addDimAngular3P(e);
             break; }
         case 24: {
-            DRW_DimAngular e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAngular(&e);
-            }
+            auto e = static_cast<DRW_DimAngular*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addDimAngular(e);
             break; }
         case 25: {
-            DRW_DimRadial e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimRadial(&e);
-            }
+            auto e = static_cast<DRW_DimRadial*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addDimRadial(e);
             break; }
         case 26: {
-            DRW_DimDiametric e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimDiametric(&e);
-            }
+            auto e = static_cast<DRW_DimDiametric*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addDimDiametric(e);
             break; }
         case 45: {
-            DRW_Leader e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addLeader(&e);
-            }
-            break; }
-        case 31: {
-            DRW_Solid e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addSolid(e);
-            }
-            break; }
-        case 78: {
-            DRW_Hatch e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addHatch(&e);
-            }
-            break; }
-        case 32: {
-            DRW_Trace e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addTrace(e);
-            }
-            break; }
-        case 34: {
-            DRW_Viewport e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addViewport(e);
-            }
-            break; }
-        case 36: {
-            DRW_Spline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addSpline(&e);
-            }
-            break; }
-        case 40: {
-            DRW_Ray e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addRay(e);
-            }
+            auto e = static_cast<DRW_Leader*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addLeader(e);
             break; }
+        case 31:
+            intfa.addSolid(*static_cast<DRW_Solid*>(ent));
+            break;
+        case 78:
+            intfa.addHatch(static_cast<DRW_Hatch*>(ent));
+            break;
+        case 32:
+            intfa.addTrace(*static_cast<DRW_Trace*>(ent));
+            break;
+        case 34:
+            intfa.addViewport(*static_cast<DRW_Viewport*>(ent));
+            break;
+        case 36:
+            intfa.addSpline(static_cast<DRW_Spline*>(ent));
+            break;
+        case 40:
+            intfa.addRay(*static_cast<DRW_Ray*>(ent));
+            break;
         case 15:    // pline 2D
         case 16:    // pline 3D
         case 29: {  // pline PFACE
-            DRW_Polyline e;
-            if (entryParse( e, buff, bs, ret)) {
-                readPlineVertex(e, dbuf);
-                intfa.addPolyline(e);
-            }
-            break; }
-//        case 30: {
-//            DRW_Polyline e;// MESH (not pline)
-//            ENTRY_PARSE(e)
-//            intfa.addRay(e);
-//            break; }
-        case 41: {
-            DRW_Xline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addXline(e);
-            }
-            break; }
-        case 101: {
-            DRW_Image e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addImage(&e);
-            }
+            auto e = static_cast<DRW_Polyline*>(ent);
+            readPlineVertex(*e, dbuf);
+            intfa.addPolyline(*e);
             break; }
-
+        case 41:
+            intfa.addXline(*static_cast<DRW_Xline*>(ent));
+            break;
+        case 101:
+            intfa.addImage(static_cast<DRW_Image*>(ent));
+            break;
         default:
-            //not supported or are object add to remaining map
-            objObjectMap[obj.handle]= obj;
             break;
     }
-    if (!ret){
-        DRW_DBG("Warning: Entity type "); DRW_DBG(oType);DRW_DBG("has failed, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
-    }
 
-    return ret;
+    return true;
 }
 
 bool dwgReader::readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf){
@@ -1208,15 +1401,14 @@ bool dwgReader::readDwgObject(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
         if (version > DRW::AC1021) {//2010+
             bs = dbuf->getUModularChar();
         }
-        duint8 *tmpByteStr = new duint8[size];
-        dbuf->getBytes(tmpByteStr, size);
+        std::vector<duint8> tmpByteStr;
+        const duint8 *objData = dbuf->getBytesView(size, tmpByteStr);
         //verify if getBytes is ok:
         if (!dbuf->isGood()){
             DRW_DBG(" Warning: readDwgObject, bad size\n");
-            delete[]tmpByteStr;
             return false;
         }
-        dwgBuffer buff(tmpByteStr, size, &decoder);
+        dwgBuffer buff(objData, size, &decoder);
         //oType are set parsing entities
         dint16 oType = obj.type;
 
@@ -1234,7 +1426,6 @@ bool dwgReader::readDwgObject(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
         if (!ret){
             DRW_DBG("Warning: Object type "); DRW_DBG(oType);DRW_DBG("has failed, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
         }
-        delete[]tmpByteStr;
     return ret;
 }
 
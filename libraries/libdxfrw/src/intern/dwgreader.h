@@ -13,9 +13,12 @@
 #ifndef DWGREADER_H
 #define DWGREADER_H
 
+#include <functional>
 #include <unordered_map>
 #include <list>
 #include <memory>
+#include <vector>
+#include "drw_mappedfile.h"
 #include "drw_textcodec.h"
 #include "dwgutil.h"
 #include "dwgbuffer.h"
@@ -94,6 +97,15 @@ public:
     duint64 address; //address (seek) , 2000-
 };
 
+// decompression of a page (2004+), writing into out[0, size)
+// the compressed data is read before, decompress only uses its own buffers
+class dwgPageJob {
+public:
+    duint8 *out{nullptr};
+    duint64 size{0};
+    std::function<bool()> decompress;
+};
+
 
 //! Class to handle dwg obj control entries
 /*!
@@ -128,6 +140,7 @@ public:
     virtual ~dwgReader();
 
 protected:
+    void mapFile(const std::string &fileName);
     virtual bool readMetaData() = 0;
     virtual bool readPreview(){return false;}
     virtual bool readFileHeader() = 0;
@@ -140,6 +153,8 @@ protected:
     virtual bool readDwgObjects(DRW_Interface& intfa) = 0;
 
     virtual bool readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa);
+    std::unique_ptr<DRW_Entity> parseDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_TextCodec *codec, bool &ret);
+    bool addDwgEntity(DRW_Entity *ent, const objHandle& obj, DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readDwgObject(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa);
     void parseAttribs(DRW_Entity* e);
     std::string findTableName(DRW::TTYPE table, dint32 handle);
@@ -153,8 +168,10 @@ protected:
 
     bool readDwgBlocks(DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf);
+    bool readDwgEntitiesParallel(DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf);
+    bool decompressPages(std::vector<dwgPageJob> &jobs);
 
 public:
     std::unordered_map<duint32, objHandle>ObjectMap;
@@ -172,6 +189,7 @@ public:
     duint8 maintenanceVersion{0};
 
 protected:
+    DRW_MappedFile mappedFile; //must outlive fileBuf, when it's a view of the mapping
     std::unique_ptr<dwgBuffer> fileBuf;
     dwgR *parent{nullptr};
     DRW::Version version{DRW::UNKNOWNV};
@@ -190,18 +208,22 @@ protected:
 //    duint32 blockCtrl;
     duint32 nextEntLink{0};
     duint32 prevEntLink{0};
+    //! decompress pages and decode the entities on several threads, set by dwgR
+    bool parallelDecode{false};
+    //! smaller drawings are not worth the threads
+    static constexpr size_t minParallelObjects = 2048;
+    static constexpr size_t minParallelPages = 4;
 
 private:
     template <class T>
-    bool entryParse(T &e, dwgBuffer &buff, duint32 bs, bool &ret) {
-        ret = e.parseDwg( version, &buff, bs);
-        if (ret) {
-            parseAttribs(&e);
-            nextEntLink = e.nextEntLink;
-            prevEntLink = e.prevEntLink;
+    std::unique_ptr<DRW_Entity> entryParse(dwgBuffer &buff, duint32 bs, bool &ret) {
+        std::unique_ptr<T> e{new T};
+        ret = e->parseDwg( version, &buff, bs);
+        if (!ret) {
+            return nullptr;
         }
-
-        return ret;
+        parseAttribs(e.get());
+        return e;
     }
 
 };
@@ -13,6 +13,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -113,6 +114,9 @@ bool dwgReader18::parseDataPage(const dwgSectionInfo &si/*, duint8 *dData*/){
     DRW_DBG("\nparseDataPage\n ");
     objData.reset( new duint8 [si.pageCount * si.maxSize] );
 
+    //read the pages from the file, then decompress them, maybe in parallel
+    std::vector<dwgPageJob> jobs;
+    jobs.reserve(si.pages.size());
     for (auto it=si.pages.begin(); it!=si.pages.end(); ++it){
         dwgPageInfo pi = it->second;
         if (!fileBuf->setPosition(pi.address))
@@ -151,14 +155,14 @@ bool dwgReader18::parseDataPage(const dwgSectionInfo &si/*, duint8 *dData*/){
         DRW_DBG("\n      data checksum= "); DRW_DBGH(bufHdr.getRawLong32()); DRW_DBG("\n");
 
         //get compressed data
-        std::vector<duint8> cData(pi.cSize);
+        auto cData = std::make_shared<std::vector<duint8>>(pi.cSize);
         if (!fileBuf->setPosition(pi.address + 32)) {
             return false;
         }
-        fileBuf->getBytes(cData.data(), pi.cSize);
+        fileBuf->getBytes(cData->data(), pi.cSize);
 
         //calculate checksum
-        duint32 calcsD = checksum(0, cData.data(), pi.cSize);
+        duint32 calcsD = checksum(0, cData->data(), pi.cSize);
         for (duint8 i= 24; i<28; ++i)
             hdrData[i]=0;
         duint32 calcsH = checksum(calcsD, hdrData, 32);
@@ -168,12 +172,12 @@ bool dwgReader18::parseDataPage(const dwgSectionInfo &si/*, duint8 *dData*/){
         duint8* oData = objData.get() + pi.startOffset;
         pi.uSize = si.maxSize;
         DRW_DBG("decompressing "); DRW_DBG(pi.cSize); DRW_DBG(" bytes in "); DRW_DBG(pi.uSize); DRW_DBG(" bytes\n");
-        dwgCompressor comp;
-        if (!comp.decompress18(cData.data(), oData, pi.cSize, pi.uSize)) {
-            return false;
-        }
+        jobs.push_back({oData, pi.uSize, [pi, oData, cData]() {
+            dwgCompressor comp;
+            return comp.decompress18(cData->data(), oData, pi.cSize, pi.uSize);
+        }});
     }
-    return true;
+    return decompressPages(jobs);
 }
 
 bool dwgReader18::readMetaData() {
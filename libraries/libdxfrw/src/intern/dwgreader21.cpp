@@ -13,6 +13,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -70,35 +71,26 @@ bool dwgReader21::parseSysPage(duint64 sizeCompressed, duint64 sizeUncompressed,
     std::vector<duint8> tmpDataRS(fpsize);
     dwgRSCodec::decode239I(&tmpDataRaw.front(), &tmpDataRS.front(), fpsize/255);
 
-    return dwgCompressor::decompress21(&tmpDataRS.front(), decompData, sizeCompressed, sizeUncompressed);
+    dwgCompressor comp;
+    return comp.decompress21(&tmpDataRS.front(), decompData, sizeCompressed, sizeUncompressed);
 }
 
 bool dwgReader21::parseDataPage(const dwgSectionInfo &si, duint8 *dData){
     DRW_DBG("parseDataPage, section size: "); DRW_DBG(si.size);
+    //read the pages from the file, then decode them, maybe in parallel
+    std::vector<dwgPageJob> jobs;
+    jobs.reserve(si.pages.size());
     for (auto it=si.pages.begin(); it!=si.pages.end(); ++it){
         dwgPageInfo pi = it->second;
         if (!fileBuf->setPosition(pi.address))
             return false;
 
-        std::vector<duint8> tmpPageRaw(pi.size);
-        fileBuf->getBytes(&tmpPageRaw.front(), pi.size);
+        auto tmpPageRaw = std::make_shared<std::vector<duint8>>(pi.size);
+        fileBuf->getBytes(&tmpPageRaw->front(), pi.size);
     #ifdef DRW_DBG_DUMP
         DRW_DBG("\nSection OBJECTS raw data=\n");
         for (unsigned int i=0, j=0; i< pi.size;i++) {
-            DRW_DBGH( (unsigned char)tmpPageRaw[i]);
-            if (j == 7) { DRW_DBG("\n"); j = 0;
-            } else { DRW_DBG(", "); j++; }
-        } DRW_DBG("\n");
-    #endif
-
-        std::vector<duint8> tmpPageRS(pi.size);
-
-        duint8 chunks =pi.size / 255;
-        dwgRSCodec::decode251I(&tmpPageRaw.front(), &tmpPageRS.front(), chunks);
-    #ifdef DRW_DBG_DUMP
-        DRW_DBG("\nSection OBJECTS RS data=\n");
-        for (unsigned int i=0, j=0; i< pi.size;i++) {
-            DRW_DBGH( (unsigned char)tmpPageRS[i]);
+            DRW_DBGH( (unsigned char)(*tmpPageRaw)[i]);
             if (j == 7) { DRW_DBG("\n"); j = 0;
             } else { DRW_DBG(", "); j++; }
         } DRW_DBG("\n");
@@ -107,22 +99,39 @@ bool dwgReader21::parseDataPage(const dwgSectionInfo &si, duint8 *dData){
         DRW_DBG("\npage uncomp size: "); DRW_DBG(pi.uSize); DRW_DBG(" comp size: "); DRW_DBG(pi.cSize);
         DRW_DBG("\noffset: "); DRW_DBG(pi.startOffset);
         duint8 *pageData = dData + pi.startOffset;
-        if (!dwgCompressor::decompress21(&tmpPageRS.front(), pageData, pi.cSize, pi.uSize)) {
-            return false;
-        }
-
-    #ifdef DRW_DBG_DUMP
-        DRW_DBG("\n\nSection OBJECTS decompressed data=\n");
-        for (unsigned int i=0, j=0; i< pi.uSize;i++) {
-            DRW_DBGH( (unsigned char)pageData[i]);
-            if (j == 7) { DRW_DBG("\n"); j = 0;
-            } else { DRW_DBG(", "); j++; }
-        } DRW_DBG("\n");
-    #endif
-
+        jobs.push_back({pageData, pi.uSize, [pi, pageData, tmpPageRaw]() {
+            std::vector<duint8> tmpPageRS(pi.size);
+
+            duint8 chunks =pi.size / 255;
+            dwgRSCodec::decode251I(&tmpPageRaw->front(), &tmpPageRS.front(), chunks);
+        #ifdef DRW_DBG_DUMP
+            DRW_DBG("\nSection OBJECTS RS data=\n");
+            for (unsigned int i=0, j=0; i< pi.size;i++) {
+                DRW_DBGH( (unsigned char)tmpPageRS[i]);
+                if (j == 7) { DRW_DBG("\n"); j = 0;
+                } else { DRW_DBG(", "); j++; }
+            } DRW_DBG("\n");
+        #endif
+
+            dwgCompressor comp;
+            if (!comp.decompress21(&tmpPageRS.front(), pageData, pi.cSize, pi.uSize)) {
+                return false;
+            }
+
+        #ifdef DRW_DBG_DUMP
+            DRW_DBG("\n\nSection OBJECTS decompressed data=\n");
+            for (unsigned int i=0, j=0; i< pi.uSize;i++) {
+                DRW_DBGH( (unsigned char)pageData[i]);
+                if (j == 7) { DRW_DBG("\n"); j = 0;
+                } else { DRW_DBG(", "); j++; }
+            } DRW_DBG("\n");
+        #endif
+            return true;
+        }});
     }
+    bool ret = decompressPages(jobs);
     DRW_DBG("\n");
-    return true;
+    return ret;
 }
 
 bool dwgReader21::readFileHeader() {
@@ -166,8 +175,9 @@ bool dwgReader21::readFileHeader() {
         std::vector<duint8> compByteStr(fileHdrCompLength);
         fileHdrBuf.getBytes(compByteStr.data(), fileHdrCompLength);
         fileHdrData.resize(fileHdrDataLength);
-        if (!dwgCompressor::decompress21(compByteStr.data(), &fileHdrData.front(),
-                                         fileHdrCompLength, fileHdrDataLength)) {
+        dwgCompressor comp;
+        if (!comp.decompress21(compByteStr.data(), &fileHdrData.front(),
+                               fileHdrCompLength, fileHdrDataLength)) {
             return false;
         }
     }
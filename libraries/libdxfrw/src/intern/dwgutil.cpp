@@ -85,15 +85,6 @@ void dwgRSCodec::decode251I(unsigned char *in, unsigned char *out, duint32 blk){
     }
 }
 
-duint8 *dwgCompressor::compressedBuffer {nullptr};
-duint32 dwgCompressor::compressedSize {0};
-duint32 dwgCompressor::compressedPos {0};
-bool    dwgCompressor::compressedGood {true};
-duint8 *dwgCompressor::decompBuffer {nullptr};
-duint32 dwgCompressor::decompSize {0};
-duint32 dwgCompressor::decompPos {0};
-bool    dwgCompressor::decompGood {true};
-
 duint32 dwgCompressor::twoByteOffset(duint32 *ll){
     duint32 cont = 0;
     duint8 fb = compressedByte();
@@ -36,35 +36,36 @@ public:
     bool decompress18(duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize);
     static void decrypt18Hdr(duint8 *buf, duint64 size, duint64 offset);
 //    static void decrypt18Data(duint8 *buf, duint32 size, duint32 offset);
-    static bool decompress21(duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize);
+    bool decompress21(duint8 *cbuf, duint8 *dbuf, duint64 csize, duint64 dsize);
 
 private:
     duint32 litLength18();
-    static duint32 litLength21(duint8 opCode);
-    static bool copyCompBytes21(duint32 length);
-    static void readInstructions21(duint8 &opCode, duint32 &sourceOffset, duint32 &length);
+    duint32 litLength21(duint8 opCode);
+    bool copyCompBytes21(duint32 length);
+    void readInstructions21(duint8 &opCode, duint32 &sourceOffset, duint32 &length);
 
     duint32 longCompressionOffset();
     duint32 long20CompressionOffset();
     duint32 twoByteOffset(duint32 *ll);
 
-    static duint8 compressedByte(void);
-    static duint8 compressedByte(const duint32 index);
-    static duint32 compressedHiByte(void);
-    static bool compressedInc(const dint32 inc = 1);
-    static duint8 decompByte(const duint32 index);
-    static void decompSet(const duint8 value);
-    static bool buffersGood(void);
-    static void copyBlock21(const duint32 length);
+    duint8 compressedByte(void);
+    duint8 compressedByte(const duint32 index);
+    duint32 compressedHiByte(void);
+    bool compressedInc(const dint32 inc = 1);
+    duint8 decompByte(const duint32 index);
+    void decompSet(const duint8 value);
+    bool buffersGood(void);
+    void copyBlock21(const duint32 length);
 
-    static duint8 *compressedBuffer;
-    static duint32 compressedSize;
-    static duint32 compressedPos;
-    static bool    compressedGood;
-    static duint8 *decompBuffer;
-    static duint32 decompSize;
-    static duint32 decompPos;
-    static bool    decompGood;
+    //state of the current decompression, one compressor per thread
+    duint8 *compressedBuffer {nullptr};
+    duint32 compressedSize {0};
+    duint32 compressedPos {0};
+    bool    compressedGood {true};
+    duint8 *decompBuffer {nullptr};
+    duint32 decompSize {0};
+    duint32 decompPos {0};
+    bool    decompGood {true};
 
     static const duint8 CopyOrder21_01[];
     static const duint8 CopyOrder21_02[];
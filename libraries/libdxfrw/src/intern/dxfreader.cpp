@@ -10,7 +10,9 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -95,8 +97,23 @@ bool dxfReader::readRec(int *codeData) {
         //break in binary files because the conduct is unpredictable
         return false;
 
-    return (filestr->good());
+    return isGood();
+}
+bool dxfReader::isGood() const {
+    return filestr->good();
+}
+
+unsigned long long dxfReader::getPosition() {
+    std::streamoff position = filestr->tellg();
+    return position > 0 ? static_cast<unsigned long long>(position) : 0;
 }
+
+void dxfReader::copySettings(dxfReader &src) {
+    decoder.setVersion(static_cast<DRW::Version>(src.decoder.getVersion()), true);
+    decoder.setCodePage(src.decoder.getCodePage(), true);
+    m_bIgnoreComments = src.m_bIgnoreComments;
+}
+
 int dxfReader::getHandleString(){
     int res;
 #if defined(__APPLE__)
@@ -157,7 +174,8 @@ bool dxfReaderBinary::readInt16() {
     type = INT32;
     char buffer[2];
     filestr->read(buffer,2);
-    intData = (int)((buffer[1] << 8) | buffer[0]);
+    intData = static_cast<short>((static_cast<unsigned char>(buffer[1]) << 8)
+                                 | static_cast<unsigned char>(buffer[0]));
     DRW_DBG(intData); DRW_DBG("\n");
     return (filestr->good());
 }
@@ -286,3 +304,234 @@ bool dxfReaderAscii::readBool() {
         return false;
 }
 
+namespace {
+std::string_view skipLeadingBlanks(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (std::string_view::npos == first)
+        return {};
+    text.remove_prefix(first);
+    if (!text.empty() && '+' == text.front())
+        text.remove_prefix(1);
+    return text;
+}
+
+//same results as atoi(), 0 for invalid or out of range values
+int toInt(std::string_view text) {
+    text = skipLeadingBlanks(text);
+    int value = 0;
+    if (std::from_chars(text.data(), text.data() + text.size(), value).ec != std::errc())
+        return 0;
+    return value;
+}
+
+//locale independent, like std::istringstream with the classic locale
+double toDouble(std::string_view text) {
+    text = skipLeadingBlanks(text);
+    double value = 0.0;
+#if defined(__cpp_lib_to_chars)
+    if (std::from_chars(text.data(), text.data() + text.size(), value).ec != std::errc())
+        return 0.0;
+#else
+    std::istringstream sd{std::string(text)};
+    sd.imbue(std::locale::classic());
+    if (!(sd >> value))
+        return 0.0;
+#endif
+    return value;
+}
+}
+
+std::string_view dxfReaderAsciiBuffer::readLine() {
+    if (pos >= end) {
+        good = false;
+        return {};
+    }
+    const char *first = pos;
+    const char *eol = static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+    if (nullptr == eol) {
+        //last line without line end
+        good = false;
+        eol = end;
+        pos = end;
+    } else {
+        pos = eol + 1;
+    }
+    std::string_view line(first, eol - first);
+    if (!line.empty() && '\r' == line.back())
+        line.remove_suffix(1);
+    return line;
+}
+
+const char *dxfReaderAsciiBuffer::skipEntity() {
+    while (good) {
+        const char *record = pos;
+        int code = toInt(readLine());
+        std::string_view value = readLine();
+        if (!good)
+            break;
+        if (0 == code) {
+            type = STRING;
+            strData.assign(value.data(), value.size());
+            return record;
+        }
+    }
+    return nullptr;
+}
+
+bool dxfReaderAsciiBuffer::readCode(int *code) {
+    *code = toInt(readLine());
+    DRW_DBG(*code); DRW_DBG("\n");
+    return good;
+}
+
+bool dxfReaderAsciiBuffer::readString(std::string *text) {
+    type = STRING;
+    std::string_view line = readLine();
+    text->assign(line.data(), line.size());
+    return good;
+}
+
+bool dxfReaderAsciiBuffer::readString() {
+    type = STRING;
+    std::string_view line = readLine();
+    strData.assign(line.data(), line.size());
+    DRW_DBG(strData); DRW_DBG("\n");
+    return good;
+}
+
+bool dxfReaderAsciiBuffer::readBinary() {
+    return readString();
+}
+
+bool dxfReaderAsciiBuffer::readInt16() {
+    type = INT32;
+    std::string_view line = readLine();
+    if (!good && line.empty())
+        return false;
+    intData = toInt(line);
+    DRW_DBG(intData); DRW_DBG("\n");
+    return true;
+}
+
+bool dxfReaderAsciiBuffer::readInt32() {
+    type = INT32;
+    return readInt16();
+}
+
+bool dxfReaderAsciiBuffer::readInt64() {
+    type = INT64;
+    return readInt16();
+}
+
+bool dxfReaderAsciiBuffer::readDouble() {
+    type = DOUBLE;
+    std::string_view line = readLine();
+    if (!good && line.empty())
+        return false;
+    doubleData = toDouble(line);
+    DRW_DBG(doubleData); DRW_DBG('\n');
+    return true;
+}
+
+bool dxfReaderAsciiBuffer::readBool() {
+    type = BOOL;
+    std::string_view line = readLine();
+    if (!good && line.empty())
+        return false;
+    intData = toInt(line);
+    DRW_DBG(intData); DRW_DBG("\n");
+    return true;
+}
+
+unsigned long long int dxfReaderBinaryBuffer::readBytes(size_t size) {
+    if (static_cast<size_t>(end - pos) < size) {
+        good = false;
+        pos = end;
+        return 0;
+    }
+    unsigned long long int data = 0;
+    for (size_t i = 0; i < size; ++i)
+        data |= static_cast<unsigned long long int>(static_cast<unsigned char>(pos[i])) << (8 * i);
+    pos += size;
+    return data;
+}
+
+bool dxfReaderBinaryBuffer::readCode(int *code) {
+    *code = static_cast<int>(readBytes(2));
+    DRW_DBG(*code); DRW_DBG("\n");
+    return good;
+}
+
+bool dxfReaderBinaryBuffer::readString(std::string *text) {
+    type = STRING;
+    const char *last = static_cast<const char *>(std::memchr(pos, '\0', end - pos));
+    if (nullptr == last) {
+        //unterminated string at the end, like std::getline()
+        text->assign(pos, end - pos);
+        pos = end;
+        good = false;
+        return false;
+    }
+    text->assign(pos, last - pos);
+    pos = last + 1;
+    return good;
+}
+
+bool dxfReaderBinaryBuffer::readString() {
+    bool ok = readString(&strData);
+    DRW_DBG(strData); DRW_DBG("\n");
+    return ok;
+}
+
+bool dxfReaderBinaryBuffer::readBinary() {
+    unsigned long long int chunklen = readBytes(1);
+    if (static_cast<unsigned long long int>(end - pos) < chunklen) {
+        good = false;
+        pos = end;
+        return false;
+    }
+    pos += chunklen;
+    DRW_DBG( chunklen); DRW_DBG( " byte(s) binary data bypassed\n");
+    return good;
+}
+
+bool dxfReaderBinaryBuffer::readInt16() {
+    type = INT32;
+    intData = static_cast<short>(readBytes(2));
+    DRW_DBG(intData); DRW_DBG("\n");
+    return good;
+}
+
+bool dxfReaderBinaryBuffer::readInt32() {
+    type = INT32;
+    intData = static_cast<int>(readBytes(4));
+    DRW_DBG(intData); DRW_DBG("\n");
+    return good;
+}
+
+bool dxfReaderBinaryBuffer::readInt64() {
+    type = INT64;
+    int64 = readBytes(8);
+    DRW_DBG(int64); DRW_DBG(" int64\n");
+    return good;
+}
+
+bool dxfReaderBinaryBuffer::readDouble() {
+    type = DOUBLE;
+    if (static_cast<size_t>(end - pos) < sizeof(double)) {
+        good = false;
+        pos = end;
+        return false;
+    }
+    //in memory byte order, like dxfReaderBinary
+    std::memcpy(&doubleData, pos, sizeof(double));
+    pos += sizeof(double);
+    DRW_DBG(doubleData); DRW_DBG("\n");
+    return good;
+}
+
+bool dxfReaderBinaryBuffer::readBool() {
+    intData = static_cast<signed char>(readBytes(1));
+    DRW_DBG(intData); DRW_DBG("\n");
+    return good;
+}
@@ -13,6 +13,7 @@
 #ifndef DXFREADER_H
 #define DXFREADER_H
 
+#include <string_view>
 #include "drw_textcodec.h"
 
 class dxfReader {
@@ -47,8 +48,13 @@ public:
     void setCodePage(const std::string &c){decoder.setCodePage(c, true);}
     std::string getCodePage(){ return decoder.getCodePage();}
     void setIgnoreComments(const bool bValue) {m_bIgnoreComments = bValue;}
+    //! current read position in the file
+    virtual unsigned long long getPosition();
+    //! use the same text codec and options as src, for readers of parts of the same file
+    void copySettings(dxfReader &src);
 
 protected:
+    virtual bool isGood() const;
     virtual bool readCode(int *code) = 0; //return true if successful (not EOF)
     virtual bool readString(std::string *text) = 0;
     virtual bool readString() = 0;
@@ -99,4 +105,73 @@ public:
     bool readBool() override;
 };
 
+/**
+ * ASCII dxf reader working on a file mapped into memory.
+ * Lines are tokenized in place, numbers are parsed without copying.
+ */
+class dxfReaderAsciiBuffer : public dxfReader {
+public:
+    dxfReaderAsciiBuffer(const char *data, size_t size):dxfReader(nullptr),
+        begin{data}, pos{data}, end{data + size} {skip = true; }
+    void setBuffer(const char *data, size_t size) {begin = data; pos = data; end = data + size; good = true;}
+    unsigned long long getPosition() override {return pos - begin;}
+    const char *position() const {return pos;}
+    /**
+     * Skips the records up to the next 0 group code, the start of the next entity,
+     * and reads the name of the next entity, as returned by getString().
+     * @return the end of the skipped records, nullptr at the end of the buffer
+     */
+    const char *skipEntity();
+    bool readCode(int *code) override;
+    bool readString(std::string *text) override;
+    bool readString() override;
+    bool readBinary() override;
+    bool readInt16() override;
+    bool readDouble() override;
+    bool readInt32() override;
+    bool readInt64() override;
+    bool readBool() override;
+
+protected:
+    bool isGood() const override {return good;}
+
+private:
+    //! next line without line end, sets good to false like std::getline() at the end of the buffer
+    std::string_view readLine();
+    const char *begin;
+    const char *pos;
+    const char *end;
+    bool good {true};
+};
+
+/**
+ * Binary dxf reader working on a file mapped into memory, after the sentinel.
+ */
+class dxfReaderBinaryBuffer : public dxfReader {
+public:
+    dxfReaderBinaryBuffer(const char *data, size_t size):dxfReader(nullptr),
+        begin{data}, pos{data}, end{data + size} {skip = false; }
+    unsigned long long getPosition() override {return pos - begin;}
+    bool readCode(int *code) override;
+    bool readString(std::string *text) override;
+    bool readString() override;
+    bool readBinary() override;
+    bool readInt16() override;
+    bool readInt32() override;
+    bool readInt64() override;
+    bool readDouble() override;
+    bool readBool() override;
+
+protected:
+    bool isGood() const override {return good;}
+
+private:
+    //! little endian integer of size bytes, sets good to false at the end of the buffer
+    unsigned long long int readBytes(size_t size);
+    const char *begin;
+    const char *pos;
+    const char *end;
+    bool good {true};
+};
+
 #endif // DXFREADER_H
@@ -10,9 +10,11 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <charconv>
 #include <cstdlib>
 #include <fstream>
 #include <string>
+#include <sstream>
 #include <algorithm>
 #include "dxfwriter.h"
 
@@ -91,6 +93,16 @@
     return (filestr->good());
 }*/
 
+bool dxfWriter::flush() {
+    filestr->flush();
+    return (filestr->good());
+}
+
+void dxfWriter::copySettings(dxfWriter &src) {
+    encoder.setVersion(static_cast<DRW::Version>(src.encoder.getVersion()), true);
+    encoder.setCodePage(src.encoder.getCodePage(), true);
+}
+
 bool dxfWriter::writeUtf8String(int code, std::string text) {
     std::string t = encoder.fromUtf8(text);
     return writeString(code, t);
@@ -143,6 +155,9 @@ bool dxfWriterBinary::writeString(int code, std::string text) {
 }*/
 
 bool dxfWriterBinary::writeInt16(int code, int data) {
+    //boolean flags are a single byte in binary files
+    if (code >= 290 && code < 300)
+        return writeBool(code, data != 0);
     char bufcode[2];
     char buffer[2];
     bufcode[0] =code & 0xFF;
@@ -214,7 +229,7 @@ bool dxfWriterBinary::writeBool(int code, bool data) {
     return (filestr->good());
 }
 
-dxfWriterAscii::dxfWriterAscii(std::ofstream *stream):dxfWriter(stream){
+dxfWriterAscii::dxfWriterAscii(std::ostream *stream):dxfWriter(stream){
     filestr->precision(16);
 }
 
@@ -268,3 +283,156 @@ bool dxfWriterAscii::writeBool(int code, bool data) {
     return (filestr->good());
 }
 
+namespace {
+//! the buffer is written to the stream, when it holds this many bytes
+constexpr size_t writeBufferSize {1 << 20};
+
+//! appends the integer, right aligned to width like std::ostream::width()
+template<typename T>
+void appendNumber(std::string &buffer, T value, int width) {
+    char digits[24];
+    char *last = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    int length = static_cast<int>(last - digits);
+    if (length < width)
+        buffer.append(width - length, ' ');
+    buffer.append(digits, length);
+}
+}
+
+dxfWriterBuffer::dxfWriterBuffer(std::ostream *stream):dxfWriter(stream){
+    if (nullptr != stream)
+        buffer.reserve(writeBufferSize + 4096);
+}
+
+dxfWriterBuffer::~dxfWriterBuffer() {
+    flush();
+}
+
+bool dxfWriterBuffer::commit() {
+    if (nullptr == filestr)
+        return true;
+    if (buffer.size() < writeBufferSize)
+        return (filestr->good());
+    filestr->write(buffer.data(), buffer.size());
+    buffer.clear();
+    return (filestr->good());
+}
+
+bool dxfWriterBuffer::flush() {
+    if (nullptr == filestr)
+        return true;
+    if (!buffer.empty()) {
+        filestr->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    return dxfWriter::flush();
+}
+
+bool dxfWriterBuffer::writeRaw(const char *data, size_t size) {
+    buffer.append(data, size);
+    return commit();
+}
+
+void dxfWriterAsciiBuffer::appendCode(int code) {
+    appendNumber(buffer, code, 3);
+    buffer += '\n';
+}
+
+bool dxfWriterAsciiBuffer::writeString(int code, std::string text) {
+    appendCode(code);
+    buffer += text;
+    buffer += '\n';
+    return commit();
+}
+
+bool dxfWriterAsciiBuffer::writeInt16(int code, int data) {
+    appendCode(code);
+    appendNumber(buffer, data, 5);
+    buffer += '\n';
+    return commit();
+}
+
+bool dxfWriterAsciiBuffer::writeInt32(int code, int data) {
+    return writeInt16(code, data);
+}
+
+bool dxfWriterAsciiBuffer::writeInt64(int code, unsigned long long int data) {
+    appendCode(code);
+    appendNumber(buffer, data, 5);
+    buffer += '\n';
+    return commit();
+}
+
+bool dxfWriterAsciiBuffer::writeDouble(int code, double data) {
+    appendCode(code);
+#if defined(__cpp_lib_to_chars)
+    char digits[32];
+    char *last = std::to_chars(digits, digits + sizeof(digits), data).ptr;
+    buffer.append(digits, last - digits);
+#else
+    std::ostringstream sd;
+    sd.imbue(std::locale::classic());
+    sd.precision(16);
+    sd << data;
+    buffer += sd.str();
+#endif
+    buffer += '\n';
+    return commit();
+}
+
+//saved as int or add a bool member??
+bool dxfWriterAsciiBuffer::writeBool(int code, bool data) {
+    appendNumber(buffer, code, 0);
+    buffer += '\n';
+    buffer += data ? '1' : '0';
+    buffer += '\n';
+    return commit();
+}
+
+void dxfWriterBinaryBuffer::appendBytes(unsigned long long int data, int size) {
+    for (int i = 0; i < size; ++i) {
+        buffer += static_cast<char>(data & 0xFF);
+        data >>= 8;
+    }
+}
+
+bool dxfWriterBinaryBuffer::writeString(int code, std::string text) {
+    appendBytes(code, 2);
+    buffer += text;
+    buffer += '\0';
+    return commit();
+}
+
+bool dxfWriterBinaryBuffer::writeInt16(int code, int data) {
+    //boolean flags are a single byte in binary files
+    if (code >= 290 && code < 300)
+        return writeBool(code, data != 0);
+    appendBytes(code, 2);
+    appendBytes(static_cast<unsigned int>(data), 2);
+    return commit();
+}
+
+bool dxfWriterBinaryBuffer::writeInt32(int code, int data) {
+    appendBytes(code, 2);
+    appendBytes(static_cast<unsigned int>(data), 4);
+    return commit();
+}
+
+bool dxfWriterBinaryBuffer::writeInt64(int code, unsigned long long int data) {
+    appendBytes(code, 2);
+    appendBytes(data, 8);
+    return commit();
+}
+
+bool dxfWriterBinaryBuffer::writeDouble(int code, double data) {
+    appendBytes(code, 2);
+    //in memory byte order, like dxfWriterBinary
+    buffer.append(reinterpret_cast<const char *>(&data), sizeof(double));
+    return commit();
+}
+
+bool dxfWriterBinaryBuffer::writeBool(int code, bool data) {
+    appendBytes(code, 2);
+    buffer += static_cast<char>(data);
+    return commit();
+}
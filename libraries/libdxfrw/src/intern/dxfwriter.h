@@ -13,11 +13,13 @@
 #ifndef DXFWRITER_H
 #define DXFWRITER_H
 
+#include <string>
+#include <vector>
 #include "drw_textcodec.h"
 
 class dxfWriter {
 public:
-    dxfWriter(std::ofstream *stream){filestr = stream; /*count =0;*/}
+    dxfWriter(std::ostream *stream){filestr = stream; /*count =0;*/}
     virtual ~dxfWriter() = default;
     virtual bool writeString(int code, std::string text) = 0;
     bool writeUtf8String(int code, std::string text);
@@ -28,18 +30,22 @@ public:
     virtual bool writeInt64(int code, unsigned long long int data) = 0;
     virtual bool writeDouble(int code, double data) = 0;
     virtual bool writeBool(int code, bool data) = 0;
+    //! write buffered data to the stream
+    virtual bool flush();
     void setVersion(const std::string &v, bool dxfFormat){encoder.setVersion(v, dxfFormat);}
     void setCodePage(const std::string &c){encoder.setCodePage(c, true);}
     std::string getCodePage(){return encoder.getCodePage();}
+    //! copy the codec settings of another writer, to write parts of the same file
+    void copySettings(dxfWriter &src);
 protected:
-    std::ofstream *filestr = nullptr;
+    std::ostream *filestr = nullptr;
 private:
     DRW_TextCodec encoder;
 };
 
 class dxfWriterBinary : public dxfWriter {
 public:
-    dxfWriterBinary(std::ofstream *stream):dxfWriter(stream){}
+    dxfWriterBinary(std::ostream *stream):dxfWriter(stream){}
     bool writeString(int code, std::string text) override;
     bool writeInt16(int code, int data) override;
     bool writeInt32(int code, int data) override;
@@ -50,7 +56,7 @@ public:
 
 class dxfWriterAscii : public dxfWriter {
 public:
-    dxfWriterAscii(std::ofstream *stream);
+    dxfWriterAscii(std::ostream *stream);
     bool writeString(int code, std::string text) override;
     bool writeInt16(int code, int data) override;
     bool writeInt32(int code, int data) override;
@@ -59,4 +65,70 @@ public:
     bool writeBool(int code, bool data) override;
 };
 
+/**
+ * Base of the dxf writers formatting into a large memory buffer, which is
+ * written to the stream in big blocks.
+ */
+class dxfWriterBuffer : public dxfWriter {
+public:
+    dxfWriterBuffer(std::ostream *stream);
+    ~dxfWriterBuffer() override;
+    bool flush() override;
+
+    /*! without a stream, all the data is kept in memory. Entity handles
+     * are not known yet in this case, markHandle() records their positions */
+    void markHandle() {handleMarks.push_back(buffer.size());}
+    const std::string &getData() const {return buffer;}
+    const std::vector<size_t> &getHandleMarks() const {return handleMarks;}
+    //! appends already formatted data
+    bool writeRaw(const char *data, size_t size);
+
+protected:
+    //! writes the buffer to the stream, once it's full
+    bool commit();
+    std::string buffer;
+
+private:
+    std::vector<size_t> handleMarks;
+};
+
+/**
+ * ASCII dxf writer formatting into a memory buffer. Numbers are formatted
+ * locale independent, doubles with the shortest representation which reads
+ * back to the same value.
+ * The output matches dxfWriterAscii, except for the digits of doubles.
+ */
+class dxfWriterAsciiBuffer : public dxfWriterBuffer {
+public:
+    dxfWriterAsciiBuffer(std::ostream *stream):dxfWriterBuffer(stream){}
+    bool writeString(int code, std::string text) override;
+    bool writeInt16(int code, int data) override;
+    bool writeInt32(int code, int data) override;
+    bool writeInt64(int code, unsigned long long int data) override;
+    bool writeDouble(int code, double data) override;
+    bool writeBool(int code, bool data) override;
+
+private:
+    //! right aligned group code, as dxfWriterAscii writes them
+    void appendCode(int code);
+};
+
+/**
+ * Binary dxf writer formatting into a memory buffer, the output matches dxfWriterBinary.
+ */
+class dxfWriterBinaryBuffer : public dxfWriterBuffer {
+public:
+    dxfWriterBinaryBuffer(std::ostream *stream):dxfWriterBuffer(stream){}
+    bool writeString(int code, std::string text) override;
+    bool writeInt16(int code, int data) override;
+    bool writeInt32(int code, int data) override;
+    bool writeInt64(int code, unsigned long long int data) override;
+    bool writeDouble(int code, double data) override;
+    bool writeBool(int code, bool data) override;
+
+private:
+    //! little endian integer of size bytes
+    void appendBytes(unsigned long long int data, int size);
+};
+
 #endif // DXFWRITER_H
@@ -43,6 +43,7 @@ RScodec::RScodec(unsigned int pp, int mm, int tt) {
     RSgenerate_gf(pp) ;
     /* compute the generator polynomial for this RS code */
     RSgen_poly() ;
+    RSgen_syndrome_tables();
 }
 
 RScodec::~RScodec() {
@@ -111,38 +112,29 @@ void RScodec::RSgen_poly() {
     for (i=0; i<=bb; i++)  gg[i] = index_of[gg[i]] ;
 }
 
-int RScodec::calcDecode(unsigned char* data, int* recd, int** elp, int* d, int* l, int* u_lu, int* s, int* root, int* loc, int* z, int* err, int* reg, int bb)
+/* tables to multiply by alpha**i, i=1..2*tt, to evaluate the syndromes
+   with Horner's rule: one lookup and one xor per symbol and syndrome
+*/
+void RScodec::RSgen_syndrome_tables() {
+    int bb = nn-kk; //nn-kk length of parity data
+
+    mulAlpha.resize(bb * (nn+1));
+    synd.resize(bb + 1);
+    for (int i = 1; i <= bb; i++) {
+        unsigned char *tab = &mulAlpha[(i-1) * (nn+1)];
+        tab[0] = 0;
+        for (int x = 1; x <= nn; x++)
+            tab[x] = alpha_to[(index_of[x] + i) % nn];
+    }
+}
+
+/* s[] holds the syndromes in index form, at least one is not zero */
+int RScodec::calcDecode(unsigned char* data, int** elp, int* d, int* l, int* u_lu, int* s, int* root, int* loc, int* z, int* err, int* reg, int bb)
 {
     if (!isOk) return -1;
     int count = 0;
-    int syn_error = 0;
     int i, j, u, q;
 
-    //    for (int i=0; i<nn; i++)
-    //       recd[i] = index_of[recd[i]] ;          /* put recd[i] into index form */
-    for (int i = 0, j = bb; i<kk; i++, j++)
-        recd[j] = index_of[data[j]];          /* put data in recd[i] into index form */
-    for (int i = kk, j = 0; i<nn; i++, j++)
-        recd[j] = index_of[data[j]];          /* put data in recd[i] into index form */
-
-    /* first form the syndromes */
-    for (i = 1; i <= bb; i++) {
-        s[i] = 0;
-        for (j = 0; j<nn; j++) {
-            if (recd[j] != -1) {
-                s[i] ^= alpha_to[(recd[j] + i*j) % nn];      /* recd[j] in index form */
-            }
-        }
-        /* convert syndrome from polynomial form to index form  */
-        if (s[i] != 0)  syn_error = 1;        /* set flag if non-zero syndrome => error */
-        s[i] = index_of[s[i]];
-    }
-
-    if (!syn_error) {      /* if no errors, ends */
-        /* no non-zero syndromes => no errors: output is received codeword */
-        return 0;
-    }
-
     /* errors are present, try and correct */
     /* compute the error location polynomial via the Berlekamp iterative algorithm,
     following the terminology of Lin and Costello :   d[u] is the 'mu'th
@@ -367,7 +359,24 @@ int RScodec::decode(unsigned char *data) {
     if (!isOk) return -1;
     int bb = nn-kk;; //nn-kk length of parity data
 
-    int *recd = new (std::nothrow) int[nn];
+    /* first form the syndromes, s[i] = data(alpha**i) in polynomial form */
+    unsigned char *syn = synd.data();
+    for (int i = 1; i <= bb; i++)
+        syn[i] = 0;
+    for (int j = nn-1; j >= 0; j--) {
+        const unsigned char c = data[j];
+        const unsigned char *tab = mulAlpha.data();
+        for (int i = 1; i <= bb; i++, tab += nn+1)
+            syn[i] = tab[syn[i]] ^ c;
+    }
+    bool syn_error = false;
+    for (int i = 1; i <= bb; i++)
+        syn_error = syn_error || syn[i] != 0;
+    if (!syn_error) {      /* if no errors, ends */
+        /* no non-zero syndromes => no errors: output is received codeword */
+        return 0;
+    }
+
     int **elp = new int*[bb + 2];
     for (int i = 0; i < bb + 2; ++i)
         elp[i] = new int[bb];
@@ -381,9 +390,11 @@ int RScodec::decode(unsigned char *data) {
     int *err = new int[nn];
     int *reg = new int[tt + 1];
 
-    int res = calcDecode(data, recd, elp ,d ,l, u_lu, s, root, loc ,z, err, reg, bb);
+    /* convert syndromes from polynomial form to index form  */
+    for (int i = 1; i <= bb; i++)
+        s[i] = index_of[syn[i]];
+    int res = calcDecode(data, elp ,d ,l, u_lu, s, root, loc ,z, err, reg, bb);
 
-    delete[] recd;
     for (int i = 0; i < bb + 2; ++i)
         delete[] elp[i];
     delete[] elp;
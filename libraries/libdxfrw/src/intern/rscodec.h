@@ -28,6 +28,9 @@
 
 #ifndef RSCODEC_H
 #define RSCODEC_H
+
+#include <vector>
+
 /**
 mm: RS code over GF(2^4)
 nn: nn= (2^mm) - 1   length of codeword
@@ -51,7 +54,8 @@ public:
 private:
     void RSgenerate_gf(unsigned int pp);
     void RSgen_poly();
-    int calcDecode(unsigned char* data, int* recd, int** elp, int* d, int* l, int* u_lu, int* s, int* root, int* loc, int* z, int* err, int* reg, int bb);
+    void RSgen_syndrome_tables();
+    int calcDecode(unsigned char* data, int** elp, int* d, int* l, int* u_lu, int* s, int* root, int* loc, int* z, int* err, int* reg, int bb);
 
     int mm; //RS code over GF(2^4)
     int tt; //number of errors that can be corrected
@@ -62,6 +66,10 @@ private:
     bool isOk;
     unsigned int *index_of;
     int *alpha_to;
+    //multiplication by alpha**i in polynomial form, nn+1 entries for each syndrome i=1..2*tt
+    std::vector<unsigned char> mulAlpha;
+    //syndromes of the current codeword, in polynomial form
+    std::vector<unsigned char> synd;
 };
 
 #endif // RSCODEC_H
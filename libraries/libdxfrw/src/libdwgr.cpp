@@ -142,6 +142,7 @@ bool dwgR::read(DRW_Interface *interface_, bool ext){
     if (!isOk)
         return false;
 
+    reader->parallelDecode = parallel;
     isOk = reader->readMetaData();
     if (isOk) {
         isOk = reader->readFileHeader();
@@ -248,8 +249,10 @@ bool dwgR::openFile(std::ifstream *filestr){
     if (!reader) {
         error = DRW::BAD_VERSION;
         filestr->close();
-    } else
+    } else {
+        reader->mapFile(fileName);
         isOk = true;
+    }
 
     return isOk;
 }
@@ -315,6 +318,20 @@ bool dwgR::processDwg() {
         iface->addAppId(const_cast<DRW_AppId&>(*ly));
     }
 
+    if (probe) {
+        //send the block names from the block records, without parsing blocks
+        for (auto it=reader->blockRecordmap.begin(); it!=reader->blockRecordmap.end(); ++it) {
+            DRW_Block_Record *bkr = it->second;
+            DRW_Block bk;
+            bk.name = bkr->name;
+            bk.basePoint = bkr->basePoint;
+            bk.flags = bkr->flags;
+            iface->addBlock(bk);
+            iface->endBlock();
+        }
+        return ret;
+    }
+
     ret2 = reader->readDwgBlocks(*iface);
     if (ret && !ret2) {
         error = DRW::BAD_READ_BLOCKS;
@@ -35,6 +35,12 @@ public:
     DRW::error getError(){return error;}
 bool testReader();
     void setDebug(DRW::DebugLevel lvl);
+    /** read only the header, the tables and the names of blocks, like dxfRW::setProbe() */
+    void setProbe(bool b) {probe = b;}
+    /** decompress the sections and decode the entities of big drawings on
+     * several threads, the interface is still called from the reading thread,
+     * in the same order. R13 to R2000 entities need a memory mapped file */
+    void setParallel(bool b) {parallel = b;}
 
 private:
     bool openFile(std::ifstream *filestr);
@@ -46,6 +52,8 @@ private:
     DRW::error error { DRW::BAD_NONE };
     std::string fileName;
     bool applyExt { false }; /*apply extrusion in entities to conv in 2D?*/
+    bool probe { false };
+    bool parallel { false };
     std::string codePage;
     DRW_Interface *iface { nullptr };
     std::unique_ptr< dwgReader > reader;
@@ -15,9 +15,14 @@
 #include "libdxfrw.h"
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <sstream>
 #include <cassert>
+#include <thread>
+#include "intern/drw_compressedfile.h"
 #include "intern/drw_textcodec.h"
+#include "intern/drw_mappedfile.h"
 #include "intern/dxfreader.h"
 #include "intern/dxfwriter.h"
 #include "intern/drw_dbg.h"
@@ -42,6 +47,25 @@ dxfRW::dxfRW(const char* name){
     applyExt = false;
     elParts = 128; //parts number when convert ellipse to polyline
 }
+
+dxfRW::dxfRW(const dxfRW &parent, dxfWriterBuffer *buffer):
+    version{parent.version},
+    fileName{parent.fileName},
+    binFile{parent.binFile},
+    writer{buffer},
+    iface{parent.iface},
+    wlayer0{parent.wlayer0},
+    dimstyleStd{parent.dimstyleStd},
+    applyExt{parent.applyExt},
+    writingBlock{parent.writingBlock},
+    elParts{parent.elParts},
+    blockMap{parent.blockMap},
+    textStyleMap{parent.textStyleMap},
+    currHandle{parent.currHandle},
+    handleBuffer{buffer}
+{
+}
+
 dxfRW::~dxfRW(){
     if (reader != NULL)
         delete reader;
@@ -67,6 +91,8 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
     drw_assert(fileName.empty() == false);
     applyExt = ext;
     std::ifstream filestr;
+    DRW_MappedFile mappedFile;
+    DRW_CompressedFile compressedFile;
     if (nullptr == interface_) {
         return setError(DRW::BAD_UNKNOWN);
     }
@@ -82,20 +108,52 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
     line2[20] = (char)26;
     line2[21] = '\0';
     filestr.read (line, 22);
+    const DRW_Compression::Codec codec = DRW_Compression::detect(line, static_cast<size_t>(filestr.gcount()));
+    filestr.clear();
+    filestr.seekg (0, std::ios::end);
+    std::streamoff endPos = filestr.tellg();
+    fileSize = endPos > 0 ? static_cast<unsigned long long>(endPos) : 0;
+    progressCount = 0;
     filestr.close();
     iface = interface_;
     DRW_DBG("dxfRW::read 2\n");
-    if (strncmp(line, line2, 21) == 0) {
-        filestr.open (fileName.c_str(), std::ios_base::in | std::ios::binary);
+    if (DRW_Compression::Codec::None != codec) {
+        // decompressed while the file is read, then tokenized in place
+        if (!compressedFile.open(fileName, codec))
+            return setError(DRW::BAD_OPEN);
+        fileSize = compressedFile.size();
+        binFile = compressedFile.size() >= 22 && strncmp(compressedFile.data(), line2, 21) == 0;
+        if (binFile) {
+            //skip sentinel
+            reader = new dxfReaderBinaryBuffer(compressedFile.data() + 22, compressedFile.size() - 22);
+            DRW_DBG("dxfRW::read compressed binary file\n");
+        } else {
+            reader = new dxfReaderAsciiBuffer(compressedFile.data(), compressedFile.size());
+            DRW_DBG("dxfRW::read compressed ascii file\n");
+        }
+    } else if (strncmp(line, line2, 21) == 0) {
         binFile = true;
-        //skip sentinel
-        filestr.seekg (22, std::ios::beg);
-        reader = new dxfReaderBinary(&filestr);
-        DRW_DBG("dxfRW::read binary file\n");
+        if (mappedFile.open(fileName) && mappedFile.size() >= 22) {
+            //skip sentinel
+            reader = new dxfReaderBinaryBuffer(mappedFile.data() + 22, mappedFile.size() - 22);
+            DRW_DBG("dxfRW::read mapped binary file\n");
+        } else {
+            filestr.open (fileName.c_str(), std::ios_base::in | std::ios::binary);
+            //skip sentinel
+            filestr.seekg (22, std::ios::beg);
+            reader = new dxfReaderBinary(&filestr);
+            DRW_DBG("dxfRW::read binary file\n");
+        }
     } else {
         binFile = false;
-        filestr.open (fileName.c_str(), std::ios_base::in);
-        reader = new dxfReaderAscii(&filestr);
+        if (mappedFile.open(fileName)) {
+            // tokenize in place, avoids the stream overhead for each line
+            reader = new dxfReaderAsciiBuffer(mappedFile.data(), mappedFile.size());
+            DRW_DBG("dxfRW::read mapped ascii file\n");
+        } else {
+            filestr.open (fileName.c_str(), std::ios_base::in);
+            reader = new dxfReaderAscii(&filestr);
+        }
     }
 
     bool isOk {processDxf()};
@@ -107,20 +165,42 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
 }
 
 bool dxfRW::write(DRW_Interface *interface_, DRW::Version ver, bool bin){
-    bool isOk = false;
+    // .dxf.gz and .dxf.zst files are compressed while they're written
+    const DRW_Compression::Codec codec = DRW_Compression::fromFileName(fileName);
+    if (!DRW_Compression::isAvailable(codec))
+        return setError(DRW::BAD_OPEN);
     std::ofstream filestr;
+    if (bin || DRW_Compression::Codec::None != codec)
+        filestr.open (fileName.c_str(), std::ios_base::out | std::ios::binary | std::ios::trunc);
+    else
+        filestr.open (fileName.c_str(), std::ios_base::out | std::ios::trunc);
+    if (!filestr.is_open())
+        return setError(DRW::BAD_OPEN);
+    if (DRW_Compression::Codec::None != codec) {
+        DRW_CompressingBuffer buffer(&filestr, codec);
+        std::ostream stream(&buffer);
+        bool isOk = buffer.isValid() && write(stream, interface_, ver, bin);
+        isOk = buffer.finish() && isOk;
+        filestr.close();
+        return isOk && !filestr.fail();
+    }
+    bool isOk = write(filestr, interface_, ver, bin);
+    filestr.close();
+    return isOk && !filestr.fail();
+}
+
+bool dxfRW::write(std::ostream &filestr, DRW_Interface *interface_, DRW::Version ver, bool bin){
+    bool isOk = false;
     version = ver;
     binFile = bin;
     iface = interface_;
     if (binFile) {
-        filestr.open (fileName.c_str(), std::ios_base::out | std::ios::binary | std::ios::trunc);
         //write sentinel
         filestr << "AutoCAD Binary DXF\r\n" << (char)26 << '\0';
-        writer = new dxfWriterBinary(&filestr);
+        writer = new dxfWriterBinaryBuffer(&filestr);
         DRW_DBG("dxfRW::read binary file\n");
     } else {
-        filestr.open (fileName.c_str(), std::ios_base::out | std::ios::trunc);
-        writer = new dxfWriterAscii(&filestr);
+        writer = new dxfWriterAsciiBuffer(&filestr);
         std::string comm = std::string("dxfrw ") + std::string(DRW_VERSION);
         writer->writeString(999, comm);
     }
@@ -156,17 +236,46 @@ bool dxfRW::write(DRW_Interface *interface_, DRW::Version ver, bool bin){
         writer->writeString(0, "ENDSEC");
     }
     writer->writeString(0, "EOF");
+    writer->flush();
     filestr.flush();
-    filestr.close();
-    isOk = true;
+    isOk = !filestr.fail();
     delete writer;
     writer = NULL;
     return isOk;
 }
 
+std::unique_ptr<dxfRW> dxfRW::createEntityBuffer() {
+    if (nullptr == dynamic_cast<dxfWriterBuffer*>(writer))
+        return nullptr;
+    dxfWriterBuffer *buffer = nullptr;
+    if (binFile)
+        buffer = new dxfWriterBinaryBuffer(nullptr);
+    else
+        buffer = new dxfWriterAsciiBuffer(nullptr);
+    buffer->copySettings(*writer);
+    return std::unique_ptr<dxfRW>(new dxfRW(*this, buffer));
+}
+
+bool dxfRW::appendEntityBuffer(dxfRW &entities) {
+    auto *mainWriter = dynamic_cast<dxfWriterBuffer*>(writer);
+    if (nullptr == mainWriter || nullptr == entities.handleBuffer)
+        return setError(DRW::BAD_UNKNOWN);
+    const std::string &data = entities.handleBuffer->getData();
+    size_t done = 0;
+    for (size_t mark : entities.handleBuffer->getHandleMarks()) {
+        mainWriter->writeRaw(data.data() + done, mark - done);
+        mainWriter->writeString(5, toHexStr(++entCount));
+        done = mark;
+    }
+    return mainWriter->writeRaw(data.data() + done, data.size() - done);
+}
+
 bool dxfRW::writeEntity(DRW_Entity *ent) {
     ent->handle = ++entCount;
-    writer->writeString(5, toHexStr(ent->handle));
+    if (nullptr != handleBuffer)
+        handleBuffer->markHandle(); //the handle is assigned by appendEntityBuffer()
+    else
+        writer->writeString(5, toHexStr(ent->handle));
     if (version > DRW::AC1009) {
         writer->writeString(100, "AcDbEntity");
     }
@@ -803,7 +912,7 @@ bool dxfRW::writeLWPolyline(DRW_LWPolyline *ent){
         if (ent->thickness != 0)
             writer->writeDouble(39, ent->thickness);
         for (int i = 0;  i< ent->vertexnum; i++){
-            auto& v = ent->vertlist.at(i);
+            const DRW_Vertex2D* v = &ent->vertlist.at(i);
             writer->writeDouble(10, v->x);
             writer->writeDouble(20, v->y);
             if (v->stawidth != 0)
@@ -864,7 +973,7 @@ bool dxfRW::writePolyline(DRW_Polyline *ent) {
 
     int vertexnum = ent->vertlist.size();
     for (int i = 0;  i< vertexnum; i++){
-        DRW_Vertex *v = ent->vertlist.at(i).get();
+        DRW_Vertex *v = &ent->vertlist.at(i);
         writer->writeString(0, "VERTEX");
         writeEntity(ent);
         if (version > DRW::AC1009)
@@ -938,10 +1047,10 @@ bool dxfRW::writeSpline(DRW_Spline *ent){
             writer->writeDouble(41, ent->weightlist.at(i));
         }
         for (int i = 0;  i< ent->ncontrol; i++){
-            auto crd = ent->controllist.at(i);
-            writer->writeDouble(10, crd->x);
-            writer->writeDouble(20, crd->y);
-            writer->writeDouble(30, crd->z);
+            const DRW_Coord& crd = ent->controllist.at(i);
+            writer->writeDouble(10, crd.x);
+            writer->writeDouble(20, crd.y);
+            writer->writeDouble(30, crd.z);
         }
     } else {
         //RLZ: TODO convert spline in polyline (not exist in acad 12)
@@ -1411,7 +1520,7 @@ bool dxfRW::writeBlock(DRW_Block *bk){
     if(version >= DRW::AC1014) {
         writeAppData(bk->appData);
     }
-    writer->writeString(1, "");
+    writer->writeUtf8String(1, bk->xrefPath);
 
     return true;
 }
@@ -1933,6 +2042,10 @@ bool dxfRW::processDxf() {
                     processed = processBlocks();
                 }
                 else if ("ENTITIES" == sectionname) {
+                    if (probe) {
+                        DRW_DBG("probe finished before entities\n");
+                        return true;
+                    }
                     processed = processEntities(false);
                 }
                 else if ("OBJECTS" == sectionname) {
@@ -2260,6 +2373,15 @@ bool dxfRW::processBlock() {
             if (nextentity == "ENDBLK") {
                 iface->endBlock();
                 return true;  //found ENDBLK, terminate
+            } else if (probe) {
+                //skip the block content
+                while (reader->readRec(&code)) {
+                    if (0 == code && "ENDBLK" == reader->getString()) {
+                        iface->endBlock();
+                        return true;
+                    }
+                }
+                return setError(DRW::BAD_READ_BLOCKS);
             } else {
                 processEntities(true);
                 iface->endBlock();
@@ -2278,9 +2400,60 @@ bool dxfRW::processBlock() {
 
 /********* Entities Section *********/
 
+namespace {
+//! entities which don't depend on the following records, parsed by processEntitiesParallel()
+std::unique_ptr<DRW_Entity> createParallelEntity(const std::string &name) {
+    if (name == "POINT")
+        return std::make_unique<DRW_Point>();
+    if (name == "LINE")
+        return std::make_unique<DRW_Line>();
+    if (name == "CIRCLE")
+        return std::make_unique<DRW_Circle>();
+    if (name == "ARC")
+        return std::make_unique<DRW_Arc>();
+    if (name == "ELLIPSE")
+        return std::make_unique<DRW_Ellipse>();
+    if (name == "TRACE")
+        return std::make_unique<DRW_Trace>();
+    if (name == "SOLID")
+        return std::make_unique<DRW_Solid>();
+    if (name == "INSERT")
+        return std::make_unique<DRW_Insert>();
+    if (name == "LWPOLYLINE")
+        return std::make_unique<DRW_LWPolyline>();
+    if (name == "TEXT")
+        return std::make_unique<DRW_Text>();
+    if (name == "MTEXT")
+        return std::make_unique<DRW_MText>();
+    if (name == "HATCH")
+        return std::make_unique<DRW_Hatch>();
+    if (name == "SPLINE")
+        return std::make_unique<DRW_Spline>();
+    if (name == "3DFACE")
+        return std::make_unique<DRW_3Dface>();
+    if (name == "LEADER")
+        return std::make_unique<DRW_Leader>();
+    if (name == "RAY")
+        return std::make_unique<DRW_Ray>();
+    if (name == "XLINE")
+        return std::make_unique<DRW_Xline>();
+    return nullptr;
+}
+
+//! the number of entities scanned ahead and parsed at once
+constexpr size_t parallelBatchSize {16384};
+//! the number of entities claimed at once by a worker thread
+constexpr size_t parallelChunkSize {64};
+}
+
 bool dxfRW::processEntities(bool isblock) {
     DRW_DBG("dxfRW::processEntities\n");
     int code;
+    // debug output isn't thread safe
+    dxfReaderAsciiBuffer *bufReader {nullptr};
+    if (parallelEntities && DRW_dbg::Level::None == DRW_DBGGL)
+        bufReader = dynamic_cast<dxfReaderAsciiBuffer *>(reader);
+
     if (!reader->readRec(&code)){
         return setError(DRW::BAD_READ_ENTITIES);
     }
@@ -2293,9 +2466,15 @@ bool dxfRW::processEntities(bool isblock) {
 
     bool processed {false};
     do {
+        if (!reportProgress(1)) {
+            return setError(DRW::BAD_CANCELED);
+        }
         if (nextentity == "ENDSEC" || nextentity == "ENDBLK") {
             return true;  //found ENDSEC or ENDBLK terminate
         }
+        else if (nullptr != bufReader && createParallelEntity(nextentity)) {
+            processed = processEntitiesParallel(bufReader);
+        }
         else if (nextentity == "POINT") {
             processed = processPoint();
         } else if (nextentity == "LINE") {
@@ -2353,6 +2532,159 @@ bool dxfRW::processEntities(bool isblock) {
     return setError(DRW::BAD_READ_ENTITIES);
 }
 
+/**
+ * Scans ahead the consecutive entities, which createParallelEntity() supports,
+ * parses them on worker threads, and adds them to the interface in file order.
+ */
+bool dxfRW::processEntitiesParallel(dxfReaderAsciiBuffer *bufReader) {
+    struct Record {
+        std::unique_ptr<DRW_Entity> entity;
+        const char *first;
+        const char *last;
+        bool parsed;
+    };
+    std::vector<Record> records;
+    bool endOfFile {false};
+    while (records.size() < parallelBatchSize) {
+        std::unique_ptr<DRW_Entity> ent {createParallelEntity(nextentity)};
+        if (!ent)
+            break;
+        const char *first {bufReader->position()};
+        const char *last {bufReader->skipEntity()};
+        if (nullptr == last) {
+            endOfFile = true;
+            break;
+        }
+        nextentity = bufReader->getString();
+        records.push_back({std::move(ent), first, last, false});
+    }
+
+    std::atomic<size_t> nextRecord {0};
+    auto parseRecords = [this, bufReader, &records, &nextRecord]() {
+        dxfReaderAsciiBuffer entReader(nullptr, 0);
+        entReader.copySettings(*bufReader);
+        for (size_t i = nextRecord.fetch_add(parallelChunkSize); i < records.size();
+             i = nextRecord.fetch_add(parallelChunkSize)) {
+            size_t chunkEnd {std::min(records.size(), i + parallelChunkSize)};
+            for (; i < chunkEnd; ++i) {
+                Record &rec = records[i];
+                entReader.setBuffer(rec.first, rec.last - rec.first);
+                DRW_Entity *ent = rec.entity.get();
+                int code;
+                rec.parsed = true;
+                while (entReader.readRec(&code)) {
+                    if (!ent->parseCode(code, &entReader)) {
+                        rec.parsed = false;
+                        break;
+                    }
+                }
+                // as done by the sequential processXXX() methods
+                switch (ent->eType) {
+                case DRW::MTEXT:
+                    static_cast<DRW_MText *>(ent)->updateAngle();
+                    break;
+                case DRW::CIRCLE:
+                case DRW::ARC:
+                case DRW::ELLIPSE:
+                case DRW::TRACE:
+                case DRW::SOLID:
+                case DRW::LWPOLYLINE:
+                    if (applyExt)
+                        ent->applyExtrusion();
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+    };
+
+    size_t threadCount {std::min<size_t>(std::thread::hardware_concurrency(),
+                                         records.size() / (4 * parallelChunkSize))};
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threadCount; ++i)
+        workers.emplace_back(parseRecords);
+    parseRecords();
+    for (std::thread &worker : workers)
+        worker.join();
+
+    for (Record &rec : records) {
+        if (!rec.parsed)
+            return setError(DRW::BAD_CODE_PARSED);
+        addParsedEntity(rec.entity.get());
+        if (!reportProgress(1))
+            return setError(DRW::BAD_CANCELED);
+    }
+
+    return endOfFile ? setError(DRW::BAD_READ_ENTITIES) : true;
+}
+
+bool dxfRW::reportProgress(size_t entities) {
+    progressCount += entities;
+    if (progressCount < 256)
+        return true;
+    progressCount = 0;
+    return iface->readProgress(reader->getPosition(), fileSize);
+}
+
+void dxfRW::addParsedEntity(DRW_Entity *ent) {
+    switch (ent->eType) {
+    case DRW::POINT:
+        iface->addPoint(*static_cast<DRW_Point *>(ent));
+        break;
+    case DRW::LINE:
+        iface->addLine(*static_cast<DRW_Line *>(ent));
+        break;
+    case DRW::RAY:
+        iface->addRay(*static_cast<DRW_Ray *>(ent));
+        break;
+    case DRW::XLINE:
+        iface->addXline(*static_cast<DRW_Xline *>(ent));
+        break;
+    case DRW::CIRCLE:
+        iface->addCircle(*static_cast<DRW_Circle *>(ent));
+        break;
+    case DRW::ARC:
+        iface->addArc(*static_cast<DRW_Arc *>(ent));
+        break;
+    case DRW::ELLIPSE:
+        iface->addEllipse(*static_cast<DRW_Ellipse *>(ent));
+        break;
+    case DRW::TRACE:
+        iface->addTrace(*static_cast<DRW_Trace *>(ent));
+        break;
+    case DRW::SOLID:
+        iface->addSolid(*static_cast<DRW_Solid *>(ent));
+        break;
+    case DRW::E3DFACE:
+        iface->add3dFace(*static_cast<DRW_3Dface *>(ent));
+        break;
+    case DRW::INSERT:
+        iface->addInsert(*static_cast<DRW_Insert *>(ent));
+        break;
+    case DRW::LWPOLYLINE:
+        iface->addLWPolyline(*static_cast<DRW_LWPolyline *>(ent));
+        break;
+    case DRW::TEXT:
+        iface->addText(*static_cast<DRW_Text *>(ent));
+        break;
+    case DRW::MTEXT:
+        iface->addMText(*static_cast<DRW_MText *>(ent));
+        break;
+    case DRW::HATCH:
+        iface->addHatch(static_cast<DRW_Hatch *>(ent));
+        break;
+    case DRW::SPLINE:
+        iface->addSpline(static_cast<DRW_Spline *>(ent));
+        break;
+    case DRW::LEADER:
+        iface->addLeader(static_cast<DRW_Leader *>(ent));
+        break;
+    default:
+        break;
+    }
+}
+
 bool dxfRW::processEllipse() {
     DRW_DBG("dxfRW::processEllipse");
     int code;
@@ -2665,7 +2997,7 @@ bool dxfRW::processPolyline() {
 bool dxfRW::processVertex(DRW_Polyline *pl) {
     DRW_DBG("dxfRW::processVertex");
     int code;
-    auto v = std::make_shared<DRW_Vertex>();
+    DRW_Vertex v;
     while (reader->readRec(&code)) {
         DRW_DBG(code); DRW_DBG("\n");
         if(0 == code)  {
@@ -2676,11 +3008,11 @@ bool dxfRW::processVertex(DRW_Polyline *pl) {
                 return true;  //found SEQEND no more vertex, terminate
             }
             if (nextentity == "VERTEX"){
-                v = std::make_shared<DRW_Vertex>(); //another vertex
+                v = DRW_Vertex(); //another vertex
             }
         }
 
-        if (!v->parseCode(code, reader)) { //the members of v are reinitialized here
+        if (!v.parseCode(code, reader)) { //the members of v are reinitialized here
             return setError(DRW::BAD_CODE_PARSED);
         }
     }
@@ -14,6 +14,8 @@
 #ifndef LIBDXFRW_H
 #define LIBDXFRW_H
 
+#include <memory>
+#include <ostream>
 #include <string>
 #include <unordered_map>
 #include "drw_entities.h"
@@ -23,7 +25,9 @@
 
 
 class dxfReader;
+class dxfReaderAsciiBuffer;
 class dxfWriter;
+class dxfWriterBuffer;
 
 class dxfRW {
 public:
@@ -40,8 +44,17 @@ public:
      */
     bool read(DRW_Interface *interface_, bool ext);
     void setBinary(bool b) {binFile = b;}
+    /*!< parse simple entities on worker threads, they are still added to the interface in file order.
+     * Used for ascii files only */
+    void setParallelEntities(bool parallel) {parallelEntities = parallel;}
+    /*!< read only the HEADER and TABLES sections and the names of blocks, without their
+     * content. Reading stops before the ENTITIES section, to get the metadata of a drawing fast */
+    void setProbe(bool b) {probe = b;}
 
     bool write(DRW_Interface *interface_, DRW::Version ver, bool bin);
+    /*!< writes the drawing into a stream instead of the file, e.g. a std::ostringstream
+     * to keep the content of the file in memory */
+    bool write(std::ostream &stream, DRW_Interface *interface_, DRW::Version ver, bool bin);
     bool writeLineType(DRW_LType *ent);
     bool writeLayer(DRW_Layer *ent);
     bool writeDimstyle(DRW_Dimstyle *ent);
@@ -74,10 +87,26 @@ public:
     void setEllipseParts(int parts){elParts = parts;} /*!< set parts number when convert ellipse to polyline */
     bool writePlotSettings(DRW_PlotSettings *ent);
 
+    /*!
+     * Entities can be written on worker threads, while the file is written:
+     * each thread writes its entities into a memory buffer returned by this method,
+     * the buffers are added to the file in order by appendEntityBuffer().
+     * Only entity write methods may be called on a buffer, except writeImage().
+     * @return the buffer, nullptr if not writing a file
+     */
+    std::unique_ptr<dxfRW> createEntityBuffer();
+    /*!
+     * Appends the content of a buffer to the file and assigns the entity handles,
+     * the result is the same as writing the buffered entities here.
+     */
+    bool appendEntityBuffer(dxfRW &entities);
+
     DRW::Version getVersion() const;
     DRW::error getError() const;
 
 private:
+    //! memory buffer for entities, see createEntityBuffer()
+    dxfRW(const dxfRW &parent, dxfWriterBuffer *buffer);
     /// used by read() to parse the content of the file
     bool processDxf();
     bool processHeader();
@@ -85,6 +114,10 @@ private:
     bool processBlocks();
     bool processBlock();
     bool processEntities(bool isblock);
+    bool processEntitiesParallel(dxfReaderAsciiBuffer *bufReader);
+    void addParsedEntity(DRW_Entity *ent);
+    //! calls DRW_Interface::readProgress() every few hundred entities, false if canceled
+    bool reportProgress(size_t entities);
     bool processObjects();
 
     bool processLType();
@@ -147,6 +180,10 @@ private:
     bool wlayer0 = false;
     bool dimstyleStd = false;
     bool applyExt =false;
+    bool parallelEntities = false;
+    bool probe = false;
+    unsigned long long fileSize = 0;
+    size_t progressCount = 0;
     bool writingBlock;
     int elParts;  /*!< parts number when convert ellipse to polyline */
     std::unordered_map<std::string,int> blockMap;
@@ -154,6 +191,7 @@ private:
     std::vector<DRW_ImageDef*> imageDef;  /*!< imageDef list */
 
     int currHandle;
+    dxfWriterBuffer *handleBuffer = nullptr;  /*!< set for entity buffers, owned by writer */
 
 };
 
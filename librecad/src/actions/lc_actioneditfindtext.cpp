@@ -0,0 +1,56 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_actioneditfindtext.h"
+#include "rs_dialogfactory.h"
+#include "rs_graphic.h"
+#include "rs_graphicview.h"
+
+namespace {
+
+// the last search, offered again by the next one
+LC_FindTextData lastSearch;
+}
+
+LC_ActionEditFindText::LC_ActionEditFindText(RS_EntityContainer& container,
+                                             RS_GraphicView& graphicView)
+    :RS_ActionInterface("Find Text", container, graphicView) {
+    actionType = RS2::ActionEditFindText;
+}
+
+void LC_ActionEditFindText::init(int status) {
+    RS_ActionInterface::init(status);
+
+    trigger();
+}
+
+void LC_ActionEditFindText::trigger() {
+    if (graphic != nullptr
+        && RS_DIALOGFACTORY->requestFindTextDialog(*graphic, *graphicView, lastSearch)) {
+        const int replaced = graphic->replaceText(lastSearch);
+        if (replaced > 0)
+            graphicView->redraw(RS2::RedrawDrawing);
+        RS_DIALOGFACTORY->commandMessage(tr("Texts replaced: %1").arg(replaced));
+    }
+    finish(false);
+}
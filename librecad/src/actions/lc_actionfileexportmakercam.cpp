@@ -40,12 +40,12 @@ bool getSetting(QString entry) {
     return RS_SETTINGS->readNumEntry("/" + entry, 0);
 }
 
-// create an SVG generator
-std::unique_ptr<LC_MakerCamSVG> getGenerator()
+// create an SVG generator, writing to the device
+std::unique_ptr<LC_MakerCamSVG> getGenerator(QIODevice* device)
 {
     auto groupGuard = RS_SETTINGS->beginGroupGuard("/ExportMakerCam");
 
-    auto generator = std::make_unique<LC_MakerCamSVG>(std::make_unique<LC_XMLWriterQXmlStreamWriter>(),
+    auto generator = std::make_unique<LC_MakerCamSVG>(std::make_unique<LC_XMLWriterQXmlStreamWriter>(device),
                                             (bool)RS_SETTINGS->readNumEntry("/ExportInvisibleLayers"),
                                             (bool)RS_SETTINGS->readNumEntry("/ExportConstructionLayers"),
                                             (bool)RS_SETTINGS->readNumEntry("/WriteBlocksInline"),
@@ -81,18 +81,15 @@ bool LC_ActionFileExportMakerCam::writeSvg(const QString& fileName, RS_Graphic&
         return false;
     }
 
-    auto generator = getGenerator();
-    if (generator->generate(&graphic)) {
-        QFile file{fileName};
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            LC_ERR<<__func__<<"(): failed in creating file "<<fileName<<", no SVG is generated";
-            return false;
-        }
-
-        QTextStream out(&file);
-        out << QString::fromStdString(generator->resultAsString());
+    // the document is written to the file as it's generated
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        LC_ERR<<__func__<<"(): failed in creating file "<<fileName<<", no SVG is generated";
+        return false;
     }
-    return true;
+
+    auto generator = getGenerator(&file);
+    return generator->generate(&graphic);
 }
 
 
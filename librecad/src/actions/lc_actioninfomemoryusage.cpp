@@ -0,0 +1,55 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <QApplication>
+
+#include "lc_actioninfomemoryusage.h"
+#include "lc_memoryreport.h"
+#include "rs_dialogfactory.h"
+#include "rs_graphic.h"
+
+LC_ActionInfoMemoryUsage::LC_ActionInfoMemoryUsage(RS_EntityContainer& container,
+                                                   RS_GraphicView& graphicView)
+    :RS_ActionInterface("Memory Usage", container, graphicView) {
+    actionType = RS2::ActionInfoMemoryUsage;
+}
+
+void LC_ActionInfoMemoryUsage::init(int status) {
+    RS_ActionInterface::init(status);
+
+    trigger();
+}
+
+void LC_ActionInfoMemoryUsage::trigger() {
+    if (graphic != nullptr) {
+        // walking millions of entities takes a moment
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        const LC_MemoryReport report{*graphic};
+        QApplication::restoreOverrideCursor();
+
+        RS_DIALOGFACTORY->commandMessage(report.toText().section('\n', 0, 0));
+        RS_DIALOGFACTORY->requestMemoryReportDialog(report);
+    }
+    finish(false);
+}
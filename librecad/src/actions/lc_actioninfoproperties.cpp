@@ -90,22 +90,29 @@ void LC_ActionInfoProperties::highlightAndShowEntityInfo(QMouseEvent *e){
 
     RS_DIALOGFACTORY->updateCoordinateWidget(mouse, relMouse);
 
+    // still over the same entity, highlighting and info stay as they are
+    RS_Entity* entity = getHoveredEntity(e);
+    if (entity != nullptr && entity == hoveredEntity)
+        return;
+
     // clear any existing hovering
     clearHighLighting();
     deleteSnapper();
-    highlightHoveredEntity(e);
+    hoveredEntity = entity;
+    if (entity != nullptr){
+        highlightEntity(entity);
+        updateQuickInfoWidget(entity);
+    }
 }
 
 
-void LC_ActionInfoProperties::highlightHoveredEntity(QMouseEvent* event)
+RS_Entity* LC_ActionInfoProperties::getHoveredEntity(QMouseEvent* event)
 {
-    bool shouldShowQuickInfoWidget = true; // todo- check for visible?
-
     RS_Entity* entity = catchEntity(event);
     if (entity == nullptr)
-        return;
-    if (!entity->isVisible() || (entity->isLocked() && !shouldShowQuickInfoWidget)){
-        return;
+        return nullptr;
+    if (!entity->isVisible()){
+        return nullptr;
     }
 
     const double hoverToleranceFactor = (entity->rtti() == RS2::EntityEllipse)
@@ -137,13 +144,7 @@ void LC_ActionInfoProperties::highlightHoveredEntity(QMouseEvent* event)
         isPointOnEntity = entity->isPointOnEntity(currentMousePosition, hoverTolerance_adjusted);
     }
 
-    // Glowing effect on mouse hovering
-    if (isPointOnEntity){
-        highlightEntity(entity);
-        if (shouldShowQuickInfoWidget){
-            updateQuickInfoWidget(entity);
-        }
-    }
+    return isPointOnEntity ? entity : nullptr;
 }
 
 
@@ -36,11 +36,13 @@ public:
 
 private:
     RS_Entity* highlightedEntity = nullptr;
+    // entity shown by the quick info widget
+    RS_Entity* hoveredEntity = nullptr;
 
     void updateQuickInfoWidget(RS_Entity *pEntity);
     void clearHighLighting();
     void clearQuickInfoWidget();
-    void highlightHoveredEntity(QMouseEvent *event);
+    RS_Entity* getHoveredEntity(QMouseEvent *event);
     void highlightEntity(RS_Entity *entity);
     void highlightAndShowEntityInfo(QMouseEvent *e);
 };
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <QApplication>
 #include <QDir>
@@ -251,8 +252,14 @@ void LC_ActionLayersExport::trigger()
                                                    + result.fileExtension);
         }
 
-        // Shallow traversing
-        for(RS_Entity* entity: *document)
+        // Shallow traversing, a single layer visits only the entities on it
+        std::vector<RS_Entity*> layerEntities;
+        if (result.checkState == Qt::Checked)
+            layerEntities.assign(document->begin(), document->end());
+        else
+            layerEntities = document->getLayerEntities(originalLayersList->find(copiedLayers));
+
+        for(RS_Entity* entity: layerEntities)
         {
             if (entity == nullptr || entity->getLayer() == nullptr)
                 continue;
@@ -83,8 +83,8 @@ void LC_ActionLayersToggleConstruction::deselectEntities(RS_Layer* layer)
 {
     if (!layer) return;
 
-    for(auto e: *container){
-        if (e && e->isVisible() && e->getLayer() == layer) {
+    for(auto e: container->getLayerEntities(layer)){
+        if (e->isVisible()) {
 
             if (graphicView) {
                 graphicView->deleteEntity(e);
@@ -69,11 +69,9 @@ void RS_ActionBlocksAttributes::trigger() {
                     blockWindow->setWindowTitle(title);
                 }
 
+                // renames the inserts of the block as well
                 blockList->rename(block, newName);
 
-                // update the name of all inserts:
-                graphic->renameInserts(oldName, newName);
-
                 graphic->addBlockNotification();
             }
         }
@@ -27,6 +27,7 @@
 #include <QAction>
 
 #include "rs_actionblocksremove.h"
+#include "rs_block.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_graphic.h"
@@ -55,37 +56,19 @@ void RS_ActionBlocksRemove::trigger() {
         return;
     }
 
-	// list of containers that might refer to the block via inserts:
-	std::vector<RS_EntityContainer*> containerList;
-	containerList.push_back(graphic);
-    for (int bi = 0; bi < bl->count(); bi++) {
-        containerList.push_back(bl->at(bi));
-	}
-
     document->startUndoCycle();
 
 	for (auto block: blocks) {
         if (nullptr == block) {
             continue;
         }
-        for(auto cont: containerList){
-			// remove all inserts from the graphic:
-			bool done;
-			do {
-				done = true;
-				for(auto e: *cont){
-
-					if (e->rtti()==RS2::EntityInsert) {
-						RS_Insert* ins = (RS_Insert*)e;
-						if (ins->getName()==block->getName() && !ins->isUndone()) {
-                            document->addUndoable(ins);
-                            ins->setUndoState(true);
-							done = false;
-							break;
-						}
-					}
-				}
-			} while (!done);
+		// remove all inserts from the graphic and the other blocks:
+		for (RS_Insert* ins: bl->getInserts(block->getName())) {
+			document->addUndoable(ins);
+			ins->setUndoState(true);
+			// blocks nesting the removed block are compiled again
+			if (ins->getParent()->rtti() == RS2::EntityBlock)
+				static_cast<RS_Block*>(ins->getParent())->setChanged();
 		}
 
 		// clear selection and active state
@@ -166,8 +166,7 @@ void RS_ActionDefault::highlightHoveredEntities(QMouseEvent* event)
 
     bool shouldShowQuickInfoWidget = allowEntityQuickInfoAuto || (event->modifiers() & (Qt::ControlModifier | Qt::MetaModifier) && allowEntityQuickInfoForCTRL);
 
-    auto guard = RS_SETTINGS->beginGroupGuard("/Appearance");
-    bool showHighlightEntity = RS_SETTINGS->readNumEntry("/VisualizeHovering", 0) != 0 || shouldShowQuickInfoWidget;
+    bool showHighlightEntity = RS_SETTINGS->snapshot().visualizeHovering || shouldShowQuickInfoWidget;
     if (!showHighlightEntity)
         return;
 
@@ -243,6 +242,7 @@ void RS_ActionDefault::mouseMoveEvent(QMouseEvent* e) {
                 RS_DEBUG->print("RS_ActionDefault::mouseMoveEvent: "
                                 "moving reference point");
                 setStatus(MovingRef);
+                preview->clearSelectionCache();
 				pPoints->v1 = ref;
 				graphicView->moveRelativeZero(pPoints->v1);
             }
@@ -253,6 +253,7 @@ void RS_ActionDefault::mouseMoveEvent(QMouseEvent* e) {
                     RS_DEBUG->print("RS_ActionDefault::mouseMoveEvent: "
                                     "moving entity");
                     setStatus(Moving);
+                    preview->clearSelectionCache();
 					RS_Vector vp= en->getNearestRef(pPoints->v1);
 					if(vp.valid) pPoints->v1=vp;
 
@@ -277,7 +278,7 @@ void RS_ActionDefault::mouseMoveEvent(QMouseEvent* e) {
         }
 
         deletePreview();
-        preview->addSelectionFrom(*container);
+        preview->addCachedSelectionFrom(*container);
 		preview->moveRef(pPoints->v1, pPoints->v2 - pPoints->v1);
 
         if (e->modifiers() & Qt::ShiftModifier) {
@@ -299,7 +300,7 @@ void RS_ActionDefault::mouseMoveEvent(QMouseEvent* e) {
         }
 
         deletePreview();
-        preview->addSelectionFrom(*container);
+        preview->addCachedSelectionFrom(*container);
 		preview->move(pPoints->v2 - pPoints->v1);
 
         if (e->modifiers() & Qt::ShiftModifier) {
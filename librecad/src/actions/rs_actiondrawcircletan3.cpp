@@ -133,10 +133,10 @@ void RS_ActionDrawCircleTan3::mouseMoveEvent(QMouseEvent* e) {
 		//        circles[getStatus()]=static_cast<RS_Line*>(en);
 		deletePreview();
 		if(preparePreview()) {
-			RS_Circle* e=new RS_Circle(preview.get(), *pPoints->cData);
-			preview->addEntity(e);
+			// rebuilt at every mouse move, in the frame arena of the preview
+			preview->addEntity(preview->create<RS_Circle>(preview.get(), *pPoints->cData));
 			for(auto& c: pPoints->candidates){
-                preview->addEntity(new RS_Point(nullptr, RS_PointData(c->center)));
+                preview->addEntity(preview->create<RS_Point>(nullptr, RS_PointData(c->center)));
 			}
 			drawPreview();
 		}
@@ -309,7 +309,7 @@ bool RS_ActionDrawCircleTan3::preparePreview(){
 	double dist=RS_MAXDOUBLE*RS_MAXDOUBLE;
 	for(size_t i=0;i<pPoints->candidates.size();++i){
 
-		preview->addEntity(new RS_Point(preview.get(), RS_PointData(pPoints->candidates.at(i)->center)));
+		preview->addEntity(preview->create<RS_Point>(preview.get(), RS_PointData(pPoints->candidates.at(i)->center)));
         double d = RS_MAXDOUBLE;
 		RS_Circle(nullptr, *pPoints->candidates.at(i)).getNearestPointOnEntity(pPoints->coord,false,&d);
 		double dCenter=pPoints->coord.distanceTo(pPoints->candidates.at(i)->center);
@@ -27,12 +27,16 @@
 #include <QAction>
 #include <QMouseEvent>
 
+#include "lc_linemath.h"
+#include "lc_splinepoints.h"
 #include "rs_actiondrawlinefree.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_graphicview.h"
+#include "rs_line.h"
 #include "rs_polyline.h"
 #include "rs_preview.h"
+#include "rs_settings.h"
 
 RS_ActionDrawLineFree::RS_ActionDrawLineFree(RS_EntityContainer& container,
         RS_GraphicView& graphicView)
@@ -40,7 +44,6 @@ RS_ActionDrawLineFree::RS_ActionDrawLineFree(RS_EntityContainer& container,
 					container, graphicView)
 		,vertex(new RS_Vector{})
 {
-	preview->setOwner(false);
 	actionType=RS2::ActionDrawLineFree;
 }
 
@@ -48,13 +51,12 @@ RS_ActionDrawLineFree::~RS_ActionDrawLineFree() = default;
 
 void RS_ActionDrawLineFree::trigger() {
 	deleteSnapper();
-	if (polyline.get()) {
+	if (!points.empty()) {
 		deletePreview();
 
-		polyline->endPolyline();
-		RS_VectorSolutions sol=polyline->getRefPoints();
-		if(sol.getNumber() > 2 ) {
-			RS_Entity* ent=polyline->clone();
+		// a stroke needs two segments at least, as dragged
+		if (points.size() > 2) {
+			RS_Entity* ent = createStroke();
 			container->addEntity(ent);
 			if (document) {
 				document->startUndoCycle();
@@ -63,13 +65,42 @@ void RS_ActionDrawLineFree::trigger() {
 			}
 			graphicView->redraw(RS2::RedrawDrawing);
 			RS_DEBUG->print("RS_ActionDrawLineFree::trigger():"
-                            " polyline added: %lu", ent->getId());
+                            " stroke of %zu points added: %lu", points.size(), ent->getId());
 		}
-		polyline.reset();
+		points.clear();
 	}
 	setStatus(SetStartpoint);
 }
 
+RS_Entity* RS_ActionDrawLineFree::createStroke() const {
+	RS_SETTINGS->beginGroup("/Draw");
+	const int tolerance = RS_SETTINGS->readNumEntry("/FreehandTolerance", 1);
+	const bool spline = RS_SETTINGS->readNumEntry("/FreehandSpline", 0) == 1;
+	RS_SETTINGS->endGroup();
+
+	const std::vector<RS_Vector> simplified = tolerance > 0
+			? LC_LineMath::simplifyPolyline(points, graphicView->toGraphDX(tolerance))
+			: points;
+
+	RS_Entity* ent = nullptr;
+	if (spline && simplified.size() > 2) {
+		LC_SplinePointsData data{false, false};
+		data.splinePoints = simplified;
+		ent = new LC_SplinePoints(container, data);
+	} else {
+		auto* polyline = new RS_Polyline(container, RS_PolylineData(simplified.front(), simplified.front(), false));
+		std::vector<std::pair<RS_Vector, double>> vertices;
+		vertices.reserve(simplified.size() - 1);
+		for (size_t i = 1; i < simplified.size(); ++i)
+			vertices.emplace_back(simplified[i], 0.);
+		polyline->appendVertexs(vertices);
+		ent = polyline;
+	}
+	ent->setLayerToActive();
+	ent->setPenToActive();
+	return ent;
+}
+
 /*
  * 11 Aug 2011, Dongxu Li
  */
@@ -77,24 +108,25 @@ void RS_ActionDrawLineFree::trigger() {
 void RS_ActionDrawLineFree::mouseMoveEvent(QMouseEvent* e) {
     RS_Vector v = snapPoint(e);
     drawSnapper();
-    if (getStatus()==Dragging && polyline.get()) {
+    if (getStatus()==Dragging && !points.empty()) {
 		if( (graphicView->toGui(v) - graphicView->toGui(*vertex)).squared()< 1. ){
             //do not add the same mouse position
             return;
         }
-        auto ent = static_cast<RS_Polyline*>(polyline->addVertex(v));
-        if (ent->count()){
-            preview->addCloneOf(ent);
-            drawPreview();
-        }
+        // the stroke is simplified once it's finished, the preview shows it as dragged
+        preview->addEntity(new RS_Line(preview.get(), *vertex, v));
+        drawPreview();
+        points.push_back(v);
 
 		*vertex = v;
-
-        RS_DEBUG->print("RS_ActionDrawLineFree::%s:"
-                        " line added: %lu", __func__, ent->getId());
     }
 }
 
+// the stroke follows every position of the cursor while dragging
+bool RS_ActionDrawLineFree::handlesEveryMouseMove() const {
+    return getStatus() == Dragging;
+}
+
 
 
 void RS_ActionDrawLineFree::mousePressEvent(QMouseEvent* e) {
@@ -105,11 +137,8 @@ void RS_ActionDrawLineFree::mousePressEvent(QMouseEvent* e) {
             // fall-through
         case Dragging:
 			*vertex = snapPoint(e);
-			polyline.reset(new RS_Polyline(container,
-									   RS_PolylineData(*vertex, *vertex, 0))
-						   );
-            polyline->setLayerToActive();
-            polyline->setPenToActive();
+			deletePreview();
+			points.assign(1, *vertex);
             break;
         default:
             break;
@@ -127,8 +156,9 @@ void RS_ActionDrawLineFree::mouseReleaseEvent(QMouseEvent* e) {
         trigger();
         }
     } else if (e->button()==Qt::RightButton) {
-		if (polyline.get()) {
-			polyline.reset();
+		if (!points.empty()) {
+			deletePreview();
+			points.clear();
         }
         init(getStatus()-1);
     }
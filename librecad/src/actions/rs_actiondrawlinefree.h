@@ -28,13 +28,17 @@
 #ifndef RS_ACTIONDRAWLINEFREE_H
 #define RS_ACTIONDRAWLINEFREE_H
 
-#include "rs_previewactioninterface.h"
+#include <vector>
 
-class RS_Polyline;
+#include "rs_previewactioninterface.h"
 
 /**
  * This action class can handle user events to draw freehand lines.
  *
+ * The stroke is simplified before it's added: vertices closer than the tolerance set by
+ * /Draw/FreehandTolerance, in pixels, are dropped. With /Draw/FreehandSpline, it's added as
+ * a spline through the kept vertices instead of a polyline.
+ *
  * @author Andrew Mustun
  */
 class RS_ActionDrawLineFree : public RS_PreviewActionInterface {
@@ -53,6 +57,7 @@ public:
 
 	void trigger() override;
 	void mouseMoveEvent(QMouseEvent* e) override;
+	bool handlesEveryMouseMove() const override;
 	void mousePressEvent(QMouseEvent* e) override;
 	void mouseReleaseEvent(QMouseEvent* e) override;
 	void updateMouseButtonHints() override;
@@ -60,7 +65,12 @@ public:
 
 protected:
 	std::unique_ptr<RS_Vector> vertex;
-	std::unique_ptr<RS_Polyline> polyline;
+	// the vertices of the stroke, as dragged
+	std::vector<RS_Vector> points;
+
+private:
+	// the simplified stroke as a polyline or a spline
+	RS_Entity* createStroke() const;
 };
 
 #endif
@@ -257,14 +257,12 @@ void RS_ActionDrawLineTangent2::preparePreivew(QMouseEvent* e)
                   const std::unique_ptr<RS_Line>& rhs) {
             return linePointDist(*lhs, mouse) < linePointDist(*rhs, mouse);
         });
+        // rebuilt at every mouse move, in the frame arena of the preview
         for(const auto& line: m_pPoints->tangents){
-            auto newEndpoint = new RS_Point{preview.get(), line->getData().startpoint};
-            preview->addEntity(newEndpoint);
-            newEndpoint = new RS_Point{preview.get(), line->getData().endpoint};
-            preview->addEntity(newEndpoint);
+            preview->addEntity(preview->create<RS_Point>(preview.get(), RS_PointData{line->getData().startpoint}));
+            preview->addEntity(preview->create<RS_Point>(preview.get(), RS_PointData{line->getData().endpoint}));
         }
-        auto* newLine = new RS_Line{preview.get(), m_pPoints->tangents.front()->getData()};
-        preview->addEntity(newLine);
+        preview->addEntity(preview->create<RS_Line>(preview.get(), m_pPoints->tangents.front()->getData()));
         drawPreview();
     }
         break;
@@ -75,8 +75,8 @@ void RS_ActionLayersToggleLock::deselectEntitiesOnLockedLayer(RS_Layer* layer)
     if (!layer) return;
     if (!layer->isLocked()) return;
 
-    for(auto e: *container){
-        if (e && e->isVisible() && e->getLayer() == layer) {
+    for(auto e: container->getLayerEntities(layer)){
+        if (e->isVisible()) {
 
             if (graphicView) {
                 graphicView->deleteEntity(e);
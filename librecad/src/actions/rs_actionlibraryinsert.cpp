@@ -27,6 +27,7 @@
 #include <QAction>
 #include <QMouseEvent>
 
+#include "lc_librarypartcache.h"
 #include "rs_actionlibraryinsert.h"
 #include "rs_dialogfactory.h"
 #include "rs_commandevent.h"
@@ -37,7 +38,8 @@
 #include "rs_units.h"
 
 struct RS_ActionLibraryInsert::Points {
-	RS_Graphic prev;
+	// the part, shared with the library inserts
+	std::shared_ptr<RS_Graphic> prev;
 	RS_LibraryInsertData data;
 };
 
@@ -74,7 +76,8 @@ void RS_ActionLibraryInsert::init(int status) {
 void RS_ActionLibraryInsert::setFile(const QString& file) {
 	pPoints->data.file = file;
 
-	if (!pPoints->prev.open(file, RS2::FormatUnknown)) {
+	pPoints->prev = LC_LibraryPartCache::instance().part(file);
+	if (pPoints->prev == nullptr) {
         RS_DIALOGFACTORY->commandMessage(tr("Cannot open file '%1'").arg(file));
     }
 }
@@ -107,13 +110,15 @@ void RS_ActionLibraryInsert::mouseMoveEvent(QMouseEvent* e) {
 
         //if (block) {
         deletePreview();
-		preview->addAllFrom(pPoints->prev);
+		if (pPoints->prev == nullptr)
+			break;
+		preview->addAllFrom(*pPoints->prev);
 		preview->move(pPoints->data.insertionPoint);
 		preview->scale(pPoints->data.insertionPoint,
 					   RS_Vector(pPoints->data.factor, pPoints->data.factor));
         // unit conversion:
         if (graphic) {
-			double const uf = RS_Units::convert(1.0, pPoints->prev.getUnit(),
+			double const uf = RS_Units::convert(1.0, pPoints->prev->getUnit(),
                                           graphic->getUnit());
 			preview->scale(pPoints->data.insertionPoint,
 			{uf, uf});
@@ -88,7 +88,7 @@ void RS_ActionModifyMirror::mouseMoveEvent(QMouseEvent* e) {
                 pPoints->axisPoint2 = mouse;
 
                 deletePreview();
-                preview->addSelectionFrom(*container);
+                preview->addCachedSelectionFrom(*container);
                 preview->mirror(pPoints->axisPoint1, pPoints->axisPoint2);
 
                 preview->addEntity(new RS_Line{preview.get(),
@@ -87,7 +87,7 @@ void RS_ActionModifyMove::mouseMoveEvent(QMouseEvent* e) {
 				pPoints->targetPoint = mouse;
 
                 deletePreview();
-                preview->addSelectionFrom(*container);
+                preview->addCachedSelectionFrom(*container);
 				preview->move(pPoints->targetPoint-pPoints->referencePoint);
 
                 if (e->modifiers() & Qt::ShiftModifier) {
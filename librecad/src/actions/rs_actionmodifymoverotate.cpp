@@ -91,7 +91,7 @@ void RS_ActionModifyMoveRotate::mouseMoveEvent(QMouseEvent* e) {
 				pPoints->data.offset = pPoints->targetPoint-pPoints->data.referencePoint;
 
                 deletePreview();
-                preview->addSelectionFrom(*container);
+                preview->addCachedSelectionFrom(*container);
 				preview->rotate(pPoints->data.referencePoint, pPoints->data.angle);
 				preview->move(pPoints->data.offset);
                 drawPreview();
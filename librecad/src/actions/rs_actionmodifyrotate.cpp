@@ -73,7 +73,7 @@ void RS_ActionModifyRotate::mouseMoveEvent(QMouseEvent* e) {
     case setTargetPoint:
         if( ! mouse.valid ) return;
         deletePreview();
-        preview->addSelectionFrom(*container);
+        preview->addCachedSelectionFrom(*container);
 		preview->rotate(data->center,RS_Math::correctAngle((mouse - data->center).angle() - data->angle));
         drawPreview();
     }
@@ -134,7 +134,7 @@ RS_Vector RS_ActionModifyScale::getTargetPoint(QMouseEvent* e)
 void RS_ActionModifyScale::showPreview()
 {
     deletePreview();
-    preview->addSelectionFrom(*container);
+    preview->addCachedSelectionFrom(*container);
     findFactor();
 
     // RS_Modification only considers selected
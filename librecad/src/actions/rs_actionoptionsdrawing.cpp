@@ -30,6 +30,7 @@
 #include "rs_actionoptionsdrawing.h"
 #include "rs_dialogfactory.h"
 #include "rs_graphicview.h"
+#include "rs_grid.h"
 
 
 
@@ -54,6 +55,7 @@ void RS_ActionOptionsDrawing::trigger() {
         RS_DIALOGFACTORY->updateCoordinateWidget(RS_Vector(0.0,0.0),
                 RS_Vector(0.0,0.0),
                 true);
+        graphicView->getGrid()->loadSettings();
         graphicView->redraw(RS2::RedrawGrid);
         graphicView->redraw(RS2::RedrawDrawing); 
     }
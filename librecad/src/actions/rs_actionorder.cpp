@@ -58,11 +58,10 @@ void RS_ActionOrder::init(int status) {
 void RS_ActionOrder::trigger() {
     RS_DEBUG->print("RS_ActionOrder::trigger()");
 
+    // in the container order
     QList<RS_Entity *> entList;
-	for(auto e: *container){
-        if (e->isSelected())
-            entList.append(e);
-    }
+    for (RS_Entity* e: container->getSelectedEntities())
+        entList.append(e);
 
     if (targetEntity) {
 		int index = -1;
@@ -24,11 +24,14 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include<cmath>
+#include <vector>
 
 #include <QAction>
 #include <QMouseEvent>
 
+#include "lc_parallel.h"
 #include "rs_actionpolylineequidistant.h"
 #include "rs_arc.h"
 #include "rs_debug.h"
@@ -70,7 +73,7 @@ void RS_ActionPolylineEquidistant::init(int status) {
  *
  * @author Rallaz
  */
-RS_Entity* RS_ActionPolylineEquidistant::calculateOffset(RS_Entity* newEntity,RS_Entity* orgEntity, double dist) {
+RS_Entity* RS_ActionPolylineEquidistant::calculateOffset(RS_Entity* newEntity,RS_Entity* orgEntity, double dist) const {
     if (orgEntity->rtti()==RS2::EntityArc && newEntity->rtti()==RS2::EntityArc) {
         RS_Arc* arc = (RS_Arc*)newEntity;
         double r0 = ((RS_Arc*)orgEntity)->getRadius();
@@ -108,7 +111,7 @@ RS_Entity* RS_ActionPolylineEquidistant::calculateOffset(RS_Entity* newEntity,RS
  *
  * @author Rallaz
  */
-RS_Vector RS_ActionPolylineEquidistant::calculateIntersection(RS_Entity* first,RS_Entity* last) {
+RS_Vector RS_ActionPolylineEquidistant::calculateIntersection(RS_Entity* first,RS_Entity* last) const {
     RS_VectorSolutions vsol;
     RS_Vector v(false);
     vsol = RS_Information::getIntersection(first, last, false);
@@ -122,6 +125,132 @@ RS_Vector RS_ActionPolylineEquidistant::calculateIntersection(RS_Entity* first,R
     return vsol.get(0);
 }
 
+/**
+ * Helper function for makeContour
+ * Creates the parallel of the polyline entities at distance offset, which are the
+ * segments of originalPolyline without length = 0. Only reads the original, so copies
+ * may be created by worker threads.
+ *
+ * @retval the new polyline, empty if no parallel exists
+ */
+std::unique_ptr<RS_Polyline> RS_ActionPolylineEquidistant::makeOffset(const RS_Polyline& originalPolyline,
+                                                                     const QList<RS_Entity*>& entities,
+                                                                     double offset) const {
+    // Create new helper entities
+    RS_Vector const origin{0.,0.};
+    RS_Line line1{origin, origin};//current line
+    RS_Line lineFirst{origin, origin};//previous line
+    RS_Arc arc1(nullptr, RS_ArcData(origin, 0,0,0,false));//current arc
+    RS_Arc arcFirst(nullptr, RS_ArcData(origin, 0,0,0,false));//previous arc
+
+    auto newPolyline = std::make_unique<RS_Polyline>(container);
+
+    bool first = true;
+    bool closed = originalPolyline.isClosed();
+    double bulge = 0.0;
+    RS_Entity* en;
+    RS_Entity* prevEntity = entities.last();
+    RS_Entity* currEntity=nullptr;
+    for (int i = 0; i < entities.size(); ++i) {
+        en = entities.at(i);
+        RS_Vector v{false};
+        if (en->rtti()==RS2::EntityArc) {
+            currEntity = &arc1;
+            calculateOffset(currEntity, en, offset);
+            bulge = arc1.getBulge();
+        } else {
+            currEntity = &line1;
+            bulge = 0.0;
+            calculateOffset(currEntity, en, offset);
+        }
+        if (first) {
+            if (closed){
+                if (prevEntity->rtti()==RS2::EntityArc) {
+                    prevEntity = calculateOffset(&arcFirst, prevEntity, offset);
+                } else {
+                    prevEntity = calculateOffset(&lineFirst, prevEntity, offset);
+                }
+                v = calculateIntersection(prevEntity, currEntity);
+            }
+            if (!v.valid) {
+                v = currEntity->getStartpoint();
+                closed = false;
+            } else if (currEntity->rtti()==RS2::EntityArc) {
+                //update bulge
+                arc1.setAngle1(arc1.getCenter().angleTo(v));
+                arc1.calculateBorders();
+                bulge = arc1.getBulge();
+            }
+            first = false;
+            if (!prevEntity) break; //prevent crash if not exist offset for prevEntity
+        }else{
+            v = calculateIntersection(prevEntity, currEntity);
+            if (!v.valid) {
+                v= prevEntity->getEndpoint();
+                double dess = currEntity->getStartpoint().distanceTo(prevEntity->getEndpoint());
+                if (dess > 1.0e-12) {
+                    newPolyline->addVertex(v, bulge);
+                    prevEntity = nullptr;
+                    break;
+                }
+            }
+            double startAngle = prevEntity->getStartpoint().angleTo(prevEntity->getEndpoint());
+            if (prevEntity->rtti()==RS2::EntityArc) {
+                arcFirst.setAngle2(arcFirst.getCenter().angleTo(v));
+                arcFirst.calculateBorders();
+                 newPolyline->setNextBulge(arcFirst.getBulge());
+            }
+            //check if the entity are reverted
+            if (fabs(remainder(prevEntity->getStartpoint().angleTo(prevEntity->getEndpoint())- startAngle, 2.*M_PI)) > 0.785){
+                prevEntity = newPolyline->lastEntity();
+                RS_Vector v0 = calculateIntersection(prevEntity, currEntity);
+                if (prevEntity->rtti()==RS2::EntityArc) {
+                    ((RS_Arc*)prevEntity)->setAngle2(arcFirst.getCenter().angleTo(v0));
+                    ((RS_Arc*)prevEntity)->calculateBorders();
+                    newPolyline->setNextBulge( ((RS_Arc*)prevEntity)->getBulge() );
+                } else {
+                    ((RS_Line*)prevEntity)->setEndpoint(v0);
+                    newPolyline->setNextBulge( 0.0 );
+                }
+                newPolyline->setEndpoint(v0);
+            }
+            if (currEntity->rtti()==RS2::EntityArc) {
+                arc1.setAngle1(arc1.getCenter().angleTo(v));
+                arc1.calculateBorders();
+                bulge = arc1.getBulge();
+            } else
+                bulge = 0.0;
+        }
+        if (prevEntity) {
+            newPolyline->addVertex(v, bulge, false);
+            if (currEntity->rtti()==RS2::EntityArc){
+                arcFirst.setData(arc1.getData());
+                arcFirst.calculateBorders();
+                prevEntity = &arcFirst;
+            } else {
+                lineFirst.setStartpoint(line1.getStartpoint());
+                lineFirst.setEndpoint(line1.getEndpoint());
+                prevEntity = &lineFirst;
+            }
+        }
+    }
+    //properly terminated, check closed
+    if (prevEntity && currEntity) {
+        if (closed){
+            if (currEntity->rtti()==RS2::EntityArc) {
+                arc1.setAngle2(arc1.getCenter().angleTo(newPolyline->getStartpoint()));
+                arc1.calculateBorders();
+                newPolyline->setNextBulge(arc1.getBulge());
+                bulge = arc1.getBulge();
+            }
+            newPolyline->setClosed(true, bulge);
+        } else {
+            newPolyline->addVertex(currEntity->getEndpoint(), bulge);
+        }
+    }
+    return newPolyline;
+}
+
 bool RS_ActionPolylineEquidistant::makeContour() {
 	if (!container) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
@@ -142,125 +271,20 @@ bool RS_ActionPolylineEquidistant::makeContour() {
 	if (document) {
         document->startUndoCycle();
     }
-    double neg = bRightSide ? -1.0 : 1.0;
-
-    // Create new helper entities
-    RS_Vector const origin{0.,0.};
-    RS_Line line1{origin, origin};//current line
-    RS_Line lineFirst{origin, origin};//previous line
-    RS_Arc arc1(nullptr, RS_ArcData(origin, 0,0,0,false));//current arc
-    RS_Arc arcFirst(nullptr, RS_ArcData(origin, 0,0,0,false));//previous arc
-
-    for (int num=1; num<=number || (number==0 && num<=1); num++) {
-        RS_Polyline* newPolyline = new RS_Polyline(container);
-        newPolyline->setLayerToActive();
-
-        bool first = true;
-        bool closed = originalPolyline->isClosed();
-        double bulge = 0.0;
-        RS_Entity* en;
-        RS_Entity* prevEntity = entities.last();
-		RS_Entity* currEntity=nullptr;
-        for (int i = 0; i < entities.size(); ++i) {
-            en = entities.at(i);
-			RS_Vector v{false};
-            if (en->rtti()==RS2::EntityArc) {
-                currEntity = &arc1;
-                calculateOffset(currEntity, en, dist*num*neg);
-                bulge = arc1.getBulge();
-            } else {
-                currEntity = &line1;
-                bulge = 0.0;
-                calculateOffset(currEntity, en, dist*num*neg);
-            }
-            if (first) {
-                if (closed){
-                    if (prevEntity->rtti()==RS2::EntityArc) {
-                        prevEntity = calculateOffset(&arcFirst, prevEntity, dist*num*neg);
-                    } else {
-                        prevEntity = calculateOffset(&lineFirst, prevEntity, dist*num*neg);
-                    }
-                    v = calculateIntersection(prevEntity, currEntity);
-                }
-                if (!v.valid) {
-                    v = currEntity->getStartpoint();
-                    closed = false;
-                } else if (currEntity->rtti()==RS2::EntityArc) {
-                    //update bulge
-                    arc1.setAngle1(arc1.getCenter().angleTo(v));
-					arc1.calculateBorders();
-                    bulge = arc1.getBulge();
-                }
-                first = false;
-                if (!prevEntity) break; //prevent crash if not exist offset for prevEntity
-            }else{
-                v = calculateIntersection(prevEntity, currEntity);
-                if (!v.valid) {
-                    v= prevEntity->getEndpoint();
-                    double dess = currEntity->getStartpoint().distanceTo(prevEntity->getEndpoint());
-                    if (dess > 1.0e-12) {
-                        newPolyline->addVertex(v, bulge);
-						prevEntity = nullptr;
-                        break;
-                    }
-                }
-                double startAngle = prevEntity->getStartpoint().angleTo(prevEntity->getEndpoint());
-                if (prevEntity->rtti()==RS2::EntityArc) {
-                    arcFirst.setAngle2(arcFirst.getCenter().angleTo(v));
-					arcFirst.calculateBorders();
-                     newPolyline->setNextBulge(arcFirst.getBulge());
-                }
-                //check if the entity are reverted
-                if (fabs(remainder(prevEntity->getStartpoint().angleTo(prevEntity->getEndpoint())- startAngle, 2.*M_PI)) > 0.785){
-                    prevEntity = newPolyline->lastEntity();
-                    RS_Vector v0 = calculateIntersection(prevEntity, currEntity);
-                    if (prevEntity->rtti()==RS2::EntityArc) {
-                        ((RS_Arc*)prevEntity)->setAngle2(arcFirst.getCenter().angleTo(v0));
-						((RS_Arc*)prevEntity)->calculateBorders();
-                        newPolyline->setNextBulge( ((RS_Arc*)prevEntity)->getBulge() );
-                    } else {
-                        ((RS_Line*)prevEntity)->setEndpoint(v0);
-                        newPolyline->setNextBulge( 0.0 );
-                    }
-                    newPolyline->setEndpoint(v0);
-                }
-                if (currEntity->rtti()==RS2::EntityArc) {
-                    arc1.setAngle1(arc1.getCenter().angleTo(v));
-					arc1.calculateBorders();
-                    bulge = arc1.getBulge();
-                } else
-                    bulge = 0.0;
-            }
-            if (prevEntity) {
-                newPolyline->addVertex(v, bulge, false);
-                if (currEntity->rtti()==RS2::EntityArc){
-                    arcFirst.setData(arc1.getData());
-					arcFirst.calculateBorders();
-                    prevEntity = &arcFirst;
-                } else {
-                    lineFirst.setStartpoint(line1.getStartpoint());
-                    lineFirst.setEndpoint(line1.getEndpoint());
-                    prevEntity = &lineFirst;
-                }
-            }
-        }
-        //properly terminated, check closed
-		if (prevEntity && currEntity) {
-            if (closed){
-				if (currEntity->rtti()==RS2::EntityArc) {
-                    arc1.setAngle2(arc1.getCenter().angleTo(newPolyline->getStartpoint()));
-					arc1.calculateBorders();
-                    newPolyline->setNextBulge(arc1.getBulge());
-                    bulge = arc1.getBulge();
-                }
-                newPolyline->setClosed(true, bulge);
-            } else {
-                newPolyline->addVertex(currEntity->getEndpoint(), bulge);
-            }
-        }
+    const double neg = bRightSide ? -1.0 : 1.0;
+    const int copies = (number == 0) ? 1 : std::max(number, 0);
+
+    // the copies are independent: computed by worker threads, added in order
+    std::vector<std::unique_ptr<RS_Polyline>> newPolylines(copies);
+    LC_Parallel::forEach(newPolylines.size(), 1, [&](size_t i) {
+        newPolylines[i] = makeOffset(*originalPolyline, entities, dist*(i + 1)*neg);
+    });
+    for (std::unique_ptr<RS_Polyline>& newPolyline: newPolylines) {
         if (!newPolyline->isEmpty()) {
-            container->addEntity(newPolyline);
-			if (document) document->addUndoable(newPolyline);
+            newPolyline->setLayerToActive();
+            container->addEntity(newPolyline.get());
+			if (document) document->addUndoable(newPolyline.get());
+            newPolyline.release();
         }
     }
 	if (document) document->endUndoCycle();
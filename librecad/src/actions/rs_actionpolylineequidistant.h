@@ -26,8 +26,14 @@
 #ifndef RS_ACTIONPOLYLINEEQUIDISTANT_H
 #define RS_ACTIONPOLYLINEEQUIDISTANT_H
 
+#include <memory>
+
+#include <QList>
+
 #include "rs_previewactioninterface.h"
 
+class RS_Polyline;
+
 /**
  * This action class can handle user events to move entities.
  *
@@ -80,8 +86,10 @@ public:
 	bool makeContour();
 
 private:
-    RS_Entity* calculateOffset(RS_Entity* newEntity,RS_Entity* orgEntity, double dist);
-    RS_Vector calculateIntersection(RS_Entity* first,RS_Entity* last);
+    RS_Entity* calculateOffset(RS_Entity* newEntity,RS_Entity* orgEntity, double dist) const;
+    RS_Vector calculateIntersection(RS_Entity* first,RS_Entity* last) const;
+    std::unique_ptr<RS_Polyline> makeOffset(const RS_Polyline& originalPolyline,
+                                            const QList<RS_Entity*>& entities, double offset) const;
 
 private:
     RS_Entity* originalEntity = nullptr;
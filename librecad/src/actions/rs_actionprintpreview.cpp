@@ -249,8 +249,8 @@ void RS_ActionPrintPreview::updateMouseCursor() {
 void RS_ActionPrintPreview::center() {
     if (graphic) {
         graphic->centerToPage();
+        // only the paper moved, zoomPage() keeps the drawing tiles of the same zoom factor
         graphicView->zoomPage();
-        graphicView->redraw();
     }
 }
 
@@ -275,7 +275,6 @@ void RS_ActionPrintPreview::fit() {
         //        }
         graphic->centerToPage();
         graphicView->zoomPage();
-        graphicView->redraw();
     }
 }
 
@@ -292,9 +291,11 @@ bool RS_ActionPrintPreview::setScale(double f, bool autoZoom) {
         pinBase += graphic->getSize()*(oldScale - f)*0.5;
         graphic->setPaperInsertionBase(pinBase);
 
+        // line widths depend on the paper scale, the tiles are rendered again by their key
         if(autoZoom)
             graphicView->zoomPage();
-        graphicView->redraw();
+        else
+            graphicView->redraw(RS2::RedrawPan);
         return true;
     }
     return false;
@@ -313,7 +314,7 @@ double RS_ActionPrintPreview::getScale() const{
 
 void RS_ActionPrintPreview::setLineWidthScaling(bool state) {
     graphicView->setLineWidthScaling(state);
-    graphicView->redraw();
+    graphicView->redraw(RS2::RedrawPan);
 }
 
 
@@ -324,7 +325,7 @@ void RS_ActionPrintPreview::setBlackWhite(bool bw) {
     else {
         graphicView->setDrawingMode(RS2::ModeFull);
     }
-    graphicView->redraw();
+    graphicView->redraw(RS2::RedrawPan);
 }
 
 
@@ -367,7 +368,6 @@ void RS_ActionPrintPreview::calcPagesNum() {
         graphic->setPagesNum(pX, pY);
         graphic->centerToPage();
         graphicView->zoomPage();
-        graphicView->redraw();
     }
 }
 
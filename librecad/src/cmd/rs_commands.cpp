@@ -826,6 +826,18 @@ RS_Commands::RS_Commands() {
             {{"aa", QObject::tr("aa", "measure area")}},   // - v2.2.0r2
             RS2::ActionInfoArea
         },
+        // Find and replace text
+        {
+            {{"findtext", QObject::tr("findtext", "find and replace text")}},
+            {{"find", QObject::tr("find", "find and replace text")}},
+            RS2::ActionEditFindText
+        },
+        // Memory usage of the drawing
+        {
+            {{"infomemory", QObject::tr("infomemory", "memory usage")}},
+            {{"mem", QObject::tr("mem", "memory usage")}},
+            RS2::ActionInfoMemoryUsage
+        },
 
         /* OTHER COMMANDS */
         // draw mtext
@@ -1040,6 +1052,13 @@ RS_Commands::RS_Commands() {
         }
     }
 
+    // lookup tables for completion and for the confirmation message: the
+    // first command of an action in map order is its full command
+    for(auto const& p: mainCommands){
+        completionIndex.emplace(p.first.toLower(), p.first);
+        actionCommands.emplace(p.second, p.first);
+    }
+
     // translations
     std::vector<std::pair<QString, QString>> transList={
         {"angle",QObject::tr("angle")},
@@ -1293,10 +1312,11 @@ void RS_Commands::updateAlias(){
  */
 QStringList RS_Commands::complete(const QString& cmd) const {
     QStringList ret;
-    for(auto const& p: mainCommands){
-        if(p.first.startsWith(cmd, Qt::CaseInsensitive)){
-            ret << p.first;
-        }
+    // all keys starting with the prefix follow each other in the sorted index
+    QString const prefix = cmd.toLower();
+    for(auto it = completionIndex.lower_bound(prefix);
+        it != completionIndex.end() && it->first.startsWith(prefix); ++it){
+        ret << it->second;
     }
     ret.sort();
 
@@ -1320,10 +1340,11 @@ RS2::ActionType RS_Commands::cmdToAction(const QString& cmd, bool verbose) const
     RS2::ActionType ret = RS2::ActionNone;
 
     // find command:
-    for(const auto& table: {mainCommands, shortCommands})
+    for(const auto* table: {&mainCommands, &shortCommands})
     {
-        if (table.count(cmd)) {
-            ret = table.at(cmd);
+        auto it = table->find(cmd);
+        if (it != table->end()) {
+            ret = it->second;
             break;
         }
     }
@@ -1332,15 +1353,14 @@ RS2::ActionType RS_Commands::cmdToAction(const QString& cmd, bool verbose) const
 
     if (!verbose) return ret;
     // find full command to confirm to user:
-    for(auto const& p: mainCommands){
-        if(p.second==ret){
-            RS_DEBUG->print("RS_Commands::cmdToAction: commandMessage");
-            RS_DIALOGFACTORY->commandMessage(QObject::tr("Command: %1 (%2)").arg(full).arg(p.first));
-            //                                        RS_DialogFactory::instance()->commandMessage( QObject::tr("Command: %1").arg(full));
-            RS_DEBUG->print("RS_Commands::cmdToAction: "
-                            "commandMessage: ok");
-            return ret;
-        }
+    auto it = actionCommands.find(ret);
+    if (it != actionCommands.end()) {
+        RS_DEBUG->print("RS_Commands::cmdToAction: commandMessage");
+        RS_DIALOGFACTORY->commandMessage(QObject::tr("Command: %1 (%2)").arg(full).arg(it->second));
+        //                                        RS_DialogFactory::instance()->commandMessage( QObject::tr("Command: %1").arg(full));
+        RS_DEBUG->print("RS_Commands::cmdToAction: "
+                        "commandMessage: ok");
+        return ret;
     }
     RS_DEBUG->print(QObject::tr("RS_Commands:: command not found: %1").arg(full).toStdString().c_str());
     return ret;
@@ -82,6 +82,10 @@ private:
     std::map<QString, RS2::ActionType> shortCommands;
     // key=english command , value = translated
     std::map<QString, QString> cmdTranslation;
+    // key=lower case main command, value = main command
+    std::multimap<QString, QString> completionIndex;
+    // key=action, value = first main command of the action
+    std::map<RS2::ActionType, QString> actionCommands;
 };
 
 #endif
@@ -0,0 +1,186 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <vector>
+
+#include "lc_snapengine.h"
+#include "lc_snappointcache.h"
+#include "lc_spatialindex.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+#include "rs_information.h"
+#include "rs_layer.h"
+#include "rs_snapper.h"
+
+namespace {
+
+// whether snapping to the entity is allowed
+bool isSnappable(const RS_Entity& entity)
+{
+    return entity.isVisible() && !entity.getParent()->ignoredSnap();
+}
+
+// the nearest entity as by RS_EntityContainer::getNearestEntity() among the candidates,
+// which are in the container order
+RS_Entity* getNearestEntity(const std::vector<RS_Entity*>& candidates, const RS_Vector& coord,
+                            RS2::ResolveLevel level, double& distance)
+{
+    RS_Entity* nearest = nullptr;
+    distance = RS_MAXDOUBLE;
+    for (RS_Entity* candidate: candidates) {
+        if (!candidate->isVisible() || (candidate->getLayer() != nullptr && candidate->getLayer()->isLocked()))
+            continue;
+        if (level == RS2::ResolveAllButTextImage && candidate->rtti() == RS2::EntityImage)
+            continue;
+        RS_Entity* subEntity = nullptr;
+        const double d = candidate->getDistanceToPoint(coord, &subEntity, level, RS_MAXDOUBLE);
+        // prefer the last one of equal distance, the one drawn on top
+        if (d <= distance) {
+            distance = d;
+            nearest = (level == RS2::ResolveNone) ? candidate : subEntity;
+        }
+    }
+    return (nearest != nullptr && nearest->isVisible()) ? nearest : nullptr;
+}
+}
+
+LC_SnapEngine::LC_SnapEngine(const RS_EntityContainer& container):
+    m_container{container}
+{
+}
+
+void LC_SnapEngine::setPointCache(const LC_SnapPointCache* cache)
+{
+    m_pointCache = cache;
+}
+
+bool LC_SnapEngine::snap(const RS_Vector& coord, double range, const RS_SnapMode& mode,
+                         int middlePoints, double snapDistance, Result& result) const
+{
+    result = {};
+    const LC_SpatialIndex* index = m_container.getSpatialIndex();
+    if (index == nullptr || !coord.valid || !(range > 0.))
+        return false;
+
+    const RS_Vector corner{range, range};
+    const std::vector<RS_Entity*> candidates = index->queryWindow(coord - corner, coord + corner);
+
+    double minDist = RS_MAXDOUBLE;
+    auto consider = [&coord, range, &minDist, &result](const RS_Vector& point) {
+        const double d = coord.distanceTo(point);
+        if (point.valid && d <= range && d < minDist) {
+            minDist = d;
+            result.point = point;
+        }
+    };
+
+    unsigned kinds = 0;
+    if (mode.snapEndpoint)
+        kinds |= LC_SnapPointCache::Endpoint;
+    if (mode.snapCenter)
+        kinds |= LC_SnapPointCache::Center;
+    if (mode.snapMiddle)
+        kinds |= LC_SnapPointCache::Middle;
+    if (mode.snapIntersection)
+        kinds |= LC_SnapPointCache::Intersection;
+    const LC_SnapPointCache* cache = (m_pointCache != nullptr && m_pointCache->covers(coord, range, kinds))
+            ? m_pointCache : nullptr;
+    auto uncached = [cache](const RS_Entity* en) {
+        return cache == nullptr || !cache->contains(en);
+    };
+
+    if (mode.snapEndpoint) {
+        if (cache != nullptr)
+            consider(cache->getNearest(coord, range, LC_SnapPointCache::Endpoint));
+        for (RS_Entity* en: candidates)
+            if (uncached(en) && en->isVisible() && !en->getParent()->ignoredOnModification())
+                consider(en->getNearestEndpoint(coord, nullptr));
+    }
+    if (mode.snapCenter) {
+        if (cache != nullptr)
+            consider(cache->getNearest(coord, range, LC_SnapPointCache::Center));
+        for (RS_Entity* en: candidates)
+            if (uncached(en) && isSnappable(*en))
+                consider(en->getNearestCenter(coord, nullptr));
+    }
+    if (mode.snapMiddle) {
+        if (cache != nullptr)
+            consider(cache->getNearest(coord, range, LC_SnapPointCache::Middle));
+        for (RS_Entity* en: candidates)
+            if (uncached(en) && isSnappable(*en))
+                consider(en->getNearestMiddle(coord, nullptr, middlePoints));
+    }
+
+    // the nearest entity is the same as found in the whole container, if it's within the range
+    double nearestDist = RS_MAXDOUBLE;
+    RS_Entity* nearest = (mode.snapDistance || mode.snapOnEntity)
+            ? getNearestEntity(candidates, coord, RS2::ResolveNone, nearestDist) : nullptr;
+    if (nearestDist > range)
+        nearest = nullptr;
+
+    if (mode.snapDistance && nearest != nullptr)
+        consider(nearest->getNearestDist(snapDistance, coord, nullptr));
+
+    if (mode.snapIntersection) {
+        double closestDist = RS_MAXDOUBLE;
+        RS_Entity* closest = getNearestEntity(candidates, coord, RS2::ResolveAllButTextImage, closestDist);
+        const bool cachedIntersections = cache != nullptr && closest != nullptr
+                && LC_SpatialIndex::hasValidBox(*closest);
+        if (cachedIntersections && closestDist <= range) {
+            consider(cache->getNearestIntersection(*closest, coord, range));
+        } else if (closest != nullptr && closestDist <= range) {
+            auto checkEntity = [&coord, closest, &consider](RS_Entity* en) {
+                if (!isSnappable(*en))
+                    return;
+                const RS_VectorSolutions sol = RS_Information::getIntersection(closest, en, true);
+                if (sol.getNumber() > 0)
+                    consider(sol.getClosest(coord, nullptr, nullptr));
+            };
+            for (RS_Entity* candidate: candidates) {
+                const bool resolve = candidate->isContainer()
+                        && candidate->rtti() != RS2::EntityText && candidate->rtti() != RS2::EntityMText;
+                if (!resolve) {
+                    checkEntity(candidate);
+                    continue;
+                }
+                auto* ec = static_cast<RS_EntityContainer*>(candidate);
+                for (RS_Entity* en: ec->getEntityRange(RS2::ResolveAllButTextImage))
+                    checkEntity(en);
+            }
+        }
+    }
+
+    if (mode.snapOnEntity) {
+        const bool pointSnaps = mode.snapEndpoint || mode.snapCenter || mode.snapMiddle
+                || mode.snapDistance || mode.snapIntersection;
+        // without a point found, the closest one is beyond the range
+        if (result.point.valid ? minDist > mode.distance : (!pointSnaps || range >= mode.distance)) {
+            if (nearest != nullptr && isSnappable(*nearest)) {
+                result.onEntityChecked = true;
+                consider(nearest->getNearestPointOnEntity(coord, true, nullptr, &result.keyEntity));
+            }
+        }
+    }
+
+    return result.point.valid;
+}
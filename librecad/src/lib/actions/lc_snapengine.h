@@ -0,0 +1,80 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_SNAPENGINE_H
+#define LC_SNAPENGINE_H
+
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+class LC_SnapPointCache;
+struct RS_SnapMode;
+
+/**
+ * @brief The LC_SnapEngine class, finds the entity snap point closest to the cursor for all enabled
+ * snap modes by one spatial index query of the entities around the cursor.
+ *
+ * Candidates are ranked as RS_Snapper does for the individual snap functions: the closest of the
+ * end, center, middle, distance and intersection points wins, ties in this order; a point on an
+ * entity is only considered, if no other point is within the snap mode distance.
+ *
+ * A snap point within the range is the same as found by scanning the whole container, because
+ * it lies within the bounding box of its entity. Points beyond the range can't be found locally:
+ * the caller falls back to the container scans, if it still needs them.
+ */
+class LC_SnapEngine {
+public:
+    struct Result {
+        // the snap point, invalid if none
+        RS_Vector point{false};
+        // whether the point on entity snap was evaluated, and the entity it is on
+        bool onEntityChecked = false;
+        RS_Entity* keyEntity = nullptr;
+    };
+
+    explicit LC_SnapEngine(const RS_EntityContainer& container);
+
+    /**
+     * @brief setPointCache - the end, center and middle points of the entities contained in the cache
+     * are taken from the cache, if it covers the range around the cursor
+     */
+    void setPointCache(const LC_SnapPointCache* cache);
+
+    /**
+     * @brief snap - find the snap point closest to coord
+     * @param range - the search radius
+     * @param middlePoints - the number of equidistant middle points
+     * @param snapDistance - the distance for distance snapping
+     * @return false, if the result can't be decided locally: the container has no spatial index,
+     * or no snap point is within the range
+     */
+    bool snap(const RS_Vector& coord, double range, const RS_SnapMode& mode,
+              int middlePoints, double snapDistance, Result& result) const;
+
+private:
+    const RS_EntityContainer& m_container;
+    const LC_SnapPointCache* m_pointCache = nullptr;
+};
+
+#endif // LC_SNAPENGINE_H
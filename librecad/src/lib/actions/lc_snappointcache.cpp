@@ -0,0 +1,287 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+
+#include "lc_snappointcache.h"
+#include "lc_spatialindex.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_entitycontainer.h"
+#include "rs_information.h"
+#include "rs_line.h"
+#include "rs_math.h"
+#include "rs_point.h"
+
+namespace {
+
+// whether snapping to the center and middle points of the entity is allowed
+bool isSnappable(const RS_Entity& entity)
+{
+    return entity.isVisible() && !entity.getParent()->ignoredSnap();
+}
+
+// whether the snap points of the entity are found as by its getNearest...() methods
+bool isCacheable(const RS_Entity& entity)
+{
+    switch (entity.rtti()) {
+    case RS2::EntityLine:
+        return entity.getLength() > RS_TOLERANCE;
+    case RS2::EntityCircle:
+        return static_cast<const RS_Circle&>(entity).getRadius() > RS_TOLERANCE;
+    case RS2::EntityArc:
+    case RS2::EntityPoint:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+std::size_t LC_SnapPointCache::CellHash::operator () (const Cell& cell) const
+{
+    const std::size_t hx = std::hash<std::int64_t>{}(cell.x);
+    return hx ^ (std::hash<std::int64_t>{}(cell.y) + 0x9e3779b97f4a7c15ULL + (hx << 6) + (hx >> 2));
+}
+
+void LC_SnapPointCache::invalidate()
+{
+    m_valid = false;
+    m_cells.clear();
+    m_entities.clear();
+    m_intersections.clear();
+}
+
+void LC_SnapPointCache::prepare(const RS_EntityContainer& container, const LC_Rect& visibleArea, double range,
+                                unsigned kinds, int middlePoints)
+{
+    const LC_SpatialIndex* index = container.getSpatialIndex();
+    if (index == nullptr || kinds == 0 || !(range > 0.)) {
+        invalidate();
+        return;
+    }
+    // a cell size far off the range makes queries visit too many cells, or too many points
+    if (m_valid && m_container == &container && m_kinds == kinds && m_middlePoints == middlePoints
+            && visibleArea.inArea(m_area) && range >= 0.25 * m_cellSize && range <= 4. * m_cellSize)
+        return;
+
+    invalidate();
+    m_container = &container;
+    m_kinds = kinds;
+    m_middlePoints = middlePoints;
+    m_cellSize = range;
+    // some margin around the visible area, to keep the cache while panning
+    m_area = visibleArea.increaseBy(0.5 * std::max(visibleArea.width(), visibleArea.height()));
+
+    for (RS_Entity* en: index->queryWindow(m_area.minP(), m_area.maxP())) {
+        const bool endpoints = en->isVisible() && !en->getParent()->ignoredOnModification();
+        if (addEntity(*en, endpoints, isSnappable(*en)))
+            m_entities.insert(en);
+    }
+    m_valid = true;
+}
+
+bool LC_SnapPointCache::covers(const RS_Vector& coord, double radius, unsigned kinds) const
+{
+    return m_valid && (kinds & ~m_kinds) == 0 && radius <= 4. * m_cellSize
+            && m_area.inArea(coord, -radius);
+}
+
+bool LC_SnapPointCache::contains(const RS_Entity* entity) const
+{
+    return m_entities.count(entity) > 0;
+}
+
+RS_Vector LC_SnapPointCache::getNearest(const RS_Vector& coord, double radius, Kind kind) const
+{
+    RS_Vector nearest{false};
+    double minDist = RS_MAXDOUBLE;
+    const Cell from = getCell(coord - RS_Vector{radius, radius});
+    const Cell to = getCell(coord + RS_Vector{radius, radius});
+    for (std::int64_t x = from.x; x <= to.x; ++x) {
+        for (std::int64_t y = from.y; y <= to.y; ++y) {
+            auto it = m_cells.find({x, y});
+            if (it == m_cells.end())
+                continue;
+            for (const Point& point: it->second) {
+                if (point.kind != kind)
+                    continue;
+                const double d = coord.distanceTo(point.point);
+                if (d <= radius && d < minDist) {
+                    minDist = d;
+                    nearest = point.point;
+                }
+            }
+        }
+    }
+    return nearest;
+}
+
+RS_Vector LC_SnapPointCache::getNearestIntersection(const RS_Entity& entity, const RS_Vector& coord,
+                                                    double radius) const
+{
+    auto it = m_intersections.find(&entity);
+    if (it == m_intersections.end()) {
+        std::vector<RS_Vector>& points = m_intersections[&entity];
+        // intersections are within the bounding boxes of both entities
+        const RS_Vector from = RS_Vector::maximum(entity.getMin(), m_area.minP());
+        const RS_Vector to = RS_Vector::minimum(entity.getMax(), m_area.maxP());
+        const LC_SpatialIndex* index = m_container->getSpatialIndex();
+        if (index != nullptr && LC_SpatialIndex::hasValidBox(entity) && from.x <= to.x && from.y <= to.y) {
+            auto addIntersections = [&entity, &points](RS_Entity* other) {
+                if (!isSnappable(*other))
+                    return;
+                for (const RS_Vector& point: RS_Information::getIntersection(&entity, other, true))
+                    if (point.valid)
+                        points.push_back(point);
+            };
+            for (RS_Entity* candidate: index->queryWindow(from, to)) {
+                const bool resolve = candidate->isContainer()
+                        && candidate->rtti() != RS2::EntityText && candidate->rtti() != RS2::EntityMText;
+                if (!resolve) {
+                    addIntersections(candidate);
+                    continue;
+                }
+                auto* ec = static_cast<RS_EntityContainer*>(candidate);
+                for (RS_Entity* en: ec->getEntityRange(RS2::ResolveAllButTextImage))
+                    addIntersections(en);
+            }
+        }
+        it = m_intersections.find(&entity);
+    }
+
+    RS_Vector nearest{false};
+    double minDist = RS_MAXDOUBLE;
+    for (const RS_Vector& point: it->second) {
+        const double d = coord.distanceTo(point);
+        if (d <= radius && d < minDist) {
+            minDist = d;
+            nearest = point;
+        }
+    }
+    return nearest;
+}
+
+LC_SnapPointCache::Cell LC_SnapPointCache::getCell(const RS_Vector& point) const
+{
+    return {static_cast<std::int64_t>(std::floor(point.x / m_cellSize)),
+            static_cast<std::int64_t>(std::floor(point.y / m_cellSize))};
+}
+
+void LC_SnapPointCache::add(const RS_Vector& point, Kind kind)
+{
+    if (point.valid && (m_kinds & kind) != 0)
+        m_cells[getCell(point)].push_back({point, kind});
+}
+
+bool LC_SnapPointCache::addEntity(const RS_Entity& entity, bool endpoints, bool snappable)
+{
+    const int counts = m_middlePoints + 1;
+    switch (entity.rtti()) {
+    case RS2::EntityLine: {
+        if (!isCacheable(entity))
+            return false;
+        const auto& line = static_cast<const RS_Line&>(entity);
+        if (endpoints) {
+            add(line.getStartpoint(), Endpoint);
+            add(line.getEndpoint(), Endpoint);
+        }
+        if (snappable) {
+            // the equidistant points without the end points, as in RS_Line::getNearestMiddle()
+            const RS_Vector dvp = line.getEndpoint() - line.getStartpoint();
+            for (int i = (counts == 1) ? 0 : 1; i < counts; ++i)
+                add(line.getStartpoint() + dvp * (double(i) / double(counts)), Middle);
+        }
+        return true;
+    }
+    case RS2::EntityArc: {
+        const auto& arc = static_cast<const RS_Arc&>(entity);
+        if (endpoints) {
+            add(arc.getStartpoint(), Endpoint);
+            add(arc.getEndpoint(), Endpoint);
+        }
+        if (snappable) {
+            add(arc.getCenter(), Center);
+            // as in RS_Arc::getNearestMiddle()
+            double amin = arc.getAngle1();
+            double amax = arc.getAngle2();
+            if (std::isnormal(amin) || std::isnormal(amax)) {
+                if (arc.isReversed())
+                    std::swap(amin, amax);
+                double da = std::fmod(amax - amin + 2. * M_PI, 2. * M_PI);
+                if (da < RS_TOLERANCE)
+                    da = 2. * M_PI;
+                for (int i = (counts == 1) ? 0 : 1; i < counts; ++i)
+                    add(arc.getCenter() + RS_Vector::polar(arc.getRadius(), amin + da * (double(i) / double(counts))),
+                        Middle);
+            }
+        }
+        return true;
+    }
+    case RS2::EntityCircle: {
+        if (!isCacheable(entity))
+            return false;
+        const auto& circle = static_cast<const RS_Circle&>(entity);
+        // as in RS_Circle::getNearestMiddle(): the quadrant points are the end points
+        const double step = M_PI_2 / counts;
+        for (int j = 0; j < 4 * counts; ++j) {
+            const RS_Vector point = circle.getCenter() + RS_Vector::polar(circle.getRadius(), step * j);
+            const bool quadrant = (j % counts) == 0;
+            if (quadrant && endpoints)
+                add(point, Endpoint);
+            if (snappable && (m_middlePoints == 0 || !quadrant))
+                add(point, Middle);
+        }
+        if (snappable)
+            add(circle.getCenter(), Center);
+        return true;
+    }
+    case RS2::EntityPoint: {
+        const RS_Vector pos = static_cast<const RS_Point&>(entity).getPos();
+        if (endpoints)
+            add(pos, Endpoint);
+        if (snappable) {
+            add(pos, Center);
+            add(pos, Middle);
+        }
+        return true;
+    }
+    case RS2::EntityPolyline: {
+        // the points of the segments, as by RS_EntityContainer, if all segments can be cached
+        const auto& polyline = static_cast<const RS_EntityContainer&>(entity);
+        for (RS_Entity* segment: polyline) {
+            const RS2::EntityType type = segment->rtti();
+            if ((type != RS2::EntityLine && type != RS2::EntityArc) || !isCacheable(*segment))
+                return false;
+        }
+        for (RS_Entity* segment: polyline) {
+            if (segment->isVisible())
+                addEntity(*segment, endpoints, snappable);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,128 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_SNAPPOINTCACHE_H
+#define LC_SNAPPOINTCACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "lc_rect.h"
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+
+/**
+ * @brief The LC_SnapPointCache class, the end, center and middle snap points of the entities around
+ * the visible area of a view, in a grid of cells sized by the snap range.
+ *
+ * The points don't change while the cursor just moves, so the cache is built once for the visible area
+ * and kept, until the drawing changes, the view zooms, or pans out of the cached area. Points are only
+ * cached for the lines, arcs, circles and points, and polylines of lines and arcs; other entities are
+ * not contained, and their snap points are found by the entities themselves. The intersections of an
+ * entity with the others are cached once it was the nearest one to the cursor.
+ */
+class LC_SnapPointCache {
+public:
+    enum Kind : unsigned {
+        Endpoint = 1,
+        Center = 2,
+        Middle = 4,
+        // intersections are computed on demand, for each entity nearest to the cursor
+        Intersection = 8
+    };
+
+    /**
+     * @brief invalidate - drops the cached points, must be called after the drawing changed
+     */
+    void invalidate();
+
+    /**
+     * @brief prepare - builds the cache, unless it's built for the same container, kinds and number of
+     * middle points, with a cell size usable for the range, and an area covering the visible area
+     * @param visibleArea - the visible area in graph coordinates
+     * @param range - the snap range, the radius of queries
+     * @param kinds - the Kind flags of the points to cache
+     */
+    void prepare(const RS_EntityContainer& container, const LC_Rect& visibleArea, double range,
+                 unsigned kinds, int middlePoints);
+
+    /**
+     * @return whether queries of the kinds within the radius around the point are answered by the cache
+     */
+    bool covers(const RS_Vector& coord, double radius, unsigned kinds) const;
+
+    /**
+     * @return whether the snap points of the entity are in the cache
+     */
+    bool contains(const RS_Entity* entity) const;
+
+    /**
+     * @return the cached point of the kind nearest to coord within the radius, invalid if none
+     */
+    RS_Vector getNearest(const RS_Vector& coord, double radius, Kind kind) const;
+
+    /**
+     * @brief getNearestIntersection - the intersection of the entity with the snappable entities of the
+     * container nearest to coord within the radius, invalid if none. The intersections of an entity are
+     * computed for the whole cached area on the first query, and kept for the following ones
+     * @param entity - a bounded entity, as found by getNearestEntity() with ResolveAllButTextImage
+     */
+    RS_Vector getNearestIntersection(const RS_Entity& entity, const RS_Vector& coord, double radius) const;
+
+private:
+    struct Point {
+        RS_Vector point;
+        Kind kind = Endpoint;
+    };
+    struct Cell {
+        std::int64_t x = 0;
+        std::int64_t y = 0;
+        bool operator == (const Cell& other) const {
+            return x == other.x && y == other.y;
+        }
+    };
+    struct CellHash {
+        std::size_t operator () (const Cell& cell) const;
+    };
+
+    Cell getCell(const RS_Vector& point) const;
+    void add(const RS_Vector& point, Kind kind);
+    // adds the points of an entity, false if its points can't be cached
+    bool addEntity(const RS_Entity& entity, bool endpoints, bool snappable);
+
+    bool m_valid = false;
+    const RS_EntityContainer* m_container = nullptr;
+    LC_Rect m_area;
+    double m_cellSize = 1.;
+    unsigned m_kinds = 0;
+    int m_middlePoints = 1;
+    std::unordered_map<Cell, std::vector<Point>, CellHash> m_cells;
+    std::unordered_set<const RS_Entity*> m_entities;
+    mutable std::unordered_map<const RS_Entity*, std::vector<RS_Vector>> m_intersections;
+};
+
+#endif // LC_SNAPPOINTCACHE_H
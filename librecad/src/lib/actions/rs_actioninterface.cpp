@@ -137,6 +137,16 @@ void RS_ActionInterface::init(int status)
  */
 void RS_ActionInterface::mouseMoveEvent(QMouseEvent*) {}
 
+/**
+ * Mouse moves quicker than the frames of the screen are coalesced by the
+ * graphic view, only the latest one is passed to the action.
+ * Should be overwritten by actions using every position of the cursor.
+ * @return true, if every mouse move is passed to mouseMoveEvent()
+ */
+bool RS_ActionInterface::handlesEveryMouseMove() const {
+    return false;
+}
+
 /**
  * Called when the left mouse button is pressed and this is the
  * current action.
@@ -67,6 +67,7 @@ public:
 
     virtual void init(int status=0);
     virtual void mouseMoveEvent(QMouseEvent*);
+    virtual bool handlesEveryMouseMove() const;
     virtual void mousePressEvent(QMouseEvent*);
 
     virtual void mouseReleaseEvent(QMouseEvent*);
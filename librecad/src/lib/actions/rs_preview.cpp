@@ -30,6 +30,7 @@
 #include "rs_line.h"
 #include "rs_preview.h"
 #include "rs_settings.h"
+#include "lc_spatialindex.h"
 
 /**
  * Constructor.
@@ -37,14 +38,18 @@
 RS_Preview::RS_Preview(RS_EntityContainer* parent)
         : RS_EntityContainer(parent, true)
 {
-    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Appearance");
-    maxEntities = RS_SETTINGS->readNumEntry("/MaxPreview", 100);
+    maxEntities = RS_SETTINGS->snapshot().maxPreview;
 
-    groupGuard = RS_SETTINGS->beginGroupGuard("/Colors");
+    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Colors");
     RS_Color highLight = QColor(RS_SETTINGS->readEntry("/highlight", RS_Settings::highlight));
     setPen(RS_Pen(highLight, RS2::Width00, RS2::SolidLine));
 }
 
+RS_Preview::~RS_Preview() {
+    // the entities in the arena are destroyed before it
+    clear();
+}
+
 /**
  * Adds an entity to this preview and removes any attributes / layer
  * connections before that.
@@ -71,24 +76,8 @@ void RS_Preview::addEntity(RS_Entity* entity) {
     }
 
     if (addBorder) {
-        RS_Vector min = entity->getMin();
-        RS_Vector max = entity->getMax();
-
-        RS_Line* l1 =
-			new RS_Line(this, {min.x, min.y}, {max.x, min.y});
-        RS_Line* l2 =
-			new RS_Line(this, {max.x, min.y}, {max.x, max.y});
-        RS_Line* l3 =
-			new RS_Line(this, {max.x, max.y}, {min.x, max.y});
-        RS_Line* l4 =
-			new RS_Line(this, {min.x, max.y}, {min.x, min.y});
-
-        RS_EntityContainer::addEntity(l1);
-        RS_EntityContainer::addEntity(l2);
-        RS_EntityContainer::addEntity(l3);
-        RS_EntityContainer::addEntity(l4);
-
-        delete entity;
+        this->addBorder(entity->getMin(), entity->getMax());
+        destroy(entity);
     } else {
         entity->setLayer(nullptr);
         entity->setSelected(false);
@@ -98,6 +87,61 @@ void RS_Preview::addEntity(RS_Entity* entity) {
     }
 }
 
+/**
+ * Removes an entity, which is deleted or destroyed in the frame arena.
+ */
+bool RS_Preview::removeEntity(RS_Entity* entity) {
+    if (!frameArena.owns(entity))
+        return RS_EntityContainer::removeEntity(entity);
+    setOwner(false);
+    const bool ret = RS_EntityContainer::removeEntity(entity);
+    setOwner(true);
+    if (ret)
+        entity->~RS_Entity();
+    return ret;
+}
+
+/**
+ * Removes all entities, and releases the frame arena for the next preview.
+ */
+void RS_Preview::clear() {
+    if (frameArena.isEmpty()) {
+        RS_EntityContainer::clear();
+        return;
+    }
+    for (RS_Entity* entity: std::as_const(entities))
+        destroy(entity);
+    entities.clear();
+    RS_EntityContainer::clear();
+    frameArena.reset();
+}
+
+void RS_Preview::destroy(RS_Entity* entity) {
+    if (frameArena.owns(entity))
+        entity->~RS_Entity();
+    else
+        delete entity;
+}
+
+/**
+ * Adds the rectangle from min to max, previewing entities by their borders.
+ */
+void RS_Preview::addBorder(const RS_Vector& min, const RS_Vector& max) {
+    RS_Line* l1 =
+        new RS_Line(this, {min.x, min.y}, {max.x, min.y});
+    RS_Line* l2 =
+        new RS_Line(this, {max.x, min.y}, {max.x, max.y});
+    RS_Line* l3 =
+        new RS_Line(this, {max.x, max.y}, {min.x, max.y});
+    RS_Line* l4 =
+        new RS_Line(this, {min.x, max.y}, {min.x, min.y});
+
+    RS_EntityContainer::addEntity(l1);
+    RS_EntityContainer::addEntity(l2);
+    RS_EntityContainer::addEntity(l3);
+    RS_EntityContainer::addEntity(l4);
+}
+
 /**
  * Clones the given entity and adds the clone to the preview.
  */
@@ -132,12 +176,19 @@ void RS_Preview::addAllFrom(RS_EntityContainer& container) {
 
 /**
  * Adds all selected entities from 'container' to the preview (unselected).
+ * Beyond the preview limit, the remaining selected entities are previewed
+ * by their common bounding box.
  */
 void RS_Preview::addSelectionFrom(RS_EntityContainer& container) {
 	int c=0;
+	bool overflow = false;
+	RS_Vector overflowMin, overflowMax;
 	for(auto e: container){
 
-        if (e->isSelected() && c<maxEntities) {
+        if (!e->isSelected() || e->isUndone()) {
+            continue;
+        }
+        if (c<maxEntities) {
             RS_Entity* clone = e->clone();
             clone->setSelected(false);
             clone->reparent(this);
@@ -145,8 +196,37 @@ void RS_Preview::addSelectionFrom(RS_EntityContainer& container) {
             c+=clone->countDeep();
             addEntity(clone);
             // clone might be nullptr after this point
+        } else if (overflow) {
+            overflowMin = RS_Vector::minimum(overflowMin, e->getMin());
+            overflowMax = RS_Vector::maximum(overflowMax, e->getMax());
+        } else {
+            overflowMin = e->getMin();
+            overflowMax = e->getMax();
+            overflow = true;
         }
     }
+    if (overflow) {
+        addBorder(overflowMin, overflowMax);
+    }
+}
+
+void RS_Preview::addCachedSelectionFrom(RS_EntityContainer& container) {
+    if (selectionCache == nullptr || selectionSource != &container) {
+        selectionCache = std::make_unique<RS_Preview>(getParent());
+        selectionCache->addSelectionFrom(container);
+        selectionSource = &container;
+    }
+    // the copies are prepared for previewing already
+    for(auto e: *selectionCache){
+        RS_Entity* clone = e->clone();
+        clone->reparent(this);
+        RS_EntityContainer::addEntity(clone);
+    }
+}
+
+void RS_Preview::clearSelectionCache() {
+    selectionCache.reset();
+    selectionSource = nullptr;
 }
 
 /**
@@ -157,7 +237,13 @@ void RS_Preview::addStretchablesFrom(RS_EntityContainer& container,
                                      const RS_Vector& v1, const RS_Vector& v2) {
     int c=0;
 
-	for(auto e: container){
+    // only entities with bounding boxes overlapping the window can be stretched
+    const LC_SpatialIndex* index = container.getSpatialIndex();
+    const std::vector<RS_Entity*> candidates = (index != nullptr)
+            ? index->queryWindow(v1, v2)
+            : std::vector<RS_Entity*>{container.begin(), container.end()};
+
+	for(auto e: candidates){
 
         if (e->isVisible() &&
                 e->rtti()!=RS2::EntityHatch &&
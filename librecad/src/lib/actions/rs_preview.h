@@ -28,6 +28,11 @@
 #ifndef RS_PREVIEW_H
 #define RS_PREVIEW_H
 
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "lc_framearena.h"
 #include "rs_entitycontainer.h"
 
 /**
@@ -40,12 +45,35 @@
 class RS_Preview : public RS_EntityContainer {
 public:
     RS_Preview(RS_EntityContainer* parent=nullptr);
+    ~RS_Preview() override;
     RS2::EntityType rtti() const override{
         return RS2::EntityPreview;
     }
     void addEntity(RS_Entity* entity) override;
+    /**
+     * Creates an entity for the preview in the frame arena of the preview,
+     * instead of the heap, for actions rebuilding the preview at every mouse move.
+     * The entity must be added to this preview, it's destroyed by clear() or
+     * removeEntity() and can't be moved to another container.
+     */
+    template<class T, class... Args>
+    T* create(Args&&... args)
+    {
+        // the global placement new, entities may have their own operator new
+        return ::new (frameArena.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+    bool removeEntity(RS_Entity* entity) override;
+    void clear() override;
     void addCloneOf(RS_Entity* entity);
     virtual void addSelectionFrom(RS_EntityContainer& container);
+    /**
+     * Like addSelectionFrom(), but the selection is only looked up and copied
+     * once: the copies are kept and added again on later calls for the same
+     * container, until clearSelectionCache(). Used by actions which preview
+     * the selection at every mouse move, while the selection doesn't change.
+     */
+    void addCachedSelectionFrom(RS_EntityContainer& container);
+    void clearSelectionCache();
     virtual void addAllFrom(RS_EntityContainer& container);
     virtual void addStretchablesFrom(RS_EntityContainer& container,
                                      const RS_Vector& v1, const RS_Vector& v2);
@@ -53,7 +81,16 @@ public:
     void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 
 private:
+    void addBorder(const RS_Vector& min, const RS_Vector& max);
+    // deletes an entity, or destroys it in place if it's in the frame arena
+    void destroy(RS_Entity* entity);
+
     int maxEntities = 0;
+    //! copies of the selection of selectionSource, for addCachedSelectionFrom()
+    std::unique_ptr<RS_Preview> selectionCache;
+    const RS_EntityContainer* selectionSource = nullptr;
+    //! the entities of create(), released together when the preview is cleared
+    LC_FrameArena frameArena;
 };
 
 #endif
@@ -25,6 +25,7 @@
 **********************************************************************/
 
 
+#include "lc_actionprofiler.h"
 #include "rs_debug.h"
 #include "rs_graphicview.h"
 #include "rs_preview.h"
@@ -65,6 +66,7 @@ RS_PreviewActionInterface::~RS_PreviewActionInterface() {
 
 void RS_PreviewActionInterface::init(int status) {
     deletePreview();
+    preview->clearSelectionCache();
     RS_ActionInterface::init(status);
 }
 
@@ -72,6 +74,7 @@ void RS_PreviewActionInterface::init(int status) {
 
 void RS_PreviewActionInterface::finish(bool updateTB) {
     deletePreview();
+    preview->clearSelectionCache();
     RS_ActionInterface::finish(updateTB);
 }
 
@@ -80,6 +83,7 @@ void RS_PreviewActionInterface::finish(bool updateTB) {
 void RS_PreviewActionInterface::suspend() {
     RS_ActionInterface::suspend();
     deletePreview();
+    preview->clearSelectionCache();
 }
 
 
@@ -94,6 +98,7 @@ void RS_PreviewActionInterface::resume() {
 void RS_PreviewActionInterface::trigger() {
     RS_ActionInterface::trigger();
     deletePreview();
+    preview->clearSelectionCache();
 }
 
 
@@ -101,6 +106,7 @@ void RS_PreviewActionInterface::trigger() {
  * Deletes the preview from the screen.
  */
 void RS_PreviewActionInterface::deletePreview() {
+    LC_ActionProfileScope profileScope{LC_ActionProfiler::Preview};
 		if (hasPreview){
                 //avoid deleting NULL or empty preview
             preview->clear();
@@ -117,6 +123,7 @@ void RS_PreviewActionInterface::deletePreview() {
  * Draws / deletes the current preview.
  */
 void RS_PreviewActionInterface::drawPreview() {
+    LC_ActionProfileScope profileScope{LC_ActionProfiler::Preview};
 	// RVT_PORT How does offset work??        painter->setOffset(offset);
 	RS_EntityContainer *container=graphicView->getOverlayContainer(RS2::ActionPreviewEntity);
 	container->clear();
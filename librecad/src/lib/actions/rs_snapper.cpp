@@ -29,6 +29,10 @@
 
 #include<QMouseEvent>
 
+#include "lc_actionprofiler.h"
+#include "lc_snapengine.h"
+#include "lc_snappointcache.h"
+#include "lc_tracing.h"
 #include "rs_circle.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
@@ -284,6 +288,8 @@ RS_Vector RS_Snapper::snapFree(QMouseEvent* e) {
  */
 RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
 {
+    LC_TRACE_SCOPE("RS_Snapper::snapPoint");
+    LC_ActionProfileScope profileScope{LC_ActionProfiler::Snap};
 	pImpData->snapSpot = RS_Vector(false);
     RS_Vector t(false);
 
@@ -296,62 +302,45 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
     RS_Vector mouseCoord = graphicView->toGraph(e->position());
     double ds2Min=RS_MAXDOUBLE*RS_MAXDOUBLE;
 
-    if (snapMode.snapEndpoint) {
-        t = snapEndpoint(mouseCoord);
-		double ds2=mouseCoord.squaredTo(t);
-
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-			pImpData->snapSpot = t;
-        }
-    }
-    if (snapMode.snapCenter) {
-        t = snapCenter(mouseCoord);
-		double ds2=mouseCoord.squaredTo(t);
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-			pImpData->snapSpot = t;
-        }
-    }
     if (snapMode.snapMiddle) {
-        //this is still brutal force
         //todo: accept value from widget QG_SnapMiddleOptions
 		RS_DIALOGFACTORY->requestSnapMiddleOptions(middlePoints, snapMode.snapMiddle);
-        t = snapMiddle(mouseCoord);
-		double ds2=mouseCoord.squaredTo(t);
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-			pImpData->snapSpot = t;
-        }
     }
     if (snapMode.snapDistance) {
-        //this is still brutal force
         //todo: accept value from widget QG_SnapDistOptions
 		RS_DIALOGFACTORY->requestSnapDistOptions(m_SnapDistance, snapMode.snapDistance);
-        t = snapDist(mouseCoord);
-		double ds2=mouseCoord.squaredTo(t);
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-			pImpData->snapSpot = t;
-        }
-    }
-    if (snapMode.snapIntersection) {
-        t = snapIntersection(mouseCoord);
-		double ds2=mouseCoord.squaredTo(t);
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-			pImpData->snapSpot = t;
-        }
     }
 
-    if (snapMode.snapOnEntity &&
-		pImpData->snapSpot.distanceTo(mouseCoord) > snapMode.distance) {
-        t = snapOnEntity(mouseCoord);
-		double ds2=mouseCoord.squaredTo(t);
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-			pImpData->snapSpot = t;
-        }
+    // all entity snap modes by one query of the entities around the cursor. The container is
+    // scanned for each mode only, if the closest point may be out of the snap range and is used
+    // the end, center, middle and intersection points come from the cache of the view, built once for
+    // its visible area
+    const double snapRange = getSnapRange();
+    unsigned cachedKinds = 0;
+    if (snapMode.snapEndpoint)
+        cachedKinds |= LC_SnapPointCache::Endpoint;
+    if (snapMode.snapCenter)
+        cachedKinds |= LC_SnapPointCache::Center;
+    if (snapMode.snapMiddle)
+        cachedKinds |= LC_SnapPointCache::Middle;
+    if (snapMode.snapIntersection)
+        cachedKinds |= LC_SnapPointCache::Intersection;
+    LC_SnapPointCache& pointCache = graphicView->getSnapPointCache();
+    pointCache.prepare(*container,
+                       LC_Rect{graphicView->toGraph(0, 0),
+                               graphicView->toGraph(graphicView->getWidth(), graphicView->getHeight())},
+                       snapRange, cachedKinds, middlePoints);
+    LC_SnapEngine engine{*container};
+    engine.setPointCache(&pointCache);
+
+    LC_SnapEngine::Result local;
+    if (engine.snap(mouseCoord, snapRange, snapMode, middlePoints, m_SnapDistance, local)) {
+        pImpData->snapSpot = local.point;
+        ds2Min = mouseCoord.squaredTo(local.point);
+        if (local.onEntityChecked)
+            keyEntity = local.keyEntity;
+    } else if (!snapMode.snapFree) {
+        ds2Min = snapEntities(mouseCoord);
     }
 
     if (snapMode.snapGrid) {
@@ -408,6 +397,70 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
 }
 
 
+/**
+ * Snaps to entities by each enabled snap mode, scanning the whole container.
+ *
+ * @return the squared distance to the closest snap point, which is set as the snap spot
+ */
+double RS_Snapper::snapEntities(const RS_Vector& mouseCoord)
+{
+    RS_Vector t(false);
+    double ds2Min=RS_MAXDOUBLE*RS_MAXDOUBLE;
+
+    if (snapMode.snapEndpoint) {
+        t = snapEndpoint(mouseCoord);
+		double ds2=mouseCoord.squaredTo(t);
+
+        if (ds2 < ds2Min){
+            ds2Min=ds2;
+			pImpData->snapSpot = t;
+        }
+    }
+    if (snapMode.snapCenter) {
+        t = snapCenter(mouseCoord);
+		double ds2=mouseCoord.squaredTo(t);
+        if (ds2 < ds2Min){
+            ds2Min=ds2;
+			pImpData->snapSpot = t;
+        }
+    }
+    if (snapMode.snapMiddle) {
+        t = snapMiddle(mouseCoord);
+		double ds2=mouseCoord.squaredTo(t);
+        if (ds2 < ds2Min){
+            ds2Min=ds2;
+			pImpData->snapSpot = t;
+        }
+    }
+    if (snapMode.snapDistance) {
+        t = snapDist(mouseCoord);
+		double ds2=mouseCoord.squaredTo(t);
+        if (ds2 < ds2Min){
+            ds2Min=ds2;
+			pImpData->snapSpot = t;
+        }
+    }
+    if (snapMode.snapIntersection) {
+        t = snapIntersection(mouseCoord);
+		double ds2=mouseCoord.squaredTo(t);
+        if (ds2 < ds2Min){
+            ds2Min=ds2;
+			pImpData->snapSpot = t;
+        }
+    }
+
+    if (snapMode.snapOnEntity &&
+		pImpData->snapSpot.distanceTo(mouseCoord) > snapMode.distance) {
+        t = snapOnEntity(mouseCoord);
+		double ds2=mouseCoord.squaredTo(t);
+        if (ds2 < ds2Min){
+            ds2Min=ds2;
+			pImpData->snapSpot = t;
+        }
+    }
+    return ds2Min;
+}
+
 /**manually set snapPoint*/
 RS_Vector RS_Snapper::snapPoint(const RS_Vector& coord, bool setSpot)
 {
@@ -691,7 +744,7 @@ RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos, RS2::EntityType enType,
 		break;
 	}
 
-	for(RS_Entity* en= container->firstEntity(level);en;en=container->nextEntity(level)){
+	for(RS_Entity* en: container->getEntityRange(level)){
         if(en->isVisible()==false) continue;
 		if(en->rtti() != enType && isContainer){
             //whether this entity is a member of member of the type enType
@@ -206,6 +206,7 @@ public:
 protected:
     void deleteSnapper();
     double getSnapRange() const;
+    double snapEntities(const RS_Vector& mouseCoord);
     RS_EntityContainer *container = nullptr;
     RS_GraphicView *graphicView = nullptr;
     RS_Entity *keyEntity = nullptr;
@@ -0,0 +1,86 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include "lc_librarypartcache.h"
+#include "rs_block.h"
+#include "rs_blocklist.h"
+#include "rs_debug.h"
+#include "rs_graphic.h"
+
+namespace {
+// the user variable marking blocks built for library parts
+const QString partVariable = QStringLiteral("LibraryPart");
+}
+
+LC_LibraryPartCache& LC_LibraryPartCache::instance() {
+    static LC_LibraryPartCache* cache = new LC_LibraryPartCache;
+    return *cache;
+}
+
+QString LC_LibraryPartCache::key(const QString& fileName) {
+    const QFileInfo fileInfo(fileName);
+    return fileInfo.canonicalFilePath() + '|'
+            + QString::number(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
+std::shared_ptr<RS_Graphic> LC_LibraryPartCache::part(const QString& fileName) {
+    if (!QFileInfo::exists(fileName))
+        return {};
+    const QString partKey = key(fileName);
+    auto it = std::find_if(m_parts.begin(), m_parts.end(), [&partKey](const Part& part) {
+        return part.key == partKey;
+    });
+    if (it != m_parts.end()) {
+        m_parts.splice(m_parts.begin(), m_parts, it);
+        return it->graphic;
+    }
+
+    auto graphic = std::make_shared<RS_Graphic>();
+    if (!graphic->open(fileName, RS2::FormatUnknown)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "LC_LibraryPartCache::part: Cannot open file: %s", fileName.toStdString().c_str());
+        return {};
+    }
+    m_parts.push_front({partKey, graphic});
+    if (m_parts.size() > maxParts)
+        m_parts.pop_back();
+    return graphic;
+}
+
+RS_Block* LC_LibraryPartCache::findBlock(const QString& fileName, RS_Graphic& graphic) const {
+    const QString partKey = key(fileName);
+    for (RS_Block* block: *graphic.getBlockList()) {
+        if (block->getUserDefVar(partVariable) == partKey)
+            return block;
+    }
+    return nullptr;
+}
+
+void LC_LibraryPartCache::setBlock(const QString& fileName, RS_Block& block) const {
+    block.setUserDefVar(partVariable, key(fileName));
+}
@@ -0,0 +1,73 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_LIBRARYPARTCACHE_H
+#define LC_LIBRARYPARTCACHE_H
+
+#include <list>
+#include <memory>
+
+#include <QString>
+
+class RS_Block;
+class RS_Graphic;
+
+/**
+ * @brief The LC_LibraryPartCache class, the library parts read for inserting.
+ * A part file is read once, by path and modification time, and the parts inserted
+ * last are kept. The block built for a part in a drawing is marked with the part, so
+ * the following inserts of the part into the drawing reuse the block.
+ */
+class LC_LibraryPartCache {
+public:
+    static LC_LibraryPartCache& instance();
+
+    /**
+     * @return the part read from the file, nullptr if the file can't be opened.
+     * The part is shared by the inserts: it's not to be changed.
+     */
+    std::shared_ptr<RS_Graphic> part(const QString& fileName);
+
+    /**
+     * @return the block built for the part of the file in the graphic,
+     * nullptr if there's none
+     */
+    RS_Block* findBlock(const QString& fileName, RS_Graphic& graphic) const;
+    //! marks the block built for the part of the file
+    void setBlock(const QString& fileName, RS_Block& block) const;
+
+private:
+    LC_LibraryPartCache() = default;
+    static QString key(const QString& fileName);
+
+    struct Part {
+        QString key;
+        std::shared_ptr<RS_Graphic> graphic;
+    };
+
+    static constexpr size_t maxParts = 16;
+    // the part inserted last first
+    std::list<Part> m_parts;
+};
+
+#endif // LC_LIBRARYPARTCACHE_H
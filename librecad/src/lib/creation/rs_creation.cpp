@@ -30,6 +30,7 @@
 #include <QFileInfo>
 
 #include "lc_hyperbola.h"
+#include "lc_librarypartcache.h"
 #include "lc_parabola.h"
 #include "lc_quadratic.h"
 #include "lc_splinepoints.h"
@@ -926,18 +927,36 @@ RS_Insert* RS_Creation::createLibraryInsert(RS_LibraryInsertData& data) {
 
     RS_DEBUG->print("RS_Creation::createLibraryInsert");
 
-    RS_Graphic g;
-    if (!g.open(data.file, RS2::FormatUnknown)) {
+    LC_LibraryPartCache& parts = LC_LibraryPartCache::instance();
+    const std::shared_ptr<RS_Graphic> g = parts.part(data.file);
+    if (g == nullptr) {
         RS_DEBUG->print(RS_Debug::D_WARNING,
                         "RS_Creation::createLibraryInsert: Cannot open file: %s", data.file.toStdString().c_str());
         return nullptr;
     }
 
-    // unit conversion:
+    // unit conversion, with the scale of the insert as the part is shared:
+    double factor = (RS_TOLERANCE < std::abs(data.factor)) ? data.factor : 1.0;
     if (graphic) {
-        double uf = RS_Units::convert(1.0, g.getUnit(),
-                                      graphic->getUnit());
-        g.scale(RS_Vector(0.0, 0.0), RS_Vector(uf, uf));
+        factor *= RS_Units::convert(1.0, g->getUnit(), graphic->getUnit());
+    }
+
+    // the part was inserted before: insert its block again
+    RS_Block* block = (graphic != nullptr) ? parts.findBlock(data.file, *graphic) : nullptr;
+    if (block != nullptr && document != nullptr) {
+        RS_InsertData di(block->getName(), data.insertionPoint, RS_Vector(factor, factor),
+                         0., 1, 1, RS_Vector(0.0, 0.0));
+        auto* insert = new RS_Insert(document, di);
+        insert->setLayerToActive();
+        insert->setPenToActive();
+        document->addEntity(insert);
+        insert->update();
+
+        LC_UndoSection undo(document, handleUndo);
+        undo.addUndoable(insert);
+
+        RS_DEBUG->print("RS_Creation::createLibraryInsert: OK");
+        return insert;
     }
 
     //g.scale(RS_Vector(data.factor, data.factor));
@@ -947,16 +966,29 @@ RS_Insert* RS_Creation::createLibraryInsert(RS_LibraryInsertData& data) {
     s = QFileInfo(data.file).completeBaseName();
 
     RS_Modification m(*container, graphicView);
+    auto lastEntity = [this]() {
+        return (document != nullptr && !document->isEmpty()) ? document->last() : nullptr;
+    };
+    const RS_Entity* last = lastEntity();
     m.paste(
                 RS_PasteData(
                     data.insertionPoint,
-                    data.factor, data.angle, true,
+                    factor, data.angle, true,
                     s),
-                &g);
+                g.get());
+
+    // the insert of the paste block
+    RS_Insert* insert = nullptr;
+    RS_Entity* pasted = lastEntity();
+    if (pasted != nullptr && pasted != last && pasted->rtti() == RS2::EntityInsert) {
+        insert = static_cast<RS_Insert*>(pasted);
+        if (insert->getBlockForInsert() != nullptr)
+            parts.setBlock(data.file, *insert->getBlockForInsert());
+    }
 
     RS_DEBUG->print("RS_Creation::createLibraryInsert: OK");
 
-    return nullptr;
+    return insert;
 }
 
 void RS_Creation::setEntity(RS_Entity* en) const
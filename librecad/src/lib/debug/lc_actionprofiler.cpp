@@ -0,0 +1,163 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <chrono>
+
+#include <QFile>
+#include <QObject>
+#include <QTextStream>
+
+#include "lc_actionprofiler.h"
+#include "rs_debug.h"
+
+namespace {
+
+struct ProfileData {
+    std::map<QString, LC_ActionProfiler::Timings> timings;
+    // the timings of the current action
+    LC_ActionProfiler::Timings* current = nullptr;
+    QString currentName;
+};
+
+ProfileData& profileData()
+{
+    static ProfileData s_data;
+    return s_data;
+}
+
+double toMs(std::int64_t us)
+{
+    return us * 1e-3;
+}
+}
+
+void LC_ActionProfiler::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+std::int64_t LC_ActionProfiler::now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void LC_ActionProfiler::setAction(const QString& name)
+{
+    ProfileData& data = profileData();
+    if (data.current != nullptr && data.currentName == name)
+        return;
+    data.currentName = name;
+    data.current = &data.timings[name];
+}
+
+void LC_ActionProfiler::record(Stage stage, std::int64_t start, std::int64_t end)
+{
+    ProfileData& data = profileData();
+    if (data.current == nullptr)
+        setAction(QObject::tr("None"));
+    Timing& timing = (*data.current)[stage];
+    const std::int64_t duration = end - start;
+    ++timing.count;
+    timing.total += duration;
+    timing.max = std::max(timing.max, duration);
+}
+
+void LC_ActionProfiler::clear()
+{
+    ProfileData& data = profileData();
+    data.timings.clear();
+    data.current = nullptr;
+    data.currentName.clear();
+}
+
+const std::map<QString, LC_ActionProfiler::Timings>& LC_ActionProfiler::timings()
+{
+    return profileData().timings;
+}
+
+QString LC_ActionProfiler::stageName(Stage stage)
+{
+    switch (stage) {
+    case MouseMove:
+        return QObject::tr("Mouse move");
+    case Snap:
+        return QObject::tr("Snap");
+    case Preview:
+        return QObject::tr("Preview");
+    case Overlay:
+        return QObject::tr("Overlay paint");
+    default:
+        return {};
+    }
+}
+
+QString LC_ActionProfiler::toText()
+{
+    QString text;
+    QTextStream out{&text};
+    out << QObject::tr("Action") << '\t' << QObject::tr("Stage") << '\t' << QObject::tr("Count")
+        << '\t' << QObject::tr("Total ms") << '\t' << QObject::tr("Mean ms") << '\t'
+        << QObject::tr("Max ms") << '\n';
+    for (const auto& [name, stages]: timings()) {
+        for (int i = 0; i < StageCount; ++i) {
+            const Timing& timing = stages[i];
+            if (timing.count == 0)
+                continue;
+            out << name << '\t' << stageName(Stage(i)) << '\t' << timing.count << '\t'
+                << QString::number(toMs(timing.total), 'f', 1) << '\t'
+                << QString::number(toMs(timing.total) / timing.count, 'f', 3) << '\t'
+                << QString::number(toMs(timing.max), 'f', 3) << '\n';
+        }
+    }
+    out.flush();
+    return text;
+}
+
+bool LC_ActionProfiler::exportCsv(const QString& fileName)
+{
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_ActionProfiler::exportCsv: cannot open %s",
+                        fileName.toLocal8Bit().constData());
+        return false;
+    }
+    QTextStream out{&file};
+    // the stage names are kept untranslated, for scripts reading the file
+    static const char* const stages[StageCount] = {"mouse_move", "snap", "preview", "overlay_paint"};
+    out << "action,stage,count,total_ms,mean_ms,max_ms\n";
+    for (const auto& [name, actionTimings]: timings()) {
+        for (int i = 0; i < StageCount; ++i) {
+            const Timing& timing = actionTimings[i];
+            if (timing.count == 0)
+                continue;
+            out << '"' << QString{name}.replace('"', "\"\"") << "\"," << stages[i] << ','
+                << timing.count << ',' << QString::number(toMs(timing.total), 'f', 3) << ','
+                << QString::number(toMs(timing.total) / timing.count, 'f', 3) << ','
+                << QString::number(toMs(timing.max), 'f', 3) << '\n';
+        }
+    }
+    out.flush();
+    return file.error() == QFileDevice::NoError;
+}
@@ -0,0 +1,121 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_ACTIONPROFILER_H
+#define LC_ACTIONPROFILER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+
+#include <QString>
+
+/**
+ * @brief The LC_ActionProfiler class, times the interactive stages of the actions.
+ *
+ * Mouse moves, snapping, preview updates and overlay paints are aggregated per action for the
+ * session, to find the tools which are sluggish on a drawing. Stages are attributed to the action
+ * which received the last mouse move. The profiler is meant for the GUI thread only. While it's
+ * disabled, a scope costs a single atomic load.
+ */
+class LC_ActionProfiler {
+public:
+    enum Stage {
+        MouseMove,
+        Snap,
+        Preview,
+        Overlay,
+        StageCount
+    };
+
+    struct Timing {
+        std::int64_t count = 0;
+        // microseconds
+        std::int64_t total = 0;
+        std::int64_t max = 0;
+    };
+    using Timings = std::array<Timing, StageCount>;
+
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief now - a steady time in microseconds
+     */
+    static std::int64_t now();
+    /**
+     * @brief setAction - the action the following stages are attributed to
+     */
+    static void setAction(const QString& name);
+    static void record(Stage stage, std::int64_t start, std::int64_t end);
+    static void clear();
+
+    static const std::map<QString, Timings>& timings();
+    static QString stageName(Stage stage);
+
+    /**
+     * @brief toText - the timings as a table, per action and stage
+     */
+    static QString toText();
+    /**
+     * @brief exportCsv - write the timings as CSV, one row per action and stage
+     * @return true on success
+     */
+    static bool exportCsv(const QString& fileName);
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+/**
+ * @brief The LC_ActionProfileScope class, records the lifetime of a scope as an action stage,
+ * if the profiler is enabled
+ */
+class LC_ActionProfileScope {
+public:
+    explicit LC_ActionProfileScope(LC_ActionProfiler::Stage stage):
+        m_stage{stage}
+        , m_enabled{LC_ActionProfiler::isEnabled()}
+    {
+        if (m_enabled)
+            m_start = LC_ActionProfiler::now();
+    }
+    ~LC_ActionProfileScope()
+    {
+        if (m_enabled)
+            LC_ActionProfiler::record(m_stage, m_start, LC_ActionProfiler::now());
+    }
+    LC_ActionProfileScope(const LC_ActionProfileScope&) = delete;
+    LC_ActionProfileScope& operator = (const LC_ActionProfileScope&) = delete;
+
+private:
+    LC_ActionProfiler::Stage m_stage;
+    bool m_enabled = false;
+    std::int64_t m_start = 0;
+};
+
+#endif // LC_ACTIONPROFILER_H
@@ -0,0 +1,212 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QTextStream>
+
+#include "lc_tracing.h"
+#include "rs_debug.h"
+
+namespace {
+
+// events kept per thread
+constexpr size_t bufferCapacity = 1 << 16;
+
+struct TraceEvent {
+    const char* name = nullptr;
+    std::int64_t start = 0;
+    std::int64_t duration = 0;
+};
+
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    size_t next = 0;
+    // names are string literals, the same name may have several addresses
+    std::unordered_map<const char*, LC_Tracing::Total> totals;
+    // the Chrome trace thread id
+    int id = 0;
+    bool inUse = false;
+};
+
+/**
+ * All thread buffers. Short lived worker threads, e.g. for tile rendering, are frequent, so the
+ * buffer of a finished thread is handed over to the next new thread.
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    ThreadBuffer* acquire()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto& buffer: buffers) {
+            if (!buffer->inUse) {
+                buffer->inUse = true;
+                return buffer.get();
+            }
+        }
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        ThreadBuffer* buffer = buffers.back().get();
+        buffer->id = int(buffers.size());
+        buffer->inUse = true;
+        buffer->events.reserve(bufferCapacity);
+        return buffer;
+    }
+
+    void release(ThreadBuffer* buffer)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        buffer->inUse = false;
+    }
+};
+
+Registry& registry()
+{
+    static Registry s_registry;
+    return s_registry;
+}
+
+struct ThreadBufferHolder {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadBufferHolder()
+    {
+        if (buffer != nullptr)
+            registry().release(buffer);
+    }
+};
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local ThreadBufferHolder holder;
+    if (holder.buffer == nullptr)
+        holder.buffer = registry().acquire();
+    return *holder.buffer;
+}
+
+std::chrono::steady_clock::time_point epoch()
+{
+    static const auto s_epoch = std::chrono::steady_clock::now();
+    return s_epoch;
+}
+}
+
+void LC_Tracing::setEnabled(bool enabled)
+{
+    epoch();
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+std::int64_t LC_Tracing::now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now() - epoch()).count();
+}
+
+void LC_Tracing::record(const char* name, std::int64_t start, std::int64_t end, std::int64_t self)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock{buffer.mutex};
+    TraceEvent event{name, start, end - start};
+    if (buffer.events.size() < bufferCapacity)
+        buffer.events.push_back(event);
+    else
+        buffer.events[buffer.next] = event;
+    buffer.next = (buffer.next + 1) % bufferCapacity;
+
+    Total& total = buffer.totals[name];
+    total.count++;
+    total.duration += end - start;
+    total.self += self;
+}
+
+void LC_Tracing::clear()
+{
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    for (auto& buffer: reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+        buffer->events.clear();
+        buffer->next = 0;
+        buffer->totals.clear();
+    }
+}
+
+std::map<std::string, LC_Tracing::Total> LC_Tracing::totals()
+{
+    std::map<std::string, Total> ret;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    for (auto& buffer: reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+        for (const auto& [name, total]: buffer->totals) {
+            Total& merged = ret[name];
+            merged.count += total.count;
+            merged.duration += total.duration;
+            merged.self += total.self;
+        }
+    }
+    return ret;
+}
+
+bool LC_Tracing::exportChromeTrace(const QString& fileName)
+{
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_Tracing::exportChromeTrace: cannot open %s",
+                        fileName.toLocal8Bit().constData());
+        return false;
+    }
+    QTextStream out{&file};
+    const qint64 pid = QCoreApplication::applicationPid();
+    out << "{\"traceEvents\":[";
+    bool first = true;
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    for (auto& buffer: reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+        // oldest first, once the ring buffer wrapped around the oldest is the next to overwrite
+        const size_t count = buffer->events.size();
+        const size_t begin = count < bufferCapacity ? 0 : buffer->next;
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[(begin + i) % count];
+            out << (first ? "\n" : ",\n")
+                << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":" << event.start
+                << ",\"dur\":" << event.duration << ",\"pid\":" << pid
+                << ",\"tid\":" << buffer->id << '}';
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    return file.error() == QFileDevice::NoError;
+}
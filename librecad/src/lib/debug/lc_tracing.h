@@ -0,0 +1,128 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_TRACING_H
+#define LC_TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+class QString;
+
+/**
+ * @brief The LC_Tracing class, scoped timers of the main processing stages.
+ *
+ * Each thread records its trace events into its own ring buffer, which keeps the most recent
+ * events. While tracing is disabled, a scope costs a single atomic load. The recorded events are
+ * exported in the Chrome trace event format, to be viewed by chrome://tracing or Perfetto.
+ *
+ * Example: void RS_Hatch::update() {
+ *              LC_TRACE_SCOPE("RS_Hatch::update");
+ *              ...
+ */
+class LC_Tracing {
+public:
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief now - the time in microseconds since the start of tracing
+     */
+    static std::int64_t now();
+    /**
+     * @brief record - add a complete event to the ring buffer of the current thread
+     * @param name - event name, a string literal
+     * @param self - the duration not spent in nested events
+     */
+    static void record(const char* name, std::int64_t start, std::int64_t end, std::int64_t self);
+    static void clear();
+
+    struct Total {
+        std::int64_t count = 0;
+        // in microseconds
+        std::int64_t duration = 0;
+        std::int64_t self = 0;
+    };
+    /**
+     * @brief totals - the number and durations of the events of each name, of all threads, since
+     * the last clear(). Unlike the ring buffers, the totals include every event.
+     */
+    static std::map<std::string, Total> totals();
+
+    /**
+     * @brief exportChromeTrace - write the recorded events as Chrome trace JSON
+     * @return true on success
+     */
+    static bool exportChromeTrace(const QString& fileName);
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+/**
+ * @brief The LC_TraceScope class, records the lifetime of a scope, if tracing is enabled.
+ * The recorded scopes of a thread are nested, each one knows the time spent in its children.
+ */
+class LC_TraceScope {
+public:
+    explicit LC_TraceScope(const char* name):
+        m_name{LC_Tracing::isEnabled() ? name : nullptr}
+    {
+        if (m_name != nullptr) {
+            m_parent = s_current;
+            s_current = this;
+            m_start = LC_Tracing::now();
+        }
+    }
+    ~LC_TraceScope()
+    {
+        if (m_name != nullptr) {
+            const std::int64_t end = LC_Tracing::now();
+            LC_Tracing::record(m_name, m_start, end, end - m_start - m_children);
+            s_current = m_parent;
+            if (m_parent != nullptr)
+                m_parent->m_children += end - m_start;
+        }
+    }
+    LC_TraceScope(const LC_TraceScope&) = delete;
+    LC_TraceScope& operator = (const LC_TraceScope&) = delete;
+
+private:
+    static inline thread_local LC_TraceScope* s_current = nullptr;
+
+    const char* m_name = nullptr;
+    LC_TraceScope* m_parent = nullptr;
+    std::int64_t m_start = 0;
+    std::int64_t m_children = 0;
+};
+
+#define LC_TRACE_CONCAT_(a, b) a##b
+#define LC_TRACE_CONCAT(a, b) LC_TRACE_CONCAT_(a, b)
+#define LC_TRACE_SCOPE(name) LC_TraceScope LC_TRACE_CONCAT(lcTraceScope, __LINE__){name}
+
+#endif // LC_TRACING_H
@@ -115,6 +115,12 @@ public:
 
     void setLevel(RS_DebugLevel level);
     RS_DebugLevel getLevel();
+    /**
+     * @return true, if messages of the given level are printed
+     */
+    static bool isEnabled(RS_DebugLevel level) {
+        return instance()->debugLevel >= level;
+    }
     void print(RS_DebugLevel level, const char* format ...);
     void print(const char* format ...);
     void print(const QString& text);
@@ -129,5 +135,26 @@ private:
     FILE* stream = nullptr;
 };
 
+/**
+ * Level gated printf style logging. Unlike RS_DEBUG->print(), the arguments
+ * are only evaluated if the level is enabled, so these macros are for hot
+ * paths. Messages of levels above LC_DEBUG_MAX_LEVEL are compiled out, e.g.
+ * with -DLC_DEBUG_MAX_LEVEL=RS_Debug::D_WARNING.
+ *
+ * Example: LC_DEBUG_PRINT(RS_Debug::D_WARNING, "block %s not found", name.toLatin1().data());
+ *          LC_DEBUG_TRACE("RS_Insert::update"); // level D_DEBUGGING
+ */
+#ifndef LC_DEBUG_MAX_LEVEL
+#define LC_DEBUG_MAX_LEVEL RS_Debug::D_DEBUGGING
+#endif
+#define LC_DEBUG_PRINT(level, ...) \
+    do { \
+        if constexpr ((level) <= (LC_DEBUG_MAX_LEVEL)) { \
+            if (RS_Debug::isEnabled(level)) \
+                RS_DEBUG->print((level), __VA_ARGS__); \
+        } \
+    } while (false)
+#define LC_DEBUG_TRACE(...) LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, __VA_ARGS__)
+
 #endif
 // EOF
@@ -0,0 +1,72 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include "lc_attributeschange.h"
+#include "rs_block.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+
+void LC_AttributesChange::add(RS_Entity* entity)
+{
+    if (entity != nullptr)
+        m_attributes.push_back({entity, entity->getPen(false), entity->getLayer(false)});
+}
+
+bool LC_AttributesChange::isEmpty() const
+{
+    return m_attributes.empty();
+}
+
+std::vector<RS_Entity*> LC_AttributesChange::getEntities() const
+{
+    std::vector<RS_Entity*> entities;
+    entities.reserve(m_attributes.size());
+    for (const Attributes& attributes: m_attributes)
+        entities.push_back(attributes.entity);
+    return entities;
+}
+
+void LC_AttributesChange::undoStateChanged(bool /*undone*/)
+{
+    // the same swap undoes and redoes the change
+    for (Attributes& attributes: m_attributes) {
+        RS_Entity* entity = attributes.entity;
+        const RS_Pen pen = entity->getPen(false);
+        RS_Layer* layer = entity->getLayer(false);
+        entity->setPen(attributes.pen);
+        entity->setLayer(attributes.layer);
+        attributes.pen = pen;
+        attributes.layer = layer;
+        applied(entity);
+    }
+}
+
+void LC_AttributesChange::applied(RS_Entity* entity)
+{
+    if (entity->rtti() == RS2::EntityInsert)
+        entity->update();
+    RS_EntityContainer* parent = entity->getParent();
+    if (parent != nullptr && parent->rtti() == RS2::EntityBlock)
+        static_cast<RS_Block*>(parent)->setChanged();
+}
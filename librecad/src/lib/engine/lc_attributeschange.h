@@ -0,0 +1,76 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_ATTRIBUTESCHANGE_H
+#define LC_ATTRIBUTESCHANGE_H
+
+#include <vector>
+
+#include "rs_pen.h"
+#include "rs_undoable.h"
+
+class RS_Entity;
+class RS_Layer;
+
+/**
+ * @brief The LC_AttributesChange class, an undoable change of the pens and layers of entities, which are
+ * modified in place instead of being replaced by modified copies.
+ *
+ * The change keeps the attributes the entities don't have: undoing and redoing swap them with the
+ * attributes of the entities. Changes are owned by their undo cycle, see RS_Undo::addOwnedUndoable().
+ */
+class LC_AttributesChange : public RS_Undoable {
+public:
+    /**
+     * @brief add - keeps the current attributes of the entity, before it's changed
+     */
+    void add(RS_Entity* entity);
+    bool isEmpty() const;
+    /**
+     * @return the changed entities
+     */
+    std::vector<RS_Entity*> getEntities() const;
+
+    RS2::UndoableType undoRtti() const override
+    {
+        return RS2::UndoableAttributes;
+    }
+    void undoStateChanged(bool undone) override;
+
+    /**
+     * @brief applied - updates what depends on the attributes of an entity changed in place: inserts
+     * resolve their pen into the entities created from their block, and blocks compile their entities
+     */
+    static void applied(RS_Entity* entity);
+
+private:
+    struct Attributes {
+        RS_Entity* entity = nullptr;
+        RS_Pen pen;
+        RS_Layer* layer = nullptr;
+    };
+    std::vector<Attributes> m_attributes;
+};
+
+#endif // LC_ATTRIBUTESCHANGE_H
@@ -0,0 +1,486 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include <QTransform>
+
+#include "lc_blockdrawlist.h"
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_circle.h"
+#include "rs_ellipse.h"
+#include "rs_graphicview.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_line.h"
+#include "rs_math.h"
+#include "rs_painter.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+
+namespace {
+
+QPointF toPoint(const RS_Vector& vp)
+{
+    return {vp.x, vp.y};
+}
+
+// continue the current subpath, if it ends at the point
+void moveTo(QPainterPath& path, const RS_Vector& point)
+{
+    const QPointF pt = toPoint(point);
+    if (path.elementCount() == 0 || path.currentPosition() != pt)
+        path.moveTo(pt);
+}
+
+// points sampled per Bezier curve for the hull, the sagitta error is below 0.2% of the radius
+constexpr int hullSamples = 16;
+
+// the outline of a group as it is compiled
+struct Outline {
+    QPainterPath& path;
+    std::vector<QPointF>& points;
+};
+
+QPolygonF toPolygon(const std::vector<QPointF>& points, size_t size)
+{
+    QPolygonF polygon;
+    polygon.reserve(static_cast<int>(size));
+    for (size_t i = 0; i < size; ++i)
+        polygon << points[i];
+    return polygon;
+}
+
+/**
+ * @brief convexHull - Andrew's monotone chain algorithm
+ */
+QPolygonF convexHull(std::vector<QPointF> points)
+{
+    std::sort(points.begin(), points.end(), [](const QPointF& p0, const QPointF& p1) {
+        return p0.x() < p1.x() || (p0.x() == p1.x() && p0.y() < p1.y());
+    });
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    if (points.size() < 3)
+        return toPolygon(points, points.size());
+
+    auto cross = [](const QPointF& o, const QPointF& a, const QPointF& b) {
+        return (a.x() - o.x()) * (b.y() - o.y()) - (a.y() - o.y()) * (b.x() - o.x());
+    };
+    std::vector<QPointF> hull(2 * points.size());
+    size_t k = 0;
+    for (const QPointF& point: points) {
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], point) <= 0.)
+            --k;
+        hull[k++] = point;
+    }
+    for (size_t i = points.size() - 1, lower = k + 1; i > 0; --i) {
+        while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0.)
+            --k;
+        hull[k++] = points[i - 1];
+    }
+    // the last point is the first one
+    return toPolygon(hull, k - 1);
+}
+
+/**
+ * Appends an elliptic arc as cubic Bezier curves, of at most 90 degrees each.
+ * Points of the ellipse are center + majorP*cos(t) + minorP*sin(t).
+ * @param sweep - the angle length, negative for clockwise arcs
+ */
+void appendEllipticArc(Outline& outline, const RS_Vector& center, const RS_Vector& majorP, double ratio,
+                       double angle1, double sweep)
+{
+    const RS_Vector minorP = RS_Vector{-majorP.y, majorP.x} * ratio;
+    auto pointAt = [&](double t) {
+        return center + majorP * std::cos(t) + minorP * std::sin(t);
+    };
+    auto tangentAt = [&](double t) {
+        return minorP * std::cos(t) - majorP * std::sin(t);
+    };
+
+    const int segments = std::max(1, static_cast<int>(std::ceil(std::abs(sweep) / M_PI_2 - RS_TOLERANCE_ANGLE)));
+    const double step = sweep / segments;
+    const double k = 4. / 3. * std::tan(step / 4.);
+    RS_Vector start = pointAt(angle1);
+    moveTo(outline.path, start);
+    outline.points.push_back(toPoint(start));
+    for (int i = 0; i < segments; ++i) {
+        const double t0 = angle1 + i * step;
+        const double t1 = t0 + step;
+        const RS_Vector end = pointAt(t1);
+        outline.path.cubicTo(toPoint(start + tangentAt(t0) * k), toPoint(end - tangentAt(t1) * k), toPoint(end));
+        for (int j = 1; j <= hullSamples; ++j)
+            outline.points.push_back(toPoint(pointAt(t0 + step * j / hullSamples)));
+        start = end;
+    }
+}
+
+// the pen of an entity of a nested insert, as in RS_Insert::createEntities()
+RS_Pen resolvePen(RS_Pen pen, const RS_Pen& insertPen)
+{
+    if (!pen.isValid())
+        return insertPen;
+    if (pen.getColor() == RS_Color(RS2::FlagByBlock))
+        pen.setColor(insertPen.getColor());
+    if (pen.getWidth() == RS2::WidthByBlock)
+        pen.setWidth(insertPen.getWidth());
+    if (pen.getLineType() == RS2::LineByBlock)
+        pen.setLineType(insertPen.getLineType());
+    return pen;
+}
+
+// the pen relative to an outer entity, which is resolved when drawing if the outer pen is invalid
+RS_Pen relativePen(const RS_Pen& pen, const RS_Pen& outerPen)
+{
+    return outerPen.isValid() ? resolvePen(pen, outerPen) : pen;
+}
+
+// whether the layer hides an insert, layer 0 is resolved to the layer of the outer insert
+bool isFrozen(const RS_Layer* layer)
+{
+    return layer != nullptr && layer->getName() != "0" && layer->isFrozen();
+}
+
+// whether appendEntity() compiles the entity
+bool isCompiled(const RS_Entity& entity)
+{
+    switch (entity.rtti()) {
+    case RS2::EntityLine:
+    case RS2::EntityArc:
+    case RS2::EntityCircle:
+    case RS2::EntityEllipse:
+    case RS2::EntitySolid:
+        return true;
+    case RS2::EntityPolyline:
+        for (const RS_Entity* segment: static_cast<const RS_Polyline&>(entity))
+            if (!isCompiled(*segment))
+                return false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Appends the outline of an entity, relative to the base point.
+ * @return false, if the entity can't be compiled
+ */
+bool appendEntity(Outline& outline, const RS_Entity& entity, const RS_Vector& basePoint)
+{
+    switch (entity.rtti()) {
+    case RS2::EntityLine: {
+        const auto& line = static_cast<const RS_Line&>(entity);
+        const QPointF start = toPoint(line.getStartpoint() - basePoint);
+        const QPointF end = toPoint(line.getEndpoint() - basePoint);
+        moveTo(outline.path, line.getStartpoint() - basePoint);
+        outline.path.lineTo(end);
+        outline.points.push_back(start);
+        outline.points.push_back(end);
+        return true;
+    }
+    case RS2::EntityArc: {
+        const auto& arc = static_cast<const RS_Arc&>(entity);
+        const double sweep = arc.isReversed() ? -arc.getAngleLength() : arc.getAngleLength();
+        appendEllipticArc(outline, arc.getCenter() - basePoint, {arc.getRadius(), 0.}, 1., arc.getAngle1(), sweep);
+        return true;
+    }
+    case RS2::EntityCircle: {
+        const auto& circle = static_cast<const RS_Circle&>(entity);
+        appendEllipticArc(outline, circle.getCenter() - basePoint, {circle.getRadius(), 0.}, 1., 0., 2. * M_PI);
+        outline.path.closeSubpath();
+        return true;
+    }
+    case RS2::EntityEllipse: {
+        const auto& ellipse = static_cast<const RS_Ellipse&>(entity);
+        if (!ellipse.isEllipticArc()) {
+            appendEllipticArc(outline, ellipse.getCenter() - basePoint, ellipse.getMajorP(), ellipse.getRatio(),
+                              0., 2. * M_PI);
+            outline.path.closeSubpath();
+            return true;
+        }
+        const double sweep = ellipse.isReversed() ? -ellipse.getAngleLength() : ellipse.getAngleLength();
+        appendEllipticArc(outline, ellipse.getCenter() - basePoint, ellipse.getMajorP(), ellipse.getRatio(),
+                          ellipse.getAngle1(), sweep);
+        return true;
+    }
+    case RS2::EntitySolid: {
+        // drawn as triangles, see RS_Solid::draw()
+        const auto& solid = static_cast<const RS_Solid&>(entity);
+        const int triangles = solid.isTriangle() ? 1 : 2;
+        for (int i = 0; i < triangles; ++i) {
+            const RS_Vector corner = solid.getCorner(i) - basePoint;
+            outline.path.moveTo(toPoint(corner));
+            outline.points.push_back(toPoint(corner));
+            for (int j = i + 1; j <= i + 2; ++j) {
+                outline.path.lineTo(toPoint(solid.getCorner(j) - basePoint));
+                outline.points.push_back(toPoint(solid.getCorner(j) - basePoint));
+            }
+            outline.path.closeSubpath();
+        }
+        return true;
+    }
+    case RS2::EntityPolyline:
+        // segments are drawn with the pen of the polyline
+        for (const RS_Entity* segment: static_cast<const RS_Polyline&>(entity))
+            if (!appendEntity(outline, *segment, basePoint))
+                return false;
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+std::shared_ptr<const LC_BlockDrawList> LC_BlockDrawList::compile(const RS_Block& block, unsigned maxCount)
+{
+    if (block.count() > maxCount)
+        return nullptr;
+
+    auto drawList = std::make_shared<LC_BlockDrawList>();
+    if (!drawList->compileEntities(block, block.getBasePoint(), nullptr))
+        return nullptr;
+    return drawList;
+}
+
+std::shared_ptr<const LC_BlockDrawList> LC_BlockDrawList::compile(const RS_EntityContainer& container,
+                                                                  std::vector<RS_Entity*>& others)
+{
+    auto drawList = std::make_shared<LC_BlockDrawList>();
+    drawList->compileEntities(container, RS_Vector{0., 0.}, &others);
+    return drawList;
+}
+
+std::shared_ptr<const LC_BlockDrawList> LC_BlockDrawList::compileText(const RS_EntityContainer& text)
+{
+    auto drawList = std::make_shared<LC_BlockDrawList>();
+    std::vector<std::vector<QPointF>> points;
+    if (!drawList->appendLetters(text, RS_Pen{RS2::FlagInvalid}, points))
+        return nullptr;
+    for (size_t i = 0; i < points.size(); ++i)
+        drawList->m_groups[i].hull = convexHull(std::move(points[i]));
+    return drawList;
+}
+
+bool LC_BlockDrawList::appendLetters(const RS_EntityContainer& container, const RS_Pen& containerPen,
+                                     std::vector<std::vector<QPointF>>& points)
+{
+    for (RS_Entity* entity: container) {
+        if (entity->isUndone())
+            continue;
+        switch (entity->rtti()) {
+        case RS2::EntityInsert: {
+            // letters are inserts of the glyph blocks of the font
+            const auto& letter = static_cast<const RS_Insert&>(*entity);
+            const RS_Block* glyph = letter.getBlockForInsert();
+            if (glyph == nullptr)
+                continue;
+            const std::shared_ptr<const LC_BlockDrawList> glyphs = glyph->getDrawList();
+            if (glyphs == nullptr)
+                return false;
+            const RS_Pen letterPen = relativePen(letter.getPen(false), containerPen);
+            const QTransform transform = letter.getCellTransform(0, 0);
+            for (const Group& glyphGroup: glyphs->getGroups()) {
+                Group& group = findGroup(letter.getLayer(false), relativePen(glyphGroup.pen, letterPen),
+                                         glyphGroup.filled, glyphGroup.insertedBy);
+                points.resize(m_groups.size());
+                std::vector<QPointF>& outline = points[&group - m_groups.data()];
+                group.path.addPath(transform.map(glyphGroup.path));
+                for (const QPointF& point: glyphGroup.hull)
+                    outline.push_back(transform.map(point));
+                if (group.path.elementCount() > maxElements)
+                    return false;
+            }
+            break;
+        }
+        case RS2::EntityContainer:
+        case RS2::EntityText:
+        case RS2::EntityMText:
+            // lines of multiline texts
+            if (!appendLetters(static_cast<const RS_EntityContainer&>(*entity),
+                               relativePen(entity->getPen(false), containerPen), points))
+                return false;
+            break;
+        default: {
+            if (!isCompiled(*entity))
+                return false;
+            Group& group = findGroup(entity->getLayer(false), relativePen(entity->getPen(false), containerPen),
+                                     entity->rtti() == RS2::EntitySolid, {});
+            points.resize(m_groups.size());
+            Outline outline{group.path, points[&group - m_groups.data()]};
+            if (!appendEntity(outline, *entity, RS_Vector{0., 0.}))
+                return false;
+            break;
+        }
+        }
+    }
+    return true;
+}
+
+void LC_BlockDrawList::draw(RS_Painter* painter, RS_GraphicView* view, RS_Entity& container,
+                            double& patternOffset) const
+{
+    // same rules as RS_Entity::getPen(true) for the entities of the container
+    const RS_Pen containerPen = container.getPen(true);
+    const QTransform guiTransform{view->getFactor().x, 0., 0., -view->getFactor().y,
+                                  view->getOffsetX(), view->getHeight() - view->getOffsetY()};
+    for (const Group& group: m_groups) {
+        if (isHidden(group))
+            continue;
+        RS_Pen pen = resolvePen(group.pen, containerPen);
+        const RS_Layer* layer = group.layer != nullptr ? group.layer : container.getLayer();
+        if (layer != nullptr) {
+            if (pen.getColor().isByLayer())
+                pen.setColor(layer->getPen().getColor());
+            if (pen.getWidth() == RS2::WidthByLayer)
+                pen.setWidth(layer->getPen().getWidth());
+            if (pen.getLineType() == RS2::LineByLayer)
+                pen.setLineType(layer->getPen().getLineType());
+        }
+        view->setPenForEntity(painter, &container, pen, patternOffset);
+        painter->drawSharedPath(group.path, guiTransform, group.filled);
+    }
+}
+
+std::shared_ptr<const LC_BlockDrawList> LC_TextGlyphs::get(const RS_EntityContainer& text) const
+{
+    // texts are drawn by several rendering threads, which may compile the same letters at once.
+    // Letters changed without a reset, e.g. through the text container, change its revision
+    std::shared_ptr<const Compiled> compiled = std::atomic_load(&m_compiled);
+    const unsigned long long revision = text.getRevision();
+    if (compiled == nullptr || compiled->revision != revision) {
+        auto created = std::make_shared<Compiled>();
+        created->glyphs = LC_BlockDrawList::compileText(text);
+        created->revision = revision;
+        compiled = std::move(created);
+        std::atomic_store(&m_compiled, compiled);
+    }
+    return compiled->glyphs;
+}
+
+void LC_TextGlyphs::reset()
+{
+    std::atomic_store(&m_compiled, std::shared_ptr<const Compiled>{});
+}
+
+bool LC_BlockDrawList::compileEntities(const RS_EntityContainer& container, const RS_Vector& basePoint,
+                                       std::vector<RS_Entity*>* others)
+{
+    // outline points by group
+    std::vector<std::vector<QPointF>> points;
+    for (RS_Entity* entity: container) {
+        if (entity->isUndone())
+            continue;
+        if (others == nullptr && entity->rtti() == RS2::EntityInsert) {
+            if (!appendInsert(static_cast<const RS_Insert&>(*entity), basePoint, points))
+                return false;
+            continue;
+        }
+        if (others != nullptr && !isCompiled(*entity)) {
+            others->push_back(entity);
+            continue;
+        }
+        Group& group = findGroup(*entity);
+        points.resize(m_groups.size());
+        Outline outline{group.path, points[&group - m_groups.data()]};
+        if (!appendEntity(outline, *entity, basePoint))
+            return false;
+    }
+    for (size_t i = 0; i < points.size(); ++i)
+        m_groups[i].hull = convexHull(std::move(points[i]));
+    return true;
+}
+
+bool LC_BlockDrawList::appendInsert(const RS_Insert& insert, const RS_Vector& basePoint,
+                                    std::vector<std::vector<QPointF>>& points)
+{
+    const RS_InsertData data = insert.getData();
+    // inserts of texts and the like are drawn from their entities
+    if (data.blockSource != nullptr)
+        return false;
+    const RS_Block* block = insert.getBlockForInsert();
+    // nothing to draw, as in RS_Insert::update()
+    if (block == nullptr
+            || std::abs(data.scaleFactor.x) < RS_Insert::minScaleFactor
+            || std::abs(data.scaleFactor.y) < RS_Insert::minScaleFactor)
+        return true;
+    std::shared_ptr<const LC_BlockDrawList> nested = block->getDrawList();
+    if (nested == nullptr)
+        return false;
+
+    RS_Layer* insertLayer = insert.getLayer(false);
+    const RS_Pen insertPen = insert.getPen(false);
+    const QTransform toBase = QTransform::fromTranslate(-basePoint.x, -basePoint.y);
+    for (const Group& nestedGroup: nested->getGroups()) {
+        // same rules as for the entities of an insert, see RS_Insert::createEntities()
+        RS_Layer* layer = nestedGroup.layer;
+        if (layer == nullptr || layer->getName() == "0")
+            layer = insertLayer;
+        std::vector<std::pair<RS_Layer*, const RS_Block*>> insertedBy{{insertLayer, block}};
+        insertedBy.insert(insertedBy.end(), nestedGroup.insertedBy.cbegin(), nestedGroup.insertedBy.cend());
+
+        Group& group = findGroup(layer, resolvePen(nestedGroup.pen, insertPen), nestedGroup.filled, insertedBy);
+        points.resize(m_groups.size());
+        std::vector<QPointF>& outline = points[&group - m_groups.data()];
+        for (int c = 0; c < data.cols; ++c) {
+            for (int r = 0; r < data.rows; ++r) {
+                const QTransform transform = insert.getCellTransform(c, r) * toBase;
+                group.path.addPath(transform.map(nestedGroup.path));
+                for (const QPointF& point: nestedGroup.hull)
+                    outline.push_back(transform.map(point));
+            }
+        }
+        if (group.path.elementCount() > maxElements)
+            return false;
+    }
+    return true;
+}
+
+LC_BlockDrawList::Group& LC_BlockDrawList::findGroup(const RS_Entity& entity)
+{
+    return findGroup(entity.getLayer(false), entity.getPen(false), entity.rtti() == RS2::EntitySolid, {});
+}
+
+LC_BlockDrawList::Group& LC_BlockDrawList::findGroup(RS_Layer* layer, const RS_Pen& pen, bool filled,
+                                                     const std::vector<std::pair<RS_Layer*, const RS_Block*>>& insertedBy)
+{
+    auto it = std::find_if(m_groups.begin(), m_groups.end(), [layer, &pen, filled, &insertedBy](const Group& group) {
+        return group.layer == layer && group.pen == pen && group.pen.getFlags() == pen.getFlags()
+                && group.pen.getAlpha() == pen.getAlpha() && group.filled == filled
+                && group.insertedBy == insertedBy;
+    });
+    if (it != m_groups.end())
+        return *it;
+    m_groups.push_back({layer, pen, {}, filled, {}, insertedBy});
+    return m_groups.back();
+}
+
+bool LC_BlockDrawList::isHidden(const Group& group)
+{
+    return std::any_of(group.insertedBy.cbegin(), group.insertedBy.cend(),
+                       [](const std::pair<RS_Layer*, const RS_Block*>& inserted) {
+        return isFrozen(inserted.first) || inserted.second->isFrozen();
+    });
+}
@@ -0,0 +1,161 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_BLOCKDRAWLIST_H
+#define LC_BLOCKDRAWLIST_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QPainterPath>
+#include <QPolygonF>
+
+#include "rs_pen.h"
+
+class RS_Block;
+class RS_Entity;
+class RS_EntityContainer;
+class RS_GraphicView;
+class RS_Insert;
+class RS_Layer;
+class RS_Painter;
+class RS_Vector;
+
+/**
+ * @brief The LC_BlockDrawList class, the geometry of a block compiled once into painter paths.
+ *
+ * Inserts of the block share the draw list: they draw and measure the paths through their own transform,
+ * instead of holding transformed copies of the block entities.
+ *
+ * Only blocks made of lines, arcs, circles, ellipses, polylines, solids and inserts of such blocks are
+ * compiled. Paths are relative to the block base point, and grouped by the layer and pen of their entities,
+ * so the pen of each group is resolved once per insert. Solids are in groups of their own, which are filled.
+ *
+ * Nested inserts are flattened: the groups of their block are composed with the transform of the insert, so
+ * drawing a block nested several levels deep doesn't go through the inserts of each level.
+ *
+ * Font letters are blocks too: the draw list works as a glyph cache, shared by all the letters of all texts
+ * using the font.
+ */
+class LC_BlockDrawList {
+public:
+    // entities of a block sharing the same layer and pen
+    struct Group {
+        RS_Layer* layer = nullptr;
+        RS_Pen pen;
+        QPainterPath path;
+        // filled with the pen color, for solids
+        bool filled = false;
+        // convex hull of points sampled along the path, for fast bounding boxes under any affine transform
+        QPolygonF hull;
+        // layers and blocks of the nested inserts containing the entities, the group is hidden when one
+        // of them is frozen
+        std::vector<std::pair<RS_Layer*, const RS_Block*>> insertedBy;
+    };
+
+    // larger blocks are drawn from entities, which can be culled
+    static constexpr unsigned maxEntities = 2048;
+    // limit of the path elements of flattened nested inserts
+    static constexpr int maxElements = 1 << 18;
+
+    /**
+     * @brief compile - compile the geometry of a block
+     * @param maxCount - larger blocks are not compiled
+     * @return nullptr, if the block contains entities which can't be compiled
+     */
+    static std::shared_ptr<const LC_BlockDrawList> compile(const RS_Block& block, unsigned maxCount = maxEntities);
+
+    /**
+     * @brief compile - compile the geometry of the entities of a container, relative to the origin
+     * @param others - the entities which can't be compiled, like texts, in the container order
+     */
+    static std::shared_ptr<const LC_BlockDrawList> compile(const RS_EntityContainer& container,
+                                                           std::vector<RS_Entity*>& others);
+
+    /**
+     * @brief compileText - compose the glyphs of the letters of a text into the paths of a few groups,
+     * so the text is drawn by a path per pen, instead of an insert per letter
+     * @return nullptr, if the text contains entities which can't be compiled
+     */
+    static std::shared_ptr<const LC_BlockDrawList> compileText(const RS_EntityContainer& text);
+
+    /**
+     * @brief draw - draw the groups of the entities compiled from a container, the pens are resolved
+     * as for the entities: invalid and ByBlock pens are the pen of the container, ByLayer pens are
+     * the pen of the layer of the group, or of the container
+     */
+    void draw(RS_Painter* painter, RS_GraphicView* view, RS_Entity& container, double& patternOffset) const;
+
+    const std::vector<Group>& getGroups() const
+    {
+        return m_groups;
+    }
+
+    /**
+     * @return true, if the group is hidden by a frozen layer or block of its nested inserts
+     */
+    static bool isHidden(const Group& group);
+
+private:
+    Group& findGroup(const RS_Entity& entity);
+    Group& findGroup(RS_Layer* layer, const RS_Pen& pen, bool filled,
+                     const std::vector<std::pair<RS_Layer*, const RS_Block*>>& insertedBy);
+    // append the groups of the block of a nested insert, with the transform of the insert
+    bool appendInsert(const RS_Insert& insert, const RS_Vector& basePoint,
+                      std::vector<std::vector<QPointF>>& points);
+    // compile the supported entities, the others are added to others, or fail the compilation if nullptr
+    bool compileEntities(const RS_EntityContainer& container, const RS_Vector& basePoint,
+                         std::vector<RS_Entity*>* others);
+    // append the glyphs of the letters of a text, and of its lines, with the pens relative to the text
+    bool appendLetters(const RS_EntityContainer& container, const RS_Pen& containerPen,
+                       std::vector<std::vector<QPointF>>& points);
+
+    std::vector<Group> m_groups;
+};
+
+/**
+ * @brief The LC_TextGlyphs class, the letters of a text compiled by LC_BlockDrawList::compileText(),
+ * when the text is first drawn by any of the rendering threads. The compiled letters are replaced
+ * atomically, so the threads read them without a lock. Texts reset them, when their letters
+ * are created again or transformed.
+ */
+class LC_TextGlyphs {
+public:
+    /**
+     * @return the compiled letters of the text, nullptr if they can't be compiled
+     */
+    std::shared_ptr<const LC_BlockDrawList> get(const RS_EntityContainer& text) const;
+    void reset();
+
+private:
+    struct Compiled {
+        std::shared_ptr<const LC_BlockDrawList> glyphs;
+        // the revision of the text, when the letters were compiled
+        unsigned long long revision = 0;
+    };
+    // loaded and stored atomically, nullptr until compiled
+    mutable std::shared_ptr<const Compiled> m_compiled;
+};
+
+#endif // LC_BLOCKDRAWLIST_H
@@ -164,6 +164,7 @@ void LC_DimArc::updateDim(bool autoText /* = false */)
 
     RS_DEBUG->print("LC_DimArc::update");
 
+    clearDimCache();
     clear();
 
     if (isUndone()) return;
@@ -0,0 +1,104 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <unordered_map>
+
+#include "lc_documentsnapshot.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+#include "rs_insert.h"
+
+std::shared_ptr<const LC_DocumentSnapshot> LC_DocumentSnapshot::create(
+    const RS_EntityContainer& container, unsigned long long revision, const LC_DocumentSnapshot* previous,
+    const std::unordered_set<unsigned long long>& changed)
+{
+    std::shared_ptr<LC_DocumentSnapshot> snapshot{new LC_DocumentSnapshot{}};
+    snapshot->m_revision = revision;
+    snapshot->m_min = container.getMin();
+    snapshot->m_max = container.getMax();
+    snapshot->m_entries.reserve(container.count());
+    snapshot->m_sources.reserve(container.count());
+
+    // positions in the previous snapshot, looked up by id once the order differs
+    std::unordered_map<unsigned long long, size_t> previousById;
+    size_t next = 0;
+    auto findPrevious = [&](const RS_Entity* entity) -> int {
+        if (previous == nullptr)
+            return -1;
+        const std::vector<const RS_Entity*>& sources = previous->m_sources;
+        size_t position = next;
+        if (position >= sources.size() || sources[position] != entity) {
+            if (previousById.empty()) {
+                for (size_t i = 0; i < sources.size(); ++i)
+                    previousById.emplace(previous->m_entries[i].id, i);
+            }
+            auto it = previousById.find(entity->getId());
+            if (it == previousById.end() || sources[it->second] != entity)
+                return -1;
+            position = it->second;
+        }
+        next = position + 1;
+        return static_cast<int>(position);
+    };
+
+    for (const RS_Entity* entity: container) {
+        if (entity == nullptr || entity->isUndone())
+            continue;
+        const unsigned long long id = entity->getId();
+        const int shared = changed.count(id) == 0 ? findPrevious(entity) : -1;
+        if (shared >= 0) {
+            snapshot->m_entries.push_back(previous->m_entries[shared]);
+        } else {
+            snapshot->m_entries.push_back({id, std::shared_ptr<const RS_Entity>{copy(*entity)}});
+        }
+        snapshot->m_sources.push_back(entity);
+    }
+    return snapshot;
+}
+
+const RS_Entity* LC_DocumentSnapshot::entityAt(size_t index) const
+{
+    return index < m_entries.size() ? m_entries[index].entity.get() : nullptr;
+}
+
+RS_Entity* LC_DocumentSnapshot::copy(const RS_Entity& entity)
+{
+    RS_Entity* copy = entity.clone();
+    copy->setParent(nullptr);
+    unregisterInserts(*copy);
+    return copy;
+}
+
+void LC_DocumentSnapshot::unregisterInserts(RS_Entity& copy)
+{
+    // the block list is changed by the editor only, and the copies are released by the readers
+    if (copy.rtti() == RS2::EntityInsert)
+        static_cast<RS_Insert&>(copy).updateReference();
+    if (!copy.isContainer())
+        return;
+    for (RS_Entity* child: static_cast<RS_EntityContainer&>(copy)) {
+        if (child != nullptr)
+            unregisterInserts(*child);
+    }
+}
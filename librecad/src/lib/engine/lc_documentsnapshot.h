@@ -0,0 +1,108 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_DOCUMENTSNAPSHOT_H
+#define LC_DOCUMENTSNAPSHOT_H
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+
+/**
+ * @brief The LC_DocumentSnapshot class, a read only view of the entities of a document at one revision,
+ * see RS_Document::snapshot().
+ *
+ * A snapshot holds frozen copies of the entities, so worker threads, e.g. for autosave, snapping or
+ * plugins, can read it while the document is edited, without locking. Snapshots share the copies of the
+ * entities unchanged between their revisions: only entities added or changed since the previous snapshot
+ * are copied again, the editor's entities are never touched by readers.
+ *
+ * The copies are detached from the document: they have no parent, and their inserts are not registered
+ * in the block list. They keep the pointers to the layers of the document, which are not part of the
+ * snapshot: readers must not rely on the attributes resolved through the layers.
+ */
+class LC_DocumentSnapshot {
+public:
+    struct Entry {
+        //! id of the entity in the document, the copy has an id of its own
+        unsigned long long id = 0;
+        std::shared_ptr<const RS_Entity> entity;
+    };
+
+    /**
+     * @brief create - the snapshot of the entities of the container.
+     * @param previous - an earlier snapshot of the container or nullptr, whose copies are reused
+     * @param changed - ids of the entities changed since the previous snapshot, they are copied again
+     */
+    static std::shared_ptr<const LC_DocumentSnapshot> create(const RS_EntityContainer& container,
+                                                             unsigned long long revision,
+                                                             const LC_DocumentSnapshot* previous,
+                                                             const std::unordered_set<unsigned long long>& changed);
+
+    //! the revision of the document, see RS_Document::getListRevision()
+    unsigned long long getRevision() const
+    {
+        return m_revision;
+    }
+    //! the entities in the order of the document
+    const std::vector<Entry>& getEntries() const
+    {
+        return m_entries;
+    }
+    size_t size() const
+    {
+        return m_entries.size();
+    }
+    const RS_Entity* entityAt(size_t index) const;
+    //! the borders of the document
+    RS_Vector getMin() const
+    {
+        return m_min;
+    }
+    RS_Vector getMax() const
+    {
+        return m_max;
+    }
+
+private:
+    LC_DocumentSnapshot() = default;
+    // the copy of an entity, detached from the document
+    static RS_Entity* copy(const RS_Entity& entity);
+    // unregisters the inserts of a detached copy
+    static void unregisterInserts(RS_Entity& copy);
+
+    unsigned long long m_revision = 0;
+    std::vector<Entry> m_entries;
+    // the document entities copied by the entries, never dereferenced: copies of an entity share its id
+    std::vector<const RS_Entity*> m_sources;
+    RS_Vector m_min;
+    RS_Vector m_max;
+};
+
+#endif // LC_DOCUMENTSNAPSHOT_H
@@ -0,0 +1,155 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "lc_endpointindex.h"
+#include "rs_entity.h"
+#include "rs.h"
+
+namespace {
+// grid coordinates are clamped to stay within the range of std::int64_t
+constexpr double maxCellCoordinate = 4e18;
+}
+
+LC_EndpointIndex::LC_EndpointIndex(double tolerance):
+    m_tolerance{std::max(tolerance, RS_TOLERANCE * RS_TOLERANCE)}
+{
+}
+
+std::size_t LC_EndpointIndex::CellHash::operator () (const Cell& cell) const
+{
+    const std::size_t hx = std::hash<std::int64_t>{}(cell.x);
+    const std::size_t hy = std::hash<std::int64_t>{}(cell.y);
+    return hx ^ (hy + 0x9e3779b97f4a7c15ULL + (hx << 6) + (hx >> 2));
+}
+
+LC_EndpointIndex::Cell LC_EndpointIndex::getCell(const RS_Vector& point) const
+{
+    auto snap = [this](double x) {
+        return static_cast<std::int64_t>(std::clamp(std::floor(x / m_tolerance),
+                                                    -maxCellCoordinate, maxCellCoordinate));
+    };
+    return {snap(point.x), snap(point.y)};
+}
+
+void LC_EndpointIndex::insert(RS_Entity* entity)
+{
+    if (entity == nullptr || m_orders.count(entity) == 1)
+        return;
+    const std::size_t order = m_nextOrder++;
+    m_orders.emplace(entity, order);
+    insert(entity->getStartpoint(), entity, order);
+    const RS_Vector end = entity->getEndpoint();
+    // a closed edge is found once by its endpoint
+    if (!end.valid || !entity->getStartpoint().valid
+            || end.squaredTo(entity->getStartpoint()) > m_tolerance * m_tolerance)
+        insert(end, entity, order);
+}
+
+void LC_EndpointIndex::insert(const RS_Vector& point, RS_Entity* entity, std::size_t order)
+{
+    if (point.valid)
+        m_cells[getCell(point)].push_back({point, entity, order});
+}
+
+void LC_EndpointIndex::remove(RS_Entity* entity)
+{
+    if (m_orders.erase(entity) == 0)
+        return;
+    for (const RS_Vector& point: {entity->getStartpoint(), entity->getEndpoint()}) {
+        if (!point.valid)
+            continue;
+        auto it = m_cells.find(getCell(point));
+        if (it == m_cells.end())
+            continue;
+        std::vector<Node>& nodes = it->second;
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [entity](const Node& node) {
+            return node.entity == entity;
+        }), nodes.end());
+        if (nodes.empty())
+            m_cells.erase(it);
+    }
+}
+
+bool LC_EndpointIndex::isEmpty() const
+{
+    return m_orders.empty();
+}
+
+template<typename Visitor>
+void LC_EndpointIndex::visitNear(const RS_Vector& point, Visitor visitor) const
+{
+    if (!point.valid)
+        return;
+    const Cell center = getCell(point);
+    const double tolerance2 = m_tolerance * m_tolerance;
+    for (std::int64_t dx = -1; dx <= 1; ++dx) {
+        for (std::int64_t dy = -1; dy <= 1; ++dy) {
+            auto it = m_cells.find({center.x + dx, center.y + dy});
+            if (it == m_cells.end())
+                continue;
+            for (const Node& node: it->second) {
+                const double dist2 = node.point.squaredTo(point);
+                if (dist2 <= tolerance2)
+                    visitor(node, dist2);
+            }
+        }
+    }
+}
+
+std::vector<RS_Entity*> LC_EndpointIndex::getConnected(const RS_Vector& point) const
+{
+    std::vector<const Node*> nodes;
+    visitNear(point, [&nodes](const Node& node, double) {
+        nodes.push_back(&node);
+    });
+    std::sort(nodes.begin(), nodes.end(), [](const Node* lhs, const Node* rhs) {
+        return lhs->order < rhs->order;
+    });
+    std::vector<RS_Entity*> connected;
+    for (const Node* node: nodes)
+        if (connected.empty() || connected.back() != node->entity)
+            connected.push_back(node->entity);
+    return connected;
+}
+
+RS_Entity* LC_EndpointIndex::getNearest(const RS_Vector& point, double* dist) const
+{
+    const Node* nearest = nullptr;
+    double minDist2 = RS_MAXDOUBLE;
+    visitNear(point, [&nearest, &minDist2](const Node& node, double dist2) {
+        if (nearest == nullptr || dist2 < minDist2
+                || (dist2 == minDist2 && node.order < nearest->order)) {
+            nearest = &node;
+            minDist2 = dist2;
+        }
+    });
+    if (nearest == nullptr)
+        return nullptr;
+    if (dist != nullptr)
+        *dist = std::sqrt(minDist2);
+    return nearest->entity;
+}
@@ -0,0 +1,91 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_ENDPOINTINDEX_H
+#define LC_ENDPOINTINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+
+/**
+ * @brief The LC_EndpointIndex class, a hash of entity endpoints snapped to a grid of the
+ * tolerance. Endpoints within the tolerance of a point are found in the neighbouring grid
+ * cells, so connecting n edges into contours takes O(n) lookups instead of O(n^2) scans.
+ * Ties are resolved by the insertion order, i.e. the container order of edges.
+ */
+class LC_EndpointIndex {
+public:
+    explicit LC_EndpointIndex(double tolerance);
+
+    // adds the start and end points of the entity
+    void insert(RS_Entity* entity);
+    void remove(RS_Entity* entity);
+    bool isEmpty() const;
+
+    /**
+     * @return all entities with an endpoint within the tolerance of the point, in the
+     * insertion order
+     */
+    std::vector<RS_Entity*> getConnected(const RS_Vector& point) const;
+
+    /**
+     * @return the entity of the nearest endpoint within the tolerance of the point,
+     * nullptr if none; dist is set to the distance of the endpoint found
+     */
+    RS_Entity* getNearest(const RS_Vector& point, double* dist = nullptr) const;
+
+private:
+    struct Cell {
+        std::int64_t x = 0;
+        std::int64_t y = 0;
+        bool operator == (const Cell& other) const {
+            return x == other.x && y == other.y;
+        }
+    };
+    struct CellHash {
+        std::size_t operator () (const Cell& cell) const;
+    };
+    struct Node {
+        RS_Vector point;
+        RS_Entity* entity = nullptr;
+        std::size_t order = 0;
+    };
+
+    Cell getCell(const RS_Vector& point) const;
+    void insert(const RS_Vector& point, RS_Entity* entity, std::size_t order);
+    template<typename Visitor>
+    void visitNear(const RS_Vector& point, Visitor visitor) const;
+
+    double m_tolerance = 0.;
+    std::unordered_map<Cell, std::vector<Node>, CellHash> m_cells;
+    std::unordered_map<RS_Entity*, std::size_t> m_orders;
+    std::size_t m_nextOrder = 0;
+};
+
+#endif // LC_ENDPOINTINDEX_H
@@ -0,0 +1,87 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <new>
+
+#include "lc_entitypool.h"
+
+namespace {
+constexpr size_t slabSize = 64 * 1024;
+
+constexpr size_t alignedSize(size_t size)
+{
+    constexpr size_t alignment = alignof(std::max_align_t);
+    return (std::max(size, sizeof(void*)) + alignment - 1) / alignment * alignment;
+}
+}
+
+LC_EntityPool::LC_EntityPool(size_t blockSize):
+    m_blockSize{alignedSize(blockSize)}
+  , m_slabLength{std::max<size_t>(1, slabSize / m_blockSize) * m_blockSize}
+{}
+
+void* LC_EntityPool::allocate(size_t size)
+{
+    if (alignedSize(size) != m_blockSize)
+        return ::operator new(size);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_used;
+    if (m_freeList != nullptr) {
+        void* block = m_freeList;
+        m_freeList = *static_cast<void**>(block);
+        return block;
+    }
+    if (m_next == m_end) {
+        // operator new[] of char returns memory aligned for any fundamental type
+        m_slabs.emplace_back(new char[m_slabLength]);
+        m_next = m_slabs.back().get();
+        m_end = m_next + m_slabLength;
+    }
+    void* block = m_next;
+    m_next += m_blockSize;
+    return block;
+}
+
+void LC_EntityPool::deallocate(void* block, size_t size)
+{
+    if (block == nullptr)
+        return;
+    if (alignedSize(size) != m_blockSize) {
+        ::operator delete(block);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_used == 0) {
+        // release all slabs but one, to avoid reallocating for single entities
+        m_slabs.resize(1);
+        m_next = m_slabs.front().get();
+        m_end = m_next + m_slabLength;
+        m_freeList = nullptr;
+        return;
+    }
+    *static_cast<void**>(block) = m_freeList;
+    m_freeList = block;
+}
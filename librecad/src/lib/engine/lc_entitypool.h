@@ -0,0 +1,83 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_ENTITYPOOL_H
+#define LC_ENTITYPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief The LC_EntityPool class, allocates the objects of one entity type in large slabs.
+ *
+ * Primitive entities, like lines, points and arcs, are by far the most numerous. Allocated from a pool,
+ * entities created together, e.g. by loading a file, are packed next to each other, so container scans
+ * for bulk transforms and borders walk through memory sequentially, and the per allocation overhead of
+ * the heap is saved.
+ *
+ * Freed blocks are reused. Slabs are released in bulk, once all the blocks of the pool are freed,
+ * e.g. after closing a drawing, so the entities of a large document are not kept as free blocks.
+ */
+class LC_EntityPool {
+public:
+    explicit LC_EntityPool(size_t blockSize);
+
+    LC_EntityPool(const LC_EntityPool&) = delete;
+    LC_EntityPool& operator = (const LC_EntityPool&) = delete;
+
+    /**
+     * @brief allocate - allocate a block. Sizes other than the block size, e.g. for derived classes,
+     * are allocated from the heap
+     */
+    void* allocate(size_t size);
+    void deallocate(void* block, size_t size);
+
+    /**
+     * @return the pool of the type T. Pools are never destroyed, as entities may still be deleted
+     * while static objects are destroyed.
+     */
+    template<class T>
+    static LC_EntityPool& forType()
+    {
+        static LC_EntityPool* pool = new LC_EntityPool{sizeof(T)};
+        return *pool;
+    }
+
+private:
+    const size_t m_blockSize;
+    // size of a slab in bytes, a multiple of the block size
+    const size_t m_slabLength;
+    std::vector<std::unique_ptr<char[]>> m_slabs;
+    // unused part of the last slab
+    char* m_next = nullptr;
+    char* m_end = nullptr;
+    // list of freed blocks, linked through their first bytes
+    void* m_freeList = nullptr;
+    // number of blocks in use
+    size_t m_used = 0;
+    std::mutex m_mutex;
+};
+
+#endif // LC_ENTITYPOOL_H
@@ -0,0 +1,169 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_ENTITYVISITOR_H
+#define LC_ENTITYVISITOR_H
+
+#include <type_traits>
+
+#include "lc_dimarc.h"
+#include "lc_hyperbola.h"
+#include "lc_parabola.h"
+#include "lc_splinepoints.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_constructionline.h"
+#include "rs_dimaligned.h"
+#include "rs_dimangular.h"
+#include "rs_dimdiametric.h"
+#include "rs_dimlinear.h"
+#include "rs_dimradial.h"
+#include "rs_ellipse.h"
+#include "rs_hatch.h"
+#include "rs_image.h"
+#include "rs_insert.h"
+#include "rs_leader.h"
+#include "rs_line.h"
+#include "rs_mtext.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+#include "rs_spline.h"
+#include "rs_text.h"
+
+/**
+ * @brief LC_Overloaded, a visitor made of lambdas, one for each entity type it handles:
+ *
+ *     LC_EntityVisitor::visit(*entity, LC_Overloaded{
+ *         [](RS_Line& line) {...},
+ *         [](RS_Dimension& dimension) {...},
+ *         [](RS_Entity&) {}
+ *     });
+ */
+template<typename... Lambdas>
+struct LC_Overloaded: Lambdas... {
+    using Lambdas::operator()...;
+};
+
+template<typename... Lambdas>
+LC_Overloaded(Lambdas...) -> LC_Overloaded<Lambdas...>;
+
+/**
+ * @brief Typed traversal of entities, a replacement for switch statements on RS_Entity::rtti().
+ *
+ * The entity is resolved to its concrete class once and the visitor is called with a reference
+ * of that class. Normal overload resolution picks the visitor function, so a visitor may handle
+ * a group of types by their common base (RS_Dimension, RS_AtomicEntity, RS_EntityContainer) and
+ * needs an RS_Entity& overload only if it ignores some types. Entity types without a class of
+ * their own are passed as RS_EntityContainer& or RS_Entity&. All overloads must have the same
+ * return type.
+ *
+ * Since everything is a template, the typed calls are inlined into the dispatch.
+ */
+namespace LC_EntityVisitor {
+
+namespace detail {
+// the class T with the constness of the visited entity
+template<typename T, typename E>
+using Typed = std::conditional_t<std::is_const_v<E>, const T, T>;
+}
+
+template<typename E, typename Visitor>
+decltype(auto) visit(E& entity, Visitor&& visitor)
+{
+    static_assert(std::is_same_v<std::remove_const_t<E>, RS_Entity>,
+                  "LC_EntityVisitor::visit() takes an RS_Entity reference");
+    using detail::Typed;
+    switch (entity.rtti()) {
+    case RS2::EntityPoint:
+        return visitor(static_cast<Typed<RS_Point, E>&>(entity));
+    case RS2::EntityLine:
+        return visitor(static_cast<Typed<RS_Line, E>&>(entity));
+    case RS2::EntityArc:
+        return visitor(static_cast<Typed<RS_Arc, E>&>(entity));
+    case RS2::EntityCircle:
+        return visitor(static_cast<Typed<RS_Circle, E>&>(entity));
+    case RS2::EntityEllipse:
+        return visitor(static_cast<Typed<RS_Ellipse, E>&>(entity));
+    case RS2::EntityHyperbola:
+        return visitor(static_cast<Typed<LC_Hyperbola, E>&>(entity));
+    case RS2::EntitySolid:
+        return visitor(static_cast<Typed<RS_Solid, E>&>(entity));
+    case RS2::EntityConstructionLine:
+        return visitor(static_cast<Typed<RS_ConstructionLine, E>&>(entity));
+    case RS2::EntityImage:
+        return visitor(static_cast<Typed<RS_Image, E>&>(entity));
+    case RS2::EntitySplinePoints:
+        return visitor(static_cast<Typed<LC_SplinePoints, E>&>(entity));
+    case RS2::EntityParabola:
+        return visitor(static_cast<Typed<LC_Parabola, E>&>(entity));
+    case RS2::EntitySpline:
+        return visitor(static_cast<Typed<RS_Spline, E>&>(entity));
+    case RS2::EntityPolyline:
+        return visitor(static_cast<Typed<RS_Polyline, E>&>(entity));
+    case RS2::EntityInsert:
+        return visitor(static_cast<Typed<RS_Insert, E>&>(entity));
+    case RS2::EntityMText:
+        return visitor(static_cast<Typed<RS_MText, E>&>(entity));
+    case RS2::EntityText:
+        return visitor(static_cast<Typed<RS_Text, E>&>(entity));
+    case RS2::EntityDimAligned:
+        return visitor(static_cast<Typed<RS_DimAligned, E>&>(entity));
+    case RS2::EntityDimLinear:
+        return visitor(static_cast<Typed<RS_DimLinear, E>&>(entity));
+    case RS2::EntityDimRadial:
+        return visitor(static_cast<Typed<RS_DimRadial, E>&>(entity));
+    case RS2::EntityDimDiametric:
+        return visitor(static_cast<Typed<RS_DimDiametric, E>&>(entity));
+    case RS2::EntityDimAngular:
+        return visitor(static_cast<Typed<RS_DimAngular, E>&>(entity));
+    case RS2::EntityDimArc:
+        return visitor(static_cast<Typed<LC_DimArc, E>&>(entity));
+    case RS2::EntityDimLeader:
+        return visitor(static_cast<Typed<RS_Leader, E>&>(entity));
+    case RS2::EntityHatch:
+        return visitor(static_cast<Typed<RS_Hatch, E>&>(entity));
+    default:
+        if (entity.isContainer()) {
+            return visitor(static_cast<Typed<RS_EntityContainer, E>&>(entity));
+        }
+        return visitor(entity);
+    }
+}
+
+/**
+ * @brief visitEach, visits the entities of a range, e.g. a container or an LC_EntityRange
+ */
+template<typename Range, typename Visitor>
+void visitEach(Range&& entities, Visitor&& visitor)
+{
+    for (auto* entity: entities) {
+        if (entity != nullptr) {
+            visit(*entity, visitor);
+        }
+    }
+}
+}
+
+#endif // LC_ENTITYVISITOR_H
@@ -0,0 +1,72 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+
+#include "lc_framearena.h"
+
+namespace {
+constexpr size_t chunkSize = 64 * 1024;
+}
+
+void* LC_FrameArena::allocate(size_t size, size_t alignment)
+{
+    // the chunks are aligned for any fundamental type
+    alignment = std::min(alignment, alignof(std::max_align_t));
+    for (; m_current < m_chunks.size(); ++m_current, m_used = 0) {
+        const Chunk& chunk = m_chunks[m_current];
+        const size_t offset = (m_used + alignment - 1) / alignment * alignment;
+        if (offset + size <= chunk.size) {
+            m_used = offset + size;
+            return chunk.data.get() + offset;
+        }
+    }
+    // operator new[] of char returns memory aligned for any fundamental type
+    const size_t length = std::max(chunkSize, size);
+    m_chunks.push_back({std::unique_ptr<char[]>(new char[length]), length});
+    m_current = m_chunks.size() - 1;
+    m_used = size;
+    return m_chunks.back().data.get();
+}
+
+bool LC_FrameArena::owns(const void* block) const
+{
+    const char* p = static_cast<const char*>(block);
+    for (size_t i = 0; i < m_chunks.size() && i <= m_current; ++i) {
+        const char* data = m_chunks[i].data.get();
+        if (p >= data && p < data + m_chunks[i].size)
+            return true;
+    }
+    return false;
+}
+
+bool LC_FrameArena::isEmpty() const
+{
+    return m_current == 0 && m_used == 0;
+}
+
+void LC_FrameArena::reset()
+{
+    m_current = 0;
+    m_used = 0;
+}
@@ -0,0 +1,70 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_FRAMEARENA_H
+#define LC_FRAMEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The LC_FrameArena class, allocates short lived objects of any type by bumping a pointer.
+ *
+ * Previews are rebuilt at every mouse move: the objects of a frame are allocated one after
+ * another, and all of them are released at once by reset(), before the next frame. Nothing is
+ * freed individually, and the chunks are kept for the next frames, so rebuilding a preview
+ * doesn't go through the heap.
+ *
+ * The arena doesn't destroy the objects, its owner does before reset(). Not thread safe.
+ */
+class LC_FrameArena {
+public:
+    LC_FrameArena() = default;
+
+    LC_FrameArena(const LC_FrameArena&) = delete;
+    LC_FrameArena& operator = (const LC_FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    /** @return true, if the block was allocated by this arena since the last reset() */
+    bool owns(const void* block) const;
+    /** @return true, if nothing was allocated since the last reset() */
+    bool isEmpty() const;
+    /**
+     * @brief reset - release all the blocks, the objects in them must have been destroyed.
+     * The chunks are kept for the next frame
+     */
+    void reset();
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+    std::vector<Chunk> m_chunks;
+    // the chunk allocated from, and the used part of it
+    size_t m_current = 0;
+    size_t m_used = 0;
+};
+
+#endif // LC_FRAMEARENA_H
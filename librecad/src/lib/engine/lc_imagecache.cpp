@@ -0,0 +1,129 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QImage>
+
+#include "lc_imagecache.h"
+#include "lc_imagepyramid.h"
+#include "rs_settings.h"
+
+LC_ImageCache& LC_ImageCache::instance() {
+    // never destroyed, images may outlive static objects
+    static LC_ImageCache* cache = new LC_ImageCache;
+    return *cache;
+}
+
+LC_ImageCache::LC_ImageCache() {
+    RS_SETTINGS->beginGroup("/Appearance");
+    m_limit = qint64(RS_SETTINGS->readNumEntry("/ImageCacheSize", 512)) << 20;
+    RS_SETTINGS->endGroup();
+}
+
+std::shared_ptr<LC_ImagePyramid> LC_ImageCache::pyramid(const QString& fileName) {
+    const QFileInfo fileInfo(fileName);
+    if (!fileInfo.exists())
+        return std::make_shared<LC_ImagePyramid>(fileName);
+    const QString key = fileInfo.canonicalFilePath() + '|'
+            + QString::number(fileInfo.lastModified().toMSecsSinceEpoch());
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::shared_ptr<LC_ImagePyramid> shared = m_pyramids.value(key).lock();
+        if (shared != nullptr)
+            return shared;
+    }
+
+    // the file is read without the lock
+    auto created = std::make_shared<LC_ImagePyramid>(fileName);
+    if (!created->size().isValid())
+        return created;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_ptr<LC_ImagePyramid> shared = m_pyramids.value(key).lock();
+    if (shared != nullptr)
+        return shared;
+    for (auto it = m_pyramids.begin(); it != m_pyramids.end();) {
+        if (it->expired())
+            it = m_pyramids.erase(it);
+        else
+            ++it;
+    }
+    m_pyramids.insert(key, created);
+    for (const auto& level: created->m_levels)
+        touch(created.get(), level.first, level.second->sizeInBytes());
+    return created;
+}
+
+void LC_ImageCache::setMemoryLimit(qint64 bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_limit = bytes;
+    evict();
+}
+
+qint64 LC_ImageCache::memoryLimit() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_limit;
+}
+
+qint64 LC_ImageCache::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+void LC_ImageCache::touch(LC_ImagePyramid* pyramid, int level, qint64 bytes) {
+    auto it = std::find_if(m_recent.begin(), m_recent.end(), [pyramid, level](const Entry& entry) {
+        return entry.pyramid == pyramid && entry.level == level;
+    });
+    if (it != m_recent.end()) {
+        m_recent.splice(m_recent.begin(), m_recent, it);
+        return;
+    }
+    m_recent.push_front({pyramid, level, bytes});
+    m_bytes += bytes;
+    evict();
+}
+
+void LC_ImageCache::forget(LC_ImagePyramid* pyramid) {
+    for (auto it = m_recent.begin(); it != m_recent.end();) {
+        if (it->pyramid == pyramid) {
+            m_bytes -= it->bytes;
+            it = m_recent.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void LC_ImageCache::evict() {
+    // the level drawn last is kept, even if it's over the limit
+    while (m_bytes > m_limit && m_recent.size() > 1) {
+        const Entry& entry = m_recent.back();
+        entry.pyramid->m_levels.erase(entry.level);
+        m_bytes -= entry.bytes;
+        m_recent.pop_back();
+    }
+}
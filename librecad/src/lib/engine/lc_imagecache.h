@@ -0,0 +1,83 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_IMAGECACHE_H
+#define LC_IMAGECACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include <QHash>
+#include <QString>
+
+class LC_ImagePyramid;
+
+/**
+ * @brief The LC_ImageCache class, the image files read by the images of all documents.
+ * An image file is read once while images use it, its pyramid is shared by path and
+ * modification time. The pyramid levels of all files are dropped in least recently
+ * drawn order, above the memory limit, setting /Appearance/ImageCacheSize in MiB.
+ */
+class LC_ImageCache {
+public:
+    static LC_ImageCache& instance();
+
+    /**
+     * @return the pyramid of the file, already read if an image uses it.
+     * Files which can't be read get a pyramid of an invalid size, not shared.
+     */
+    std::shared_ptr<LC_ImagePyramid> pyramid(const QString& fileName);
+
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+    //! the bytes of the pyramid levels held, of all files
+    qint64 memoryUsage() const;
+
+private:
+    friend class LC_ImagePyramid;
+
+    LC_ImageCache();
+    // with m_mutex locked: a level was read or drawn
+    void touch(LC_ImagePyramid* pyramid, int level, qint64 bytes);
+    // with m_mutex locked: the pyramid is destroyed
+    void forget(LC_ImagePyramid* pyramid);
+    // with m_mutex locked
+    void evict();
+
+    struct Entry {
+        LC_ImagePyramid* pyramid;
+        int level;
+        qint64 bytes;
+    };
+
+    // guards the levels of all pyramids too
+    mutable std::mutex m_mutex;
+    QHash<QString, std::weak_ptr<LC_ImagePyramid>> m_pyramids;
+    // the most recently drawn level first
+    std::list<Entry> m_recent;
+    qint64 m_bytes = 0;
+    qint64 m_limit = 0;
+};
+
+#endif // LC_IMAGECACHE_H
@@ -0,0 +1,100 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+
+#include <QImage>
+#include <QImageReader>
+
+#include "lc_imagecache.h"
+#include "lc_imagepyramid.h"
+
+namespace {
+// no level is smaller than this, in pixels
+constexpr int minLevelSize = 16;
+}
+
+LC_ImagePyramid::LC_ImagePyramid(QString fileName):
+    m_fileName{std::move(fileName)}
+{
+    QImageReader reader(m_fileName);
+    m_size = reader.size();
+    if (m_size.isValid())
+        return;
+    // the format can't tell the size without decoding
+    auto full = std::make_shared<QImage>(reader.read());
+    if (!full->isNull()) {
+        m_size = full->size();
+        // LC_ImageCache accounts for it, when it shares this pyramid
+        m_levels.emplace(0, full);
+    }
+}
+
+LC_ImagePyramid::~LC_ImagePyramid() {
+    LC_ImageCache& cache = LC_ImageCache::instance();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    cache.forget(this);
+}
+
+std::shared_ptr<QImage> LC_ImagePyramid::image(double scale) {
+    if (!m_size.isValid())
+        return {};
+
+    int level = 0;
+    if (scale > 0. && scale < 1.)
+        level = static_cast<int>(std::floor(-std::log2(scale)));
+    while (level > 0 && std::min(m_size.width(), m_size.height()) >> level < minLevelSize)
+        --level;
+
+    LC_ImageCache& cache = LC_ImageCache::instance();
+    {
+        std::lock_guard<std::mutex> lock(cache.m_mutex);
+        auto it = m_levels.find(level);
+        if (it != m_levels.end()) {
+            cache.touch(this, level, it->second->sizeInBytes());
+            return it->second;
+        }
+    }
+
+    // the file is read without the lock
+    std::shared_ptr<QImage> image = readLevel(level);
+    if (image == nullptr)
+        return {};
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    std::shared_ptr<QImage> drawn = m_levels.emplace(level, std::move(image)).first->second;
+    cache.touch(this, level, drawn->sizeInBytes());
+    return drawn;
+}
+
+std::shared_ptr<QImage> LC_ImagePyramid::readLevel(int level) const {
+    QImageReader reader(m_fileName);
+    // decoders like jpeg read downscaled images much faster
+    if (level > 0)
+        reader.setScaledSize(QSize(std::max(1, m_size.width() >> level),
+                                   std::max(1, m_size.height() >> level)));
+    auto image = std::make_shared<QImage>(reader.read());
+    if (image->isNull())
+        return {};
+    return image;
+}
@@ -0,0 +1,75 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_IMAGEPYRAMID_H
+#define LC_IMAGEPYRAMID_H
+
+#include <map>
+#include <memory>
+
+#include <QSize>
+#include <QString>
+
+class QImage;
+
+/**
+ * @brief The LC_ImagePyramid class, the raster of an image file read when it's drawn.
+ * Level n is the image at 1/2^n of its resolution, read directly at that size, so
+ * zoomed out images take memory and time for the pixels on screen. Only the size is
+ * read from the file on construction. Shared by all images of the file, see
+ * LC_ImageCache, which drops levels not drawn recently.
+ */
+class LC_ImagePyramid {
+public:
+    explicit LC_ImagePyramid(QString fileName);
+    ~LC_ImagePyramid();
+    LC_ImagePyramid(const LC_ImagePyramid&) = delete;
+    LC_ImagePyramid& operator=(const LC_ImagePyramid&) = delete;
+
+    const QString& fileName() const {
+        return m_fileName;
+    }
+    /** @return size in pixels of the full image, invalid if the file can't be read */
+    QSize size() const {
+        return m_size;
+    }
+
+    /**
+     * @brief image - the coarsest level with at least one of its pixels per screen pixel
+     * @param scale screen pixels per image pixel
+     * @return nullptr, if the file can't be read
+     */
+    std::shared_ptr<QImage> image(double scale);
+
+private:
+    friend class LC_ImageCache;
+
+    std::shared_ptr<QImage> readLevel(int level) const;
+
+    QString m_fileName;
+    QSize m_size;
+    // the levels kept by LC_ImageCache, guarded by its mutex
+    std::map<int, std::shared_ptr<QImage>> m_levels;
+};
+
+#endif // LC_IMAGEPYRAMID_H
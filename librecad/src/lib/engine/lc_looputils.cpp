@@ -24,13 +24,15 @@
 */
 #include <algorithm>
 #include <array>
-#include <map>
 #include <random>
 #include <set>
 #include <unordered_map>
 #include <vector>
 
+#include "lc_endpointindex.h"
 #include "lc_looputils.h"
+#include "lc_parallel.h"
+#include "lc_spatialindex.h"
 #include "rs_circle.h"
 #include "rs_debug.h"
 #include "rs_entity.h"
@@ -43,13 +45,12 @@
 namespace {
 
 constexpr double contourGapTolerance = 1E-7;
+// loops searched for their parents by a worker thread at once
+constexpr size_t parentChunkSize = 16;
 
 // a random angle between 0 and 2 pi
 double getRandomAngle();
 
-// Create a random ray: starting from an internal point of the loop
-std::unique_ptr<RS_Line> getRandomRay(RS_EntityContainer* loop);
-
 // Find intersection between a line and a loop
 RS_VectorSolutions getIntersection(const RS_Entity& line, const RS_EntityContainer& loop);
 
@@ -123,14 +124,6 @@ RS_Vector getInternalPoint(const RS_EntityContainer& loop)
     return RS_Vector{false};
 }
 
-std::unique_ptr<RS_Line> getRandomRay(RS_EntityContainer* loop)
-{
-    assert(loop != nullptr);
-    RS_Vector p0 = getInternalPoint(*loop);
-    double size = loop->getSize().magnitude();
-    return std::make_unique<RS_Line>(nullptr, p0, p0 + RS_Vector{getRandomAngle()}*size);
-}
-
 std::unordered_map<const RS_EntityContainer*, double> findAreas(const std::vector<std::unique_ptr<RS_EntityContainer>>& loops )
 {
     std::unordered_map<const RS_EntityContainer*, double> ret;
@@ -190,12 +183,25 @@ struct LoopExtractor::LoopData {
     LoopData(RS_EntityContainer &edges):
         size{edges.getSize().magnitude()}
     , edges{edges}
-    {}
+    {
+        for (RS_Entity* edge: edges)
+            endpoints.insert(edge);
+    }
+
+    // removes a processed edge
+    void remove(RS_Entity* edge)
+    {
+        endpoints.remove(edge);
+        edges.removeEntity(edge);
+    }
+
     const double size = 0.;
     RS_Vector vertex;
     RS_Vector vertexTarget;
     RS_Entity* current = nullptr;
     RS_EntityContainer& edges;
+    // endpoints of unprocessed edges, for connected edges
+    LC_EndpointIndex endpoints{contourGapTolerance};
 };
 
 LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
@@ -209,15 +215,8 @@ LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
 //------------------------------------------------------------------------------------//
 std::vector<RS_Entity*> LoopExtractor::getConnected() const
 {
-    std::vector<RS_Entity *> connected;
-    std::copy_if(m_data->edges.begin(), m_data->edges.end(), std::back_inserter(connected),
-                 [vertex = m_data->vertex, current = m_data->current](const RS_Entity *e) {
-        if (e == current)
-            return false;
-        double dist = RS_MAXDOUBLE;
-        e->getNearestEndpoint(vertex, &dist);
-        return dist < contourGapTolerance;
-    });
+    std::vector<RS_Entity *> connected = m_data->endpoints.getConnected(m_data->vertex);
+    connected.erase(std::remove(connected.begin(), connected.end(), m_data->current), connected.end());
     return connected;
 }
 
@@ -277,7 +276,7 @@ RS_Entity* LoopExtractor::findFirst() const
     m_data->current = first;
     m_loop = std::make_unique<RS_EntityContainer>(nullptr, false);
     m_loop->addEntity(m_data->current);
-    m_data->edges.removeEntity(first);
+    m_data->remove(first);
     return first;
 }
 
@@ -340,7 +339,7 @@ bool LoopExtractor::findNext() const
     }
     m_data->vertex = (m_data->vertex.squaredTo(m_data->current->getStartpoint()) > RS_TOLERANCE) ? m_data->current->getStartpoint() : m_data->current->getEndpoint();
     m_loop->addEntity(m_data->current);
-    m_data->edges.removeEntity(m_data->current);
+    m_data->remove(m_data->current);
     return true;
 }
 
@@ -401,7 +400,6 @@ struct LoopSorter::Data {
         loops{std::move(loops)}
       , area{findAreas(this->loops)}
       , areaComparison{*sorter}
-      , toProcess{areaComparison}
     {}
 
     // hold input loops
@@ -410,11 +408,14 @@ struct LoopSorter::Data {
     std::unordered_map<const RS_EntityContainer*, double> area;
     // compare loops by their enclosed areas
     // The area of any ancestor loop is larger than the child loop.
-    // Always find ancestors using the loop with the smallest unprocessed loop.
-    // For each loop, only need to find its parent once.
     LoopSorter::AreaPredicate areaComparison;
-    // Candidate loops, sorted by their enclosed areas
-    std::multiset<RS_EntityContainer*, LoopSorter::AreaPredicate> toProcess;
+    // loops, sorted by their enclosed areas
+    std::vector<RS_EntityContainer*> sorted;
+    // an internal point and a ray direction of each sorted loop
+    std::vector<RS_Vector> innerPoints;
+    std::vector<RS_Vector> directions;
+    // bounding boxes of the sorted loops. Queries return loops in the area order
+    LC_SpatialIndex boxes;
     // lookup table for parent loops
     std::unordered_map<RS_EntityContainer*, RS_EntityContainer*> parents;
 };
@@ -443,48 +444,66 @@ LoopSorter::~LoopSorter() = default;
 //------------------------------------------------------------------------------------//
 void LoopSorter::init()
 {
+    std::vector<RS_EntityContainer*>& sorted = m_data->sorted;
     for(const auto& loop: m_data->loops)
-        m_data->toProcess.insert(loop.get());
-    std::vector<RS_EntityContainer*> loops{m_data->toProcess.begin(), m_data->toProcess.end()};
+        sorted.push_back(loop.get());
+    std::stable_sort(sorted.begin(), sorted.end(), m_data->areaComparison);
+    if (sorted.size() < 2)
+        return;
+
+    // the random engine is not shared with worker threads
+    for (RS_EntityContainer* loop : sorted) {
+        m_data->innerPoints.push_back(getInternalPoint(*loop));
+        // use a random direction to avoid passing tangential directions
+        // TODO, to complete avoid tangential
+        m_data->directions.emplace_back(getRandomAngle());
+    }
+    m_data->boxes.build(std::vector<RS_Entity*>(sorted.begin(), sorted.end()));
 
-    for (RS_EntityContainer* loop : loops)
-        findAncestors(loop);
+    std::vector<RS_EntityContainer*> found(sorted.size(), nullptr);
+    LC_Parallel::forEach(sorted.size(), parentChunkSize, [this, &found](size_t i) {
+        found[i] = findParent(i);
+    });
+
+    // link children in the area order, so the results don't depend on the threads
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (found[i] == nullptr)
+            continue;
+        m_data->parents[sorted[i]] = found[i];
+        found[i]->addEntity(sorted[i]);
+    }
 }
 
 //------------------------------------------------------------------------------------//
-void LoopSorter::findAncestors(RS_EntityContainer* loop)
+RS_EntityContainer* LoopSorter::findParent(size_t index) const
 {
-    if (m_data->toProcess.erase(loop) == 0)
-        return;
+    const RS_EntityContainer* loop = m_data->sorted[index];
+    const RS_Vector& point = m_data->innerPoints[index];
+    if (!point.valid)
+        return nullptr;
+
+    const RS_Vector loopMin = loop->getMin();
+    const RS_Vector loopMax = loop->getMax();
+    auto encloses = [&loopMin, &loopMax](const RS_EntityContainer& candidate) {
+        const RS_Vector tolerance{RS_TOLERANCE, RS_TOLERANCE};
+        const RS_Vector min = candidate.getMin() - tolerance;
+        const RS_Vector max = candidate.getMax() + tolerance;
+        return min.x <= loopMin.x && min.y <= loopMin.y && loopMax.x <= max.x && loopMax.y <= max.y;
+    };
 
-    // use a random direction to avoid passing tangential directions
-    // TODO, to complete avoid tangential
-    auto ray = getRandomRay(loop);
-    // sorting by floating points is okay, the loops shouldn't be close to each other, with exception
-    // of touching points
-    std::map<double, RS_EntityContainer*> ancestors;
-    for(RS_EntityContainer* candidate: m_data->toProcess) {
-        if (candidate == loop)
-            continue;
-        RS_VectorSolutions intersections = getIntersection(*ray, *candidate);
-        if (intersections.size()%2 == 0)
+    // candidates come in the increasing area order: the first one enclosing the loop is its parent
+    for (RS_Entity* entity : m_data->boxes.queryWindow(loopMin, loopMax)) {
+        auto candidate = static_cast<RS_EntityContainer*>(entity);
+        if (candidate == loop || !m_data->areaComparison(loop, candidate) || !encloses(*candidate))
             continue;
+        // the ray is long enough to leave the bounding box of the candidate
+        const double length = 1.1 * candidate->getSize().magnitude() + RS_TOLERANCE;
+        const RS_Line ray{nullptr, point, point + m_data->directions[index] * length};
         // a parent loop has odd intersections for a ray starting from an inner point
-        double distance = intersections.getClosestDistance(ray->getStartpoint());
-        ancestors.emplace(distance, candidate);
-    }
-    // ancestors found: from innermost to outermost
-    RS_EntityContainer* current = loop;
-    for (const auto& entry: ancestors)
-    {
-        RS_EntityContainer* parent = entry.second;
-        m_data->toProcess.erase(parent);
-        if (m_data->parents.count(current) == 1)
-            break;
-        m_data->parents[current] = parent;
-        parent->addEntity(current);
-        current = parent;
+        if (getIntersection(ray, *candidate).size() % 2 == 1)
+            return candidate;
     }
+    return nullptr;
 }
 
 
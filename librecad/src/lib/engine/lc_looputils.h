@@ -164,8 +164,8 @@ private:
 
     void init();
 
-    // find all ancestor loops of a given loop
-    void findAncestors(RS_EntityContainer* loop);
+    // find the immediate parent loop of the loop at the given position in the area order
+    RS_EntityContainer* findParent(size_t index) const;
 
     struct Data;
     std::unique_ptr<Data> m_data;
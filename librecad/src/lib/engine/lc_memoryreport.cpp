@@ -0,0 +1,329 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <QObject>
+
+#include "lc_dimarc.h"
+#include "lc_hyperbola.h"
+#include "lc_imagecache.h"
+#include "lc_memoryreport.h"
+#include "lc_parabola.h"
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_blocklist.h"
+#include "rs_circle.h"
+#include "rs_constructionline.h"
+#include "rs_dimaligned.h"
+#include "rs_dimangular.h"
+#include "rs_dimdiametric.h"
+#include "rs_dimlinear.h"
+#include "rs_dimradial.h"
+#include "rs_ellipse.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_image.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_leader.h"
+#include "rs_line.h"
+#include "rs_mtext.h"
+#include "rs_pattern.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+#include "rs_spline.h"
+#include "rs_text.h"
+
+namespace {
+
+size_t stringBytes(const QString& text)
+{
+    return text.capacity() * sizeof(QChar);
+}
+
+template<class T>
+size_t vectorBytes(const std::vector<T>& v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+// bytes as text, in the unit fitting the size
+QString formatBytes(size_t bytes)
+{
+    if (bytes >= (size_t(1) << 30))
+        return QString("%1 GiB").arg(bytes / double(1 << 30), 0, 'f', 2);
+    if (bytes >= (size_t(1) << 20))
+        return QString("%1 MiB").arg(bytes / double(1 << 20), 0, 'f', 1);
+    if (bytes >= 1024)
+        return QString("%1 KiB").arg(bytes / 1024., 0, 'f', 1);
+    return QString("%1 B").arg(bytes);
+}
+
+void appendRow(QString& text, const QString& name, const LC_MemoryReport::Usage& usage)
+{
+    text += QString("  %1 %2 %3\n").arg(name, -32).arg(usage.count, 10).arg(formatBytes(usage.bytes), 12);
+}
+
+// the rows of a table, the largest first
+template<class Key, class Name>
+void appendTable(QString& text, const QString& title, const std::map<Key, LC_MemoryReport::Usage>& table,
+                 Name name)
+{
+    std::vector<std::pair<Key, LC_MemoryReport::Usage>> rows{table.cbegin(), table.cend()};
+    std::stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.second.bytes > b.second.bytes;
+    });
+    text += title + "\n";
+    for (const auto& [key, usage]: rows)
+        appendRow(text, name(key), usage);
+}
+}
+
+LC_MemoryReport::Usage& LC_MemoryReport::Usage::operator += (const Usage& other)
+{
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+}
+
+LC_MemoryReport::LC_MemoryReport(RS_Graphic& graphic)
+{
+    m_modelSpace = addDocument(graphic, true);
+
+    if (RS_BlockList* blockList = graphic.getBlockList()) {
+        for (RS_Block* block: *blockList) {
+            const Usage usage = addDocument(*block, false);
+            m_blocks[block->getName()] = usage;
+            m_blockDefinitions += usage;
+        }
+    }
+
+    m_imageCacheBytes = size_t(LC_ImageCache::instance().memoryUsage());
+}
+
+LC_MemoryReport::Usage LC_MemoryReport::addDocument(RS_EntityContainer& document, bool modelSpace)
+{
+    Usage total;
+    for (const RS_Entity* e: document) {
+        Usage usage = addEntity(*e);
+        if (e->isUndone()) {
+            m_undoneEntities += usage;
+            continue;
+        }
+        m_topLevelTypes[e->rtti()] += usage;
+        if (modelSpace) {
+            const RS_Layer* layer = e->getLayer();
+            m_layers[layer != nullptr ? layer->getName() : QString{}] += usage;
+        }
+        total += usage;
+    }
+
+    if (auto* undo = dynamic_cast<RS_Document*>(&document)) {
+        size_t undoables = 0;
+        const size_t bytes = undo->memoryUsage(undoables);
+        m_undoCycles += {undoables, bytes};
+    }
+    return total;
+}
+
+LC_MemoryReport::Usage LC_MemoryReport::addEntity(const RS_Entity& entity)
+{
+    Usage usage{1, entityBytes(entity)};
+    m_types[entity.rtti()] += usage;
+    if (entity.isContainer()) {
+        for (const RS_Entity* child: static_cast<const RS_EntityContainer&>(entity))
+            usage += addEntity(*child);
+    }
+    return usage;
+}
+
+size_t LC_MemoryReport::entityBytes(const RS_Entity& entity)
+{
+    // the list of children
+    size_t bytes = entity.isContainer()
+        ? static_cast<const RS_EntityContainer&>(entity).count() * sizeof(RS_Entity*)
+        : 0;
+
+    switch (entity.rtti()) {
+    case RS2::EntityPoint:
+        return bytes + sizeof(RS_Point);
+    case RS2::EntityLine:
+        return bytes + sizeof(RS_Line);
+    case RS2::EntityPolyline:
+        return bytes + sizeof(RS_Polyline);
+    case RS2::EntityArc:
+        return bytes + sizeof(RS_Arc);
+    case RS2::EntityCircle:
+        return bytes + sizeof(RS_Circle);
+    case RS2::EntityEllipse:
+        return bytes + sizeof(RS_Ellipse);
+    case RS2::EntityHyperbola:
+        return bytes + sizeof(LC_Hyperbola);
+    case RS2::EntitySolid:
+        return bytes + sizeof(RS_Solid);
+    case RS2::EntityConstructionLine:
+        return bytes + sizeof(RS_ConstructionLine);
+    case RS2::EntityMText: {
+        const auto& text = static_cast<const RS_MText&>(entity);
+        return bytes + sizeof(RS_MText) + stringBytes(text.getText());
+    }
+    case RS2::EntityText: {
+        const RS_TextData data = static_cast<const RS_Text&>(entity).getData();
+        return bytes + sizeof(RS_Text) + stringBytes(data.text) + stringBytes(data.style);
+    }
+    case RS2::EntityDimAligned:
+        return bytes + sizeof(RS_DimAligned);
+    case RS2::EntityDimLinear:
+        return bytes + sizeof(RS_DimLinear);
+    case RS2::EntityDimRadial:
+        return bytes + sizeof(RS_DimRadial);
+    case RS2::EntityDimDiametric:
+        return bytes + sizeof(RS_DimDiametric);
+    case RS2::EntityDimAngular:
+        return bytes + sizeof(RS_DimAngular);
+    case RS2::EntityDimArc:
+        return bytes + sizeof(LC_DimArc);
+    case RS2::EntityDimLeader:
+        return bytes + sizeof(RS_Leader);
+    case RS2::EntityHatch:
+        return bytes + sizeof(RS_Hatch);
+    case RS2::EntityImage:
+        return bytes + sizeof(RS_Image) + stringBytes(static_cast<const RS_Image&>(entity).getData().file);
+    case RS2::EntitySpline: {
+        const RS_SplineData& data = static_cast<const RS_Spline&>(entity).getData();
+        return bytes + sizeof(RS_Spline) + vectorBytes(data.controlPoints) + vectorBytes(data.knotslist);
+    }
+    case RS2::EntitySplinePoints:
+    case RS2::EntityParabola: {
+        const LC_SplinePointsData& data = static_cast<const LC_SplinePoints&>(entity).getData();
+        const size_t size = entity.rtti() == RS2::EntityParabola ? sizeof(LC_Parabola) : sizeof(LC_SplinePoints);
+        return bytes + size + vectorBytes(data.splinePoints) + vectorBytes(data.controlPoints);
+    }
+    case RS2::EntityInsert:
+        return bytes + sizeof(RS_Insert);
+    case RS2::EntityBlock:
+        return bytes + sizeof(RS_Block);
+    case RS2::EntityPattern:
+        return bytes + sizeof(RS_Pattern);
+    default:
+        return bytes + (entity.isContainer() ? sizeof(RS_EntityContainer) : sizeof(RS_AtomicEntity));
+    }
+}
+
+QString LC_MemoryReport::typeName(RS2::EntityType type)
+{
+    switch (type) {
+    case RS2::EntityContainer:
+        return QObject::tr("Container");
+    case RS2::EntityBlock:
+        return QObject::tr("Block");
+    case RS2::EntityFontChar:
+        return QObject::tr("Font letter");
+    case RS2::EntityInsert:
+        return QObject::tr("Insert");
+    case RS2::EntityPoint:
+        return QObject::tr("Point");
+    case RS2::EntityLine:
+        return QObject::tr("Line");
+    case RS2::EntityPolyline:
+        return QObject::tr("Polyline");
+    case RS2::EntityArc:
+        return QObject::tr("Arc");
+    case RS2::EntityCircle:
+        return QObject::tr("Circle");
+    case RS2::EntityEllipse:
+        return QObject::tr("Ellipse");
+    case RS2::EntityHyperbola:
+        return QObject::tr("Hyperbola");
+    case RS2::EntitySolid:
+        return QObject::tr("Solid");
+    case RS2::EntityConstructionLine:
+        return QObject::tr("Construction line");
+    case RS2::EntityMText:
+        return QObject::tr("MText");
+    case RS2::EntityText:
+        return QObject::tr("Text");
+    case RS2::EntityDimAligned:
+        return QObject::tr("Aligned dimension");
+    case RS2::EntityDimLinear:
+        return QObject::tr("Linear dimension");
+    case RS2::EntityDimRadial:
+        return QObject::tr("Radial dimension");
+    case RS2::EntityDimDiametric:
+        return QObject::tr("Diametric dimension");
+    case RS2::EntityDimAngular:
+        return QObject::tr("Angular dimension");
+    case RS2::EntityDimArc:
+        return QObject::tr("Arc dimension");
+    case RS2::EntityDimLeader:
+        return QObject::tr("Leader");
+    case RS2::EntityHatch:
+        return QObject::tr("Hatch");
+    case RS2::EntityImage:
+        return QObject::tr("Image");
+    case RS2::EntitySpline:
+        return QObject::tr("Spline");
+    case RS2::EntitySplinePoints:
+        return QObject::tr("Spline through points");
+    case RS2::EntityParabola:
+        return QObject::tr("Parabola");
+    case RS2::EntityPattern:
+        return QObject::tr("Hatch pattern");
+    default:
+        return QObject::tr("Other");
+    }
+}
+
+size_t LC_MemoryReport::totalBytes() const
+{
+    return m_modelSpace.bytes + m_blockDefinitions.bytes + m_undoneEntities.bytes + m_undoCycles.bytes
+        + m_imageCacheBytes;
+}
+
+QString LC_MemoryReport::toText() const
+{
+    QString text;
+    text += QObject::tr("Approximate memory usage: %1").arg(formatBytes(totalBytes())) + "\n";
+    appendRow(text, QObject::tr("Model space"), m_modelSpace);
+    appendRow(text, QObject::tr("Block definitions"), m_blockDefinitions);
+    appendRow(text, QObject::tr("Undone entities"), m_undoneEntities);
+    appendRow(text, QObject::tr("Undo cycles (undoables)"), m_undoCycles);
+    appendRow(text, QObject::tr("Image cache"), {0, m_imageCacheBytes});
+
+    const auto byType = [](RS2::EntityType type) {
+        return typeName(type);
+    };
+    appendTable(text, QObject::tr("Entity types, without children:"), m_types, byType);
+    appendTable(text, QObject::tr("Entity types, with children:"), m_topLevelTypes, byType);
+    appendTable(text, QObject::tr("Layers:"), m_layers, [](const QString& name) {
+        return name;
+    });
+    appendTable(text, QObject::tr("Blocks:"), m_blocks, [](const QString& name) {
+        return name;
+    });
+    return text;
+}
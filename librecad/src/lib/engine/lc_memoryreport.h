@@ -0,0 +1,124 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_MEMORYREPORT_H
+#define LC_MEMORYREPORT_H
+
+#include <cstddef>
+#include <map>
+
+#include <QString>
+
+#include "rs.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+class RS_Graphic;
+
+/**
+ * @brief The LC_MemoryReport class, the approximate memory used by a document.
+ *
+ * Walks the entities of the model space and of the blocks, and reports the bytes of the entity
+ * objects and of the data they own, e.g. the points of splines, by entity type, by layer and by
+ * block. Entities deleted but kept for undo, and the undo cycles, are reported as undo history.
+ * Shared data, like fonts and hatch patterns, and heap overhead are not counted.
+ */
+class LC_MemoryReport {
+public:
+    struct Usage {
+        size_t count = 0;
+        size_t bytes = 0;
+
+        Usage& operator += (const Usage& other);
+    };
+
+    explicit LC_MemoryReport(RS_Graphic& graphic);
+
+    /**
+     * @return the bytes of the entity itself and the data it owns, without its child entities.
+     */
+    static size_t entityBytes(const RS_Entity& entity);
+
+    //! the translated name of an entity type
+    static QString typeName(RS2::EntityType type);
+
+    //! all entities by their own type, the bytes without children
+    const std::map<RS2::EntityType, Usage>& types() const {
+        return m_types;
+    }
+    //! entities of the model space and of blocks by their type, including their children,
+    //! e.g. text letters, hatch boundaries and patterns
+    const std::map<RS2::EntityType, Usage>& topLevelTypes() const {
+        return m_topLevelTypes;
+    }
+    //! entities of the model space by their layer, including their children
+    const std::map<QString, Usage>& layers() const {
+        return m_layers;
+    }
+    //! the entities of each block, including their children
+    const std::map<QString, Usage>& blocks() const {
+        return m_blocks;
+    }
+
+    const Usage& modelSpace() const {
+        return m_modelSpace;
+    }
+    //! the entities of all block definitions
+    const Usage& blockDefinitions() const {
+        return m_blockDefinitions;
+    }
+    //! entities deleted or undone, still held by the undo cycles of the documents
+    const Usage& undoneEntities() const {
+        return m_undoneEntities;
+    }
+    //! the undo cycles of the drawing and of blocks, counting their undoables
+    const Usage& undoCycles() const {
+        return m_undoCycles;
+    }
+    //! the image pixels read, shared by the images of all open documents
+    size_t imageCacheBytes() const {
+        return m_imageCacheBytes;
+    }
+    size_t totalBytes() const;
+
+    //! the report as a plain text table, for the command line and the clipboard
+    QString toText() const;
+
+private:
+    // the entities of a document, the model space or a block
+    Usage addDocument(RS_EntityContainer& document, bool modelSpace);
+    // the entity and its children, counted by their own types
+    Usage addEntity(const RS_Entity& entity);
+
+    std::map<RS2::EntityType, Usage> m_types;
+    std::map<RS2::EntityType, Usage> m_topLevelTypes;
+    std::map<QString, Usage> m_layers;
+    std::map<QString, Usage> m_blocks;
+    Usage m_modelSpace;
+    Usage m_blockDefinitions;
+    Usage m_undoneEntities;
+    Usage m_undoCycles;
+    size_t m_imageCacheBytes = 0;
+};
+
+#endif // LC_MEMORYREPORT_H
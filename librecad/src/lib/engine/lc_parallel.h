@@ -0,0 +1,73 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_PARALLEL_H
+#define LC_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace LC_Parallel {
+
+/**
+ * @brief forEach - calls job(i) for i in [0, count), by worker threads taking chunks of
+ * consecutive indices. Jobs must be independent; they are run by the calling thread,
+ * if there are fewer than two chunks or a single core.
+ * @param count - number of jobs
+ * @param chunkSize - number of jobs taken by a worker at once
+ */
+template<typename Job>
+void forEach(size_t count, size_t chunkSize, Job job)
+{
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    const size_t chunks = (count + chunkSize - 1) / chunkSize;
+    const size_t threadCount = std::min<size_t>(std::thread::hardware_concurrency(), chunks);
+    if (threadCount < 2) {
+        for (size_t i = 0; i < count; ++i)
+            job(i);
+        return;
+    }
+
+    std::atomic<size_t> nextChunk{0};
+    auto runChunks = [count, chunkSize, chunks, &nextChunk, &job]() {
+        for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            const size_t end = std::min(count, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i)
+                job(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i)
+        workers.emplace_back(runChunks);
+    runChunks();
+    for (std::thread& worker: workers)
+        worker.join();
+}
+
+}
+
+#endif // LC_PARALLEL_H
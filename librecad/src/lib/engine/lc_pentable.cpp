@@ -0,0 +1,128 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "lc_pentable.h"
+#include "rs_debug.h"
+#include "rs_pen.h"
+
+namespace {
+constexpr size_t chunkSize = 256;
+constexpr size_t maxChunks = 4096;
+
+// RS_Pen::operator==() only compares the color, width and line type
+bool isIdentical(const RS_Pen& p0, const RS_Pen& p1)
+{
+    return p0.getFlags() == p1.getFlags()
+            && p0.getLineType() == p1.getLineType()
+            && p0.getWidth() == p1.getWidth()
+            && p0.getScreenWidth() == p1.getScreenWidth()
+            && p0.getColor() == p1.getColor()
+            && p0.getColor().getFlags() == p1.getColor().getFlags()
+            && p0.getAlpha() == p1.getAlpha()
+            && p0.dashOffset() == p1.dashOffset();
+}
+
+struct PenHash {
+    size_t operator () (const RS_Pen& pen) const
+    {
+        size_t seed = std::hash<unsigned>{}(pen.getFlags());
+        auto combine = [&seed](size_t value) {
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+        combine(std::hash<int>{}(pen.getLineType()));
+        combine(std::hash<int>{}(pen.getWidth()));
+        combine(std::hash<unsigned>{}(pen.getColor().rgba()));
+        combine(std::hash<unsigned>{}(pen.getColor().getFlags()));
+        return seed;
+    }
+};
+
+struct PenEqual {
+    bool operator () (const RS_Pen& p0, const RS_Pen& p1) const
+    {
+        return isIdentical(p0, p1);
+    }
+};
+
+struct Table {
+    // chunks are never moved, so readers don't need the lock
+    std::array<std::atomic<RS_Pen*>, maxChunks> chunks{};
+    std::unordered_map<RS_Pen, LC_PenTable::Index, PenHash, PenEqual> indices;
+    size_t size = 0;
+    std::mutex mutex;
+
+    Table()
+    {
+        add(RS_Pen{});
+    }
+
+    LC_PenTable::Index add(const RS_Pen& pen)
+    {
+        const size_t chunk = size / chunkSize;
+        if (chunk >= maxChunks) {
+            RS_DEBUG->print(RS_Debug::D_WARNING, "LC_PenTable::intern: too many pens");
+            return 0;
+        }
+        RS_Pen* pens = chunks[chunk].load(std::memory_order_relaxed);
+        if (pens == nullptr) {
+            pens = new RS_Pen[chunkSize];
+            chunks[chunk].store(pens, std::memory_order_release);
+        }
+        pens[size % chunkSize] = pen;
+        const auto index = static_cast<LC_PenTable::Index>(size++);
+        indices.emplace(pen, index);
+        return index;
+    }
+};
+
+// never destroyed, entities may still be deleted while static objects are destroyed
+Table& table()
+{
+    static Table* instance = new Table;
+    return *instance;
+}
+}
+
+LC_PenTable::Index LC_PenTable::intern(const RS_Pen& pen)
+{
+    Table& penTable = table();
+    std::lock_guard<std::mutex> lock(penTable.mutex);
+    auto it = penTable.indices.find(pen);
+    if (it != penTable.indices.end())
+        return it->second;
+    return penTable.add(pen);
+}
+
+const RS_Pen& LC_PenTable::get(Index index)
+{
+    const RS_Pen* pens = table().chunks[index / chunkSize].load(std::memory_order_acquire);
+    return pens[index % chunkSize];
+}
@@ -0,0 +1,57 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_PENTABLE_H
+#define LC_PENTABLE_H
+
+class RS_Pen;
+
+/**
+ * @brief The LC_PenTable class, a table of interned pens, shared by all entities.
+ *
+ * Drawings use a few hundred distinct pens at most, across any number of entities. Entities store
+ * the index of their pen in this table, instead of a full RS_Pen.
+ *
+ * The table is global rather than per graphic: entities move between documents (clipboard, block
+ * creation, undo), and the pen of an entity is read without looking up its graphic. Pens are never
+ * removed, and an index stays valid for the lifetime of the application.
+ *
+ * Lookups by index are lock free, so pens can be resolved while drawing from several threads.
+ */
+class LC_PenTable {
+public:
+    using Index = unsigned;
+
+    /**
+     * @brief intern - find or add a pen. Pens are identical, if all their attributes and flags are equal
+     * @return the index of the pen
+     */
+    static Index intern(const RS_Pen& pen);
+
+    /**
+     * @return the pen at the index returned by intern(). Index 0 is the default pen, RS_Pen()
+     */
+    static const RS_Pen& get(Index index);
+};
+
+#endif // LC_PENTABLE_H
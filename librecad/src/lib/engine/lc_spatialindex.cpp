@@ -0,0 +1,361 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include "lc_spatialindex.h"
+#include "rs.h"
+#include "rs_entity.h"
+#include "rs_vector.h"
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+namespace {
+
+using Point = bg::model::point<double, 2, bg::cs::cartesian>;
+using Box = bg::model::box<Point>;
+using Value = std::pair<Box, RS_Entity*>;
+using Tree = bgi::rtree<Value, bgi::rstar<16>>;
+
+Point toPoint(const RS_Vector& vp)
+{
+    return {vp.x, vp.y};
+}
+
+Box toBox(const RS_Entity& entity)
+{
+    return {toPoint(entity.getMin()), toPoint(entity.getMax())};
+}
+
+Box toBox(const RS_Vector& v1, const RS_Vector& v2)
+{
+    return {{std::min(v1.x, v2.x), std::min(v1.y, v2.y)},
+            {std::max(v1.x, v2.x), std::max(v1.y, v2.y)}};
+}
+
+bool isSameBox(const Box& b0, const Box& b1)
+{
+    return bg::get<bg::min_corner, 0>(b0) == bg::get<bg::min_corner, 0>(b1)
+            && bg::get<bg::min_corner, 1>(b0) == bg::get<bg::min_corner, 1>(b1)
+            && bg::get<bg::max_corner, 0>(b0) == bg::get<bg::max_corner, 0>(b1)
+            && bg::get<bg::max_corner, 1>(b0) == bg::get<bg::max_corner, 1>(b1);
+}
+}
+
+struct LC_SpatialIndex::Data {
+    struct Entry {
+        // the box as stored in the tree, needed to remove an entry
+        Box box;
+        // the key of the entity in the container order
+        double order = 0.;
+        bool bounded = false;
+    };
+
+    Tree tree;
+    std::unordered_map<const RS_Entity*, Entry> entries;
+    // entities without a valid bounding box
+    std::vector<RS_Entity*> unbounded;
+
+    void add(RS_Entity* entity, double order)
+    {
+        Entry entry;
+        entry.order = order;
+        entry.bounded = hasValidBox(*entity);
+        if (entry.bounded) {
+            entry.box = toBox(*entity);
+            tree.insert({entry.box, entity});
+        } else {
+            unbounded.push_back(entity);
+        }
+        entries.emplace(entity, entry);
+    }
+
+    void removeUnbounded(const RS_Entity* entity)
+    {
+        auto it = std::find(unbounded.begin(), unbounded.end(), entity);
+        if (it != unbounded.end())
+            unbounded.erase(it);
+    }
+
+    const Entry* find(const RS_Entity* entity) const
+    {
+        auto it = entries.find(entity);
+        return it != entries.end() ? &it->second : nullptr;
+    }
+};
+
+LC_SpatialIndex::LC_SpatialIndex():
+    m_data{std::make_unique<Data>()}
+{}
+
+LC_SpatialIndex::~LC_SpatialIndex() = default;
+
+void LC_SpatialIndex::build(const std::vector<RS_Entity*>& entities)
+{
+    clear();
+    std::vector<Value> values;
+    values.reserve(entities.size());
+    double order = 0.;
+    for (RS_Entity* entity: entities) {
+        if (entity == nullptr || contains(entity))
+            continue;
+        Data::Entry entry;
+        entry.order = order;
+        order += 1.;
+        entry.bounded = hasValidBox(*entity);
+        if (entry.bounded) {
+            entry.box = toBox(*entity);
+            values.emplace_back(entry.box, entity);
+        } else {
+            m_data->unbounded.push_back(entity);
+        }
+        m_data->entries.emplace(entity, entry);
+    }
+    // packing algorithm
+    m_data->tree = Tree{values.cbegin(), values.cend()};
+}
+
+bool LC_SpatialIndex::insert(RS_Entity* entity, const RS_Entity* previous, const RS_Entity* next)
+{
+    if (entity == nullptr || contains(entity))
+        return true;
+    const Data::Entry* before = previous != nullptr ? m_data->find(previous) : nullptr;
+    const Data::Entry* after = next != nullptr ? m_data->find(next) : nullptr;
+    if ((previous != nullptr && before == nullptr) || (next != nullptr && after == nullptr))
+        return false;
+
+    double order = 0.;
+    if (before != nullptr && after != nullptr) {
+        order = 0.5 * (before->order + after->order);
+        // no more room between the neighbors
+        if (!(before->order < order && order < after->order))
+            return false;
+    } else if (before != nullptr) {
+        order = before->order + 1.;
+    } else if (after != nullptr) {
+        order = after->order - 1.;
+    }
+    m_data->add(entity, order);
+    return true;
+}
+
+bool LC_SpatialIndex::reorder(const std::vector<RS_Entity*>& moved, const RS_Entity* previous,
+                              const RS_Entity* next)
+{
+    const Data::Entry* before = previous != nullptr ? m_data->find(previous) : nullptr;
+    const Data::Entry* after = next != nullptr ? m_data->find(next) : nullptr;
+    if ((previous != nullptr && before == nullptr) || (next != nullptr && after == nullptr))
+        return false;
+
+    std::vector<Data::Entry*> entries;
+    entries.reserve(moved.size());
+    for (RS_Entity* entity: moved) {
+        auto it = m_data->entries.find(entity);
+        if (it == m_data->entries.end())
+            return false;
+        entries.push_back(&it->second);
+    }
+    if (entries.empty())
+        return true;
+
+    // keys evenly spaced between the neighbors, only the moved entities change: the boxes stay in the tree
+    const double count = double(entries.size());
+    double first = 1.;
+    double step = 1.;
+    if (before != nullptr && after != nullptr) {
+        step = (after->order - before->order) / (count + 1.);
+        first = before->order + step;
+        // no more room between the neighbors
+        if (!(before->order < first && first + step * (count - 1.) < after->order && first < first + step))
+            return false;
+    } else if (before != nullptr) {
+        first = before->order + 1.;
+    } else if (after != nullptr) {
+        first = after->order - count;
+    }
+    for (size_t i = 0; i < entries.size(); ++i)
+        entries[i]->order = first + step * double(i);
+    return true;
+}
+
+bool LC_SpatialIndex::remove(RS_Entity* entity)
+{
+    auto it = m_data->entries.find(entity);
+    if (it == m_data->entries.end())
+        return false;
+    if (it->second.bounded)
+        m_data->tree.remove(Value{it->second.box, entity});
+    else
+        m_data->removeUnbounded(entity);
+    m_data->entries.erase(it);
+    return true;
+}
+
+bool LC_SpatialIndex::update(RS_Entity* entity)
+{
+    auto it = m_data->entries.find(entity);
+    if (it == m_data->entries.end())
+        return false;
+
+    Data::Entry& entry = it->second;
+    const bool bounded = hasValidBox(*entity);
+    if (bounded && entry.bounded) {
+        Box box = toBox(*entity);
+        if (isSameBox(box, entry.box))
+            return true;
+        m_data->tree.remove(Value{entry.box, entity});
+        m_data->tree.insert({box, entity});
+        entry.box = box;
+    } else if (bounded) {
+        m_data->removeUnbounded(entity);
+        entry.box = toBox(*entity);
+        entry.bounded = true;
+        m_data->tree.insert({entry.box, entity});
+    } else if (entry.bounded) {
+        m_data->tree.remove(Value{entry.box, entity});
+        entry.bounded = false;
+        m_data->unbounded.push_back(entity);
+    }
+    return true;
+}
+
+bool LC_SpatialIndex::contains(const RS_Entity* entity) const
+{
+    return m_data->entries.count(entity) == 1;
+}
+
+bool LC_SpatialIndex::isBefore(const RS_Entity* e0, const RS_Entity* e1) const
+{
+    const Data::Entry* entry0 = m_data->find(e0);
+    const Data::Entry* entry1 = m_data->find(e1);
+    return entry0 != nullptr && entry1 != nullptr && entry0->order < entry1->order;
+}
+
+void LC_SpatialIndex::clear()
+{
+    m_data->tree.clear();
+    m_data->entries.clear();
+    m_data->unbounded.clear();
+}
+
+size_t LC_SpatialIndex::size() const
+{
+    return m_data->entries.size();
+}
+
+std::vector<RS_Entity*> LC_SpatialIndex::queryWindow(const RS_Vector& v1, const RS_Vector& v2) const
+{
+    std::vector<Value> found;
+    m_data->tree.query(bgi::intersects(toBox(v1, v2)), std::back_inserter(found));
+
+    // restore the container order
+    std::vector<std::pair<double, RS_Entity*>> ordered;
+    ordered.reserve(m_data->unbounded.size() + found.size());
+    for (RS_Entity* entity: m_data->unbounded)
+        ordered.emplace_back(m_data->entries.at(entity).order, entity);
+    for (const Value& value: found)
+        ordered.emplace_back(m_data->entries.at(value.second).order, value.second);
+    std::sort(ordered.begin(), ordered.end(),
+              [](const std::pair<double, RS_Entity*>& p0, const std::pair<double, RS_Entity*>& p1) {
+        return p0.first < p1.first;
+    });
+
+    std::vector<RS_Entity*> ret;
+    ret.reserve(ordered.size());
+    std::transform(ordered.cbegin(), ordered.cend(), std::back_inserter(ret),
+                   [](const std::pair<double, RS_Entity*>& p) { return p.second; });
+    return ret;
+}
+
+std::vector<RS_Entity*> LC_SpatialIndex::queryNearest(const RS_Vector& coord, size_t k) const
+{
+    std::vector<Value> found;
+    if (k >= 1)
+        m_data->tree.query(bgi::nearest(toPoint(coord), static_cast<unsigned>(k)), std::back_inserter(found));
+
+    // the nearest predicate doesn't guarantee the order of the output
+    const Point point = toPoint(coord);
+    std::sort(found.begin(), found.end(), [&point](const Value& v0, const Value& v1) {
+        return bg::comparable_distance(point, v0.first) < bg::comparable_distance(point, v1.first);
+    });
+    std::vector<RS_Entity*> ret;
+    ret.reserve(found.size());
+    std::transform(found.cbegin(), found.cend(), std::back_inserter(ret),
+                   [](const Value& value) { return value.second; });
+    return ret;
+}
+
+void LC_SpatialIndex::visitNearest(const RS_Vector& coord,
+                                   const std::function<bool(RS_Entity*, double)>& visitor) const
+{
+    for (RS_Entity* entity: m_data->unbounded)
+        if (!visitor(entity, 0.))
+            return;
+
+    const Tree& tree = m_data->tree;
+    if (tree.empty())
+        return;
+
+    // incremental nearest neighbor query: results are ordered by the distance to boxes
+    const Point point = toPoint(coord);
+    for (auto it = tree.qbegin(bgi::nearest(point, static_cast<unsigned>(tree.size())));
+         it != tree.qend(); ++it) {
+        if (!visitor(it->second, bg::distance(point, it->first)))
+            return;
+    }
+}
+
+double LC_SpatialIndex::distanceToBox(const RS_Vector& coord, const RS_Entity& entity)
+{
+    if (!hasValidBox(entity))
+        return 0.;
+    return bg::distance(toPoint(coord), toBox(entity));
+}
+
+bool LC_SpatialIndex::hasValidBox(const RS_Entity& entity)
+{
+    // construction lines are of infinite length
+    if (entity.rtti() == RS2::EntityConstructionLine)
+        return false;
+    const RS_Vector vpMin = entity.getMin();
+    const RS_Vector vpMax = entity.getMax();
+    if (!(vpMin.valid && vpMax.valid))
+        return false;
+    if (!(std::isfinite(vpMin.x) && std::isfinite(vpMin.y)
+          && std::isfinite(vpMax.x) && std::isfinite(vpMax.y)))
+        return false;
+    // borders reset by resetBorders(), or corrupted
+    return vpMin.x <= vpMax.x && vpMin.y <= vpMax.y
+            && vpMin.x > RS_MINDOUBLE && vpMax.x < RS_MAXDOUBLE
+            && vpMin.y > RS_MINDOUBLE && vpMax.y < RS_MAXDOUBLE;
+}
@@ -0,0 +1,135 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_SPATIALINDEX_H
+#define LC_SPATIALINDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class RS_Entity;
+class RS_Vector;
+
+/**
+ * @brief The LC_SpatialIndex class, a bounding box R-tree of the direct children of an entity container.
+ *
+ * Entities are indexed by the borders (getMin()/getMax()) they had when they were inserted or last updated.
+ * The owner container is responsible for calling update() after the borders of an indexed entity change.
+ *
+ * Entities without a valid bounding box (empty containers, or unbounded entities like construction lines)
+ * are not stored in the tree; they are kept in a separate list and returned by every query, so callers
+ * always see a superset of the entities that could possibly match.
+ *
+ * Every entity also carries an order key, following its position in the container, so window queries
+ * can return entities in the drawing order without scanning the container.
+ */
+class LC_SpatialIndex {
+public:
+    LC_SpatialIndex();
+    ~LC_SpatialIndex();
+
+    LC_SpatialIndex(const LC_SpatialIndex&) = delete;
+    LC_SpatialIndex& operator = (const LC_SpatialIndex&) = delete;
+
+    /**
+     * @brief build - replace the index content by the given entities, using bulk loading
+     * @param entities - entities to index, in the container order
+     */
+    void build(const std::vector<RS_Entity*>& entities);
+
+    /**
+     * @brief insert - index an entity inserted into the container
+     * @param previous, next - the indexed neighbors of the entity in the container, nullptr at the ends
+     * @return false, if the neighbors are not indexed, or no order key is left between them;
+     * the index must be rebuilt in this case
+     */
+    bool insert(RS_Entity* entity, const RS_Entity* previous, const RS_Entity* next);
+    bool remove(RS_Entity* entity);
+    /**
+     * @brief reorder - give indexed entities new order keys, after they were moved together in the container
+     * @param moved - the moved entities, in their new container order
+     * @param previous, next - the indexed neighbors of the moved entities in the container, nullptr at the ends
+     * @return false, if an entity is not indexed, or no order keys are left between the neighbors;
+     * the index must be rebuilt in this case
+     */
+    bool reorder(const std::vector<RS_Entity*>& moved, const RS_Entity* previous, const RS_Entity* next);
+    /**
+     * @brief update - refresh the stored bounding box of an indexed entity
+     * @return true, if the entity is indexed
+     */
+    bool update(RS_Entity* entity);
+    bool contains(const RS_Entity* entity) const;
+    /**
+     * @brief isBefore - whether e0 comes before e1 in the container order
+     * @return false, if any of the entities is not indexed
+     */
+    bool isBefore(const RS_Entity* e0, const RS_Entity* e1) const;
+    void clear();
+    size_t size() const;
+
+    /**
+     * @brief queryWindow - find entities, whose bounding box overlaps with the window
+     * @param v1, v2 - two opposite corners of the window
+     * @return entities found in the container order, including all entities without a valid bounding box
+     */
+    std::vector<RS_Entity*> queryWindow(const RS_Vector& v1, const RS_Vector& v2) const;
+
+    /**
+     * @brief queryNearest - find the k entities, whose bounding boxes are the closest to a point,
+     * ordered by the bounding box distance
+     * @param coord - the point
+     * @param k - the maximum number of entities
+     * @return entities found, not including entities without a valid bounding box
+     */
+    std::vector<RS_Entity*> queryNearest(const RS_Vector& coord, size_t k) const;
+
+    /**
+     * @brief visitNearest - visit entities in the increasing order of the distance from a point to their
+     * bounding boxes. Entities without a valid bounding box are visited first, with a distance of 0.
+     * This allows branch and bound searches: the distance to the bounding box is a lower bound of
+     * the distance to the entity.
+     * @param coord - the point
+     * @param visitor - called with an entity and its bounding box distance. Returns false to stop
+     */
+    void visitNearest(const RS_Vector& coord,
+                      const std::function<bool(RS_Entity*, double)>& visitor) const;
+
+    /**
+     * @brief distanceToBox - the distance from a point to the bounding box of an entity
+     * @return 0, if the point is inside the box, or the entity has no valid bounding box
+     */
+    static double distanceToBox(const RS_Vector& coord, const RS_Entity& entity);
+
+    /**
+     * @brief hasValidBox - whether the entity has a bounded and valid bounding box
+     */
+    static bool hasValidBox(const RS_Entity& entity);
+
+private:
+    struct Data;
+    std::unique_ptr<Data> m_data;
+};
+
+#endif // LC_SPATIALINDEX_H
@@ -21,6 +21,9 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 **********************************************************************/
 
+#include <algorithm>
+#include <cmath>
+
 #include <QPainterPath>
 #include <QPolygonF>
 #include "lc_splinepoints.h"
@@ -381,54 +384,112 @@ bool SetNewDist(bool bResSet, double dNewDist, double dNewT,
 	return bRes;
 }
 
-double GetDistToQuadSquared(const RS_Vector& coord, const RS_Vector& x1,
-	const RS_Vector& c1, const RS_Vector& x2, double* dist)
+// real roots of x^2 + b x + c = 0, as RS_Math::quadraticSolver(), without allocating
+int GetQuadraticRoots(double b, double c, double* roots)
 {
-	double a1, a2, a3, a4;
-	a1 = (x2.x - 2.0*c1.x + x1.x)*(x2.x - 2.0*c1.x + x1.x) +
-		(x2.y - 2.0*c1.y + x1.y)*(x2.y - 2.0*c1.y + x1.y);
-	a2 = 3.0*((c1.x - x1.x)*(x2.x - 2.0*c1.x + x1.x) +
-		(c1.y - x1.y)*(x2.y - 2.0*c1.y + x1.y));
-	a3 = 2.0*(c1.x - x1.x)*(c1.x - x1.x) +
-		(x1.x - coord.x)*(x2.x - 2.0*c1.x + x1.x) +
-		2.0*(c1.y - x1.y)*(c1.y - x1.y) +
-		(x1.y - coord.y)*(x2.y - 2.0*c1.y + x1.y);
-	a4 = (x1.x - coord.x)*(c1.x - x1.x) + (x1.y - coord.y)*(c1.y - x1.y);
+	const double h = -0.5*b;
+	const double discriminant = h*h - c;
+	if(discriminant < 0.0) return 0;
 
-	std::vector<double> dCoefs(0, 0.);
-	std::vector<double> dSol(0, 0.);
+	const double r = std::sqrt(discriminant);
+	if(r <= 1.0e-24*std::abs(h))
+	{
+		roots[0] = h;
+		return 1;
+	}
+	// avoid the loss of significance of (h - r), Vieta's formulas for the second root
+	roots[0] = h >= 0.0 ? h + r : h - r;
+	roots[1] = c/roots[0];
+	return 2;
+}
 
-    if(std::abs(a1) > RS_TOLERANCE) // solve as cubic
+// real roots of x^3 + b x^2 + c x + d = 0, without allocating
+int GetCubicRoots(double b, double c, double d, double* roots)
+{
+	// depressed cubic t^3 + p t + q = 0, with x = t - b/3
+	const double shift = b/3.0;
+	const double p = c - shift*b;
+	const double q = b*((2.0/27.0)*b*b - c/3.0) + d;
+
+	int count = 0;
+	if(std::abs(p) < 1.0e-75)
 	{
-		dCoefs.push_back(a2/a1);
-		dCoefs.push_back(a3/a1);
-		dCoefs.push_back(a4/a1);
-		dSol = RS_Math::cubicSolver(dCoefs);
+		roots[count++] = std::cbrt(-q) - shift;
 	}
-    else if(std::abs(a2) > RS_TOLERANCE) // solve as quadratic
+	else
 	{
-		dCoefs.push_back(a3/a2);
-		dCoefs.push_back(a4/a2);
-		dSol = RS_Math::quadraticSolver(dCoefs);
+		const double discriminant = p*p*p/27.0 + 0.25*q*q;
+		if(discriminant > 0.0)
+		{
+			// one real root, by Cardano's method
+			const double sq = std::sqrt(discriminant);
+			const double u = std::cbrt(q > 0.0 ? -0.5*q - sq : -0.5*q + sq);
+			roots[count++] = u - p/(3.0*u) - shift;
+		}
+		else
+		{
+			// three real roots, by Viete's trigonometric method
+			const double m = 2.0*std::sqrt(-p/3.0);
+			const double theta = std::acos(std::max(-1.0, std::min(1.0, 3.0*q/(p*m))))/3.0;
+			for(int k = 0; k < 3; ++k)
+				roots[count++] = m*std::cos(theta - 2.0*M_PI*k/3.0) - shift;
+		}
+	}
+
+	// one Newton step against rounding in the closed forms
+	for(int i = 0; i < count; ++i)
+	{
+		const double x = roots[i];
+		const double f = ((x + b)*x + c)*x + d;
+		const double df = (3.0*x + 2.0*b)*x + c;
+		if(std::abs(df) > RS_TOLERANCE) roots[i] = x - f/df;
 	}
-    else if(std::abs(a3) > RS_TOLERANCE) // solve as linear
+	return count;
+}
+
+// roots of a1 t^3 + a2 t^2 + a3 t + a4 = 0, falling back to lower orders for vanishing leading terms
+int GetNearestQuadRoots(double a1, double a2, double a3, double a4, double* roots)
+{
+	if(std::abs(a1) > RS_TOLERANCE) // solve as cubic
+		return GetCubicRoots(a2/a1, a3/a1, a4/a1, roots);
+	if(std::abs(a2) > RS_TOLERANCE) // solve as quadratic
+		return GetQuadraticRoots(a3/a2, a4/a2, roots);
+	if(std::abs(a3) > RS_TOLERANCE) // solve as linear
 	{
-		dSol.push_back(-a4/a3);
+		roots[0] = -a4/a3;
+		return 1;
 	}
-	else return -1.0;
+	return 0;
+}
+
+// the nearest point of the quad x(t) = x1 + 2 b t + a t^2, where c3, c2 and c1 are
+// a.a, 3 a.b and 2 b.b
+double GetNearestQuadParameter(const RS_Vector& coord, const RS_Vector& x1,
+	const RS_Vector& a, const RS_Vector& b, double c3, double c2, double c1,
+	const RS_Vector& x2, double* dist)
+{
+	// the derivative of the squared distance vanishes at the nearest point:
+	// c3 t^3 + c2 t^2 + (c1 + a.d) t + b.d = 0
+	const RS_Vector d = x1 - coord;
+	double dSol[3];
+	const int iSol = GetNearestQuadRoots(c3, c2, c1 + a.dotP(d), b.dotP(d), dSol);
 
 	bool bResSet = false;
 	double dDist = 0., dNewDist;
-	double dRes;
-	for(const double& dSolValue: dSol)
-	{
-		dNewDist = GetDistToQuadAtPointSquared(coord, x1, c1, x2, dSolValue);
-		SetNewDist(bResSet, dNewDist, dSolValue, &dDist, &dRes);
+	double dRes = 0.;
+	for(int i = 0; i < iSol; ++i)
+	{
+		const double dt = dSol[i];
+		// the endpoints are tested below
+		if(dt < RS_TOLERANCE || dt > 1.0 - RS_TOLERANCE) continue;
+		dNewDist = (d + (b*2.0 + a*dt)*dt).squared();
+		SetNewDist(bResSet, dNewDist, dt, &dDist, &dRes);
 		bResSet = true;
 	}
 
-	dNewDist = (coord - x1).squared();
+	dNewDist = d.squared();
 	SetNewDist(bResSet, dNewDist, 0.0, &dDist, &dRes);
+	bResSet = true;
 
 	dNewDist = (coord - x2).squared();
 	SetNewDist(bResSet, dNewDist, 1.0, &dDist, &dRes);
@@ -438,6 +499,30 @@ double GetDistToQuadSquared(const RS_Vector& coord, const RS_Vector& x1,
 	return dRes;
 }
 
+double GetDistToQuadSquared(const RS_Vector& coord, const RS_Vector& x1,
+	const RS_Vector& c1, const RS_Vector& x2, double* dist)
+{
+	const RS_Vector a = x2 - c1*2.0 + x1;
+	const RS_Vector b = c1 - x1;
+	return GetNearestQuadParameter(coord, x1, a, b, a.squared(), 3.0*a.dotP(b),
+		2.0*b.squared(), x2, dist);
+}
+
+// squared distance from coord to the rectangle, zero inside
+double GetDistToBoxSquared(const RS_Vector& coord, const RS_Vector& minP, const RS_Vector& maxP)
+{
+	const double dx = std::max({minP.x - coord.x, 0.0, coord.x - maxP.x});
+	const double dy = std::max({minP.y - coord.y, 0.0, coord.y - maxP.y});
+	return dx*dx + dy*dy;
+}
+
+bool BoxesOverlap(const RS_Vector& min0, const RS_Vector& max0,
+	const RS_Vector& min1, const RS_Vector& max1)
+{
+	return min0.x <= max1.x + RS_TOLERANCE && min1.x <= max0.x + RS_TOLERANCE &&
+		min0.y <= max1.y + RS_TOLERANCE && min1.y <= max0.y + RS_TOLERANCE;
+}
+
 RS_Vector GetNearestMiddleLine(const RS_Vector& x1, const RS_Vector& x2,
 	const RS_Vector& coord, double* dist, int middlePoints)
 {
@@ -515,26 +600,23 @@ void addLineQuadIntersect(RS_VectorSolutions *pVS,
 	double a2 = 2.0*(x2.x*x4.y - x2.y*x4.x);
 	double a3 = x3.x*x4.y - x3.y*x4.x;
 
-	std::vector<double> dSol(0, 0.);
+	double dSol[2];
+	int iSol = 0;
 
     if(std::abs(a1) > RS_TOLERANCE)
 	{
-		std::vector<double> dCoefs(0, 0.);
-
-		dCoefs.push_back(a2/a1);
-		dCoefs.push_back(a3/a1);
-		dSol = RS_Math::quadraticSolver(dCoefs);
-
+		iSol = GetQuadraticRoots(a2/a1, a3/a1, dSol);
 	}
     else if(std::abs(a2) > RS_TOLERANCE)
 	{
-		dSol.push_back(-a3/a2);
+		dSol[iSol++] = -a3/a2;
 	}
 
 	double ds;
 
-	for(double& d: dSol)
+	for(int i = 0; i < iSol; ++i)
 	{
+		double d = dSol[i];
 		if(d > -RS_TOLERANCE && d < 1.0 + RS_TOLERANCE)
 		{
 			if(d < 0.0) d = 0.0;
@@ -573,7 +655,8 @@ LC_SplinePoints::LC_SplinePoints(RS_EntityContainer* parent,
 	RS_AtomicEntity(parent)
   ,data(d)
 {
-	calculateBorders();
+	// control points are needed to draw
+	update();
 }
 
 RS_Entity* LC_SplinePoints::clone() const
@@ -621,12 +704,40 @@ void LC_SplinePoints::UpdateQuadExtent(const RS_Vector& x1, const RS_Vector& c1,
 
     minV = RS_Vector::minimum(locMinV, minV);
     maxV = RS_Vector::maximum(locMaxV, maxV);
+
+	QuadSegment quad;
+	quad.start = x1;
+	quad.control = c1;
+	quad.end = x2;
+	quad.a = vDer;
+	quad.b = c1 - x1;
+	quad.c3 = quad.a.squared();
+	quad.c2 = 3.0*quad.a.dotP(quad.b);
+	quad.c1 = 2.0*quad.b.squared();
+	quad.minP = locMinV;
+	quad.maxP = locMaxV;
+	m_quads.push_back(quad);
+}
+
+double LC_SplinePoints::QuadSegment::nearestParameter(const RS_Vector& coord, double* distSquared) const
+{
+	return GetNearestQuadParameter(coord, start, a, b, c3, c2, c1, end, distSquared);
+}
+
+// whether the cached segments match the control points
+bool LC_SplinePoints::hasQuadSegments() const
+{
+	const size_t n = data.controlPoints.size();
+	if(n < 3) return false;
+	return m_quads.size() == (data.closed ? n : n - 2);
 }
 
 void LC_SplinePoints::calculateBorders()
 {
+	touch();
 	minV = RS_Vector(false);
 	maxV = RS_Vector(false);
+	m_quads.clear();
 
 	size_t const n = data.controlPoints.size();
 	if(n < 1) return;
@@ -824,6 +935,26 @@ int LC_SplinePoints::GetQuadPoints(int iSeg, RS_Vector *pvStart, RS_Vector *pvCo
 int LC_SplinePoints::GetNearestQuad(const RS_Vector& coord,
 	double* dist, double* dt) const
 {
+	if(hasQuadSegments())
+	{
+		double dDist = RS_MAXDOUBLE, dNewDist = 0.;
+		double dRes = 0.;
+		int iRes = -1;
+		for(size_t i = 0; i < m_quads.size(); ++i)
+		{
+			const QuadSegment& quad = m_quads[i];
+			// no point of the segment is nearer than its extent
+			if(GetDistToBoxSquared(coord, quad.minP, quad.maxP) >= dDist) continue;
+
+			const double dNewRes = quad.nearestParameter(coord, &dNewDist);
+			if(SetNewDist(true, dNewDist, dNewRes, &dDist, &dRes)) iRes = i + 1;
+		}
+
+		*dt = dRes;
+		if(dist) *dist = std::sqrt(dDist);
+		return iRes;
+	}
+
 	size_t n = data.controlPoints.size();
 
 	RS_Vector vStart(false), vControl(false), vEnd(false), vRes(false);
@@ -1922,8 +2053,6 @@ void LC_SplinePoints::draw(RS_Painter* painter, RS_GraphicView* view, double& pa
     if(painter == nullptr || view == nullptr)
         return;
 
-    update();
-
     // Adjust dash offset
     updateDashOffset(*painter, *view, patternOffset);
 
@@ -3070,6 +3199,18 @@ RS_VectorSolutions LC_SplinePoints::getLineIntersect(const RS_Vector& x1, const
 {
 	RS_VectorSolutions ret;
 
+	if(hasQuadSegments())
+	{
+		const RS_Vector vMin = RS_Vector::minimum(x1, x2);
+		const RS_Vector vMax = RS_Vector::maximum(x1, x2);
+		for(const QuadSegment& quad: m_quads)
+		{
+			if(BoxesOverlap(quad.minP, quad.maxP, vMin, vMax))
+				addLineQuadIntersect(&ret, x1, x2, quad.start, quad.control, quad.end);
+		}
+		return ret;
+	}
+
 	size_t n = data.controlPoints.size();
 	if(n < 2) return ret;
 
@@ -3217,6 +3358,19 @@ void addQuadQuadIntersect(RS_VectorSolutions *pVS,
 void LC_SplinePoints::addQuadIntersect(RS_VectorSolutions *pVS, const RS_Vector& x1,
 	const RS_Vector& c1, const RS_Vector& x2)
 {
+	if(hasQuadSegments())
+	{
+		// the quad is within the hull of its control points
+		const RS_Vector vMin = RS_Vector::minimum(RS_Vector::minimum(x1, c1), x2);
+		const RS_Vector vMax = RS_Vector::maximum(RS_Vector::maximum(x1, c1), x2);
+		for(const QuadSegment& quad: m_quads)
+		{
+			if(BoxesOverlap(quad.minP, quad.maxP, vMin, vMax))
+				addQuadQuadIntersect(pVS, quad.start, quad.control, quad.end, x1, c1, x2);
+		}
+		return;
+	}
+
 	size_t n = data.controlPoints.size();
 	if(n < 2) return;
 
@@ -3290,6 +3444,16 @@ RS_VectorSolutions LC_SplinePoints::getSplinePointsIntersect(LC_SplinePoints* l1
 {
 	RS_VectorSolutions ret;
 
+	if(hasQuadSegments())
+	{
+		for(const QuadSegment& quad: m_quads)
+		{
+			if(BoxesOverlap(quad.minP, quad.maxP, l1->getMin(), l1->getMax()))
+				l1->addQuadIntersect(&ret, quad.start, quad.control, quad.end);
+		}
+		return ret;
+	}
+
 	size_t n = data.controlPoints.size();
 	if(n < 2) return ret;
 
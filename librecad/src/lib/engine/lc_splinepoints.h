@@ -82,6 +82,23 @@ private:
     LC_SplinePointsData mapDataToGui(RS_GraphicView& view) const;
 	void UpdateControlPoints();
 	void UpdateQuadExtent(const RS_Vector& x1, const RS_Vector& c1, const RS_Vector& x2);
+
+	/**
+	 * @brief QuadSegment - a quadratic segment x(t) = start + 2*b*t + a*t^2, with the
+	 * parts of its nearest point equation, which do not depend on the query point
+	 */
+	struct QuadSegment {
+		RS_Vector start, control, end;
+		RS_Vector a, b;
+		// coefficients of t^3 and t^2, and the coordinate free part of t
+		double c3 = 0., c2 = 0., c1 = 0.;
+		// extent of the segment itself
+		RS_Vector minP, maxP;
+		double nearestParameter(const RS_Vector& coord, double* distSquared) const;
+	};
+	// segments of the control points, rebuilt by calculateBorders()
+	std::vector<QuadSegment> m_quads;
+	bool hasQuadSegments() const;
 	int GetNearestQuad(const RS_Vector& coord, double* dist, double* dt) const;
 	RS_Vector GetSplinePointAtDist(double dDist, int iStartSeg, double dStartT,
 		int *piSeg, double *pdt) const;
@@ -0,0 +1,225 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+
+#include "lc_textindex.h"
+#include "rs_block.h"
+#include "rs_dimension.h"
+#include "rs_information.h"
+#include "rs_insert.h"
+#include "rs_mtext.h"
+#include "rs_text.h"
+
+bool LC_TextIndex::Match::getBorders(RS_Vector& min, RS_Vector& max) const
+{
+    if (entity == nullptr)
+        return false;
+    if (block == nullptr) {
+        min = entity->getMin();
+        max = entity->getMax();
+        return min.valid && max.valid;
+    }
+    if (inserts.empty())
+        return false;
+    // copies in inserts share the id of the block entity
+    const RS_Insert* insert = inserts.front();
+    const RS_Entity* copy = insert->findEntityById(entity->getId());
+    const RS_Entity* shown = copy != nullptr ? copy : insert;
+    min = shown->getMin();
+    max = shown->getMax();
+    return min.valid && max.valid;
+}
+
+bool LC_TextIndex::isText(const RS_Entity* entity)
+{
+    if (entity == nullptr)
+        return false;
+    switch (entity->rtti()) {
+    case RS2::EntityText:
+    case RS2::EntityMText:
+        return true;
+    default:
+        return RS_Information::isDimension(entity->rtti());
+    }
+}
+
+QString LC_TextIndex::getText(RS_Entity* entity)
+{
+    if (entity == nullptr)
+        return {};
+    switch (entity->rtti()) {
+    case RS2::EntityText:
+        return static_cast<RS_Text*>(entity)->getText();
+    case RS2::EntityMText:
+        // paragraph breaks left in the text by the filters
+        return static_cast<RS_MText*>(entity)->getText().replace("\\P", "\n");
+    default:
+        if (RS_Information::isDimension(entity->rtti()))
+            return static_cast<RS_Dimension*>(entity)->getLabel();
+        return {};
+    }
+}
+
+QStringList LC_TextIndex::getWords(const QString& text)
+{
+    QStringList words;
+    const QString lower = text.toLower();
+    int start = -1;
+    for (int i = 0; i <= lower.size(); ++i) {
+        const bool letter = i < lower.size() && lower.at(i).isLetterOrNumber();
+        if (letter && start < 0) {
+            start = i;
+        } else if (!letter && start >= 0) {
+            words << lower.mid(start, i - start);
+            start = -1;
+        }
+    }
+    words.removeDuplicates();
+    return words;
+}
+
+void LC_TextIndex::insert(RS_Entity* entity)
+{
+    if (!isText(entity))
+        return;
+    remove(entity);
+    Entry& entry = m_entries[entity];
+    entry.order = m_nextOrder++;
+    entry.words = getWords(getText(entity));
+    for (const QString& word: entry.words)
+        m_postings[word].insert(entity);
+}
+
+void LC_TextIndex::remove(RS_Entity* entity)
+{
+    auto it = m_entries.find(entity);
+    if (it == m_entries.end())
+        return;
+    for (const QString& word: it->second.words) {
+        auto posting = m_postings.find(word);
+        if (posting == m_postings.end())
+            continue;
+        posting->second.erase(entity);
+        if (posting->second.empty())
+            m_postings.erase(posting);
+    }
+    m_entries.erase(it);
+}
+
+void LC_TextIndex::clear()
+{
+    m_postings.clear();
+    m_entries.clear();
+    m_nextOrder = 0;
+}
+
+std::size_t LC_TextIndex::size() const
+{
+    return m_entries.size();
+}
+
+void LC_TextIndex::lookup(const QString& word, bool wordStart, bool wordEnd,
+                          std::unordered_set<RS_Entity*>& candidates) const
+{
+    const auto add = [&candidates](const std::unordered_set<RS_Entity*>& entities) {
+        candidates.insert(entities.cbegin(), entities.cend());
+    };
+    if (wordStart && wordEnd) {
+        auto it = m_postings.find(word);
+        if (it != m_postings.cend())
+            add(it->second);
+    } else if (wordStart) {
+        // the words starting with the word are sorted after it
+        for (auto it = m_postings.lower_bound(word);
+             it != m_postings.cend() && it->first.startsWith(word); ++it)
+            add(it->second);
+    } else {
+        // parts of words, the distinct words are still far fewer than the texts
+        for (const auto& [key, entities]: m_postings) {
+            if (wordEnd ? key.endsWith(word) : key.contains(word))
+                add(entities);
+        }
+    }
+}
+
+std::vector<RS_Entity*> LC_TextIndex::find(const QString& text, Qt::CaseSensitivity cs) const
+{
+    std::vector<RS_Entity*> found;
+    if (text.isEmpty())
+        return found;
+
+    // the words of the searched text, and whether they're whole words at its start or end
+    struct Word {
+        QString word;
+        bool wordStart = false;
+        bool wordEnd = false;
+    };
+    std::vector<Word> words;
+    const QString lower = text.toLower();
+    int start = -1;
+    for (int i = 0; i <= lower.size(); ++i) {
+        const bool letter = i < lower.size() && lower.at(i).isLetterOrNumber();
+        if (letter && start < 0) {
+            start = i;
+        } else if (!letter && start >= 0) {
+            words.push_back({lower.mid(start, i - start), start > 0, i < lower.size()});
+            start = -1;
+        }
+    }
+    // the narrowest lookups first
+    std::stable_sort(words.begin(), words.end(), [](const Word& a, const Word& b) {
+        return (a.wordStart ? 0 : 2) + (a.wordEnd ? 0 : 1) < (b.wordStart ? 0 : 2) + (b.wordEnd ? 0 : 1);
+    });
+
+    std::unordered_set<RS_Entity*> candidates;
+    if (words.empty()) {
+        for (const auto& entry: m_entries)
+            candidates.insert(entry.first);
+    }
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        std::unordered_set<RS_Entity*> matching;
+        lookup(words[i].word, words[i].wordStart, words[i].wordEnd, matching);
+        if (i > 0) {
+            for (auto it = candidates.begin(); it != candidates.end();) {
+                if (matching.count(*it) == 0)
+                    it = candidates.erase(it);
+                else
+                    ++it;
+            }
+        } else {
+            candidates = std::move(matching);
+        }
+        if (candidates.empty())
+            return found;
+    }
+
+    for (RS_Entity* entity: candidates) {
+        if (getText(entity).contains(text, cs))
+            found.push_back(entity);
+    }
+    std::sort(found.begin(), found.end(), [this](RS_Entity* a, RS_Entity* b) {
+        return m_entries.at(a).order < m_entries.at(b).order;
+    });
+    return found;
+}
@@ -0,0 +1,114 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_TEXTINDEX_H
+#define LC_TEXTINDEX_H
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+class RS_Block;
+class RS_Entity;
+class RS_Insert;
+class RS_Vector;
+
+/**
+ * @brief The LC_TextIndex class, an inverted index of the words of the texts, multi line texts
+ * and dimension labels of a container. Searching a string looks up the entities containing its
+ * words, and compares the text of those candidates only, instead of decoding every text entity.
+ * Words are compared in lower case, so the index serves case sensitive searches as well.
+ */
+class LC_TextIndex {
+public:
+    /**
+     * @brief The Match struct, a text found in the drawing, or in a block definition
+     * with the inserts showing the block
+     */
+    struct Match {
+        RS_Entity* entity = nullptr;
+        // the block holding the entity, nullptr for entities of the drawing
+        RS_Block* block = nullptr;
+        std::vector<RS_Insert*> inserts;
+
+        /**
+         * @brief getBorders - the area to show the match, the entity, or its copy in the
+         * first insert for texts in blocks
+         * @return false, if the match isn't shown anywhere
+         */
+        bool getBorders(RS_Vector& min, RS_Vector& max) const;
+    };
+
+    /**
+     * @return true for the texts, multi line texts and dimensions
+     */
+    static bool isText(const RS_Entity* entity);
+    /**
+     * @return the text shown by the entity, the label with the measurement for dimensions
+     */
+    static QString getText(RS_Entity* entity);
+
+    // adds the entity, or updates its words if it's indexed already
+    void insert(RS_Entity* entity);
+    void remove(RS_Entity* entity);
+    void clear();
+    std::size_t size() const;
+
+    /**
+     * @brief find - the indexed entities showing the text
+     * @return the entities, in the order they were indexed
+     */
+    std::vector<RS_Entity*> find(const QString& text, Qt::CaseSensitivity cs) const;
+
+private:
+    struct Entry {
+        std::size_t order = 0;
+        QStringList words;
+    };
+
+    static QStringList getWords(const QString& text);
+    // adds the entities with a word matching the given word to the candidates
+    void lookup(const QString& word, bool wordStart, bool wordEnd,
+                std::unordered_set<RS_Entity*>& candidates) const;
+
+    // the entities of each word
+    std::map<QString, std::unordered_set<RS_Entity*>> m_postings;
+    std::unordered_map<RS_Entity*, Entry> m_entries;
+    std::size_t m_nextOrder = 0;
+};
+
+/**
+ * @brief The LC_FindTextData struct, a text to find and its replacement
+ */
+struct LC_FindTextData {
+    QString text;
+    QString replacement;
+    Qt::CaseSensitivity cs = Qt::CaseInsensitive;
+};
+
+#endif // LC_TEXTINDEX_H
@@ -0,0 +1,71 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <map>
+
+#include "lc_transformchange.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+
+LC_TransformChange::LC_TransformChange(std::vector<RS_Entity*> entities, const RS_Vector& offset):
+    m_entities{std::move(entities)}
+    , m_offset{offset}
+{
+}
+
+std::unique_ptr<LC_TransformChange> LC_TransformChange::move(std::vector<RS_Entity*> entities,
+                                                             const RS_Vector& offset)
+{
+    return std::unique_ptr<LC_TransformChange>{new LC_TransformChange{std::move(entities), offset}};
+}
+
+void LC_TransformChange::apply()
+{
+    transform(false);
+}
+
+const std::vector<RS_Entity*>& LC_TransformChange::getEntities() const
+{
+    return m_entities;
+}
+
+void LC_TransformChange::undoStateChanged(bool undone)
+{
+    transform(undone);
+}
+
+void LC_TransformChange::transform(bool inverse)
+{
+    std::map<RS_EntityContainer*, std::vector<RS_Entity*>> changed;
+    for (RS_Entity* entity: m_entities) {
+        entity->move(inverse ? -m_offset : m_offset);
+        // the entities of inserts are created from their block, in the new place
+        if (entity->rtti() == RS2::EntityInsert)
+            entity->update();
+        if (entity->getParent() != nullptr)
+            changed[entity->getParent()].push_back(entity);
+    }
+    for (const auto& [container, entities]: changed)
+        container->childrenTransformed(entities);
+}
@@ -0,0 +1,73 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_TRANSFORMCHANGE_H
+#define LC_TRANSFORMCHANGE_H
+
+#include <memory>
+#include <vector>
+
+#include "rs_undoable.h"
+#include "rs_vector.h"
+
+class RS_Entity;
+
+/**
+ * @brief The LC_TransformChange class, an undoable move of entities, which are moved in place instead
+ * of being replaced by moved copies.
+ *
+ * The change keeps the entities and the offset only: undoing moves them back, redoing moves them again.
+ * Changes are owned by their undo cycle, see RS_Undo::addOwnedUndoable().
+ * Only moves are undone this way: moving back may round the coordinates once, but the rounded ones are
+ * restored by every later cycle. The inverse of a rotation or scaling adds rounding errors on each cycle,
+ * so those keep the original entities.
+ */
+class LC_TransformChange : public RS_Undoable {
+public:
+    static std::unique_ptr<LC_TransformChange> move(std::vector<RS_Entity*> entities, const RS_Vector& offset);
+
+    /**
+     * @brief apply - transforms the entities, when the change is made
+     */
+    void apply();
+    /**
+     * @return the transformed entities
+     */
+    const std::vector<RS_Entity*>& getEntities() const;
+
+    RS2::UndoableType undoRtti() const override
+    {
+        return RS2::UndoableTransform;
+    }
+    void undoStateChanged(bool undone) override;
+
+private:
+    LC_TransformChange(std::vector<RS_Entity*> entities, const RS_Vector& offset);
+    void transform(bool inverse);
+
+    std::vector<RS_Entity*> m_entities;
+    RS_Vector m_offset;
+};
+
+#endif // LC_TRANSFORMCHANGE_H
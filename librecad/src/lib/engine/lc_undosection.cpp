@@ -48,3 +48,17 @@ void LC_UndoSection::addUndoable(RS_Undoable *undoable)
         document->addUndoable( undoable);
     }
 }
+
+void LC_UndoSection::addOwnedUndoable(std::unique_ptr<RS_Undoable> undoable)
+{
+    if (valid) {
+        document->addOwnedUndoable( std::move(undoable));
+    }
+}
+
+void LC_UndoSection::addUndoables(const std::vector<RS_Entity*>& entities)
+{
+    if (valid) {
+        document->addUndoables( entities);
+    }
+}
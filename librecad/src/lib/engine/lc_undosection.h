@@ -26,7 +26,11 @@
 #ifndef LC_UNDOSECTION_H
 #define LC_UNDOSECTION_H
 
+#include <memory>
+#include <vector>
+
 class RS_Document;
+class RS_Entity;
 class RS_Undoable;
 
 /** \brief This class is a wrapper for RS_Undo methods
@@ -47,6 +51,8 @@ public:
     ~LC_UndoSection();
 
     void addUndoable(RS_Undoable * undoable);
+    void addUndoables(const std::vector<RS_Entity*>& entities);
+    void addOwnedUndoable(std::unique_ptr<RS_Undoable> undoable);
 
 private:
     RS_Document *document {nullptr};
@@ -0,0 +1,94 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <limits>
+
+#include <QFileInfo>
+
+#include "lc_blockdrawlist.h"
+#include "lc_xrefcache.h"
+#include "rs_block.h"
+#include "rs_debug.h"
+#include "rs_fileio.h"
+#include "rs_graphic.h"
+
+LC_XrefCache& LC_XrefCache::instance() {
+    // never destroyed, documents may outlive static objects
+    static LC_XrefCache* cache = new LC_XrefCache;
+    return *cache;
+}
+
+std::shared_ptr<RS_Graphic> LC_XrefCache::drawing(const QString& fileName) {
+    const QFileInfo fileInfo(fileName);
+    if (!fileInfo.exists())
+        return {};
+    const QString path = fileInfo.canonicalFilePath();
+    const QDateTime modified = fileInfo.lastModified();
+
+    for (auto it = m_drawings.begin(); it != m_drawings.end();) {
+        if (it->drawing.expired())
+            it = m_drawings.erase(it);
+        else
+            ++it;
+    }
+    auto it = m_drawings.find(path);
+    if (it != m_drawings.end() && it->modified == modified)
+        return it->drawing.lock();
+
+    // nested references are loaded lazily, but may be updated by the import
+    if (m_opening.count(path) != 0)
+        return {};
+    m_opening.insert(path);
+    // imported without a journal, the drawing is not edited
+    auto drawing = std::make_shared<RS_Graphic>();
+    drawing->newDoc();
+    const bool opened = RS_FileIO::instance()->fileImport(*drawing, path, RS2::FormatUnknown);
+    drawing->setFilename(path);
+    m_opening.erase(path);
+    if (!opened) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "LC_XrefCache::drawing: Cannot open file: %s", path.toStdString().c_str());
+        return {};
+    }
+
+    // the blocks holding the previous drawing keep it, until they're reloaded
+    m_drawings.insert(path, {modified, drawing, nullptr, {}, false});
+    return drawing;
+}
+
+std::shared_ptr<const LC_BlockDrawList> LC_XrefCache::drawList(const RS_Block& block, const RS_Graphic& drawing) {
+    for (Entry& entry: m_drawings) {
+        if (entry.drawing.lock().get() != &drawing)
+            continue;
+        // compiled for the base point of the first block
+        if (!entry.compiled) {
+            entry.drawList = LC_BlockDrawList::compile(block, std::numeric_limits<unsigned>::max());
+            entry.basePoint = block.getBasePoint();
+            entry.compiled = true;
+        }
+        if (entry.basePoint == block.getBasePoint())
+            return entry.drawList;
+        break;
+    }
+    return LC_BlockDrawList::compile(block, std::numeric_limits<unsigned>::max());
+}
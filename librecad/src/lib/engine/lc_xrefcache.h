@@ -0,0 +1,79 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_XREFCACHE_H
+#define LC_XREFCACHE_H
+
+#include <memory>
+#include <set>
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+
+#include "rs_vector.h"
+
+class LC_BlockDrawList;
+class RS_Block;
+class RS_Graphic;
+
+/**
+ * @brief The LC_XrefCache class, the drawings referenced by the external reference blocks
+ * of all documents. A drawing is read once while blocks reference it, by path, and read
+ * again when the file was modified since. The blocks share the entities of the drawing,
+ * and the geometry compiled for drawing their inserts.
+ */
+class LC_XrefCache {
+public:
+    static LC_XrefCache& instance();
+
+    /**
+     * @return the drawing of the file, nullptr if it can't be opened, or is being opened
+     * by a reference to itself. The drawing is shared: it's not to be changed.
+     */
+    std::shared_ptr<RS_Graphic> drawing(const QString& fileName);
+
+    /**
+     * @return the geometry of the drawing compiled for the inserts of the block,
+     * shared by the blocks of the same base point
+     */
+    std::shared_ptr<const LC_BlockDrawList> drawList(const RS_Block& block, const RS_Graphic& drawing);
+
+private:
+    LC_XrefCache() = default;
+
+    struct Entry {
+        QDateTime modified;
+        std::weak_ptr<RS_Graphic> drawing;
+        std::shared_ptr<const LC_BlockDrawList> drawList;
+        RS_Vector basePoint;
+        bool compiled = false;
+    };
+
+    // by canonical path
+    QHash<QString, Entry> m_drawings;
+    // the files being opened
+    std::set<QString> m_opening;
+};
+
+#endif // LC_XREFCACHE_H
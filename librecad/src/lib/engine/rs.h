@@ -107,13 +107,15 @@ namespace RS2 {
         FormatDXFRW2000,           /**< DXF format. v2000. */
         FormatDXFRW14,           /**< DXF format. v14. */
         FormatDXFRW12,           /**< DXF format. v12. */
+        FormatDXFRWBinary,           /**< DXF format. v2007, binary. */
 #ifdef DWGSUPPORT
         FormatDWG,           /**< DWG format. */
 #endif
         FormatLFF,           /**< LibreCAD Font File format. */
         FormatCXF,           /**< CAM Expert Font format. */
         FormatJWW,           /**< JWW Format type */
-        FormatJWC            /**< JWC Format type */
+        FormatJWC,           /**< JWC Format type */
+        FormatSnapshot       /**< LibreCAD binary snapshot, cache of drawings */
     };
 
     /*
@@ -193,6 +195,7 @@ namespace RS2 {
         ActionEditCopy,
         ActionEditCopyNoSelect,
         ActionEditPaste,
+        ActionEditFindText,
         ActionOrderNoSelect,
         ActionOrderBottom,
         ActionOrderLower,
@@ -389,6 +392,7 @@ namespace RS2 {
         ActionInfoArea,
         ActionInfoProperties,
         ActionInfoPickCoordinates,
+        ActionInfoMemoryUsage,
 
         ActionLayersDefreezeAll,
         ActionLayersFreezeAll,
@@ -478,7 +482,9 @@ namespace RS2 {
     enum UndoableType {
         UndoableUnknown,    /**< Unknown undoable */
         UndoableEntity,     /**< Entity */
-        UndoableLayer       /**< Layer */
+        UndoableLayer,      /**< Layer */
+        UndoableAttributes, /**< Attributes of entities changed in place */
+        UndoableTransform   /**< Entities transformed in place */
     };
 
     /**
@@ -977,6 +983,13 @@ namespace RS2 {
                 RedrawGrid = 1,
                 RedrawOverlay = 2,
                 RedrawDrawing = 4,
+                // compose the drawing from cached tiles, only missing tiles are rendered
+                RedrawTiles = 8,
+                // the selected and highlighted entities, drawn on top of the drawing
+                RedrawSelection = 16,
+                // render the tiles left missing by the time budget of the last frame
+                RedrawRemainingTiles = 32,
+                RedrawPan = RedrawGrid | RedrawOverlay | RedrawTiles,
                 RedrawAll = 0xffff
         };
 
@@ -36,6 +36,7 @@
 #include "lc_quadratic.h"
 #include "rs_painterqt.h"
 #include "rs_debug.h"
+#include "lc_entitypool.h"
 #include "lc_rect.h"
 
 #ifdef EMU_C99
@@ -90,6 +91,14 @@ RS_Entity* RS_Arc::clone() const {
 	return a;
 }
 
+void* RS_Arc::operator new(size_t size) {
+    return LC_EntityPool::forType<RS_Arc>().allocate(size);
+}
+
+void RS_Arc::operator delete(void* p, size_t size) {
+    LC_EntityPool::forType<RS_Arc>().deallocate(p, size);
+}
+
 /**
  * Creates this arc from 3 given points which define the arc line.
  *
@@ -241,6 +250,7 @@ bool RS_Arc::createFrom2PBulge(const RS_Vector& startPoint, const RS_Vector& end
 }
 
 void RS_Arc::calculateBorders() {
+	touch();
 	RS_Vector const startpoint = data.center + RS_Vector::polar(data.radius, data.angle1);
 	RS_Vector const endpoint = data.center + RS_Vector::polar(data.radius, data.angle2);
 	LC_Rect const rect{startpoint, endpoint};
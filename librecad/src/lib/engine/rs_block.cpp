@@ -24,12 +24,56 @@
 **
 **********************************************************************/
 
+#include<algorithm>
+#include<atomic>
 #include<iostream>
+#include<vector>
+
+#include <QDir>
+#include <QFileInfo>
+
 #include "rs_block.h"
 
+#include "lc_blockdrawlist.h"
+#include "lc_xrefcache.h"
+#include "rs_debug.h"
 #include "rs_graphic.h"
 #include "rs_insert.h"
 
+namespace {
+// the last revision given to a block, blocks are created by the threads reading a file
+std::atomic<unsigned long long> blockRevision{0};
+
+// the blocks visited by the current thread, to stop at recursive blocks, which are not valid
+class BlockVisit {
+public:
+    BlockVisit(std::vector<const RS_Block*>& visited, const RS_Block* block):
+        m_visited{visited}
+      , m_recursive{std::find(visited.cbegin(), visited.cend(), block) != visited.cend()}
+    {
+        if (!m_recursive)
+            m_visited.push_back(block);
+    }
+    ~BlockVisit() {
+        if (!m_recursive)
+            m_visited.pop_back();
+    }
+    BlockVisit(const BlockVisit&) = delete;
+    BlockVisit& operator=(const BlockVisit&) = delete;
+
+    bool isRecursive() const {
+        return m_recursive;
+    }
+
+private:
+    std::vector<const RS_Block*>& m_visited;
+    const bool m_recursive;
+};
+
+thread_local std::vector<const RS_Block*> revisionVisits;
+thread_local std::vector<const RS_Block*> drawListVisits;
+}
+
 RS_BlockData::RS_BlockData(const QString& _name,
 						   const RS_Vector& _basePoint,
 						   bool _frozen):
@@ -52,19 +96,70 @@ RS_Block::RS_Block(RS_EntityContainer* parent,
                    const RS_BlockData& d)
         : RS_Document(parent), data(d) {
 
-    pen = RS_Pen(RS_Color(128,128,128), RS2::Width01, RS2::SolidLine);
+    setPen(RS_Pen(RS_Color(128,128,128), RS2::Width01, RS2::SolidLine));
+    setChanged();
+    // the external drawing is read when the block is inserted
+    if (isXref())
+        setLoader([](RS_Block& block) { block.loadXref(); });
 }
 
 
 RS_Entity* RS_Block::clone() const {
+    // the copy of an external reference shares the drawing too, loading it again
+    if (isXref()) {
+        auto* blk = new RS_Block(getParent(), data);
+        blk->setPen(getPen(false));
+        return blk;
+    }
+    load();
     RS_Block* blk = new RS_Block(*this);
     blk->setOwner(isOwner());
     blk->detach();
     blk->initId();
+    blk->setChanged();
     return blk;
 }
 
 
+void RS_Block::addEntity(RS_Entity* entity) {
+    RS_Document::addEntity(entity);
+    setChanged();
+}
+
+
+bool RS_Block::removeEntity(RS_Entity* entity) {
+    setChanged();
+    return RS_Document::removeEntity(entity);
+}
+
+int RS_Block::removeEntities(const std::vector<RS_Entity*>& removed) {
+    setChanged();
+    return RS_Document::removeEntities(removed);
+}
+
+
+/**
+ * Undo and redo toggle the entities of the block.
+ */
+bool RS_Block::undo() {
+    setChanged();
+    return RS_Document::undo();
+}
+
+
+bool RS_Block::redo() {
+    setChanged();
+    return RS_Document::redo();
+}
+
+
+void RS_Block::endUndoCycle() {
+    if (hasUndoable())
+        setChanged();
+    RS_Document::endUndoCycle();
+}
+
+
 
 RS_LayerList* RS_Block::getLayerList() {
     RS_Graphic* g = getGraphic();
@@ -109,6 +204,8 @@ void RS_Block::setModified(bool m) {
         p->setModified(m);
     }
     modified = m;
+    if (m)
+        setChanged();
 }
 
 
@@ -158,6 +255,7 @@ bool RS_Block::isSelectedInBlockList() const {
 QStringList RS_Block::findNestedInsert(const QString& bName) {
 
     QStringList bnChain;
+    load();
 
     for (RS_Entity* e: entities) {
         if (e->rtti()==RS2::EntityInsert) {
@@ -187,6 +285,112 @@ QStringList RS_Block::findNestedInsert(const QString& bName) {
     return bnChain;
 }
 
+std::shared_ptr<const LC_BlockDrawList> RS_Block::getDrawList() const {
+    load();
+    // nested inserts are flattened into the draw list, it's compiled again when a nested block changed
+    const unsigned long long currentRevision = getContentRevision();
+    std::shared_ptr<const CompiledDrawList> compiled = std::atomic_load(&drawList);
+    if (compiled == nullptr || compiled->revision != currentRevision) {
+        const BlockVisit visit{drawListVisits, this};
+        if (visit.isRecursive())
+            return nullptr;
+        auto created = std::make_shared<CompiledDrawList>();
+        // the geometry of external drawings is shared like their entities, and not limited in size
+        created->drawList = (xrefDrawing != nullptr) ? LC_XrefCache::instance().drawList(*this, *xrefDrawing)
+                                                     : LC_BlockDrawList::compile(*this);
+        created->revision = currentRevision;
+        compiled = std::move(created);
+        std::atomic_store(&drawList, compiled);
+    }
+    return compiled->drawList;
+}
+
+void RS_Block::setLoader(std::function<void(RS_Block&)> blockLoader) {
+    loader = std::move(blockLoader);
+}
+
+void RS_Block::load() const {
+    if (!loader)
+        return;
+    // reset first, the loader may look up this block again
+    auto blockLoader = std::move(loader);
+    loader = nullptr;
+    // the deferred entities are part of the block, like the compiled drawList
+    blockLoader(const_cast<RS_Block&>(*this));
+}
+
+QString RS_Block::resolveXrefPath() const {
+    // paths of drawings saved on Windows
+    QString path = data.xrefPath;
+    path.replace('\\', '/');
+    if (!QFileInfo(path).isRelative())
+        return path;
+    // relative to the drawing of the reference
+    const RS_Graphic* graphic = getGraphic();
+    if (graphic == nullptr || graphic->getFilename().isEmpty())
+        return path;
+    return QFileInfo(graphic->getFilename()).absoluteDir().filePath(path);
+}
+
+void RS_Block::loadXref() {
+    xrefDrawing = LC_XrefCache::instance().drawing(resolveXrefPath());
+    if (xrefDrawing == nullptr) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Block::loadXref: %s: cannot load %s",
+                        data.name.toLatin1().data(), data.xrefPath.toLatin1().data());
+        return;
+    }
+    // the entities stay owned by the shared drawing, they are not copied
+    setOwner(false);
+    for (RS_Entity* e: *xrefDrawing) {
+        if (!e->isUndone())
+            RS_Document::addEntity(e);
+    }
+    setChanged();
+}
+
+bool RS_Block::reloadXref() {
+    if (!isXref() || !isLoaded())
+        return false;
+    if (LC_XrefCache::instance().drawing(resolveXrefPath()) == xrefDrawing)
+        return false;
+    clear();
+    xrefDrawing.reset();
+    setLoader([](RS_Block& block) { block.loadXref(); });
+    setChanged();
+    return true;
+}
+
+unsigned long long RS_Block::getContentRevision() const {
+    // read first, a block changed meanwhile computes the revision again on the next call
+    const unsigned long long lastRevision = blockRevision.load();
+    std::shared_ptr<const ContentRevision> cached = std::atomic_load(&contentRevision);
+    if (cached != nullptr && cached->checked == lastRevision)
+        return cached->revision;
+    const BlockVisit visit{revisionVisits, this};
+    if (visit.isRecursive())
+        return revision;
+
+    unsigned long long ret = revision;
+    for (RS_Entity* e: entities) {
+        if (e->rtti() != RS2::EntityInsert)
+            continue;
+        RS_Block* blk = static_cast<RS_Insert*>(e)->getBlockForInsert();
+        if (blk != nullptr)
+            ret = std::max(ret, blk->getContentRevision());
+    }
+
+    auto computed = std::make_shared<ContentRevision>();
+    computed->revision = ret;
+    computed->checked = lastRevision;
+    std::atomic_store(&contentRevision, std::shared_ptr<const ContentRevision>{std::move(computed)});
+    return ret;
+}
+
+void RS_Block::setChanged() {
+    revision = ++blockRevision;
+    std::atomic_store(&drawList, std::shared_ptr<const CompiledDrawList>{});
+}
+
 std::ostream& operator << (std::ostream& os, const RS_Block& b) {
     os << " name: " << b.getName().toLatin1().data() << "\n";
     os << " entities: " << (RS_EntityContainer&)b << "\n";
@@ -28,8 +28,14 @@
 #ifndef RS_BLOCK_H
 #define RS_BLOCK_H
 
+#include <functional>
+#include <memory>
+
 #include "rs_document.h"
 
+class LC_BlockDrawList;
+class RS_Graphic;
+
 /**
  * Holds the data that defines a block.
  */
@@ -53,6 +59,11 @@ struct RS_BlockData {
 	RS_Vector basePoint;
 
 	bool frozen {false};              //!< Frozen flag
+	/**
+	 * Path of the drawing referenced by an external reference block,
+	 * empty for the blocks defined in the drawing.
+	 */
+	QString xrefPath;
     mutable bool visibleInBlockList {true};   //!< Visible in block list
     mutable bool selectedInBlockList {false}; //!< selected in block list
 };
@@ -85,6 +96,14 @@ public:
 
     RS_Entity* clone() const override;
 
+    void addEntity(RS_Entity* entity) override;
+    bool removeEntity(RS_Entity* entity) override;
+    int removeEntities(const std::vector<RS_Entity*>& removed) override;
+
+    bool undo() override;
+    bool redo() override;
+    void endUndoCycle() override;
+
     /** @return RS2::EntityBlock */
     RS2::EntityType rtti() const override{
         return RS2::EntityBlock;
@@ -217,9 +236,85 @@ public:
      */
     QStringList findNestedInsert(const QString& bName);
 
+    /**
+     * @brief getDrawList - the geometry of the block compiled for drawing, shared by its inserts.
+     * It's compiled on the first call, and again after the block or one of its nested blocks changed.
+     * Loaded blocks may be compiled and read by several threads, like their content revision.
+     * @return nullptr, if the block can't be compiled
+     */
+    std::shared_ptr<const LC_BlockDrawList> getDrawList() const;
+
+    /**
+     * @brief getContentRevision - the revision of the block content, including the blocks of its nested
+     * inserts. Revisions are unique among all blocks, and increase whenever setChanged() is called for
+     * a block, so inserts can tell whether their entities are still up to date.
+     */
+    unsigned long long getContentRevision() const;
+    /**
+     * @brief setChanged - must be called after the entities of the block changed. Gives the block a new
+     * revision, and drops the compiled geometry
+     */
+    void setChanged();
+
+    /**
+     * @brief setLoader - defers creating the entities of the block until they're needed,
+     * e.g. for the blocks of an imported file, which might never be inserted.
+     * The loader is called once, by load(), and adds the entities to the block.
+     */
+    void setLoader(std::function<void(RS_Block&)> blockLoader);
+    /**
+     * @brief load - creates the deferred entities, does nothing if the block is loaded.
+     * Must be called before the entities of the block are iterated, inserts call it
+     * when they look up their block.
+     */
+    void load() const;
+    bool isLoaded() const {
+        return !loader;
+    }
+
+    /**
+     * @return true, if the entities of the block are those of an external drawing
+     */
+    bool isXref() const {
+        return !data.xrefPath.isEmpty();
+    }
+    QString getXrefPath() const {
+        return data.xrefPath;
+    }
+    /**
+     * @brief reloadXref - loads the entities of an external reference again on demand,
+     * if its drawing file was modified since they were loaded
+     * @return true, if the block changed
+     */
+    bool reloadXref();
+
 protected:
 	//! Block data
 	RS_BlockData data;
+
+private:
+    struct CompiledDrawList {
+        std::shared_ptr<const LC_BlockDrawList> drawList;
+        // revision including nested blocks, when the draw list was compiled
+        unsigned long long revision = 0;
+    };
+    struct ContentRevision {
+        // revision including nested blocks
+        unsigned long long revision = 0;
+        // the last revision given to any block, when it was computed
+        unsigned long long checked = 0;
+    };
+    // the caches are read by the threads updating inserts, they're loaded and stored atomically
+    mutable std::shared_ptr<const CompiledDrawList> drawList;
+    mutable std::shared_ptr<const ContentRevision> contentRevision;
+
+    unsigned long long revision = 0;
+    // creates the entities of a lazily imported block
+    mutable std::function<void(RS_Block&)> loader;
+    // the external drawing owning the entities of an external reference
+    std::shared_ptr<RS_Graphic> xrefDrawing;
+    void loadXref();
+    QString resolveXrefPath() const;
 };
 
 
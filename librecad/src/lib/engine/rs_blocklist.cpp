@@ -26,12 +26,15 @@
 
 #include <set>
 #include <iostream>
+#include <utility>
 #include <QString>
 #include <QRegularExpression>
 #include "rs_debug.h"
 #include "rs_blocklist.h"
 #include "rs_block.h"
 #include "rs_blocklistlistener.h"
+#include "rs_graphic.h"
+#include "rs_insert.h"
 
 /**
  * Constructor.
@@ -48,11 +51,21 @@ RS_BlockList::RS_BlockList(bool owner) {
 }
 
 
+RS_BlockList::~RS_BlockList() {
+    // the entities of the graphic are deleted after its block list
+    for (const QSet<RS_Insert*>& inserts: std::as_const(references)) {
+        for (RS_Insert* insert: inserts)
+            insert->reference.list = nullptr;
+    }
+}
+
+
 /**
  * Removes all blocks in the blocklist.
  */
 void RS_BlockList::clear() {
     blocks.clear();
+    blockIndex.clear();
 	activeBlock = nullptr;
 	setModified(true);
 }
@@ -74,6 +87,9 @@ void RS_BlockList::activate(const QString& name) {
  */
 void RS_BlockList::activate(RS_Block* block) {
     RS_DEBUG->print("RS_BlockList::activateBlock");
+    // the active block is edited, saved or inserted
+    if (block != nullptr)
+        block->load();
 	activeBlock = block;
 }
 
@@ -98,6 +114,7 @@ bool RS_BlockList::add(RS_Block* block, bool notify) {
     RS_Block* b = find(block->getName());
 	if (!b) {
         blocks.append(block);
+        blockIndex.insert(block->getName(), block);
 
         if (notify) {
             addNotification();
@@ -140,6 +157,8 @@ void RS_BlockList::remove(RS_Block* block) {
 
     // here the block is removed from the list but not deleted
     blocks.removeOne(block);
+    if (blockIndex.value(block->getName(), nullptr) == block)
+        blockIndex.remove(block->getName());
 
 	for(auto l: blockListListeners){
 		l->blockRemoved(block);
@@ -175,11 +194,17 @@ bool RS_BlockList::rename(RS_Block* block, const QString& name) {
 		if (!find(name)) {
 			QString oldName = block->getName();
 			block->setName(name);
+			if (blockIndex.value(oldName, nullptr) == block) {
+				blockIndex.remove(oldName);
+				blockIndex.insert(name, block);
+			}
 			setModified(true);
 
-			// when the renamed block is nested within other block, we need to rename its inserts as well
-			for(RS_Block* b: blocks) {
-				b->renameInserts(oldName, name);
+			// rename the inserts in the graphic, and the inserts nested within other blocks.
+			// Renamed inserts move to the references of the new name
+			const QSet<RS_Insert*> inserts = references.value(oldName);
+			for(RS_Insert* insert: inserts) {
+				insert->setName(name);
 			}
 
 			return true;
@@ -219,15 +244,67 @@ RS_Block* RS_BlockList::find(const QString& name) {
         RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): wrong name to find");
         return nullptr;
     }
-	// Todo : reduce this from O(N) to O(log(N)) complexity based on sorted list or hash
-	//DFS
-	for(RS_Block* b: blocks) {
-		if (b->getName()==name) {
-			return b;
+	RS_Block* block = blockIndex.value(name, nullptr);
+	if (block == nullptr)
+		RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
+	return block;
+}
+
+void RS_BlockList::addReference(RS_Insert* insert) {
+	references[insert->getName()].insert(insert);
+}
+
+void RS_BlockList::removeReference(RS_Insert* insert, const QString& name) {
+	auto it = references.find(name);
+	if (it == references.end())
+		return;
+	it->remove(insert);
+	if (it->isEmpty())
+		references.erase(it);
+}
+
+std::vector<RS_Insert*> RS_BlockList::getInserts(const QString& name) const {
+	std::vector<RS_Insert*> ret;
+	auto it = references.constFind(name);
+	if (it == references.cend())
+		return ret;
+	for (RS_Insert* insert: *it) {
+		if (insert->isUndone())
+			continue;
+		// skip previews, and the copies of the block entities created by inserts
+		RS_EntityContainer* parent = insert->getParent();
+		if (parent == nullptr)
+			continue;
+		if (parent->rtti() == RS2::EntityGraphic) {
+			if (static_cast<RS_Graphic*>(parent)->getBlockList() != this)
+				continue;
+		} else if (parent->rtti() == RS2::EntityBlock) {
+			auto* block = static_cast<RS_Block*>(parent);
+			if (blockIndex.value(block->getName(), nullptr) != block)
+				continue;
+		} else {
+			continue;
 		}
+		ret.push_back(insert);
+	}
+	return ret;
+}
+
+std::vector<RS_Block*> RS_BlockList::getNestingBlocks(const QString& name) const {
+	std::vector<RS_Block*> ret;
+	std::set<RS_Block*> found;
+	for (RS_Insert* insert: getInserts(name)) {
+		if (insert->getParent()->rtti() != RS2::EntityBlock)
+			continue;
+		auto* block = static_cast<RS_Block*>(insert->getParent());
+		if (found.insert(block).second)
+			ret.push_back(block);
 	}
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
-	return nullptr;
+	return ret;
+}
+
+bool RS_BlockList::isUsed(const QString& name) const {
+	return !getInserts(name).empty();
 }
 
 /**
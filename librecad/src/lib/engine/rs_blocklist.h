@@ -29,11 +29,16 @@
 #define RS_BLOCKLIST_H
 
 
+#include <vector>
+
+#include <QHash>
 #include <QList>
+#include <QSet>
 
 class QString;
 class RS_Block;
 class RS_BlockListListener;
+class RS_Insert;
 
 /**
  * List of blocks.
@@ -45,7 +50,7 @@ class RS_BlockListListener;
 class RS_BlockList {
 public:
     RS_BlockList(bool owner=false);
-	virtual ~RS_BlockList() = default;
+	virtual ~RS_BlockList();
 
     void clear();
     /**
@@ -81,6 +86,26 @@ public:
     void toggle(RS_Block* block);
     void freezeAll(bool freeze);
 
+    /**
+     * @brief addReference, removeReference - keep the graph of the inserts referencing the
+     * blocks of the list, called by the inserts when they are created, renamed or deleted
+     */
+    void addReference(RS_Insert* insert);
+    void removeReference(RS_Insert* insert, const QString& name);
+    /**
+     * @brief getInserts - where used query, without scanning the entities
+     * @return the inserts of the block in the graphic and in the blocks of the list, which are not undone
+     */
+    std::vector<RS_Insert*> getInserts(const QString& name) const;
+    /**
+     * @return the blocks of the list containing inserts of the given block
+     */
+    std::vector<RS_Block*> getNestingBlocks(const QString& name) const;
+    /**
+     * @return true, if the block is inserted in the graphic or in one of the blocks of the list
+     */
+    bool isUsed(const QString& name) const;
+
     void addListener(RS_BlockListListener* listener);
     void removeListener(RS_BlockListListener* listener);
 
@@ -105,6 +130,11 @@ private:
     bool owner = false;
     //! Blocks in the graphic
     QList<RS_Block*> blocks;
+    //! Blocks by name, block names are unique in the list
+    QHash<QString, RS_Block*> blockIndex;
+    //! Inserts referencing a block, by block name. Contains all inserts using the list,
+    //! including undone inserts and the copies created by inserts of nested blocks
+    QHash<QString, QSet<RS_Insert*>> references;
     //! List of registered BlockListListeners
     QList<RS_BlockListListener*> blockListListeners;
     //! Currently active block
@@ -29,6 +29,7 @@
 #include <cfloat>
 #include <QPolygonF>
 #include "rs_circle.h"
+#include "lc_entitypool.h"
 
 #include "rs_line.h"
 #include "rs_information.h"
@@ -81,8 +82,17 @@ RS_Entity* RS_Circle::clone() const {
 	return c;
 }
 
+void* RS_Circle::operator new(size_t size) {
+    return LC_EntityPool::forType<RS_Circle>().allocate(size);
+}
+
+void RS_Circle::operator delete(void* p, size_t size) {
+    LC_EntityPool::forType<RS_Circle>().deallocate(p, size);
+}
+
 
 void RS_Circle::calculateBorders() {
+    touch();
     RS_Vector r{data.radius, data.radius};
     minV = data.center - r;
     maxV = data.center + r;
@@ -62,6 +62,10 @@ public:
 
 	RS_Entity* clone() const override;
 
+	// allocated from a pool, see LC_EntityPool
+	static void* operator new(size_t size);
+	static void operator delete(void* p, size_t size);
+
     /**	@return RS2::EntityCircle */
 	RS2::EntityType rtti() const override{
         return RS2::EntityCircle;
@@ -64,6 +64,7 @@ RS_Entity* RS_ConstructionLine::clone() const {
 }
 
 void RS_ConstructionLine::calculateBorders() {
+    touch();
     minV = RS_Vector::minimum(data.point1, data.point2);
     maxV = RS_Vector::maximum(data.point1, data.point2);
 }
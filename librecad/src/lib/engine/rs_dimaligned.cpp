@@ -109,9 +109,7 @@ RS_VectorSolutions RS_DimAligned::getRefPoints() const
 QString RS_DimAligned::getMeasuredLabel() {
 	double dist = edata.extensionPoint1.distanceTo(edata.extensionPoint2) * getGeneralFactor();
 
-    RS_SETTINGS->beginGroup("/Appearance");
-    if (RS_SETTINGS->readNumEntry("/UnitlessGrid", 1) != 1) dist = RS_Units::convert(dist);
-    RS_SETTINGS->endGroup();
+    if (!RS_SETTINGS->snapshot().unitlessGrid) dist = RS_Units::convert(dist);
 
     RS_Graphic* graphic = getGraphic();
     QString ret;
@@ -159,6 +157,7 @@ void RS_DimAligned::updateDim(bool autoText) {
 
     RS_DEBUG->print("RS_DimAligned::update");
 
+    clearDimCache();
     clear();
 
     if (isUndone()) {
@@ -297,6 +297,7 @@ void RS_DimAngular::updateDim(bool autoText /*= false*/)
     Q_UNUSED( autoText)
     RS_DEBUG->print("RS_DimAngular::update");
 
+    clearDimCache();
     clear();
 
     if (isUndone()) {
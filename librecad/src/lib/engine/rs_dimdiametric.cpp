@@ -87,9 +87,7 @@ QString RS_DimDiametric::getMeasuredLabel() {
     // Definitive dimension line:
 	double dist = data.definitionPoint.distanceTo(edata.definitionPoint) * getGeneralFactor();
 
-    RS_SETTINGS->beginGroup("/Appearance");
-    if (RS_SETTINGS->readNumEntry("/UnitlessGrid", 1) != 1) dist = RS_Units::convert(dist);
-    RS_SETTINGS->endGroup();
+    if (!RS_SETTINGS->snapshot().unitlessGrid) dist = RS_Units::convert(dist);
 
     RS_Graphic* graphic = getGraphic();
 
@@ -134,6 +132,7 @@ void RS_DimDiametric::updateDim(bool autoText) {
 
     RS_DEBUG->print("RS_DimDiametric::update");
 
+    clearDimCache();
     clear();
 
         if (isUndone()) {
@@ -24,7 +24,16 @@
 **
 **********************************************************************/
 #include<iostream>
+#include<set>
+
+#include <QPainterPath>
+#include <QTransform>
+
+#include "lc_blockdrawlist.h"
+#include "rs_graphicview.h"
 #include "rs_information.h"
+#include "rs_layer.h"
+#include "rs_painter.h"
 #include "rs_line.h"
 #include "rs_dimension.h"
 #include "rs_solid.h"
@@ -121,6 +130,129 @@ RS_Vector RS_Dimension::getNearestSelectedRef( const RS_Vector& coord,
     return RS_Entity::getNearestSelectedRef( coord, dist);
 }
 
+void RS_Dimension::invalidateDim(bool autoText)
+{
+    m_outdatedAutoText = m_outdated ? (m_outdatedAutoText || autoText) : autoText;
+    m_outdated = true;
+}
+
+void RS_Dimension::updateOutdatedDim() const
+{
+    if (!m_outdated)
+        return;
+    // the subentities are a cache of the dimension data
+    auto* self = const_cast<RS_Dimension*>(this);
+    self->updateDim(m_outdatedAutoText);
+    self->m_outdated = false;
+    if (getParent() != nullptr)
+        getParent()->updateSpatialIndex(self);
+}
+
+void RS_Dimension::clearDimCache()
+{
+    m_outdated = false;
+    m_released = false;
+    m_drawCache = {};
+}
+
+/**
+ * Creates the released subentities again, for snapping, selecting,
+ * exploding or modifying the dimension. The compiled paths stay valid,
+ * the subentities are kept until the dimension is updated.
+ */
+void RS_Dimension::prepareEntities() const
+{
+    runDeferredUpdate();
+    updateOutdatedDim();
+    if (!m_released)
+        return;
+    auto* self = const_cast<RS_Dimension*>(this);
+    std::shared_ptr<const LC_BlockDrawList> paths = std::move(m_drawCache.paths);
+    self->updateDim(false);
+    m_drawCache.paths = std::move(paths);
+}
+
+/**
+ * Compiles the lines, arcs and arrows of the dimension into painter paths,
+ * and releases them. Only the texts are kept as entities.
+ */
+void RS_Dimension::compileDim()
+{
+    prepareEntities();
+    std::vector<RS_Entity*> others;
+    m_drawCache.paths = LC_BlockDrawList::compile(*this, others);
+
+    const RS_Vector minBorder = getMin();
+    const RS_Vector maxBorder = getMax();
+    m_drawCache.texts.clear();
+    for (const auto& taken: takeEntities({others.cbegin(), others.cend()}))
+        m_drawCache.texts.emplace_back(taken.second);
+    clear();
+    minV = minBorder;
+    maxV = maxBorder;
+    m_released = true;
+}
+
+void RS_Dimension::calculateBorders()
+{
+    // the borders of released subentities are kept
+    if (!m_released)
+        RS_EntityContainer::calculateBorders();
+}
+
+void RS_Dimension::forcedCalculateBorders()
+{
+    if (!m_released)
+        RS_EntityContainer::forcedCalculateBorders();
+}
+
+bool RS_Dimension::setSelected(bool select)
+{
+    if (!RS_EntityContainer::setSelected(select))
+        return false;
+    for (const auto& text: m_drawCache.texts)
+        text->setSelected(select);
+    return true;
+}
+
+void RS_Dimension::prepareDraw(const RS_GraphicView& view)
+{
+    runDeferredUpdate();
+    updateOutdatedDim();
+    if (view.isDraftMode())
+        prepareEntities();
+    else if (m_drawCache.paths == nullptr)
+        compileDim();
+}
+
+void RS_Dimension::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset)
+{
+    if (painter == nullptr || view == nullptr) {
+        runDeferredUpdate();
+        updateOutdatedDim();
+        return;
+    }
+    // views drawing by several threads prepared the dimension before, nothing is left to do then
+    prepareDraw(*view);
+    if (view->isDraftMode()) {
+        RS_EntityContainer::draw(painter, view, patternOffset);
+        return;
+    }
+    if (!view->isDrawnBy(painter, this))
+        return;
+
+    m_drawCache.paths->draw(painter, view, *this, patternOffset);
+
+    if (m_released) {
+        for (const auto& text: m_drawCache.texts)
+            view->drawEntity(painter, text.get());
+    } else {
+        for (RS_Entity* e: entities) {
+            if (e->rtti() == RS2::EntityMText || e->rtti() == RS2::EntityText)
+                view->drawEntity(painter, e);
+        }
+    }
+}
 
 /**
  * @return Dimension text. Either a text the user defined or
@@ -204,10 +336,7 @@ RS_VectorSolutions RS_Dimension::getIntersectionsLineContainer(
         }
     }
 
-    /**
-     * We cannot sort the solutions in place because getVector() returns a
-     * const vector, so first construct a copy:
-     */
+    // getVector() returns a copy, which can be sorted
     std::vector<RS_Vector> solutions_sorted(solutions_filtered.getVector());
     std::sort(solutions_sorted.begin(), solutions_sorted.end(),
               [l](const RS_Vector& lhs, const RS_Vector& rhs)
@@ -28,9 +28,14 @@
 #ifndef RS_DIMENSION_H
 #define RS_DIMENSION_H
 
+#include <memory>
+#include <vector>
+
 #include "rs_entitycontainer.h"
 #include "rs_mtext.h"
 
+class LC_BlockDrawList;
+
 /**
  * Holds the data that is common to all dimension entities.
  */
@@ -106,6 +111,13 @@ public:
 	RS_Vector getNearestRef( const RS_Vector& coord, double* dist = nullptr) const override;
 	RS_Vector getNearestSelectedRef( const RS_Vector& coord, double* dist = nullptr) const override;
 
+	void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
+    //! updates and compiles the dimension, draw() only reads it afterwards
+    void prepareDraw(const RS_GraphicView& view) override;
+	void calculateBorders() override;
+	void forcedCalculateBorders() override;
+	bool setSelected(bool select=true) override;
+
     /** @return Copy of data that defines the dimension. */
     RS_DimensionData getData() const {
         return data;
@@ -130,6 +142,17 @@ public:
 
     virtual void updateDim(bool autoText=false) = 0;
 
+    /**
+     * Marks the subentities outdated, e.g. after a change of the dimension style.
+     * They are created again by updateDim(), when the dimension is drawn or queried.
+     */
+    void invalidateDim(bool autoText=false);
+    bool isDimOutdated() const {
+        return m_outdated;
+    }
+    //! creates the subentities, if outdated by invalidateDim()
+    void updateOutdatedDim() const;
+
     void updateCreateDimensionLine(const RS_Vector& p1, const RS_Vector& p2,
                   bool arrow1=true, bool arrow2=true, bool autoText=false);
 
@@ -216,9 +239,41 @@ private:
         const RS_Vector& p1, const RS_Vector& p2,
         bool arrow1=true, bool arrow2=true, bool autoText=false);
 
+    //! compiles the subentities into m_drawCache, and releases them
+    void compileDim();
+
+    // the subentities compiled for drawing, see draw()
+    struct DrawCache {
+        DrawCache() = default;
+        // copies of the dimension compile their own subentities
+        DrawCache(const DrawCache&) {}
+        DrawCache& operator = (const DrawCache&)
+        {
+            paths.reset();
+            texts.clear();
+            return *this;
+        }
+        DrawCache(DrawCache&&) = default;
+        DrawCache& operator = (DrawCache&&) = default;
+
+        std::shared_ptr<const LC_BlockDrawList> paths;
+        // texts are kept as entities, with the parent dimension
+        std::vector<std::unique_ptr<RS_Entity>> texts;
+    };
+    mutable DrawCache m_drawCache;
+    //! the subentities are released after compiling, and created again by prepareEntities()
+    mutable bool m_released = false;
+
 protected:
+    void prepareEntities() const override;
+    //! called by updateDim() before creating the subentities
+    void clearDimCache();
+
     /** Data common to all dimension entities. */
     RS_DimensionData data;
+    //! set by invalidateDim(), cleared by updateDim()
+    bool m_outdated = false;
+    bool m_outdatedAutoText = false;
 };
 
 #endif
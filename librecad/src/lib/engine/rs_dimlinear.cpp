@@ -115,9 +115,7 @@ QString RS_DimLinear::getMeasuredLabel() {
     // Definitive dimension line:
     double dist = dimP1.distanceTo(dimP2) * getGeneralFactor();
 
-    RS_SETTINGS->beginGroup("/Appearance");
-    if (RS_SETTINGS->readNumEntry("/UnitlessGrid", 1) != 1) dist = RS_Units::convert(dist);
-    RS_SETTINGS->endGroup();
+    if (!RS_SETTINGS->snapshot().unitlessGrid) dist = RS_Units::convert(dist);
 
         RS_Graphic* graphic = getGraphic();
 
@@ -162,6 +160,7 @@ void RS_DimLinear::updateDim(bool autoText) {
 
     RS_DEBUG->print("RS_DimLinear::update");
 
+    clearDimCache();
     clear();
 
     if (isUndone()) {
@@ -90,9 +90,7 @@ QString RS_DimRadial::getMeasuredLabel() {
     // Definitive dimension line:
 	double dist = data.definitionPoint.distanceTo(edata.definitionPoint) * getGeneralFactor();
 
-    RS_SETTINGS->beginGroup("/Appearance");
-    if (RS_SETTINGS->readNumEntry("/UnitlessGrid", 1) != 1) dist = RS_Units::convert(dist);
-    RS_SETTINGS->endGroup();
+    if (!RS_SETTINGS->snapshot().unitlessGrid) dist = RS_Units::convert(dist);
 
     RS_Graphic* graphic = getGraphic();
 
@@ -136,6 +134,7 @@ void RS_DimRadial::updateDim(bool autoText)
 
     RS_DEBUG->print("RS_DimRadial::update");
 
+    clearDimCache();
     clear();
 
     if (isUndone()) return;
@@ -26,8 +26,14 @@
 **********************************************************************/
 
 
+#include <map>
+
 #include "rs_document.h"
+#include "lc_attributeschange.h"
+#include "lc_documentsnapshot.h"
+#include "lc_transformchange.h"
 #include "rs_debug.h"
+#include "rs_undocycle.h"
 
 
 /**
@@ -44,6 +50,26 @@ RS_Document::RS_Document(RS_EntityContainer* parent)
     RS_DEBUG->print("RS_Document::RS_Document() ");
 }
 
+RS_Document::RS_Document(const RS_Document& other)
+    : RS_EntityContainer{other}
+    , RS_Undo{other}
+    , modified{other.modified}
+    , activePen{other.activePen}
+    , filename{other.filename}
+    , autosaveFilename{other.autosaveFilename}
+    , formatType{other.formatType}
+    , gv{other.gv}
+{
+}
+
+RS_Document::~RS_Document()
+{
+    if (isOwner()) {
+        for (const auto& entry: undoneEntities)
+            delete entry.first;
+    }
+}
+
 /**
  * Overwritten to set modified flag when undo cycle finished with undoable(s).
  */
@@ -56,3 +82,171 @@ void RS_Document::endUndoCycle()
     RS_Undo::endUndoCycle();
 }
 
+void RS_Document::addEntity(RS_Entity* entity)
+{
+    ++revision;
+    RS_EntityContainer::addEntity(entity);
+}
+
+void RS_Document::appendEntity(RS_Entity* entity)
+{
+    ++revision;
+    RS_EntityContainer::appendEntity(entity);
+}
+
+void RS_Document::prependEntity(RS_Entity* entity)
+{
+    ++revision;
+    RS_EntityContainer::prependEntity(entity);
+}
+
+void RS_Document::insertEntity(int index, RS_Entity* entity)
+{
+    ++revision;
+    RS_EntityContainer::insertEntity(index, entity);
+}
+
+void RS_Document::moveEntity(int index, QList<RS_Entity *>& entList)
+{
+    ++revision;
+    RS_EntityContainer::moveEntity(index, entList);
+}
+
+void RS_Document::setEntityAt(int index, RS_Entity* en)
+{
+    ++revision;
+    RS_EntityContainer::setEntityAt(index, en);
+}
+
+bool RS_Document::removeEntity(RS_Entity* entity)
+{
+    ++revision;
+    RS_Document* document = getParentDocument(entity);
+    auto it = document != nullptr ? document->undoneEntities.find(entity) : undoneEntities.end();
+    if (document == nullptr || it == document->undoneEntities.end())
+        return RS_EntityContainer::removeEntity(entity);
+    document->undoneEntities.erase(it);
+    if (document->isOwner())
+        delete entity;
+    return true;
+}
+
+int RS_Document::removeEntities(const std::vector<RS_Entity*>& removed)
+{
+    ++revision;
+    std::vector<RS_Entity*> listed;
+    listed.reserve(removed.size());
+    int undone = 0;
+    for (RS_Entity* entity: removed) {
+        RS_Document* document = getParentDocument(entity);
+        auto it = document != nullptr ? document->undoneEntities.find(entity) : undoneEntities.end();
+        if (document == nullptr || it == document->undoneEntities.end()) {
+            listed.push_back(entity);
+            continue;
+        }
+        document->undoneEntities.erase(it);
+        if (document->isOwner())
+            delete entity;
+        ++undone;
+    }
+    return undone + RS_EntityContainer::removeEntities(listed);
+}
+
+void RS_Document::clear()
+{
+    ++revision;
+    if (isOwner()) {
+        for (const auto& entry: undoneEntities)
+            delete entry.first;
+    }
+    undoneEntities.clear();
+    RS_EntityContainer::clear();
+}
+
+RS_Document* RS_Document::getParentDocument(RS_Entity* entity)
+{
+    RS_EntityContainer* parent = entity != nullptr ? entity->getParent() : nullptr;
+    if (parent == nullptr || !parent->isDocument())
+        return nullptr;
+    return static_cast<RS_Document*>(parent);
+}
+
+void RS_Document::undoCycleChanged(const RS_UndoCycle& cycle)
+{
+    ++revision;
+    std::vector<RS_Entity*> entities;
+    for (RS_Undoable* undoable: cycle.getUndoables()) {
+        switch (undoable->undoRtti()) {
+        case RS2::UndoableEntity:
+            entities.push_back(static_cast<RS_Entity*>(undoable));
+            // copies share the id of their original
+            if (!undoable->isUndone())
+                entityChanged(entities.back());
+            break;
+        case RS2::UndoableAttributes:
+            for (RS_Entity* entity: static_cast<LC_AttributesChange*>(undoable)->getEntities())
+                entityChanged(entity);
+            break;
+        case RS2::UndoableTransform:
+            for (RS_Entity* entity: static_cast<LC_TransformChange*>(undoable)->getEntities())
+                entityChanged(entity);
+            break;
+        default:
+            break;
+        }
+    }
+    updateUndoneEntities(entities);
+}
+
+std::shared_ptr<const LC_DocumentSnapshot> RS_Document::snapshot()
+{
+    if (lastSnapshot == nullptr || lastSnapshot->getRevision() != revision) {
+        lastSnapshot = LC_DocumentSnapshot::create(*this, revision, lastSnapshot.get(), changedEntities);
+        changedEntities.clear();
+    }
+    return lastSnapshot;
+}
+
+void RS_Document::entityChanged(const RS_Entity* entity)
+{
+    // the top level entity of any document holding it
+    while (entity != nullptr && entity->getParent() != nullptr && !entity->getParent()->isDocument())
+        entity = entity->getParent();
+    if (entity == nullptr || entity->getParent() == nullptr)
+        return;
+    auto* document = static_cast<RS_Document*>(entity->getParent());
+    ++document->revision;
+    if (document->lastSnapshot != nullptr)
+        document->changedEntities.insert(entity->getId());
+}
+
+void RS_Document::updateUndoneEntities(const std::vector<RS_Entity*>& entities)
+{
+    ++revision;
+    // a cycle may also contain entities of other documents, e.g. inserts in blocks
+    struct Changes {
+        std::vector<std::pair<int, RS_Entity*>> restored;
+        std::set<RS_Entity*> taken;
+    };
+    std::map<RS_Document*, Changes> changes;
+    for (RS_Entity* entity: entities) {
+        RS_Document* document = getParentDocument(entity);
+        if (document == nullptr)
+            continue;
+        auto it = document->undoneEntities.find(entity);
+        // the own state only, entities of an undone block stay in the block
+        if (entity->getFlag(RS2::FlagUndone)) {
+            if (it == document->undoneEntities.end())
+                changes[document].taken.insert(entity);
+        } else if (it != document->undoneEntities.end()) {
+            changes[document].restored.emplace_back(it->second, entity);
+            document->undoneEntities.erase(it);
+        }
+    }
+    for (auto& [document, change]: changes) {
+        // undo and redo are done in reverse order: restoring first undoes the last taking
+        document->restoreEntities(std::move(change.restored));
+        for (const auto& [position, entity]: document->takeEntities(change.taken))
+            document->undoneEntities.emplace(entity, position);
+    }
+}
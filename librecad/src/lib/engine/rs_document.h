@@ -29,9 +29,14 @@
 #ifndef RS_DOCUMENT_H
 #define RS_DOCUMENT_H
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "rs_entitycontainer.h"
 #include "rs_undo.h"
 
+class LC_DocumentSnapshot;
 class RS_BlockList;
 class RS_LayerList;
 
@@ -47,6 +52,10 @@ class RS_Document : public RS_EntityContainer,
     public RS_Undo {
 public:
 	RS_Document(RS_EntityContainer* parent=nullptr);
+	//! undone entities are owned by the original document, they are not copied
+	RS_Document(const RS_Document& other);
+	RS_Document& operator = (const RS_Document&) = delete;
+	~RS_Document() override;
 
     virtual RS_LayerList* getLayerList()= 0;
     virtual RS_BlockList* getBlockList() = 0;
@@ -75,6 +84,49 @@ public:
         }
     }
 
+    /**
+     * Changes of the entity list increase the revision of the document.
+     */
+    void addEntity(RS_Entity* entity) override;
+    void appendEntity(RS_Entity* entity) override;
+    void prependEntity(RS_Entity* entity) override;
+    void insertEntity(int index, RS_Entity* entity) override;
+    void moveEntity(int index, QList<RS_Entity *>& entList) override;
+    void setEntityAt(int index, RS_Entity* en) override;
+    /**
+     * Also removes undone entities, which are kept out of the entity list.
+     */
+    bool removeEntity(RS_Entity* entity) override;
+    int removeEntities(const std::vector<RS_Entity*>& removed) override;
+    void clear() override;
+
+    /**
+     * @return the revision of the entity list of the document, increased by every change of
+     * the list and by every undo cycle, either made, undone or redone. Unlike the revision of
+     * the document as an entity, it doesn't change with the entities edited in place.
+     */
+    unsigned long long getListRevision() const {
+        return revision;
+    }
+    /**
+     * @brief snapshot - a read only view of the entities at the current revision, which other
+     * threads can hold while the document is edited. Called from the thread editing the document:
+     * the entities changed since the previous snapshot are copied, the others are shared with it.
+     */
+    std::shared_ptr<const LC_DocumentSnapshot> snapshot();
+    /**
+     * @brief entityChanged - marks an entity, changed in place outside of an undo cycle, so the
+     * next snapshot copies it again. Nested entities mark their top level entity.
+     */
+    void entityChanged(const RS_Entity* entity);
+
+    /**
+     * Moves the given entities, which are undone, out of the entity list of
+     * their document, and the ones no longer undone back into it. Called for
+     * each undo cycle, and for entities undone outside of an undo cycle.
+     */
+    void updateUndoneEntities(const std::vector<RS_Entity*>& entities);
+
     /**
      * @return Currently active drawing pen.
      */
@@ -132,6 +184,16 @@ public:
      */
      void endUndoCycle() override;
 
+protected:
+    /**
+     * Keeps the entities undone by the cycle out of the entity lists, so
+     * traversals don't have to skip the deleted entities kept for undo.
+     * @see updateUndoneEntities()
+     */
+    void undoCycleChanged(const RS_UndoCycle& cycle) override;
+
+public:
+
     void setGraphicView(RS_GraphicView * g) {gv = g;}
     RS_GraphicView* getGraphicView() {return gv;}
 
@@ -149,5 +211,18 @@ protected:
     //used to read/save current view
     RS_GraphicView * gv = nullptr;
 
+private:
+    // the document holding the entity as a direct child, or nullptr
+    static RS_Document* getParentDocument(RS_Entity* entity);
+
+    //! undone direct children, moved out of the entity list, with their previous positions
+    std::unordered_map<RS_Entity*, int> undoneEntities;
+
+    unsigned long long revision = 0;
+    //! the last snapshot, sharing its copies of unchanged entities with the next one
+    std::shared_ptr<const LC_DocumentSnapshot> lastSnapshot;
+    //! ids of the entities changed in place since the last snapshot
+    std::unordered_set<unsigned long long> changedEntities;
+
 };
 #endif
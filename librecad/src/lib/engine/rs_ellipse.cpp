@@ -25,7 +25,11 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <cmath>
+
 #include "rs_ellipse.h"
+#include "lc_entitypool.h"
 
 #include  "lc_quadratic.h"
 
@@ -198,6 +202,69 @@ private:
     double by2=0.;
 };
 
+/**
+ * The closest point on a full ellipse to a point, in the coordinates of the ellipse, with the major
+ * axis along x. The point is folded into the first quadrant, where the closest point is unique. A
+ * trigonometry free estimate is refined by Newton-Raphson on the elliptic angle.
+ * @return false, if the iteration doesn't converge, or the ellipse is too close to a circle
+ */
+bool getClosestEllipsePoint(double a, double b, const RS_Vector& point, RS_Vector& closest)
+{
+    if (b > a) {
+        RS_Vector flipped;
+        if (!getClosestEllipsePoint(b, a, {point.y, point.x}, flipped))
+            return false;
+        closest = {flipped.y, flipped.x};
+        return true;
+    }
+    const double c2 = a*a - b*b;
+    // close to a circle, the ellipse angle is badly conditioned
+    if (c2 < RS_TOLERANCE * a * a)
+        return false;
+    const double px = std::abs(point.x);
+    const double py = std::abs(point.y);
+
+    // the estimate: the centers of curvature of the current guess are moved along the ellipse
+    double tx = std::sqrt(0.5);
+    double ty = tx;
+    for (short i = 0; i < 3; ++i) {
+        const double ex = c2 * tx * tx * tx / a;
+        const double ey = -c2 * ty * ty * ty / b;
+        const double qx = px - ex;
+        const double qy = py - ey;
+        const double q = std::hypot(qx, qy);
+        if (q < RS_TOLERANCE * a)
+            break;
+        const double r = std::hypot(a * tx - ex, b * ty - ey);
+        tx = std::clamp((qx * r / q + ex) / a, 0., 1.);
+        ty = std::clamp((qy * r / q + ey) / b, 0., 1.);
+        const double t = std::hypot(tx, ty);
+        tx /= t;
+        ty /= t;
+    }
+
+    // Newton-Raphson on the half derivative of the squared distance over the elliptic angle
+    double theta = std::atan2(ty, tx);
+    bool converged = false;
+    for (short i = 0; i < 8 && !converged; ++i) {
+        const double s = std::sin(theta);
+        const double c = std::cos(theta);
+        const double d1 = a * px * s - b * py * c - c2 * s * c;
+        const double d2 = a * px * c + b * py * s - c2 * (c * c - s * s);
+        // not a minimum
+        if (d2 <= 0.)
+            return false;
+        const double step = d1 / d2;
+        const double next = std::clamp(theta - step, 0., M_PI_2);
+        converged = std::abs(next - theta) < 1e-12;
+        theta = next;
+    }
+    if (!converged)
+        return false;
+    closest = {std::copysign(a * std::cos(theta), point.x), std::copysign(b * std::sin(theta), point.y)};
+    return true;
+}
+
 }
 
 std::ostream& operator << (std::ostream& os, const RS_EllipseData& ed) {
@@ -227,11 +294,20 @@ RS_Entity* RS_Ellipse::clone() const {
 	return e;
 }
 
+void* RS_Ellipse::operator new(size_t size) {
+    return LC_EntityPool::forType<RS_Ellipse>().allocate(size);
+}
+
+void RS_Ellipse::operator delete(void* p, size_t size) {
+    LC_EntityPool::forType<RS_Ellipse>().deallocate(p, size);
+}
+
 /**
  * Calculates the boundary box of this ellipse.
   * @author Dongxu Li
  */
 void RS_Ellipse::calculateBorders() {
+    touch();
 
     RS_Vector startpoint = getStartpoint();
     RS_Vector endpoint = getEndpoint();
@@ -554,64 +630,72 @@ RS_Vector RS_Ellipse::getNearestPointOnEntity(const RS_Vector& coord,
     RS_Vector perpendicular{-ret.y, ret.x};
     //std::cout<<"(a= "<<a<<" b= "<<b<<" x= "<<x<<" y= "<<y<<" )\n";
     //std::cout<<"finding minimum for ("<<x<<"-"<<a<<"*cos(t))^2+("<<y<<"-"<<b<<"*sin(t))^2\n";
-    double twoa2b2=2*(a*a-b*b);
-    double twoax=2*a*x;
-    double twoby=2*b*y;
-    double a0=twoa2b2*twoa2b2;
-    std::vector<double> ce(4,0.);
-    std::vector<double> roots(0,0.);
-
-    //need to handle: a=b (i.e. a0=0); point close to the ellipse origin.
-    if (a0 > RS_TOLERANCE && std::abs(getRatio() - 1.0) > RS_TOLERANCE && ret.squared() > RS_TOLERANCE2 ) {
-        // a != b , ellipse
-        ce[0]=-2.*twoax/twoa2b2;
-        ce[1]= (twoax*twoax+twoby*twoby)/a0-1.;
-        ce[2]= - ce[0];
-        ce[3]= -twoax*twoax/a0;
-        //std::cout<<"1::find cosine, variable c, solve(c^4 +("<<ce[0]<<")*c^3+("<<ce[1]<<")*c^2+("<<ce[2]<<")*c+("<<ce[3]<<")=0,c)\n";
-        roots=RS_Math::quarticSolver(ce);
+	double dDistance(RS_MAXDOUBLE*RS_MAXDOUBLE);
+    RS_Vector closest;
+    if (a > RS_TOLERANCE && b > RS_TOLERANCE && getClosestEllipsePoint(a, b, ret, closest)) {
+        dDistance = (closest - ret).squared();
+        ret = closest;
     } else {
-        // Issue #1653: approximately a=b, solve the equation of ds^2/d\theta = 0 by Newton-Raphson
-        double theta = ClosestEllipticPoint{a, b, ret}.getTheta();
-        roots.push_back(std::cos(theta));
-        // Just in case, the found solution is for the maximum distance. Then, the minimum is at the opposite
-        roots.push_back(-roots.front());
-    }
-    if(roots.empty()) {
-        //this should not happen
-        std::cout<<"(a= "<<a<<" b= "<<b<<" x= "<<x<<" y= "<<y<<" )\n";
-        std::cout<<"finding minimum for ("<<x<<"-"<<a<<"*cos(t))^2+("<<y<<"-"<<b<<"*sin(t))^2\n";
-        std::cout<<"2::find cosine, variable c, solve(c^4 +("<<ce[0]<<")*c^3+("<<ce[1]<<")*c^2+("<<ce[2]<<")*c+("<<ce[3]<<")=0,c)\n";
-        std::cout<<ce[0]<<' '<<ce[1]<<' '<<ce[2]<<' '<<ce[3]<<std::endl;
-        std::cerr<<"RS_Math::RS_Ellipse::getNearestPointOnEntity() finds no root from quartic, this should not happen\n";
-        return RS_Vector(coord); // better not to return invalid: return RS_Vector(false);
-    }
-
-//    RS_Vector vp2(false);
-	double d,dDistance(RS_MAXDOUBLE*RS_MAXDOUBLE);
-    //double ea;
-    for(size_t i=0; i<roots.size(); i++) {
-        //I don't understand the reason yet, but I can do without checking whether sine/cosine are valid
-        //if ( fabs(roots[i])>1.) continue;
-		double const s=twoby*roots[i]/(twoax-twoa2b2*roots[i]); //sine
-        //if (fabs(s) > 1. ) continue;
-		double const d2=twoa2b2+(twoax-2.*roots[i]*twoa2b2)*roots[i]+twoby*s;
-        if (d2<0) continue; // fartherest
-        RS_Vector vp3;
-        vp3.set(a*roots[i],b*s);
-        d=(vp3-ret).squared();
-//        std::cout<<i<<" Checking: cos= "<<roots[i]<<" sin= "<<s<<" angle= "<<atan2(roots[i],s)<<" ds2= "<<d<<" d="<<d2<<std::endl;
-        if( ret.valid && d>dDistance) continue;
-        ret=vp3;
-        dDistance=d;
-//			ea=atan2(roots[i],s);
-    }
-    if( ! ret.valid ) {
-        //this should not happen
-//        std::cout<<ce[0]<<' '<<ce[1]<<' '<<ce[2]<<' '<<ce[3]<<std::endl;
-//        std::cout<<"(x,y)=( "<<x<<" , "<<y<<" ) a= "<<a<<" b= "<<b<<" sine= "<<s<<" d2= "<<d2<<" dist= "<<d<<std::endl;
-//        std::cout<<"RS_Ellipse::getNearestPointOnEntity() finds no minimum, this should not happen\n";
-        RS_DEBUG->print(RS_Debug::D_ERROR,"RS_Ellipse::getNearestPointOnEntity() finds no minimum, this should not happen\n");
+        // fall back to the quartic equation of the cosine
+        double twoa2b2=2*(a*a-b*b);
+        double twoax=2*a*x;
+        double twoby=2*b*y;
+        double a0=twoa2b2*twoa2b2;
+        std::vector<double> ce(4,0.);
+        std::vector<double> roots(0,0.);
+
+        //need to handle: a=b (i.e. a0=0); point close to the ellipse origin.
+        if (a0 > RS_TOLERANCE && std::abs(getRatio() - 1.0) > RS_TOLERANCE && ret.squared() > RS_TOLERANCE2 ) {
+            // a != b , ellipse
+            ce[0]=-2.*twoax/twoa2b2;
+            ce[1]= (twoax*twoax+twoby*twoby)/a0-1.;
+            ce[2]= - ce[0];
+            ce[3]= -twoax*twoax/a0;
+            //std::cout<<"1::find cosine, variable c, solve(c^4 +("<<ce[0]<<")*c^3+("<<ce[1]<<")*c^2+("<<ce[2]<<")*c+("<<ce[3]<<")=0,c)\n";
+            roots=RS_Math::quarticSolver(ce);
+        } else {
+            // Issue #1653: approximately a=b, solve the equation of ds^2/d\theta = 0 by Newton-Raphson
+            double theta = ClosestEllipticPoint{a, b, ret}.getTheta();
+            roots.push_back(std::cos(theta));
+            // Just in case, the found solution is for the maximum distance. Then, the minimum is at the opposite
+            roots.push_back(-roots.front());
+        }
+        if(roots.empty()) {
+            //this should not happen
+            std::cout<<"(a= "<<a<<" b= "<<b<<" x= "<<x<<" y= "<<y<<" )\n";
+            std::cout<<"finding minimum for ("<<x<<"-"<<a<<"*cos(t))^2+("<<y<<"-"<<b<<"*sin(t))^2\n";
+            std::cout<<"2::find cosine, variable c, solve(c^4 +("<<ce[0]<<")*c^3+("<<ce[1]<<")*c^2+("<<ce[2]<<")*c+("<<ce[3]<<")=0,c)\n";
+            std::cout<<ce[0]<<' '<<ce[1]<<' '<<ce[2]<<' '<<ce[3]<<std::endl;
+            std::cerr<<"RS_Math::RS_Ellipse::getNearestPointOnEntity() finds no root from quartic, this should not happen\n";
+            return RS_Vector(coord); // better not to return invalid: return RS_Vector(false);
+        }
+
+    //    RS_Vector vp2(false);
+        double d = 0.;
+        //double ea;
+        for(size_t i=0; i<roots.size(); i++) {
+            //I don't understand the reason yet, but I can do without checking whether sine/cosine are valid
+            //if ( fabs(roots[i])>1.) continue;
+            double const s=twoby*roots[i]/(twoax-twoa2b2*roots[i]); //sine
+            //if (fabs(s) > 1. ) continue;
+            double const d2=twoa2b2+(twoax-2.*roots[i]*twoa2b2)*roots[i]+twoby*s;
+            if (d2<0) continue; // fartherest
+            RS_Vector vp3;
+            vp3.set(a*roots[i],b*s);
+            d=(vp3-ret).squared();
+    //        std::cout<<i<<" Checking: cos= "<<roots[i]<<" sin= "<<s<<" angle= "<<atan2(roots[i],s)<<" ds2= "<<d<<" d="<<d2<<std::endl;
+            if( ret.valid && d>dDistance) continue;
+            ret=vp3;
+            dDistance=d;
+    //			ea=atan2(roots[i],s);
+        }
+        if( ! ret.valid ) {
+            //this should not happen
+    //        std::cout<<ce[0]<<' '<<ce[1]<<' '<<ce[2]<<' '<<ce[3]<<std::endl;
+    //        std::cout<<"(x,y)=( "<<x<<" , "<<y<<" ) a= "<<a<<" b= "<<b<<" sine= "<<s<<" d2= "<<d2<<" dist= "<<d<<std::endl;
+    //        std::cout<<"RS_Ellipse::getNearestPointOnEntity() finds no minimum, this should not happen\n";
+            RS_DEBUG->print(RS_Debug::D_ERROR,"RS_Ellipse::getNearestPointOnEntity() finds no minimum, this should not happen\n");
+        }
     }
 	if (dist) {
         *dist = std::sqrt(dDistance);
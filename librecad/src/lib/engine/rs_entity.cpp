@@ -26,7 +26,11 @@
 **********************************************************************/
 
 
+#include <atomic>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <QPolygon>
 #include <QString>
@@ -53,6 +57,30 @@
 
 namespace {
 
+using UserDefVars = std::map<QString, QString>;
+
+/**
+ * User defined variables of all entities having any, keyed by the entity address:
+ * copies of an entity share its id until initId() is called.
+ */
+std::unordered_map<const RS_Entity*, UserDefVars>& userDefVarTable() {
+    static std::unordered_map<const RS_Entity*, UserDefVars> table;
+    return table;
+}
+
+/**
+ * Guards the table: the copies held by document snapshots are destroyed by the threads reading them.
+ */
+std::mutex& userDefVarMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+//! the last revision given to an entity
+std::atomic<unsigned long long> revisionCounter{0};
+//! the number of RS_Entity::RevisionHold in this thread
+thread_local int revisionHolds = 0;
+
 // Whether the entity is a member of cross hatch filling curves
 bool isHatchMember(const RS_Entity* entity) {
     if (entity == nullptr || entity->getParent() == nullptr)
@@ -77,18 +105,53 @@ RS_Entity::RS_Entity(RS_EntityContainer *parent)
 
 
 /**
- * Copy constructor.
+ * Copy constructor. Copies the user defined variables too.
  */
-/*RS_Entity::RS_Entity(const RS_Entity& e) : RS_Flags(e.getFlags()) {
-        cout << "copy constructor called\n";
-        init();
-        parent = e.parent;
-        layer = e.layer;
-        //setFlag(e.getFlags());
-    minV = e.minV;
-    maxV = e.maxV;
-    pen = e.pen;
-}*/
+RS_Entity::RS_Entity(const RS_Entity& other)
+    : RS_Undoable{other}
+    , updateEnabled{other.updateEnabled}
+    , parent{other.parent}
+    , minV{other.minV}
+    , maxV{other.maxV}
+    , layer{other.layer}
+    , id{other.id}
+    , revision{other.revision.load(std::memory_order_relaxed)}
+    , penIndex{other.penIndex}
+{
+    if (other.hasUserDefVars) {
+        std::lock_guard<std::mutex> lock{userDefVarMutex()};
+        userDefVarTable()[this] = userDefVarTable().at(&other);
+        hasUserDefVars = true;
+    }
+}
+
+RS_Entity& RS_Entity::operator = (const RS_Entity& other) {
+    if (this == &other)
+        return *this;
+    RS_Undoable::operator = (other);
+    updateEnabled = other.updateEnabled;
+    parent = other.parent;
+    minV = other.minV;
+    maxV = other.maxV;
+    layer = other.layer;
+    id = other.id;
+    revision.store(other.revision.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    penIndex = other.penIndex;
+    std::lock_guard<std::mutex> lock{userDefVarMutex()};
+    if (hasUserDefVars)
+        userDefVarTable().erase(this);
+    hasUserDefVars = other.hasUserDefVars;
+    if (hasUserDefVars)
+        userDefVarTable()[this] = userDefVarTable().at(&other);
+    return *this;
+}
+
+RS_Entity::~RS_Entity() {
+    if (hasUserDefVars) {
+        std::lock_guard<std::mutex> lock{userDefVarMutex()};
+        userDefVarTable().erase(this);
+    }
+}
 
 /**
  * Initialisation. Called from all constructors.
@@ -109,7 +172,8 @@ void RS_Entity::init() {
  * Gives this entity a new unique id.
  */
 void RS_Entity::initId() {
-    static unsigned long long idCounter=0;
+    // entities may be created by worker threads, e.g. for offsets
+    static std::atomic<unsigned long long> idCounter{0};
     id = idCounter++;
 }
 
@@ -147,11 +211,14 @@ bool RS_Entity::setSelected(bool select) {
         return false;
     }
 
+    const bool changed = getFlag(RS2::FlagSelected) != select;
     if (select) {
         setFlag(RS2::FlagSelected);
     } else {
         delFlag(RS2::FlagSelected);
     }
+    if (changed && parent != nullptr)
+        parent->childSelectionChanged(this);
 
     return true;
 }
@@ -235,6 +302,28 @@ void RS_Entity::undoStateChanged(bool undone)
 
     setSelected(false);
     update();
+    touch();
+}
+
+
+void RS_Entity::touch()
+{
+    if (revisionHolds > 0)
+        return;
+    // the parents share the stamp, so a container is at least as recent as its children
+    const unsigned long long stamp = revisionCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+    for (RS_Entity* e = this; e != nullptr; e = e->parent)
+        e->revision.store(stamp, std::memory_order_relaxed);
+}
+
+RS_Entity::RevisionHold::RevisionHold()
+{
+    ++revisionHolds;
+}
+
+RS_Entity::RevisionHold::~RevisionHold()
+{
+    --revisionHolds;
 }
 
 
@@ -431,6 +520,8 @@ bool RS_Entity::isVisible() const{
 }
 
 void RS_Entity::setVisible(bool v) {
+    if (v != getFlag(RS2::FlagVisible))
+        touch();
 	if (v) {
 		setFlag(RS2::FlagVisible);
 	} else {
@@ -756,11 +847,7 @@ RS_Layer* RS_Entity::getLayer(bool resolve) const {
  */
 void RS_Entity::setLayer(const QString& name) {
     RS_Graphic* graphic = getGraphic();
-    if (graphic) {
-        layer = graphic->findLayer(name);
-    } else {
-		layer = nullptr;
-    }
+    RS_Entity::setLayer(graphic != nullptr ? graphic->findLayer(name) : nullptr);
 }
 
 
@@ -769,7 +856,13 @@ void RS_Entity::setLayer(const QString& name) {
  * Sets the layer of this entity to the layer given.
  */
 void RS_Entity::setLayer(RS_Layer* l) {
+    if (l == layer)
+        return;
+    const RS_Layer* previous = layer;
     layer = l;
+    touch();
+    if (parent != nullptr)
+        parent->childLayerChanged(this, previous);
 }
 
 
@@ -781,12 +874,7 @@ void RS_Entity::setLayer(RS_Layer* l) {
  */
 void RS_Entity::setLayerToActive() {
     RS_Graphic* graphic = getGraphic();
-
-    if (graphic) {
-        layer = graphic->getActiveLayer();
-    } else {
-		layer = nullptr;
-    }
+    RS_Entity::setLayer(graphic != nullptr ? graphic->getActiveLayer() : nullptr);
 }
 
 
@@ -803,6 +891,7 @@ void RS_Entity::setLayerToActive() {
  * @return Pen for this entity.
  */
 RS_Pen RS_Entity::getPen(bool resolve) const {
+    const RS_Pen& pen = LC_PenTable::get(penIndex);
 
     if (!resolve) {
         return pen;
@@ -878,7 +967,7 @@ RS_Pen RS_Entity::getPen(bool resolve) const {
 void RS_Entity::setPenToActive() {
     RS_Document* doc = getDocument();
     if (doc) {
-        pen = doc->getActivePen();
+        setPen(doc->getActivePen());
     } else {
         //RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Entity::setPenToActive(): "
         //                "No document / active pen linked to this entity.");
@@ -962,9 +1051,12 @@ double RS_Entity::getStyleFactor(RS_GraphicView* view) {
  * @return User defined variable connected to this entity or nullptr if not found.
  */
 QString RS_Entity::getUserDefVar(const QString& key) const {
+	if (!hasUserDefVars) return nullptr;
+	std::lock_guard<std::mutex> lock{userDefVarMutex()};
+	const UserDefVars& varList = userDefVarTable().at(this);
 	auto it=varList.find(key);
 	if(it==varList.end()) return nullptr;
-	return varList.at(key);
+	return it->second;
 }
 /*
  * @coord
@@ -983,14 +1075,23 @@ RS_Vector RS_Entity::getNearestOrthTan(const RS_Vector& /*coord*/,
  * Add a user defined variable to this entity.
  */
 void RS_Entity::setUserDefVar(QString key, QString val) {
-	varList.insert(std::make_pair(key, val));
+	std::lock_guard<std::mutex> lock{userDefVarMutex()};
+	userDefVarTable()[this].insert(std::make_pair(key, val));
+	hasUserDefVars = true;
 }
 
 /**
  * Deletes the given user defined variable.
  */
 void RS_Entity::delUserDefVar(QString key) {
-	varList.erase(key);
+	if (!hasUserDefVars) return;
+	std::lock_guard<std::mutex> lock{userDefVarMutex()};
+	auto it = userDefVarTable().find(this);
+	it->second.erase(key);
+	if (it->second.empty()) {
+		userDefVarTable().erase(it);
+		hasUserDefVars = false;
+	}
 }
 
 /**
@@ -998,7 +1099,9 @@ void RS_Entity::delUserDefVar(QString key) {
  */
 std::vector<QString> RS_Entity::getAllKeys() const{
 	std::vector<QString> ret(0);
-	for(auto const& v: varList){
+	if (!hasUserDefVars) return ret;
+	std::lock_guard<std::mutex> lock{userDefVarMutex()};
+	for(auto const& v: userDefVarTable().at(this)){
 		ret.push_back(v.first);
 	}
 	return ret;
@@ -1088,12 +1191,12 @@ std::ostream& operator << (std::ostream& os, RS_Entity& e) {
         os << " layer address: " << e.layer << " ";
     }
 
-    os << e.pen << "\n";
+    os << e.getPen(false) << "\n";
 
         os << "variable list:\n";
-	for(auto const& v: e.varList){
-		os << v.first.toLatin1().data()<< ": "
-		   << v.second.toLatin1().data()
+	for(auto const& key: e.getAllKeys()){
+		os << key.toLatin1().data()<< ": "
+		   << e.getUserDefVar(key).toLatin1().data()
 			   << ", ";
 	}
 
@@ -29,8 +29,10 @@
 #ifndef RS_ENTITY_H
 #define RS_ENTITY_H
 
-#include <map>
+#include <atomic>
+
 #include "rs_vector.h"
+#include "lc_pentable.h"
 #include "rs_pen.h"
 #include "rs_undoable.h"
 
@@ -61,6 +63,9 @@ class QString;
 class RS_Entity : public RS_Undoable {
 public:
 	RS_Entity(RS_EntityContainer* parent=nullptr);
+	RS_Entity(const RS_Entity& other);
+	RS_Entity& operator = (const RS_Entity& other);
+	~RS_Entity() override;
 
     void init();
     virtual void initId();
@@ -98,6 +103,34 @@ public:
         return id;
     }
 
+    /**
+     * @return Revision of this entity, a stamp which increases with each change of
+     * this entity or of an entity inside of it. Stamps are unique across entities,
+     * a copy starts with the revision of the original.
+     */
+    unsigned long long getRevision() const {
+        return revision.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Marks this entity and its parents as changed, with a new revision. Called
+     * by the mutators which recalculate the borders of atomic entities, change the
+     * pen, layer or visibility, change the undo state, or add and remove children.
+     */
+    void touch();
+
+    /**
+     * Entities keep their revisions while a RevisionHold exists in the current
+     * thread, for recalculations which do not change any entity.
+     */
+    class RevisionHold {
+    public:
+        RevisionHold();
+        ~RevisionHold();
+        RevisionHold(const RevisionHold&) = delete;
+        RevisionHold& operator = (const RevisionHold&) = delete;
+    };
+
     /**
      * This method must be overwritten in subclasses and return the
      * number of <b>atomic</b> entities in this entity.
@@ -152,7 +185,11 @@ public:
      * attributes such as BY_LAYER, ..
      */
     void setPen(const RS_Pen& pen) {
-        this->pen = pen;
+        const LC_PenTable::Index index = LC_PenTable::intern(pen);
+        if (index != penIndex) {
+            penIndex = index;
+            touch();
+        }
     }
 
 
@@ -600,6 +637,15 @@ m0 x + m1 y + m2 =0
     virtual bool isArcCircleLine() const;
 
 protected:
+    //! auto updating enabled?
+    //! the flags are declared first, to fill the padding after the flags of the base class
+    bool updateEnabled = false;
+    //! user defined variables are rare, they are stored out of line
+    bool hasUserDefVars = false;
+    //! the last known position in the entity list of a container, verified before use
+    mutable int positionHint = -1;
+    friend class RS_EntityContainer;
+
 	//! Entity's parent entity or nullptr is this entity has no parent.
 	RS_EntityContainer* parent = nullptr;
     //! minimum coordinates
@@ -613,14 +659,11 @@ protected:
     //! Entity id
     unsigned long long id = 0;
 
-    //! pen (attributes) for this entity
-    RS_Pen pen;
-
-    //! auto updating enabled?
-    bool updateEnabled = false;
+    //! stamp of the last change, see getRevision(); copies read by other threads share the parents
+    std::atomic<unsigned long long> revision{0};
 
-private:
-    std::map<QString, QString> varList;
+    //! pen (attributes) for this entity, interned in LC_PenTable
+    LC_PenTable::Index penIndex = 0;
 };
 
 #endif
@@ -24,12 +24,18 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <mutex>
 #include <set>
 
 #include <QtGlobal>
+#include "lc_endpointindex.h"
 #include "lc_looputils.h"
+#include "lc_parallel.h"
+#include "lc_rect.h"
+#include "lc_spatialindex.h"
 
 #include "qg_dialogfactory.h"
 
@@ -51,6 +57,23 @@ namespace {
 // the tolerance used to check topology of contours in hatching
 constexpr double contourTolerance = 1e-8;
 
+// containers with fewer entities are searched linearly
+constexpr int spatialIndexMinimumSize = 256;
+
+// guards the lazy building of spatial indices, while drawing threads share containers
+std::mutex spatialIndexMutex;
+
+// number of selected entities measured by a worker at once
+constexpr size_t lengthChunkSize = 1024;
+
+// the window drawn by a view, with a margin for line widths and handles
+std::pair<RS_Vector, RS_Vector> getDrawnWindow(const RS_GraphicView& view)
+{
+    const RS_Vector margin{view.toGraphDX(RS_GraphicView::viewportMargin),
+                           view.toGraphDY(RS_GraphicView::viewportMargin)};
+    return {view.toGraph(0, view.getHeight()) - margin, view.toGraph(view.getWidth(), 0) + margin};
+}
+
 // For validate hatch contours, whether an entity in the contour is a closed
 // loop itself
 bool isClosedLoop(RS_Entity& entity)
@@ -95,14 +118,34 @@ RS_EntityContainer::RS_EntityContainer(RS_EntityContainer* parent,
 
 
 /**
- * Copy constructor. Makes a deep copy of all entities.
+ * Copy constructor. Makes a shallow copy of all entities, detach() is
+ * needed to make a deep copy.
  */
-/*
-RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& ec)
- : RS_Entity(ec) {
+RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& other):
+    RS_Entity(other)
+  , entities{other.entities}
+  , subContainer{other.subContainer}
+  , autoUpdateBorders{other.autoUpdateBorders}
+  , entIdx{other.entIdx}
+  , autoDelete{other.autoDelete}
+  , spatialIndexEnabled{other.spatialIndexEnabled}
+{
+}
 
+RS_EntityContainer& RS_EntityContainer::operator = (const RS_EntityContainer& other)
+{
+    if (this == &other)
+        return *this;
+    RS_Entity::operator = (other);
+    entities = other.entities;
+    subContainer = other.subContainer;
+    autoUpdateBorders = other.autoUpdateBorders;
+    entIdx = other.entIdx;
+    autoDelete = other.autoDelete;
+    spatialIndexEnabled = other.spatialIndexEnabled;
+    invalidateSpatialIndex();
+    return *this;
 }
-*/
 
 
 
@@ -120,7 +163,7 @@ RS_EntityContainer::~RS_EntityContainer() {
 
 
 RS_Entity* RS_EntityContainer::clone() const{
-    RS_DEBUG->print("RS_EntityContainer::clone: ori autoDel: %d",
+    LC_DEBUG_TRACE("RS_EntityContainer::clone: ori autoDel: %d",
                     autoDelete);
 
     RS_EntityContainer* ec = new RS_EntityContainer(getParent(), isOwner());
@@ -132,7 +175,7 @@ RS_Entity* RS_EntityContainer::clone() const{
         ec->entities = entities;
     }
 
-    RS_DEBUG->print("RS_EntityContainer::clone: clone autoDel: %d",
+    LC_DEBUG_TRACE("RS_EntityContainer::clone: clone autoDel: %d",
                     ec->isOwner());
 
     ec->detach();
@@ -150,7 +193,7 @@ RS_Entity* RS_EntityContainer::clone() const{
 void RS_EntityContainer::detach() {
     QList<RS_Entity*> tmp;
     bool autoDel = isOwner();
-    RS_DEBUG->print("RS_EntityContainer::detach: autoDel: %d",
+    LC_DEBUG_TRACE("RS_EntityContainer::detach: autoDel: %d",
                     (int)autoDel);
     setOwner(false);
 
@@ -163,6 +206,7 @@ void RS_EntityContainer::detach() {
 
     // clear shared pointers:
     entities.clear();
+    invalidateSpatialIndex();
     setOwner(autoDel);
 
     // point to new deep copies:
@@ -204,6 +248,7 @@ void RS_EntityContainer::setVisible(bool v) {
  * @return Total length of all entities in this container.
  */
 double RS_EntityContainer::getLength() const {
+    prepareEntities();
     double ret = 0.0;
 
     for(auto e: entities){
@@ -280,50 +325,60 @@ void RS_EntityContainer::setHighlighted(bool on)
  */
 void RS_EntityContainer::selectWindow(enum RS2::EntityType typeToSelect,RS_Vector v1, RS_Vector v2,
                                       bool select, bool cross) {
+    prepareEntities();
 
     bool included;
 
-    for(auto e: entities){
+    // only entities with bounding boxes overlapping the window can be included
+    LC_SpatialIndex* index = getSpatialIndex();
+    const std::vector<RS_Entity*> candidates = (index != nullptr) ? index->queryWindow(v1, v2)
+                                                                  : std::vector<RS_Entity*>{entities.cbegin(), entities.cend()};
+
+    RS_EntityContainer l;
+    if (cross)
+        l.addRectangle(v1, v2);
+
+    // intersections with the window edges count within this tolerance, as in RS_Information::getIntersection()
+    const double crossTolerance = 1.0e-4;
+    const LC_Rect window{v1, v2};
+    const bool hasInside = window.width() > 2. * crossTolerance && window.height() > 2. * crossTolerance;
+    const LC_Rect inside = hasInside ? window.increaseBy(-crossTolerance) : window;
+    auto crossesWindow = [&](RS_Entity* en) {
+        if (en->rtti() == RS2::EntitySolid)
+            return static_cast<RS_Solid*>(en)->isInCrossWindow(v1,v2);
+        // entities away from the edges, outside or inside of the window, can't cross them
+        if (!en->isConstruction(true) && LC_SpatialIndex::hasValidBox(*en)) {
+            const LC_Rect box{en->getMin(), en->getMax()};
+            if (!box.intersects(window, crossTolerance) || (hasInside && box.inArea(inside)))
+                return false;
+        }
+        for (auto line: l) {
+            if (RS_Information::getIntersection(en, line, true).hasValid())
+                return true;
+        }
+        return false;
+    };
+
+    for(auto e: candidates){
 
+        // the estimated borders of deferred entities are not exact
+        if (e->isContainer())
+            static_cast<RS_EntityContainer*>(e)->runDeferredUpdate();
         included = false;
         if (e->isVisible()) {
             if (e->isInWindow(v1, v2)) {
                 //e->setSelected(select);
                 included = true;
             } else if (cross) {
-                RS_EntityContainer l;
-                l.addRectangle(v1, v2);
-                RS_VectorSolutions sol;
-
                 if (e->isContainer()) {
                     RS_EntityContainer* ec = (RS_EntityContainer*)e;
-                    for (RS_Entity* se=ec->firstEntity(RS2::ResolveAll);
-                         se && included==false;
-                         se=ec->nextEntity(RS2::ResolveAll)) {
-
-                        if (se->rtti() == RS2::EntitySolid){
-                            included = static_cast<RS_Solid*>(se)->isInCrossWindow(v1,v2);
-                        } else {
-                            for (auto line: l) {
-                                sol = RS_Information::getIntersection(
-                                            se, line, true);
-                                if (sol.hasValid()) {
-                                    included = true;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                } else if (e->rtti() == RS2::EntitySolid){
-                    included = static_cast<RS_Solid*>(e)->isInCrossWindow(v1,v2);
-                } else {
-                    for (auto line: l) {
-                        sol = RS_Information::getIntersection(e, line, true);
-                        if (sol.hasValid()) {
-                            included = true;
+                    for (RS_Entity* se: ec->getEntityRange(RS2::ResolveAll)) {
+                        included = crossesWindow(se);
+                        if (included)
                             break;
-                        }
                     }
+                } else {
+                    included = crossesWindow(e);
                 }
             }
         }
@@ -367,9 +422,13 @@ void RS_EntityContainer::addEntity(RS_Entity* entity) {
     if (entity->rtti()==RS2::EntityImage ||
             entity->rtti()==RS2::EntityHatch) {
         entities.prepend(entity);
+        insertIntoSpatialIndex(0);
     } else {
         entities.append(entity);
+        entity->positionHint = entities.size() - 1;
+        insertIntoSpatialIndex(entities.size() - 1);
     }
+    touch();
     if (autoUpdateBorders) {
         adjustBorders(entity);
     }
@@ -384,6 +443,9 @@ void RS_EntityContainer::appendEntity(RS_Entity* entity){
     if (!entity)
         return;
     entities.append(entity);
+    entity->positionHint = entities.size() - 1;
+    insertIntoSpatialIndex(entities.size() - 1);
+    touch();
     if (autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -395,6 +457,8 @@ void RS_EntityContainer::appendEntity(RS_Entity* entity){
 void RS_EntityContainer::prependEntity(RS_Entity* entity){
     if (!entity) return;
     entities.prepend(entity);
+    insertIntoSpatialIndex(0);
+    touch();
     if (autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -405,32 +469,49 @@ void RS_EntityContainer::prependEntity(RS_Entity* entity){
  */
 void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *>& entList){
     if (entList.isEmpty()) return;
-    int ci = 0; //current index for insert without invert order
-    bool ret, into = false;
-    RS_Entity *mid = nullptr;
-    if (index < 1) {
-        ci = 0;
-    } else if (index >= entities.size() ) {
-        ci = entities.size() - entList.size();
-    } else {
-        into = true;
-        mid = entities.at(index);
+    const std::unordered_set<RS_Entity*> moving{entList.cbegin(), entList.cend()};
+
+    // one pass: the kept entities, and the insertion point among them
+    QList<RS_Entity*> kept;
+    kept.reserve(entities.size());
+    std::unordered_set<RS_Entity*> found;
+    int ci = -1; //current index for insert without invert order
+    for (int i = 0; i < entities.size(); ++i) {
+        if (i == std::max(index, 0))
+            ci = kept.size();
+        RS_Entity* e = entities.at(i);
+        if (moving.count(e) == 1)
+            found.insert(e);
+        else
+            kept.append(e);
     }
+    if (ci < 0)
+        ci = kept.size();
 
-    for (int i = 0; i < entList.size(); ++i) {
-        RS_Entity *e = entList.at(i);
-        ret = entities.removeOne(e);
-        //if e not exist in entities list remove from entList
-        if (!ret) {
+    //if e not exist in entities list remove from entList
+    std::vector<RS_Entity*> moved;
+    moved.reserve(found.size());
+    for (int i = 0; i < entList.size(); ) {
+        if (found.erase(entList.at(i)) == 1) {
+            moved.push_back(entList.at(i++));
+        } else {
             entList.removeAt(i);
         }
     }
-    if (into) {
-        ci = entities.indexOf(mid);
-    }
 
-    for(auto e: entList){
-        entities.insert(ci++, e);
+    entities.clear();
+    entities.reserve(kept.size() + int(moved.size()));
+    entities.append(kept.mid(0, ci));
+    for (RS_Entity* e: moved)
+        entities.append(e);
+    entities.append(kept.mid(ci));
+
+    // only the draw order keys of the moved entities change
+    if (spatialIndex != nullptr) {
+        const RS_Entity* previous = ci > 0 ? kept.at(ci - 1) : nullptr;
+        const RS_Entity* next = ci < kept.size() ? kept.at(ci) : nullptr;
+        if (!spatialIndex->reorder(moved, previous, next))
+            invalidateSpatialIndex();
     }
 }
 
@@ -442,6 +523,8 @@ void RS_EntityContainer::insertEntity(int index, RS_Entity* entity) {
     if (!entity) return;
 
     entities.insert(index, entity);
+    insertIntoSpatialIndex(index);
+    touch();
 
     if (autoUpdateBorders) {
         adjustBorders(entity);
@@ -479,29 +562,146 @@ bool RS_EntityContainer::removeEntity(RS_Entity* entity) {
     //RLZ TODO: in Q3PtrList if 'entity' is nullptr remove the current item-> at.(entIdx)
     //    and sets 'entIdx' in next() or last() if 'entity' is the last item in the list.
     //    in LibreCAD is never called with nullptr
-    bool ret = entities.removeOne(entity);
+    const int position = positionOf(entity);
+    const bool ret = position >= 0;
+    if (ret) {
+        entities.removeAt(position);
+        touch();
+    }
+    if (ret && spatialIndex) {
+        spatialIndex->remove(entity);
+        removeIndexedEntity(entity);
+    }
+    // the borders only shrink, if the entity was on them
+    const bool onBorders = ret && autoUpdateBorders && isOnBorders(*entity);
 
     if (autoDelete && ret) {
         delete entity;
     }
-    if (autoUpdateBorders) {
-        calculateBorders();
+    if (onBorders) {
+        adjustBordersToChildren();
     }
     return ret;
 }
 
 
 
+int RS_EntityContainer::removeEntities(const std::vector<RS_Entity*>& removed)
+{
+    const auto taken = takeEntities({removed.cbegin(), removed.cend()});
+    bool onBorders = false;
+    for (const auto& [position, entity]: taken) {
+        onBorders = onBorders || (autoUpdateBorders && isOnBorders(*entity));
+        if (autoDelete)
+            delete entity;
+    }
+    if (onBorders)
+        adjustBordersToChildren();
+    return int(taken.size());
+}
+
+int RS_EntityContainer::positionOf(const RS_Entity* entity) const
+{
+    if (entity == nullptr)
+        return -1;
+    const auto isAt = [this, entity]() {
+        const int hint = entity->positionHint;
+        return hint >= 0 && hint < entities.size() && entities.at(hint) == entity;
+    };
+    if (isAt())
+        return entity->positionHint;
+    // entities inserted or removed before this one, one pass to correct the hints of all children
+    if (entity->getParent() == this || entities.size() < 64) {
+        for (int i = 0; i < entities.size(); ++i)
+            entities.at(i)->positionHint = i;
+        return isAt() ? entity->positionHint : -1;
+    }
+    // entities shared by temporary containers
+    return entities.indexOf(const_cast<RS_Entity*>(entity));
+}
+
+std::vector<std::pair<int, RS_Entity*>> RS_EntityContainer::takeEntities(const std::set<RS_Entity*>& taken)
+{
+    std::vector<std::pair<int, RS_Entity*>> ret;
+    if (taken.empty())
+        return ret;
+
+    // a single pass, entities may be taken in bulk from large drawings
+    QList<RS_Entity*> kept;
+    kept.reserve(entities.size());
+    for (int i = 0; i < entities.size(); ++i) {
+        RS_Entity* entity = entities.at(i);
+        if (taken.count(entity) == 1) {
+            ret.emplace_back(i, entity);
+            if (spatialIndex != nullptr) {
+                spatialIndex->remove(entity);
+                removeIndexedEntity(entity);
+            }
+        } else {
+            kept.append(entity);
+        }
+    }
+    entities = std::move(kept);
+    return ret;
+}
+
+void RS_EntityContainer::restoreEntities(std::vector<std::pair<int, RS_Entity*>> restored)
+{
+    if (restored.empty())
+        return;
+    std::sort(restored.begin(), restored.end(),
+              [](const std::pair<int, RS_Entity*>& p0, const std::pair<int, RS_Entity*>& p1) {
+        return p0.first < p1.first;
+    });
+
+    QList<RS_Entity*> merged;
+    merged.reserve(entities.size() + int(restored.size()));
+    std::vector<int> positions;
+    positions.reserve(restored.size());
+    int next = 0;
+    for (const auto& [position, entity]: restored) {
+        while (merged.size() < position && next < entities.size())
+            merged.append(entities.at(next++));
+        positions.push_back(merged.size());
+        merged.append(entity);
+    }
+    while (next < entities.size())
+        merged.append(entities.at(next++));
+    entities = std::move(merged);
+
+    if (spatialIndex == nullptr)
+        return;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const int position = positions[i];
+        // the next neighbor must be indexed already: skip the entities restored after this one
+        int after = position + 1;
+        for (size_t j = i + 1; j < positions.size() && positions[j] == after; ++j)
+            ++after;
+        const RS_Entity* previous = position >= 1 ? entities.at(position - 1) : nullptr;
+        const RS_Entity* following = after < entities.size() ? entities.at(after) : nullptr;
+        if (!spatialIndex->insert(entities.at(position), previous, following)) {
+            invalidateSpatialIndex();
+            return;
+        }
+        addIndexedEntity(entities.at(position));
+    }
+}
+
+
 /**
  * Erases all entities in this container and resets the borders..
  */
 void RS_EntityContainer::clear() {
+    // the children are created again by the caller
+    updateDeferred = false;
     if (autoDelete) {
         while (!entities.isEmpty())
             delete entities.takeFirst();
     } else
         entities.clear();
+    invalidateSpatialIndex();
     resetBorders();
+    touch();
 }
 
 unsigned int RS_EntityContainer::count() const{
@@ -513,6 +713,7 @@ unsigned int RS_EntityContainer::count() const{
  * Counts all entities (leaves of the tree).
  */
 unsigned int RS_EntityContainer::countDeep() const{
+    prepareEntities();
     unsigned int c=0;
     for(auto t: *this){
         c += t->countDeep();
@@ -526,17 +727,27 @@ unsigned int RS_EntityContainer::countDeep() const{
  * Counts the selected entities in this container.
  */
 unsigned RS_EntityContainer::countSelected(bool deep, QList<RS2::EntityType> const& types) {
+    prepareEntities();
     unsigned c=0;
     std::set<RS2::EntityType> type{types.cbegin(), types.cend()};
 
-    for (RS_Entity* t: entities){
-
+    auto countEntity = [&](RS_Entity* t) {
         if (t->isSelected())
 	    if (!types.size() || type.count(t->rtti()))
                 c++;
 
         if (t->isContainer())
             c += static_cast<RS_EntityContainer*>(t)->countSelected(deep);
+    };
+
+    // the selected entities are tracked with the spatial index: only the sub-containers which are
+    // selected themselves are counted into
+    if (getSpatialIndex() != nullptr) {
+        for (RS_Entity* t: getSelectedEntities())
+            countEntity(t);
+    } else {
+        for (RS_Entity* t: entities)
+            countEntity(t);
     }
 
     return c;
@@ -546,19 +757,103 @@ unsigned RS_EntityContainer::countSelected(bool deep, QList<RS2::EntityType> con
  * Counts the selected entities in this container.
  */
 double RS_EntityContainer::totalSelectedLength() {
-    double ret(0.0);
-    for (RS_Entity* e: entities){
+    const std::vector<RS_Entity*> selected = getSelectedEntities();
+    // the lengths by the position in the selection, summed in order for reproducible totals
+    std::vector<double> lengths(selected.size(), 0.);
+    std::vector<size_t> measured;
+    measured.reserve(selected.size());
+    for (size_t i = 0; i < selected.size(); ++i) {
+        RS_Entity* e = selected[i];
+        if (!e->isVisible())
+            continue;
+        // containers may create their subentities on demand, which isn't thread safe.
+        // Polylines are measured from their vertex array.
+        if (e->isContainer() && e->rtti() != RS2::EntityPolyline)
+            lengths[i] = e->getLength();
+        else
+            measured.push_back(i);
+    }
+    LC_Parallel::forEach(measured.size(), lengthChunkSize, [&selected, &measured, &lengths](size_t i) {
+        lengths[measured[i]] = selected[measured[i]]->getLength();
+    });
 
-        if (e->isVisible() && e->isSelected()) {
-            double l = e->getLength();
-            if (l>=0.) {
-                ret += l;
-            }
+    double ret(0.0);
+    for (double l: lengths) {
+        if (l>=0.) {
+            ret += l;
         }
     }
     return ret;
 }
 
+std::vector<RS_Entity*> RS_EntityContainer::getSelectedEntities() const
+{
+    prepareEntities();
+    std::vector<RS_Entity*> selected;
+    const LC_SpatialIndex* index = getSpatialIndex();
+    if (index == nullptr) {
+        for (RS_Entity* e: entities) {
+            if (e->isSelected())
+                selected.push_back(e);
+        }
+        return selected;
+    }
+
+    // entities of hidden layers have the flag, but are not selected
+    for (RS_Entity* e: selectedEntities) {
+        if (e->isSelected())
+            selected.push_back(e);
+    }
+    std::sort(selected.begin(), selected.end(), [index](const RS_Entity* e0, const RS_Entity* e1) {
+        return index->isBefore(e0, e1);
+    });
+    return selected;
+}
+
+
+RS_Entity* RS_EntityContainer::findEntityById(unsigned long long id) const
+{
+    prepareEntities();
+    if (getSpatialIndex() == nullptr) {
+        auto it = std::find_if(entities.cbegin(), entities.cend(), [id](const RS_Entity* e) {
+            return e->getId() == id;
+        });
+        return it != entities.cend() ? *it : nullptr;
+    }
+    auto it = idEntities.find(id);
+    return it != idEntities.end() ? it->second : nullptr;
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getLayerEntities(const RS_Layer* layer) const
+{
+    prepareEntities();
+    std::vector<RS_Entity*> found;
+    const LC_SpatialIndex* index = getSpatialIndex();
+    if (index == nullptr) {
+        for (RS_Entity* e: entities) {
+            if (e->getLayer() == layer)
+                found.push_back(e);
+        }
+        return found;
+    }
+
+    const auto collect = [this, &found](const RS_Layer* key) {
+        auto it = layerEntities.find(key);
+        if (it != layerEntities.end())
+            found.insert(found.end(), it->second.cbegin(), it->second.cend());
+    };
+    collect(layer);
+    // entities without a layer resolve to the layer of this container
+    if (layer != nullptr && getLayer() == layer)
+        collect(nullptr);
+    else if (layer == nullptr && getLayer() != nullptr)
+        found.clear();
+    std::sort(found.begin(), found.end(), [index](const RS_Entity* e0, const RS_Entity* e1) {
+        return index->isBefore(e0, e1);
+    });
+    return found;
+}
+
 
 /**
  * Adjusts the borders of this graphic (max/min values)
@@ -570,10 +865,12 @@ void RS_EntityContainer::adjustBorders(RS_Entity* entity) {
     if (entity) {
         // make sure a container is not empty (otherwise the border
         //   would get extended to 0/0):
-        if (!entity->isContainer() || entity->count()>0) {
+        if (!entity->isContainer() || entity->count()>0
+                || static_cast<RS_EntityContainer*>(entity)->isUpdateDeferred()) {
             minV = RS_Vector::minimum(entity->getMin(),minV);
             maxV = RS_Vector::maximum(entity->getMax(),maxV);
         }
+        updateSpatialIndex(entity);
 
         // Notify parents. The border for the parent might
         // also change TODO: Check for efficiency
@@ -588,8 +885,13 @@ void RS_EntityContainer::adjustBorders(RS_Entity* entity) {
  * Recalculates the borders of this entity container.
  */
 void RS_EntityContainer::calculateBorders() {
-    RS_DEBUG->print("RS_EntityContainer::calculateBorders");
+    LC_DEBUG_TRACE("RS_EntityContainer::calculateBorders");
 
+    // the estimated borders are kept until the children are created
+    if (updateDeferred)
+        return;
+    // recalculating the borders of the children changes none of them
+    const RevisionHold hold;
     resetBorders();
     for (RS_Entity* e: entities){
 
@@ -604,9 +906,97 @@ void RS_EntityContainer::calculateBorders() {
         }
     }
 
-    RS_DEBUG->print("RS_EntityContainer::calculateBorders: size 1: %f,%f",
+    LC_DEBUG_TRACE("RS_EntityContainer::calculateBorders: size 1: %f,%f",
+                    getSize().x, getSize().y);
+
+    fixBorders();
+
+    LC_DEBUG_TRACE("RS_EntityContainer::calculateBorders: size: %f,%f",
                     getSize().x, getSize().y);
 
+    //RS_DEBUG->print("  borders: %f/%f %f/%f", minV.x, minV.y, maxV.x, maxV.y);
+
+    //printf("borders: %lf/%lf  %lf/%lf\n", minV.x, minV.y, maxV.x, maxV.y);
+    //RS_Entity::calculateBorders();
+}
+
+/**
+ * Recalculates the borders of this entity container from the borders of the
+ * entities, which are up to date.
+ */
+void RS_EntityContainer::adjustBordersToChildren() {
+    resetBorders();
+    for (RS_Entity* e: entities) {
+        const RS_Layer* layer = e->getLayer();
+        if (e->isVisible() && !(layer && layer->isFrozen()))
+            adjustBorders(e);
+    }
+    fixBorders();
+}
+
+void RS_EntityContainer::childrenTransformed(const std::vector<RS_Entity*>& children) {
+    for (RS_Entity* e: children)
+        updateSpatialIndex(e);
+    if (autoUpdateBorders)
+        adjustBordersToChildren();
+    if (getParent() != nullptr)
+        getParent()->updateSpatialIndex(this);
+}
+
+void RS_EntityContainer::deferUpdate(const RS_Vector& minBorder, const RS_Vector& maxBorder) {
+    updateDeferred = true;
+    minV = RS_Vector::minimum(minBorder, maxBorder);
+    maxV = RS_Vector::maximum(minBorder, maxBorder);
+    if (getParent() != nullptr)
+        getParent()->updateSpatialIndex(this);
+}
+
+void RS_EntityContainer::runDeferredUpdate() const {
+    if (!updateDeferred)
+        return;
+    // the children are a cache of the entity data
+    auto* self = const_cast<RS_EntityContainer*>(this);
+    self->updateDeferred = false;
+    self->update();
+    if (getParent() != nullptr)
+        getParent()->updateSpatialIndex(self);
+}
+
+void RS_EntityContainer::prepareDraw(const RS_GraphicView& view) {
+    runDeferredUpdate();
+    // the same children as draw() visits, e.g. dimensions in inserts which aren't instanced
+    const LC_SpatialIndex* index = getSpatialIndex();
+    std::vector<RS_Entity*> candidates{entities.cbegin(), entities.cend()};
+    if (index != nullptr) {
+        const auto [vpMin, vpMax] = getDrawnWindow(view);
+        candidates = index->queryWindow(vpMin, vpMax);
+    }
+    for (RS_Entity* e: candidates) {
+        if (e->isContainer())
+            static_cast<RS_EntityContainer*>(e)->prepareDraw(view);
+    }
+}
+
+/**
+ * Whether the entity is counted for the borders of this container, and
+ * touches them.
+ */
+bool RS_EntityContainer::isOnBorders(const RS_Entity& entity) const {
+    const RS_Layer* layer = entity.getLayer();
+    if (!entity.isVisible() || (layer && layer->isFrozen())
+            || (entity.isContainer() && entity.count() == 0
+                && !static_cast<const RS_EntityContainer&>(entity).isUpdateDeferred()))
+        return false;
+    const RS_Vector& eMin = entity.getMin();
+    const RS_Vector& eMax = entity.getMax();
+    return eMin.x <= minV.x + RS_TOLERANCE || eMin.y <= minV.y + RS_TOLERANCE
+            || eMax.x >= maxV.x - RS_TOLERANCE || eMax.y >= maxV.y - RS_TOLERANCE;
+}
+
+/**
+ * Resets invalid borders.
+ */
+void RS_EntityContainer::fixBorders() {
     // needed for correcting corrupt data (PLANS.dxf)
     if (minV.x>maxV.x || minV.x>RS_MAXDOUBLE || maxV.x>RS_MAXDOUBLE
             || minV.x<RS_MINDOUBLE || maxV.x<RS_MINDOUBLE) {
@@ -620,14 +1010,6 @@ void RS_EntityContainer::calculateBorders() {
         minV.y = 0.0;
         maxV.y = 0.0;
     }
-
-    RS_DEBUG->print("RS_EntityContainer::calculateBorders: size: %f,%f",
-                    getSize().x, getSize().y);
-
-    //RS_DEBUG->print("  borders: %f/%f %f/%f", minV.x, minV.y, maxV.x, maxV.y);
-
-    //printf("borders: %lf/%lf  %lf/%lf\n", minV.x, minV.y, maxV.x, maxV.y);
-    //RS_Entity::calculateBorders();
 }
 
 //namespace {
@@ -647,6 +1029,10 @@ void RS_EntityContainer::calculateBorders() {
 void RS_EntityContainer::forcedCalculateBorders() {
     //RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
+    if (updateDeferred)
+        return;
+    // recalculating the borders of the children changes none of them
+    const RevisionHold hold;
     resetBorders();
     for (RS_Entity* e: entities){
 
@@ -660,19 +1046,7 @@ void RS_EntityContainer::forcedCalculateBorders() {
         adjustBorders(e);
     }
 
-    // needed for correcting corrupt data (PLANS.dxf)
-    if (minV.x>maxV.x || minV.x>RS_MAXDOUBLE || maxV.x>RS_MAXDOUBLE
-            || minV.x<RS_MINDOUBLE || maxV.x<RS_MINDOUBLE) {
-
-        minV.x = 0.0;
-        maxV.x = 0.0;
-    }
-    if (minV.y>maxV.y || minV.y>RS_MAXDOUBLE || maxV.y>RS_MAXDOUBLE
-            || minV.y<RS_MINDOUBLE || maxV.y<RS_MINDOUBLE) {
-
-        minV.y = 0.0;
-        maxV.y = 0.0;
-    }
+    fixBorders();
 
     //RS_DEBUG->print("  borders: %f/%f %f/%f", minV.x, minV.y, maxV.x, maxV.y);
 
@@ -688,7 +1062,7 @@ void RS_EntityContainer::forcedCalculateBorders() {
  */
 void RS_EntityContainer::updateDimensions(bool autoText) {
 
-    RS_DEBUG->print("RS_EntityContainer::updateDimensions()");
+    LC_DEBUG_TRACE("RS_EntityContainer::updateDimensions()");
 
     //for (RS_Entity* e=firstEntity(RS2::ResolveNone);
     //        e;
@@ -696,16 +1070,19 @@ void RS_EntityContainer::updateDimensions(bool autoText) {
 
     for (RS_Entity* e: entities){
         if (RS_Information::isDimension(e->rtti())) {
-            // update and reposition label:
-            ((RS_Dimension*)e)->updateDim(autoText);
-        } else if(e->rtti()==RS2::EntityDimLeader)
+            // update and reposition label, when drawn or queried
+            ((RS_Dimension*)e)->invalidateDim(autoText);
+        } else if(e->rtti()==RS2::EntityDimLeader) {
             e->update();
+            updateSpatialIndex(e);
+        }
         else if (e->isContainer()) {
             ((RS_EntityContainer*)e)->updateDimensions(autoText);
+            updateSpatialIndex(e);
         }
     }
 
-    RS_DEBUG->print("RS_EntityContainer::updateDimensions() OK");
+    LC_DEBUG_TRACE("RS_EntityContainer::updateDimensions() OK");
 }
 
 
@@ -715,26 +1092,56 @@ void RS_EntityContainer::updateDimensions(bool autoText) {
  */
 void RS_EntityContainer::updateInserts() {
 
-    std::string idTypeId = std::to_string(getId()) + "/" + std::to_string(rtti());
-    RS_DEBUG->print("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
+    // only used by trace messages
+    const std::string idTypeId = RS_Debug::isEnabled(RS_Debug::D_DEBUGGING)
+            ? std::to_string(getId()) + "/" + std::to_string(rtti()) : std::string{};
+    LC_DEBUG_TRACE("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
 
+    // inserts drawing the compiled geometry of their block, the block is loaded and compiled
+    // once by the first of them, so they are updated by worker threads afterwards
+    std::vector<RS_Insert*> instanced;
     for (RS_Entity* e: entities){
         //// Only update our own inserts and not inserts of inserts
         if (e->rtti()==RS2::EntityInsert  /*&& e->getParent()==this*/) {
-            ((RS_Insert*)e)->update();
-            RS_DEBUG->print("RS_EntityContainer::updateInserts: updated ID/type: %s", idTypeId.c_str());
+            auto* insert = static_cast<RS_Insert*>(e);
+            if (insert->prepareUpdate()) {
+                instanced.push_back(insert);
+                continue;
+            }
+            // entities are only created again, if the block changed
+            if (insert->isUpdateNeeded())
+                insert->update();
+            else
+                insert->calculateBorders();
+            updateSpatialIndex(e);
+            LC_DEBUG_TRACE("RS_EntityContainer::updateInserts: updated ID/type: %s", idTypeId.c_str());
         } else if (e->isContainer()) {
             if (e->rtti()==RS2::EntityHatch) {
-                RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_EntityContainer::updateInserts: skip hatch ID/type: %s", idTypeId.c_str());
+                LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_EntityContainer::updateInserts: skip hatch ID/type: %s", idTypeId.c_str());
             } else {
-                RS_DEBUG->print("RS_EntityContainer::updateInserts: update container ID/type: %s", idTypeId.c_str());
+                LC_DEBUG_TRACE("RS_EntityContainer::updateInserts: update container ID/type: %s", idTypeId.c_str());
                 ((RS_EntityContainer*)e)->updateInserts();
+                updateSpatialIndex(e);
             }
         } else {
-            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_EntityContainer::updateInserts: skip entity ID/type: %s", idTypeId.c_str());
+            LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_EntityContainer::updateInserts: skip entity ID/type: %s", idTypeId.c_str());
         }
     }
-    RS_DEBUG->print("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
+
+    if (!instanced.empty()) {
+        constexpr size_t insertChunkSize = 64;
+        LC_Parallel::forEach(instanced.size(), insertChunkSize, [&instanced](size_t i) {
+            RS_Insert* insert = instanced[i];
+            if (insert->isUpdateNeeded())
+                insert->update();
+            else
+                insert->calculateBorders();
+        });
+        for (RS_Insert* insert: instanced)
+            updateSpatialIndex(insert);
+        adjustBordersToChildren();
+    }
+    LC_DEBUG_TRACE("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
 }
 
 
@@ -745,7 +1152,7 @@ void RS_EntityContainer::updateInserts() {
  */
 void RS_EntityContainer::renameInserts(const QString& oldName,
                                        const QString& newName) {
-    RS_DEBUG->print("RS_EntityContainer::renameInserts()");
+    LC_DEBUG_TRACE("RS_EntityContainer::renameInserts()");
 
     //for (RS_Entity* e=firstEntity(RS2::ResolveNone);
     //        e;
@@ -763,7 +1170,7 @@ void RS_EntityContainer::renameInserts(const QString& oldName,
         }
     }
 
-    RS_DEBUG->print("RS_EntityContainer::renameInserts() OK");
+    LC_DEBUG_TRACE("RS_EntityContainer::renameInserts() OK");
 
 }
 
@@ -772,18 +1179,20 @@ void RS_EntityContainer::renameInserts(const QString& oldName,
  */
 void RS_EntityContainer::updateSplines() {
 
-    RS_DEBUG->print("RS_EntityContainer::updateSplines()");
+    LC_DEBUG_TRACE("RS_EntityContainer::updateSplines()");
 
     for (RS_Entity* e: entities){
         //// Only update our own inserts and not inserts of inserts
         if (e->rtti()==RS2::EntitySpline  /*&& e->getParent()==this*/) {
             e->update();
+            updateSpatialIndex(e);
         } else if (e->isContainer() && e->rtti()!=RS2::EntityHatch) {
             static_cast<RS_EntityContainer*>(e)->updateSplines();
+            updateSpatialIndex(e);
         }
     }
 
-    RS_DEBUG->print("RS_EntityContainer::updateSplines() OK");
+    LC_DEBUG_TRACE("RS_EntityContainer::updateSplines() OK");
 }
 
 
@@ -793,6 +1202,7 @@ void RS_EntityContainer::updateSplines() {
 void RS_EntityContainer::update() {
     for (RS_Entity* e: entities){
         e->update();
+        updateSpatialIndex(e);
     }
 }
 
@@ -804,11 +1214,103 @@ void RS_EntityContainer::addRectangle(RS_Vector const& v0, RS_Vector const& v1)
     addEntity(new RS_Line{this, {v0.x, v1.y}, v0});
 }
 
+LC_EntityRange RS_EntityContainer::getEntityRange(RS2::ResolveLevel level) const
+{
+    return {*this, level};
+}
+
+LC_EntityIterator::LC_EntityIterator(const RS_EntityContainer& container, RS2::ResolveLevel level,
+                                     int first, int last):
+    m_path{{&container, first, last}}
+    , m_level{level}
+{
+    advance();
+}
+
+LC_EntityIterator& LC_EntityIterator::operator++()
+{
+    advance();
+    return *this;
+}
+
+LC_EntityIterator LC_EntityIterator::operator++(int)
+{
+    LC_EntityIterator previous = *this;
+    advance();
+    return previous;
+}
+
+bool LC_EntityIterator::isResolved(const RS_Entity& entity, RS2::ResolveLevel level)
+{
+    if (!entity.isContainer())
+        return false;
+    switch (level) {
+    case RS2::ResolveAllButInserts:
+        return entity.rtti() != RS2::EntityInsert;
+    case RS2::ResolveAllButTexts:
+    case RS2::ResolveAllButTextImage:
+        return entity.rtti() != RS2::EntityText && entity.rtti() != RS2::EntityMText;
+    case RS2::ResolveAll:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void LC_EntityIterator::advance()
+{
+    while (!m_path.empty()) {
+        Position& position = m_path.back();
+        if (position.index >= position.last) {
+            m_path.pop_back();
+            continue;
+        }
+        RS_Entity* entity = position.container->entities.at(position.index++);
+        if (!isResolved(*entity, m_level)) {
+            m_current = entity;
+            return;
+        }
+        const auto* container = static_cast<const RS_EntityContainer*>(entity);
+        container->prepareEntities();
+        m_path.push_back({container, 0, int(container->entities.size())});
+    }
+    m_current = nullptr;
+}
+
+LC_EntityRange::LC_EntityRange(const RS_EntityContainer& container, RS2::ResolveLevel level):
+    m_container{&container}
+    , m_level{level}
+{
+    container.prepareEntities();
+    m_last = int(container.entities.size());
+}
+
+LC_EntityRange::LC_EntityRange(const RS_EntityContainer& container, RS2::ResolveLevel level,
+                               int first, int last):
+    m_container{&container}
+    , m_level{level}
+    , m_first{first}
+    , m_last{last}
+{
+}
+
+std::vector<LC_EntityRange> LC_EntityRange::split(int count) const
+{
+    std::vector<LC_EntityRange> ranges;
+    const int size = m_last - m_first;
+    count = std::min(std::max(count, 1), size);
+    for (int i = 0; i < count; ++i)
+        ranges.push_back({*m_container, m_level, m_first + size * i / count, m_first + size * (i + 1) / count});
+    return ranges;
+}
+
 /**
  * Returns the first entity or nullptr if this graphic is empty.
+ * Keeps the position in the container, see getEntityRange() for nested or concurrent iterations.
  * @param level
  */
 RS_Entity* RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
+    prepareEntities();
     RS_Entity* e = nullptr;
     entIdx = -1;
     switch (level) {
@@ -891,6 +1393,7 @@ RS_Entity* RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
  *              \li \p 2 all Entity Containers are resolved
  */
 RS_Entity* RS_EntityContainer::lastEntity(RS2::ResolveLevel level) const {
+    prepareEntities();
     RS_Entity* e = nullptr;
     if(!entities.size()) return nullptr;
     entIdx = entities.size()-1;
@@ -1148,6 +1651,7 @@ RS_Entity* RS_EntityContainer::prevEntity(RS2::ResolveLevel level) const {
  * @return Entity at the given index or nullptr if the index is out of range.
  */
 RS_Entity* RS_EntityContainer::entityAt(int index) {
+    prepareEntities();
     if (entities.size() > index && index >= 0)
         return entities.at(index);
     else
@@ -1155,10 +1659,15 @@ RS_Entity* RS_EntityContainer::entityAt(int index) {
 }
 
 void RS_EntityContainer::setEntityAt(int index,RS_Entity* en){
+    if (spatialIndex) {
+        spatialIndex->remove(entities.at(index));
+        removeIndexedEntity(entities.at(index));
+    }
     if(autoDelete && entities.at(index)) {
         delete entities.at(index);
     }
     entities[index] = en;
+    insertIntoSpatialIndex(index);
 }
 
 /**
@@ -1174,7 +1683,8 @@ int RS_EntityContainer::entityAt() {
  * Finds the given entity and makes it the current entity if found.
  */
 int RS_EntityContainer::findEntity(RS_Entity const* const entity) {
-    entIdx = entities.indexOf(const_cast<RS_Entity*>(entity));
+    prepareEntities();
+    entIdx = positionOf(entity);
     return entIdx;
 }
 
@@ -1184,26 +1694,45 @@ int RS_EntityContainer::findEntity(RS_Entity const* const entity) {
  */
 RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
                                                  double* dist  )const {
+    prepareEntities();
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist;                 // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
+    RS_Entity* closestEntity = nullptr;
+    // ties are resolved by the entity order, when entities are not visited in order
+    const LC_SpatialIndex* index = getSpatialIndex();
 
-    for (RS_Entity* en: entities){
-
+    auto checkEntity = [&](RS_Entity* en) {
         if (en->isVisible()
                 && !en->getParent()->ignoredOnModification()
                 ){//no end point for Insert, text, Dim
             point = en->getNearestEndpoint(coord, &curDist);
-            if (point.valid && curDist<minDist) {
+            if (point.valid && (curDist<minDist
+                                || (index != nullptr && curDist == minDist && closestEntity != nullptr
+                                    && isBefore(en, closestEntity)))) {
                 closestPoint = point;
+                closestEntity = en;
                 minDist = curDist;
                 if (dist) {
                     *dist = minDist;
                 }
             }
         }
+    };
+
+    if (index != nullptr) {
+        // endpoints are within the bounding boxes
+        index->visitNearest(coord, [&](RS_Entity* en, double boxDistance) {
+            if (boxDistance > minDist)
+                return false;
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (RS_Entity* en: entities)
+            checkEntity(en);
     }
 
     return closestPoint;
@@ -1216,23 +1745,26 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
  */
 RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
                                                  double* dist,  RS_Entity** pEntity)const {
+    prepareEntities();
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist;                 // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-    //QListIterator<RS_Entity> it = createIterator();
-    //RS_Entity* en;
-    //while ( (en = it.current())  ) {
-    //    ++it;
+    RS_Entity* closestEntity = nullptr;
+    // ties are resolved by the entity order, when entities are not visited in order
+    const LC_SpatialIndex* index = getSpatialIndex();
 
-    for(auto en: entities){
+    auto checkEntity = [&](RS_Entity* en) {
         if (!en->getParent()->ignoredOnModification() ){//no end point for Insert, text, Dim
             //            std::cout<<"find nearest for entity "<<i0<<std::endl;
             point = en->getNearestEndpoint(coord, &curDist);
-            if (point.valid && curDist<minDist) {
+            if (point.valid && (curDist<minDist
+                                || (index != nullptr && curDist == minDist && closestEntity != nullptr
+                                    && isBefore(en, closestEntity)))) {
                 closestPoint = point;
+                closestEntity = en;
                 minDist = curDist;
                 if (dist) {
                     *dist = minDist;
@@ -1242,6 +1774,18 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
                 }
             }
         }
+    };
+
+    if (index != nullptr) {
+        index->visitNearest(coord, [&](RS_Entity* en, double boxDistance) {
+            if (boxDistance > minDist)
+                return false;
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (RS_Entity* en: entities)
+            checkEntity(en);
     }
 
     //    std::cout<<__FILE__<<" : "<<__func__<<" : line "<<__LINE__<<std::endl;
@@ -1255,6 +1799,7 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
 
 RS_Vector RS_EntityContainer::getNearestPointOnEntity(const RS_Vector& coord,
                                                       bool onEntity, double* dist, RS_Entity** entity)const {
+    prepareEntities();
 
     RS_Vector point(false);
 
@@ -1273,6 +1818,7 @@ RS_Vector RS_EntityContainer::getNearestPointOnEntity(const RS_Vector& coord,
 
 RS_Vector RS_EntityContainer::getNearestCenter(const RS_Vector& coord,
                                                double* dist) const{
+    prepareEntities();
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
@@ -1303,6 +1849,7 @@ RS_Vector RS_EntityContainer::getNearestMiddle(const RS_Vector& coord,
                                                double* dist,
                                                int middlePoints
                                                ) const{
+    prepareEntities();
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
@@ -1332,6 +1879,7 @@ RS_Vector RS_EntityContainer::getNearestMiddle(const RS_Vector& coord,
 RS_Vector RS_EntityContainer::getNearestDist(double distance,
                                              const RS_Vector& coord,
                                              double* dist) const{
+    prepareEntities();
 
     RS_Vector point(false);
     RS_Entity* closestEntity;
@@ -1352,6 +1900,7 @@ RS_Vector RS_EntityContainer::getNearestDist(double distance,
  */
 RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector& coord,
                                                      double* dist) {
+    prepareEntities();
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
@@ -1362,28 +1911,42 @@ RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector& coord,
 
     closestEntity = getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
 
-    if (closestEntity) {
-        for (RS_Entity* en = firstEntity(RS2::ResolveAllButTextImage);
-             en;
-             en = nextEntity(RS2::ResolveAllButTextImage)) {
-            if (
-                    !en->isVisible()
-                    || en->getParent()->ignoredSnap()
-                    ){
-                continue;
-            }
+    auto checkEntity = [&](RS_Entity* en) {
+        if (
+                !en->isVisible()
+                || en->getParent()->ignoredSnap()
+                ){
+            return;
+        }
 
-            sol = RS_Information::getIntersection(closestEntity,
-                                                  en,
-                                                  true);
+        sol = RS_Information::getIntersection(closestEntity,
+                                              en,
+                                              true);
 
-            point=sol.getClosest(coord,&curDist,nullptr);
-            if(sol.getNumber()>0 && curDist<minDist){
-                closestPoint=point;
-                minDist=curDist;
+        point=sol.getClosest(coord,&curDist,nullptr);
+        if(sol.getNumber()>0 && curDist<minDist){
+            closestPoint=point;
+            minDist=curDist;
+        }
+    };
+
+    const LC_SpatialIndex* index = getSpatialIndex();
+    if (closestEntity && index != nullptr && LC_SpatialIndex::hasValidBox(*closestEntity)) {
+        // intersections are within the bounding boxes of both entities
+        for (RS_Entity* candidate: index->queryWindow(closestEntity->getMin(), closestEntity->getMax())) {
+            const bool resolve = candidate->isContainer()
+                    && candidate->rtti() != RS2::EntityText && candidate->rtti() != RS2::EntityMText;
+            if (!resolve) {
+                checkEntity(candidate);
+                continue;
             }
-
+            auto* ec = static_cast<RS_EntityContainer*>(candidate);
+            for (RS_Entity* en: ec->getEntityRange(RS2::ResolveAllButTextImage))
+                checkEntity(en);
         }
+    } else if (closestEntity) {
+        for (RS_Entity* en: getEntityRange(RS2::ResolveAllButTextImage))
+            checkEntity(en);
     }
     if(dist && closestPoint.valid) {
         *dist = minDist;
@@ -1396,6 +1959,7 @@ RS_Vector RS_EntityContainer::getNearestVirtualIntersection(const RS_Vector& coo
                                                             const double& angle,
                                                             double* dist)
 {
+    prepareEntities();
 
     RS_Vector point;                // endpoint found
     RS_VectorSolutions sol;
@@ -1458,6 +2022,7 @@ RS_Vector RS_EntityContainer::getNearestRef(const RS_Vector& coord,
 
 RS_Vector RS_EntityContainer::getNearestSelectedRef(const RS_Vector& coord,
                                                     double* dist) const{
+    prepareEntities();
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist;                 // currently measured distance
@@ -1486,25 +2051,28 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
                                               RS_Entity** entity,
                                               RS2::ResolveLevel level,
                                               double solidDist) const{
+    prepareEntities();
 
-    RS_DEBUG->print("RS_EntityContainer::getDistanceToPoint");
+    LC_DEBUG_TRACE("RS_EntityContainer::getDistanceToPoint");
 
 
     double minDist = RS_MAXDOUBLE;      // minimum measured distance
     double curDist;                     // currently measured distance
     RS_Entity* closestEntity = nullptr;    // closest entity found
+    RS_Entity* closestTopEntity = nullptr; // the entity in this container, containing closestEntity
     RS_Entity* subEntity = nullptr;
+    // ties are resolved by the entity order, when entities are not visited in order
+    const LC_SpatialIndex* index = getSpatialIndex();
 
-    for(auto e: entities){
-
+    auto checkEntity = [&](RS_Entity* e) {
         if (e->isVisible() && (e->getLayer()==nullptr || !e->getLayer()->isLocked())) {
-            RS_DEBUG->print("entity: getDistanceToPoint");
-            RS_DEBUG->print("entity: %d", e->rtti());
+            LC_DEBUG_TRACE("entity: getDistanceToPoint");
+            LC_DEBUG_TRACE("entity: %d", e->rtti());
             // bug#426, need to ignore Images to find nearest intersections
-            if(level==RS2::ResolveAllButTextImage && e->rtti()==RS2::EntityImage) continue;
+            if(level==RS2::ResolveAllButTextImage && e->rtti()==RS2::EntityImage) return;
             curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
 
-            RS_DEBUG->print("entity: getDistanceToPoint: OK");
+            LC_DEBUG_TRACE("entity: getDistanceToPoint: OK");
 
             /*
              * By using '<=', we will prefer the *last* item in the container if there are multiple
@@ -1515,7 +2083,9 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
              * tend to want to reference entities that they see or have recently drawn as opposed
              * to deeper more forgotten and invisible ones...
              */
-            if (curDist<=minDist)
+            if (curDist<minDist
+                        || (curDist == minDist && (index == nullptr || closestTopEntity == nullptr
+                                               || !isBefore(e, closestTopEntity))))
             {
                 switch(level){
                 case RS2::ResolveAll:
@@ -1525,15 +2095,29 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
                 default:
                     closestEntity = e;
                 }
+                closestTopEntity = e;
                 minDist = curDist;
             }
         }
+    };
+
+    if (index != nullptr) {
+        // the distance to an entity is never shorter than the distance to its bounding box
+        index->visitNearest(coord, [&](RS_Entity* e, double boxDistance) {
+            if (boxDistance > minDist)
+                return false;
+            checkEntity(e);
+            return true;
+        });
+    } else {
+        for (auto e: entities)
+            checkEntity(e);
     }
 
     if (entity) {
         *entity = closestEntity;
     }
-    RS_DEBUG->print("RS_EntityContainer::getDistanceToPoint: OK");
+    LC_DEBUG_TRACE("RS_EntityContainer::getDistanceToPoint: OK");
 
     return minDist;
 }
@@ -1543,8 +2127,9 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
 RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
                                                 double* dist,
                                                 RS2::ResolveLevel level) const{
+    prepareEntities();
 
-    RS_DEBUG->print("RS_EntityContainer::getNearestEntity");
+    LC_DEBUG_TRACE("RS_EntityContainer::getNearestEntity");
 
     RS_Entity* e = nullptr;
 
@@ -1564,7 +2149,7 @@ RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
     if (dist) {
         *dist = d;
     }
-    RS_DEBUG->print("RS_EntityContainer::getNearestEntity: OK");
+    LC_DEBUG_TRACE("RS_EntityContainer::getNearestEntity: OK");
 
     return e;
 }
@@ -1582,11 +2167,12 @@ RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
  * to do: find closed contour by flood-fill
  */
 bool RS_EntityContainer::optimizeContours() {
+    prepareEntities();
     //    std::cout<<"RS_EntityContainer::optimizeContours: begin"<<std::endl;
 
     //    DEBUG_HEADER
     //    std::cout<<"loop with count()="<<count()<<std::endl;
-    RS_DEBUG->print("RS_EntityContainer::optimizeContours");
+    LC_DEBUG_TRACE("RS_EntityContainer::optimizeContours");
 
     RS_EntityContainer tmp;
     tmp.setAutoUpdateBorders(false);
@@ -1619,8 +2205,7 @@ bool RS_EntityContainer::optimizeContours() {
     //    std::cout<<"RS_EntityContainer::optimizeContours: 1"<<std::endl;
 
     /** remove unsupported entities */
-    for(RS_Entity* it: enList)
-        removeEntity(it);
+    removeEntities({enList.cbegin(), enList.cend()});
 
     /** check and form a closed contour **/
     //    std::cout<<"RS_EntityContainer::optimizeContours: 2"<<std::endl;
@@ -1640,47 +2225,47 @@ bool RS_EntityContainer::optimizeContours() {
         vpStart=current->getStartpoint();
         vpEnd=current->getEndpoint();
     }
-    RS_Entity* next = nullptr;
+    // connected endpoints are looked up by hashing, instead of scanning all remaining entities
+    LC_EndpointIndex endpoints{contourTolerance};
+    for (RS_Entity* e: entities)
+        if (e->isVisible())
+            endpoints.insert(e);
     //    std::cout<<"RS_EntityContainer::optimizeContours: 4"<<std::endl;
     /** connect entities **/
     const auto errMsg=QObject::tr("Hatch failed due to a gap=%1 between (%2, %3) and (%4, %5)");
 
     while (count()>0) {
         double dist = 0.;
-        RS_Vector vpTmp=getNearestEndpoint(vpEnd,&dist,&next);
-        if (dist > contourTolerance) {
+        RS_Entity* next = endpoints.getNearest(vpEnd, &dist);
+        if (next == nullptr) {
             if(vpEnd.squaredTo(vpStart) < contourTolerance) {
                 RS_Entity* e2=entityAt(0);
                 tmp.addEntity(e2->clone());
                 vpStart=e2->getStartpoint();
                 vpEnd=e2->getEndpoint();
+                endpoints.remove(e2);
                 removeEntity(e2);
                 continue;
             }
             else {
+                // the gap reported is to the nearest endpoint of all
+                RS_Vector vpTmp=getNearestEndpoint(vpEnd,&dist);
                 QG_DIALOGFACTORY->commandMessage(
                             errMsg.arg(dist).arg(vpTmp.x).arg(vpTmp.y).arg(vpEnd.x).arg(vpEnd.y)
                             );
-                RS_DEBUG->print(RS_Debug::D_ERROR, "RS_EntityContainer::optimizeContours: hatch failed due to a gap");
+                LC_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_EntityContainer::optimizeContours: hatch failed due to a gap");
                 closed=false;
                 break;
             }
         }
-        if(!next) { 	    //workaround if next is nullptr
-            //      	    std::cout<<"RS_EntityContainer::optimizeContours: next is nullptr" <<std::endl;
-            RS_DEBUG->print("RS_EntityContainer::optimizeContours: next is nullptr");
-            //			closed=false;	//workaround if next is nullptr
-            break;			//workaround if next is nullptr
-        } 					//workaround if next is nullptr
-        if(closed) {
-            next->setProcessed(true);
-            RS_Entity* eTmp = next->clone();
-            if(vpEnd.squaredTo(eTmp->getStartpoint())>vpEnd.squaredTo(eTmp->getEndpoint()))
-                eTmp->revertDirection();
-            vpEnd=eTmp->getEndpoint();
-            tmp.addEntity(eTmp);
-            removeEntity(next);
-        }
+        next->setProcessed(true);
+        RS_Entity* eTmp = next->clone();
+        if(vpEnd.squaredTo(eTmp->getStartpoint())>vpEnd.squaredTo(eTmp->getEndpoint()))
+            eTmp->revertDirection();
+        vpEnd=eTmp->getEndpoint();
+        tmp.addEntity(eTmp);
+        endpoints.remove(next);
+        removeEntity(next);
     }
     //    DEBUG_HEADER
     //    if(vpEnd.valid && vpEnd.squaredTo(vpStart) > 1e-8) {
@@ -1701,10 +2286,10 @@ bool RS_EntityContainer::optimizeContours() {
     //    std::cout<<"RS_EntityContainer::optimizeContours: 6"<<std::endl;
 
     if(closed) {
-        RS_DEBUG->print("RS_EntityContainer::optimizeContours: OK");
+        LC_DEBUG_TRACE("RS_EntityContainer::optimizeContours: OK");
     }
     else {
-        RS_DEBUG->print("RS_EntityContainer::optimizeContours: bad");
+        LC_DEBUG_TRACE("RS_EntityContainer::optimizeContours: bad");
     }
     //    std::cout<<"RS_EntityContainer::optimizeContours: end: count()="<<count()<<std::endl;
     //    std::cout<<"RS_EntityContainer::optimizeContours: closed="<<closed<<std::endl;
@@ -1713,6 +2298,7 @@ bool RS_EntityContainer::optimizeContours() {
 
 
 bool RS_EntityContainer::hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2) {
+    prepareEntities();
     for(auto e: entities){
         if (e->hasEndpointsWithinWindow(v1, v2))  {
             return true;
@@ -1724,12 +2310,17 @@ bool RS_EntityContainer::hasEndpointsWithinWindow(const RS_Vector& v1, const RS_
 
 
 void RS_EntityContainer::move(const RS_Vector& offset) {
+    runDeferredUpdate();
+    // the moved borders are exact, unless they weren't valid
+    const bool recalculate = autoUpdateBorders && (entities.isEmpty() || minV.x > maxV.x || minV.y > maxV.y);
     moveBorders(offset);
     for(auto* e: entities){
         e->move(offset);
-        adjustBorders(e);
+        if (!autoUpdateBorders)
+            adjustBorders(e);
     }
-    if (autoUpdateBorders)
+    invalidateSpatialIndex();
+    if (recalculate)
         calculateBorders();
 }
 
@@ -1741,24 +2332,30 @@ void RS_EntityContainer::rotate(const RS_Vector& center, const double& angle) {
 
 
 void RS_EntityContainer::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
+    runDeferredUpdate();
     resetBorders();
 
     for(auto* e: entities){
         e->rotate(center, angleVector);
-        adjustBorders(e);
+        if (!autoUpdateBorders)
+            adjustBorders(e);
     }
+    invalidateSpatialIndex();
     if (autoUpdateBorders)
         calculateBorders();
 }
 
 
 void RS_EntityContainer::scale(const RS_Vector& center, const RS_Vector& factor) {
+    runDeferredUpdate();
     if (std::abs(factor.x)>RS_TOLERANCE && std::abs(factor.y)>RS_TOLERANCE) {
         scaleBorders(center, factor);
         for(auto* e: entities){
             e->scale(center, factor);
-            adjustBorders(e);
+            if (!autoUpdateBorders)
+                adjustBorders(e);
         }
+        invalidateSpatialIndex();
         if (autoUpdateBorders)
             calculateBorders();
     }
@@ -1767,6 +2364,7 @@ void RS_EntityContainer::scale(const RS_Vector& center, const RS_Vector& factor)
 
 
 void RS_EntityContainer::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+    runDeferredUpdate();
     if (axisPoint1.distanceTo(axisPoint2)>RS_TOLERANCE) {
 
         resetBorders();
@@ -1774,13 +2372,16 @@ void RS_EntityContainer::mirror(const RS_Vector& axisPoint1, const RS_Vector& ax
             e->mirror(axisPoint1, axisPoint2);
             adjustBorders(e);
         }
+        invalidateSpatialIndex();
     }
 }
 
 RS_Entity& RS_EntityContainer::shear(double k)
 {
+    prepareEntities();
     for (auto* e: *this)
         e->shear(k);
+    invalidateSpatialIndex();
     calculateBorders();
     return *this;
 }
@@ -1789,15 +2390,20 @@ RS_Entity& RS_EntityContainer::shear(double k)
 void RS_EntityContainer::stretch(const RS_Vector& firstCorner,
                                  const RS_Vector& secondCorner,
                                  const RS_Vector& offset) {
+    prepareEntities();
 
     if (getMin().isInWindow(firstCorner, secondCorner) &&
             getMax().isInWindow(firstCorner, secondCorner)) {
 
         move(offset);
     } else {
-
-        for(auto* e: entities){
+        // only children with bounding boxes overlapping the window have anything to stretch
+        const std::vector<RS_Entity*> candidates = (spatialIndex != nullptr)
+                ? spatialIndex->queryWindow(firstCorner, secondCorner)
+                : std::vector<RS_Entity*>{entities.cbegin(), entities.cend()};
+        for(auto* e: candidates){
             e->stretch(firstCorner, secondCorner, offset);
+            updateSpatialIndex(e);
         }
     }
 
@@ -1809,10 +2415,12 @@ void RS_EntityContainer::stretch(const RS_Vector& firstCorner,
 
 void RS_EntityContainer::moveRef(const RS_Vector& ref,
                                  const RS_Vector& offset) {
+    prepareEntities();
 
     resetBorders();
     for(auto* e: entities){
         e->moveRef(ref, offset);
+        updateSpatialIndex(e);
         adjustBorders(e);
     }
     if (autoUpdateBorders) {
@@ -1823,6 +2431,16 @@ void RS_EntityContainer::moveRef(const RS_Vector& ref,
 
 void RS_EntityContainer::moveSelectedRef(const RS_Vector& ref,
                                          const RS_Vector& offset) {
+    prepareEntities();
+
+    if (spatialIndex != nullptr) {
+        // the index knows the selected children, others have no selected reference points
+        const std::vector<RS_Entity*> selected{selectedEntities.cbegin(), selectedEntities.cend()};
+        for(auto* e: selected)
+            e->moveSelectedRef(ref, offset);
+        childrenTransformed(selected);
+        return;
+    }
 
     resetBorders();
     for(auto* e: entities){
@@ -1835,6 +2453,7 @@ void RS_EntityContainer::moveSelectedRef(const RS_Vector& ref,
 }
 
 void RS_EntityContainer::revertDirection() {
+    prepareEntities();
     // revert entity order in the container
     for(int k = 0; k < entities.size() / 2; ++k) {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 13, 0))
@@ -1843,6 +2462,7 @@ void RS_EntityContainer::revertDirection() {
         entities.swap(k, entities.size() - 1 - k);
 #endif
     }
+    invalidateSpatialIndex();
 
     // revert each entity itself
     for(RS_Entity* entity: entities)
@@ -1851,6 +2471,8 @@ void RS_EntityContainer::revertDirection() {
 
 /**
  * @brief RS_EntityContainer::draw() draw entities in order
+ * On screen, only the entities found by the spatial index within the visible
+ * window are visited. All entities are drawn when printing.
  * @param painter
  * @param view
  */
@@ -1858,8 +2480,18 @@ void RS_EntityContainer::draw(RS_Painter* painter, RS_GraphicView* view, double&
 {
     if (painter == nullptr || view == nullptr)
         return;
+    runDeferredUpdate();
+
+    // printed pages of a drawing tiled on several pages only draw the entities on the page
+    const LC_SpatialIndex* index = getSpatialIndex();
+    if (index == nullptr) {
+        foreach (auto* e, entities)
+            view->drawEntity(painter, e);
+        return;
+    }
 
-    foreach (auto* e, entities)
+    const auto [vpMin, vpMax] = getDrawnWindow(*view);
+    for (RS_Entity* e: index->queryWindow(vpMin, vpMax))
         view->drawEntity(painter, e);
 }
 
@@ -1870,6 +2502,7 @@ void RS_EntityContainer::draw(RS_Painter* painter, RS_GraphicView* view, double&
  */
 double RS_EntityContainer::areaLineIntegral() const
 {
+    prepareEntities();
     //TODO make sure all contour integral is by counter-clockwise
     double contourArea=0.;
     //closed area is always positive
@@ -1899,7 +2532,7 @@ double RS_EntityContainer::areaLineIntegral() const
         if (previousPoint.valid) {
             double distance = endPointDistance(previousPoint, *e);
             if (distance > contourTolerance)
-                RS_DEBUG->print(RS_Debug::D_ERROR, "%s(): contour area calculation maybe incorrect: gap of %lg found at (%lg, %lg)",
+                LC_DEBUG_PRINT(RS_Debug::D_ERROR, "%s(): contour area calculation maybe incorrect: gap of %lg found at (%lg, %lg)",
                                 __func__, distance, previousPoint.x, previousPoint.y);
         }
         // assume the contour is a simple connected loop
@@ -1953,21 +2586,25 @@ bool RS_EntityContainer::ignoredSnap() const
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::begin() const
 {
+    prepareEntities();
     return entities.begin();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::end() const
 {
+    prepareEntities();
     return entities.end();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::begin()
 {
+    prepareEntities();
     return entities.begin();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::end()
 {
+    prepareEntities();
     return entities.end();
 }
 
@@ -2028,23 +2665,135 @@ std::ostream& operator << (std::ostream& os, RS_EntityContainer& ec) {
 }
 
 
+void RS_EntityContainer::setSpatialIndexEnabled(bool enable)
+{
+    spatialIndexEnabled = enable;
+    if (!enable)
+        invalidateSpatialIndex();
+}
+
+LC_SpatialIndex* RS_EntityContainer::getSpatialIndex() const
+{
+    if (!spatialIndexEnabled || entities.size() < spatialIndexMinimumSize)
+        return nullptr;
+    std::lock_guard<std::mutex> lock{spatialIndexMutex};
+    if (spatialIndex == nullptr) {
+        spatialIndex = std::make_unique<LC_SpatialIndex>();
+        spatialIndex->build({entities.cbegin(), entities.cend()});
+        selectedEntities.clear();
+        layerEntities.clear();
+        idEntities.clear();
+        for (RS_Entity* e: entities)
+            addIndexedEntity(e);
+    }
+    return spatialIndex.get();
+}
+
+void RS_EntityContainer::invalidateSpatialIndex()
+{
+    spatialIndex.reset();
+    selectedEntities.clear();
+    layerEntities.clear();
+    idEntities.clear();
+}
+
+void RS_EntityContainer::updateSpatialIndex(RS_Entity* entity) const
+{
+    if (spatialIndex != nullptr)
+        spatialIndex->update(entity);
+}
+
+void RS_EntityContainer::insertIntoSpatialIndex(int position)
+{
+    if (spatialIndex == nullptr || position < 0 || position >= entities.size())
+        return;
+    const RS_Entity* previous = position >= 1 ? entities.at(position - 1) : nullptr;
+    const RS_Entity* next = position + 1 < entities.size() ? entities.at(position + 1) : nullptr;
+    // rebuilt on demand, if the order keys are exhausted
+    if (!spatialIndex->insert(entities.at(position), previous, next))
+        invalidateSpatialIndex();
+    else
+        addIndexedEntity(entities.at(position));
+}
+
+void RS_EntityContainer::addIndexedEntity(RS_Entity* entity) const
+{
+    if (entity->getFlag(RS2::FlagSelected))
+        selectedEntities.insert(entity);
+    layerEntities[entity->getLayer(false)].insert(entity);
+    idEntities[entity->getId()] = entity;
+}
+
+void RS_EntityContainer::removeIndexedEntity(RS_Entity* entity) const
+{
+    selectedEntities.erase(entity);
+    // copies of an entity share its id
+    auto idIt = idEntities.find(entity->getId());
+    if (idIt != idEntities.end() && idIt->second == entity)
+        idEntities.erase(idIt);
+    auto it = layerEntities.find(entity->getLayer(false));
+    if (it == layerEntities.end())
+        return;
+    it->second.erase(entity);
+    if (it->second.empty())
+        layerEntities.erase(it);
+}
+
+void RS_EntityContainer::childSelectionChanged(RS_Entity* child)
+{
+    // clones share the parent, without being in the entity list
+    if (spatialIndex == nullptr || !spatialIndex->contains(child))
+        return;
+    if (child->getFlag(RS2::FlagSelected))
+        selectedEntities.insert(child);
+    else
+        selectedEntities.erase(child);
+}
+
+void RS_EntityContainer::childLayerChanged(RS_Entity* child, const RS_Layer* previous)
+{
+    // clones share the parent, without being in the entity list
+    if (spatialIndex == nullptr || !spatialIndex->contains(child))
+        return;
+    auto it = layerEntities.find(previous);
+    if (it != layerEntities.end()) {
+        it->second.erase(child);
+        if (it->second.empty())
+            layerEntities.erase(it);
+    }
+    layerEntities[child->getLayer(false)].insert(child);
+}
+
+bool RS_EntityContainer::isBefore(const RS_Entity* e0, const RS_Entity* e1) const
+{
+    if (e0 == e1)
+        return false;
+    if (spatialIndex != nullptr)
+        return spatialIndex->isBefore(e0, e1);
+    return entities.indexOf(const_cast<RS_Entity*>(e0)) < entities.indexOf(const_cast<RS_Entity*>(e1));
+}
+
 RS_Entity* RS_EntityContainer::first() const
 {
+    prepareEntities();
     return entities.first();
 }
 
 RS_Entity* RS_EntityContainer::last() const
 {
+    prepareEntities();
     return entities.last();
 }
 
 const QList<RS_Entity*>& RS_EntityContainer::getEntityList()
 {
+    prepareEntities();
     return entities;
 }
 
 std::vector<std::unique_ptr<RS_EntityContainer>> RS_EntityContainer::getLoops() const
 {
+    prepareEntities();
     if (entities.empty())
         return {};
 
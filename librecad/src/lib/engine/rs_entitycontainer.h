@@ -28,11 +28,20 @@
 #ifndef RS_ENTITYCONTAINER_H
 #define RS_ENTITYCONTAINER_H
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include <QList>
 #include "rs_entity.h"
 
+class LC_EntityRange;
+class LC_SpatialIndex;
+
 /**
  * Class representing a tree of entities.
  * Typical entity containers are graphics, polylines, groups, texts, ...)
@@ -45,7 +54,11 @@ class RS_EntityContainer : public RS_Entity {
 public:
 
 	RS_EntityContainer(RS_EntityContainer* parent=nullptr, bool owner=true);
-    //RS_EntityContainer(const RS_EntityContainer& ec);
+    /**
+     * Shallow copy. The spatial index is not copied, the copy builds its own on demand.
+     */
+    RS_EntityContainer(const RS_EntityContainer& other);
+    RS_EntityContainer& operator = (const RS_EntityContainer& other);
 	
 	~RS_EntityContainer() override;
 
@@ -94,6 +107,12 @@ public:
 	virtual void moveEntity(int index, QList<RS_Entity *>& entList);
     virtual void insertEntity(int index, RS_Entity* entity);
     virtual bool removeEntity(RS_Entity* entity);
+    /**
+     * @brief removeEntities - removes the entities in one pass over the entity list, deleting them
+     * if auto delete is enabled. Entities not in this container are ignored.
+     * @return the number of entities removed
+     */
+    virtual int removeEntities(const std::vector<RS_Entity*>& removed);
 
 	//!
 	//! \brief addRectangle add four lines to form a rectangle by
@@ -102,6 +121,11 @@ public:
 	//!
 	void addRectangle(RS_Vector const& v0, RS_Vector const& v1);
 
+    /**
+     * @brief getEntityRange - the entities resolved by the level, for range based loops. Unlike
+     * firstEntity()/nextEntity(), the range keeps no state in the container.
+     */
+    LC_EntityRange getEntityRange(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* nextEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
@@ -127,6 +151,25 @@ public:
 	*/
     virtual unsigned countSelected(bool deep=true, QList<RS2::EntityType> const& types = {});
     virtual double totalSelectedLength();
+    /**
+     * @brief getSelectedEntities - the selected entities of this container, not resolving sub-containers
+     * @return the selected entities in the container order. Containers with a spatial index keep
+     *  track of their selected entities, they are found without scanning the container.
+     */
+    std::vector<RS_Entity*> getSelectedEntities() const;
+    /**
+     * @brief getLayerEntities - the entities of this container on the given layer, not resolving
+     *  sub-containers. Entities without a layer of their own are on the layer of this container.
+     * @return the entities in the container order. Containers with a spatial index keep track of
+     *  the entities of each layer, they are found without scanning the container.
+     */
+    std::vector<RS_Entity*> getLayerEntities(const RS_Layer* layer) const;
+    /**
+     * @brief findEntityById - the entity of this container with the id, not resolving sub-containers
+     * @return the entity, nullptr if there is none. Containers with a spatial index keep track of
+     *  the ids of their entities, they are found without scanning the container.
+     */
+    RS_Entity* findEntityById(unsigned long long id) const;
 
     /**
      * Enables / disables automatic update of borders on entity removals
@@ -135,9 +178,60 @@ public:
     virtual void setAutoUpdateBorders(bool enable) {
         autoUpdateBorders = enable;
     }
+    bool getAutoUpdateBorders() const {
+        return autoUpdateBorders;
+    }
     virtual void adjustBorders(RS_Entity* entity);
+
+    /**
+     * Enables / disables the bounding box spatial index of the entities in this
+     * container. The index is built on demand, once the container holds enough
+     * entities, and is updated by entity additions, removals and border updates.
+     * By default this is turned on.
+     */
+    void setSpatialIndexEnabled(bool enable);
+    bool isSpatialIndexEnabled() const {
+        return spatialIndexEnabled;
+    }
+    /**
+     * @return the spatial index of the entities in this container, or nullptr if
+     *  the index is disabled or the container is too small to benefit from it.
+     */
+    LC_SpatialIndex* getSpatialIndex() const;
+    /**
+     * Discards the spatial index. It's rebuilt on the next query. Must be called
+     * after borders of entities have been changed without notifying the container.
+     */
+    void invalidateSpatialIndex();
 	void calculateBorders() override;
-	void forcedCalculateBorders();
+	virtual void forcedCalculateBorders();
+    /**
+     * @brief adjustBordersToChildren - recalculates the borders from the borders of the
+     * entities, without recalculating those
+     */
+    void adjustBordersToChildren();
+    /**
+     * @brief childrenTransformed - must be called after entities of this container were transformed in
+     * place: updates their spatial index entries and the borders of this container
+     */
+    void childrenTransformed(const std::vector<RS_Entity*>& children);
+    /**
+     * @brief deferUpdate - postpones update() until the container is drawn, transformed, or its
+     * children are accessed. The borders are the given estimate until then, which should enclose
+     * the entities created by update(). update() cancels the deferred update.
+     */
+    void deferUpdate(const RS_Vector& minBorder, const RS_Vector& maxBorder);
+    bool isUpdateDeferred() const {
+        return updateDeferred;
+    }
+    //! runs the update postponed by deferUpdate()
+    void runDeferredUpdate() const;
+    /**
+     * @brief prepareDraw - runs the postponed updates and creates the draw caches of the
+     * container and the nested children visible in the view, so they can be drawn by
+     * concurrent threads afterwards, which only read them
+     */
+    virtual void prepareDraw(const RS_GraphicView& view);
 	void updateDimensions( bool autoText=true);
     virtual void updateInserts();
     virtual void updateSplines();
@@ -248,6 +342,27 @@ protected:
      */
     virtual std::vector<std::unique_ptr<RS_EntityContainer>> getLoops() const;
 
+    /**
+     * @brief prepareEntities - called before the child entities are accessed. Containers creating their
+     * children on demand, like inserts sharing the geometry of their block, create them here.
+     */
+    virtual void prepareEntities() const {
+        runDeferredUpdate();
+    }
+
+    /**
+     * @brief takeEntities - move entities out of the entity list, without deleting them
+     * @param taken - the entities to move out, entities not in the list are ignored
+     * @return the entities moved out, with their positions in the list before, in increasing order
+     */
+    std::vector<std::pair<int, RS_Entity*>> takeEntities(const std::set<RS_Entity*>& taken);
+    /**
+     * @brief restoreEntities - move entities back into the list. This is the exact inverse of
+     * takeEntities(), if the list is in the same state as right after taking the entities.
+     * @param restored - entities with their previous positions, as returned by takeEntities()
+     */
+    void restoreEntities(std::vector<std::pair<int, RS_Entity*>> restored);
+
     /** entities in the container */
     QList<RS_Entity *> entities;
 
@@ -259,8 +374,37 @@ protected:
      * are added or removed.
      */
     bool autoUpdateBorders = true;
+    /** set by deferUpdate(), the children are created by runDeferredUpdate() */
+    bool updateDeferred = false;
 
 private:
+    // whether removing the entity may shrink the borders
+    bool isOnBorders(const RS_Entity& entity) const;
+    // reset corrupt borders
+    void fixBorders();
+    // refresh the spatial index entry after the borders of an entity changed
+    void updateSpatialIndex(RS_Entity* entity) const;
+    // index the entity at the given position of the entity list
+    void insertIntoSpatialIndex(int position);
+    // keep track of the selection and the layer of an indexed entity
+    void addIndexedEntity(RS_Entity* entity) const;
+    void removeIndexedEntity(RS_Entity* entity) const;
+    // the position of the entity in the entity list, -1 if it is not a child.
+    // Positions are looked up by the hints of the entities, renumbered after they were shifted
+    int positionOf(const RS_Entity* entity) const;
+    // for entities found at equal distances, whether e0 is before e1 in this container
+    bool isBefore(const RS_Entity* e0, const RS_Entity* e1) const;
+    // called by RS_Entity::setSelected(), after the selection of a child changed
+    friend class RS_Entity;
+    void childSelectionChanged(RS_Entity* child);
+    // called by RS_Entity::setLayer(), after the layer of a child changed
+    void childLayerChanged(RS_Entity* child, const RS_Layer* previous);
+    // refreshes the spatial index after creating outdated subentities
+    friend class RS_Dimension;
+    // prepares and walks sub containers
+    friend class LC_EntityIterator;
+    friend class LC_EntityRange;
+
 	/**
 	 * @brief ignoredSnap whether snapping is ignored
 	 * @return true when entity of this container won't be considered for snapping points
@@ -268,6 +412,131 @@ private:
 	bool ignoredSnap() const;
     mutable int entIdx = 0;
     bool autoDelete = false;
+
+    bool spatialIndexEnabled = true;
+    mutable std::unique_ptr<LC_SpatialIndex> spatialIndex;
+    // the indexed entities with the selected flag, kept along with the spatial index
+    mutable std::unordered_set<RS_Entity*> selectedEntities;
+    // the indexed entities by their layer, kept along with the spatial index
+    mutable std::unordered_map<const RS_Layer*, std::unordered_set<RS_Entity*>> layerEntities;
+    // the indexed entities by their id, kept along with the spatial index
+    mutable std::unordered_map<unsigned long long, RS_Entity*> idEntities;
+};
+
+/**
+ * @brief The LC_EntityIterator class, visits the entities of a container depth first, resolving sub containers
+ * the same way as firstEntity()/nextEntity() for the resolve level: resolved sub containers are replaced by
+ * their entities, and empty ones are skipped.
+ *
+ * The position is kept by the iterator, so iterations over the same container can be nested, or run from
+ * several threads on separate ranges, as long as the entities are not modified.
+ */
+class LC_EntityIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = RS_Entity*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = RS_Entity* const*;
+    using reference = RS_Entity* const&;
+
+    /** the end iterator */
+    LC_EntityIterator() = default;
+    /** the first entity of the top level entities [first, last) of the container */
+    LC_EntityIterator(const RS_EntityContainer& container, RS2::ResolveLevel level, int first, int last);
+
+    reference operator*() const
+    {
+        return m_current;
+    }
+    LC_EntityIterator& operator++();
+    LC_EntityIterator operator++(int);
+    bool operator==(const LC_EntityIterator& other) const
+    {
+        return m_current == other.m_current;
+    }
+    bool operator!=(const LC_EntityIterator& other) const
+    {
+        return m_current != other.m_current;
+    }
+
+    /** whether the entity is replaced by its children at the level */
+    static bool isResolved(const RS_Entity& entity, RS2::ResolveLevel level);
+
+private:
+    // moves to the next entity, which is not a resolved container
+    void advance();
+
+    struct Position {
+        const RS_EntityContainer* container = nullptr;
+        int index = 0;
+        int last = 0;
+    };
+    // the containers entered, the top level container first
+    std::vector<Position> m_path;
+    RS2::ResolveLevel m_level = RS2::ResolveNone;
+    RS_Entity* m_current = nullptr;
+};
+
+/**
+ * @brief The LC_EntityRange class, the entities of a container resolved by a level, as returned by
+ * RS_EntityContainer::getEntityRange().
+ *
+ * Sub containers creating their children on demand, like inserts, create them when they are reached, which
+ * is not thread safe: prepare them before iterating split ranges from several threads.
+ */
+class LC_EntityRange {
+public:
+    LC_EntityRange(const RS_EntityContainer& container, RS2::ResolveLevel level = RS2::ResolveNone);
+
+    LC_EntityIterator begin() const
+    {
+        return {*m_container, m_level, m_first, m_last};
+    }
+    LC_EntityIterator end() const
+    {
+        return {};
+    }
+
+    /**
+     * @brief split - splits the top level entities into consecutive ranges of similar sizes
+     * @param count - the maximum number of ranges
+     * @return the ranges in the order of the entities, empty for an empty range
+     */
+    std::vector<LC_EntityRange> split(int count) const;
+
+private:
+    LC_EntityRange(const RS_EntityContainer& container, RS2::ResolveLevel level, int first, int last);
+
+    const RS_EntityContainer* m_container = nullptr;
+    RS2::ResolveLevel m_level = RS2::ResolveNone;
+    int m_first = 0;
+    int m_last = 0;
+};
+
+/**
+ * @brief The LC_DeferredBorders class, defers the border updates of a container while a batch
+ * of entities is added or removed. The borders are calculated once, at the end of the scope.
+ */
+class LC_DeferredBorders {
+public:
+    explicit LC_DeferredBorders(RS_EntityContainer& container):
+        m_container{container}
+        , m_autoUpdate{container.getAutoUpdateBorders()}
+    {
+        m_container.setAutoUpdateBorders(false);
+    }
+    ~LC_DeferredBorders()
+    {
+        m_container.setAutoUpdateBorders(m_autoUpdate);
+        if (m_autoUpdate)
+            m_container.calculateBorders();
+    }
+    LC_DeferredBorders(const LC_DeferredBorders&) = delete;
+    LC_DeferredBorders& operator = (const LC_DeferredBorders&) = delete;
+
+private:
+    RS_EntityContainer& m_container;
+    bool m_autoUpdate = true;
 };
 
 #endif
@@ -26,7 +26,13 @@
 
 #include <iostream>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
 #include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QStringConverter>
 #include <QTextStream>
 
@@ -86,7 +92,6 @@ RS_Font::RS_Font(const QString& fileName, bool owner)
     letterSpacing = 3.0;
     wordSpacing = 6.75;
     lineSpacingFactor = 1.0;
-    rawLffFontList.clear();
 }
 
 
@@ -104,10 +109,11 @@ bool RS_Font::loadFont() {
         return true;
     }
 
-    QString path;
+    QString path = this->path;
 
     // Search for the appropriate font if we have only the name of the font:
-    if (!fileName.contains(".cxf", Qt::CaseInsensitive) &&
+    if (path.isEmpty() &&
+        !fileName.contains(".cxf", Qt::CaseInsensitive) &&
         !fileName.contains(".lff", Qt::CaseInsensitive)) {
         QStringList fonts = RS_SYSTEM->getNewFontList();
         fonts.append(RS_SYSTEM->getFontList());
@@ -121,7 +127,7 @@ bool RS_Font::loadFont() {
     }
 
     // We have the full path of the font:
-    else {
+    else if (path.isEmpty()) {
         path = fileName;
     }
 
@@ -313,28 +319,42 @@ void RS_Font::readCXF(QString path) {
     f.close();
 }
 
+/**
+ * Reads the settings of a lff font and where its letters are in the file.
+ * The letters themselves are only read when used, see generateLffFont().
+ * The positions are kept in an index file in the cache directory, so the
+ * font file is scanned only once, until it is modified.
+ */
 void RS_Font::readLFF(QString path) {
-    QString line;
+    lffPath = path;
+    lffGlyphs.clear();
+    if (readLffIndex(path))
+        return;
+    if (scanLFF(path))
+        writeLffIndex(path);
+}
+
+bool RS_Font::scanLFF(const QString& path) {
     QFile f(path);
     encoding = "UTF-8";
-    f.open(QIODevice::ReadOnly);
-    QTextStream ts(&f);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    QStringDecoder decoder(QStringConverter::Utf8);
 
     // Read line by line until we find a new letter:
-    while (!ts.atEnd()) {
-        line = ts.readLine();
-
-        if (line.isEmpty())
+    while (!f.atEnd()) {
+        QByteArray bytes = f.readLine();
+        while (bytes.endsWith('\n') || bytes.endsWith('\r'))
+            bytes.chop(1);
+        if (bytes.isEmpty())
             continue;
 
+        QString line = decoder.decode(bytes);
+
         // Read font settings:
         if (line.at(0)=='#') {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
             QStringList lst =line.remove(0,1).split(':', Qt::SkipEmptyParts);
-#else
-            QStringList lst =line.remove(0,1).split(':', QString::SkipEmptyParts);
-#endif \
-    //if size is < 2 is a comentary not parameter
+            //if size is < 2 is a comentary not parameter
             if (lst.size()<2)
                 continue;
 
@@ -354,7 +374,9 @@ void RS_Font::readLFF(QString path) {
             } else if (identifier.toLower()=="license") {
                 fileLicense = value;
             } else if (identifier.toLower()=="encoding") {
-                ts.setEncoding(QStringConverter::encodingForName(value.toLatin1()).value());
+                auto converter = QStringConverter::encodingForName(value.toLatin1());
+                if (converter)
+                    decoder = QStringDecoder(converter.value());
                 encoding = value;
             } else if (identifier.toLower()=="created") {
                 fileCreate = value;
@@ -371,30 +393,146 @@ void RS_Font::readLFF(QString path) {
                 continue;
             }
 
-            QStringList fontData;
-            do {
-                line = ts.readLine();
-                if(line.isEmpty()) break;
-                fontData.push_back(line);
-            } while(true);
-            if (!fontData.isEmpty()                             // valid data
-                && !rawLffFontList.contains( ch)) {    // ignore duplicates
-                rawLffFontList[ch] = fontData;
+            // the letter data ends at the next empty line
+            LffGlyph glyph;
+            glyph.offset = f.pos();
+            while (!f.atEnd()) {
+                QByteArray data = f.readLine();
+                while (data.endsWith('\n') || data.endsWith('\r'))
+                    data.chop(1);
+                if (data.isEmpty())
+                    break;
+                glyph.length = f.pos() - glyph.offset;
+            }
+            if (glyph.length > 0                 // valid data
+                && !lffGlyphs.contains(ch)) {    // ignore duplicates
+                lffGlyphs[ch] = glyph;
             }
         }
     }
-    f.close();
+    return true;
+}
+
+namespace {
+constexpr quint32 lffIndexMagic = 0x4c434649; // "LCFI"
+constexpr quint32 lffIndexVersion = 1;
+
+// index file of a lff font in the cache directory, named after the font file path
+QString lffIndexPath(const QString& path)
+{
+    const QFileInfo fi(path);
+    const QByteArray hash = QCryptographicHash::hash(fi.absoluteFilePath().toUtf8(),
+                                                     QCryptographicHash::Md5).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/fonts/" + fi.completeBaseName() + "-" + QString::fromLatin1(hash) + ".idx";
+}
+}
+
+/**
+ * Reads the index of a lff font written by writeLffIndex().
+ * @return false, if there is no index or it is older than the font file.
+ */
+bool RS_Font::readLffIndex(const QString& path) {
+    const QFileInfo fi(path);
+    QFile f(lffIndexPath(path));
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0, version = 0;
+    qint64 size = 0, modified = 0;
+    in >> magic >> version >> size >> modified;
+    if (magic != lffIndexMagic || version != lffIndexVersion
+        || size != fi.size() || modified != fi.lastModified().toMSecsSinceEpoch())
+        return false;
+
+    QMap<QString, LffGlyph> glyphs;
+    double letter = 0., word = 0., lineFactor = 0.;
+    QStringList fontNames, fontAuthors;
+    QString license, created, codec;
+    quint32 count = 0;
+    in >> letter >> word >> lineFactor >> fontNames >> fontAuthors
+       >> license >> created >> codec >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        LffGlyph glyph;
+        in >> key >> glyph.offset >> glyph.length;
+        glyphs.insert(key, glyph);
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    letterSpacing = letter;
+    wordSpacing = word;
+    lineSpacingFactor = lineFactor;
+    names = fontNames;
+    authors = fontAuthors;
+    fileLicense = license;
+    fileCreate = created;
+    encoding = codec;
+    lffGlyphs = std::move(glyphs);
+    return true;
+}
+
+void RS_Font::writeLffIndex(const QString& path) const {
+    const QFileInfo fi(path);
+    const QString indexPath = lffIndexPath(path);
+    if (!QDir().mkpath(QFileInfo(indexPath).absolutePath()))
+        return;
+
+    QSaveFile f(indexPath);
+    if (!f.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << lffIndexMagic << lffIndexVersion
+        << qint64(fi.size()) << qint64(fi.lastModified().toMSecsSinceEpoch())
+        << letterSpacing << wordSpacing << lineSpacingFactor << names << authors
+        << fileLicense << fileCreate << encoding << quint32(lffGlyphs.size());
+    for (auto it = lffGlyphs.cbegin(); it != lffGlyphs.cend(); ++it)
+        out << it.key() << it->offset << it->length;
+    if (out.status() == QDataStream::Ok)
+        f.commit();
+    else
+        f.cancelWriting();
+}
+
+/**
+ * @return the lines defining a letter, read from the lff font file.
+ */
+QStringList RS_Font::readLffGlyph(const QString& key) const {
+    const auto it = lffGlyphs.constFind(key);
+    if (it == lffGlyphs.cend())
+        return {};
+
+    QFile f(lffPath);
+    if (!f.open(QIODevice::ReadOnly) || !f.seek(it->offset))
+        return {};
+    const QByteArray bytes = f.read(it->length);
+
+    auto converter = QStringConverter::encodingForName(encoding.toLatin1());
+    QStringDecoder decoder(converter.value_or(QStringConverter::Utf8));
+    QStringList lines = QString(decoder.decode(bytes)).split('\n', Qt::SkipEmptyParts);
+    for (QString& line: lines) {
+        if (line.endsWith('\r'))
+            line.chop(1);
+    }
+    return lines;
 }
 
 void RS_Font::generateAllFonts()
 {
-    for(const QString& key : rawLffFontList.keys())
-        generateLffFont(key);
+    for(const QString& key : lffGlyphs.keys()) {
+        if (letterList.find(key) == nullptr)
+            generateLffFont(key);
+    }
 }
 
 RS_Block* RS_Font::generateLffFont(const QString& key){
 
-    if (!rawLffFontList.contains( key)) {
+    if (!lffGlyphs.contains( key)) {
         RS_DEBUG->print( RS_Debug::D_ERROR, "RS_Font::generateLffFont([%04X]) : can not find the letter in LFF file %s", QChar(key.at(0)), qPrintable(fileName));
         return nullptr;
     }
@@ -405,7 +543,7 @@ RS_Block* RS_Font::generateLffFont(const QString& key){
     // Read entities of this letter:
     QStringList vertex;
     QStringList coords;
-    QStringList fontData = rawLffFontList[key];
+    QStringList fontData = readLffGlyph(key);
     QString line;
 
     while(!fontData.isEmpty()) {
@@ -428,7 +566,7 @@ RS_Block* RS_Font::generateLffFont(const QString& key){
 
             RS_Block* bk = letterList.find(ch);
             if (nullptr == bk) {
-                if (!rawLffFontList.contains(ch)) {
+                if (!lffGlyphs.contains(ch)) {
                     RS_DEBUG->print( RS_Debug::D_ERROR, "RS_Font::generateLffFont([%04X]) : can not find the letter C%04X in LFF file %s", QChar(key.at(0)), uCode, qPrintable(fileName));
                     delete letter;
                     return nullptr;
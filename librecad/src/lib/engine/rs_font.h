@@ -115,11 +115,24 @@ public:
 private:
     void readCXF(QString path);
     void readLFF(QString path);
+    bool scanLFF(const QString& path);
+    bool readLffIndex(const QString& path);
+    void writeLffIndex(const QString& path) const;
+    QStringList readLffGlyph(const QString& key) const;
     RS_Block* generateLffFont(const QString& key);
 
 private:
-    //raw lff font file list, not processed into blocks yet
-    QMap<QString, QStringList> rawLffFontList;
+    //! position of a letter definition in the lff file, in bytes
+    struct LffGlyph {
+        qint64 offset = 0;
+        qint64 length = 0;
+    };
+
+    //lff font file letters, not read and processed into blocks yet
+    QMap<QString, LffGlyph> lffGlyphs;
+
+    //! lff font file the letters are read from
+    QString lffPath;
 
     //! block list (letters)
     RS_BlockList letterList;
@@ -127,6 +140,9 @@ private:
     //! Font file name
     QString fileName;
 
+    //! Font file path, if known; otherwise the font file is searched by name
+    QString path;
+
     //! Font file license
     QString fileLicense;
 
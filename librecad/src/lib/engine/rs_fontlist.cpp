@@ -42,14 +42,27 @@ RS_FontList* RS_FontList::instance() {
 
 
 /**
- * Initializes the font list by creating empty RS_Font 
+ * Initializes the font list by creating empty RS_Font
  * objects, one for each font that could be found.
+ * The font directories are searched in the background, the list
+ * is completed when it is first used.
  */
 void RS_FontList::init() {
     RS_DEBUG->print("RS_FontList::initFonts");
 
-    QStringList list = RS_SYSTEM->getNewFontList();
-    list.append(RS_SYSTEM->getFontList());
+    fonts.clear();
+    fontFiles = RS_SYSTEM->getFileListAsync("fonts", {"lff", "cxf"});
+}
+
+/**
+ * Waits for the font directories searched after init(), and creates the fonts found.
+ */
+void RS_FontList::loadFontList() const {
+    if (!fontFiles.valid())
+        return;
+
+    const QStringList list = fontFiles.get();
+    fontFiles = {};
     QHash<QString, int> added; //used to remember added fonts (avoid duplication)
 
     for (int i = 0; i < list.size(); ++i) {
@@ -58,6 +71,7 @@ void RS_FontList::init() {
         QFileInfo fi( list.at(i) );
         if ( !added.contains(fi.baseName()) ) {
 			fonts.emplace_back(new RS_Font(fi.baseName()));
+            fonts.back()->path = list.at(i);
             added.insert(fi.baseName(), 1);
         }
 
@@ -66,16 +80,19 @@ void RS_FontList::init() {
 }
 
 size_t RS_FontList::countFonts() const{
+	loadFontList();
 	return fonts.size();
 }
 
 std::vector<std::unique_ptr<RS_Font> >::const_iterator RS_FontList::begin() const
 {
+	loadFontList();
 	return fonts.begin();
 }
 
 std::vector<std::unique_ptr<RS_Font> >::const_iterator RS_FontList::end() const
 {
+	loadFontList();
 	return fonts.end();
 }
 
@@ -83,6 +100,7 @@ std::vector<std::unique_ptr<RS_Font> >::const_iterator RS_FontList::end() const
  * Removes all fonts in the fontlist.
  */
 void RS_FontList::clearFonts() {
+	fontFiles = {};
 	fonts.clear();
 }
 
@@ -94,6 +112,7 @@ void RS_FontList::clearFonts() {
 RS_Font* RS_FontList::requestFont(const QString& name) {
     RS_DEBUG->print("RS_FontList::requestFont %s",  name.toLatin1().data());
 
+    std::lock_guard<std::recursive_mutex> lock(requestMutex);
     QString name2 = name.toLower();
     RS_Font* foundFont = nullptr;
     if (name.isEmpty())
@@ -107,6 +126,7 @@ RS_Font* RS_FontList::requestFont(const QString& name) {
     }
 
     RS_DEBUG->print("name2: %s", name2.toLatin1().data());
+    loadFontList();
 
 	// Search our list of available fonts:
 	for( auto const& f: fonts){
@@ -132,6 +152,7 @@ RS_Font* RS_FontList::requestFont(const QString& name) {
 std::ostream& operator << (std::ostream& os, RS_FontList& l) {
 
     os << "Fontlist: \n";
+    l.loadFontList();
 	for(auto const& f: l.fonts){
         os << *f << "\n";
     }
@@ -25,10 +25,13 @@
 **********************************************************************/
 #ifndef RS_FONTLIST_H
 #define RS_FONTLIST_H
+#include <future>
 #include <memory>
+#include <mutex>
 #include <vector>
 
-class QString;
+#include <QStringList>
+
 class RS_Font;
 
 #define RS_FONTLIST RS_FontList::instance()
@@ -60,12 +63,18 @@ public:
     friend std::ostream& operator << (std::ostream& os, RS_FontList& l);
 
 private:
+    void loadFontList() const;
+
     RS_FontList()=default;
     RS_FontList(RS_FontList const&)=delete;
     RS_FontList& operator = (RS_FontList const&)=delete;
     static RS_FontList* uniqueInstance;
+    //! font files, while they are searched for after init()
+    mutable std::shared_future<QStringList> fontFiles;
     //! fonts in the graphic
-    std::vector<std::unique_ptr<RS_Font>> fonts;
+    mutable std::vector<std::unique_ptr<RS_Font>> fonts;
+    //! fonts are requested by drawings imported in worker threads, too
+    std::recursive_mutex requestMutex;
 };
 
 #endif
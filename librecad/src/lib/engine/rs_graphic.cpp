@@ -24,24 +24,60 @@
 **
 **********************************************************************/
 
-#include <iostream>
+#include <chrono>
 #include <cmath>
+#include <iostream>
+#include <memory>
+#include <set>
 
 #include <QDir>
+#include <QSaveFile>
 
 #include "rs_graphic.h"
 
 #include "dxf_format.h"
+#include "lc_attributeschange.h"
+#include "lc_drawingjournal.h"
+#include "lc_endpointindex.h"
 #include "lc_defaults.h"
+#include "lc_transformchange.h"
+#include "lc_undosection.h"
 #include "rs_block.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
+#include "rs_dimension.h"
 #include "rs_fileio.h"
+#include "rs_insert.h"
 #include "rs_layer.h"
 #include "rs_math.h"
+#include "rs_mtext.h"
 #include "rs_settings.h"
+#include "rs_text.h"
+#include "rs_undocycle.h"
 #include "rs_units.h"
 
+namespace {
+/**
+ * @return whether autosave files are written by a worker thread,
+ * setting /Defaults/AutoSaveInBackground
+ */
+bool autoSaveInBackground()
+{
+    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
+    return RS_SETTINGS->readNumEntry("/AutoSaveInBackground", 1) != 0;
+}
+
+/**
+ * @return whether drawings of the format can have journals, the DXF formats
+ */
+bool isJournalFormat(const QString& filename, RS2::FormatType type)
+{
+    if (type == RS2::FormatUnknown)
+        type = RS_FileIO::detectFormat(filename, false);
+    return RS_FileIO::canBufferExport(type);
+}
+}
+
 
 /**
  * Default constructor.
@@ -116,12 +152,8 @@ unsigned long int RS_Graphic::countLayerEntities(RS_Layer* layer) {
     int c=0;
 
 	if (layer) {
-        for(RS_Entity* t: entities){
-
-			if (t->getLayer() &&
-                    t->getLayer()->getName()==layer->getName()) {
-                c+=t->countDeep();
-            }
+        for(RS_Entity* t: getLayerEntities(layer)){
+            c+=t->countDeep();
         }
     }
 
@@ -137,14 +169,8 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 
     if (layer && layer->getName()!="0") {
 
-		std::vector<RS_Entity*> toRemove;
 		//find entities on layer
-        for(RS_Entity* e: entities){
-			if (e->getLayer() &&
-                    e->getLayer()->getName()==layer->getName()) {
-				toRemove.push_back(e);
-            }
-        }
+		std::vector<RS_Entity*> toRemove = getLayerEntities(layer);
 		// remove all entities on that layer:
 		if(toRemove.size()){
 			startUndoCycle();
@@ -160,11 +186,13 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
         // remove all entities in blocks that are on that layer:
 		for(RS_Block* blk: blockList){
 			if(!blk) continue;
+			blk->load();
 			for(auto e: *blk){
 
 				if (e->getLayer() &&
 						e->getLayer()->getName()==layer->getName()) {
 					toRemove.push_back(e);
+					blk->setChanged();
 				}
 			}
 		}
@@ -173,6 +201,8 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 			e->setUndoState(true);
 			e->setLayer("0");
 		}
+		// not undoable, the entities are still kept out of the block lists
+		updateUndoneEntities(toRemove);
 
         layerList.remove(layer);
     }
@@ -187,6 +217,7 @@ void RS_Graphic::newDoc() {
 
     RS_DEBUG->print("RS_Graphic::newDoc");
 
+    journal.reset();
     clear();
 
     clearLayers();
@@ -308,6 +339,19 @@ bool RS_Graphic::save(bool isAutoSave)
 
     RS_DEBUG->print("RS_Graphic::save: Entering...");
 
+    /*	- An autosave file written in background is finished first: a failure
+         *	  is reported by the next autosave, which is skipped while the
+         *	  previous one is still being written.
+         *	----------------------------------------------------------- */
+    if (isAutoSave) {
+        if (!finishBackgroundSave(false))
+            return false;
+        if (backgroundSave.valid())
+            return true;
+    } else {
+        finishBackgroundSave(true);
+    }
+
     /*	- Save drawing file only if it has been modified.
          *	- Notes: Potentially dangerous in case of an internal
          *	  coding error that make LibreCAD not aware of modification
@@ -316,6 +360,7 @@ bool RS_Graphic::save(bool isAutoSave)
 	if (isModified())
     {
 		QString actualName;
+		bool journaled = false;
         RS2::FormatType	actualType;
 
         actualType	= formatType;
@@ -352,9 +397,15 @@ bool RS_Graphic::save(bool isAutoSave)
             }
 
 			actualName = filename;
-            auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
-            if (RS_SETTINGS->readNumEntry("/AutoBackupDocument", 1)!=0)
-                BackupDrawingFile(filename);
+			//	- A journaled save appends the changes to the journal,
+			//	  the drawing file is kept.
+			journaled = journal != nullptr && journal->getFileName() == filename
+                && LC_DrawingJournal::isEnabled() && journal->save();
+            if (!journaled) {
+                auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
+                if (RS_SETTINGS->readNumEntry("/AutoBackupDocument", 1)!=0)
+                    BackupDrawingFile(filename);
+            }
         }
 
         /*	Save drawing file if able to created associated object.
@@ -365,9 +416,20 @@ bool RS_Graphic::save(bool isAutoSave)
             RS_DEBUG->print("RS_Graphic::save: Format: %d", (int) actualType);
             RS_DEBUG->print("RS_Graphic::save: Export...");
 
-			ret = RS_FileIO::instance()->fileExport(*this, actualName, actualType);
-			QFileInfo	finfo(actualName);
-			modifiedTime=finfo.lastModified();
+			if (journaled) {
+				RS_DEBUG->print("RS_Graphic::save: Saved to the journal");
+				ret = true;
+			} else if (isAutoSave && RS_FileIO::canBufferExport(actualType)
+				&& autoSaveInBackground()) {
+				ret = saveInBackground(actualName, actualType);
+				modifiedTime = QDateTime();
+			} else {
+				ret = RS_FileIO::instance()->fileExport(*this, actualName, actualType);
+				QFileInfo	finfo(actualName);
+				modifiedTime=finfo.lastModified();
+				if (ret && !isAutoSave)
+					startJournal(actualName, actualType);
+			}
 			currentFileName=actualName;
 		} else {
             RS_DEBUG->print("RS_Graphic::save: Can't create object!");
@@ -411,6 +473,136 @@ bool RS_Graphic::save(bool isAutoSave)
     return ret;
 }
 
+/**
+ * Writes the autosave file of the drawing in a DXF format: the drawing
+ * is written into memory, the memory is written to the file by a worker
+ * thread, so that slow disks don't block the application.
+ * The result is available from finishBackgroundSave().
+ *
+ * @return false if the drawing could not be written into memory.
+ */
+bool RS_Graphic::saveInBackground(const QString &filename, RS2::FormatType type)
+{
+    RS_DEBUG->print("RS_Graphic::saveInBackground: %s", filename.toLatin1().data());
+
+    auto data = std::make_shared<std::string>();
+    if (!RS_FileIO::instance()->bufferExport(*this, *data, type))
+        return false;
+
+    backgroundSave = std::async(std::launch::async, [filename, data]() {
+        QSaveFile file(filename);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+        const auto size = static_cast<qint64>(data->size());
+        if (file.write(data->data(), size) != size) {
+            file.cancelWriting();
+            return false;
+        }
+        return file.commit();
+    });
+    return true;
+}
+
+
+
+/**
+ * Finishes the autosave file written by saveInBackground().
+ *
+ * @param wait true to wait for the worker thread, false to return
+ *             while it is still writing the file.
+ * @return false if the autosave file could not be written.
+ */
+bool RS_Graphic::finishBackgroundSave(bool wait)
+{
+    if (!backgroundSave.valid())
+        return true;
+    if (!wait && backgroundSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return true;
+    return backgroundSave.get();
+}
+/**
+ * Replays the journal of the drawing file just opened. Changes, which were not
+ * saved, leave the drawing modified.
+ */
+void RS_Graphic::openJournal(const QString &filename, RS2::FormatType type)
+{
+    if (!isJournalFormat(filename, type))
+        return;
+    journal = std::make_unique<LC_DrawingJournal>(*this);
+    const int changes = journal->recover(filename);
+    if (changes > 0) {
+        setModified(true);
+        RS_DIALOGFACTORY->commandMessage(
+            QObject::tr("Recovered %1 changes of the drawing from its journal").arg(changes));
+    }
+    if (!LC_DrawingJournal::isEnabled()) {
+        // the changes of the journal are written with the complete drawing
+        if (changes >= 0)
+            setModified(true);
+        journal.reset();
+    } else if (changes < 0 && !journal->start(filename)) {
+        journal.reset();
+    }
+}
+
+
+
+/**
+ * Starts the journal of the drawing file, which was just written completely.
+ */
+void RS_Graphic::startJournal(const QString &filename, RS2::FormatType type)
+{
+    journal.reset();
+    LC_DrawingJournal::remove(filename);
+    if (!LC_DrawingJournal::isEnabled() || !isJournalFormat(filename, type))
+        return;
+    journal = std::make_unique<LC_DrawingJournal>(*this);
+    if (!journal->start(filename))
+        journal.reset();
+}
+
+
+
+void RS_Graphic::undoCycleChanged(const RS_UndoCycle& cycle)
+{
+    const bool textIndexed = textIndex != nullptr && textRevision == getListRevision();
+    RS_Document::undoCycleChanged(cycle);
+    if (textIndexed) {
+        // the entities of the drawing, which were added, undone or changed
+        const auto update = [this](RS_Entity* entity) {
+            if (entity->getParent() != this)
+                return;
+            if (entity->isUndone())
+                textIndex->remove(entity);
+            else
+                textIndex->insert(entity);
+        };
+        for (RS_Undoable* undoable: cycle.getUndoables()) {
+            switch (undoable->undoRtti()) {
+            case RS2::UndoableEntity:
+                update(static_cast<RS_Entity*>(undoable));
+                break;
+            case RS2::UndoableAttributes:
+                for (RS_Entity* entity: static_cast<LC_AttributesChange*>(undoable)->getEntities())
+                    update(entity);
+                break;
+            case RS2::UndoableTransform:
+                // measured labels of dimensions
+                for (RS_Entity* entity: static_cast<LC_TransformChange*>(undoable)->getEntities())
+                    update(entity);
+                break;
+            default:
+                break;
+            }
+        }
+        textRevision = getListRevision();
+    }
+    if (journal != nullptr)
+        journal->record(cycle);
+}
+
+
+
 
 
 /*
@@ -521,26 +713,13 @@ bool RS_Graphic::loadTemplate(const QString &filename, RS2::FormatType type) {
 bool RS_Graphic::open(const QString &filename, RS2::FormatType type) {
     RS_DEBUG->print("RS_Graphic::open(%s)", filename.toLatin1().data());
 
-        bool ret = false;
-
-    this->filename = filename;
-        QFileInfo finfo(filename);
-        // Construct new autosave filename by prepending # to the filename
-        // part, using the same directory as the destination file.
-        this->autosaveFilename = finfo.path() + "/#" + finfo.fileName();
-
-    // clean all:
-    newDoc();
+    beginOpen(filename);
 
     // import file:
-    ret = RS_FileIO::instance()->fileImport(*this, filename, type);
+    bool ret = RS_FileIO::instance()->fileImport(*this, filename, type);
 
     if( ret) {
-        setModified(false);
-        layerList.setModified(false);
-        blockList.setModified(false);
-        modifiedTime = finfo.lastModified();
-        currentFileName=QString(filename);
+        endOpen(filename, type);
 
         //cout << *((RS_Graphic*)graphic);
         //calculateBorders();
@@ -551,6 +730,38 @@ bool RS_Graphic::open(const QString &filename, RS2::FormatType type) {
     return ret;
 }
 
+void RS_Graphic::beginOpen(const QString &filename) {
+    this->filename = filename;
+    QFileInfo finfo(filename);
+    // Construct new autosave filename by prepending # to the filename
+    // part, using the same directory as the destination file.
+    this->autosaveFilename = finfo.path() + "/#" + finfo.fileName();
+
+    // clean all:
+    newDoc();
+}
+
+void RS_Graphic::endOpen(const QString &filename, RS2::FormatType type) {
+    setModified(false);
+    layerList.setModified(false);
+    blockList.setModified(false);
+    modifiedTime = QFileInfo(filename).lastModified();
+    currentFileName=QString(filename);
+    openJournal(filename, type);
+}
+
+
+bool RS_Graphic::reloadXrefs() {
+    bool reloaded = false;
+    for (RS_Block* block: blockList) {
+        if (block->reloadXref())
+            reloaded = true;
+    }
+    if (reloaded)
+        updateInserts();
+    return reloaded;
+}
+
 
 void RS_Graphic::clearVariables() {
     variableDict.clear();
@@ -996,7 +1207,19 @@ bool RS_Graphic::isBiggerThanPaper() {
 
 void RS_Graphic::addEntity(RS_Entity* entity)
 {
-    RS_EntityContainer::addEntity(entity);
+    // added entities are indexed, if the index is up to date
+    const bool indexed = endpointIndex != nullptr && endpointRevision == getListRevision();
+    const bool textIndexed = textIndex != nullptr && textRevision == getListRevision();
+    RS_Document::addEntity(entity);
+    if (indexed) {
+        if (entity->isAtomic())
+            endpointIndex->insert(entity);
+        endpointRevision = getListRevision();
+    }
+    if (textIndexed) {
+        textIndex->insert(entity);
+        textRevision = getListRevision();
+    }
     if( entity->rtti() == RS2::EntityBlock ||
             entity->rtti() == RS2::EntityContainer){
         RS_EntityContainer* e=static_cast<RS_EntityContainer*>(entity);
@@ -1007,6 +1230,144 @@ void RS_Graphic::addEntity(RS_Entity* entity)
 }
 
 
+const LC_EndpointIndex& RS_Graphic::getEndpointIndex()
+{
+    if (endpointIndex == nullptr || endpointRevision != getListRevision()) {
+        endpointIndex = std::make_unique<LC_EndpointIndex>(endpointTolerance);
+        for (RS_Entity* e: *this) {
+            if (e->isAtomic() && !e->isUndone())
+                endpointIndex->insert(e);
+        }
+        endpointRevision = getListRevision();
+    }
+    return *endpointIndex;
+}
+
+
+std::vector<LC_TextIndex::Match> RS_Graphic::findText(const QString& text, Qt::CaseSensitivity cs)
+{
+    std::vector<LC_TextIndex::Match> matches;
+    if (textIndex == nullptr || textRevision != getListRevision()) {
+        textIndex = std::make_unique<LC_TextIndex>();
+        for (RS_Entity* e: *this) {
+            if (!e->isUndone())
+                textIndex->insert(e);
+        }
+        textRevision = getListRevision();
+    }
+    for (RS_Entity* e: textIndex->find(text, cs))
+        matches.push_back({e, nullptr, {}});
+
+    std::set<const RS_Block*> blocks;
+    for (RS_Block* block: blockList) {
+        // the drawings of external references are not edited here
+        if (block == nullptr || block->isXref())
+            continue;
+        blocks.insert(block);
+        block->load();
+        BlockTextIndex& blockIndex = blockTextIndices[block];
+        if (blockIndex.revision != block->getContentRevision() || blockIndex.revision == 0) {
+            blockIndex.index.clear();
+            for (RS_Entity* e: *block) {
+                if (!e->isUndone())
+                    blockIndex.index.insert(e);
+            }
+            blockIndex.revision = block->getContentRevision();
+        }
+        const std::vector<RS_Entity*> found = blockIndex.index.find(text, cs);
+        if (found.empty())
+            continue;
+        const std::vector<RS_Insert*> inserts = blockList.getInserts(block->getName());
+        for (RS_Entity* e: found)
+            matches.push_back({e, block, inserts});
+    }
+    // removed blocks
+    for (auto it = blockTextIndices.begin(); it != blockTextIndices.end();) {
+        if (blocks.count(it->first) == 0)
+            it = blockTextIndices.erase(it);
+        else
+            ++it;
+    }
+    return matches;
+}
+
+namespace {
+// replaces the text of a copy of the entity, false if the copy shows the same text
+bool replaceIn(RS_Entity* entity, const LC_FindTextData& data)
+{
+    switch (entity->rtti()) {
+    case RS2::EntityText: {
+        auto* text = static_cast<RS_Text*>(entity);
+        const QString replaced = QString{text->getText()}.replace(data.text, data.replacement, data.cs);
+        if (replaced == text->getText())
+            return false;
+        text->setText(replaced);
+        return true;
+    }
+    case RS2::EntityMText: {
+        auto* text = static_cast<RS_MText*>(entity);
+        const QString replaced = text->getText().replace(data.text, data.replacement, data.cs);
+        if (replaced == text->getText())
+            return false;
+        text->setText(replaced);
+        return true;
+    }
+    default: {
+        // labels only, measurements matching the text stay as they are
+        auto* dimension = static_cast<RS_Dimension*>(entity);
+        const QString label = dimension->getLabel(false);
+        const QString replaced = QString{label}.replace(data.text, data.replacement, data.cs);
+        if (replaced == label)
+            return false;
+        dimension->setLabel(replaced);
+        return true;
+    }
+    }
+}
+
+int RS_Graphic::replaceText(const LC_FindTextData& data)
+{
+    if (data.text.isEmpty())
+        return 0;
+
+    std::vector<RS_Entity*> added;
+    std::vector<RS_Entity*> removed;
+    std::set<RS_Insert*> inserts;
+    for (const LC_TextIndex::Match& match: findText(data.text, data.cs)) {
+        RS_Entity* original = match.entity;
+        RS_EntityContainer* parent = original->getParent();
+        if (parent == nullptr || original->isLocked())
+            continue;
+        RS_Entity* clone = original->clone();
+        if (!replaceIn(clone, data)) {
+            delete clone;
+            continue;
+        }
+        clone->update();
+        clone->setSelected(false);
+        // the copy shares the id of the original
+        parent->addEntity(clone);
+        original->setSelected(false);
+        original->setUndoState(true);
+        added.push_back(clone);
+        removed.push_back(original);
+        inserts.insert(match.inserts.cbegin(), match.inserts.cend());
+    }
+    if (added.empty())
+        return 0;
+
+    {
+        // the cycle holds the texts of blocks as well
+        LC_UndoSection undo(this);
+        undo.addUndoables(added);
+        undo.addUndoables(removed);
+    }
+    for (RS_Insert* insert: inserts)
+        insert->update();
+    return int(added.size());
+}
+
+
 /**
  * Dumps the entities to stdout.
  */
@@ -1028,7 +1389,7 @@ int RS_Graphic::clean()
 {
     // author: ravas
 
-    int how_many = 0;
+    std::vector<RS_Entity*> invalid;
 
     foreach (RS_Entity* e, entities)
     {
@@ -1043,11 +1404,10 @@ int RS_Graphic::clean()
             || e->getMin().y < RS_MINDOUBLE
             || e->getMax().y < RS_MINDOUBLE)
         {
-            removeEntity(e);
-            how_many += 1;
+            invalid.push_back(e);
         }
     }
-    return how_many;
+    return removeEntities(invalid);
 }
 
 /**
@@ -29,12 +29,19 @@
 #ifndef RS_GRAPHIC_H
 #define RS_GRAPHIC_H
 
+#include <future>
+#include <map>
+#include <memory>
+
 #include <QDateTime>
+#include "lc_textindex.h"
 #include "rs_blocklist.h"
 #include "rs_layerlist.h"
 #include "rs_variabledict.h"
 #include "rs_document.h"
 
+class LC_DrawingJournal;
+class LC_EndpointIndex;
 class QG_LayerWidget;
 
 /**
@@ -69,6 +76,13 @@ public:
     bool save(bool isAutoSave = false) override;
     bool saveAs(const QString& filename, RS2::FormatType type, bool force = false) override;
     bool open(const QString& filename, RS2::FormatType type) override;
+    /**
+     * The two halves of open() around the import, for files imported
+     * by a worker thread: beginOpen() clears the drawing for the file,
+     * endOpen() marks the imported drawing as unmodified.
+     */
+    void beginOpen(const QString& filename);
+    void endOpen(const QString& filename, RS2::FormatType type);
     bool loadTemplate(const QString &filename, RS2::FormatType type) override;
 
         // Wrappers for Layer functions:
@@ -180,6 +194,12 @@ public:
     void removeBlockListListener(RS_BlockListListener* listener) {
         blockList.removeListener(listener);
     }
+    /**
+     * Loads the external references again, whose drawing files were modified since
+     * they were loaded, and updates their inserts.
+     * @return true, if an external reference changed
+     */
+    bool reloadXrefs();
 
         // Wrappers for variable functions:
     void clearVariables();
@@ -342,11 +362,56 @@ public:
 
     int clean();
 
+    //! endpoints closer than the tolerance are connected
+    static constexpr double endpointTolerance = 1.0e-4;
+    /**
+     * @return the endpoints of the atomic entities of the drawing, to follow the entities
+     * connected by their endpoints. The index is kept up to date while entities are added,
+     * and built again on the first call after other changes of the drawing.
+     */
+    const LC_EndpointIndex& getEndpointIndex();
+    /**
+     * @brief findText - the texts, multi line texts and dimensions showing the text, in the drawing
+     * and in the blocks, with the inserts of the blocks. The words of the texts are indexed on the
+     * first search, the index of the drawing is kept up to date while entities are added and undone.
+     * Blocks are indexed again after they changed, external references are not searched.
+     */
+    std::vector<LC_TextIndex::Match> findText(const QString& text, Qt::CaseSensitivity cs = Qt::CaseInsensitive);
+    /**
+     * @brief replaceText - replaces the text found in the texts, multi line texts and dimension
+     * labels by copies of them, in one undo cycle. Locked entities are kept.
+     * @return the number of entities changed
+     */
+    int replaceText(const LC_FindTextData& data);
+
+protected:
+    void undoCycleChanged(const RS_UndoCycle& cycle) override;
+
 private:
 
         bool BackupDrawingFile(const QString &filename);
+        bool saveInBackground(const QString &filename, RS2::FormatType type);
+        bool finishBackgroundSave(bool wait);
+        void openJournal(const QString &filename, RS2::FormatType type);
+        void startJournal(const QString &filename, RS2::FormatType type);
         QDateTime modifiedTime;
         QString currentFileName; //keep a copy of filename for the modifiedTime
+        //! the autosave file being written by a worker thread
+        std::future<bool> backgroundSave;
+        //! the journal of the drawing file, if saves are journaled
+        std::unique_ptr<LC_DrawingJournal> journal;
+        //! the endpoint index, valid for the drawing revision
+        std::unique_ptr<LC_EndpointIndex> endpointIndex;
+        unsigned long long endpointRevision = 0;
+        //! the text index of the drawing, valid for the drawing revision
+        std::unique_ptr<LC_TextIndex> textIndex;
+        unsigned long long textRevision = 0;
+        //! the text index of each block, valid for the block revision
+        struct BlockTextIndex {
+            unsigned long long revision = 0;
+            LC_TextIndex index;
+        };
+        std::map<const RS_Block*, BlockTextIndex> blockTextIndices;
 
         RS_LayerList layerList;
         RS_BlockList blockList;
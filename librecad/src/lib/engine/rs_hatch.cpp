@@ -23,15 +23,24 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
+#include <unordered_map>
 
+#include <QPainter>
 #include <QPainterPath>
 #include <QBrush>
+#include <QImage>
 #include <QString>
+#include <QTransform>
 
+#include "lc_intersections.h"
 #include "lc_looputils.h"
+#include "lc_parallel.h"
+#include "lc_preparedcontour.h"
+#include "lc_tracing.h"
 
 #include "rs_arc.h"
 #include "rs_circle.h"
@@ -45,11 +54,89 @@
 #include "rs_painter.h"
 #include "rs_pattern.h"
 #include "rs_patternlist.h"
+#include "rs_settings.h"
 
 
 namespace
 {
 
+// number of pattern entities trimmed or tested by a worker thread at once
+constexpr size_t trimChunkSize = 256;
+
+// the angle between the points of the polygons approximating ellipses in solid fills
+constexpr double ellipseStep = M_PI / 90.;
+
+// pattern tiles drawn larger than this are drawn as lines
+constexpr double maxTileSize = 1024.;
+// pattern tiles are drawn at least that large, and shrunk by the brush
+constexpr int minTileSize = 4;
+// pattern tiles drawn smaller than this are drawn as a tone of the pattern color
+constexpr double maxToneTileSize = 2.;
+// the pattern coverage of a tile is measured at this width
+constexpr int toneTileSize = 64;
+
+// the transformation of drawing coordinates into gui coordinates of the view
+QTransform guiTransform(const RS_GraphicView& view)
+{
+    const RS_Vector factor = view.getFactor();
+    const RS_Vector origin = view.toGui(RS_Vector{0., 0.});
+    return QTransform{factor.x, 0., 0., -factor.y, origin.x, origin.y};
+}
+
+// whether pattern hatches are drawn from the pattern definition, instead of as lines
+bool patternTexturesEnabled()
+{
+    return RS_SETTINGS->snapshot().hatchPatternTextures;
+}
+
+/**
+ * @brief renderPatternTile - draws one tile of a pattern into an image, which repeats seamlessly
+ * @param pattern - the pattern entities, between the origin and size
+ * @return the tile, the y axis pointing up
+ */
+std::shared_ptr<QImage> renderPatternTile(const RS_EntityContainer& pattern, const RS_Vector& size,
+                                          int width, int height, const QColor& color)
+{
+    auto tile = std::make_shared<QImage>(width, height, QImage::Format_ARGB32_Premultiplied);
+    tile->fill(Qt::transparent);
+    const double fx = width / size.x;
+    const double fy = height / size.y;
+    auto toTile = [fx, fy, height](const RS_Vector& v) {
+        return QPointF(v.x * fx, height - v.y * fy);
+    };
+
+    QPainter painter(tile.get());
+    painter.setPen(QPen(color, 0.));
+    for (const RS_Entity* e: pattern) {
+        switch (e->rtti()) {
+        case RS2::EntityLine:
+            painter.drawLine(toTile(e->getStartpoint()), toTile(e->getEndpoint()));
+            break;
+        case RS2::EntityArc: {
+            const auto* arc = static_cast<const RS_Arc*>(e);
+            const QPointF center = toTile(arc->getCenter());
+            const double rx = arc->getRadius() * fx;
+            const double ry = arc->getRadius() * fy;
+            const double span = arc->isReversed() ?
+                        -RS_Math::correctAngle(arc->getAngle1() - arc->getAngle2()) :
+                        RS_Math::correctAngle(arc->getAngle2() - arc->getAngle1());
+            painter.drawArc(QRectF(center.x() - rx, center.y() - ry, 2. * rx, 2. * ry),
+                            int(std::lround(RS_Math::rad2deg(arc->getAngle1()) * 16.)),
+                            int(std::lround(RS_Math::rad2deg(span) * 16.)));
+            break;
+        }
+        case RS2::EntityCircle: {
+            const QPointF center = toTile(e->getCenter());
+            painter.drawEllipse(center, e->getRadius() * fx, e->getRadius() * fy);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return tile;
+}
+
 // angular distance corrected for direction and range [0, 2 pi]
 double angularDist(double a, double startAngle, bool reversed) {
     return reversed?
@@ -137,14 +224,20 @@ bool RS_Hatch::validate() {
 
 
 RS_Entity* RS_Hatch::clone() const{
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::clone()");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::clone()");
     RS_Hatch* t = new RS_Hatch(*this);
     t->setOwner(isOwner());
     t->initId();
     t->detach();
+    // the pattern lines are copied, so update() keeps them, unless the clone is changed
+    t->hatch = nullptr;
+    if (hatch != nullptr) {
+        t->hatch = static_cast<RS_EntityContainer*>(hatch->clone());
+        t->hatch->reparent(t);
+        t->addEntity(t->hatch);
+    }
     t->update();
-//    t->hatch = nullptr;
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::clone(): OK");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::clone(): OK");
     return t;
 }
 
@@ -153,7 +246,7 @@ RS_Entity* RS_Hatch::clone() const{
  * @return Number of loops.
  */
 int RS_Hatch::countLoops() const{
-    if (data.solid) {
+    if (data.solid || hatch == nullptr) {
         return count();
     } else {
         return count() - 1;
@@ -168,13 +261,13 @@ bool RS_Hatch::isContainer() const {
  * Recalculates the borders of this hatch.
  */
 void RS_Hatch::calculateBorders() {
-    RS_DEBUG->print("RS_Hatch::calculateBorders");
+    LC_DEBUG_TRACE("RS_Hatch::calculateBorders");
 
     activateContour(true);
 
     RS_EntityContainer::calculateBorders();
 
-        RS_DEBUG->print("RS_Hatch::calculateBorders: size: %f,%f",
+        LC_DEBUG_TRACE("RS_Hatch::calculateBorders: size: %f,%f",
                 getSize().x, getSize().y);
 
     activateContour(false);
@@ -189,79 +282,117 @@ void RS_Hatch::calculateBorders() {
  * Refill hatch with pattern. Move, scale, rotate, trim, etc.
  */
 void RS_Hatch::update() {
+    LC_TRACE_SCOPE("RS_Hatch::update");
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update");
+
+    updateDeferred = false;
+    // the contour may have changed
+    std::atomic_store(&m_contourPath, std::shared_ptr<const QPainterPath>{});
+    m_area = RS_MAXDOUBLE;
 
     updateError = HATCH_OK;
     if (updateRunning) {
-        RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch in updating process");
+        LC_DEBUG_PRINT(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch in updating process");
         return;
     }
 
     if (updateEnabled==false) {
-        RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch forbidden to update");
+        LC_DEBUG_PRINT(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch forbidden to update");
         return;
     }
 
     if (data.solid==true) {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: processing solid hatch");
+        LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: processing solid hatch");
+        // prepare the contours here, so drawing doesn't modify the hatch
+        if (needOptimization==true) {
+            foreach (auto l, entities){
+
+                if (l->rtti()==RS2::EntityContainer) {
+                    RS_EntityContainer* loop = (RS_EntityContainer*)l;
+
+                    loop->optimizeContours();
+                }
+            }
+            needOptimization = false;
+        }
+
+        foreach (auto l, entities){
+            l->setLayer(getLayer());
+
+            if (l->rtti()==RS2::EntityContainer) {
+                for(auto e: *static_cast<RS_EntityContainer*>(l))
+                    e->setLayer(getLayer());
+            }
+        }
         calculateBorders();
         return;
     }
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour has %d loops", count());
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour has %d loops", count());
     updateRunning = true;
 
     // save attributes for the current hatch
     RS_Layer* hatch_layer = this->getLayer();
     RS_Pen hatch_pen = this->getPen();
 
+    // the pattern is kept, unless the contour or the pattern data changed
+    std::vector<double> signature = getContourSignature();
+    const bool deferring = !m_materializing && patternTexturesEnabled();
+    if (!isUndone() && signature == m_contourSignature && data.pattern == m_signaturePattern
+            && (hatch != nullptr || (m_patternDeferred && deferring))) {
+        LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: pattern unchanged");
+        if (hatch != nullptr) {
+            hatch->setPen(hatch_pen);
+            hatch->setLayer(hatch_layer);
+            for (RS_Entity* e: *hatch) {
+                e->setPen(hatch_pen);
+                e->setLayer(hatch_layer);
+            }
+        }
+        forcedCalculateBorders();
+        activateContour(false);
+        updateRunning = false;
+        m_updated = true;
+        return;
+    }
+    m_contourSignature = std::move(signature);
+    m_signaturePattern = data.pattern;
+
     // delete old hatch:
     if (hatch) {
         removeEntity(hatch);
 		hatch = nullptr;
     }
+    m_patternDeferred = false;
+    m_patternTile.reset();
+    std::atomic_store(&m_tileImage, std::shared_ptr<const TileImage>{});
+    m_patternCoverage = -1.;
 
     if (isUndone()) {
-        RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip undone hatch");
+        LC_DEBUG_PRINT(RS_Debug::D_NOTICE, "RS_Hatch::update: skip undone hatch");
         updateRunning = false;
         return;
     }
 
     if (!validate()) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: invalid contour in hatch found");
+        LC_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: invalid contour in hatch found");
         updateRunning = false;
         updateError = HATCH_INVALID_CONTOUR;
         return;
     }
 
-    // search for pattern
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern");
-    std::unique_ptr<RS_Pattern> pat = RS_PATTERNLIST->requestPattern(data.pattern);
+    // search for pattern, scaled and moved to the origin; it is shared by all hatches using it
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern");
+    std::shared_ptr<const RS_Pattern> pat = RS_PATTERNLIST->requestPattern(data.pattern, data.scale, 0.);
     if (pat == nullptr) {
         updateRunning = false;
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: requesting pattern: %s not found", data.pattern.toUtf8().constData());
+        LC_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: requesting pattern: %s not found", data.pattern.toUtf8().constData());
         updateError = HATCH_PATTERN_NOT_FOUND;
         return;
-    } else {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern: OK");
-        // make a working copy of hatch pattern
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cloning pattern");
-        pat.reset((RS_Pattern*)pat->clone());
-        if (pat != nullptr) {
-            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cloning pattern: OK");
-        } else {
-            RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: error while cloning hatch pattern");
-            return;
-        }
     }
-
-    // scale pattern
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: scaling pattern");
-    pat->scale(RS_Vector(0.0,0.0), RS_Vector(data.scale, data.scale));
-    pat->calculateBorders();
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern: OK");
     forcedCalculateBorders();
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: scaling pattern: OK");
 
     std::unique_ptr<RS_Hatch> copy {(RS_Hatch*)this->clone()};
     copy->rotate(RS_Vector(0.0,0.0), -data.angle);
@@ -269,12 +400,11 @@ void RS_Hatch::update() {
 
     // create a pattern over the whole contour.
     RS_Vector pSize = pat->getSize();
-    RS_Vector rot_center=pat->getMin();
 //    RS_Vector cPos = getMin();
     RS_Vector cSize = getSize();
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: pattern size: %f/%f", pSize.x, pSize.y);
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour size: %f/%f", cSize.x, cSize.y);
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: pattern size: %f/%f", pSize.x, pSize.y);
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: contour size: %f/%f", cSize.x, cSize.y);
 
     // check pattern sizes for sanity
     if (cSize.x<1.0e-6 || cSize.y<1.0e-6 ||
@@ -282,17 +412,32 @@ void RS_Hatch::update() {
             cSize.x>RS_MAXDOUBLE-1 || cSize.y>RS_MAXDOUBLE-1 ||
             pSize.x>RS_MAXDOUBLE-1 || pSize.y>RS_MAXDOUBLE-1) {
         updateRunning = false;
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size or pattern size too small");
+        LC_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: contour size or pattern size too small");
         updateError = HATCH_TOO_SMALL;
         return;
     }
     // avoid huge memory consumption:
     else if ( cSize.x* cSize.y/(pSize.x*pSize.y)>1e4) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size too large or pattern size too small");
+        LC_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch::update: contour size too large or pattern size too small");
         updateError = HATCH_AREA_TOO_BIG;
         return;
     }
 
+    // the tile is also kept for the tone of lines denser than the pixels
+    m_patternTile = pat;
+    m_patternTileSize = pSize;
+
+    // drawn from the pattern definition, the lines are only created on demand
+    if (!m_materializing && patternTexturesEnabled()) {
+        m_patternDeferred = true;
+
+        forcedCalculateBorders();
+        activateContour(false);
+        updateRunning = false;
+        m_updated = true;
+        return;
+    }
+
     // calculate pattern pieces quantity
     // find out how many pattern-instances we need in x/y:
     int px1 = (int)floor(copy->getMin().x/pSize.x);
@@ -301,34 +446,41 @@ void RS_Hatch::update() {
     int py2 = (int)ceil(copy->getMax().y/pSize.y);
     RS_Vector dvx=RS_Vector(data.angle)*pSize.x;
     RS_Vector dvy=RS_Vector(data.angle+M_PI*0.5)*pSize.y;
-    pat->rotate(rot_center, data.angle);
-    pat->move(-rot_center);
+    pat = RS_PATTERNLIST->requestPattern(data.pattern, data.scale, data.angle);
 
     RS_EntityContainer tmp;   // container for untrimmed lines
 
     // adding array of patterns to tmp:
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet");
+    // the carpet covers the rotated contour, the pieces outside the contour box are skipped
+    const RS_Vector cMin = getMin();
+    const RS_Vector cMax = getMax();
     for (int px=px1; px<px2; px++) {
 		for (int py=py1; py<py2; py++) {
+            const RS_Vector offset = dvx*px + dvy*py;
 			for(auto e: *pat){
+                const RS_Vector eMin = e->getMin() + offset;
+                const RS_Vector eMax = e->getMax() + offset;
+                if (eMax.x < cMin.x || eMax.y < cMin.y || eMin.x > cMax.x || eMin.y > cMax.y)
+                    continue;
                 RS_Entity* te=e->clone();
-                te->move(dvx*px + dvy*py);
+                te->move(offset);
                 tmp.addEntity(te);
             }
         }
     }
 
     // clean memory
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet: OK");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet: OK");
 
     // cut pattern to contour shape
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet");
     // start for very very long for(auto e: tmp) loop
     RS_EntityContainer tmp2 = trimPattern(tmp);   // container for small cut lines
     // end for very very long for(auto e: tmp) loop
 
     // updating hatch / adding entities that are inside
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet: OK");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet: OK");
 
     // add the hatch pattern entities
     hatch = new RS_EntityContainer(this);
@@ -337,8 +489,12 @@ void RS_Hatch::update() {
     hatch->setFlag(RS2::FlagTemp);
 
     //calculateBorders();
-	for(auto e: tmp2){
-
+    // the contour is queried twice for every piece of the pattern, by worker threads
+    const LC_PreparedContour contour{*this};
+    const std::vector<RS_Entity*> pieces(tmp2.begin(), tmp2.end());
+    std::vector<char> inside(pieces.size(), 0);
+    LC_Parallel::forEach(pieces.size(), trimChunkSize, [&contour, &pieces, &inside](size_t i) {
+        RS_Entity* e = pieces[i];
         RS_Vector middlePoint;
         RS_Vector middlePoint2;
         if (e->rtti()==RS2::EntityLine) {
@@ -359,18 +515,25 @@ void RS_Hatch::update() {
         if (middlePoint.valid) {
             bool onContour=false;
 
-            if (RS_Information::isPointInsideContour(
-                        middlePoint,
-                        this, &onContour) ||
-                    RS_Information::isPointInsideContour(middlePoint2, this)) {
-
-                RS_Entity* te = e->clone();
-                te->setPen(hatch_pen);
-                te->setLayer(hatch_layer);
-                te->reparent(hatch);
-                hatch->addEntity(te);
+            if (contour.isInside(middlePoint, &onContour) ||
+                    contour.isInside(middlePoint2)) {
+                inside[i] = 1;
             }
         }
+    });
+
+    // the pieces inside are moved into the hatch
+    tmp2.setOwner(false);
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        RS_Entity* te = pieces[i];
+        if (inside[i]) {
+            te->setPen(hatch_pen);
+            te->setLayer(hatch_layer);
+            te->reparent(hatch);
+            hatch->addEntity(te);
+        } else {
+            delete te;
+        }
     }
 
     addEntity(hatch);
@@ -384,7 +547,7 @@ void RS_Hatch::update() {
     updateRunning = false;
     m_updated = true;
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
+    LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
 }
 
 
@@ -392,11 +555,35 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
 {
     LC_LOG<<"RS_Hatch::"<<__func__<<": begin";
     RS_EntityContainer trimmed;
-    for(auto* e: patternEntities) {
+
+    // getting all intersections of the pattern lines with the contour at once:
+    std::vector<RS_Entity*> pattern(patternEntities.begin(), patternEntities.end());
+    std::vector<RS_Entity*> contour;
+    foreach(const auto& loop, entities){
+        if (loop->isContainer()) {
+            for(auto p: * static_cast<RS_EntityContainer*>(loop))
+                contour.push_back(p);
+        }
+    }
+    std::unordered_map<const RS_Entity*, QList<RS_Vector>> crossings;
+    for (const LC_Intersection& crossing: LC_Intersections::findBetween(pattern, contour)) {
+        QList<RS_Vector>& is = crossings[crossing.first];
+        for (const RS_Vector& vp: crossing.points) {
+            if (vp.valid) {
+                is.append(vp);
+                LC_DEBUG_PRINT(RS_Debug::D_DEBUGGING, "  pattern line intersection: %f/%f", vp.x, vp.y);
+            }
+        }
+    }
+
+    // the pattern entities are cut into pieces independently, by worker threads
+    std::vector<std::vector<RS_Entity*>> pieces(pattern.size());
+    LC_Parallel::forEach(pattern.size(), trimChunkSize, [&pattern, &crossings, &pieces](size_t index) {
+        RS_Entity* e = pattern[index];
 
         if (!e) {
-            RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Hatch::update: nullptr entity found");
-            continue;
+            LC_DEBUG_PRINT(RS_Debug::D_WARNING, "RS_Hatch::update: nullptr entity found");
+            return;
         }
 
         RS_Line* line = nullptr;
@@ -437,29 +624,14 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
             reversed = ellipse->isReversed();
             break;
         default:
-            continue;
+            return;
         }
 
-        // getting all intersections of this pattern line with the contour:
+        // the intersections of this pattern line with the contour:
         QList<RS_Vector> is;
-
-        foreach(const auto& loop, entities){
-
-            if (loop->isContainer()) {
-                for(auto p: * static_cast<RS_EntityContainer*>(loop)){
-
-                    RS_VectorSolutions sol =
-                        RS_Information::getIntersection(e, p, true);
-
-                    for (const RS_Vector& vp: sol) {
-                        if (vp.valid) {
-                            is.append(vp);
-                            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "  pattern line intersection: %f/%f", vp.x, vp.y);
-                        }
-                    }
-                }
-            }
-        }
+        auto found = crossings.find(e);
+        if (found != crossings.end())
+            is = std::move(found->second);
 
         QList<RS_Vector> is2;       //to be filled with sorted intersections
         is2.append(startPoint);
@@ -469,52 +641,36 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
             is2.append(is.first());
         }
         else if(is.size() > 1) {
-            RS_Vector sp = startPoint;
-            double sa = center.angleTo(sp);
+            double sa = center.angleTo(startPoint);
             if(ellipse )
-                sa=ellipse->getEllipseAngle(sp);
-            bool done = false;
-            double dist = 0.0;
-            RS_Vector av{};
-            RS_Vector last{};
-            do {    // very long while(!done) loop
-                done = true;
-                double minDist = RS_MAXDOUBLE;
-                av.valid = false;
-                for (const RS_Vector& v: is) {
-                    switch(e->rtti()){
-                    case RS2::EntityLine:
-                        dist = sp.distanceTo(v);
-                        break;
-                    case RS2::EntityArc:
-                    case RS2::EntityCircle:
-                        dist = angularDist(center.angleTo(v), sa, reversed);
-                        break;
-                    case RS2::EntityEllipse:
-                        dist = angularDist(ellipse->getEllipseAngle(v), sa, reversed);
-                        break;
-                    default:
-                        break;
-                    }
-
-                    if (dist<minDist) {
-                        minDist = dist;
-                        done = false;
-                        av = v;
-                    }
+                sa=ellipse->getEllipseAngle(startPoint);
+            // the position of an intersection along the pattern entity, from its start point
+            auto position = [&](const RS_Vector& v) {
+                switch(e->rtti()){
+                case RS2::EntityLine:
+                    return startPoint.distanceTo(v);
+                case RS2::EntityEllipse:
+                    return angularDist(ellipse->getEllipseAngle(v), sa, reversed);
+                default:
+                    return angularDist(center.angleTo(v), sa, reversed);
                 }
-
-                // copy to sorted list, removing double points
-                if (!done && av) {
-                    if (last.valid==false || last.distanceTo(av)>RS_TOLERANCE) {
-                        is2.append(av);
-                        last = av;
-                    }
-                    is.removeOne(av);
-
-                    av.valid = false;
+            };
+            std::vector<std::pair<double, RS_Vector>> sorted;
+            sorted.reserve(is.size());
+            for (const RS_Vector& v: is)
+                sorted.emplace_back(position(v), v);
+            std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+
+            // copy to sorted list, removing double points
+            RS_Vector last{false};
+            for (const auto& [dist, v]: sorted) {
+                if (last.valid==false || last.distanceTo(v)>RS_TOLERANCE) {
+                    is2.append(v);
+                    last = v;
                 }
-            } while(!done);
+            }
         }
 
         is2.append(endPoint);
@@ -525,11 +681,11 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
             auto v2 = is2.at(i);
 
             if (line) {
-                trimmed.addEntity(new RS_Line{&trimmed, v1, v2});
+                pieces[index].push_back(new RS_Line{nullptr, v1, v2});
             } else if (arc || circle) {
                 if(fabs(center.angleTo(v2)-center.angleTo(v1)) > RS_TOLERANCE_ANGLE)
                 {//don't create an arc with a too small angle
-                    trimmed.addEntity(new RS_Arc(&trimmed,
+                    pieces[index].push_back(new RS_Arc(nullptr,
                                               RS_ArcData(center,
                                                          center.distanceTo(v1),
                                                          center.angleTo(v1),
@@ -538,39 +694,90 @@ RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntiti
                 }
             }
         }
+    });
+
+    for (const std::vector<RS_Entity*>& entityPieces: pieces) {
+        for (RS_Entity* piece: entityPieces) {
+            piece->reparent(&trimmed);
+            trimmed.addEntity(piece);
+        }
     }
     LC_LOG<<"RS_Hatch::"<<__func__<<": done";
     return trimmed;
 }
 
+/**
+ * @return the geometry of the contour loops with the pattern scale and angle. The pattern
+ * depends on nothing else but the pattern name.
+ */
+std::vector<double> RS_Hatch::getContourSignature() const {
+    std::vector<double> signature{data.scale, data.angle};
+    auto addPoint = [&signature](const RS_Vector& v) {
+        signature.push_back(v.x);
+        signature.push_back(v.y);
+    };
+    foreach (auto l, entities){
+        if (l->rtti()!=RS2::EntityContainer || l->getFlag(RS2::FlagTemp))
+            continue;
+        const auto* loop = static_cast<const RS_EntityContainer*>(l);
+        signature.push_back(loop->count());
+        for (const RS_Entity* e: *loop) {
+            signature.push_back(e->rtti());
+            addPoint(e->getStartpoint());
+            addPoint(e->getEndpoint());
+            addPoint(e->getCenter());
+            signature.push_back(e->getRadius());
+            addPoint(e->getMin());
+            addPoint(e->getMax());
+        }
+    }
+    return signature;
+}
+
+void RS_Hatch::materializePattern() {
+    runDeferredUpdate();
+    if (!m_patternDeferred)
+        return;
+    m_materializing = true;
+    update();
+    m_materializing = false;
+}
+
 /**
  * Activates of deactivates the hatch boundary.
  */
 void RS_Hatch::activateContour(bool on) {
-        RS_DEBUG->print("RS_Hatch::activateContour: %d", (int)on);
+        LC_DEBUG_TRACE("RS_Hatch::activateContour: %d", (int)on);
         foreach(auto* e, entities){
         if (!e->isUndone()) {
             if (!e->getFlag(RS2::FlagTemp)) {
-                                RS_DEBUG->print("RS_Hatch::activateContour: set visible");
+                                LC_DEBUG_TRACE("RS_Hatch::activateContour: set visible");
                 e->setVisible(on);
             }
                         else {
-                                RS_DEBUG->print("RS_Hatch::activateContour: entity temp");
+                                LC_DEBUG_TRACE("RS_Hatch::activateContour: entity temp");
                         }
         }
                 else {
-                        RS_DEBUG->print("RS_Hatch::activateContour: entity undone");
+                        LC_DEBUG_TRACE("RS_Hatch::activateContour: entity undone");
                 }
     }
-        RS_DEBUG->print("RS_Hatch::activateContour: OK");
+        LC_DEBUG_TRACE("RS_Hatch::activateContour: OK");
 }
 
 /**
  * Overrides drawing of subentities. This is only ever called for solid fills.
  */
 void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
+    runDeferredUpdate();
 
     if (!data.solid) {
+        if (drawPatternTone(painter, view))
+            return;
+        if (m_patternDeferred && drawPatternTiles(painter, view))
+            return;
+        // printing or zoomed in far
+        materializePattern();
         foreach (auto se, entities){
 
             view->drawEntity(painter,se);
@@ -578,128 +785,229 @@ void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*pattern
         return;
     }
 
-    //area of solid fill. Use polygon approximation, except trivial cases
-    QPainterPath path;
-    QList<QPolygon> paClosed;
-    QPolygon pa;
+    //bug#474, restore brush after solid fill
+    const QBrush brush(painter->brush());
+    const RS_Pen pen=painter->getPen();
+    painter->setBrush(pen.getColor());
+    painter->disablePen();
+    painter->drawPath(guiTransform(*view).map(*getContourPath()));
+    painter->setBrush(brush);
+    painter->setPen(pen);
+}
 
-    if (needOptimization==true) {
-        foreach (auto l, entities){
+/**
+ * Creates the pattern lines, if the view draws them, the pattern tone and the contour
+ * path, before the hatch is drawn by several threads. Only the tile image depends on
+ * the pen, it's replaced atomically while drawing.
+ */
+void RS_Hatch::prepareDraw(const RS_GraphicView& view) {
+    runDeferredUpdate();
+    if (!data.solid) {
+        if (isDrawnAsTone(view))
+            measurePatternCoverage();
+        else if (!(m_patternDeferred && isDrawnAsTiles(view)))
+            materializePattern();
+    }
+    getContourPath();
+    RS_EntityContainer::prepareDraw(view);
+}
 
-            if (l->rtti()==RS2::EntityContainer) {
-                RS_EntityContainer* loop = (RS_EntityContainer*)l;
+bool RS_Hatch::isDrawnAsTiles(const RS_GraphicView& view) const {
+    if (m_patternTile == nullptr || view.isPrinting() || view.isPrintPreview())
+        return false;
+    const double factor = view.getFactor().x;
+    return m_patternTileSize.x * factor <= maxTileSize && m_patternTileSize.y * factor <= maxTileSize;
+}
 
-                loop->optimizeContours();
-            }
-        }
-        needOptimization = false;
-    }
+bool RS_Hatch::isDrawnAsTone(const RS_GraphicView& view) const {
+    if (m_patternTile == nullptr || view.isPrinting() || view.isPrintPreview())
+        return false;
+    const double factor = view.getFactor().x;
+    return std::max(m_patternTileSize.x, m_patternTileSize.y) * factor < maxToneTileSize;
+}
 
-    foreach (auto l, entities){
-        l->setLayer(getLayer());
+/**
+ * Draws a deferred pattern hatch by filling the contour with a texture of a pattern tile.
+ *
+ * @return false, if the pattern needs to be drawn as lines
+ */
+bool RS_Hatch::drawPatternTiles(RS_Painter* painter, RS_GraphicView* view) {
+    if (!isDrawnAsTiles(*view))
+        return false;
 
-        if (l->rtti()==RS2::EntityContainer) {
-            RS_EntityContainer* loop = (RS_EntityContainer*)l;
+    const double factor = view->getFactor().x;
+    const double width = m_patternTileSize.x * factor;
+    const double height = m_patternTileSize.y * factor;
 
-            // edges:
-            for(auto e: *loop){
-
-                e->setLayer(getLayer());
-                switch (e->rtti()) {
-                case RS2::EntityLine: {
-                    QPoint pt1(RS_Math::round(view->toGuiX(e->getStartpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getStartpoint().y)));
-                    QPoint pt2(RS_Math::round(view->toGuiX(e->getEndpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getEndpoint().y)));
-
-                    if(!pa.size() || (pa.last() - pt1).manhattanLength() >= 1) {
-                        pa << pt1;
-                    }
-                    pa << pt2;
-                }
-                    break;
+    // threads drawing with other pens replace the tile of each other, but never change it
+    const RS_Pen pen=painter->getPen();
+    std::shared_ptr<const TileImage> tile = std::atomic_load(&m_tileImage);
+    if (tile == nullptr || tile->factor != factor || !(tile->color == pen.getColor())) {
+        auto created = std::make_shared<TileImage>();
+        created->image = renderPatternTile(*m_patternTile, m_patternTileSize,
+                                           std::max(minTileSize, int(std::lround(width))),
+                                           std::max(minTileSize, int(std::lround(height))),
+                                           pen.getColor());
+        created->factor = factor;
+        created->color = pen.getColor();
+        tile = std::move(created);
+        std::atomic_store(&m_tileImage, tile);
+    }
 
-                case RS2::EntityArc: {
-                    QPolygon pa2;
-                    RS_Arc* arc=static_cast<RS_Arc*>(e);
+    // tiles start at the origin, rotated by the hatch angle, and scaled to the exact pattern size
+    const RS_Vector origin = view->toGui(RS_Vector{0., 0.});
+    QTransform transform;
+    transform.translate(origin.x, origin.y);
+    transform.rotateRadians(-data.angle);
+    transform.scale(width / tile->image->width(), height / tile->image->height());
+    QBrush texture(*tile->image);
+    texture.setTransform(transform);
 
-                    painter->createArc(pa2, view->toGui(arc->getCenter()),
-                                       view->toGuiDX(arc->getRadius())
-                                       ,arc->getAngle1(),arc->getAngle2(),arc->isReversed());
-                    if(pa.size() &&pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
+    const QBrush brush(painter->brush());
+    painter->setBrush(texture);
+    painter->disablePen();
+    painter->drawPath(guiTransform(*view).map(*getContourPath()));
+    painter->setBrush(brush);
+    painter->setPen(pen);
+    return true;
+}
 
-                }
-                    break;
+/**
+ * Draws a pattern hatch, whose lines are closer than the pixels, by filling the contour with the
+ * pattern color, at the opacity of the share of the area the lines would cover.
+ *
+ * @return false, if the pattern needs to be drawn as lines or tiles
+ */
+bool RS_Hatch::drawPatternTone(RS_Painter* painter, RS_GraphicView* view) {
+    if (!isDrawnAsTone(*view))
+        return false;
 
-                case RS2::EntityCircle: {
-                    RS_Circle* circle = static_cast<RS_Circle*>(e);
-                    RS_Vector c=view->toGui(circle->getCenter());
-                    double r=view->toGuiDX(circle->getRadius());
-                    path.addEllipse(QPoint(c.x,c.y),r,r);
-                }
-                    break;
-                case RS2::EntityEllipse:
-                if(static_cast<RS_Ellipse*>(e)->isArc()) {
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle()
-                                           ,ellipse->getAngle1(),ellipse->getAngle2(),ellipse->isReversed()
-                                           );
-
-                    if(pa.size() && pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
-                }else{
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle(),
-                                           ellipse->getAngle1(), ellipse->getAngle2(),
-                                           ellipse->isReversed()
-                                           );
-                    path.addPolygon(pa2);
-                }
-                    break;
-                default:
-                    break;
-                }
+    // measured by prepareDraw(), if drawn by several threads
+    measurePatternCoverage();
 
-                if( pa.size()>2 && pa.first() == pa.last()) {
-                    paClosed<<pa;
-                    pa.clear();
-                }
+    // lines one pixel wide cover a share of the tile growing as the tile shrinks
+    const double width = m_patternTileSize.x * view->getFactor().x;
+    const RS_Pen pen=painter->getPen();
+    QColor tone = pen.getColor();
+    tone.setAlphaF(std::min(1., tone.alphaF() * m_patternCoverage * toneTileSize / std::max(width, RS_TOLERANCE)));
 
-            }
+    const QBrush brush(painter->brush());
+    painter->setBrush(QBrush(tone));
+    painter->disablePen();
+    painter->drawPath(guiTransform(*view).map(*getContourPath()));
+    painter->setBrush(brush);
+    painter->setPen(pen);
+    return true;
+}
 
+void RS_Hatch::measurePatternCoverage() {
+    if (m_patternTile != nullptr && m_patternCoverage < 0.) {
+        const int tileHeight = std::clamp(int(std::lround(toneTileSize * m_patternTileSize.y / m_patternTileSize.x)),
+                                          minTileSize, int(maxTileSize));
+        const std::shared_ptr<QImage> tile = renderPatternTile(*m_patternTile, m_patternTileSize,
+                                                               toneTileSize, tileHeight, Qt::black);
+        double alpha = 0.;
+        for (int y = 0; y < tile->height(); ++y) {
+            const auto* line = reinterpret_cast<const QRgb*>(tile->constScanLine(y));
+            for (int x = 0; x < tile->width(); ++x)
+                alpha += qAlpha(line[x]);
         }
+        m_patternCoverage = alpha / (255. * tile->width() * tile->height());
     }
-    if(pa.size()>2){
-        pa<<pa.first();
-        paClosed<<pa;
-    }
+}
 
-    for(auto& p:paClosed){
-        path.addPolygon(p);
+/**
+ * @return the area within the contour loops in drawing coordinates, built once after each update()
+ */
+std::shared_ptr<const QPainterPath> RS_Hatch::getContourPath() {
+    std::shared_ptr<const QPainterPath> cached = std::atomic_load(&m_contourPath);
+    if (cached != nullptr)
+        return cached;
+
+    auto path = std::make_shared<QPainterPath>();
+    auto toPoint = [](const RS_Vector& v) {
+        return QPointF(v.x, v.y);
+    };
+    foreach (auto l, entities){
+        if (l->rtti()!=RS2::EntityContainer || l->getFlag(RS2::FlagTemp))
+            continue;
+
+        bool started = false;
+        auto connect = [&path, &started, &toPoint](const RS_Vector& start) {
+            if (!started) {
+                path->moveTo(toPoint(start));
+                started = true;
+            } else if (path->currentPosition() != toPoint(start)) {
+                path->lineTo(toPoint(start));
+            }
+        };
+        // edges:
+        for(auto e: *static_cast<RS_EntityContainer*>(l)){
+            switch (e->rtti()) {
+            case RS2::EntityLine:
+                connect(e->getStartpoint());
+                path->lineTo(toPoint(e->getEndpoint()));
+                break;
+
+            case RS2::EntityArc: {
+                RS_Arc* arc=static_cast<RS_Arc*>(e);
+                const RS_Vector& center = arc->getCenter();
+                const double r = arc->getRadius();
+                const double sweep = arc->isReversed() ?
+                            -RS_Math::correctAngle(arc->getAngle1() - arc->getAngle2()) :
+                            RS_Math::correctAngle(arc->getAngle2() - arc->getAngle1());
+                connect(arc->getStartpoint());
+                // Qt angles are clockwise with the y axis pointing up
+                path->arcTo(QRectF(center.x - r, center.y - r, 2. * r, 2. * r),
+                            -RS_Math::rad2deg(arc->getAngle1()), -RS_Math::rad2deg(sweep));
+                break;
+            }
+
+            case RS2::EntityCircle: {
+                RS_Circle* circle = static_cast<RS_Circle*>(e);
+                path->addEllipse(toPoint(circle->getCenter()), circle->getRadius(), circle->getRadius());
+                break;
+            }
+
+            case RS2::EntityEllipse: {
+                auto ellipse=static_cast<RS_Ellipse*>(e);
+                const RS_Vector& center = ellipse->getCenter();
+                const RS_Vector& major = ellipse->getMajorP();
+                const RS_Vector minor = RS_Vector{-major.y, major.x} * ellipse->getRatio();
+                double start = 0.;
+                double sweep = 2. * M_PI;
+                if (ellipse->isArc()) {
+                    start = ellipse->getAngle1();
+                    sweep = ellipse->isReversed() ?
+                                -RS_Math::correctAngle(ellipse->getAngle1() - ellipse->getAngle2()) :
+                                RS_Math::correctAngle(ellipse->getAngle2() - ellipse->getAngle1());
+                }
+                const int segments = std::max(4, int(std::ceil(std::abs(sweep) / ellipseStep)));
+                for (int i = 0; i <= segments; ++i) {
+                    const double t = start + sweep * i / segments;
+                    const RS_Vector point = center + major * std::cos(t) + minor * std::sin(t);
+                    if (i == 0)
+                        connect(point);
+                    else
+                        path->lineTo(toPoint(point));
+                }
+                if (!ellipse->isArc()) {
+                    path->closeSubpath();
+                    started = false;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        if (started)
+            path->closeSubpath();
     }
 
-    //bug#474, restore brush after solid fill
-    const QBrush brush(painter->brush());
-    const RS_Pen pen=painter->getPen();
-    painter->setBrush(pen.getColor());
-    painter->disablePen();
-    painter->drawPath(path);
-    painter->setBrush(brush);
-    painter->setPen(pen);
+    cached = std::move(path);
+    std::atomic_store(&m_contourPath, cached);
+    return cached;
 }
 
 //must be called after update()
@@ -709,7 +1017,7 @@ double RS_Hatch::getTotalArea() {
     try {
         getTotalAreaImpl();
     } catch(...) {
-        RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch:: %s() failure in find hatch area", __func__);
+        LC_DEBUG_PRINT(RS_Debug::D_ERROR, "RS_Hatch:: %s() failure in find hatch area", __func__);
     }
 
     return m_area;
@@ -744,7 +1052,8 @@ double RS_Hatch::getDistanceToPoint(
     RS2::ResolveLevel level,
     double solidDist) const {
 
-    if (data.solid==true) {
+    // without pattern lines, deferred pattern hatches are selected within their contour as well
+    if (data.solid==true || m_patternDeferred) {
         if (entity) {
             *entity = const_cast<RS_Hatch*>(this);
         }
@@ -28,6 +28,9 @@
 #ifndef RS_HATCH_H
 #define RS_HATCH_H
 
+#include <memory>
+#include <vector>
+
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
 
@@ -59,6 +62,9 @@ struct RS_HatchData {
 
 std::ostream& operator << (std::ostream& os, const RS_HatchData& td);
 
+class QImage;
+class QPainterPath;
+
 
 
 /**
@@ -139,8 +145,23 @@ public:
     }
     void activateContour(bool on);
 
+    /**
+     * @return true, if the pattern is drawn as a tiled texture from the pattern definition,
+     * without pattern lines in the hatch container. See "/Appearance/HatchPatternTextures".
+     */
+    bool isPatternDeferred() const {
+        return m_patternDeferred;
+    }
+    /**
+     * Creates the trimmed pattern lines of a deferred pattern hatch, for explode or
+     * exports writing the pattern as lines.
+     */
+    void materializePattern();
+
     void draw(RS_Painter* painter, RS_GraphicView* view,
                       double& patternOffset) override;
+    //! creates the pattern lines, the contour path or the pattern tone the view draws
+    void prepareDraw(const RS_GraphicView& view) override;
 
     double getDistanceToPoint(const RS_Vector& coord,
                                       RS_Entity** entity = NULL,
@@ -162,6 +183,13 @@ public:
 private:
     double getTotalAreaImpl();
     RS_EntityContainer trimPattern(const RS_EntityContainer& patternEntities) const;
+    bool drawPatternTiles(RS_Painter* painter, RS_GraphicView* view);
+    bool drawPatternTone(RS_Painter* painter, RS_GraphicView* view);
+    bool isDrawnAsTiles(const RS_GraphicView& view) const;
+    bool isDrawnAsTone(const RS_GraphicView& view) const;
+    void measurePatternCoverage();
+    std::shared_ptr<const QPainterPath> getContourPath();
+    std::vector<double> getContourSignature() const;
     RS_HatchData data;
     RS_EntityContainer* hatch = nullptr;
     double m_area = RS_MAXDOUBLE;
@@ -169,6 +197,27 @@ private:
     bool updateRunning = false;
     bool needOptimization = false;
     bool m_updated=false;
+    //! the pattern lines are not created by update(), the pattern is drawn from m_patternTile
+    bool m_patternDeferred = false;
+    bool m_materializing = false;
+    //! the area within the contour, in drawing coordinates, loaded and stored atomically
+    std::shared_ptr<const QPainterPath> m_contourPath;
+    //! the contour and pattern data of the current pattern, to skip regenerating it
+    std::vector<double> m_contourSignature;
+    QString m_signaturePattern;
+    //! one tile of the scaled pattern, moved to the origin, but not rotated yet
+    std::shared_ptr<const RS_EntityContainer> m_patternTile;
+    RS_Vector m_patternTileSize;
+    //! the tile, as drawn for a view factor and pen color
+    struct TileImage {
+        std::shared_ptr<QImage> image;
+        double factor = 0.;
+        RS_Color color;
+    };
+    //! the last tile drawn, by any of the rendering threads, loaded and stored atomically
+    std::shared_ptr<const TileImage> m_tileImage;
+    //! the share of a tile drawn at toneTileSize covered by the pattern, negative until measured
+    double m_patternCoverage = -1.;
 };
 
 #endif
@@ -23,11 +23,14 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
 #include<iostream>
 #include <QDir>
 #include <QFileInfo>
 #include <QImage>
 
+#include "lc_imagecache.h"
+#include "lc_imagepyramid.h"
 #include "rs_debug.h"
 #include "rs_document.h"
 #include "rs_graphicview.h"
@@ -126,10 +129,11 @@ void RS_Image::update() {
     // the whole image:
     QString filePathName = imageRelativePathName(data.file);
 
-    //QImage image = QImage(data.file);
-    img = std::make_shared<QImage>(filePathName);
-	if (!img->isNull()) {
-		data.size = RS_Vector(img->width(), img->height());
+    // only the size is read, the raster when the image is drawn. Images of a file share it
+    pyramid = LC_ImageCache::instance().pyramid(filePathName);
+    const QSize imageSize = pyramid->size();
+	if (imageSize.isValid()) {
+		data.size = RS_Vector(imageSize.width(), imageSize.height());
 		calculateBorders(); // image update need this.
     } else {
         LC_LOG(RS_Debug::D_ERROR)<<"RS_Image::"<<__func__<<"(): image file not found: "<<data.file<<"("<<filePathName<<")";
@@ -175,6 +179,7 @@ void RS_Image::update() {
 
 
 void RS_Image::calculateBorders() {
+    touch();
 
     RS_VectorSolutions sol = getCorners();
         minV =  RS_Vector::minimum(
@@ -316,9 +321,7 @@ double RS_Image::getDistanceToPoint(const RS_Vector& coord,
 	if(containsPoint(coord)){
 		//if coord is on image
 
-		RS_SETTINGS->beginGroup("/Appearance");
-		bool draftMode = (bool)RS_SETTINGS->readNumEntry("/DraftMode", 0);
-		RS_SETTINGS->endGroup();
+		bool draftMode = RS_SETTINGS->snapshot().draftMode;
 		if(!draftMode) return double(0.);
 	}
     //continue to allow selecting by image edges
@@ -380,7 +383,7 @@ void RS_Image::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 
 
 void RS_Image::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
-	if (!(painter && view) || !img.get() || img->isNull())
+	if (!(painter && view) || pyramid == nullptr)
 		return;
 
     // erase image:
@@ -392,6 +395,13 @@ void RS_Image::draw(RS_Painter* painter, RS_GraphicView* view, double& /*pattern
 	RS_Vector scale{view->toGuiDX(data.uVector.magnitude()),
 								view->toGuiDY(data.vVector.magnitude())};
 
+    // the level matching the zoom, scaled to the size of the full image
+    std::shared_ptr<QImage> img = pyramid->image(std::max(scale.x, scale.y));
+    if (img == nullptr)
+        return;
+    scale.x *= data.size.x / img->width();
+    scale.y *= data.size.y / img->height();
+
     painter->drawImg(*img,
                      view->toGui(data.insertionPoint),
                      data.uVector, data.vVector, scale);
@@ -29,7 +29,7 @@
 #include <memory>
 #include "rs_atomicentity.h"
 
-class QImage;
+class LC_ImagePyramid;
 
 /**
  * Holds the data that defines a line.
@@ -220,8 +220,8 @@ protected:
 	// whether the point is within image
 	bool containsPoint(const RS_Vector& coord) const;
 	RS_ImageData data;
-    std::shared_ptr<QImage> img;
-        //QImage** img;
+    // the raster, read when drawn
+    std::shared_ptr<LC_ImagePyramid> pyramid;
         //int nx;
         //int ny;
 };
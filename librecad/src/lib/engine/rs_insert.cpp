@@ -26,22 +26,28 @@
 
 #include "rs_insert.h"
 
+#include<algorithm>
 #include<cmath>
 #include<iostream>
 
+#include <QTransform>
+
+#include "lc_blockdrawlist.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
 #include "rs_debug.h"
 #include "rs_ellipse.h"
 #include "rs_graphic.h"
+#include "rs_graphicview.h"
 #include "rs_layer.h"
 #include "rs_math.h"
+#include "rs_painter.h"
 
 namespace {
 
 // Minimum scaling factor allowed
-constexpr double MIN_Scale_Factor = 1.0e-6;
+constexpr double MIN_Scale_Factor = RS_Insert::minScaleFactor;
 
 // update the entity pen according to the blockPen
 RS_Pen updatePen(RS_Pen&& pen, const RS_Pen& blockPen)
@@ -98,21 +104,51 @@ RS_Insert::RS_Insert(RS_EntityContainer* parent,
 
 		block = nullptr;
 
+    updateReference();
     if (data.updateMode!=RS2::NoUpdate) {
         update();
         //calculateBorders();
     }
 }
 
+RS_Insert::~RS_Insert() {
+    if (reference.list != nullptr)
+        reference.list->removeReference(this, reference.name);
+}
+
 
 RS_Entity* RS_Insert::clone() const{
 	RS_Insert* i = new RS_Insert(*this);
 	i->setOwner(isOwner());
 	i->initId();
 	i->detach();
+	i->updateReference();
 	return i;
 }
 
+/**
+ * Keeps the reference of the insert to its block in the block list of its graphic
+ * up to date. Inserts of other block sources, like the letters of texts, are not
+ * registered.
+ */
+void RS_Insert::updateReference() {
+    RS_BlockList* list = nullptr;
+    if (data.blockSource == nullptr) {
+        RS_Graphic* graphic = getGraphic();
+        if (graphic != nullptr)
+            list = graphic->getBlockList();
+    }
+    if (list == reference.list && data.name == reference.name)
+        return;
+
+    if (reference.list != nullptr)
+        reference.list->removeReference(this, reference.name);
+    reference.list = list;
+    reference.name = data.name;
+    if (list != nullptr)
+        list->addReference(this);
+}
+
 
 /**
  * Updates the entity buffer of this insert entity. This method
@@ -120,38 +156,84 @@ RS_Entity* RS_Insert::clone() const{
  */
 void RS_Insert::update() {
 
-        RS_DEBUG->print("RS_Insert::update");
-        RS_DEBUG->print("RS_Insert::update: name: %s", data.name.toLatin1().data());
+        LC_DEBUG_TRACE("RS_Insert::update");
+        LC_DEBUG_TRACE("RS_Insert::update: name: %s", data.name.toLatin1().data());
 //        RS_DEBUG->print("RS_Insert::update: insertionPoint: %f/%f",
 //                data.insertionPoint.x, data.insertionPoint.y);
 
+    updateReference();
         if (updateEnabled==false) {
                 return;
         }
 
     clear();
+    drawList.reset();
+    blockRevision = 0;
 
     RS_Block* blk = getBlockForInsert();
     if (blk == nullptr) {
-        RS_DEBUG->print("RS_Insert::update: Block is nullptr");
+        LC_DEBUG_TRACE("RS_Insert::update: Block is nullptr");
         return;
     }
 
     if (isUndone()) {
-        RS_DEBUG->print("RS_Insert::update: Insert is in undo list");
+        LC_DEBUG_TRACE("RS_Insert::update: Insert is in undo list");
         return;
     }
 
     if (std::abs(data.scaleFactor.x)<MIN_Scale_Factor || std::abs(data.scaleFactor.y)<MIN_Scale_Factor) {
-        RS_DEBUG->print("RS_Insert::update: scale factor is 0");
+        LC_DEBUG_TRACE("RS_Insert::update: scale factor is 0");
         return;
     }
 
-    RS_DEBUG->print("RS_Insert::update: cols: %d, rows: %d",
+    LC_DEBUG_TRACE("RS_Insert::update: cols: %d, rows: %d",
                     data.cols, data.rows);
-    RS_DEBUG->print("RS_Insert::update: block has %d entities",
+    LC_DEBUG_TRACE("RS_Insert::update: block has %d entities",
                     blk->count());
-        for(auto* e: *blk){
+
+    blockRevision = blk->getContentRevision();
+    drawList = blk->getDrawList();
+    if (drawList == nullptr)
+        createEntities(*blk);
+        calculateBorders();
+
+        LC_DEBUG_TRACE("RS_Insert::update: OK");
+}
+
+
+
+std::vector<RS_Entity*> RS_Insert::releaseEntities() {
+    prepareEntities();
+    std::vector<RS_Entity*> released{entities.cbegin(), entities.cend()};
+    entities.clear();
+    invalidateSpatialIndex();
+    blockRevision = 0;
+    return released;
+}
+
+
+bool RS_Insert::prepareUpdate() {
+    updateReference();
+    RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr || !updateEnabled)
+        return false;
+    if (!isUpdateNeeded())
+        return drawList != nullptr;
+    return blk->getDrawList() != nullptr;
+}
+
+
+bool RS_Insert::isUpdateNeeded() const {
+    RS_Block* blk = getBlockForInsert();
+    return blk == nullptr || blockRevision == 0 || blockRevision != blk->getContentRevision();
+}
+
+
+/**
+ * Creates the transformed copies of the block entities.
+ */
+void RS_Insert::createEntities(RS_Block& blk) {
+        for(auto* e: blk){
             for (int c=0; c<data.cols; ++c) {
 //            RS_DEBUG->print("RS_Insert::update: col %d", c);
                 for (int r=0; r<data.rows; ++r) {
@@ -162,7 +244,9 @@ void RS_Insert::update() {
                             data.updateMode!=RS2::PreviewUpdate) {
 
 //                                        RS_DEBUG->print("RS_Insert::update: updating sub-insert");
-                        e->update();
+                        auto* insert = static_cast<RS_Insert*>(e);
+                        if (insert->isUpdateNeeded())
+                            insert->update();
                 }
 
 //                                RS_DEBUG->print("RS_Insert::update: cloning entity");
@@ -213,7 +297,7 @@ void RS_Insert::update() {
                     }
                 // Move because of block base point:
 //                                RS_DEBUG->print("RS_Insert::update: move 2");
-                    ne->move(blk->getBasePoint()*(-1));
+                    ne->move(blk.getBasePoint()*(-1));
                 // Scale:
 //                                RS_DEBUG->print("RS_Insert::update: scale");
                     ne->scale(data.insertionPoint, data.scaleFactor);
@@ -247,9 +331,297 @@ void RS_Insert::update() {
                 }
             }
         }
+}
+
+/**
+ * Creates the entities of an instanced insert, before they are accessed
+ * for editing, snapping or selection.
+ */
+void RS_Insert::prepareEntities() const {
+    if (drawList == nullptr)
+        return;
+    auto* insert = const_cast<RS_Insert*>(this);
+    insert->drawList.reset();
+    RS_Block* blk = getBlockForInsert();
+    if (blk != nullptr)
+        insert->createEntities(*blk);
+}
+
+QTransform RS_Insert::getCellTransform(int col, int row) const {
+    const RS_Vector offset{data.spacing.x/data.scaleFactor.x*col,
+                           data.spacing.y/data.scaleFactor.y*row};
+    const double c = std::cos(data.angle);
+    const double s = std::sin(data.angle);
+    const double sx = data.scaleFactor.x;
+    const double sy = data.scaleFactor.y;
+    return {c*sx, s*sx, -s*sy, c*sy,
+            data.insertionPoint.x + c*sx*offset.x - s*sy*offset.y,
+            data.insertionPoint.y + s*sx*offset.x + c*sy*offset.y};
+}
+
+bool RS_Insert::queryCells(const RS_Vector& coord, bool withinBorders, const CellQuery& query,
+                           RS_Vector& point, double& dist) const {
+    point = RS_Vector{false};
+    dist = RS_MAXDOUBLE;
+    if (drawList == nullptr)
+        return false;
+    // distances in the block scale by the same factor in all directions
+    const double scale = std::abs(data.scaleFactor.x);
+    if (std::abs(std::abs(data.scaleFactor.y) - scale) > RS_TOLERANCE * scale)
+        return false;
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr)
+        return false;
+
+    // borders of the block geometry, relative to the base point
+    RS_Vector boxMin{RS_MAXDOUBLE, RS_MAXDOUBLE};
+    RS_Vector boxMax{RS_MINDOUBLE, RS_MINDOUBLE};
+    for (const LC_BlockDrawList::Group& group: drawList->getGroups()) {
+        for (const QPointF& point: group.hull) {
+            boxMin = RS_Vector::minimum(boxMin, {point.x(), point.y()});
+            boxMax = RS_Vector::maximum(boxMax, {point.x(), point.y()});
+        }
+    }
+
+    struct Cell {
+        double boxDistance;
+        QTransform transform;
+        QPointF local;
+    };
+    std::vector<Cell> cells;
+    cells.reserve(static_cast<size_t>(std::max(data.cols, 0)) * static_cast<size_t>(std::max(data.rows, 0)));
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            const QTransform transform = getCellTransform(c, r);
+            bool invertible = false;
+            const QTransform inverted = transform.inverted(&invertible);
+            if (!invertible)
+                continue;
+            const QPointF local = inverted.map(QPointF{coord.x, coord.y});
+            const double dx = std::max({boxMin.x - local.x(), 0., local.x() - boxMax.x});
+            const double dy = std::max({boxMin.y - local.y(), 0., local.y() - boxMax.y});
+            cells.push_back({withinBorders ? std::hypot(dx, dy) * scale : 0., transform, local});
+        }
+    }
+    std::sort(cells.begin(), cells.end(), [](const Cell& c0, const Cell& c1) {
+        return c0.boxDistance < c1.boxDistance;
+    });
+
+    const RS_Vector basePoint = blk->getBasePoint();
+    for (const Cell& cell: cells) {
+        if (cell.boxDistance > dist)
+            break;
+        double blockDist = RS_MAXDOUBLE;
+        const RS_Vector found = query(*blk, RS_Vector{cell.local.x(), cell.local.y()} + basePoint, blockDist);
+        if (!found.valid || blockDist >= RS_MAXDOUBLE || blockDist * scale >= dist)
+            continue;
+        const QPointF mapped = cell.transform.map(QPointF{found.x - basePoint.x, found.y - basePoint.y});
+        point = RS_Vector{mapped.x(), mapped.y()};
+        dist = blockDist * scale;
+    }
+    return true;
+}
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord, double* dist) const {
+    RS_Vector point;
+    double minDist = RS_MAXDOUBLE;
+    auto query = [](const RS_Block& block, const RS_Vector& blockCoord, double& blockDist) {
+        return block.getNearestEndpoint(blockCoord, &blockDist);
+    };
+    if (!queryCells(coord, true, query, point, minDist))
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    if (dist != nullptr)
+        *dist = minDist;
+    return point;
+}
+
+RS_Vector RS_Insert::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                             double* dist, RS_Entity** entity) const {
+    RS_Vector point;
+    double minDist = RS_MAXDOUBLE;
+    auto query = [onEntity](const RS_Block& block, const RS_Vector& blockCoord, double& blockDist) {
+        return block.getNearestPointOnEntity(blockCoord, onEntity, &blockDist);
+    };
+    // the entity found is one of the entities of the insert
+    if (entity != nullptr || !queryCells(coord, true, query, point, minDist))
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    if (dist != nullptr)
+        *dist = minDist;
+    return point;
+}
+
+RS_Vector RS_Insert::getNearestCenter(const RS_Vector& coord, double* dist) const {
+    RS_Vector point;
+    double minDist = RS_MAXDOUBLE;
+    auto query = [](const RS_Block& block, const RS_Vector& blockCoord, double& blockDist) {
+        return block.getNearestCenter(blockCoord, &blockDist);
+    };
+    // centers of arcs may be outside of the borders
+    if (!queryCells(coord, false, query, point, minDist))
+        return RS_EntityContainer::getNearestCenter(coord, dist);
+    if (dist != nullptr)
+        *dist = minDist;
+    return point;
+}
+
+RS_Vector RS_Insert::getNearestMiddle(const RS_Vector& coord, double* dist, int middlePoints) const {
+    RS_Vector point;
+    double minDist = RS_MAXDOUBLE;
+    auto query = [middlePoints](const RS_Block& block, const RS_Vector& blockCoord, double& blockDist) {
+        return block.getNearestMiddle(blockCoord, &blockDist, middlePoints);
+    };
+    if (!queryCells(coord, true, query, point, minDist))
+        return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+    if (dist != nullptr)
+        *dist = minDist;
+    return point;
+}
+
+RS_Vector RS_Insert::getNearestDist(double distance, const RS_Vector& coord, double* dist) const {
+    RS_Vector point;
+    double minDist = RS_MAXDOUBLE;
+    const double blockDistance = distance / std::abs(data.scaleFactor.x);
+    auto query = [blockDistance](const RS_Block& block, const RS_Vector& blockCoord, double& blockDist) {
+        return block.getNearestDist(blockDistance, blockCoord, &blockDist);
+    };
+    if (!queryCells(coord, true, query, point, minDist))
+        return RS_EntityContainer::getNearestDist(distance, coord, dist);
+    if (dist != nullptr)
+        *dist = minDist;
+    return point;
+}
+
+double RS_Insert::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                     RS2::ResolveLevel level, double solidDist) const {
+    RS_Vector point;
+    double minDist = RS_MAXDOUBLE;
+    const double blockSolidDist = solidDist / std::abs(data.scaleFactor.x);
+    auto query = [blockSolidDist](const RS_Block& block, const RS_Vector& blockCoord, double& blockDist) {
+        blockDist = block.getDistanceToPoint(blockCoord, nullptr, RS2::ResolveNone, blockSolidDist);
+        return RS_Vector{blockDist < RS_MAXDOUBLE};
+    };
+    if (level != RS2::ResolveNone || !queryCells(coord, true, query, point, minDist))
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    if (entity != nullptr)
+        *entity = const_cast<RS_Insert*>(this);
+    return minDist;
+}
+
+void RS_Insert::calculateBorders() {
+    if (drawList == nullptr) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+
+    resetBorders();
+    for (const LC_BlockDrawList::Group& group: drawList->getGroups()) {
+        RS_Layer* layer = group.layer;
+        if (layer == nullptr || layer->getName() == "0")
+            layer = getLayer();
+        if (layer != nullptr && layer->isFrozen())
+            continue;
+        // the transformed hull is cheaper to measure than the transformed path
+        for (int c=0; c<data.cols; ++c) {
+            for (int r=0; r<data.rows; ++r) {
+                const QTransform transform = getCellTransform(c, r);
+                for (const QPointF& point: group.hull) {
+                    const QPointF mapped = transform.map(point);
+                    minV = RS_Vector::minimum(minV, {mapped.x(), mapped.y()});
+                    maxV = RS_Vector::maximum(maxV, {mapped.x(), mapped.y()});
+                }
+            }
+        }
+    }
+}
+
+void RS_Insert::forcedCalculateBorders() {
+    if (drawList == nullptr)
+        RS_EntityContainer::forcedCalculateBorders();
+    else
         calculateBorders();
+}
+
+unsigned RS_Insert::count() const {
+    if (drawList == nullptr)
+        return RS_EntityContainer::count();
+    RS_Block* blk = getBlockForInsert();
+    return blk != nullptr ? blk->count() * data.cols * data.rows : 0;
+}
+
+unsigned RS_Insert::countDeep() const {
+    if (drawList == nullptr)
+        return RS_EntityContainer::countDeep();
+    RS_Block* blk = getBlockForInsert();
+    return blk != nullptr ? blk->countDeep() * data.cols * data.rows : 0;
+}
 
-        RS_DEBUG->print("RS_Insert::update: OK");
+unsigned RS_Insert::countSelected(bool deep, QList<RS2::EntityType> const& types) {
+    // the entity types of the block are only known from its entities
+    if (drawList == nullptr || !types.isEmpty())
+        return RS_EntityContainer::countSelected(deep, types);
+    return isSelected() ? count() : 0;
+}
+
+/**
+ * Draws the shared block geometry through the insert transform,
+ * or the insert entities, if they have been created.
+ */
+void RS_Insert::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) {
+    if (drawList == nullptr) {
+        RS_EntityContainer::draw(painter, view, patternOffset);
+        return;
+    }
+    if (painter == nullptr || view == nullptr || !view->isDrawnBy(painter, this))
+        return;
+
+    const bool printing = view->isPrinting() || view->isPrintPreview();
+    const QTransform guiTransform{view->getFactor().x, 0., 0., -view->getFactor().y,
+                                  view->getOffsetX(), view->getHeight() - view->getOffsetY()};
+    const RS_Pen insertPen = getPen();
+    for (const LC_BlockDrawList::Group& group: drawList->getGroups()) {
+        // same rules as for the entities of the insert, see createEntities()
+        RS_Layer* layer = group.layer;
+        if (layer == nullptr || layer->getName() == "0")
+            layer = getLayer();
+        if (layer != nullptr
+                && (layer->isFrozen() || (printing && (!layer->isPrint() || layer->isConstruction()))))
+            continue;
+        if (LC_BlockDrawList::isHidden(group))
+            continue;
+
+        RS_Pen pen = updatePen(RS_Pen{group.pen}, insertPen);
+        if (!pen.isValid())
+            pen = insertPen;
+        if (layer != nullptr) {
+            if (pen.getColor().isByLayer())
+                pen.setColor(layer->getPen().getColor());
+            if (pen.getWidth() == RS2::WidthByLayer)
+                pen.setWidth(layer->getPen().getWidth());
+            if (pen.getLineType() == RS2::LineByLayer)
+                pen.setLineType(layer->getPen().getLineType());
+        }
+        view->setPenForEntity(painter, this, pen, patternOffset);
+
+        for (int c=0; c<data.cols; ++c) {
+            for (int r=0; r<data.rows; ++r) {
+                painter->drawSharedPath(group.path, getCellTransform(c, r) * guiTransform, group.filled);
+            }
+        }
+    }
+}
+
+/**
+ * Updates the insert after its transform changed. The shared geometry
+ * of an instanced insert stays the same, only its borders change.
+ */
+void RS_Insert::updateTransform() {
+    if (isInstanced() && updateEnabled
+            && std::abs(data.scaleFactor.x)>=MIN_Scale_Factor
+            && std::abs(data.scaleFactor.y)>=MIN_Scale_Factor) {
+        calculateBorders();
+    } else {
+        update();
+    }
 }
 
 
@@ -282,6 +654,9 @@ RS_Block* RS_Insert::getBlockForInsert() const{
         blk = blkList->find(data.name);
     }
 
+    if (blk != nullptr) {
+        blk->load();
+    }
     block = blk;
 
     return blk;
@@ -327,52 +702,55 @@ RS_Vector RS_Insert::getNearestRef(const RS_Vector& coord,
 
 
 void RS_Insert::move(const RS_Vector& offset) {
-        RS_DEBUG->print("RS_Insert::move: offset: %f/%f",
+        LC_DEBUG_TRACE("RS_Insert::move: offset: %f/%f",
                 offset.x, offset.y);
-        RS_DEBUG->print("RS_Insert::move1: insertionPoint: %f/%f",
+        LC_DEBUG_TRACE("RS_Insert::move1: insertionPoint: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y);
     data.insertionPoint.move(offset);
-        RS_DEBUG->print("RS_Insert::move2: insertionPoint: %f/%f",
+        LC_DEBUG_TRACE("RS_Insert::move2: insertionPoint: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y);
-    update();
+    if (isInstanced() && updateEnabled)
+        moveBorders(offset);
+    else
+        update();
 }
 
 
 
 void RS_Insert::rotate(const RS_Vector& center, const double& angle) {
-        RS_DEBUG->print("RS_Insert::rotate1: insertionPoint: %f/%f "
+        LC_DEBUG_TRACE("RS_Insert::rotate1: insertionPoint: %f/%f "
             "/ center: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y,
                 center.x, center.y);
     data.insertionPoint.rotate(center, angle);
     data.angle = RS_Math::correctAngle(data.angle+angle);
-        RS_DEBUG->print("RS_Insert::rotate2: insertionPoint: %f/%f",
+        LC_DEBUG_TRACE("RS_Insert::rotate2: insertionPoint: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y);
-    update();
+    updateTransform();
 }
 void RS_Insert::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
-        RS_DEBUG->print("RS_Insert::rotate1: insertionPoint: %f/%f "
+        LC_DEBUG_TRACE("RS_Insert::rotate1: insertionPoint: %f/%f "
             "/ center: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y,
                 center.x, center.y);
     data.insertionPoint.rotate(center, angleVector);
     data.angle = RS_Math::correctAngle(data.angle+angleVector.angle());
-        RS_DEBUG->print("RS_Insert::rotate2: insertionPoint: %f/%f",
+        LC_DEBUG_TRACE("RS_Insert::rotate2: insertionPoint: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y);
-    update();
+    updateTransform();
 }
 
 
 
 void RS_Insert::scale(const RS_Vector& center, const RS_Vector& factor) {
-        RS_DEBUG->print("RS_Insert::scale1: insertionPoint: %f/%f",
+        LC_DEBUG_TRACE("RS_Insert::scale1: insertionPoint: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y);
     data.insertionPoint.scale(center, factor);
     data.scaleFactor.scale(RS_Vector(0.0, 0.0), factor);
     data.spacing.scale(RS_Vector(0.0, 0.0), factor);
-        RS_DEBUG->print("RS_Insert::scale2: insertionPoint: %f/%f",
+        LC_DEBUG_TRACE("RS_Insert::scale2: insertionPoint: %f/%f",
                 data.insertionPoint.x, data.insertionPoint.y);
-    update();
+    updateTransform();
 
 }
 
@@ -387,7 +765,7 @@ void RS_Insert::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 
         data.scaleFactor.x*=-1;
 
-    update();
+    updateTransform();
 }
 
 
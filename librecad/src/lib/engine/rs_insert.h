@@ -28,8 +28,13 @@
 #ifndef RS_INSERT_H
 #define RS_INSERT_H
 
+#include <functional>
+#include <memory>
+
 #include "rs_entitycontainer.h"
 
+class LC_BlockDrawList;
+class QTransform;
 class RS_BlockList;
 
 /**
@@ -85,6 +90,8 @@ std::ostream& operator << (std::ostream& os, const RS_InsertData& d);
  * Inserts don't really contain other entities internally. They just
  * refer to a block. However, to the outside world they act exactly
  * like EntityContainer.
+ * Inserts of simple blocks share the compiled geometry of the block
+ * for drawing. Their entities are only created, when they are accessed.
  *
  * @author Andrew Mustun
  */
@@ -92,6 +99,7 @@ class RS_Insert : public RS_EntityContainer {
 public:
     RS_Insert(RS_EntityContainer* parent,
               const RS_InsertData& d);
+    ~RS_Insert() override;
 
     RS_Entity* clone() const override;
 
@@ -111,11 +119,54 @@ public:
     void reparent(RS_EntityContainer* parent)  override{
                 RS_Entity::reparent(parent);
                 block = nullptr;
+                updateReference();
     }
 
 	RS_Block* getBlockForInsert() const;
 
     void update() override;
+    /**
+     * @return true, if the block or one of its nested blocks changed
+     * since the last update, or the insert has not been updated yet
+     */
+    bool isUpdateNeeded() const;
+    /**
+     * @brief prepareUpdate - does the part of update() which changes state shared with
+     * other inserts: registers the insert, loads its block and compiles the draw list.
+     * @return true, if update() and calculateBorders() use the compiled draw list only
+     * then, so prepared inserts may be updated by concurrent threads
+     */
+    bool prepareUpdate();
+    void calculateBorders() override;
+    void forcedCalculateBorders() override;
+
+    /**
+     * @return true, if the insert draws the shared geometry of its
+     * block, and has not created its entities yet
+     */
+    bool isInstanced() const {
+        return drawList != nullptr;
+    }
+    /**
+     * @brief releaseEntities - moves the transformed copies of the block entities out of this insert,
+     * without copying them again. The insert is empty until its next update().
+     * @return the entities, the caller takes their ownership
+     */
+    std::vector<RS_Entity*> releaseEntities();
+
+    unsigned count() const override;
+    unsigned countDeep() const override;
+    unsigned countSelected(bool deep=true, QList<RS2::EntityType> const& types = {}) override;
+
+    void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
+
+    /**
+     * @return the transform of the block geometry, relative to the base point, in the given cell of the array
+     */
+    QTransform getCellTransform(int col, int row) const;
+
+    // inserts with a smaller scale factor are empty
+    static constexpr double minScaleFactor = 1.0e-6;
 
     QString getName() const {
         return data.name;
@@ -174,6 +225,26 @@ public:
 
     bool isVisible() const override;
 
+    /**
+     * Snapping and hit-testing of instanced inserts query the block in the cells next to the
+     * coordinate, without creating the entities of the insert. Inserts with a non-uniform scale
+     * create their entities.
+     */
+    using RS_EntityContainer::getNearestEndpoint;
+    RS_Vector getNearestEndpoint(const RS_Vector& coord, double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord, bool onEntity = true,
+                                      double* dist = nullptr, RS_Entity** entity = nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord, double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord, double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance, const RS_Vector& coord, double* dist = nullptr) const override;
+    /**
+     * @brief getDistanceToPoint - for instanced inserts and RS2::ResolveNone, the entity found is the insert
+     */
+    double getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                              RS2::ResolveLevel level = RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+
     RS_VectorSolutions getRefPoints() const override;
     RS_Vector getMiddlePoint(void) const  override{
         return {};
@@ -190,8 +261,47 @@ public:
     friend std::ostream& operator << (std::ostream& os, const RS_Insert& i);
 
 protected:
+    void prepareEntities() const override;
+
     RS_InsertData data{};
     mutable RS_Block* block = nullptr;
+
+private:
+    friend class RS_BlockList;
+    // unregisters the copies of document snapshots
+    friend class LC_DocumentSnapshot;
+
+    void createEntities(RS_Block& blk);
+    // registers the insert in the reference graph of the block list of its graphic
+    void updateReference();
+
+    // a query in the block, the coordinate and the distance found are in block coordinates
+    using CellQuery = std::function<RS_Vector(const RS_Block& block, const RS_Vector& blockCoord, double& blockDist)>;
+    /**
+     * @brief queryCells - runs a query in the block for the cells of the array, nearest first
+     * @param withinBorders - whether the points found are within the borders of the block geometry, so
+     * the cells too far away are skipped
+     * @return false, if the insert is not instanced with a uniform scale
+     */
+    bool queryCells(const RS_Vector& coord, bool withinBorders, const CellQuery& query,
+                    RS_Vector& point, double& dist) const;
+    void updateTransform();
+
+    std::shared_ptr<const LC_BlockDrawList> drawList;
+    // revision of the block, when the entities were created
+    unsigned long long blockRevision = 0;
+    // where the insert is registered by updateReference(), copies of the insert register themselves
+    struct Reference {
+        Reference() = default;
+        Reference(const Reference&) {}
+        Reference& operator = (const Reference&)
+        {
+            return *this;
+        }
+        RS_BlockList* list = nullptr;
+        QString name;
+    };
+    Reference reference;
 };
 
 
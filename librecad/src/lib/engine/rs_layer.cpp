@@ -27,9 +27,15 @@
 
 #include <iostream>
 #include <QString>
+#include <atomic>
+
 #include <rs_debug.h>
 #include "rs_layer.h"
 
+namespace {
+std::atomic<unsigned> renameCount{0};
+}
+
 RS_LayerData::RS_LayerData(const QString& name,
 						   const RS_Pen& pen,
 						   bool frozen,
@@ -57,6 +63,7 @@ RS_Layer* RS_Layer::clone() const{
 /** sets a new name for this layer. */
 void RS_Layer::setName(const QString& name) {
 	data.name = name;
+	++renameCount;
 }
 
 /** @return the name of this layer. */
@@ -64,6 +71,10 @@ QString RS_Layer::getName() const {
 	return data.name;
 }
 
+unsigned RS_Layer::getRenameCount() {
+	return renameCount;
+}
+
 /** sets the default pen for this layer. */
 void RS_Layer::setPen(const RS_Pen& pen) {
 	data.pen = pen;
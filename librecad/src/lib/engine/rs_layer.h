@@ -82,6 +82,12 @@ public:
     /** @return the name of this layer. */
 	QString getName() const;
 
+	/**
+	 * @return a counter incremented on each layer rename, used by
+	 * layer lists to find out whether their name index is outdated
+	 */
+	static unsigned getRenameCount();
+
     /** sets the default pen for this layer. */
 	void setPen(const RS_Pen& pen);
 
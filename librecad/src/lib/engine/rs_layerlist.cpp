@@ -47,6 +47,7 @@ RS_LayerList::RS_LayerList() {
  */
 void RS_LayerList::clear() {
     layers.clear();
+    indexValid = false;
 	setModified(true);
 }
 
@@ -155,6 +156,8 @@ void RS_LayerList::add(RS_Layer* layer) {
     RS_Layer* l = find(layer->getName());
     if (l==nullptr) {
         layers.append(layer);
+        if (indexValid)
+            layerIndex.insert(layer->getName(), layer);
         this->sort();
         // notify listeners
         for (int i=0; i<layerListListeners.size(); ++i) {
@@ -201,6 +204,8 @@ void RS_LayerList::remove(RS_Layer* layer) {
 
     // here the layer is removed from the list but not deleted
     layers.removeOne(layer);
+    // another layer may have the same name after renaming
+    indexValid = false;
 
     for (int i=0; i<layerListListeners.size(); ++i) {
         RS_LayerListListener* l = layerListListeners.at(i);
@@ -231,6 +236,7 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
     }
 
     *layer = source;
+    indexValid = false;
 
     fireEdit(layer);
 }
@@ -252,21 +258,8 @@ void RS_LayerList::fireEdit(RS_Layer* layer) {
  * \p nullptr if no such layer was found.
  */
 RS_Layer* RS_LayerList::find(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    RS_Layer* ret = nullptr;
-
-    for (int i=0; i<layers.size(); ++i) {
-        RS_Layer* l = layers.at(i);
-        if (l->getName()==name) {
-            ret = l;
-            break;
-        }
-    }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    updateIndex();
+    return layerIndex.value(name, nullptr);
 }
 
 
@@ -276,22 +269,28 @@ RS_Layer* RS_LayerList::find(const QString& name) {
  * was not found.
  */
 int RS_LayerList::getIndex(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    int ret = -1;
+    RS_Layer* layer = find(name);
+    return layer != nullptr ? layers.indexOf(layer) : -1;
+}
 
-    for (int i=0; i<layers.size(); i++) {
-        RS_Layer* l = layers.at(i);
 
-        if (l->getName()==name) {
-            ret = i;
-            break;
-        }
+/**
+ * Rebuilds the name index, if layers were added, removed, or renamed
+ * since it was built. Of layers with the same name, left by renaming,
+ * the first one in the list, when the index was built, is found.
+ */
+void RS_LayerList::updateIndex() {
+    const unsigned renameCount = RS_Layer::getRenameCount();
+    if (indexValid && indexRenameCount == renameCount)
+        return;
+    layerIndex.clear();
+    layerIndex.reserve(layers.size());
+    for (RS_Layer* layer: layers) {
+        if (!layerIndex.contains(layer->getName()))
+            layerIndex.insert(layer->getName(), layer);
     }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    indexValid = true;
+    indexRenameCount = renameCount;
 }
 
 
@@ -405,12 +404,15 @@ void RS_LayerList::toggleConstruction(RS_Layer* layer) {
     }
 }
 
-void RS_LayerList::fireLayerToggled(){
+/**
+ * Notifies the listeners of the layers changed at once.
+ */
+void RS_LayerList::fireLayerToggled(const QList<RS_Layer*>& toggledLayers){
     setModified(true);
 
     for (int i=0; i<layerListListeners.size(); ++i) {
         RS_LayerListListener* l = layerListListeners.at(i);
-        l->layerToggled(nullptr);
+        l->layersToggled(toggledLayers);
     }
 }
 
@@ -421,13 +423,15 @@ void RS_LayerList::fireLayerToggled(){
  */
 void RS_LayerList::freezeAll(bool freeze) {
 
+    QList<RS_Layer*> toggledLayers;
     for (unsigned l=0; l<count(); l++) {
         if (at(l)->isVisibleInLayerList()) {
              at(l)->freeze(freeze);
+             toggledLayers.append(at(l));
          }
     }
 
-    fireLayerToggled();
+    fireLayerToggled(toggledLayers);
 
 }
 
@@ -440,12 +444,14 @@ void RS_LayerList::freezeAll(bool freeze) {
  */
 void RS_LayerList::lockAll(bool lock) {
 
+    QList<RS_Layer*> toggledLayers;
     for (unsigned l=0; l<count(); l++) {
         if (at(l)->isVisibleInLayerList()) {
              at(l)->lock(lock);
+             toggledLayers.append(at(l));
          }
     }
-    fireLayerToggled();
+    fireLayerToggled(toggledLayers);
 }
 
 void RS_LayerList::toggleLockMulti(QList<RS_Layer*> toggleLayers){
@@ -458,7 +464,7 @@ void RS_LayerList::toggleLockMulti(QList<RS_Layer*> toggleLayers){
         }
     }
 
-    fireLayerToggled();
+    fireLayerToggled(toggleLayers);
 }
 void RS_LayerList::togglePrintMulti(QList<RS_Layer*> toggleLayers){
     int count = toggleLayers.count();
@@ -468,7 +474,7 @@ void RS_LayerList::togglePrintMulti(QList<RS_Layer*> toggleLayers){
             layer->togglePrint();
         }
     }
-    fireLayerToggled();
+    fireLayerToggled(toggleLayers);
 }
 
 void RS_LayerList::toggleConstructionMulti(QList<RS_Layer*> toggleLayers){
@@ -479,7 +485,7 @@ void RS_LayerList::toggleConstructionMulti(QList<RS_Layer*> toggleLayers){
             layer->toggleConstruction();
         }
     }
-    fireLayerToggled();
+    fireLayerToggled(toggleLayers);
 }
 
 void RS_LayerList::setFreezeMulti(QList<RS_Layer*> layersEnable, QList<RS_Layer*> layersDisable){
@@ -497,7 +503,7 @@ void RS_LayerList::setFreezeMulti(QList<RS_Layer*> layersEnable, QList<RS_Layer*
             layer->freeze(true);
         }
     }
-   fireLayerToggled();
+   fireLayerToggled(layersEnable + layersDisable);
 }
 
 void RS_LayerList::setLockMulti(QList<RS_Layer*> layersToUnlock, QList<RS_Layer*> layersToLock){
@@ -515,7 +521,7 @@ void RS_LayerList::setLockMulti(QList<RS_Layer*> layersToUnlock, QList<RS_Layer*
             layer->lock(true);
         }
     }
-    fireLayerToggled();
+    fireLayerToggled(layersToUnlock + layersToLock);
 }
 
 void RS_LayerList::setPrintMulti(QList<RS_Layer*> layersNoPrint, QList<RS_Layer*> layersPrint){
@@ -533,7 +539,7 @@ void RS_LayerList::setPrintMulti(QList<RS_Layer*> layersNoPrint, QList<RS_Layer*
             layer->setPrint(true);
         }
     }
-    fireLayerToggled();
+    fireLayerToggled(layersNoPrint + layersPrint);
 }
 
 void RS_LayerList::setConstructionMulti(QList<RS_Layer*> layersNoConstruction, QList<RS_Layer*> layersConstruction){
@@ -551,7 +557,7 @@ void RS_LayerList::setConstructionMulti(QList<RS_Layer*> layersNoConstruction, Q
             layer->setConstruction(true);
         }
     }
-    fireLayerToggled();
+    fireLayerToggled(layersNoConstruction + layersConstruction);
 }
 
 void RS_LayerList::toggleFreezeMulti(QList<RS_Layer*> toggleLayers){
@@ -562,7 +568,7 @@ void RS_LayerList::toggleFreezeMulti(QList<RS_Layer*> toggleLayers){
             layer->toggle();
         }
     }
-   fireLayerToggled();
+   fireLayerToggled(toggleLayers);
 }
 
 
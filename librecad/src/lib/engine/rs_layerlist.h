@@ -29,6 +29,7 @@
 #ifndef RS_LAYERLIST_H
 #define RS_LAYERLIST_H
 
+#include <QHash>
 #include <QList>
 
 class RS_Layer;
@@ -141,9 +142,15 @@ public:
 
 private:
 
-    void fireLayerToggled();
+    void fireLayerToggled(const QList<RS_Layer*>& toggledLayers);
+    void updateIndex();
 	//! layers in the graphic
     QList<RS_Layer*> layers;
+    //! layers by name, built on demand
+    QHash<QString, RS_Layer*> layerIndex;
+    bool indexValid = false;
+    //! RS_Layer::getRenameCount() when the index was built, layers are renamed directly
+    unsigned indexRenameCount = 0;
     //! List of registered LayerListListeners
     QList<RS_LayerListListener*> layerListListeners;
     QG_LayerWidget *layerWidget = nullptr;
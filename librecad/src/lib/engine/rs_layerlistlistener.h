@@ -29,6 +29,8 @@
 #ifndef RS_LAYERLISTLISTENER_H
 #define RS_LAYERLISTLISTENER_H
 
+#include <QList>
+
 #include "rs_layer.h"
 
 /**
@@ -79,6 +81,14 @@ public:
      */
     virtual void layerToggledConstruction(RS_Layer*) {}
 
+    /**
+     * Called when attributes of several layers are changed at once.
+     * By default like a toggle of all layers.
+     */
+    virtual void layersToggled(const QList<RS_Layer*>& /*layers*/) {
+        layerToggled(nullptr);
+    }
+
     /**
      * Called when layer list is modified.
      */
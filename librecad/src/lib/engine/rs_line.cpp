@@ -28,6 +28,7 @@
 
 #include "rs_line.h"
 
+#include "lc_entitypool.h"
 #include "lc_rect.h"
 #include "qc_applicationwindow.h"
 
@@ -82,9 +83,18 @@ RS_Entity* RS_Line::clone() const {
 	return l;
 }
 
+void* RS_Line::operator new(size_t size) {
+    return LC_EntityPool::forType<RS_Line>().allocate(size);
+}
+
+void RS_Line::operator delete(void* p, size_t size) {
+    LC_EntityPool::forType<RS_Line>().deallocate(p, size);
+}
+
 
 
 void RS_Line::calculateBorders() {
+    touch();
     minV = RS_Vector::minimum(data.startpoint, data.endpoint);
     maxV = RS_Vector::maximum(data.startpoint, data.endpoint);
 }
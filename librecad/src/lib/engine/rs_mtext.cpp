@@ -26,6 +26,12 @@
 
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include <QStringList>
 
 #include "rs_mtext.h"
 
@@ -37,6 +43,85 @@
 #include "rs_math.h"
 #include "rs_painter.h"
 
+namespace {
+
+/**
+ * Layouts of texts, the lines of letters placed for the insertion point at the origin
+ * without rotation. Texts of equal contents and style share the layout: placing a copy
+ * replaces parsing the text, the font lookups and the alignment of the lines.
+ */
+class LayoutCache {
+public:
+  struct Layout {
+    RS_EntityContainer lines{nullptr};
+    double usedTextWidth = 0.;
+    double usedTextHeight = 0.;
+  };
+
+  static QString key(const RS_MTextData &data) {
+    return QStringList{data.text,
+                       data.style,
+                       QString::number(data.height, 'g', 17),
+                       QString::number(data.width, 'g', 17),
+                       QString::number(data.lineSpacingFactor, 'g', 17),
+                       QString::number(data.valign),
+                       QString::number(data.halign),
+                       QString::number(data.drawingDirection),
+                       QString::number(data.lineSpacingStyle)}
+        .join(QChar{0x1f});
+  }
+
+  /**
+   * @return the layout of the key, if any. Layouts are kept for keys laid out
+   * before, so the layouts of texts met once are not copied: keep is set then.
+   */
+  std::shared_ptr<const Layout> find(const QString &key, bool &keep) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto it = m_layouts.find(key);
+    if (it != m_layouts.end())
+      return it->second;
+    if (m_seen.size() >= maxSize)
+      m_seen.clear();
+    keep = !m_seen.insert(key).second;
+    return {};
+  }
+
+  void store(const QString &key, std::shared_ptr<const Layout> layout) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_layouts.size() >= maxSize)
+      m_layouts.clear();
+    m_layouts.emplace(key, std::move(layout));
+  }
+
+private:
+  static constexpr size_t maxSize = 2048;
+  std::mutex m_mutex;
+  std::map<QString, std::shared_ptr<const Layout>> m_layouts;
+  std::set<QString> m_seen;
+};
+
+LayoutCache &layoutCache() {
+  static LayoutCache *cache = new LayoutCache;
+  return *cache;
+}
+
+// copies the text lines of a text or a layout
+void copyLines(const RS_EntityContainer &from, RS_EntityContainer &to) {
+  for (const RS_Entity *line : from) {
+    auto *lineCopy = new RS_EntityContainer(&to);
+    lineCopy->setPen(RS_Pen(RS2::FlagInvalid));
+    lineCopy->setLayer(nullptr);
+    for (const RS_Entity *e : *static_cast<const RS_EntityContainer *>(line)) {
+      RS_Entity *copy = e->clone();
+      copy->reparent(lineCopy);
+      lineCopy->addEntity(copy);
+    }
+    lineCopy->forcedCalculateBorders();
+    to.addEntity(lineCopy);
+  }
+}
+} // namespace
+
 RS_MTextData::RS_MTextData(const RS_Vector &_insertionPoint, double _height,
                            double _width, VAlign _valign, HAlign _halign,
                            MTextDrawingDirection _drawingDirection,
@@ -184,6 +269,7 @@ void RS_MText::update() {
   RS_DEBUG->print("RS_MText::update");
 
   clear();
+  glyphs.reset();
   if (isUndone()) {
     return;
   }
@@ -196,6 +282,18 @@ void RS_MText::update() {
     return;
   }
 
+  const QString layoutKey = LayoutCache::key(data);
+  bool keepLayout = false;
+  if (const auto layout = layoutCache().find(layoutKey, keepLayout)) {
+    copyLines(layout->lines, *this);
+    usedTextWidth = layout->usedTextWidth;
+    usedTextHeight = layout->usedTextHeight;
+    RS_EntityContainer::move(data.insertionPoint);
+    RS_EntityContainer::rotate(data.insertionPoint, data.angle);
+    forcedCalculateBorders();
+    return;
+  }
+
   RS_Vector letterPos{0.0, -9.0};
   RS_Vector letterSpace{font->getLetterSpacing(), 0.0};
   RS_Vector space{font->getWordSpacing(), 0.0};
@@ -369,6 +467,16 @@ void RS_MText::update() {
   updateAddLine(oneLine, lineCounter);
 
   alignVertically();
+
+  if (keepLayout) {
+    auto layout = std::make_shared<LayoutCache::Layout>();
+    copyLines(*this, layout->lines);
+    layout->lines.rotate(data.insertionPoint, -data.angle);
+    layout->lines.move(-data.insertionPoint);
+    layout->usedTextWidth = usedTextWidth;
+    layout->usedTextHeight = usedTextHeight;
+    layoutCache().store(layoutKey, std::move(layout));
+  }
   RS_DEBUG->print("RS_MText::update: OK");
 }
 
@@ -535,6 +643,7 @@ RS_VectorSolutions RS_MText::getRefPoints() const {
 
 void RS_MText::move(const RS_Vector &offset) {
   RS_EntityContainer::move(offset);
+  glyphs.reset();
   data.insertionPoint.move(offset);
   //    update();
 }
@@ -542,12 +651,14 @@ void RS_MText::move(const RS_Vector &offset) {
 void RS_MText::rotate(const RS_Vector &center, const double &angle) {
   RS_Vector angleVector(angle);
   RS_EntityContainer::rotate(center, angleVector);
+  glyphs.reset();
   data.insertionPoint.rotate(center, angleVector);
   data.angle = RS_Math::correctAngle(data.angle + angle);
   //    update();
 }
 void RS_MText::rotate(const RS_Vector &center, const RS_Vector &angleVector) {
   RS_EntityContainer::rotate(center, angleVector);
+  glyphs.reset();
   data.insertionPoint.rotate(center, angleVector);
   data.angle = RS_Math::correctAngle(data.angle + angleVector.angle());
   //    update();
@@ -562,6 +673,7 @@ void RS_MText::scale(const RS_Vector &center, const RS_Vector &factor) {
 
 void RS_MText::mirror(const RS_Vector &axisPoint1,
                       const RS_Vector &axisPoint2) {
+  runDeferredUpdate();
   data.insertionPoint.mirror(axisPoint1, axisPoint2);
   // double ang = axisPoint1.angleTo(axisPoint2);
   bool readable = RS_Math::isAngleReadable(data.angle);
@@ -600,6 +712,7 @@ bool RS_MText::hasEndpointsWithinWindow(const RS_Vector & /*v1*/,
  */
 void RS_MText::stretch(const RS_Vector &firstCorner,
                        const RS_Vector &secondCorner, const RS_Vector &offset) {
+  runDeferredUpdate();
 
   if (getMin().isInWindow(firstCorner, secondCorner) &&
       getMax().isInWindow(firstCorner, secondCorner)) {
@@ -617,9 +730,10 @@ std::ostream &operator<<(std::ostream &os, const RS_MText &p) {
 }
 
 void RS_MText::draw(RS_Painter *painter, RS_GraphicView *view,
-                    double & /*patternOffset*/) {
+                    double &patternOffset) {
   if (!(painter && view))
     return;
+  runDeferredUpdate();
 
   if (!view->isPrintPreview() && !view->isPrinting()) {
     if (view->isPanning() || view->toGuiDY(getHeight()) < 4) {
@@ -628,8 +742,16 @@ void RS_MText::draw(RS_Painter *painter, RS_GraphicView *view,
     }
   }
 
-  double patternOffset = 0.0;
+  // all letters in one path, instead of a path per letter line
+  const auto letters = glyphs.get(*this);
+  if (letters != nullptr) {
+    if (view->isDrawnBy(painter, this))
+      letters->draw(painter, view, *this, patternOffset);
+    return;
+  }
+
+  double lettersOffset = 0.0;
 
   foreach (RS_Entity *entity, entities)
-    entity->draw(painter, view, patternOffset);
+    entity->draw(painter, view, lettersOffset);
 }
@@ -27,6 +27,7 @@
 #ifndef RS_MTEXT_H
 #define RS_MTEXT_H
 
+#include "lc_blockdrawlist.h"
 #include "rs_entitycontainer.h"
 #include <iosfwd>
 
@@ -184,8 +185,14 @@ public:
   QString getStyle() const { return data.style; }
   void setAngle(double a) { data.angle = a; }
   double getAngle() const { return data.angle; }
-  double getUsedTextWidth() const { return usedTextWidth; }
-  double getUsedTextHeight() const { return usedTextHeight; }
+  double getUsedTextWidth() const {
+    runDeferredUpdate();
+    return usedTextWidth;
+  }
+  double getUsedTextHeight() const {
+    runDeferredUpdate();
+    return usedTextHeight;
+  }
 
   //	virtual double getLength() const {
   //		return -1.0;
@@ -241,6 +248,8 @@ protected:
    * @see update
    */
   double usedTextHeight = 0.;
+  /** The letters drawn as one path, compiled when the text is drawn */
+  LC_TextGlyphs glyphs;
 };
 
 #endif
@@ -43,7 +43,7 @@ RS_Pattern::RS_Pattern(const QString& fileName)
 		,fileName(fileName)
 		,loaded(false)
 {
-	RS_DEBUG->print("RS_Pattern::RS_Pattern() ");
+	LC_DEBUG_TRACE("RS_Pattern::RS_Pattern() ");
 }
 
 
@@ -75,7 +75,7 @@ bool RS_Pattern::loadPattern() {
         return true;
     }
 
-    RS_DEBUG->print("RS_Pattern::loadPattern");
+    LC_DEBUG_TRACE("RS_Pattern::loadPattern");
 
     // Search for the appropriate pattern if we have only the name of the pattern:
     QString path;
@@ -84,12 +84,12 @@ bool RS_Pattern::loadPattern() {
         foreach (const QString& path0, RS_SYSTEM->getPatternList()) {
             if (QFileInfo(path0).baseName().toLower()==fileName.toLower()) {
                 path = path0;
-                RS_DEBUG->print("Pattern found: %s", path.toLatin1().data());
+                LC_DEBUG_TRACE("Pattern found: %s", path.toLatin1().data());
                 break;
             }
         }
         if (path.isEmpty()) {
-                RS_DEBUG->print("Pattern not found: %s", fileName.toLatin1().data());
+                LC_DEBUG_TRACE("Pattern not found: %s", fileName.toLatin1().data());
         }
     }
 
@@ -100,7 +100,7 @@ bool RS_Pattern::loadPattern() {
 
     // No pattern paths found:
     if (path.isEmpty()) {
-        RS_DEBUG->print("No pattern \"%s\"available.", fileName.toLatin1().data());
+        LC_DEBUG_TRACE("No pattern \"%s\"available.", fileName.toLatin1().data());
         return false;
     }
 
@@ -121,8 +121,9 @@ bool RS_Pattern::loadPattern() {
         }
 	}
 
+    calculateBorders();
     loaded = true;
-    RS_DEBUG->print("RS_Pattern::loadPattern: OK");
+    LC_DEBUG_TRACE("RS_Pattern::loadPattern: OK");
 
     return true;
 }
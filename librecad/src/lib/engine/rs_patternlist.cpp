@@ -32,6 +32,7 @@
 #include "rs_pattern.h"
 #include "rs_patternlist.h"
 #include "rs_system.h"
+#include "rs_vector.h"
 
 RS_PatternList* RS_PatternList::instance() {
 	static RS_PatternList instance;
@@ -41,23 +42,38 @@ RS_PatternList* RS_PatternList::instance() {
 RS_PatternList::~RS_PatternList() = default;
 
 /**
- * Initializes the pattern list by creating empty RS_Pattern 
+ * Initializes the pattern list by creating empty RS_Pattern
  * objects, one for each pattern that could be found.
+ * The pattern directories are searched in the background, the list
+ * is completed when it is first used.
  */
 void RS_PatternList::init() {
-    RS_DEBUG->print("RS_PatternList::initPatterns");
-
-	QStringList list = RS_SYSTEM->getPatternList();
+    LC_DEBUG_TRACE("RS_PatternList::initPatterns");
 
 	patterns.clear();
+	paths.clear();
+	transformed.clear();
+	patternFiles = RS_SYSTEM->getFileListAsync("patterns", {"dxf"});
+}
+
+/**
+ * Waits for the pattern directories searched after init(), and lists the patterns found.
+ */
+void RS_PatternList::loadPatternList() const {
+	if (!patternFiles.valid())
+		return;
+
+	const QStringList list = patternFiles.get();
+	patternFiles = {};
 
     foreach(auto const& s, list) {
-        RS_DEBUG->print("pattern: %s:", s.toLatin1().data());
+        LC_DEBUG_TRACE("pattern: %s:", s.toLatin1().data());
 
         QString const name = QFileInfo(s).baseName().toLower();
-        patterns.emplace(name, std::unique_ptr<RS_Pattern>{});
+        patterns.emplace(name, nullptr);
+        paths.emplace(name, s);
 
-        RS_DEBUG->print("base: %s", name.toLatin1().data());
+        LC_DEBUG_TRACE("base: %s", name.toLatin1().data());
     }
     if (patterns.empty())
         RS_DIALOGFACTORY->commandMessage(QObject::tr("Hatch:: no pattern found. Please set pattern path in application preferences"));
@@ -67,19 +83,22 @@ void RS_PatternList::init() {
 /**
  * @return Pointer to the pattern with the given name or
  * \p NULL if no such pattern was found. The pattern will be loaded into
- * memory if it's not already.
+ * memory if it's not already. Loaded patterns are shared, not copied.
  */
-std::unique_ptr<RS_Pattern> RS_PatternList::requestPattern(const QString& name) {
-    RS_DEBUG->print("RS_PatternList::requestPattern %s", name.toLatin1().data());
+std::shared_ptr<const RS_Pattern> RS_PatternList::requestPattern(const QString& name) {
+    LC_DEBUG_TRACE("RS_PatternList::requestPattern %s", name.toLatin1().data());
+    std::lock_guard<std::recursive_mutex> lock(requestMutex);
 
     QString name2 = name.toLower();
-    RS_DEBUG->print("Pattern: name2: %s", name2.toLatin1().data());
+    LC_DEBUG_TRACE("Pattern: name2: %s", name2.toLatin1().data());
+    loadPatternList();
     if (patterns.count(name2) == 0 || patterns.at(name2) == nullptr) {
-        auto p = std::make_unique<RS_Pattern>(name2);
+        // load from the file found by init(), if any
+        const auto path = paths.find(name2);
+        auto p = std::make_shared<RS_Pattern>(path != paths.end() ? path->second : name2);
         if (p!=nullptr) {
             if (p->loadPattern()) {
-                patterns.emplace(name2,  std::unique_ptr<RS_Pattern>{});
-                patterns[name2].swap(p);
+                patterns[name2] = std::move(p);
             }
             else {
                 patterns.erase(name2);
@@ -93,17 +112,50 @@ std::unique_ptr<RS_Pattern> RS_PatternList::requestPattern(const QString& name)
     }
 
     if (patterns.count(name2) == 1) {
-        RS_DEBUG->print("name2: %s, size= %d", name2.toLatin1().data(),
+        LC_DEBUG_TRACE("name2: %s, size= %d", name2.toLatin1().data(),
                         patterns[name2]->countDeep());
-        return std::unique_ptr<RS_Pattern>{static_cast<RS_Pattern*>(patterns[name2]->clone())};
+        return patterns[name2];
 	}
 
     return {};
 
 }
 
+/**
+ * @return the pattern with the given name, scaled by a factor, and rotated
+ * by an angle around its lower left corner, which is moved to the origin.
+ * Hatches of the same pattern, scale and angle share the transformed copy.
+ */
+std::shared_ptr<const RS_Pattern> RS_PatternList::requestPattern(const QString& name,
+                                                                 double scale, double angle) {
+    std::lock_guard<std::recursive_mutex> lock(requestMutex);
+    const auto key = std::make_tuple(name.toLower(), scale, angle);
+    auto it = transformed.find(key);
+    if (it != transformed.end())
+        return it->second;
+
+    std::shared_ptr<const RS_Pattern> pattern = requestPattern(name);
+    if (pattern == nullptr)
+        return {};
+
+    std::shared_ptr<RS_Pattern> copy{static_cast<RS_Pattern*>(pattern->clone())};
+    copy->scale(RS_Vector(0.0,0.0), RS_Vector(scale, scale));
+    copy->calculateBorders();
+    const RS_Vector corner = copy->getMin();
+    copy->rotate(corner, angle);
+    copy->move(-corner);
+    copy->calculateBorders();
+
+    // bounded, in case of many different scales and angles
+    if (transformed.size() >= 256)
+        transformed.clear();
+    transformed.emplace(key, copy);
+    return copy;
+}
+
 	
 bool RS_PatternList::contains(const QString& name) const {
+	loadPatternList();
 
 	return patterns.count(name.toLower());
 
@@ -116,6 +168,7 @@ bool RS_PatternList::contains(const QString& name) const {
 std::ostream& operator << (std::ostream& os, RS_PatternList& l) {
 
     os << "Patternlist: \n";
+	l.loadPatternList();
 	for (auto const& pa: l.patterns)
 		if (pa.second)
 			os<< *pa.second << '\n';
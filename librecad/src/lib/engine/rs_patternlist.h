@@ -28,11 +28,15 @@
 #ifndef RS_PATTERNLIST_H
 #define RS_PATTERNLIST_H
 
+#include<future>
 #include<map>
 #include<memory>
+#include<mutex>
+#include<tuple>
+
+#include<QStringList>
 
 class RS_Pattern;
-class QString;
 
 #define RS_PATTERNLIST RS_PatternList::instance()
 
@@ -43,7 +47,7 @@ class QString;
  * @author Andrew Mustun
  */
 class RS_PatternList {
-	using PTN_MAP = std::map<QString, std::unique_ptr<RS_Pattern>>;
+	using PTN_MAP = std::map<QString, std::shared_ptr<const RS_Pattern>>;
 	RS_PatternList() = default;
 
 public:
@@ -61,25 +65,31 @@ public:
 	void init();
 
 	int countPatterns() const {
+		loadPatternList();
 		return static_cast<int>(patterns.size());
     }
 
 	//! \{ range based loop support
 	PTN_MAP::iterator begin() {
+		loadPatternList();
 		return patterns.begin();
 	}
     PTN_MAP::const_iterator cbegin() const{
+		loadPatternList();
         return patterns.cbegin();
 	}
 	PTN_MAP::iterator end() {
+		loadPatternList();
 		return patterns.end();
 	}
     PTN_MAP::const_iterator cend() const{
+		loadPatternList();
         return patterns.cend();
 	}
 	//! \}
 
-    std::unique_ptr<RS_Pattern> requestPattern(const QString& name);
+    std::shared_ptr<const RS_Pattern> requestPattern(const QString& name);
+    std::shared_ptr<const RS_Pattern> requestPattern(const QString& name, double scale, double angle);
 
 	bool contains(const QString& name) const;
 
@@ -87,8 +97,18 @@ public:
 
 
 private:
+    void loadPatternList() const;
+
+    //! pattern files, while they are searched for after init()
+    mutable std::shared_future<QStringList> patternFiles;
     //! patterns in the graphic
-    PTN_MAP patterns;
+    mutable PTN_MAP patterns;
+    //! pattern file paths, by pattern name
+    mutable std::map<QString, QString> paths;
+    //! scaled and rotated patterns, by name, scale and angle
+    std::map<std::tuple<QString, double, double>, std::shared_ptr<const RS_Pattern>> transformed;
+    //! patterns are requested by drawings imported in worker threads, too
+    std::recursive_mutex requestMutex;
 };
 
 #endif
@@ -32,6 +32,7 @@
 #include "rs_painter.h"
 #include "rs_debug.h"
 #include "lc_defaults.h"
+#include "lc_entitypool.h"
 
 RS_Point::RS_Point(RS_EntityContainer* parent,
                    const RS_PointData& d)
@@ -45,12 +46,21 @@ RS_Entity* RS_Point::clone() const {
 	return p;
 }
 
+void* RS_Point::operator new(size_t size) {
+    return LC_EntityPool::forType<RS_Point>().allocate(size);
+}
+
+void RS_Point::operator delete(void* p, size_t size) {
+    LC_EntityPool::forType<RS_Point>().deallocate(p, size);
+}
+
 RS2::EntityType RS_Point::rtti() const
 {
     return RS2::EntityPoint;
 }
 
 void RS_Point::calculateBorders () {
+    touch();
     minV = maxV = data.pos;
 }
 
@@ -27,12 +27,14 @@
 #include <cassert>
 #include<cmath>
 #include<iostream>
+#include <memory>
 
 
 #include "rs_line.h"
 #include "rs_debug.h"
 #include "qc_applicationwindow.h"
 
+#include "lc_entitypool.h"
 #include "rs_arc.h"
 #include "rs_debug.h"
 #include "rs_document.h"
@@ -95,6 +97,14 @@ RS_Entity* RS_Polyline::clone() const {
 	return p;
 }
 
+void* RS_Polyline::operator new(size_t size) {
+    return LC_EntityPool::forType<RS_Polyline>().allocate(size);
+}
+
+void RS_Polyline::operator delete(void* p, size_t size) {
+    LC_EntityPool::forType<RS_Polyline>().deallocate(p, size);
+}
+
 
 bool RS_Polyline::toggleSelected()
 {
@@ -349,7 +359,7 @@ void RS_Polyline::setLayer(const QString& name) {
 }
 
 void RS_Polyline::setLayer(RS_Layer* l) {
-    layer = l;
+    RS_Entity::setLayer(l);
     // set layer for sub-entities
     for (auto *e : entities) {
         e->setLayer(layer);
@@ -424,6 +434,74 @@ void RS_Polyline::addEntity(RS_Entity* /*entity*/) {
 	assert(false);
 }
 
+bool RS_Polyline::removeEntity(RS_Entity* entity) {
+    invalidateVertices();
+    return RS_EntityContainer::removeEntity(entity);
+}
+
+int RS_Polyline::removeEntities(const std::vector<RS_Entity*>& removed) {
+    invalidateVertices();
+    return RS_EntityContainer::removeEntities(removed);
+}
+
+void RS_Polyline::clear() {
+    invalidateVertices();
+    RS_EntityContainer::clear();
+}
+
+void RS_Polyline::calculateBorders() {
+    // all changes of the segments end with recalculating the borders
+    invalidateVertices();
+    RS_EntityContainer::calculateBorders();
+}
+
+void RS_Polyline::invalidateVertices() {
+    std::atomic_store(&vertices, std::shared_ptr<const std::vector<RS_PolylineVertex>>{});
+}
+
+std::shared_ptr<const std::vector<RS_PolylineVertex>> RS_Polyline::getVertices() const {
+    // drawing threads may build the same array at once, each one stores a complete array
+    std::shared_ptr<const std::vector<RS_PolylineVertex>> cached = std::atomic_load(&vertices);
+    if (cached != nullptr)
+        return cached;
+    auto built = std::make_shared<std::vector<RS_PolylineVertex>>();
+    built->reserve(entities.size() + 1);
+    const RS_Entity* last = nullptr;
+    for (const RS_Entity* e: entities) {
+        if (!e->isAtomic())
+            continue;
+        const double bulge = e->rtti() == RS2::EntityArc ? static_cast<const RS_Arc*>(e)->getBulge() : 0.;
+        built->push_back({e->getStartpoint(), bulge});
+        last = e;
+    }
+    if (last != nullptr)
+        built->push_back({last->getEndpoint(), 0.});
+    cached = std::move(built);
+    std::atomic_store(&vertices, cached);
+    return cached;
+}
+
+/**
+ * @return The length of the segments, from the vertex array.
+ */
+double RS_Polyline::getLength() const {
+    const std::shared_ptr<const std::vector<RS_PolylineVertex>> vertexArray = getVertices();
+    const std::vector<RS_PolylineVertex>& v = *vertexArray;
+    double length = 0.;
+    for (size_t i = 0; i + 1 < v.size(); ++i) {
+        const double chord = v[i].point.distanceTo(v[i + 1].point);
+        if (std::abs(v[i].bulge) < RS_TOLERANCE) {
+            length += chord;
+            continue;
+        }
+        // the arc of the included angle alpha over the chord
+        const double alpha = 4. * std::atan(std::abs(v[i].bulge));
+        const double sinHalf = std::sin(alpha / 2.);
+        length += sinHalf > RS_TOLERANCE ? chord * alpha / (2. * sinHalf) : entities.at(int(i))->getLength();
+    }
+    return length;
+}
+
 
 /**
  * Adds a segment to the polyline.
@@ -693,6 +771,7 @@ void RS_Polyline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 
 void RS_Polyline::revertDirection() {
 	RS_EntityContainer::revertDirection();
+	invalidateVertices();
 	RS_Vector tmp = data.startpoint;
 	data.startpoint = data.endpoint;
 	data.endpoint = tmp;
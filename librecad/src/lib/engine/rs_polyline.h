@@ -28,7 +28,7 @@
 #pragma once
 
 #include <memory>
-
+#include <vector>
 
 #include "rs_entitycontainer.h"
 
@@ -48,6 +48,14 @@ struct RS_PolylineData : public RS_Flags {
 
 std::ostream& operator << (std::ostream& os, const RS_PolylineData& pd);
 
+/**
+ * A vertex of a polyline, with the bulge of the segment starting at it.
+ */
+struct RS_PolylineVertex {
+    RS_Vector point;
+    double bulge = 0.;
+};
+
 /**
  * Class for a poly line entity (lots of connected lines and arcs).
  *
@@ -61,6 +69,10 @@ public:
 
 	RS_Entity* clone() const override;
 
+	// allocated from a pool, see LC_EntityPool
+	static void* operator new(size_t size);
+	static void operator delete(void* p, size_t size);
+
     /**	@return RS2::EntityPolyline */
 	RS2::EntityType rtti() const  override{
         return RS2::EntityPolyline;
@@ -118,7 +130,20 @@ public:
 	void setNextBulge(double bulge) {
                 nextBulge = bulge;
         }
+
+    /**
+     * @brief getVertices - the vertices as a flat array, built on demand after the polyline
+     * changed. Segment i runs from vertex i to vertex i + 1, the bulge of the last vertex is 0.
+     * The array stays valid while held, even if the polyline changes.
+     */
+    std::shared_ptr<const std::vector<RS_PolylineVertex>> getVertices() const;
+
 	void addEntity(RS_Entity* entity) override;
+    bool removeEntity(RS_Entity* entity) override;
+    int removeEntities(const std::vector<RS_Entity*>& removed) override;
+    void clear() override;
+    void calculateBorders() override;
+    double getLength() const override;
 	//void addSegment(RS_Entity* entity) override;
 	void removeLastVertex();
 	void endPolyline();
@@ -154,6 +179,10 @@ protected:
     double nextBulge = 0.;
 
     private:
+        void invalidateVertices();
 
         RS_Vector highlightedVertex;
+        // the flat vertex array of the segments, see getVertices(). Loaded and stored atomically,
+        // nullptr until built
+        mutable std::shared_ptr<const std::vector<RS_PolylineVertex>> vertices;
 };
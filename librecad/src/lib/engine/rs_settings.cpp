@@ -117,7 +117,8 @@ bool RS_Settings::writeEntry(const QString& key, const QVariant& value) {
     // RVT_PORT not supported anymore s.insertSearchPath(QSettings::Windows, companyKey);
 
     s.setValue(QString("%1%2").arg(m_group).arg(key), value);
-	cache[key]=value;
+	cache[m_group + key]=value;
+	++m_revision;
 
     return true;
 }
@@ -138,7 +139,7 @@ QString RS_Settings::readEntry(const QString& key,
 		}
 		
         ret = s.value(QString("%1%2").arg(m_group).arg(key), QVariant(def));
-		cache[key]=ret;
+		cache[m_group + key]=ret;
     }
 
     return ret.toString();
@@ -159,7 +160,7 @@ QByteArray RS_Settings::readByteArrayEntry(const QString& key,
                 }
 
         ret = s.value(QString("%1%2").arg(m_group).arg(key), QVariant(def));
-		cache[key]=ret;
+		cache[m_group + key]=ret;
     }
 
     return ret.toByteArray();
@@ -175,7 +176,7 @@ int RS_Settings::readNumEntry(const QString& key, int def)
         QString str = QString("%1%2").arg(m_group).arg(key);
 		// qDebug() << str;
 		value = s.value(str, QVariant(def));
-		cache[key] = value;
+		cache[m_group + key] = value;
 	}
     unsigned long long uValue = value.toULongLong();
     uValue = uValue % 0x80000000ull;
@@ -183,20 +184,50 @@ int RS_Settings::readNumEntry(const QString& key, int def)
 }
 
 
+const RS_Settings::Snapshot& RS_Settings::snapshot() {
+    if (!m_snapshotValid || m_snapshotRevision != m_revision)
+        readSnapshot();
+    return m_snapshot;
+}
+
+void RS_Settings::readSnapshot() {
+    const QString group = m_group;
+
+    m_group = "/Appearance";
+    m_snapshot.draftMode = readNumEntry("/DraftMode", 0) != 0;
+    m_snapshot.hatchPatternTextures = readNumEntry("/HatchPatternTextures", 0) != 0;
+    m_snapshot.unitlessGrid = readNumEntry("/UnitlessGrid", 1) == 1;
+    m_snapshot.autopanning = readNumEntry("/Autopanning", 0) != 0;
+    m_snapshot.visualizeHovering = readNumEntry("/VisualizeHovering", 0) != 0;
+    m_snapshot.maxPreview = readNumEntry("/MaxPreview", 100);
+
+    m_group = "/Defaults";
+    m_snapshot.invertZoomDirection = readNumEntry("/InvertZoomDirection", 0) == 1;
+    m_snapshot.wheelScrollInvertH = readNumEntry("/WheelScrollInvertH", 0) == 1;
+    m_snapshot.wheelScrollInvertV = readNumEntry("/WheelScrollInvertV", 0) == 1;
+
+    m_group = group;
+    m_snapshotRevision = m_revision;
+    m_snapshotValid = true;
+}
+
+// the cache is by group and key, as keys are repeated in different groups
 QVariant RS_Settings::readEntryCache(const QString& key) {
-	if(!cache.count(key)) return QVariant();
-	return cache[key];
+	const auto it = cache.find(m_group + key);
+	return it != cache.end() ? it->second : QVariant();
 }
 
 
 void RS_Settings::addToCache(const QString& key, const QVariant& value) {
-    cache[key]=value;
+    cache[m_group + key]=value;
 }
 
 void RS_Settings::clear_all()
 {
     QSettings s(companyKey, appKey);
     s.clear();
+    cache.clear();
+    ++m_revision;
     save_is_allowed = false;
 }
 
@@ -105,6 +105,31 @@ public:
                         const QString& def = QString(),
                         bool* ok = 0);
 	int readNumEntry(const QString& key, int def=0);
+
+    /**
+     * Settings read while drawing, snapping and handling mouse events, kept
+     * as plain values, so these don't look up the settings every time.
+     */
+    struct Snapshot {
+        // "/Appearance"
+        bool draftMode = false;
+        bool hatchPatternTextures = false;
+        bool unitlessGrid = true;
+        bool autopanning = false;
+        bool visualizeHovering = false;
+        int maxPreview = 100;
+        // "/Defaults"
+        bool invertZoomDirection = false;
+        bool wheelScrollInvertH = false;
+        bool wheelScrollInvertV = false;
+    };
+    //! @return the settings snapshot, read again after any setting has changed
+    const Snapshot& snapshot();
+    //! @return a number incremented whenever a setting is changed, to refresh values read from the settings
+    unsigned revision() const {
+        return m_revision;
+    }
+
     void clear_all();
     void clear_geometry();
     static bool save_is_allowed;
@@ -116,9 +141,15 @@ private:
 	QVariant readEntryCache(const QString& key);
 	void addToCache(const QString& key, const QVariant& value);
 
+	void readSnapshot();
+
 protected:
 
 	std::map<QString, QVariant> cache;
+	Snapshot m_snapshot;
+	unsigned m_revision = 0;
+	unsigned m_snapshotRevision = 0;
+	bool m_snapshotValid = false;
     QString companyKey;
     QString appKey;
     QString m_group;
@@ -132,6 +132,7 @@ void RS_Solid::shapeArrow(const RS_Vector& point,
 
 void RS_Solid::calculateBorders()
 {
+    touch();
     resetBorders();
 
     for (int i = RS_SolidData::FirstCorner; i < RS_SolidData::MaxCorners; ++i) {
@@ -25,6 +25,8 @@
 **********************************************************************/
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <numeric>
@@ -167,6 +169,7 @@ void RS_Spline::update() {
     RS_DEBUG->print("RS_Spline::update");
 
     clear();
+    invalidateTessellation();
 
     if (isUndone()) {
         return;
@@ -312,6 +315,7 @@ RS_Vector RS_Spline::getNearestDist(double /*distance*/,
 
 void RS_Spline::move(const RS_Vector& offset) {
     RS_EntityContainer::move(offset);
+    invalidateTessellation();
 	for (RS_Vector& vp: data.controlPoints) {
 		vp.move(offset);
     }
@@ -327,6 +331,7 @@ void RS_Spline::rotate(const RS_Vector& center, const double& angle) {
 
 void RS_Spline::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
 	RS_EntityContainer::rotate(center, angleVector);
+	invalidateTessellation();
 	for (RS_Vector& vp: data.controlPoints) {
 		vp.rotate(center, angleVector);
 	}
@@ -373,6 +378,7 @@ void RS_Spline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 
 void RS_Spline::revertDirection() {
 	std::reverse(data.controlPoints.begin(), data.controlPoints.end());
+	invalidateTessellation();
 }
 
 
@@ -381,6 +387,7 @@ void RS_Spline::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patter
 	if (!(painter && view)) {
         return;
     }
+    runDeferredUpdate();
 
     painter->drawSpline(*this, *view);
 }
@@ -475,6 +482,7 @@ void RS_Spline::addControlPoint(const RS_Vector& v) {
     } else {
         data.controlPoints.push_back(v);
     }
+    invalidateTessellation();
 }
 
 
@@ -488,6 +496,7 @@ void RS_Spline::removeLastControlPoint() {
     } else {
         data.controlPoints.pop_back();
     }
+    invalidateTessellation();
 }
 
 
@@ -572,6 +581,120 @@ std::vector<double> rbasis(int c, double t, int npts,
 	}
 	return r;
 }
+
+// the highest order of RS_Spline, a cubic spline
+constexpr size_t maxSplineOrder = 4;
+
+/**
+ * Evaluates a B-spline with unit weights by the de Boor recurrence of the basis functions.
+ * Only the basis functions of the knot span of a parameter are non-zero, at most
+ * maxSplineOrder of them, so they are computed in fixed size arrays without allocation.
+ * Parameters out of the spans, or knot vectors it can't handle, fall back to rbasis().
+ */
+class SplineEvaluator {
+public:
+    SplineEvaluator(size_t order,
+                    const std::vector<RS_Vector>& controlPoints,
+                    const std::vector<double>& knots):
+        m_order{order}
+      , m_controlPoints{controlPoints}
+      , m_knots{knots}
+      , m_valid{order >= 1 && order <= maxSplineOrder
+                && controlPoints.size() >= order
+                && knots.size() == controlPoints.size() + order
+                && knots[order - 1] < knots[controlPoints.size()]}
+    {}
+
+    RS_Vector pointAt(double t) const
+    {
+        if (!isInSpans(t))
+            return pointByBasis(t);
+        return pointInSpan(findSpan(t, m_order - 1), t);
+    }
+
+    /**
+     * @brief evaluate the points at increasing parameters
+     */
+    void evaluate(const std::vector<double>& parameters, std::vector<RS_Vector>& points) const
+    {
+        points.resize(parameters.size());
+        size_t span = m_order - 1;
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            const double t = parameters[i];
+            if (isInSpans(t)) {
+                // the span only moves forward, so it's found by stepping from the last one
+                if (t < m_knots[span])
+                    span = m_order - 1;
+                span = findSpan(t, span);
+                points[i] = pointInSpan(span, t);
+            } else {
+                points[i] = pointByBasis(t);
+            }
+        }
+    }
+
+private:
+    bool isInSpans(double t) const
+    {
+        return m_valid && t >= m_knots[m_order - 1] && t < m_knots[m_controlPoints.size()];
+    }
+
+    // the span i with knots[i] <= t < knots[i+1], searched from the span given
+    size_t findSpan(double t, size_t span) const
+    {
+        while (t >= m_knots[span + 1])
+            ++span;
+        return span;
+    }
+
+    RS_Vector pointInSpan(size_t span, double t) const
+    {
+        // the basis functions of order j + 1, N[r] belongs to the control point span - j + r
+        std::array<double, maxSplineOrder> basis{};
+        std::array<double, maxSplineOrder> left{};
+        std::array<double, maxSplineOrder> right{};
+        basis[0] = 1.;
+        for (size_t j = 1; j < m_order; ++j) {
+            left[j] = t - m_knots[span + 1 - j];
+            right[j] = m_knots[span + j] - t;
+            double saved = 0.;
+            for (size_t r = 0; r < j; ++r) {
+                const double temp = basis[r] / (right[r + 1] + left[j - r]);
+                basis[r] = saved + right[r + 1] * temp;
+                saved = left[j - r] * temp;
+            }
+            basis[j] = saved;
+        }
+
+        RS_Vector vp{0., 0.};
+        const size_t first = span + 1 - m_order;
+        for (size_t r = 0; r < m_order; ++r)
+            vp += m_controlPoints[first + r] * basis[r];
+        return vp;
+    }
+
+    RS_Vector pointByBasis(double t) const
+    {
+        const size_t npts = m_controlPoints.size();
+        if (m_knots.size() != npts + m_order)
+            return RS_Vector{false};
+        auto const nbasis = rbasis(m_order, t, npts, m_knots, std::vector<double>(npts + 1, 1.));
+        RS_Vector vp{0., 0.};
+        for (size_t i = 0; i < npts; i++)
+            vp += m_controlPoints[i] * nbasis[i];
+        return vp;
+    }
+
+    size_t m_order = 0;
+    const std::vector<RS_Vector>& m_controlPoints;
+    const std::vector<double>& m_knots;
+    bool m_valid = false;
+};
+
+bool hasUnitWeights(const std::vector<double>& weights)
+{
+    return std::all_of(weights.cbegin(), weights.cend(), [](double w) { return w == 1.; });
+}
 }
 
 
@@ -591,6 +714,17 @@ void RS_Spline::rbspline(size_t npts, size_t k, size_t p1,
     double t {x[0]};
     double const step {(x[nplusc-1] - t) / (p1-1)};
 
+	if (hasUnitWeights(h)) {
+		std::vector<double> parameters(p.size());
+		for (double& parameter: parameters) {
+			if (x[nplusc-1] - t < 5e-6) t = x[nplusc-1];
+			parameter = t;
+			t += step;
+		}
+		SplineEvaluator{k, b, x}.evaluate(parameters, p);
+		return;
+	}
+
 	for (auto& vp: p) {
 		if (x[nplusc-1] - t < 5e-6) t = x[nplusc-1];
 
@@ -633,6 +767,17 @@ void RS_Spline::rbsplinu(size_t npts, size_t k, size_t p1,
 	double t = k-1;
 	double const step = double(npts - k + 1)/(p1 - 1);
 
+	if (hasUnitWeights(h)) {
+		std::vector<double> parameters(p.size());
+		for (double& parameter: parameters) {
+			if (x[nplusc-1] - t < 5e-6) t = x[nplusc-1];
+			parameter = t;
+			t += step;
+		}
+		SplineEvaluator{k, b, x}.evaluate(parameters, p);
+		return;
+	}
+
 	for (auto& vp: p) {
 		if (x[nplusc-1] - t < 5e-6) t = x[nplusc-1];
 
@@ -648,6 +793,111 @@ void RS_Spline::rbsplinu(size_t npts, size_t k, size_t p1,
 }
 
 
+namespace {
+// the deepest bisection of an initial parameter interval
+constexpr int maxTessellationDepth = 12;
+// initial parameter intervals per knot span, so inflections within a span are not missed
+constexpr size_t tessellationSpanIntervals = 4;
+
+// the distance from a point to the chord from p0 to p1
+double getChordDistance(const RS_Vector& point, const RS_Vector& p0, const RS_Vector& p1)
+{
+    const RS_Vector chord = p1 - p0;
+    const double length2 = chord.squared();
+    if (length2 < RS_TOLERANCE2)
+        return point.distanceTo(p0);
+    const double u = std::clamp(RS_Vector::dotP(point - p0, chord) / length2, 0., 1.);
+    return point.distanceTo(p0 + chord * u);
+}
+
+/**
+ * The bisection of the parameter intervals of a B-spline with unit weights.
+ */
+struct SplineTessellator {
+    SplineEvaluator evaluator;
+    double tolerance = 0.;
+    std::vector<RS_Vector>& vertices;
+
+    RS_Vector pointAt(double t) const {
+        return evaluator.pointAt(t);
+    }
+
+    // appends the vertices after p0 up to p1, bisecting until the chord is within the tolerance
+    void bisect(double t0, const RS_Vector& p0, double t1, const RS_Vector& p1, int depth) {
+        const double tm = 0.5 * (t0 + t1);
+        const RS_Vector pm = pointAt(tm);
+        if (depth < maxTessellationDepth && getChordDistance(pm, p0, p1) > tolerance) {
+            bisect(t0, p0, tm, pm, depth + 1);
+            bisect(tm, pm, t1, p1, depth + 1);
+            return;
+        }
+        vertices.push_back(p1);
+    }
+};
+}
+
+std::shared_ptr<const std::vector<RS_Vector>> RS_Spline::getTessellation(double tolerance) const
+{
+    std::shared_ptr<const Tessellation> cached = std::atomic_load(&m_tessellation);
+    // a much finer tessellation is redone too, so zooming out doesn't keep drawing too many vertices
+    if (cached == nullptr || cached->tolerance > 2. * tolerance || cached->tolerance < tolerance / 64.) {
+        auto tessellation = std::make_shared<Tessellation>();
+        tessellation->tolerance = tolerance;
+        tessellation->vertices = tessellate(tolerance);
+        cached = tessellation;
+        std::atomic_store(&m_tessellation, cached);
+    }
+    return {cached, &cached->vertices};
+}
+
+void RS_Spline::invalidateTessellation()
+{
+    std::atomic_store(&m_tessellation, std::shared_ptr<const Tessellation>{});
+}
+
+/**
+ * Tessellates the curve with the control points wrapped by update(), over the same
+ * parameter range as rbspline() and rbsplinu().
+ */
+std::vector<RS_Vector> RS_Spline::tessellate(double tolerance) const
+{
+    std::vector<RS_Vector> vertices;
+    // update() didn't find a valid curve
+    if (count() == 0 || !(tolerance > 0.))
+        return vertices;
+
+    const std::vector<RS_Vector>& controlPoints = data.controlPoints;
+    const size_t npts = controlPoints.size();
+    const size_t k = data.degree + 1;
+    const std::vector<double> x = data.closed ? knotu(npts, k) : knot(npts, k);
+    const double t0 = data.closed ? double(k - 1) : x.front();
+    const double t1 = data.closed ? double(npts) : x.back();
+    if (!(t1 > t0))
+        return vertices;
+
+    // the bounding box is a safe scale for tolerances below the floating point precision
+    tolerance = std::max(tolerance, getSize().magnitude() * RS_TOLERANCE);
+
+    SplineTessellator tessellator{{k, controlPoints, x}, tolerance, vertices};
+    const size_t intervals = (npts - k + 1) * tessellationSpanIntervals;
+    // the end point of an open spline is picked up exactly, as in rbspline()
+    auto parameterAt = [&](size_t i) {
+        return i == intervals ? t1 : t0 + (t1 - t0) * double(i) / double(intervals);
+    };
+
+    double ta = t0;
+    RS_Vector pa = tessellator.pointAt(ta);
+    vertices.push_back(pa);
+    for (size_t i = 1; i <= intervals; ++i) {
+        const double tb = parameterAt(i);
+        const RS_Vector pb = tessellator.pointAt(tb);
+        tessellator.bisect(ta, pa, tb, pb, 0);
+        ta = tb;
+        pa = pb;
+    }
+    return vertices;
+}
+
 /**
  * Dumps the spline's data to stdout.
  */
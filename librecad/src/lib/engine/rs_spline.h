@@ -28,6 +28,7 @@
 #ifndef RS_SPLINE_H
 #define RS_SPLINE_H
 
+#include <memory>
 #include <vector>
 #include "rs_entitycontainer.h"
 
@@ -147,6 +148,13 @@ public:
 		void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 		const std::vector<RS_Vector>& getControlPoints() const;
 
+		/**
+		 * @brief getTessellation the vertices of the curve, refined by curvature until no chord
+		 *        is farther than tolerance from the curve. The vertices are cached, and only
+		 *        tessellated again when a smaller tolerance is asked, or the spline changes.
+		 */
+		std::shared_ptr<const std::vector<RS_Vector>> getTessellation(double tolerance) const;
+
         friend std::ostream& operator << (std::ostream& os, const RS_Spline& l);
 
 		void calculateBorders() override;
@@ -174,6 +182,16 @@ private:
          */
         bool hasWrappedControlPoints() const;
 
+		std::vector<RS_Vector> tessellate(double tolerance) const;
+		void invalidateTessellation();
+
+		struct Tessellation {
+			std::vector<RS_Vector> vertices;
+			double tolerance = 0.;
+		};
+		// drawn by the threads of tiles, so the cache is replaced atomically
+		mutable std::shared_ptr<const Tessellation> m_tessellation;
+
 protected:
 		RS_SplineData data;
 }
@@ -570,11 +570,68 @@ QStringList RS_System::getFileList(const QString& subDirectory,
 }
 
 
+/**
+ * Searches for files like getFileList(), for each of the extensions in turn.
+ * The settings are read by the calling thread, the directories are searched
+ * by a worker thread, as they may be slow to access.
+ *
+ * @return List of the absolute paths of the files found, once available.
+ */
+std::shared_future<QStringList> RS_System::getFileListAsync(const QString& subDirectory,
+                                                            const QStringList& fileExtensions) {
+    checkInit();
+
+    const QStringList dirList = getDirectoryCandidates(subDirectory);
+    return std::async(std::launch::async, [dirList, fileExtensions]() {
+        QStringList fileList;
+        for (const QString& fileExtension: fileExtensions) {
+            for (const QString& path: dirList) {
+                QDir dir {path};
+                if (dir.exists() && dir.isReadable()) {
+                    for (const QString& file: dir.entryList(QStringList("*." + fileExtension)))
+                        fileList += path + "/" + file;
+                }
+            }
+        }
+        return fileList;
+    }).share();
+}
+
+
 /**
  * @return List of all directories in subdirectory 'subDirectory' in
  * all possible LibreCAD directories.
  */
-QStringList RS_System::getDirectoryList(const QString& _subDirectory) {
+QStringList RS_System::getDirectoryList(const QString& subDirectory) {
+    QStringList dirList = getDirectoryCandidates(subDirectory);
+
+    QStringList ret;
+
+    RS_DEBUG->print("RS_System::getDirectoryList: Paths:");
+    for (QStringList::Iterator it = dirList.begin();
+         it != dirList.end();
+         ++it ) {
+        if (QFileInfo( *it).isDir()) {
+            ret += (*it);
+            RS_DEBUG->print(*it);
+        }
+    }
+
+    for (auto& dir: ret) {
+
+
+        RS_DEBUG->print("%s\n", QString("%1(): line %2: dir=%3").arg(__func__).arg(__LINE__).arg(dir).toUtf8().constData());
+    }
+
+    return ret;
+}
+
+
+/**
+ * @return List of the directories, existing or not, which may contain
+ * subdirectory 'subDirectory' in all possible LibreCAD directories.
+ */
+QStringList RS_System::getDirectoryCandidates(const QString& _subDirectory) {
     QStringList dirList;
 
     QString subDirectory = QDir::fromNativeSeparators( _subDirectory);
@@ -667,25 +724,7 @@ QStringList RS_System::getDirectoryList(const QString& _subDirectory) {
     }
     RS_SETTINGS->endGroup();
 
-    QStringList ret;
-
-    RS_DEBUG->print("RS_System::getDirectoryList: Paths:");
-    for (QStringList::Iterator it = dirList.begin();
-         it != dirList.end();
-         ++it ) {
-        if (QFileInfo( *it).isDir()) {
-            ret += (*it);
-            RS_DEBUG->print(*it);
-        }
-    }
-
-    for (auto& dir: ret) {
-
-
-        RS_DEBUG->print("%s\n", QString("%1(): line %2: dir=%3").arg(__func__).arg(__LINE__).arg(dir).toUtf8().constData());
-    }
-
-    return ret;
+    return dirList;
 }
 
 
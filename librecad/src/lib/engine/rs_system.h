@@ -29,6 +29,8 @@
 #ifndef RS_SYSTEM_H
 #define RS_SYSTEM_H
 
+#include <future>
+
 #include <QDir>
 #include <QList>
 #include <QSharedPointer>
@@ -166,6 +168,9 @@ public:
 
     QStringList getDirectoryList(const QString& subDirectory);
 
+    std::shared_future<QStringList> getFileListAsync(const QString& subDirectory,
+                                                     const QStringList& fileExtensions);
+
     QStringList getLanguageList() {
         return languageList;
     }
@@ -187,6 +192,7 @@ public:
 private:
     RS_System() = default;
     void addLocale(RS_Locale *locale);
+    QStringList getDirectoryCandidates(const QString& subDirectory);
 
 protected:
 
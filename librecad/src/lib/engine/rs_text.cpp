@@ -257,6 +257,7 @@ void RS_Text::update() {
     RS_DEBUG->print("RS_Text::update");
 
     clear();
+    glyphs.reset();
 
     if (isUndone()) {
         return;
@@ -436,6 +437,7 @@ RS_VectorSolutions RS_Text::getRefPoints() const{
 
 void RS_Text::move(const RS_Vector& offset) {
     RS_EntityContainer::move(offset);
+    glyphs.reset();
     data.insertionPoint.move(offset);
     data.secondPoint.move(offset);
 //    update();
@@ -446,6 +448,7 @@ void RS_Text::move(const RS_Vector& offset) {
 void RS_Text::rotate(const RS_Vector& center, const double& angle) {
     RS_Vector angleVector(angle);
     RS_EntityContainer::rotate(center, angleVector);
+    glyphs.reset();
     data.insertionPoint.rotate(center, angleVector);
     data.secondPoint.rotate(center, angleVector);
     data.angle = RS_Math::correctAngle(data.angle+angle);
@@ -453,6 +456,7 @@ void RS_Text::rotate(const RS_Vector& center, const double& angle) {
 }
 void RS_Text::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
     RS_EntityContainer::rotate(center, angleVector);
+    glyphs.reset();
     data.insertionPoint.rotate(center, angleVector);
     data.secondPoint.rotate(center, angleVector);
     data.angle = RS_Math::correctAngle(data.angle+angleVector.angle());
@@ -471,6 +475,7 @@ void RS_Text::scale(const RS_Vector& center, const RS_Vector& factor) {
 
 
 void RS_Text::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+    runDeferredUpdate();
     bool readable = RS_Math::isAngleReadable(data.angle);
 
 	RS_Vector vec = RS_Vector::polar(1.0, data.angle);
@@ -517,6 +522,7 @@ bool RS_Text::hasEndpointsWithinWindow(const RS_Vector& /*v1*/, const RS_Vector&
  * by the given offset.
  */
 void RS_Text::stretch(const RS_Vector& firstCorner, const RS_Vector& secondCorner, const RS_Vector& offset) {
+    runDeferredUpdate();
 
     if (getMin().isInWindow(firstCorner, secondCorner) &&
             getMax().isInWindow(firstCorner, secondCorner)) {
@@ -536,11 +542,12 @@ std::ostream& operator << (std::ostream& os, const RS_Text& p) {
 }
 
 
-void RS_Text::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/)
+void RS_Text::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset)
 {
     if (!(painter && view)) {
         return;
     }
+    runDeferredUpdate();
 
     if (!view->isPrintPreview() && !view->isPrinting())
     {
@@ -551,6 +558,14 @@ void RS_Text::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternO
         }
     }
 
+    // all letters in one path, instead of a path per letter line
+    const auto letters = glyphs.get(*this);
+    if (letters != nullptr) {
+        if (view->isDrawnBy(painter, this))
+            letters->draw(painter, view, *this, patternOffset);
+        return;
+    }
+
     foreach (auto e, entities)
     {
         view->drawEntity(painter, e);
@@ -28,6 +28,7 @@
 #ifndef RS_TEXT_H
 #define RS_TEXT_H
 
+#include "lc_blockdrawlist.h"
 #include "rs_entitycontainer.h"
 
 /**
@@ -211,9 +212,11 @@ public:
         return data.angle;
     }
     double getUsedTextWidth() {
+        runDeferredUpdate();
         return usedTextWidth;
     }
     double getUsedTextHeight() {
+        runDeferredUpdate();
         return usedTextHeight;
     }
 
@@ -257,6 +260,8 @@ protected:
      * @see update
      */
     double usedTextHeight = 0.;
+    /** The letters drawn as one path, compiled when the text is drawn */
+    LC_TextGlyphs glyphs;
 };
 
 #endif
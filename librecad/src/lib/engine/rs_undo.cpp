@@ -26,10 +26,19 @@
 **********************************************************************/
 
 #include<iostream>
+#include <list>
+#include <unordered_set>
+#include "lc_tracing.h"
 #include "qc_applicationwindow.h"
 #include "rs_undocycle.h"
 #include "rs_undo.h"
 #include "rs_debug.h"
+#include "rs_settings.h"
+
+namespace {
+// default maximum number of undoables kept in the undo history
+constexpr int defaultUndoLimit = 1000000;
+}
 
 /**
  * @return Number of Cycles that can be undone.
@@ -42,6 +51,20 @@ int RS_Undo::countUndoCycles() {
 
 
 
+size_t RS_Undo::memoryUsage(size_t& undoables) const {
+    size_t bytes = undoList.capacity() * sizeof(std::shared_ptr<RS_UndoCycle>);
+    undoables = 0;
+    for (const std::shared_ptr<RS_UndoCycle>& cycle: undoList) {
+        // the cycle with the control block of its shared pointer
+        bytes += sizeof(RS_UndoCycle) + 2 * sizeof(void*)
+            + cycle->undoables.capacity() * sizeof(RS_Undoable*);
+        undoables += cycle->undoables.size();
+    }
+    return bytes;
+}
+
+
+
 /**
  * @return Number of Cycles that can be redone.
  */
@@ -153,12 +176,38 @@ void RS_Undo::addUndoable(RS_Undoable* u) {
 }
 
 
+/**
+ * Adds entities to the current undo cycle in one go. Used by bulk
+ * modifications, the GUI is updated once by endUndoCycle().
+ */
+void RS_Undo::addUndoables(const std::vector<RS_Entity*>& entities) {
+    if( nullptr == currentCycle) {
+        RS_DEBUG->print( RS_Debug::D_CRITICAL, "RS_Undo::%s(): invalid currentCycle, possibly missing startUndoCycle()", __func__);
+        return;
+    }
+
+    currentCycle->addUndoables(entities);
+}
+
+
+
+void RS_Undo::addOwnedUndoable(std::unique_ptr<RS_Undoable> u) {
+    if( nullptr == currentCycle) {
+        RS_DEBUG->print( RS_Debug::D_CRITICAL, "RS_Undo::%s(): invalid currentCycle, possibly missing startUndoCycle()", __func__);
+        return;
+    }
+
+    currentCycle->addOwnedUndoable(std::move(u));
+}
+
+
 
 /**
  * Ends the current undo cycle.
  */
 void RS_Undo::endUndoCycle() 
 {
+    LC_TRACE_SCOPE("RS_Undo::endUndoCycle");
     if (0 < refCount) {
         // compensate nested calls of start-/endUndoCycle()
         if( 0 < --refCount) {
@@ -174,6 +223,14 @@ void RS_Undo::endUndoCycle()
     if (hasUndoable()) {
         // only keep the undoCycle, when it contains undoables
         addUndoCycle(currentCycle);
+        undoCycleChanged(*currentCycle);
+
+        // 0 for an unlimited history
+        RS_SETTINGS->beginGroup("/Defaults");
+        const int limit = RS_SETTINGS->readNumEntry("/UndoLimit", defaultUndoLimit);
+        RS_SETTINGS->endGroup();
+        if (limit > 0)
+            limitUndoCycles(static_cast<size_t>(limit));
     }
 
     setGUIButtons();
@@ -182,10 +239,57 @@ void RS_Undo::endUndoCycle()
 
 
 
+/**
+ * Bounds the memory used by the undo history: while the cycles hold more
+ * undoables than the limit, the oldest cycles are dropped. Dropped undoables
+ * which are undone, i.e. deleted by the user, and not referenced by the
+ * remaining cycles are removed for good. The last cycle done is always kept.
+ *
+ * The history is trimmed to three quarters of the limit, so the cost of
+ * trimming is shared by many cycles.
+ */
+void RS_Undo::limitUndoCycles(size_t limit)
+{
+    size_t total = 0;
+    for (const auto& cycle: undoList)
+        total += cycle->size();
+    if (total <= limit)
+        return;
+
+    const size_t target = limit - limit / 4;
+    int dropped = 0;
+    while (dropped < undoPointer && total > target)
+        total -= undoList[dropped++]->size();
+    if (dropped == 0)
+        return;
+    RS_DEBUG->print("RS_Undo::limitUndoCycles: dropping %d cycles", dropped);
+
+    std::unordered_set<RS_Undoable*> keep;
+    for (auto it = undoList.begin() + dropped; it != undoList.end(); ++it)
+        keep.insert((*it)->getUndoables().cbegin(), (*it)->getUndoables().cend());
+
+    std::unordered_set<RS_Undoable*> obsolete;
+    for (auto it = undoList.begin(); it != undoList.begin() + dropped; ++it) {
+        for (RS_Undoable* u: (*it)->getUndoables()) {
+            if (keep.count(u) == 0)
+                obsolete.insert(u);
+        }
+    }
+    undoList.erase(undoList.begin(), undoList.begin() + dropped);
+    undoPointer -= dropped;
+
+    // only removes undone undoables, live entities stay in their document
+    for (RS_Undoable* u: obsolete)
+        removeUndoable(u);
+}
+
+
+
 /**
  * Undoes the last undo cycle.
  */
 bool RS_Undo::undo() {
+    LC_TRACE_SCOPE("RS_Undo::undo");
     RS_DEBUG->print("RS_Undo::undo");
 
 	if (undoPointer < 0) return false;
@@ -194,6 +298,7 @@ bool RS_Undo::undo() {
 
 	setGUIButtons();
 	uc->changeUndoState();
+	undoCycleChanged(*uc);
 	return true;
 }
 
@@ -202,6 +307,7 @@ bool RS_Undo::undo() {
  * Redoes the undo cycle which was at last undone.
  */
 bool RS_Undo::redo() {
+    LC_TRACE_SCOPE("RS_Undo::redo");
     RS_DEBUG->print("RS_Undo::redo");
 
 	if (undoPointer+1 < int(undoList.size())) {
@@ -210,6 +316,7 @@ bool RS_Undo::redo() {
 
 		setGUIButtons();
 		uc->changeUndoState();
+		undoCycleChanged(*uc);
 		return true;
 	}
     return false;
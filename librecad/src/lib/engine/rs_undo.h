@@ -29,9 +29,11 @@
 #ifndef RS_UNDO_H
 #define RS_UNDO_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
+class RS_Entity;
 class RS_UndoCycle;
 class RS_Undoable;
 
@@ -56,8 +58,19 @@ public:
     virtual int countRedoCycles();
     virtual bool hasUndoable();
 
+    /**
+     * @return the approximate bytes of the undo cycles, without the
+     * undoables themselves.
+     * @param undoables set to the number of undoables of all cycles
+     */
+    size_t memoryUsage(size_t& undoables) const;
+
     virtual void startUndoCycle();
     virtual void addUndoable(RS_Undoable* u);
+    //! adds many entities to the current undo cycle at once
+    void addUndoables(const std::vector<RS_Entity*>& entities);
+    //! adds an undoable owned by the current undo cycle, e.g. a change made in place
+    void addOwnedUndoable(std::unique_ptr<RS_Undoable> u);
     virtual void endUndoCycle();
 
     /**
@@ -67,6 +80,12 @@ public:
      */
     virtual void removeUndoable(RS_Undoable* u) = 0;
 
+    /**
+     * Called after the undo state of the undoables of a cycle has changed,
+     * by undo(), redo(), and by endUndoCycle() for a new cycle.
+     */
+    virtual void undoCycleChanged(const RS_UndoCycle& /*cycle*/) {}
+
     /**
 	  *\brief enable/disable redo/undo buttons in main application window
 	  *\author: Dongxu Li
@@ -80,6 +99,11 @@ public:
 private:
 
 	void addUndoCycle(std::shared_ptr<RS_UndoCycle> const& i);
+	/**
+	 * Drops the oldest undone cycles, if the history holds more undoables
+	 * than the limit.
+	 */
+	void limitUndoCycles(size_t limit);
     //! List of undo list items. every item is something that can be undone.
 	std::vector<std::shared_ptr<RS_UndoCycle>> undoList;
 
@@ -26,6 +26,7 @@
 **********************************************************************/
 
 
+#include <algorithm>
 #include <ostream>
 #include"rs_undocycle.h"
 
@@ -37,7 +38,30 @@ void RS_UndoCycle::addUndoable(RS_Undoable* u) {
     if (!u)
         return;
 
-    undoables.insert(u);
+    undoables.push_back(u);
+    normalized = false;
+}
+
+/**
+ * Adds a range of Undoables at once. Bulk modifications add thousands of
+ * entities to one cycle, sorting them once is cheaper than a tree insert
+ * for each of them.
+ */
+void RS_UndoCycle::addUndoables(const std::vector<RS_Entity*>& entities) {
+    undoables.reserve(undoables.size() + entities.size());
+    for (RS_Entity* e: entities) {
+        if (e != nullptr)
+            undoables.push_back(e);
+    }
+    normalized = false;
+}
+
+void RS_UndoCycle::addOwnedUndoable(std::unique_ptr<RS_Undoable> u) {
+    if (!u)
+        return;
+
+    addUndoable(u.get());
+    owned.push_back(std::move(u));
 }
 
 /**
@@ -47,28 +71,44 @@ void RS_UndoCycle::removeUndoable(RS_Undoable* u) {
     if (!u)
         return;
 
-    undoables.erase(u);
+    normalize();
+    auto it = std::lower_bound(undoables.begin(), undoables.end(), u);
+    if (it != undoables.end() && *it == u)
+        undoables.erase(it);
 }
 
 /**
  * Return number of undoables in cycle
  */
-size_t RS_UndoCycle::size()
+size_t RS_UndoCycle::size() const
 {
+    normalize();
     return undoables.size();
 }
 
 void RS_UndoCycle::changeUndoState()
 {
+    // an undoable must toggle once, even if it was added twice
+    normalize();
 	for (RS_Undoable* u: undoables)
 		u->changeUndoState();
 }
 
-std::set<RS_Undoable*> const& RS_UndoCycle::getUndoables() const
+std::vector<RS_Undoable*> const& RS_UndoCycle::getUndoables() const
 {
+    normalize();
     return undoables;
 }
 
+void RS_UndoCycle::normalize() const
+{
+    if (normalized)
+        return;
+    std::sort(undoables.begin(), undoables.end());
+    undoables.erase(std::unique(undoables.begin(), undoables.end()), undoables.end());
+    normalized = true;
+}
+
 
 std::ostream& operator << (std::ostream& os,
 								  RS_UndoCycle& uc) {
@@ -83,7 +123,7 @@ std::ostream& operator << (std::ostream& os,
 		break;
 }*/
 	os << "   Undoable ids: ";
-	for (auto u: uc.undoables) {
+	for (auto u: uc.getUndoables()) {
 		if (u->undoRtti()==RS2::UndoableEntity) {
 			RS_Entity* e = (RS_Entity*)u;
 			os << e->getId() << (u->isUndone() ? "*" : "") << " ";
@@ -30,7 +30,8 @@
 #define RS_UNDOLISTITEM_H
 
 #include <iosfwd>
-#include <set>
+#include <memory>
+#include <vector>
 
 #include "rs_entity.h"
 #include "rs_undoable.h"
@@ -61,6 +62,16 @@ public:
      */
     void addUndoable(RS_Undoable* u);
 
+    /**
+     * Adds a range of Undoables at once, reserving the storage first.
+     */
+    void addUndoables(const std::vector<RS_Entity*>& entities);
+
+    /**
+     * Adds an Undoable, which is deleted with this Undo Cycle.
+     */
+    void addOwnedUndoable(std::unique_ptr<RS_Undoable> u);
+
     /**
      * Removes an undoable from the list.
      */
@@ -69,7 +80,7 @@ public:
     /**
      * Return number of undoables in cycle
      */
-    size_t size(void);
+    size_t size(void) const;
 
 
     //! change undo state of all undoable in the current cycle
@@ -79,13 +90,21 @@ public:
 
     friend class RS_Undo;
 
-    std::set<RS_Undoable*> const& getUndoables() const;
+    //! Undoables of the cycle, sorted by address and without duplicates
+    std::vector<RS_Undoable*> const& getUndoables() const;
 
 private:
+    //! sort the undoables appended since the last call, and drop duplicates
+    void normalize() const;
+
     //! Undo type:
     //RS2::UndoType type;
-    //! List of entity id's that were affected by this action
-    std::set<RS_Undoable*> undoables;
+    //! List of entity id's that were affected by this action.
+    //! Appended unsorted, normalized on the first read
+    mutable std::vector<RS_Undoable*> undoables;
+    mutable bool normalized = true;
+    //! Undoables only referenced by this cycle
+    std::vector<std::unique_ptr<RS_Undoable>> owned;
 };
 
 #endif
@@ -586,13 +586,12 @@ RS_Vector RS_Vector::crossP(const RS_Vector& v1, const RS_Vector& v2) {
  * Constructor for no solution.
  */
 RS_VectorSolutions::RS_VectorSolutions():
-	vector(0)
-  ,tangent(false)
+  tangent(false)
 {
 }
 
 RS_VectorSolutions::RS_VectorSolutions(std::vector<RS_Vector> vectors):
-    vector(std::move(vectors))
+    vector(vectors.cbegin(), vectors.cend())
 {
 }
 
@@ -613,12 +612,7 @@ RS_VectorSolutions::RS_VectorSolutions(std::initializer_list<RS_Vector> list):
  * Allocates 'num' vectors.
  */
 void RS_VectorSolutions::alloc(size_t num) {
-	if(num<=vector.size()){
-		vector.resize(num);
-	}else{
-		const std::vector<RS_Vector> v(num - vector.size());
-		vector.insert(vector.end(), v.begin(), v.end());
-	}
+	vector.resize(num);
 }
 
 RS_Vector RS_VectorSolutions::get(size_t i) const
@@ -683,36 +677,36 @@ void RS_VectorSolutions::resize(size_t n){
     vector.resize(n);
 }
 
-const std::vector<RS_Vector>& RS_VectorSolutions::getVector() const {
-    return vector;
+std::vector<RS_Vector> RS_VectorSolutions::getVector() const {
+    return {vector.cbegin(), vector.cend()};
 }
 
-std::vector<RS_Vector>::const_iterator RS_VectorSolutions::cbegin() const
+RS_VectorSolutions::const_iterator RS_VectorSolutions::cbegin() const
 {
     return vector.cbegin();
 }
 
-std::vector<RS_Vector>::const_iterator RS_VectorSolutions::cend() const
+RS_VectorSolutions::const_iterator RS_VectorSolutions::cend() const
 {
     return vector.cend();
 }
 
-std::vector<RS_Vector>::const_iterator RS_VectorSolutions::begin() const
+RS_VectorSolutions::const_iterator RS_VectorSolutions::begin() const
 {
     return vector.cbegin();
 }
 
-std::vector<RS_Vector>::const_iterator RS_VectorSolutions::end() const
+RS_VectorSolutions::const_iterator RS_VectorSolutions::end() const
 {
     return vector.cend();
 }
 
-std::vector<RS_Vector>::iterator RS_VectorSolutions::begin()
+RS_VectorSolutions::iterator RS_VectorSolutions::begin()
 {
 	return vector.begin();
 }
 
-std::vector<RS_Vector>::iterator RS_VectorSolutions::end()
+RS_VectorSolutions::iterator RS_VectorSolutions::end()
 {
 	return vector.end();
 }
@@ -31,6 +31,8 @@
 #include <vector>
 #include <iosfwd>
 
+#include <boost/container/small_vector.hpp>
+
 class QPointF;
 
 /**
@@ -159,13 +161,45 @@ public:
 };
 
 
+/**
+ * A compact 2d point (x/y), for large arrays of points, which are always
+ * valid and never need a z coordinate, like grid points.
+ * Takes half the memory of RS_Vector and converts implicitly to it.
+ */
+struct RS_Vector2D {
+	RS_Vector2D()=default;
+	RS_Vector2D(double vx, double vy):
+		x{vx}
+	  , y{vy}
+	{}
+	explicit RS_Vector2D(const RS_Vector& v):
+		x{v.x}
+	  , y{v.y}
+	{}
+
+	operator RS_Vector() const {
+		return {x, y};
+	}
+
+	double x=0.;
+	double y=0.;
+};
+
+
 /**
  * Represents one to 4 vectors. Typically used to return multiple
  * solutions from a function.
+ * Up to 4 vectors are stored inline, without heap allocation.
  */
 class RS_VectorSolutions {
 public:
 	typedef RS_Vector value_type;
+	// solutions stored inline, intersections of two conics have at most 4
+	static constexpr size_t inlineSize = 4;
+	using container_type = boost::container::small_vector<RS_Vector, inlineSize>;
+	using iterator = container_type::iterator;
+	using const_iterator = container_type::const_iterator;
+
 	RS_VectorSolutions();
     RS_VectorSolutions(std::vector<RS_Vector> vectors);
     RS_VectorSolutions(std::initializer_list<RS_Vector> list);
@@ -197,13 +231,14 @@ public:
 						 double* dist=nullptr, size_t* index=nullptr) const;
     double getClosestDistance(const RS_Vector& coord,
                               int counts = -1); //default to search all
-	const std::vector<RS_Vector>& getVector() const;
-    std::vector<RS_Vector>::const_iterator cbegin() const;
-    std::vector<RS_Vector>::const_iterator cend() const;
-    std::vector<RS_Vector>::const_iterator begin() const;
-    std::vector<RS_Vector>::const_iterator end() const;
-    std::vector<RS_Vector>::iterator begin();
-	std::vector<RS_Vector>::iterator end();
+	/** @return a copy of the solutions */
+	std::vector<RS_Vector> getVector() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    iterator begin();
+	iterator end();
 	void rotate(double ang);
     void rotate(const RS_Vector& angleVector);
 	void rotate(const RS_Vector& center, double ang);
@@ -219,7 +254,7 @@ public:
                                       const RS_VectorSolutions& s);
 
 private:
-	std::vector<RS_Vector> vector;
+	container_type vector;
     bool tangent = false;
 };
 
@@ -0,0 +1,427 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QList>
+
+#include "lc_attributeschange.h"
+#include "lc_drawingjournal.h"
+#include "lc_filtersnapshot.h"
+#include "lc_transformchange.h"
+#include "rs_debug.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+#include "rs_settings.h"
+#include "rs_undocycle.h"
+
+namespace {
+
+constexpr quint32 journalMagic = 0x4C434A4E; // "LCJN"
+constexpr quint32 journalVersion = 1;
+constexpr QDataStream::Version streamVersion = QDataStream::Qt_6_0;
+
+// journals smaller than this are not compacted, whatever the size of the drawing
+constexpr qint64 minimumCompactionSize = 1 << 20;
+
+QByteArray toPayload(const QList<quint32>& list) {
+    QByteArray payload;
+    QDataStream stream{&payload, QIODevice::WriteOnly};
+    stream << list;
+    return payload;
+}
+
+} // namespace
+
+LC_DrawingJournal::LC_DrawingJournal(RS_Graphic& graphic):
+    graphic{graphic}
+{}
+
+bool LC_DrawingJournal::isEnabled() {
+    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
+    return RS_SETTINGS->readNumEntry("/SaveJournal", 0) != 0;
+}
+
+QString LC_DrawingJournal::journalFileName(const QString& file) {
+    return file + ".lcjournal";
+}
+
+void LC_DrawingJournal::remove(const QString& file) {
+    QFile::remove(journalFileName(file));
+}
+
+/**
+ * @return whether the entity is written to the DXF file as one entity, read back
+ * at the same position, and can be written to snapshots
+ */
+bool LC_DrawingJournal::isJournaled(const RS_Entity* entity) {
+    switch (entity->rtti()) {
+    case RS2::EntityPoint:
+    case RS2::EntityLine:
+    case RS2::EntityCircle:
+    case RS2::EntityArc:
+    case RS2::EntitySolid:
+    case RS2::EntityEllipse:
+    case RS2::EntityPolyline:
+    case RS2::EntitySpline:
+    case RS2::EntitySplinePoints:
+    case RS2::EntityInsert:
+    case RS2::EntityMText:
+    case RS2::EntityText:
+    case RS2::EntityDimLinear:
+    case RS2::EntityDimAligned:
+    case RS2::EntityDimAngular:
+    case RS2::EntityDimRadial:
+    case RS2::EntityDimDiametric:
+    case RS2::EntityDimLeader:
+    case RS2::EntityHatch:
+    case RS2::EntityImage:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool LC_DrawingJournal::start(const QString& fileName) {
+    RS_DEBUG->print("LC_DrawingJournal::start: %s", fileName.toLatin1().data());
+    file.close();
+    drawingFile = fileName;
+    numbers.clear();
+    removed.clear();
+    nextNumber = 0;
+    valid = false;
+
+    for (RS_Entity* e: graphic) {
+        if (e->getFlag(RS2::FlagUndone))
+            continue;
+        if (!isJournaled(e)) {
+            RS_DEBUG->print(RS_Debug::D_WARNING,
+                            "LC_DrawingJournal::start: entity type %d can't be journaled",
+                            int(e->rtti()));
+            remove(fileName);
+            return false;
+        }
+        numbers.insert(e->getId(), nextNumber++);
+    }
+    setLayers();
+
+    const QFileInfo info{fileName};
+    baseSize = info.size();
+    baseModified = info.lastModified().toMSecsSinceEpoch();
+
+    file.setFileName(journalFileName(fileName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_DrawingJournal::start: can't write %s",
+                        file.fileName().toLatin1().data());
+        return false;
+    }
+    QDataStream stream{&file};
+    stream.setVersion(streamVersion);
+    stream << journalMagic << journalVersion << baseSize << baseModified << nextNumber;
+    valid = stream.status() == QDataStream::Ok && file.flush();
+    return valid;
+}
+
+int LC_DrawingJournal::recover(const QString& fileName) {
+    QFile in{journalFileName(fileName)};
+    if (!in.open(QIODevice::ReadOnly))
+        return -1;
+    RS_DEBUG->print("LC_DrawingJournal::recover: %s", in.fileName().toLatin1().data());
+
+    // the entities read from the drawing file, by number
+    std::vector<RS_Entity*> entities;
+    for (RS_Entity* e: graphic) {
+        if (!e->getFlag(RS2::FlagUndone))
+            entities.push_back(e);
+    }
+
+    QDataStream stream{&in};
+    stream.setVersion(streamVersion);
+    quint32 magic = 0, version = 0, count = 0;
+    qint64 size = 0, modified = 0;
+    stream >> magic >> version >> size >> modified >> count;
+    const QFileInfo info{fileName};
+    if (stream.status() != QDataStream::Ok || magic != journalMagic
+            || version != journalVersion || size != info.size()
+            || modified != info.lastModified().toMSecsSinceEpoch()
+            || count != entities.size()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "LC_DrawingJournal::recover: %s is not the journal of the file",
+                        in.fileName().toLatin1().data());
+        return -1;
+    }
+
+    // a partly written record ends the journal
+    qint64 validSize = in.pos();
+    int changes = 0;
+    QSet<quint32> removedNumbers;
+    while (!stream.atEnd()) {
+        quint32 type = 0;
+        QByteArray payload;
+        stream >> type >> payload;
+        if (stream.status() != QDataStream::Ok)
+            break;
+
+        QDataStream record{payload};
+        QList<quint32> list;
+        bool ok = true;
+        switch (type) {
+        case Added: {
+            QByteArray snapshot;
+            record >> list >> snapshot;
+            std::vector<RS_Entity*> created;
+            ok = LC_FilterSnapshot::readEntitySnapshot(graphic, snapshot, created)
+                    && qsizetype(created.size()) == list.size();
+            for (size_t i = 0; ok && i < created.size(); ++i)
+                ok = list[qsizetype(i)] == entities.size() + i;
+            if (!ok) {
+                for (RS_Entity* e: created)
+                    delete e;
+                break;
+            }
+            for (RS_Entity* e: created) {
+                graphic.addEntity(e);
+                entities.push_back(e);
+            }
+            break;
+        }
+        case Removed:
+        case Restored:
+            record >> list;
+            for (quint32 n: list) {
+                ok = ok && n < entities.size();
+                if (ok && type == Removed)
+                    removedNumbers.insert(n);
+                else if (ok)
+                    removedNumbers.remove(n);
+            }
+            break;
+        case Tables: {
+            QByteArray snapshot;
+            record >> snapshot;
+            ok = LC_FilterSnapshot::readTableSnapshot(graphic, snapshot);
+            break;
+        }
+        case Saved:
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok || record.status() != QDataStream::Ok)
+            break;
+        changes = type == Saved ? 0 : changes + 1;
+        validSize = in.pos();
+    }
+    in.close();
+
+    // entities removed by the journal can't be restored anymore
+    {
+        std::vector<RS_Entity*> removed;
+        for (quint32 n: removedNumbers) {
+            removed.push_back(entities[n]);
+            entities[n] = nullptr;
+        }
+        graphic.removeEntities(removed);
+    }
+
+    drawingFile = fileName;
+    baseSize = size;
+    baseModified = modified;
+    numbers.clear();
+    removed.clear();
+    for (size_t n = 0; n < entities.size(); ++n) {
+        if (entities[n] != nullptr)
+            numbers.insert(entities[n]->getId(), quint32(n));
+    }
+    nextNumber = quint32(entities.size());
+    setLayers();
+
+    file.close();
+    file.setFileName(in.fileName());
+    valid = file.open(QIODevice::ReadWrite) && file.resize(validSize) && file.seek(validSize);
+    RS_DEBUG->print("LC_DrawingJournal::recover: %d changes after the last save", changes);
+    return changes;
+}
+
+void LC_DrawingJournal::record(const RS_UndoCycle& cycle) {
+    if (!valid)
+        return;
+    // blocks are only written with the complete drawing
+    if (graphic.getBlockList()->isModified()) {
+        invalidate();
+        return;
+    }
+
+    std::vector<RS_Entity*> added;
+    QList<quint32> removedNumbers;
+    QList<quint32> restoredNumbers;
+    for (RS_Undoable* undoable: cycle.getUndoables()) {
+        if (undoable->undoRtti() == RS2::UndoableAttributes || undoable->undoRtti() == RS2::UndoableTransform) {
+            // changed in place: journaled as removed, and added again in the current state
+            const std::vector<RS_Entity*> changed = undoable->undoRtti() == RS2::UndoableAttributes
+                    ? static_cast<LC_AttributesChange*>(undoable)->getEntities()
+                    : static_cast<LC_TransformChange*>(undoable)->getEntities();
+            for (RS_Entity* entity: changed) {
+                if (entity->getParent() != &graphic) {
+                    invalidate();
+                    return;
+                }
+                auto it = numbers.find(entity->getId());
+                if (it != numbers.end()) {
+                    removed.insert(it.value());
+                    removedNumbers << it.value();
+                    numbers.erase(it);
+                }
+                added.push_back(entity);
+            }
+            continue;
+        }
+        if (undoable->undoRtti() != RS2::UndoableEntity)
+            continue;
+        auto entity = static_cast<RS_Entity*>(undoable);
+        if (entity->getParent() != &graphic) {
+            invalidate();
+            return;
+        }
+        const bool undone = entity->getFlag(RS2::FlagUndone);
+        auto it = numbers.constFind(entity->getId());
+        if (it == numbers.constEnd()) {
+            // undone entities the journal doesn't know were never added to it
+            if (!undone)
+                added.push_back(entity);
+            continue;
+        }
+        if (undone && !removed.contains(it.value())) {
+            removed.insert(it.value());
+            removedNumbers << it.value();
+        } else if (!undone && removed.remove(it.value())) {
+            restoredNumbers << it.value();
+        }
+    }
+
+    if (!added.empty()) {
+        const bool newLayer = std::any_of(added.cbegin(), added.cend(), [this](RS_Entity* e) {
+            RS_Layer* layer = e->getLayer(false);
+            return layer != nullptr && !layers.contains(layer->getName());
+        });
+        if (newLayer && !appendTables())
+            return;
+
+        const bool journaled = std::all_of(added.cbegin(), added.cend(), isJournaled);
+        const QByteArray snapshot = journaled ? LC_FilterSnapshot::entitySnapshot(added) : QByteArray{};
+        if (snapshot.isEmpty()) {
+            invalidate();
+            return;
+        }
+        QList<quint32> list;
+        for (RS_Entity* e: added) {
+            numbers.insert(e->getId(), nextNumber);
+            list << nextNumber++;
+        }
+        QByteArray payload;
+        QDataStream stream{&payload, QIODevice::WriteOnly};
+        stream << list << snapshot;
+        if (!append(Added, payload))
+            return;
+    }
+    if (!removedNumbers.isEmpty() && !append(Removed, toPayload(removedNumbers)))
+        return;
+    if (!restoredNumbers.isEmpty())
+        append(Restored, toPayload(restoredNumbers));
+}
+
+bool LC_DrawingJournal::save() {
+    if (!valid || !isBaseUnchanged() || isCompactionDue()
+            || graphic.getBlockList()->isModified())
+        return false;
+    // removed layers are only written with the complete drawing
+    for (const QString& name: std::as_const(layers)) {
+        if (graphic.findLayer(name) == nullptr)
+            return false;
+    }
+    return appendTables() && append(Saved, QByteArray{});
+}
+
+/**
+ * @return whether the drawing file is still the file the journal is for
+ */
+bool LC_DrawingJournal::isBaseUnchanged() const {
+    const QFileInfo info{drawingFile};
+    return info.size() == baseSize && info.lastModified().toMSecsSinceEpoch() == baseModified;
+}
+
+/**
+ * @return whether the journal has grown big compared to the drawing file,
+ * which is then written completely
+ */
+bool LC_DrawingJournal::isCompactionDue() const {
+    return file.size() > std::max(minimumCompactionSize, baseSize / 2);
+}
+
+/**
+ * Appends a record, which is written to the file at once.
+ */
+bool LC_DrawingJournal::append(RecordType type, const QByteArray& payload) {
+    QDataStream stream{&file};
+    stream.setVersion(streamVersion);
+    stream << quint32(type) << payload;
+    if (stream.status() != QDataStream::Ok || !file.flush()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_DrawingJournal::append: can't write %s",
+                        file.fileName().toLatin1().data());
+        invalidate();
+        return false;
+    }
+    return true;
+}
+
+bool LC_DrawingJournal::appendTables() {
+    QByteArray payload;
+    QDataStream stream{&payload, QIODevice::WriteOnly};
+    stream << LC_FilterSnapshot::tableSnapshot(graphic);
+    if (!append(Tables, payload))
+        return false;
+    setLayers();
+    return true;
+}
+
+void LC_DrawingJournal::setLayers() {
+    layers.clear();
+    for (RS_Layer* layer: *graphic.getLayerList())
+        layers.insert(layer->getName());
+}
+
+/**
+ * Ends the journal, the changes are kept by writing the complete drawing. The
+ * records so far are still recovered, if that fails.
+ */
+void LC_DrawingJournal::invalidate() {
+    RS_DEBUG->print("LC_DrawingJournal: the drawing has changes, which can't be journaled");
+    valid = false;
+}
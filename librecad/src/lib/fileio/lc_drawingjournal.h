@@ -0,0 +1,117 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_DRAWINGJOURNAL_H
+#define LC_DRAWINGJOURNAL_H
+
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+class QByteArray;
+class RS_Entity;
+class RS_Graphic;
+class RS_UndoCycle;
+
+/**
+ * @brief The LC_DrawingJournal class, the journal of a DXF drawing file.
+ * The journal is a file next to the drawing, appended with the entities added and
+ * removed by each undo cycle, and with the layers and variables at each save.
+ * Saving a drawing with a journal only appends to it, until the journal is
+ * compacted by writing the complete drawing file.
+ *
+ * Journals are replayed when their drawing is opened: the changes after the last
+ * save are the changes recovered after a crash. Entities are identified by their
+ * position in the drawing file, entities added later by the numbers following.
+ * Changes of blocks and entities the snapshot format can't hold end the journal,
+ * the next save writes the complete file.
+ */
+class LC_DrawingJournal {
+public:
+    explicit LC_DrawingJournal(RS_Graphic& graphic);
+
+    /** @return whether journals are kept for DXF drawings, setting /Defaults/SaveJournal */
+    static bool isEnabled();
+    /** @return the file name of the journal of the drawing file */
+    static QString journalFileName(const QString& file);
+    /** Removes the journal of the drawing file, once the file is written completely. */
+    static void remove(const QString& file);
+
+    /** Starts the journal of the drawing, which was just read from or written to the file. */
+    bool start(const QString& file);
+    /**
+     * Replays the journal of the drawing file into the drawing, which was just read
+     * from the file, and continues the journal.
+     * @return the count of changes recovered after the last save, -1 if the file
+     * has no journal of its content
+     */
+    int recover(const QString& file);
+    /** Appends the changes of a cycle done, undone or redone. */
+    void record(const RS_UndoCycle& cycle);
+    /**
+     * Saves the drawing by appending its layers and variables to the journal.
+     * @return false if the drawing file must be written completely
+     */
+    bool save();
+
+    /** @return the drawing file of the journal */
+    const QString& getFileName() const {
+        return drawingFile;
+    }
+
+private:
+    enum RecordType : quint32 {
+        Added = 1,
+        Removed,
+        Restored,
+        Tables,
+        Saved
+    };
+
+    static bool isJournaled(const RS_Entity* entity);
+    bool isBaseUnchanged() const;
+    bool isCompactionDue() const;
+    bool append(RecordType type, const QByteArray& payload);
+    bool appendTables();
+    void setLayers();
+    void invalidate();
+
+    RS_Graphic& graphic;
+    QFile file;
+    QString drawingFile;
+    //! size and modification time of the drawing file the journal is for
+    qint64 baseSize = 0;
+    qint64 baseModified = 0;
+    //! journal numbers by entity id
+    QHash<unsigned long, quint32> numbers;
+    //! numbers of entities removed by the journal
+    QSet<quint32> removed;
+    quint32 nextNumber = 0;
+    //! names of the layers known to the journal
+    QSet<QString> layers;
+    //! false once the drawing has changes, which the journal can't hold
+    bool valid = false;
+};
+
+#endif // LC_DRAWINGJOURNAL_H
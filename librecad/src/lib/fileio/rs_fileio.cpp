@@ -33,11 +33,15 @@
 #include <QApplication>
 #endif
 #include "rs_fileio.h"
+#include "rs_block.h"
+#include "rs_blocklist.h"
+#include "rs_graphic.h"
 #include "rs_filtercxf.h"
 #include "rs_filterdxf1.h"
 #include "rs_filterjww.h"
 #include "rs_filterlff.h"
 #include "rs_filterdxfrw.h"
+#include "lc_filtersnapshot.h"
 #include "rs_debug.h"
 
 /**
@@ -63,6 +67,13 @@ bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
     }
 
     if (RS2::FormatUnknown != t) {
+        // unchanged DXF files are read from their snapshot
+        const bool cached = t == RS2::FormatDXFRW && LC_FilterSnapshot::isCacheEnabled();
+        if (cached && LC_FilterSnapshot().importCache(graphic, file)) {
+            RS_DEBUG->print("RS_FileIO::fileImport: read snapshot of %s", file.toLatin1().data());
+            return true;
+        }
+
 		std::unique_ptr<RS_FilterInterface>&& filter(getImportFilter(file, t));
 		if (filter){
 #ifdef DWGSUPPORT
@@ -85,6 +96,9 @@ bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
             }
 #endif
             bool bImported {filter->fileImport(graphic, file, t)};
+            if (bImported && cached) {
+                LC_FilterSnapshot().exportCache(graphic, file);
+            }
             if (!bImported) {
                 QApplication::restoreOverrideCursor();  // disable WaitCursor for massagebox
 
@@ -158,7 +172,8 @@ RS2::FormatType RS_FileIO::detectFormat(QString const& file, bool forRead)
 	std::map<QString, RS2::FormatType> list{
 		{"dxf", RS2::FormatDXFRW},
 		{"cxf", RS2::FormatCXF},
-		{"lff", RS2::FormatLFF}
+		{"lff", RS2::FormatLFF},
+		{"lcsnap", RS2::FormatSnapshot}
 	};
 	// only read support for dwg
 	if(forRead) list["dwg"]=RS2::FormatDWG;
@@ -167,6 +182,11 @@ RS2::FormatType RS_FileIO::detectFormat(QString const& file, bool forRead)
 	RS2::FormatType type=(list.find(extension)!=
 			list.end()) ? list[extension]:RS2::FormatUnknown;
 
+	// compressed dxf, the content is verified by the filter while it's decompressed
+	QString const lowerFile = file.toLower();
+	if (lowerFile.endsWith(".dxf.gz") || lowerFile.endsWith(".dxf.zst"))
+		return RS2::FormatDXFRW;
+
 	//only read dxf to verify
 	if (forRead && type==RS2::FormatDXFRW) {
 		type = RS2::FormatDXFRW;
@@ -224,6 +244,10 @@ bool RS_FileIO::fileExport(RS_Graphic& graphic, const QString& file,
 
 	std::unique_ptr<RS_FilterInterface>&& filter(getExportFilter(file, type));
 	if (filter){
+        // blocks imported lazily are written with their entities
+        for (RS_Block* blk: *graphic.getBlockList()) {
+            blk->load();
+        }
         return filter->fileExport(graphic, file, type);
     }
     RS_DEBUG->print("RS_FileIO::fileExport: no filter found");
@@ -232,6 +256,24 @@ bool RS_FileIO::fileExport(RS_Graphic& graphic, const QString& file,
 }
 
 
+bool RS_FileIO::bufferExport(RS_Graphic& graphic, std::string& data, RS2::FormatType type) {
+    RS_DEBUG->print("RS_FileIO::bufferExport");
+
+    if (!canBufferExport(type))
+        return false;
+    for (RS_Block* blk: *graphic.getBlockList()) {
+        blk->load();
+    }
+    RS_FilterDXFRW filter;
+    return filter.bufferExport(graphic, data, type);
+}
+
+
+bool RS_FileIO::canBufferExport(RS2::FormatType type) {
+    return RS_FilterDXFRW().canExport(QString(), type);
+}
+
+
 RS_FileIO* RS_FileIO::instance() {
 	static RS_FileIO* uniqueInstance=nullptr;
 	if (!uniqueInstance) {
@@ -278,6 +320,7 @@ std::vector<std::function<RS_FilterInterface*()>> RS_FileIO::getFilters()
 												  ,RS_FilterCXF::createFilter
 												  ,RS_FilterJWW::createFilter
 												  ,RS_FilterDXF1::createFilter
+												  ,LC_FilterSnapshot::createFilter
 												  };
 }
 
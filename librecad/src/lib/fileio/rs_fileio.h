@@ -30,6 +30,7 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <string>
 #include "rs_filterinterface.h"
 
 //RLZ: TODO destructor for clear filterList
@@ -70,6 +71,12 @@ public:
 		
     bool fileExport(RS_Graphic& graphic, const QString& file,
 		RS2::FormatType type = RS2::FormatUnknown);
+	/**
+	 * Writes the content of a file of the type into memory, for the DXF formats.
+	 * \return false if the type can't be written into memory, see canBufferExport()
+	 */
+	bool bufferExport(RS_Graphic& graphic, std::string& data, RS2::FormatType type);
+	static bool canBufferExport(RS2::FormatType type);
 	/** \brief detectFormat detect file format type
 	 * \param file type
 	 * \param forRead read the file to verify dxf/dxfrw type, default to true
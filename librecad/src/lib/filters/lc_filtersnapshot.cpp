@@ -0,0 +1,1414 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+
+#include "lc_dimarc.h"
+#include "lc_filtersnapshot.h"
+#include "lc_splinepoints.h"
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_circle.h"
+#include "rs_debug.h"
+#include "rs_dimaligned.h"
+#include "rs_dimangular.h"
+#include "rs_dimdiametric.h"
+#include "rs_dimlinear.h"
+#include "rs_dimradial.h"
+#include "rs_ellipse.h"
+#include "rs_hatch.h"
+#include "rs_image.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_leader.h"
+#include "rs_line.h"
+#include "rs_mtext.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_settings.h"
+#include "rs_solid.h"
+#include "rs_spline.h"
+#include "rs_system.h"
+#include "rs_text.h"
+
+namespace {
+
+// The layout of a snapshot: the header, followed by the sections of the Section
+// enumeration, each aligned to 8 bytes. All values are in the byte order of the
+// writer, the records are read in place from the mapped file.
+
+constexpr char snapshotMagic[8] = {'L', 'C', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr quint32 snapshotVersion = 1;
+constexpr quint32 byteOrderMark = 0x01020304;
+
+enum Section : quint32 {
+    StringOffsets,  // quint32 offsets of the strings in StringData, one more than strings
+    StringData,     // UTF-8, string 0 is the empty string
+    Numbers,        // double, coordinates are pairs, NaN for invalid vectors
+    Variables,      // VariableRecord
+    Layers,         // LayerRecord
+    Blocks,         // BlockRecord
+    Entities,       // EntityRecord, the children of an entity follow it
+    SectionCount
+};
+
+struct SectionRecord {
+    quint64 offset;
+    quint64 size;
+};
+
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    // size and modification time of the drawing file, a cache is for
+    qint64 sourceSize;
+    qint64 sourceModified;
+    // string with the version of the writer
+    quint32 application;
+    // the entities of the graphic
+    quint32 entities;
+    quint32 entityCount;
+    qint32 pagesHorizontal;
+    qint32 pagesVertical;
+    quint32 reserved;
+    double margins[4];
+    SectionRecord sections[SectionCount];
+};
+
+struct PenRecord {
+    quint32 color;
+    quint32 colorFlags;
+    qint32 width;
+    qint32 lineType;
+    quint32 flags;
+};
+
+struct VariableRecord {
+    quint32 name;
+    qint32 code;
+    qint32 type;
+    // integer value or string
+    qint32 value;
+    double number;
+    double x;
+    double y;
+    double z;
+};
+
+enum LayerFlags : quint32 {
+    LayerFrozen = 1,
+    LayerLocked = 2,
+    LayerPrint = 4,
+    LayerConstruction = 8,
+    LayerConverted = 16,
+    LayerHidden = 32
+};
+
+struct LayerRecord {
+    quint32 name;
+    quint32 flags;
+    PenRecord pen;
+};
+
+enum BlockFlags : quint32 {
+    BlockFrozen = 1
+};
+
+struct BlockRecord {
+    quint32 name;
+    quint32 flags;
+    double baseX;
+    double baseY;
+    quint32 entities;
+    quint32 entityCount;
+};
+
+enum EntityFlags : quint32 {
+    EntityInvisible = 1,
+    EntityClosed = 2,
+    EntityReversed = 4,
+    EntitySolid = 8,
+    EntityArrowHead = 16,
+    EntityCut = 32,
+    EntityUseControlPoints = 64
+};
+
+/**
+ * An entity, its type specific data are the numbers, values, text and style:
+ * the numbers hold the coordinates and scalars in the order of the data members,
+ * the values the enumerations and counts. Hatches have their loops as children,
+ * the loops their edges.
+ */
+struct EntityRecord {
+    quint32 type;
+    quint32 flags;
+    // layer name, string 0 for entities without layer
+    quint32 layer;
+    PenRecord pen;
+    quint32 text;
+    quint32 style;
+    qint32 values[4];
+    quint32 numbers;
+    quint32 numberCount;
+    quint32 children;
+    quint32 childCount;
+};
+
+static_assert(std::is_trivially_copyable<Header>::value
+              && std::is_trivially_copyable<EntityRecord>::value,
+              "snapshot records are read in place");
+
+constexpr quint64 align8(quint64 offset) {
+    return (offset + 7) & ~quint64(7);
+}
+
+constexpr double invalidNumber = std::numeric_limits<double>::quiet_NaN();
+
+// count of numbers of the dimension data shared by all dimensions
+constexpr quint32 dimensionNumbers = 6;
+
+PenRecord toRecord(const RS_Pen& pen) {
+    const RS_Color color = pen.getColor();
+    return {color.rgba(), color.getFlags(), int(pen.getWidth()),
+            int(pen.getLineType()), pen.getFlags()};
+}
+
+RS_Pen fromRecord(const PenRecord& record) {
+    RS_Color color{QColor::fromRgba(record.color)};
+    color.setFlags(record.colorFlags);
+    RS_Pen pen{color, RS2::LineWidth(record.width), RS2::LineType(record.lineType)};
+    pen.setFlags(record.flags);
+    return pen;
+}
+
+bool isDimension(quint32 type) {
+    switch (type) {
+    case RS2::EntityDimAligned:
+    case RS2::EntityDimLinear:
+    case RS2::EntityDimRadial:
+    case RS2::EntityDimDiametric:
+    case RS2::EntityDimAngular:
+    case RS2::EntityDimArc:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// entities, which can be edges of hatch loops
+bool isEdge(quint32 type) {
+    switch (type) {
+    case RS2::EntityLine:
+    case RS2::EntityArc:
+    case RS2::EntityCircle:
+    case RS2::EntityEllipse:
+    case RS2::EntitySpline:
+    case RS2::EntitySplinePoints:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Collects the tables of a snapshot from a graphic.
+ */
+class SnapshotWriter {
+public:
+    SnapshotWriter() {
+        stringOffsets = {0, 0};
+    }
+
+    quint32 string(const QString& text);
+
+    void addVariables(RS_Graphic& graphic);
+    void addLayers(RS_Graphic& graphic);
+    bool addBlocks(RS_Graphic& graphic);
+    bool addEntities(RS_EntityContainer& container, quint32& first, quint32& count);
+    bool addEntities(const std::vector<RS_Entity*>& list, quint32& first, quint32& count);
+
+    bool write(QIODevice& device, Header& header) const;
+
+private:
+    void add(const RS_Vector& v);
+    void add(double number) {
+        numbers.push_back(number);
+    }
+    bool addEntity(RS_Entity* entity, size_t index);
+    void addDimension(RS_Dimension* dimension, EntityRecord& record);
+
+    std::vector<quint32> stringOffsets;
+    QByteArray stringData;
+    QHash<QString, quint32> stringIndex;
+    std::vector<double> numbers;
+    std::vector<VariableRecord> variables;
+    std::vector<LayerRecord> layers;
+    std::vector<BlockRecord> blocks;
+    std::vector<EntityRecord> entities;
+};
+
+quint32 SnapshotWriter::string(const QString& text) {
+    if (text.isEmpty())
+        return 0;
+    auto it = stringIndex.constFind(text);
+    if (it != stringIndex.constEnd())
+        return it.value();
+    const quint32 index = quint32(stringOffsets.size() - 1);
+    stringData.append(text.toUtf8());
+    stringOffsets.push_back(quint32(stringData.size()));
+    stringIndex.insert(text, index);
+    return index;
+}
+
+void SnapshotWriter::add(const RS_Vector& v) {
+    numbers.push_back(v.valid ? v.x : invalidNumber);
+    numbers.push_back(v.valid ? v.y : invalidNumber);
+}
+
+void SnapshotWriter::addVariables(RS_Graphic& graphic) {
+    const QHash<QString, RS_Variable>& dict = graphic.getVariableDict();
+    for (auto it = dict.cbegin(); it != dict.cend(); ++it) {
+        const RS_Variable& v = it.value();
+        VariableRecord record{};
+        record.name = string(it.key());
+        record.code = v.getCode();
+        record.type = v.getType();
+        switch (v.getType()) {
+        case RS2::VariableString:
+            record.value = qint32(string(v.getString()));
+            break;
+        case RS2::VariableInt:
+            record.value = v.getInt();
+            break;
+        case RS2::VariableDouble:
+            record.number = v.getDouble();
+            break;
+        case RS2::VariableVector: {
+            const RS_Vector vector = v.getVector();
+            record.x = vector.valid ? vector.x : invalidNumber;
+            record.y = vector.y;
+            record.z = vector.z;
+            break;
+        }
+        default:
+            continue;
+        }
+        variables.push_back(record);
+    }
+}
+
+void SnapshotWriter::addLayers(RS_Graphic& graphic) {
+    for (RS_Layer* layer: *graphic.getLayerList()) {
+        LayerRecord record{};
+        record.name = string(layer->getName());
+        record.flags = (layer->isFrozen() ? LayerFrozen : 0)
+                | (layer->isLocked() ? LayerLocked : 0)
+                | (layer->isPrint() ? LayerPrint : 0)
+                | (layer->isConstruction() ? LayerConstruction : 0)
+                | (layer->isConverted() ? LayerConverted : 0)
+                | (layer->isVisibleInLayerList() ? 0 : LayerHidden);
+        record.pen = toRecord(layer->getPen());
+        layers.push_back(record);
+    }
+}
+
+bool SnapshotWriter::addBlocks(RS_Graphic& graphic) {
+    for (RS_Block* block: *graphic.getBlockList()) {
+        // blocks imported lazily are written with their entities
+        block->load();
+        BlockRecord record{};
+        record.name = string(block->getName());
+        record.flags = block->isFrozen() ? BlockFrozen : 0;
+        record.baseX = block->getBasePoint().x;
+        record.baseY = block->getBasePoint().y;
+        if (!addEntities(*block, record.entities, record.entityCount))
+            return false;
+        blocks.push_back(record);
+    }
+    return true;
+}
+
+/**
+ * Appends the records of the entities of the container, followed by their children.
+ * @return false, if the container has an entity, which can't be written
+ */
+bool SnapshotWriter::addEntities(RS_EntityContainer& container, quint32& first, quint32& count) {
+    const bool loops = container.rtti() == RS2::EntityHatch;
+    std::vector<RS_Entity*> list;
+    for (RS_Entity* e: container) {
+        if (e->getFlag(RS2::FlagUndone))
+            continue;
+        // the pattern of hatches is created by updates
+        if (loops && !(e->isContainer() && !e->getFlag(RS2::FlagTemp)))
+            continue;
+        list.push_back(e);
+    }
+    return addEntities(list, first, count);
+}
+
+/**
+ * Appends the records of the entities, followed by their children.
+ * @return false, if an entity can't be written
+ */
+bool SnapshotWriter::addEntities(const std::vector<RS_Entity*>& list, quint32& first, quint32& count) {
+    first = quint32(entities.size());
+    count = quint32(list.size());
+    entities.resize(entities.size() + list.size());
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (!addEntity(list[i], first + i))
+            return false;
+    }
+    return true;
+}
+
+void SnapshotWriter::addDimension(RS_Dimension* dimension, EntityRecord& record) {
+    const RS_DimensionData data = dimension->getData();
+    add(data.definitionPoint);
+    add(data.middleOfText);
+    add(data.lineSpacingFactor);
+    add(data.angle);
+    record.values[0] = data.valign;
+    record.values[1] = data.halign;
+    record.values[2] = data.lineSpacingStyle;
+    record.values[3] = qint32(data.getFlags());
+    record.text = string(data.text);
+    record.style = string(data.style);
+}
+
+bool SnapshotWriter::addEntity(RS_Entity* entity, size_t index) {
+    EntityRecord record{};
+    record.type = entity->rtti();
+    record.flags = entity->getFlag(RS2::FlagVisible) ? 0 : EntityInvisible;
+    RS_Layer* layer = entity->getLayer(false);
+    record.layer = layer != nullptr ? string(layer->getName()) : 0;
+    record.pen = toRecord(entity->getPen(false));
+    record.numbers = quint32(numbers.size());
+
+    switch (entity->rtti()) {
+    case RS2::EntityPoint:
+        add(static_cast<RS_Point*>(entity)->getPos());
+        break;
+    case RS2::EntityLine: {
+        const RS_LineData& data = static_cast<RS_Line*>(entity)->getData();
+        add(data.startpoint);
+        add(data.endpoint);
+        break;
+    }
+    case RS2::EntityArc: {
+        const RS_ArcData& data = static_cast<RS_Arc*>(entity)->getData();
+        add(data.center);
+        add(data.radius);
+        add(data.angle1);
+        add(data.angle2);
+        record.flags |= data.reversed ? EntityReversed : 0;
+        break;
+    }
+    case RS2::EntityCircle: {
+        const RS_CircleData& data = static_cast<RS_Circle*>(entity)->getData();
+        add(data.center);
+        add(data.radius);
+        break;
+    }
+    case RS2::EntityEllipse: {
+        const RS_EllipseData& data = static_cast<RS_Ellipse*>(entity)->getData();
+        add(data.center);
+        add(data.majorP);
+        add(data.ratio);
+        add(data.angle1);
+        add(data.angle2);
+        record.flags |= data.reversed ? EntityReversed : 0;
+        break;
+    }
+    case RS2::EntityPolyline: {
+        // the vertices with the bulge of the following segment, like in DXF
+        auto polyline = static_cast<RS_Polyline*>(entity);
+        RS_AtomicEntity* last = nullptr;
+        for (RS_Entity* e: *polyline) {
+            if (e->rtti() != RS2::EntityLine && e->rtti() != RS2::EntityArc)
+                return false;
+            last = static_cast<RS_AtomicEntity*>(e);
+            add(last->getStartpoint());
+            add(e->rtti() == RS2::EntityArc ? static_cast<RS_Arc*>(e)->getBulge() : 0.);
+        }
+        if (last == nullptr) {
+            if (polyline->getStartpoint().valid) {
+                add(polyline->getStartpoint());
+                add(0.);
+            }
+        } else if (!polyline->isClosed()) {
+            add(last->getEndpoint());
+            add(0.);
+        }
+        record.flags |= polyline->isClosed() ? EntityClosed : 0;
+        break;
+    }
+    case RS2::EntitySpline: {
+        const RS_SplineData& data = static_cast<RS_Spline*>(entity)->getData();
+        for (const RS_Vector& v: data.controlPoints)
+            add(v);
+        for (double knot: data.knotslist)
+            add(knot);
+        record.values[0] = data.degree;
+        record.values[1] = qint32(data.controlPoints.size());
+        record.flags |= data.closed ? EntityClosed : 0;
+        break;
+    }
+    case RS2::EntitySplinePoints: {
+        const LC_SplinePointsData& data = static_cast<LC_SplinePoints*>(entity)->getData();
+        for (const RS_Vector& v: data.splinePoints)
+            add(v);
+        for (const RS_Vector& v: data.controlPoints)
+            add(v);
+        record.values[0] = qint32(data.splinePoints.size());
+        record.flags |= (data.closed ? EntityClosed : 0)
+                | (data.cut ? EntityCut : 0)
+                | (data.useControlPoints ? EntityUseControlPoints : 0);
+        break;
+    }
+    case RS2::EntitySolid: {
+        const RS_SolidData& data = static_cast<RS_Solid*>(entity)->getData();
+        for (const RS_Vector& corner: data.corner)
+            add(corner);
+        break;
+    }
+    case RS2::EntityInsert: {
+        const RS_InsertData data = static_cast<RS_Insert*>(entity)->getData();
+        add(data.insertionPoint);
+        add(data.scaleFactor);
+        add(data.angle);
+        add(data.spacing);
+        record.values[0] = data.cols;
+        record.values[1] = data.rows;
+        record.text = string(data.name);
+        break;
+    }
+    case RS2::EntityMText: {
+        const RS_MTextData data = static_cast<RS_MText*>(entity)->getData();
+        add(data.insertionPoint);
+        add(data.height);
+        add(data.width);
+        add(data.lineSpacingFactor);
+        add(data.angle);
+        record.values[0] = data.valign;
+        record.values[1] = data.halign;
+        record.values[2] = data.drawingDirection;
+        record.values[3] = data.lineSpacingStyle;
+        record.text = string(data.text);
+        record.style = string(data.style);
+        break;
+    }
+    case RS2::EntityText: {
+        const RS_TextData data = static_cast<RS_Text*>(entity)->getData();
+        add(data.insertionPoint);
+        add(data.secondPoint);
+        add(data.height);
+        add(data.widthRel);
+        add(data.angle);
+        record.values[0] = data.valign;
+        record.values[1] = data.halign;
+        record.values[2] = data.textGeneration;
+        record.text = string(data.text);
+        record.style = string(data.style);
+        break;
+    }
+    case RS2::EntityHatch: {
+        const RS_HatchData data = static_cast<RS_Hatch*>(entity)->getData();
+        add(data.scale);
+        add(data.angle);
+        record.flags |= data.solid ? EntitySolid : 0;
+        record.text = string(data.pattern);
+        if (!addEntities(*static_cast<RS_Hatch*>(entity), record.children, record.childCount))
+            return false;
+        break;
+    }
+    case RS2::EntityContainer: {
+        // hatch loops, with the edges as children
+        auto loop = static_cast<RS_EntityContainer*>(entity);
+        if (entity->getParent() == nullptr || entity->getParent()->rtti() != RS2::EntityHatch)
+            return false;
+        for (RS_Entity* e: *loop) {
+            if (!isEdge(e->rtti()))
+                return false;
+        }
+        if (!addEntities(*loop, record.children, record.childCount))
+            return false;
+        break;
+    }
+    case RS2::EntityImage: {
+        const RS_ImageData data = static_cast<RS_Image*>(entity)->getData();
+        add(data.insertionPoint);
+        add(data.uVector);
+        add(data.vVector);
+        add(data.size);
+        record.values[0] = data.handle;
+        record.values[1] = data.brightness;
+        record.values[2] = data.contrast;
+        record.values[3] = data.fade;
+        record.text = string(data.file);
+        break;
+    }
+    case RS2::EntityDimAligned: {
+        auto dimension = static_cast<RS_DimAligned*>(entity);
+        addDimension(dimension, record);
+        add(dimension->getEData().extensionPoint1);
+        add(dimension->getEData().extensionPoint2);
+        break;
+    }
+    case RS2::EntityDimLinear: {
+        auto dimension = static_cast<RS_DimLinear*>(entity);
+        addDimension(dimension, record);
+        const RS_DimLinearData data = dimension->getEData();
+        add(data.extensionPoint1);
+        add(data.extensionPoint2);
+        add(data.angle);
+        add(data.oblique);
+        break;
+    }
+    case RS2::EntityDimRadial: {
+        auto dimension = static_cast<RS_DimRadial*>(entity);
+        addDimension(dimension, record);
+        const RS_DimRadialData data = dimension->getEData();
+        add(data.definitionPoint);
+        add(data.leader);
+        break;
+    }
+    case RS2::EntityDimDiametric: {
+        auto dimension = static_cast<RS_DimDiametric*>(entity);
+        addDimension(dimension, record);
+        const RS_DimDiametricData data = dimension->getEData();
+        add(data.definitionPoint);
+        add(data.leader);
+        break;
+    }
+    case RS2::EntityDimAngular: {
+        auto dimension = static_cast<RS_DimAngular*>(entity);
+        addDimension(dimension, record);
+        const RS_DimAngularData data = dimension->getEData();
+        add(data.definitionPoint1);
+        add(data.definitionPoint2);
+        add(data.definitionPoint3);
+        add(data.definitionPoint4);
+        break;
+    }
+    case RS2::EntityDimArc: {
+        auto dimension = static_cast<LC_DimArc*>(entity);
+        addDimension(dimension, record);
+        const LC_DimArcData data = dimension->getData();
+        add(data.radius);
+        add(data.arcLength);
+        add(data.centre);
+        add(data.endAngle);
+        add(data.startAngle);
+        break;
+    }
+    case RS2::EntityDimLeader: {
+        auto leader = static_cast<RS_Leader*>(entity);
+        bool first = true;
+        for (RS_Entity* e: *leader) {
+            if (e->rtti() != RS2::EntityLine)
+                return false;
+            if (first)
+                add(static_cast<RS_Line*>(e)->getStartpoint());
+            add(static_cast<RS_Line*>(e)->getEndpoint());
+            first = false;
+        }
+        record.flags |= leader->getData().arrowHead ? EntityArrowHead : 0;
+        break;
+    }
+    default:
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "LC_FilterSnapshot: entity type %u can't be written", record.type);
+        return false;
+    }
+
+    record.numberCount = quint32(numbers.size() - record.numbers);
+    entities[index] = record;
+    return true;
+}
+
+bool SnapshotWriter::write(QIODevice& device, Header& header) const {
+    const std::pair<const void*, quint64> sections[SectionCount] = {
+        {stringOffsets.data(), stringOffsets.size() * sizeof(quint32)},
+        {stringData.constData(), quint64(stringData.size())},
+        {numbers.data(), numbers.size() * sizeof(double)},
+        {variables.data(), variables.size() * sizeof(VariableRecord)},
+        {layers.data(), layers.size() * sizeof(LayerRecord)},
+        {blocks.data(), blocks.size() * sizeof(BlockRecord)},
+        {entities.data(), entities.size() * sizeof(EntityRecord)}
+    };
+    // the records refer to strings, numbers and entities by 32 bit indices
+    constexpr size_t maximum = std::numeric_limits<quint32>::max();
+    if (stringData.size() >= qsizetype(maximum) || numbers.size() >= maximum
+            || entities.size() >= maximum)
+        return false;
+
+    quint64 offset = align8(sizeof(Header));
+    for (quint32 i = 0; i < SectionCount; ++i) {
+        header.sections[i] = {offset, sections[i].second};
+        offset = align8(offset + sections[i].second);
+    }
+
+    const char padding[8] = {};
+    if (device.write(reinterpret_cast<const char*>(&header), sizeof(Header)) != qint64(sizeof(Header)))
+        return false;
+    quint64 written = sizeof(Header);
+    for (quint32 i = 0; i < SectionCount; ++i) {
+        const qint64 gap = qint64(header.sections[i].offset - written);
+        if (gap > 0 && device.write(padding, gap) != gap)
+            return false;
+        const qint64 size = qint64(sections[i].second);
+        if (size > 0 && device.write(static_cast<const char*>(sections[i].first), size) != size)
+            return false;
+        written = header.sections[i].offset + sections[i].second;
+    }
+    return true;
+}
+
+/**
+ * The tables of a mapped snapshot, the records are validated before any is used.
+ */
+class SnapshotView {
+public:
+    bool map(const uchar* data, qint64 size);
+    bool isValid() const;
+
+    const Header& header() const {
+        return *m_header;
+    }
+
+    QString string(quint32 index) const {
+        return QString::fromUtf8(m_stringData + m_stringOffsets[index],
+                                 qsizetype(m_stringOffsets[index + 1] - m_stringOffsets[index]));
+    }
+
+    RS_Vector vector(const double* n) const {
+        return std::isnan(n[0]) ? RS_Vector(false) : RS_Vector(n[0], n[1]);
+    }
+
+    template<typename T>
+    const T* table(Section section, quint64& count) const {
+        count = m_header->sections[section].size / sizeof(T);
+        return reinterpret_cast<const T*>(m_data + m_header->sections[section].offset);
+    }
+
+    const double* numbers(const EntityRecord& record) const {
+        return m_numbers + record.numbers;
+    }
+
+    const EntityRecord& entity(quint32 index) const {
+        return m_entities[index];
+    }
+
+private:
+    bool isValidString(quint32 index) const {
+        return index < m_stringCount;
+    }
+    bool isValidRange(quint64 first, quint64 count, quint64 size) const {
+        return first <= size && count <= size - first;
+    }
+    // level 0 for entities of the graphic and blocks, 1 for hatch loops, 2 for their edges
+    bool isValidEntity(quint64 index, int level) const;
+    bool isValidEntities(quint64 first, quint64 count, int level) const;
+
+    const uchar* m_data = nullptr;
+    const Header* m_header = nullptr;
+    const quint32* m_stringOffsets = nullptr;
+    quint64 m_stringCount = 0;
+    const char* m_stringData = nullptr;
+    const double* m_numbers = nullptr;
+    quint64 m_numberCount = 0;
+    const EntityRecord* m_entities = nullptr;
+    quint64 m_entityCount = 0;
+};
+
+bool SnapshotView::map(const uchar* data, qint64 size) {
+    if (data == nullptr || size < qint64(sizeof(Header)) || quintptr(data) % 8 != 0)
+        return false;
+    m_data = data;
+    m_header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(m_header->magic, snapshotMagic, sizeof(snapshotMagic)) != 0
+            || m_header->version != snapshotVersion
+            || m_header->byteOrder != byteOrderMark)
+        return false;
+
+    const quint64 recordSizes[SectionCount] = {
+        sizeof(quint32), 1, sizeof(double), sizeof(VariableRecord), sizeof(LayerRecord),
+        sizeof(BlockRecord), sizeof(EntityRecord)
+    };
+    for (quint32 i = 0; i < SectionCount; ++i) {
+        const SectionRecord& section = m_header->sections[i];
+        if (section.offset % 8 != 0 || section.size % recordSizes[i] != 0
+                || !isValidRange(section.offset, section.size, quint64(size)))
+            return false;
+    }
+
+    quint64 offsetCount = 0;
+    quint64 dataSize = 0;
+    m_stringOffsets = table<quint32>(StringOffsets, offsetCount);
+    m_stringData = table<char>(StringData, dataSize);
+    if (offsetCount < 2)
+        return false;
+    m_stringCount = offsetCount - 1;
+    for (quint64 i = 0; i < m_stringCount; ++i) {
+        if (m_stringOffsets[i] > m_stringOffsets[i + 1])
+            return false;
+    }
+    if (m_stringOffsets[0] != 0 || m_stringOffsets[m_stringCount] > dataSize)
+        return false;
+
+    m_numbers = table<double>(Numbers, m_numberCount);
+    m_entities = table<EntityRecord>(Entities, m_entityCount);
+    return true;
+}
+
+bool SnapshotView::isValidEntities(quint64 first, quint64 count, int level) const {
+    if (!isValidRange(first, count, m_entityCount))
+        return false;
+    for (quint64 i = first; i < first + count; ++i) {
+        if (!isValidEntity(i, level))
+            return false;
+    }
+    return true;
+}
+
+bool SnapshotView::isValidEntity(quint64 index, int level) const {
+    const EntityRecord& r = m_entities[index];
+    if (!isValidString(r.layer) || !isValidString(r.text) || !isValidString(r.style)
+            || !isValidRange(r.numbers, r.numberCount, m_numberCount))
+        return false;
+
+    // the entities allowed at the level
+    const bool edge = isEdge(r.type);
+    if ((level == 1 && r.type != RS2::EntityContainer) || (level == 2 && !edge)
+            || (level == 0 && r.type == RS2::EntityContainer))
+        return false;
+
+    auto inRange = [](qint32 value, qint32 last) {
+        return value >= 0 && value <= last;
+    };
+    const quint32 n = r.numberCount;
+    bool valid = false;
+    switch (r.type) {
+    case RS2::EntityPoint:
+        valid = n == 2;
+        break;
+    case RS2::EntityLine:
+        valid = n == 4;
+        break;
+    case RS2::EntityArc:
+        valid = n == 5;
+        break;
+    case RS2::EntityCircle:
+        valid = n == 3;
+        break;
+    case RS2::EntityEllipse:
+        valid = n == 7;
+        break;
+    case RS2::EntityPolyline:
+        valid = n % 3 == 0;
+        break;
+    case RS2::EntitySpline:
+        valid = inRange(r.values[1], qint32(n / 2)) && r.values[0] >= 1;
+        break;
+    case RS2::EntitySplinePoints:
+        valid = n % 2 == 0 && inRange(r.values[0], qint32(n / 2));
+        break;
+    case RS2::EntitySolid:
+        valid = n == 8;
+        break;
+    case RS2::EntityInsert:
+        valid = n == 7;
+        break;
+    case RS2::EntityMText:
+        valid = n == 6 && inRange(r.values[0], RS_MTextData::VABottom)
+                && inRange(r.values[1], RS_MTextData::HARight)
+                && inRange(r.values[2], RS_MTextData::ByStyle)
+                && inRange(r.values[3], RS_MTextData::Exact);
+        break;
+    case RS2::EntityText:
+        valid = n == 7 && inRange(r.values[0], RS_TextData::VATop)
+                && inRange(r.values[1], RS_TextData::HAFit)
+                && inRange(r.values[2], RS_TextData::UpsideDown);
+        break;
+    case RS2::EntityHatch:
+        valid = n == 2 && isValidEntities(r.children, r.childCount, 1);
+        break;
+    case RS2::EntityContainer:
+        valid = n == 0 && isValidEntities(r.children, r.childCount, 2);
+        break;
+    case RS2::EntityImage:
+        valid = n == 8;
+        break;
+    case RS2::EntityDimLeader:
+        valid = n % 2 == 0;
+        break;
+    default:
+        if (isDimension(r.type)) {
+            const quint32 extra = r.type == RS2::EntityDimAligned ? 4
+                    : r.type == RS2::EntityDimLinear ? 6
+                    : r.type == RS2::EntityDimAngular || r.type == RS2::EntityDimArc ? 8
+                    : 3;
+            valid = n == dimensionNumbers + extra
+                    && inRange(r.values[0], RS_MTextData::VABottom)
+                    && inRange(r.values[1], RS_MTextData::HARight)
+                    && inRange(r.values[2], RS_MTextData::Exact);
+        }
+        break;
+    }
+    // only hatches and loops have children, which follow them
+    if (r.type != RS2::EntityHatch && r.type != RS2::EntityContainer)
+        valid = valid && r.childCount == 0;
+    else
+        valid = valid && (r.childCount == 0 || r.children > index);
+    return valid;
+}
+
+bool SnapshotView::isValid() const {
+    const Header& h = *m_header;
+    if (!isValidString(h.application) || !isValidEntities(h.entities, h.entityCount, 0))
+        return false;
+
+    quint64 count = 0;
+    const VariableRecord* variables = table<VariableRecord>(Variables, count);
+    for (quint64 i = 0; i < count; ++i) {
+        if (!isValidString(variables[i].name)
+                || (variables[i].type == RS2::VariableString
+                    && !isValidString(quint32(variables[i].value))))
+            return false;
+    }
+    const LayerRecord* layers = table<LayerRecord>(Layers, count);
+    for (quint64 i = 0; i < count; ++i) {
+        if (!isValidString(layers[i].name))
+            return false;
+    }
+    const BlockRecord* blocks = table<BlockRecord>(Blocks, count);
+    for (quint64 i = 0; i < count; ++i) {
+        if (!isValidString(blocks[i].name)
+                || !isValidEntities(blocks[i].entities, blocks[i].entityCount, 0))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Creates the entities of a validated snapshot.
+ */
+class SnapshotBuilder {
+public:
+    SnapshotBuilder(const SnapshotView& view, RS_Graphic& graphic):
+        view{view}
+      , graphic{graphic}
+    {}
+
+    void addEntities(RS_EntityContainer& container, quint32 first, quint32 count);
+    void createEntities(RS_EntityContainer* parent, quint32 first, quint32 count,
+                        std::vector<RS_Entity*>& entities);
+
+private:
+    RS_Entity* createEntity(RS_EntityContainer* parent, quint32 index);
+    RS_DimensionData dimensionData(const EntityRecord& r) const;
+    RS_Layer* layer(quint32 name);
+
+    const SnapshotView& view;
+    RS_Graphic& graphic;
+    // layers by name string, resolved once
+    QHash<quint32, RS_Layer*> layers;
+};
+
+RS_Layer* SnapshotBuilder::layer(quint32 name) {
+    if (name == 0)
+        return nullptr;
+    auto it = layers.constFind(name);
+    if (it == layers.constEnd())
+        it = layers.insert(name, graphic.findLayer(view.string(name)));
+    return it.value();
+}
+
+RS_DimensionData SnapshotBuilder::dimensionData(const EntityRecord& r) const {
+    const double* n = view.numbers(r);
+    RS_DimensionData data{view.vector(n), view.vector(n + 2),
+                          RS_MTextData::VAlign(r.values[0]),
+                          RS_MTextData::HAlign(r.values[1]),
+                          RS_MTextData::MTextLineSpacingStyle(r.values[2]),
+                          n[4], view.string(r.text), view.string(r.style), n[5]};
+    data.setFlags(unsigned(r.values[3]));
+    return data;
+}
+
+void SnapshotBuilder::addEntities(RS_EntityContainer& container, quint32 first, quint32 count) {
+    for (quint32 i = first; i < first + count; ++i) {
+        // appended, hatches and images keep their place
+        container.appendEntity(createEntity(&container, i));
+    }
+}
+
+void SnapshotBuilder::createEntities(RS_EntityContainer* parent, quint32 first, quint32 count,
+                                     std::vector<RS_Entity*>& entities) {
+    for (quint32 i = first; i < first + count; ++i) {
+        RS_Entity* entity = createEntity(parent, i);
+        if (entity != nullptr)
+            entities.push_back(entity);
+    }
+}
+
+RS_Entity* SnapshotBuilder::createEntity(RS_EntityContainer* parent, quint32 index) {
+    const EntityRecord& r = view.entity(index);
+    const double* n = view.numbers(r);
+    auto vector = [this, n](quint32 i) {
+        return view.vector(n + i);
+    };
+
+    RS_Entity* entity = nullptr;
+    bool update = true;
+    switch (r.type) {
+    case RS2::EntityPoint:
+        entity = new RS_Point(parent, RS_PointData(vector(0)));
+        update = false;
+        break;
+    case RS2::EntityLine:
+        entity = new RS_Line(parent, {vector(0), vector(2)});
+        update = false;
+        break;
+    case RS2::EntityArc:
+        entity = new RS_Arc(parent, RS_ArcData(vector(0), n[2], n[3], n[4],
+                                               r.flags & EntityReversed));
+        update = false;
+        break;
+    case RS2::EntityCircle:
+        entity = new RS_Circle(parent, RS_CircleData(vector(0), n[2]));
+        update = false;
+        break;
+    case RS2::EntityEllipse:
+        entity = new RS_Ellipse(parent, {vector(0), vector(2), n[4], n[5], n[6],
+                                         bool(r.flags & EntityReversed)});
+        update = false;
+        break;
+    case RS2::EntityPolyline: {
+        auto polyline = new RS_Polyline(parent, RS_PolylineData(RS_Vector(false), RS_Vector(false),
+                                                                r.flags & EntityClosed));
+        std::vector<std::pair<RS_Vector, double>> vertices;
+        for (quint32 i = 0; i < r.numberCount; i += 3)
+            vertices.emplace_back(vector(i), n[i + 2]);
+        polyline->appendVertexs(vertices);
+        entity = polyline;
+        update = false;
+        break;
+    }
+    case RS2::EntitySpline: {
+        RS_SplineData data(r.values[0], r.flags & EntityClosed);
+        const quint32 controlPoints = quint32(r.values[1]);
+        for (quint32 i = 0; i < controlPoints; ++i)
+            data.controlPoints.push_back(vector(2 * i));
+        data.knotslist.assign(n + 2 * controlPoints, n + r.numberCount);
+        entity = new RS_Spline(parent, data);
+        break;
+    }
+    case RS2::EntitySplinePoints: {
+        LC_SplinePointsData data(r.flags & EntityClosed, r.flags & EntityCut);
+        data.useControlPoints = r.flags & EntityUseControlPoints;
+        const quint32 splinePoints = 2 * quint32(r.values[0]);
+        for (quint32 i = 0; i < r.numberCount; i += 2)
+            (i < splinePoints ? data.splinePoints : data.controlPoints).push_back(vector(i));
+        entity = new LC_SplinePoints(parent, data);
+        break;
+    }
+    case RS2::EntitySolid:
+        entity = new RS_Solid(parent, RS_SolidData(vector(0), vector(2), vector(4), vector(6)));
+        update = false;
+        break;
+    case RS2::EntityInsert:
+        // updated with all inserts, when the blocks are complete
+        entity = new RS_Insert(parent, RS_InsertData(view.string(r.text), vector(0), vector(2), n[4],
+                                                     r.values[0], r.values[1], vector(5),
+                                                     nullptr, RS2::NoUpdate));
+        update = false;
+        break;
+    case RS2::EntityMText:
+        entity = new RS_MText(parent, RS_MTextData(vector(0), n[2], n[3],
+                                                   RS_MTextData::VAlign(r.values[0]),
+                                                   RS_MTextData::HAlign(r.values[1]),
+                                                   RS_MTextData::MTextDrawingDirection(r.values[2]),
+                                                   RS_MTextData::MTextLineSpacingStyle(r.values[3]),
+                                                   n[4], view.string(r.text), view.string(r.style),
+                                                   n[5], RS2::NoUpdate));
+        break;
+    case RS2::EntityText:
+        entity = new RS_Text(parent, RS_TextData(vector(0), vector(2), n[4], n[5],
+                                                 RS_TextData::VAlign(r.values[0]),
+                                                 RS_TextData::HAlign(r.values[1]),
+                                                 RS_TextData::TextGeneration(r.values[2]),
+                                                 view.string(r.text), view.string(r.style),
+                                                 n[6], RS2::NoUpdate));
+        break;
+    case RS2::EntityHatch: {
+        auto hatch = new RS_Hatch(parent, RS_HatchData(r.flags & EntitySolid, n[0], n[1],
+                                                       view.string(r.text)));
+        for (quint32 i = r.children; i < r.children + r.childCount; ++i)
+            hatch->addEntity(createEntity(hatch, i));
+        entity = hatch;
+        break;
+    }
+    case RS2::EntityContainer: {
+        auto loop = new RS_EntityContainer(parent);
+        for (quint32 i = r.children; i < r.children + r.childCount; ++i)
+            loop->addEntity(createEntity(loop, i));
+        entity = loop;
+        update = false;
+        break;
+    }
+    case RS2::EntityImage:
+        entity = new RS_Image(parent, RS_ImageData(r.values[0], vector(0), vector(2), vector(4),
+                                                   vector(6), view.string(r.text),
+                                                   r.values[1], r.values[2], r.values[3]));
+        break;
+    case RS2::EntityDimAligned:
+        entity = new RS_DimAligned(parent, dimensionData(r),
+                                   RS_DimAlignedData(vector(6), vector(8)));
+        break;
+    case RS2::EntityDimLinear:
+        entity = new RS_DimLinear(parent, dimensionData(r),
+                                  RS_DimLinearData(vector(6), vector(8), n[10], n[11]));
+        break;
+    case RS2::EntityDimRadial:
+        entity = new RS_DimRadial(parent, dimensionData(r), RS_DimRadialData(vector(6), n[8]));
+        break;
+    case RS2::EntityDimDiametric:
+        entity = new RS_DimDiametric(parent, dimensionData(r), RS_DimDiametricData(vector(6), n[8]));
+        break;
+    case RS2::EntityDimAngular:
+        entity = new RS_DimAngular(parent, dimensionData(r),
+                                   RS_DimAngularData(vector(6), vector(8), vector(10), vector(12)));
+        break;
+    case RS2::EntityDimArc:
+        entity = new LC_DimArc(parent, dimensionData(r),
+                               LC_DimArcData(n[6], n[7], vector(8), vector(10), vector(12)));
+        break;
+    case RS2::EntityDimLeader: {
+        auto leader = new RS_Leader(parent, RS_LeaderData(r.flags & EntityArrowHead));
+        for (quint32 i = 0; i < r.numberCount; i += 2)
+            leader->addVertex(vector(i));
+        entity = leader;
+        break;
+    }
+    default:
+        return nullptr;
+    }
+
+    entity->setLayer(layer(r.layer));
+    entity->setPen(fromRecord(r.pen));
+    if (r.flags & EntityInvisible)
+        entity->setVisible(false);
+    if (update)
+        entity->update();
+    return entity;
+}
+
+Header createHeader(SnapshotWriter& writer) {
+    Header header{};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.byteOrder = byteOrderMark;
+    header.application = writer.string(RS_SYSTEM->getAppVersion());
+    return header;
+}
+
+void setPageHeader(RS_Graphic& g, Header& header) {
+    header.pagesHorizontal = g.getPagesNumHoriz();
+    header.pagesVertical = g.getPagesNumVert();
+    header.margins[0] = g.getMarginLeft();
+    header.margins[1] = g.getMarginTop();
+    header.margins[2] = g.getMarginRight();
+    header.margins[3] = g.getMarginBottom();
+}
+
+QByteArray toByteArray(const SnapshotWriter& writer, Header& header) {
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    if (!writer.write(buffer, header))
+        return {};
+    return buffer.data();
+}
+
+/**
+ * Maps a snapshot held in memory, the records are read in place from a copy
+ * aligned like a mapped file.
+ */
+bool mapBuffer(const QByteArray& snapshot, std::vector<quint64>& aligned, SnapshotView& view) {
+    aligned.resize((size_t(snapshot.size()) + 7) / 8);
+    if (!aligned.empty())
+        std::memcpy(aligned.data(), snapshot.constData(), size_t(snapshot.size()));
+    return view.map(reinterpret_cast<const uchar*>(aligned.data()), snapshot.size())
+            && view.isValid();
+}
+
+/**
+ * Adds the variables and layers of the snapshot to the graphic, existing layers
+ * get the attributes of the snapshot.
+ */
+void readTables(const SnapshotView& view, RS_Graphic& g) {
+    quint64 count = 0;
+    const VariableRecord* variables = view.table<VariableRecord>(Variables, count);
+    for (quint64 i = 0; i < count; ++i) {
+        const VariableRecord& v = variables[i];
+        const QString name = view.string(v.name);
+        switch (v.type) {
+        case RS2::VariableString:
+            g.addVariable(name, view.string(quint32(v.value)), v.code);
+            break;
+        case RS2::VariableInt:
+            g.addVariable(name, int(v.value), v.code);
+            break;
+        case RS2::VariableDouble:
+            g.addVariable(name, v.number, v.code);
+            break;
+        case RS2::VariableVector:
+            g.addVariable(name, std::isnan(v.x) ? RS_Vector(false) : RS_Vector(v.x, v.y, v.z),
+                          v.code);
+            break;
+        default:
+            break;
+        }
+    }
+
+    const LayerRecord* layers = view.table<LayerRecord>(Layers, count);
+    for (quint64 i = 0; i < count; ++i) {
+        const LayerRecord& l = layers[i];
+        auto layer = new RS_Layer(view.string(l.name));
+        layer->setPen(fromRecord(l.pen));
+        layer->freeze(l.flags & LayerFrozen);
+        layer->lock(l.flags & LayerLocked);
+        layer->setPrint(l.flags & LayerPrint);
+        layer->setConstruction(l.flags & LayerConstruction);
+        layer->setConverted(l.flags & LayerConverted);
+        layer->visibleInLayerList(!(l.flags & LayerHidden));
+        g.addLayer(layer);
+    }
+}
+
+} // namespace
+
+bool LC_FilterSnapshot::canImport(const QString& /*fileName*/, RS2::FormatType t) const {
+    return t == RS2::FormatSnapshot;
+}
+
+bool LC_FilterSnapshot::canExport(const QString& /*fileName*/, RS2::FormatType t) const {
+    return t == RS2::FormatSnapshot;
+}
+
+bool LC_FilterSnapshot::fileImport(RS_Graphic& g, const QString& file, RS2::FormatType /*type*/) {
+    return read(g, file, QString{});
+}
+
+bool LC_FilterSnapshot::fileExport(RS_Graphic& g, const QString& file, RS2::FormatType /*type*/) {
+    return write(g, file, QString{});
+}
+
+QString LC_FilterSnapshot::lastError() const {
+    switch (errorCode) {
+    case NoError:
+        return QObject::tr("no error", "LC_FilterSnapshot");
+    case OpenError:
+        return QObject::tr("can't open the snapshot", "LC_FilterSnapshot");
+    case FormatError:
+        return QObject::tr("the file isn't a valid snapshot of this version", "LC_FilterSnapshot");
+    case UnsupportedEntity:
+        return QObject::tr("the drawing has entities, which can't be written to snapshots",
+                           "LC_FilterSnapshot");
+    case WriteError:
+        return QObject::tr("can't write the snapshot", "LC_FilterSnapshot");
+    default:
+        return RS_FilterInterface::lastError();
+    }
+}
+
+bool LC_FilterSnapshot::isCacheEnabled() {
+    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
+    return RS_SETTINGS->readNumEntry("/SnapshotCache", 0) != 0;
+}
+
+QString LC_FilterSnapshot::cacheFileName(const QString& file) {
+    return file + ".lcsnap";
+}
+
+bool LC_FilterSnapshot::importCache(RS_Graphic& g, const QString& file) {
+    const QString snapshot = cacheFileName(file);
+    if (!QFileInfo::exists(snapshot))
+        return false;
+    return read(g, snapshot, file);
+}
+
+bool LC_FilterSnapshot::exportCache(RS_Graphic& g, const QString& file) {
+    return write(g, cacheFileName(file), file);
+}
+
+/**
+ * Reads the snapshot into the graphic. If the source file is given, the snapshot
+ * is only read, if it's the cache of the unchanged file.
+ */
+bool LC_FilterSnapshot::read(RS_Graphic& g, const QString& snapshot, const QString& source) {
+    RS_DEBUG->print("LC_FilterSnapshot::read: %s", snapshot.toLatin1().data());
+    QFile file{snapshot};
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorCode = OpenError;
+        return false;
+    }
+    const qint64 size = file.size();
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (data == nullptr) {
+        errorCode = OpenError;
+        return false;
+    }
+
+    SnapshotView view;
+    if (!view.map(data, size) || !view.isValid()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_FilterSnapshot::read: invalid snapshot %s",
+                        snapshot.toLatin1().data());
+        errorCode = FormatError;
+        return false;
+    }
+    const Header& header = view.header();
+    if (!source.isEmpty()) {
+        const QFileInfo sourceInfo{source};
+        if (header.sourceSize != sourceInfo.size()
+                || header.sourceModified != sourceInfo.lastModified().toMSecsSinceEpoch()
+                || view.string(header.application) != RS_SYSTEM->getAppVersion()) {
+            errorCode = FormatError;
+            return false;
+        }
+    }
+
+    readTables(view, g);
+
+    quint64 count = 0;
+    SnapshotBuilder builder{view, g};
+    const BlockRecord* blocks = view.table<BlockRecord>(Blocks, count);
+    for (quint64 i = 0; i < count; ++i) {
+        const BlockRecord& b = blocks[i];
+        auto block = new RS_Block(&g, RS_BlockData(view.string(b.name), RS_Vector(b.baseX, b.baseY),
+                                                   b.flags & BlockFrozen));
+        if (!g.addBlock(block, false)) {
+            delete block;
+            continue;
+        }
+        builder.addEntities(*block, b.entities, b.entityCount);
+        block->setChanged();
+    }
+    g.addBlockNotification();
+
+    builder.addEntities(g, header.entities, header.entityCount);
+    g.setMargins(header.margins[0], header.margins[1], header.margins[2], header.margins[3]);
+    g.setPagesNum(header.pagesHorizontal, header.pagesVertical);
+
+    RS_Layer* current = g.findLayer(g.getVariableString("$CLAYER", "0"));
+    if (current != nullptr)
+        g.getLayerList()->activate(current, true);
+    g.updateInserts();
+
+    errorCode = NoError;
+    return true;
+}
+
+/**
+ * Writes the snapshot of the graphic, as cache of the source file, if it's given.
+ */
+bool LC_FilterSnapshot::write(RS_Graphic& g, const QString& snapshot, const QString& source) {
+    RS_DEBUG->print("LC_FilterSnapshot::write: %s", snapshot.toLatin1().data());
+    SnapshotWriter writer;
+    Header header = createHeader(writer);
+    if (!source.isEmpty()) {
+        const QFileInfo sourceInfo{source};
+        header.sourceSize = sourceInfo.size();
+        header.sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+    }
+    setPageHeader(g, header);
+
+    writer.addVariables(g);
+    writer.addLayers(g);
+    if (!writer.addBlocks(g) || !writer.addEntities(g, header.entities, header.entityCount)) {
+        errorCode = UnsupportedEntity;
+        return false;
+    }
+
+    // readers never see a partly written snapshot
+    QSaveFile file{snapshot};
+    if (!file.open(QIODevice::WriteOnly) || !writer.write(file, header) || !file.commit()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_FilterSnapshot::write: can't write %s",
+                        snapshot.toLatin1().data());
+        errorCode = WriteError;
+        return false;
+    }
+    errorCode = NoError;
+    return true;
+}
+
+QByteArray LC_FilterSnapshot::entitySnapshot(const std::vector<RS_Entity*>& entities) {
+    SnapshotWriter writer;
+    Header header = createHeader(writer);
+    if (!writer.addEntities(entities, header.entities, header.entityCount))
+        return {};
+    return toByteArray(writer, header);
+}
+
+bool LC_FilterSnapshot::readEntitySnapshot(RS_Graphic& g, const QByteArray& snapshot,
+                                           std::vector<RS_Entity*>& entities) {
+    std::vector<quint64> aligned;
+    SnapshotView view;
+    if (!mapBuffer(snapshot, aligned, view))
+        return false;
+    SnapshotBuilder builder{view, g};
+    builder.createEntities(&g, view.header().entities, view.header().entityCount, entities);
+    return true;
+}
+
+QByteArray LC_FilterSnapshot::tableSnapshot(RS_Graphic& g) {
+    SnapshotWriter writer;
+    Header header = createHeader(writer);
+    setPageHeader(g, header);
+    writer.addVariables(g);
+    writer.addLayers(g);
+    return toByteArray(writer, header);
+}
+
+bool LC_FilterSnapshot::readTableSnapshot(RS_Graphic& g, const QByteArray& snapshot) {
+    std::vector<quint64> aligned;
+    SnapshotView view;
+    if (!mapBuffer(snapshot, aligned, view))
+        return false;
+    readTables(view, g);
+    const Header& header = view.header();
+    g.setMargins(header.margins[0], header.margins[1], header.margins[2], header.margins[3]);
+    g.setPagesNum(header.pagesHorizontal, header.pagesVertical);
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_FILTERSNAPSHOT_H
+#define LC_FILTERSNAPSHOT_H
+
+#include <vector>
+
+#include <QByteArray>
+
+#include "rs_filterinterface.h"
+
+class RS_Entity;
+
+/**
+ * @brief The LC_FilterSnapshot class, import and export of LibreCAD snapshots.
+ * A snapshot is a binary image of a drawing, which is read through a mapping of
+ * the file: variables, layers, blocks and entities are tables of fixed size records,
+ * their coordinates are one array of numbers, and their names and texts a string table.
+ * RS_FileIO writes a snapshot next to the DXF files it opens, if the setting
+ * /Defaults/SnapshotCache is on, and reads it instead while the DXF file is unchanged.
+ */
+class LC_FilterSnapshot : public RS_FilterInterface {
+public:
+    enum Error {
+        NoError,
+        OpenError,
+        FormatError,
+        UnsupportedEntity,
+        WriteError
+    };
+
+    bool canImport(const QString& fileName, RS2::FormatType t) const override;
+    bool canExport(const QString& fileName, RS2::FormatType t) const override;
+
+    bool fileImport(RS_Graphic& g, const QString& file, RS2::FormatType type) override;
+    bool fileExport(RS_Graphic& g, const QString& file, RS2::FormatType type) override;
+
+    QString lastError() const override;
+
+    static RS_FilterInterface* createFilter() {
+        return new LC_FilterSnapshot();
+    }
+
+    /** @return whether snapshots are kept for the opened DXF files */
+    static bool isCacheEnabled();
+    /** @return the file name of the snapshot kept for the drawing file */
+    static QString cacheFileName(const QString& file);
+
+    /**
+     * Reads the snapshot kept for the drawing file, if it was written from
+     * the unchanged file by this version. The graphic is unchanged otherwise.
+     */
+    bool importCache(RS_Graphic& g, const QString& file);
+    /** Writes the snapshot of the graphic, which was read from the drawing file. */
+    bool exportCache(RS_Graphic& g, const QString& file);
+
+    /**
+     * @return snapshot of the entities alone, e.g. for the journal of a drawing;
+     * empty if an entity can't be written
+     */
+    static QByteArray entitySnapshot(const std::vector<RS_Entity*>& entities);
+    /**
+     * Creates the entities of a snapshot written by entitySnapshot(), with the graphic
+     * as parent and layers of the graphic. They are not added to the graphic.
+     */
+    static bool readEntitySnapshot(RS_Graphic& g, const QByteArray& snapshot,
+                                   std::vector<RS_Entity*>& entities);
+    /** @return snapshot of the variables, layers and page layout of the graphic */
+    static QByteArray tableSnapshot(RS_Graphic& g);
+    /** Adds the variables and layers of a snapshot written by tableSnapshot() to the graphic. */
+    static bool readTableSnapshot(RS_Graphic& g, const QByteArray& snapshot);
+
+private:
+    bool read(RS_Graphic& g, const QString& snapshot, const QString& source);
+    bool write(RS_Graphic& g, const QString& snapshot, const QString& source);
+};
+
+#endif // LC_FILTERSNAPSHOT_H
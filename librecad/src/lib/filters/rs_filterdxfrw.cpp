@@ -23,14 +23,25 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include<cstdlib>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
 #include <QRegularExpression>
 #include <QStringList>
 #include <QStringConverter>
 
 #include "rs_filterdxfrw.h"
 
+#include "lc_entityvisitor.h"
+#include "lc_imagecache.h"
 #include "lc_parabola.h"
+#include "lc_tracing.h"
 #include "rs_arc.h"
 #include "rs_circle.h"
 #include "rs_dimaligned.h"
@@ -64,6 +75,50 @@
 #include "rs_debug.h"
 #endif
 
+namespace {
+// smaller entity lists are written sequentially, threads are not worth it
+constexpr size_t parallelWriteMinimum = 4096;
+// entities written into one buffer
+constexpr size_t parallelWriteRange = 1024;
+
+// images add image definitions to the file, R12 dimensions remove their unnamed block,
+// both are written by the main writer
+bool needsSequentialWrite(const RS_Entity* e) {
+    switch (e->rtti()) {
+    case RS2::EntityImage:
+    case RS2::EntityDimLinear:
+    case RS2::EntityDimAligned:
+    case RS2::EntityDimAngular:
+    case RS2::EntityDimRadial:
+    case RS2::EntityDimDiametric:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Bounding box of polyline vertices. Arc segments are inside of the box of their
+ * chord, grown by the sagitta, which is |bulge| * chord / 2.
+ * @param toVertex returns the position and the bulge of a vertex
+ */
+template<typename Vertices, typename ToVertex>
+std::pair<RS_Vector, RS_Vector> polylineBox(const Vertices& vertices, ToVertex toVertex) {
+    RS_Vector vMin{RS_MAXDOUBLE, RS_MAXDOUBLE};
+    RS_Vector vMax{RS_MINDOUBLE, RS_MINDOUBLE};
+    double bulge = 0.;
+    for (const auto& v: vertices) {
+        const std::pair<RS_Vector, double> vertex = toVertex(v);
+        vMin = RS_Vector::minimum(vMin, vertex.first);
+        vMax = RS_Vector::maximum(vMax, vertex.first);
+        bulge = std::max(bulge, std::abs(vertex.second));
+    }
+    // no chord is longer than the diagonal
+    const double margin = 0.5 * bulge * vMin.distanceTo(vMax);
+    return {vMin - RS_Vector{margin, margin}, vMax + RS_Vector{margin, margin}};
+}
+}
+
 /**
  * Default constructor.
  *
@@ -128,6 +183,8 @@ QString RS_FilterDXFRW::lastError() const
         return (QObject::tr( "error reading DXF/DWG sections", "RS_FilterDXFRW"));
     case DRW::BAD_CODE_PARSED:
         return (QObject::tr( "error reading DXF/DWG code", "RS_FilterDXFRW"));
+    case DRW::BAD_CANCELED:
+        return (QObject::tr( "reading DXF/DWG file canceled", "RS_FilterDXFRW"));
     default:
         break;
     }
@@ -146,6 +203,7 @@ QString RS_FilterDXFRW::lastError() const
  * taken to be stored in a file.
  */
 bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatType type) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::fileImport");
     RS_DEBUG->print("RS_FilterDXFRW::fileImport");
 
     RS_DEBUG->print("DXFRW Filter: importing file '%s'...", (const char*)QFile::encodeName(file));
@@ -166,6 +224,12 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
     //reset library version
     isLibDxfRw = false;
     libDxfRwVersion = 0;
+    filterLayer.clear();
+    filterLayerImported = true;
+    layerCache.clear();
+    lineTypeCache.clear();
+    lazyBlocks.clear();
+    lazyRecords = nullptr;
 
 #ifdef DWGSUPPORT
     if (type == RS2::FormatDWG) {
@@ -173,7 +237,13 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading DWG file");
         if (RS_DEBUG->getLevel()== RS_Debug::D_DEBUGGING)
             dwgr.setDebug(DRW::DebugLevel::Debug);
-        bool success = dwgr.read(this, true);
+        dwgr.setProbe(importFilter.probe);
+        dwgr.setParallel(true);
+        bool success = false;
+        {
+            LC_TRACE_SCOPE("dwgR::read");
+            success = dwgr.read(this, true);
+        }
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading DWG file: OK");
         RS_DIALOGFACTORY->commandMessage(QObject::tr("Opened dwg file version %1.").arg(printDwgVersion(dwgr.getVersion())));
         int  lastError = dwgr.getError();
@@ -182,17 +252,31 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
             RS_DEBUG->print(RS_Debug::D_WARNING,
                             "Cannot open DWG file '%s'.", (const char*)QFile::encodeName(file));
             errorCode = dwgr.getError();
+            // the entities read may still be opened
+            setLazyBlockLoaders();
             return false;
         }
     } else {
 #endif
         dxfRW dxfR(QFile::encodeName(file));
+        // entities are still added in file order, on this thread
+        dxfR.setParallelEntities(true);
+        dxfR.setProbe(importFilter.probe);
 
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading file");
         if (RS_Debug::D_DEBUGGING == RS_DEBUG->getLevel()) {
             dxfR.setDebug(DRW::DebugLevel::Debug);
         }
-        bool success = dxfR.read(this, true);
+        progressTimer.start();
+        bool success = false;
+        {
+            LC_TRACE_SCOPE("dxfRW::read");
+            success = dxfR.read(this, true);
+        }
+        if (progressCallback)
+            progressCallback(100);
+        else
+            RS_DIALOGFACTORY->updateImportProgress(file, 100);
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading file: OK");
         //graphic->setAutoUpdateBorders(true);
 
@@ -200,6 +284,7 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
             RS_DEBUG->print(RS_Debug::D_WARNING,
                             "Cannot open DXF file '%s'.", (const char*)QFile::encodeName(file));
             errorCode = dxfR.getError();
+            setLazyBlockLoaders();
             return false;
         }
 #ifdef DWGSUPPORT
@@ -207,6 +292,7 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
 #endif
 
     delete dummyContainer;
+    setLazyBlockLoaders();
     /*set current layer */
     RS_Layer* cl = graphic->findLayer(graphic->getVariableString("$CLAYER", "0"));
 	if (cl ){
@@ -221,10 +307,47 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
     return true;
 }
 
+void RS_FilterDXFRW::setImportFilter(const ImportFilter& filter) {
+    importFilter = filter;
+    filterLayer.clear();
+    filterLayerImported = true;
+}
+
+bool RS_FilterDXFRW::isImported(const DRW_Entity& data, RS2::EntityType type) const {
+    // inserts may need the whole block content
+    if (currentContainer != graphic) {
+        return true;
+    }
+    if (!importFilter.types.isEmpty() && !importFilter.types.contains(type)) {
+        return false;
+    }
+    if (!importFilter.layers.isEmpty() && (filterLayer.empty() || data.layer != filterLayer)) {
+        filterLayer = data.layer;
+        QString layName = toNativeString(QString::fromUtf8(data.layer.c_str()));
+        filterLayerImported = importFilter.layers.contains(layName, Qt::CaseInsensitive);
+    }
+    return importFilter.layers.isEmpty() || filterLayerImported;
+}
+
+bool RS_FilterDXFRW::isImported(const DRW_Entity& data, RS2::EntityType type,
+                                const RS_Vector& vMin, const RS_Vector& vMax) const {
+    if (!isImported(data, type)) {
+        return false;
+    }
+    if (currentContainer != graphic || !importFilter.corner1.valid || !importFilter.corner2.valid) {
+        return true;
+    }
+    const RS_Vector regionMin = RS_Vector::minimum(importFilter.corner1, importFilter.corner2);
+    const RS_Vector regionMax = RS_Vector::maximum(importFilter.corner1, importFilter.corner2);
+    return vMin.x <= regionMax.x && vMax.x >= regionMin.x
+            && vMin.y <= regionMax.y && vMax.y >= regionMin.y;
+}
+
 /**
  * Implementation of the method which handles layers.
  */
 void RS_FilterDXFRW::addLayer(const DRW_Layer &data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addLayer");
     RS_DEBUG->print("RS_FilterDXF::addLayer");
     RS_DEBUG->print("  adding layer: %s", data.name.c_str());
 
@@ -328,6 +451,7 @@ void RS_FilterDXFRW::addVport(const DRW_Vport &data) {
  * @todo Adding blocks to blocks (stack for currentContainer)
  */
 void RS_FilterDXFRW::addBlock(const DRW_Block& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addBlock");
 
     RS_DEBUG->print("RS_FilterDXF::addBlock");
 
@@ -340,13 +464,18 @@ void RS_FilterDXFRW::addBlock(const DRW_Block& data) {
     if (mid.toLower() != "paper_space" && mid.toLower() != "model_space") {
 
             RS_Vector bp(data.basePoint.x, data.basePoint.y);
-            RS_Block* block =
-                new RS_Block(graphic, RS_BlockData(name, bp, false ));
+            RS_BlockData blockData(name, bp, false);
+            // external references load their drawing themselves
+            if ((data.flags & 4) != 0)
+                blockData.xrefPath = QString::fromUtf8(data.xrefPath.c_str());
+            RS_Block* block = new RS_Block(graphic, blockData);
             //block->setFlags(flags);
 
             if (graphic->addBlock(block)) {
                 currentContainer = block;
                 blockHash.insert(data.parentHandle, currentContainer);
+                if (importFilter.lazyBlocks && !block->isXref())
+                    lazyRecords = &lazyBlocks[block];
             } else
                 blockHash.insert(data.parentHandle, dummyContainer);
     } else {
@@ -364,21 +493,141 @@ void RS_FilterDXFRW::setBlock(const int handle){
         currentContainer = blockHash.value(handle);
     } else
         currentContainer = graphic;
+    auto it = lazyBlocks.find(currentContainer);
+    lazyRecords = it != lazyBlocks.end() ? &it->second : nullptr;
 }
 
 /**
  * Implementation of the method which closes blocks.
  */
 void RS_FilterDXFRW::endBlock() {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::endBlock");
     if (currentContainer->rtti() == RS2::EntityBlock) {
         RS_Block *bk = (RS_Block *)currentContainer;
         //remove unnamed blocks *D only if version != R12
         if (version!=1009) {
-            if (bk->getName().startsWith("*D") )
+            if (bk->getName().startsWith("*D") ) {
+                lazyBlocks.erase(bk);
                 graphic->removeBlock(bk);
+            }
         }
     }
     currentContainer = graphic;
+    lazyRecords = nullptr;
+}
+
+/**
+ * In the lazy mode, records an entity of the current block instead of creating it.
+ * The data is copied, the reader reuses it.
+ * @return true if the entity was recorded
+ */
+template<class T>
+bool RS_FilterDXFRW::deferBlockEntity(void (RS_FilterDXFRW::*add)(const T&), const T& data) {
+    if (lazyRecords == nullptr)
+        return false;
+    lazyRecords->emplace_back([add, data](RS_FilterDXFRW& filter) {
+        (filter.*add)(data);
+    });
+    return true;
+}
+
+template<class T>
+bool RS_FilterDXFRW::deferBlockEntity(void (RS_FilterDXFRW::*add)(const T*), const T* data) {
+    if (lazyRecords == nullptr)
+        return false;
+    lazyRecords->emplace_back([add, copy = *data](RS_FilterDXFRW& filter) {
+        (filter.*add)(&copy);
+    });
+    return true;
+}
+
+/**
+ * Creates the recorded entities of a block imported lazily.
+ */
+void RS_FilterDXFRW::loadLazyBlock(RS_EntityContainer* block, const std::vector<BlockRecord>& records) {
+    RS_EntityContainer* container = currentContainer;
+    std::vector<BlockRecord>* recording = lazyRecords;
+    currentContainer = block;
+    lazyRecords = nullptr;
+    for (const BlockRecord& record: records) {
+        record(*this);
+    }
+    currentContainer = container;
+    lazyRecords = recording;
+}
+
+/**
+ * Gives the blocks imported lazily a loader. It replays their records on a new
+ * filter with the import state of this one, which is gone when they're loaded.
+ */
+void RS_FilterDXFRW::setLazyBlockLoaders() {
+    lazyRecords = nullptr;
+    if (lazyBlocks.empty())
+        return;
+    auto loader = std::make_shared<RS_FilterDXFRW>();
+    loader->graphic = graphic;
+    loader->file = file;
+    loader->codePage = codePage;
+    loader->versionStr = versionStr;
+    loader->version = version;
+    loader->isLibDxfRw = isLibDxfRw;
+    loader->libDxfRwVersion = libDxfRwVersion;
+    loader->dimStyle = dimStyle;
+    loader->textStyle = textStyle;
+    loader->oldMText = oldMText;
+    for (auto& lazyBlock: lazyBlocks) {
+        if (lazyBlock.second.empty())
+            continue;
+        auto* block = static_cast<RS_Block*>(lazyBlock.first);
+        block->setLoader([loader, records = std::move(lazyBlock.second)](RS_Block& blk) {
+            // layers may have been removed since the import
+            loader->layerCache.clear();
+            loader->loadLazyBlock(&blk, records);
+        });
+    }
+    lazyBlocks.clear();
+}
+
+/**
+ * In the lazy regeneration mode, postpones the update of an entity of the drawing
+ * until it's drawn or queried.
+ *
+ * @param points points of the entity data, estimating its borders together with the margin
+ * @return false, if the entity needs to be updated now
+ */
+bool RS_FilterDXFRW::deferUpdate(RS_EntityContainer* entity, const std::vector<RS_Vector>& points,
+                                 double margin) const {
+    if (!importFilter.lazyRegeneration || currentContainer != graphic || points.empty())
+        return false;
+    RS_Vector minBorder{RS_MAXDOUBLE, RS_MAXDOUBLE};
+    RS_Vector maxBorder{RS_MINDOUBLE, RS_MINDOUBLE};
+    for (const RS_Vector& point: points) {
+        if (!point.valid)
+            continue;
+        minBorder = RS_Vector::minimum(minBorder, point);
+        maxBorder = RS_Vector::maximum(maxBorder, point);
+    }
+    if (minBorder.x > maxBorder.x || !std::isfinite(margin))
+        return false;
+    const RS_Vector offset{margin, margin};
+    entity->deferUpdate(minBorder - offset, maxBorder + offset);
+    return true;
+}
+
+/**
+ * Postpones the update of a dimension, see deferUpdate(). The label, the arrows and
+ * the extension lines are placed around the definition points.
+ */
+bool RS_FilterDXFRW::deferDimensionUpdate(RS_Dimension* dimension) const {
+    if (!importFilter.lazyRegeneration || currentContainer != graphic)
+        return false;
+    // a measured label has a few digits
+    const QString label = dimension->getText();
+    const int labelSize = label.isEmpty() || label.contains("<>") ? label.size() + 10 : label.size();
+    const double scale = dimension->getGeneralScale();
+    const double margin = ((labelSize + 1) * dimension->getTextHeight() + dimension->getArrowSize()
+                           + dimension->getExtensionLineExtension()) * scale;
+    return deferUpdate(dimension, dimension->getRefPoints().getVector(), margin);
 }
 
 
@@ -387,7 +636,12 @@ void RS_FilterDXFRW::endBlock() {
  * Implementation of the method which handles point entities.
  */
 void RS_FilterDXFRW::addPoint(const DRW_Point& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addPoint");
+    if (deferBlockEntity(&RS_FilterDXFRW::addPoint, data))
+        return;
     RS_Vector v(data.basePoint.x, data.basePoint.y);
+    if (!isImported(data, RS2::EntityPoint, v, v))
+        return;
 
     RS_Point* entity = new RS_Point(currentContainer,
                                     RS_PointData(v));
@@ -402,12 +656,18 @@ void RS_FilterDXFRW::addPoint(const DRW_Point& data) {
  * Implementation of the method which handles line entities.
  */
 void RS_FilterDXFRW::addLine(const DRW_Line& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addLine");
     RS_DEBUG->print("RS_FilterDXF::addLine");
 
+    if (deferBlockEntity(&RS_FilterDXFRW::addLine, data))
+        return;
     RS_Vector v1(data.basePoint.x, data.basePoint.y);
     RS_Vector v2(data.secPoint.x, data.secPoint.y);
 
     RS_DEBUG->print("RS_FilterDXF::addLine: create line");
+    if (!isImported(data, RS2::EntityLine,
+                    RS_Vector::minimum(v1, v2), RS_Vector::maximum(v1, v2)))
+        return;
 
 	if (!currentContainer) {
 		RS_DEBUG->print("RS_FilterDXF::addLine: currentContainer is nullptr");
@@ -429,7 +689,12 @@ void RS_FilterDXFRW::addLine(const DRW_Line& data) {
  * Implementation of the method which handles ray entities.
  */
 void RS_FilterDXFRW::addRay(const DRW_Ray& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addRay");
     RS_DEBUG->print("RS_FilterDXF::addRay");
+    if (deferBlockEntity(&RS_FilterDXFRW::addRay, data))
+        return;
+    if (!isImported(data, RS2::EntityLine))
+        return;
 
 	RS_Vector v1{data.basePoint.x, data.basePoint.y};
 	RS_Vector v2{data.basePoint.x+data.secPoint.x,
@@ -457,7 +722,12 @@ void RS_FilterDXFRW::addRay(const DRW_Ray& data) {
  * Implementation of the method which handles line entities.
  */
 void RS_FilterDXFRW::addXline(const DRW_Xline& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addXline");
     RS_DEBUG->print("RS_FilterDXF::addXline");
+    if (deferBlockEntity(&RS_FilterDXFRW::addXline, data))
+        return;
+    if (!isImported(data, RS2::EntityConstructionLine))
+        return;
 
     RS_Vector v1(data.basePoint.x, data.basePoint.y);
     RS_Vector v2(data.basePoint.x+data.secPoint.x, data.basePoint.y+data.secPoint.y);
@@ -485,9 +755,15 @@ void RS_FilterDXFRW::addXline(const DRW_Xline& data) {
  * Implementation of the method which handles circle entities.
  */
 void RS_FilterDXFRW::addCircle(const DRW_Circle& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addCircle");
     RS_DEBUG->print("RS_FilterDXF::addCircle");
 
+    if (deferBlockEntity(&RS_FilterDXFRW::addCircle, data))
+        return;
 	RS_Vector v{data.basePoint.x, data.basePoint.y};
+    const RS_Vector r{data.radious, data.radious};
+    if (!isImported(data, RS2::EntityCircle, v - r, v + r))
+        return;
 	RS_Circle* entity = new RS_Circle(currentContainer, {v, data.radious});
     setEntityAttributes(entity, &data);
 
@@ -503,8 +779,14 @@ void RS_FilterDXFRW::addCircle(const DRW_Circle& data) {
  * @param angle2 End angle in deg (!)
  */
 void RS_FilterDXFRW::addArc(const DRW_Arc& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addArc");
     RS_DEBUG->print("RS_FilterDXF::addArc");
+    if (deferBlockEntity(&RS_FilterDXFRW::addArc, data))
+        return;
     RS_Vector v(data.basePoint.x, data.basePoint.y);
+    const RS_Vector r{data.radious, data.radious};
+    if (!isImported(data, RS2::EntityArc, v - r, v + r))
+        return;
     RS_ArcData d(v, data.radious,
                  data.staangle,
                  data.endangle,
@@ -524,11 +806,18 @@ void RS_FilterDXFRW::addArc(const DRW_Arc& data) {
  * @param angle2 End angle in rad (!)
  */
 void RS_FilterDXFRW::addEllipse(const DRW_Ellipse& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addEllipse");
     RS_DEBUG->print("RS_FilterDXFRW::addEllipse");
 
+    if (deferBlockEntity(&RS_FilterDXFRW::addEllipse, data))
+        return;
 	RS_Vector v1(data.basePoint.x, data.basePoint.y);
 	RS_Vector v2(data.secPoint.x, data.secPoint.y);
 	double ang2 = data.endparam;
+	// the major axis is the biggest radius
+	const RS_Vector r{v2.magnitude(), v2.magnitude()};
+	if (!isImported(data, RS2::EntityEllipse, v1 - r, v1 + r))
+		return;
 	if (fabs(ang2 - 2.*M_PI) < RS_TOLERANCE &&
 			fabs(data.staparam) < RS_TOLERANCE)
 		ang2 = 0.;
@@ -546,11 +835,18 @@ void RS_FilterDXFRW::addEllipse(const DRW_Ellipse& data) {
  * Implementation of the method which handles trace entities.
  */
 void RS_FilterDXFRW::addTrace(const DRW_Trace& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addTrace");
+    if (deferBlockEntity(&RS_FilterDXFRW::addTrace, data))
+        return;
     RS_Solid* entity;
 	RS_Vector v1{data.basePoint.x, data.basePoint.y};
 	RS_Vector v2{data.secPoint.x, data.secPoint.y};
 	RS_Vector v3{data.thirdPoint.x, data.thirdPoint.y};
 	RS_Vector v4{data.fourPoint.x, data.fourPoint.y};
+    if (!isImported(data, RS2::EntitySolid,
+                    RS_Vector::minimum(RS_Vector::minimum(v1, v2), RS_Vector::minimum(v3, v4)),
+                    RS_Vector::maximum(RS_Vector::maximum(v1, v2), RS_Vector::maximum(v3, v4))))
+        return;
     if (v3 == v4)
         entity = new RS_Solid(currentContainer, RS_SolidData(v1, v2, v3));
     else
@@ -564,6 +860,7 @@ void RS_FilterDXFRW::addTrace(const DRW_Trace& data) {
  * Implementation of the method which handles solid entities.
  */
 void RS_FilterDXFRW::addSolid(const DRW_Solid& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addSolid");
     addTrace(data);
 }
 
@@ -571,9 +868,17 @@ void RS_FilterDXFRW::addSolid(const DRW_Solid& data) {
  * Implementation of the method which handles lightweight polyline entities.
  */
 void RS_FilterDXFRW::addLWPolyline(const DRW_LWPolyline& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addLWPolyline");
     RS_DEBUG->print("RS_FilterDXFRW::addLWPolyline");
+    if (deferBlockEntity(&RS_FilterDXFRW::addLWPolyline, data))
+        return;
     if (data.vertlist.empty())
         return;
+    const auto box = polylineBox(data.vertlist, [](const DRW_Vertex2D& v) {
+        return std::make_pair(RS_Vector{v.x, v.y}, v.bulge);
+    });
+    if (!isImported(data, RS2::EntityPolyline, box.first, box.second))
+        return;
     RS_PolylineData d(RS_Vector{},
                       RS_Vector{},
                       data.flags&0x1);
@@ -581,8 +886,9 @@ void RS_FilterDXFRW::addLWPolyline(const DRW_LWPolyline& data) {
     setEntityAttributes(polyline, &data);
 
     std::vector<std::pair<RS_Vector, double> > verList;
+    verList.reserve(data.vertlist.size());
     for (auto const& v: data.vertlist)
-        verList.emplace_back(std::make_pair(RS_Vector{v->x, v->y}, v->bulge));
+        verList.emplace_back(std::make_pair(RS_Vector{v.x, v.y}, v.bulge));
 
     polyline->appendVertexs(verList);
 
@@ -594,12 +900,22 @@ void RS_FilterDXFRW::addLWPolyline(const DRW_LWPolyline& data) {
  * Implementation of the method which handles polyline entities.
  */
 void RS_FilterDXFRW::addPolyline(const DRW_Polyline& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addPolyline");
     RS_DEBUG->print("RS_FilterDXFRW::addPolyline");
+    if (deferBlockEntity(&RS_FilterDXFRW::addPolyline, data))
+        return;
     if ( data.flags&0x10)
         return; //the polyline is a polygon mesh, not handled
 
     if ( data.flags&0x40)
         return; //the polyline is a poliface mesh, TODO convert
+    if (!data.vertlist.empty()) {
+        const auto box = polylineBox(data.vertlist, [](const DRW_Vertex& v) {
+            return std::make_pair(RS_Vector{v.basePoint.x, v.basePoint.y}, v.bulge);
+        });
+        if (!isImported(data, RS2::EntityPolyline, box.first, box.second))
+            return;
+    }
 
     RS_PolylineData d(RS_Vector{},
                       RS_Vector{},
@@ -608,11 +924,11 @@ void RS_FilterDXFRW::addPolyline(const DRW_Polyline& data) {
     setEntityAttributes(polyline, &data);
 
     std::vector< std::pair<RS_Vector, double> > verList;
-
+    verList.reserve(data.vertlist.size());
     for (auto const& v: data.vertlist)
         verList.emplace_back(
-                    std::make_pair(RS_Vector{v->basePoint.x, v->basePoint.y},
-                                   v->bulge));
+                    std::make_pair(RS_Vector{v.basePoint.x, v.basePoint.y},
+                                   v.bulge));
 
     polyline->appendVertexs(verList);
 
@@ -624,13 +940,33 @@ void RS_FilterDXFRW::addPolyline(const DRW_Polyline& data) {
  * Implementation of the method which handles splines.
  */
 void RS_FilterDXFRW::addSpline(const DRW_Spline* data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addSpline");
     RS_DEBUG->print("RS_FilterDXFRW::addSpline: degree: %d", data->degree);
+    if (deferBlockEntity(&RS_FilterDXFRW::addSpline, data))
+        return;
+    RS2::EntityType type = RS2::EntitySpline;
+    if (data->degree == 2)
+        type = data->controllist.size() == 3 ? RS2::EntityParabola : RS2::EntitySplinePoints;
+    if (data->controllist.empty()) {
+        if (!isImported(*data, type))
+            return;
+    } else {
+        // the curve is inside of the convex hull of the control points
+        RS_Vector vMin{RS_MAXDOUBLE, RS_MAXDOUBLE};
+        RS_Vector vMax{RS_MINDOUBLE, RS_MINDOUBLE};
+        for (const auto& c: data->controllist) {
+            vMin = RS_Vector::minimum(vMin, {c.x, c.y});
+            vMax = RS_Vector::maximum(vMax, {c.x, c.y});
+        }
+        if (!isImported(*data, type, vMin, vMax))
+            return;
+    }
 
 	if(data->degree == 2)
 	{
         if (data->controllist.size() == 3) {
-            auto toRs = [](const std::shared_ptr<DRW_Coord>& coord) -> RS_Vector {
-                return coord ? RS_Vector{coord->x, coord->y} : RS_Vector{};
+            auto toRs = [](const DRW_Coord& coord) -> RS_Vector {
+                return {coord.x, coord.y};
             };
             LC_ParabolaData d{{toRs(data->controllist.at(0)),
                             toRs(data->controllist.at(1)),
@@ -648,7 +984,7 @@ void RS_FilterDXFRW::addSpline(const DRW_Spline* data) {
 		currentContainer->addEntity(splinePoints);
 
         for(auto const& vert: data->controllist) {
-            splinePoints->addControlPoint({vert->x, vert->y});
+            splinePoints->addControlPoint({vert.x, vert.y});
 		}
 
 		splinePoints->update();
@@ -675,17 +1011,19 @@ void RS_FilterDXFRW::addSpline(const DRW_Spline* data) {
         return;
 	}
 	for (auto const& vert: data->controllist)
-        spline->addControlPoint({vert->x, vert->y});
+        spline->addControlPoint({vert.x, vert.y});
 
     if (data->ncontrol== 0 && data->degree != 2){
         for (auto const& vert: data->fitlist)
-            spline->addControlPoint({vert->x, vert->y});
+            spline->addControlPoint({vert.x, vert.y});
     }
     // ensure that the spline is really closed
     if (spline->data.closed and !spline->hasWrappedControlPoints())
         spline->data.closed = 0;
 
-    spline->update();
+    // the curve is within the convex hull of its control points
+    if (!deferUpdate(spline, spline->getControlPoints(), 0.))
+        spline->update();
 }
 
 
@@ -693,8 +1031,14 @@ void RS_FilterDXFRW::addSpline(const DRW_Spline* data) {
  * Implementation of the method which handles inserts.
  */
 void RS_FilterDXFRW::addInsert(const DRW_Insert& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addInsert");
 
     RS_DEBUG->print("RS_FilterDXF::addInsert");
+    if (deferBlockEntity(&RS_FilterDXFRW::addInsert, data))
+        return;
+    // the block extents are not known yet
+    if (!isImported(data, RS2::EntityInsert))
+        return;
 
     RS_Vector ip(data.basePoint.x, data.basePoint.y);
     RS_Vector sc(data.xscale, data.yscale);
@@ -720,7 +1064,12 @@ void RS_FilterDXFRW::addInsert(const DRW_Insert& data) {
  * multi texts (MTEXT).
  */
 void RS_FilterDXFRW::addMText(const DRW_MText& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addMText");
     RS_DEBUG->print("RS_FilterDXF::addMText: %s", data.text.c_str());
+    if (deferBlockEntity(&RS_FilterDXFRW::addMText, data))
+        return;
+    if (!isImported(data, RS2::EntityMText))
+        return;
 
     RS_MTextData::VAlign valign;
     RS_MTextData::HAlign halign;
@@ -811,7 +1160,10 @@ void RS_FilterDXFRW::addMText(const DRW_MText& data) {
     RS_MText* entity = new RS_MText(currentContainer, d);
 
     setEntityAttributes(entity, &data);
-    entity->update();
+    // any layout of the lines is within the length of the text from the insertion point
+    const double textSize = (mtext.size() + 1) * data.height * std::max(1., interlin * 5. / 3.);
+    if (!deferUpdate(entity, {ip}, std::max(textSize, data.widthscale)))
+        entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -822,7 +1174,12 @@ void RS_FilterDXFRW::addMText(const DRW_MText& data) {
  * texts (TEXT).
  */
 void RS_FilterDXFRW::addText(const DRW_Text& data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addText");
     RS_DEBUG->print("RS_FilterDXFRW::addText");
+    if (deferBlockEntity(&RS_FilterDXFRW::addText, data))
+        return;
+    if (!isImported(data, RS2::EntityText))
+        return;
     RS_Vector refPoint = RS_Vector(data.basePoint.x, data.basePoint.y);;
     RS_Vector secPoint = RS_Vector(data.secPoint.x, data.secPoint.y);;
     double angle = data.angle;
@@ -870,7 +1227,13 @@ void RS_FilterDXFRW::addText(const DRW_Text& data) {
     RS_Text* entity = new RS_Text(currentContainer, d);
 
     setEntityAttributes(entity, &data);
-    entity->update();
+    // any layout of the text is within its length from the alignment points
+    std::vector<RS_Vector> alignment{refPoint};
+    if (data.alignH == DRW_Text::HAligned || data.alignH == DRW_Text::HFit)
+        alignment.push_back(secPoint);
+    const double textSize = (mtext.size() + 1) * data.height * std::max(1., data.widthscale);
+    if (!deferUpdate(entity, alignment, textSize))
+        entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -946,7 +1309,12 @@ RS_DimensionData RS_FilterDXFRW::convDimensionData(const  DRW_Dimension* data) {
  * aligned dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addDimAlign");
     RS_DEBUG->print("RS_FilterDXFRW::addDimAligned");
+    if (deferBlockEntity(&RS_FilterDXFRW::addDimAlign, data))
+        return;
+    if (!isImported(*data, RS2::EntityDimAligned))
+        return;
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
 
@@ -959,7 +1327,8 @@ void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
                             dimensionData, d);
     setEntityAttributes(entity, data);
     entity->updateDimPoint();
-    entity->update();
+    if (!deferDimensionUpdate(entity))
+        entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -970,7 +1339,12 @@ void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
  * linear dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addDimLinear");
     RS_DEBUG->print("RS_FilterDXFRW::addDimLinear");
+    if (deferBlockEntity(&RS_FilterDXFRW::addDimLinear, data))
+        return;
+    if (!isImported(*data, RS2::EntityDimLinear))
+        return;
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
 
@@ -983,7 +1357,8 @@ void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
     RS_DimLinear* entity = new RS_DimLinear(currentContainer,
                                             dimensionData, d);
     setEntityAttributes(entity, data);
-    entity->update();
+    if (!deferDimensionUpdate(entity))
+        entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -994,7 +1369,12 @@ void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
  * radial dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addDimRadial");
     RS_DEBUG->print("RS_FilterDXFRW::addDimRadial");
+    if (deferBlockEntity(&RS_FilterDXFRW::addDimRadial, data))
+        return;
+    if (!isImported(*data, RS2::EntityDimRadial))
+        return;
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
     RS_Vector dp(data->getDiameterPoint().x, data->getDiameterPoint().y);
@@ -1005,7 +1385,8 @@ void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
                                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
+    if (!deferDimensionUpdate(entity))
+        entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -1016,7 +1397,12 @@ void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
  * diametric dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addDimDiametric");
     RS_DEBUG->print("RS_FilterDXFRW::addDimDiametric");
+    if (deferBlockEntity(&RS_FilterDXFRW::addDimDiametric, data))
+        return;
+    if (!isImported(*data, RS2::EntityDimDiametric))
+        return;
 
     RS_DimensionData dimensionData = convDimensionData((DRW_Dimension*)data);
     RS_Vector dp(data->getDiameter1Point().x, data->getDiameter1Point().y);
@@ -1027,7 +1413,8 @@ void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
                               dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
+    if (!deferDimensionUpdate(entity))
+        entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -1038,7 +1425,12 @@ void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
  * angular dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimAngular(const DRW_DimAngular* data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addDimAngular");
     RS_DEBUG->print("RS_FilterDXFRW::addDimAngular");
+    if (deferBlockEntity(&RS_FilterDXFRW::addDimAngular, data))
+        return;
+    if (!isImported(*data, RS2::EntityDimAngular))
+        return;
 
     RS_DimensionData dimensionData = convDimensionData(data);
     RS_Vector dp1(data->getFirstLine1().x, data->getFirstLine1().y);
@@ -1063,7 +1455,12 @@ void RS_FilterDXFRW::addDimAngular(const DRW_DimAngular* data) {
  * angular dimensions (DIMENSION).
  */
 void RS_FilterDXFRW::addDimAngular3P(const DRW_DimAngular3p* data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addDimAngular3P");
     RS_DEBUG->print("RS_FilterDXFRW::addDimAngular3P");
+    if (deferBlockEntity(&RS_FilterDXFRW::addDimAngular3P, data))
+        return;
+    if (!isImported(*data, RS2::EntityDimAngular))
+        return;
 
     RS_DimensionData dimensionData = convDimensionData(data);
     RS_Vector dp1(data->getFirstLine().x, data->getFirstLine().y);
@@ -1093,7 +1490,12 @@ void RS_FilterDXFRW::addDimOrdinate(const DRW_DimOrdinate* /*data*/) {
  * Implementation of the method which handles leader entities.
  */
 void RS_FilterDXFRW::addLeader(const DRW_Leader *data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addLeader");
     RS_DEBUG->print("RS_FilterDXFRW::addDimLeader");
+    if (deferBlockEntity(&RS_FilterDXFRW::addLeader, data))
+        return;
+    if (!isImported(*data, RS2::EntityDimLeader))
+        return;
     RS_LeaderData d(data->arrow!=0);
     RS_Leader* leader = new RS_Leader(currentContainer, d);
     setEntityAttributes(leader, data);
@@ -1112,7 +1514,12 @@ void RS_FilterDXFRW::addLeader(const DRW_Leader *data) {
  * Implementation of the method which handles hatch entities.
  */
 void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addHatch");
     RS_DEBUG->print("RS_FilterDXF::addHatch()");
+    if (deferBlockEntity(&RS_FilterDXFRW::addHatch, data))
+        return;
+    if (!isImported(*data, RS2::EntityHatch))
+        return;
     RS_Hatch* hatch;
     RS_EntityContainer* hatchLoop;
 
@@ -1135,7 +1542,7 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
 			RS_Polyline polyline{nullptr,
 					RS_PolylineData(RS_Vector(false), RS_Vector(false), pline->flags)};
 			for (auto const& vert: pline->vertlist)
-				polyline.addVertex(RS_Vector{vert->x, vert->y}, vert->bulge);
+				polyline.addVertex(RS_Vector{vert.x, vert.y}, vert.bulge);
 
 			for (RS_Entity* e=polyline.firstEntity(); e;
 					e=polyline.nextEntity()) {
@@ -1225,7 +1632,10 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
 
     RS_DEBUG->print("hatch->update()");
     if (hatch->validate()) {
-        hatch->update();
+        // the borders of the boundary are exact
+        hatch->calculateBorders();
+        if (!deferUpdate(hatch, {hatch->getMin(), hatch->getMax()}, 0.))
+            hatch->update();
     } else {
         graphic->removeEntity(hatch);
         RS_DEBUG->print(RS_Debug::D_ERROR,
@@ -1238,12 +1648,26 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
  * Implementation of the method which handles image entities.
  */
 void RS_FilterDXFRW::addImage(const DRW_Image *data) {
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addImage");
     RS_DEBUG->print("RS_FilterDXF::addImage");
+    // linkImage() needs the images of blocks, create the block now
+    if (lazyRecords != nullptr) {
+        std::vector<BlockRecord> records = std::move(*lazyRecords);
+        lazyBlocks.erase(currentContainer);
+        lazyRecords = nullptr;
+        loadLazyBlock(currentContainer, records);
+    }
 
     RS_Vector ip(data->basePoint.x, data->basePoint.y);
     RS_Vector uv(data->secPoint.x, data->secPoint.y);
     RS_Vector vv(data->vVector.x, data->vVector.y);
     RS_Vector size(data->sizeu, data->sizev);
+    const RS_Vector u = uv * size.x;
+    const RS_Vector v = vv * size.y;
+    if (!isImported(*data, RS2::EntityImage,
+                    RS_Vector::minimum(RS_Vector::minimum(ip, ip + u), RS_Vector::minimum(ip + v, ip + u + v)),
+                    RS_Vector::maximum(RS_Vector::maximum(ip, ip + u), RS_Vector::maximum(ip + v, ip + u + v))))
+        return;
 
     RS_Image* image = new RS_Image( currentContainer,
             RS_ImageData(data->ref, ip, uv, vv, size,
@@ -1289,6 +1713,9 @@ void RS_FilterDXFRW::linkImage(const DRW_ImageDef *data) {
         }
     }
 
+    // the file is read once for all its images, while they're updated
+    std::shared_ptr<LC_ImagePyramid> imageFile = LC_ImageCache::instance().pyramid(sfile);
+
     // Also link images in subcontainers (e.g. inserts):
     for (RS_Entity* e=graphic->firstEntity(RS2::ResolveNone);
             e; e=graphic->nextEntity(RS2::ResolveNone)) {
@@ -1326,6 +1753,7 @@ using std::map;
  * Sets the header variables from the DXF file.
  */
 void RS_FilterDXFRW::addHeader(const DRW_Header* data){
+    LC_TRACE_SCOPE("RS_FilterDXFRW::addHeader");
 	RS_Graphic* container = nullptr;
     if (currentContainer->rtti()==RS2::EntityGraphic) {
         container = (RS_Graphic*)currentContainer;
@@ -1435,31 +1863,13 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
     //
 #endif
 
-    // set version for DXF filter:
-    exactColor = false;
-    DRW::Version exportVersion;
-    if (type==RS2::FormatDXFRW12) {
-        exportVersion = DRW::AC1009;
-        version = 1009;
-    } else if (type==RS2::FormatDXFRW14) {
-        exportVersion = DRW::AC1014;
-        version = 1014;
-    } else if (type==RS2::FormatDXFRW2000) {
-        exportVersion = DRW::AC1015;
-        version = 1015;
-    } else if (type==RS2::FormatDXFRW2004) {
-        exportVersion = DRW::AC1018;
-        version = 1018;
-        exactColor = true;
-    } else {
-        exportVersion = DRW::AC1021;
-        version = 1021;
-        exactColor = true;
-    }
-
+    const DRW::Version exportVersion = setExportVersion(type);
+    const bool binary = type==RS2::FormatDXFRWBinary;
+    // layers may have been renamed since an earlier export
+    exportLayerNames.clear();
+    exportPen.reset();
     dxfW = new dxfRW(QFile::encodeName(file));
-    bool success = dxfW->write(this, exportVersion, false); //ascii
-//    bool success = dxf->write(this, exportVersion, true); //binary
+    bool success = dxfW->write(this, exportVersion, binary);
     delete dxfW;
 
     if (!success) {
@@ -1490,6 +1900,61 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
     return success;
 }
 
+/**
+ * Writes the graphic in a DXF format into memory, the content of the file
+ * that fileExport() writes.
+ * @param data the DXF data, replaced
+ */
+bool RS_FilterDXFRW::bufferExport(RS_Graphic& g, std::string& data, RS2::FormatType type) {
+    RS_DEBUG->print("RS_FilterDXFDW::bufferExport: file type '%d'", (int)type);
+
+    this->graphic = &g;
+    const DRW::Version exportVersion = setExportVersion(type);
+    const bool binary = type==RS2::FormatDXFRWBinary;
+    std::ostringstream stream(binary ? std::ios_base::out | std::ios_base::binary
+                                     : std::ios_base::out);
+    exportLayerNames.clear();
+    exportPen.reset();
+    dxfW = new dxfRW("");
+    bool success = dxfW->write(stream, this, exportVersion, binary);
+    delete dxfW;
+    dxfW = nullptr;
+
+    if (!success) {
+        RS_DEBUG->print("RS_FilterDXFDW::bufferExport: can't write drawing");
+        return false;
+    }
+    data = std::move(stream).str();
+    return true;
+}
+
+/**
+ * Sets the version written for the format type.
+ */
+DRW::Version RS_FilterDXFRW::setExportVersion(RS2::FormatType type) {
+    exactColor = false;
+    DRW::Version exportVersion;
+    if (type==RS2::FormatDXFRW12) {
+        exportVersion = DRW::AC1009;
+        version = 1009;
+    } else if (type==RS2::FormatDXFRW14) {
+        exportVersion = DRW::AC1014;
+        version = 1014;
+    } else if (type==RS2::FormatDXFRW2000) {
+        exportVersion = DRW::AC1015;
+        version = 1015;
+    } else if (type==RS2::FormatDXFRW2004) {
+        exportVersion = DRW::AC1018;
+        version = 1018;
+        exactColor = true;
+    } else {
+        exportVersion = DRW::AC1021;
+        version = 1021;
+        exactColor = true;
+    }
+    return exportVersion;
+}
+
 /**
  * Prepare unnamed blocks.
  */
@@ -1526,6 +1991,8 @@ void RS_FilterDXFRW::prepareBlocks() {
             case RS2::EntityHatch:
                 if (version==1009) {
                     if ( !((RS_Hatch*)e)->isSolid() ) {
+                        // the pattern is written as lines of an unnamed block
+                        ((RS_Hatch*)e)->materializePattern();
                         prefix = "*U" + QString::number(++hatchNum);
                         noNameBlock[e] = prefix;
                     }
@@ -1577,13 +2044,7 @@ void RS_FilterDXFRW::writeBlocks() {
         block.basePoint.z = 0.0;
         block.flags = 1;//flag for unnamed block
         dxfW->writeBlock(&block);
-        RS_EntityContainer *ct = (RS_EntityContainer *)it.key();
-        for (RS_Entity* e=ct->firstEntity(RS2::ResolveNone);
-             e; e=ct->nextEntity(RS2::ResolveNone)) {
-            if ( !(e->getFlag(RS2::FlagUndone)) ) {
-                writeEntity(e);
-            }
-        }
+        writeContainerEntities((RS_EntityContainer *)it.key());
         ++it;
     }
 
@@ -1598,13 +2059,15 @@ void RS_FilterDXFRW::writeBlocks() {
             block.basePoint.x = blk->getBasePoint().x;
             block.basePoint.y = blk->getBasePoint().y;
             block.basePoint.z = blk->getBasePoint().z;
-            dxfW->writeBlock(&block);
-            for (RS_Entity* e=blk->firstEntity(RS2::ResolveNone);
-                 e; e=blk->nextEntity(RS2::ResolveNone)) {
-                if ( !(e->getFlag(RS2::FlagUndone)) ) {
-                    writeEntity(e);
-                }
+            if (blk->isXref()) {
+                // the entities are in the referenced drawing
+                block.flags = 4;
+                block.xrefPath = blk->getXrefPath().toUtf8().data();
+                dxfW->writeBlock(&block);
+                continue;
             }
+            dxfW->writeBlock(&block);
+            writeContainerEntities(blk);
         }
     }
 }
@@ -2092,74 +2555,116 @@ void RS_FilterDXFRW::writeAppId(){
 }
 
 void RS_FilterDXFRW::writeEntities(){
-    for (RS_Entity *e = graphic->firstEntity(RS2::ResolveNone);
-		 e ; e = graphic->nextEntity(RS2::ResolveNone)) {
+    writeContainerEntities(graphic);
+}
+
+/**
+ * Writes the entities of a container, which are not undone.
+ * Big containers are split into ranges, written into memory buffers on
+ * worker threads, and appended to the file in order. Handles are assigned
+ * when appending, so the file is the same as written sequentially.
+ */
+void RS_FilterDXFRW::writeContainerEntities(RS_EntityContainer* container) {
+    std::vector<RS_Entity*> entities;
+    entities.reserve(container->count());
+    for (RS_Entity *e = container->firstEntity(RS2::ResolveNone);
+         e ; e = container->nextEntity(RS2::ResolveNone)) {
         if ( !(e->getFlag(RS2::FlagUndone)) ) {
+            entities.push_back(e);
+        }
+    }
+
+    const size_t threadCount = std::min<size_t>(std::thread::hardware_concurrency(),
+                                                 entities.size() / parallelWriteRange);
+    if (entities.size() < parallelWriteMinimum || threadCount < 2) {
+        for (RS_Entity* e: entities) {
             writeEntity(e);
         }
+        return;
+    }
+
+    struct Range {
+        size_t begin = 0;
+        size_t end = 0;
+        // nullptr for ranges written by the main writer
+        std::unique_ptr<dxfRW> buffer;
+        std::promise<void> written;
+    };
+    std::vector<Range> ranges((entities.size() + parallelWriteRange - 1) / parallelWriteRange);
+    std::vector<std::future<void>> written;
+    written.reserve(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        Range& range = ranges[i];
+        range.begin = i * parallelWriteRange;
+        range.end = std::min(range.begin + parallelWriteRange, entities.size());
+        if (std::none_of(entities.cbegin() + range.begin, entities.cbegin() + range.end,
+                         needsSequentialWrite)) {
+            range.buffer = dxfW->createEntityBuffer();
+        }
+        written.push_back(range.written.get_future());
+    }
+
+    std::atomic<size_t> nextRange{0};
+    auto writeRanges = [this, &entities, &ranges, &nextRange]() {
+        // the copy writes into the buffers, it shares the read only state of the export
+        RS_FilterDXFRW worker{*this};
+        for (size_t i = nextRange++; i < ranges.size(); i = nextRange++) {
+            Range& range = ranges[i];
+            if (range.buffer != nullptr) {
+                worker.dxfW = range.buffer.get();
+                for (size_t k = range.begin; k < range.end; ++k) {
+                    worker.writeEntity(entities[k]);
+                }
+            }
+            range.written.set_value();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(writeRanges);
+    }
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        written[i].wait();
+        Range& range = ranges[i];
+        if (range.buffer != nullptr) {
+            dxfW->appendEntityBuffer(*range.buffer);
+            range.buffer.reset();
+        } else {
+            for (size_t k = range.begin; k < range.end; ++k) {
+                writeEntity(entities[k]);
+            }
+        }
+    }
+    for (std::thread& t: workers) {
+        t.join();
     }
 }
 
 void RS_FilterDXFRW::writeEntity(RS_Entity* e){
-    switch (e->rtti()) {
-    case RS2::EntityPoint:
-        writePoint((RS_Point*)e);
-        break;
-    case RS2::EntityLine:
-        writeLine((RS_Line*)e);
-        break;
-    case RS2::EntityCircle:
-        writeCircle((RS_Circle*)e);
-        break;
-    case RS2::EntityArc:
-        writeArc((RS_Arc*)e);
-        break;
-    case RS2::EntitySolid:
-        writeSolid((RS_Solid*)e);
-        break;
-    case RS2::EntityEllipse:
-        writeEllipse((RS_Ellipse*)e);
-        break;
-    case RS2::EntityPolyline:
-        writeLWPolyline((RS_Polyline*)e);
-        break;
-    case RS2::EntitySpline:
-        writeSpline((RS_Spline*)e);
-        break;
-    case RS2::EntitySplinePoints:
-    case RS2::EntityParabola:
-        writeSplinePoints((LC_SplinePoints*)e);
-        break;
-//    case RS2::EntityVertex:
-//        break;
-    case RS2::EntityInsert:
-        writeInsert((RS_Insert*)e);
-        break;
-    case RS2::EntityMText:
-        writeMText((RS_MText*)e);
-        break;
-    case RS2::EntityText:
-        writeText((RS_Text*)e);
-        break;
-    case RS2::EntityDimLinear:
-    case RS2::EntityDimAligned:
-    case RS2::EntityDimAngular:
-    case RS2::EntityDimRadial:
-    case RS2::EntityDimDiametric:
-        writeDimension((RS_Dimension*)e);
-        break;
-    case RS2::EntityDimLeader:
-        writeLeader((RS_Leader*)e);
-        break;
-    case RS2::EntityHatch:
-        writeHatch((RS_Hatch*)e);
-        break;
-    case RS2::EntityImage:
-        writeImage((RS_Image*)e);
-        break;
-    default:
-        break;
-    }
+    // arc dimensions, construction lines, hyperbolas and vertices are not exported
+    LC_EntityVisitor::visit(*e, LC_Overloaded{
+        [this](RS_Point& p) { writePoint(&p); },
+        [this](RS_Line& l) { writeLine(&l); },
+        [this](RS_Circle& c) { writeCircle(&c); },
+        [this](RS_Arc& a) { writeArc(&a); },
+        [this](RS_Solid& s) { writeSolid(&s); },
+        [this](RS_Ellipse& el) { writeEllipse(&el); },
+        [this](RS_Polyline& l) { writeLWPolyline(&l); },
+        [this](RS_Spline& s) { writeSpline(&s); },
+        // parabolas included
+        [this](LC_SplinePoints& s) { writeSplinePoints(&s); },
+        [this](RS_Insert& i) { writeInsert(&i); },
+        [this](RS_MText& t) { writeMText(&t); },
+        [this](RS_Text& t) { writeText(&t); },
+        [this](RS_Dimension& d) { writeDimension(&d); },
+        [](LC_DimArc&) {},
+        [this](RS_Leader& l) { writeLeader(&l); },
+        [this](RS_Hatch& h) { writeHatch(&h); },
+        [this](RS_Image& i) { writeImage(&i); },
+        [](RS_Entity&) {}
+    });
 }
 
 
@@ -2235,40 +2740,19 @@ void RS_FilterDXFRW::writeLWPolyline(RS_Polyline* l) {
         return;
     }
     DRW_LWPolyline pol;
-    RS_Entity* currEntity = 0;
-    RS_Entity* nextEntity = 0;
-	RS_AtomicEntity* ae = nullptr;
-    double bulge=0.0;
-
-    for (RS_Entity* e=l->firstEntity(RS2::ResolveNone);
-         e; e=nextEntity) {
-
-        currEntity = e;
-        nextEntity = l->nextEntity(RS2::ResolveNone);
-
-        if (!e->isAtomic()) {
-            continue;
-        }
-        ae = (RS_AtomicEntity*)e;
-
-        // Write vertex:
-            if (e->rtti()==RS2::EntityArc) {
-                bulge = ((RS_Arc*)e)->getBulge();
-            } else
-                bulge = 0.0;
-            pol.addVertex( DRW_Vertex2D(ae->getStartpoint().x,
-                                      ae->getStartpoint().y, bulge));
+    const std::shared_ptr<const std::vector<RS_PolylineVertex>> vertexArray = l->getVertices();
+    const std::vector<RS_PolylineVertex>& vertices = *vertexArray;
+    if (vertices.empty())
+        return;
+    // the last vertex of a closed polyline repeats the first one
+    const size_t count = l->isClosed() ? vertices.size() - 1 : vertices.size();
+    pol.vertlist.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const RS_PolylineVertex& v = vertices[i];
+        pol.addVertex(DRW_Vertex2D(v.point.x, v.point.y, v.bulge));
     }
-    if (l->isClosed()) {
+    if (l->isClosed())
         pol.flags = 1;
-    } else {
-        ae = (RS_AtomicEntity*)currEntity;
-        if (ae->rtti()==RS2::EntityArc) {
-            bulge = ((RS_Arc*)ae)->getBulge();
-        }
-        pol.addVertex( DRW_Vertex2D(ae->getEndpoint().x,
-                                  ae->getEndpoint().y, bulge));
-    }
     pol.vertexnum = pol.vertlist.size();
     getEntityAttributes(&pol, l);
     dxfW->writeLWPolyline(&pol);
@@ -2360,7 +2844,7 @@ void RS_FilterDXFRW::writeSpline(RS_Spline *s) {
     // write spline control points:
     for (const RS_Vector& v: s->getControlPoints())
     {
-        sp.controllist.push_back(std::make_shared<DRW_Coord>(v.x, v.y));
+        sp.controllist.emplace_back(v.x, v.y);
     }
 
     sp.ncontrol = sp.controllist.size();
@@ -2444,7 +2928,7 @@ void RS_FilterDXFRW::writeSplinePoints(LC_SplinePoints *s)
 
 	// write spline control points:
 	for (auto const& v: cp)
-        sp.controllist.push_back(std::make_shared<DRW_Coord>(v.x, v.y));
+        sp.controllist.emplace_back(v.x, v.y);
 
 	getEntityAttributes(&sp, s);
 	dxfW->writeSpline(&sp);
@@ -3041,15 +3525,24 @@ void RS_FilterDXFRW::setEntityAttributes(RS_Entity* entity,
     RS_Pen pen;
     pen.setColor(Qt::black);
     pen.setLineType(RS2::SolidLine);
-    QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
 
-    // Layer: add layer in case it doesn't exist:
-	if (!graphic->findLayer(layName)) {
-        DRW_Layer lay;
-        lay.name = attrib->layer;
-        addLayer(lay);
+    // Layer: add layer in case it doesn't exist, names are resolved once per file:
+    RS_Layer* layer = nullptr;
+    auto layerIt = layerCache.find(attrib->layer);
+    if (layerIt != layerCache.end()) {
+        layer = layerIt->second;
+    } else {
+        QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
+        if (!graphic->findLayer(layName)) {
+            DRW_Layer lay;
+            lay.name = attrib->layer;
+            addLayer(lay);
+        }
+        layer = graphic->findLayer(layName);
+        layerCache.emplace(attrib->layer, layer);
     }
-    entity->setLayer(layName);
+    // like setLayer(name), entities outside of the graphic get no layer
+    entity->setLayer(entity->getGraphic() ? layer : nullptr);
 
     // Color:
     if (attrib->color24 >= 0)
@@ -3060,7 +3553,12 @@ void RS_FilterDXFRW::setEntityAttributes(RS_Entity* entity,
     pen.setColor(numberToColor(attrib->color));
 
     // Linetype:
-    pen.setLineType(nameToLineType( QString::fromUtf8(attrib->lineType.c_str()) ));
+    auto lineTypeIt = lineTypeCache.find(attrib->lineType);
+    if (lineTypeIt == lineTypeCache.end()) {
+        RS2::LineType lineType = nameToLineType( QString::fromUtf8(attrib->lineType.c_str()) );
+        lineTypeIt = lineTypeCache.emplace(attrib->lineType, lineType).first;
+    }
+    pen.setLineType(lineTypeIt->second);
 
     // Width:
     pen.setWidth(numberToWidth(attrib->lWeight));
@@ -3078,32 +3576,32 @@ void RS_FilterDXFRW::getEntityAttributes(DRW_Entity* ent, const RS_Entity* entit
 //DRW_Entity RS_FilterDXFRW::getEntityAttributes(RS_Entity* /*entity*/) {
 
     // Layer:
-    RS_Layer* layer = entity->getLayer();
-    QString layerName;
-    if (layer) {
-        layerName = layer->getName();
-    } else {
-        layerName = "0";
+    // the names and pens are converted once, the entities share a few layers and pens
+    const RS_Layer* layer = entity->getLayer();
+    auto it = exportLayerNames.find(layer);
+    if (it == exportLayerNames.end()) {
+        const QString layerName = layer ? layer->getName() : QString{"0"};
+        it = exportLayerNames.emplace(layer, toDxfString(layerName).toStdString()).first;
     }
 
-    RS_Pen pen = entity->getPen(false);
-
-    // Color:
-    int exact_rgb;
-    int color = colorToNumber(pen.getColor(), &exact_rgb);
-    //printf("Color is: %s -> %d\n", pen.getColor().name().toLatin1().data(), color);
-
-    // Linetype:
-    QString lineType = lineTypeToName(pen.getLineType());
-
-    // Width:
-    DRW_LW_Conv::lineWidth width = widthToNumber(pen.getWidth());
+    const RS_Pen pen = entity->getPen(false);
+    if (exportPen == nullptr || exportPen->pen != pen) {
+        if (exportPen == nullptr)
+            exportPen = std::make_unique<ExportPen>();
+        exportPen->pen = pen;
+        // Color:
+        exportPen->color = colorToNumber(pen.getColor(), &exportPen->color24);
+        // Linetype:
+        exportPen->lineType = lineTypeToName(pen.getLineType()).toStdString();
+        // Width:
+        exportPen->lWeight = widthToNumber(pen.getWidth());
+    }
 
-    ent->layer = toDxfString(layerName).toUtf8().data();
-    ent->color = color;
-    ent->color24 = exact_rgb;
-    ent->lWeight = width;
-    ent->lineType = lineType.toUtf8().data();
+    ent->layer = it->second;
+    ent->color = exportPen->color;
+    ent->color24 = exportPen->color24;
+    ent->lWeight = exportPen->lWeight;
+    ent->lineType = exportPen->lineType;
 }
 
 
@@ -3215,15 +3713,21 @@ int RS_FilterDXFRW::colorToNumber(const RS_Color& col, int *rgb) {
 
 void RS_FilterDXFRW::add3dFace(const DRW_3Dface& data) {
     RS_DEBUG->print("RS_FilterDXFRW::add3dFace");
+    if (deferBlockEntity(&RS_FilterDXFRW::add3dFace, data))
+        return;
+    RS_Vector v1(data.basePoint.x, data.basePoint.y);
+    RS_Vector v2(data.secPoint.x, data.secPoint.y);
+    RS_Vector v3(data.thirdPoint.x, data.thirdPoint.y);
+    RS_Vector v4(data.fourPoint.x, data.fourPoint.y);
+    if (!isImported(data, RS2::EntityPolyline,
+                    RS_Vector::minimum(RS_Vector::minimum(v1, v2), RS_Vector::minimum(v3, v4)),
+                    RS_Vector::maximum(RS_Vector::maximum(v1, v2), RS_Vector::maximum(v3, v4))))
+        return;
     RS_PolylineData d(RS_Vector(false),
                       RS_Vector(false),
                       !data.invisibleflag);
     RS_Polyline *polyline = new RS_Polyline(currentContainer, d);
     setEntityAttributes(polyline, &data);
-    RS_Vector v1(data.basePoint.x, data.basePoint.y);
-    RS_Vector v2(data.secPoint.x, data.secPoint.y);
-    RS_Vector v3(data.thirdPoint.x, data.thirdPoint.y);
-    RS_Vector v4(data.fourPoint.x, data.fourPoint.y);
 
     polyline->addVertex(v1, 0.0);
     polyline->addVertex(v2, 0.0);
@@ -3237,6 +3741,28 @@ void RS_FilterDXFRW::addComment(const char*) {
     RS_DEBUG->print("RS_FilterDXF::addComment(const char*) not yet implemented.");
 }
 
+/**
+ * Shows the entities read so far, a few times per second, and lets
+ * the user cancel the import of huge files.
+ */
+bool RS_FilterDXFRW::readProgress(unsigned long long position, unsigned long long size) {
+    if (progressTimer.elapsed() < 250) {
+        return true;
+    }
+
+    int percent = size > 0 ? static_cast<int>(std::min(position, size) * 100 / size) : 0;
+    percent = std::min(percent, 99);
+    progressTimer.start();
+    if (progressCallback)
+        return progressCallback(percent);
+
+    RS_GraphicView* view = graphic->getGraphicView();
+    if (view != nullptr) {
+        view->redraw(RS2::RedrawDrawing);
+    }
+    return RS_DIALOGFACTORY->updateImportProgress(file, percent);
+}
+
 void RS_FilterDXFRW::addPlotSettings(const DRW_PlotSettings *data) {
     graphic->setPagesNum(QString::fromStdString(data->plotViewName));
     graphic->setMargins(data->marginLeft, data->marginTop,
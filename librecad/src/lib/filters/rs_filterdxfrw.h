@@ -27,10 +27,20 @@
 #ifndef RS_FILTERDXFRW_H
 #define RS_FILTERDXFRW_H
 
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QStringList>
+
 #include "rs_filterinterface.h"
 
 #include "rs_color.h"
 #include "rs_dimension.h"
+#include "rs_pen.h"
 #include "drw_interface.h"
 #include "libdxfrw.h"
 
@@ -38,6 +48,7 @@ class RS_Point;
 class RS_Line;
 class RS_Circle;
 class RS_Arc;
+class RS_Block;
 class RS_Ellipse;
 class RS_Solid;
 class RS_Polyline;
@@ -48,6 +59,7 @@ class RS_MText;
 class RS_Text;
 class RS_Hatch;
 class RS_Image;
+class RS_Layer;
 class RS_Leader;
 class RS_Polyline;
 class DL_WriterA;
@@ -73,7 +85,8 @@ public:
         
      bool canExport(const QString &/*fileName*/, RS2::FormatType t) const override {
         return (t==RS2::FormatDXFRW || t==RS2::FormatDXFRW2004 || t==RS2::FormatDXFRW2000
-                || t==RS2::FormatDXFRW14 || t==RS2::FormatDXFRW12);
+                || t==RS2::FormatDXFRW14 || t==RS2::FormatDXFRW12
+                || t==RS2::FormatDXFRWBinary);
     }
 
     // Error messages
@@ -81,6 +94,52 @@ public:
 
     // Import:
      bool fileImport(RS_Graphic& g, const QString& file, RS2::FormatType type) override;
+    /**
+     * Reports the percentage of the file read to the callback instead of
+     * the dialog factory, and cancels the import if it returns false.
+     * The drawing isn't redrawn while it's read, so that a worker thread can
+     * import a drawing that isn't shown yet.
+     */
+    void setProgressCallback(std::function<bool(int)> callback) {
+        progressCallback = std::move(callback);
+    }
+
+    /**
+     * Options to import a part of a drawing. Entities of other layers, types
+     * or regions are skipped while parsing, before they are created.
+     * The content of blocks is always imported.
+     */
+    struct ImportFilter {
+        /** names of the layers to import, all layers if empty */
+        QStringList layers;
+        /** types of the entities to import, all types if empty */
+        QList<RS2::EntityType> types;
+        /**
+         * Corners of the region to import, the whole drawing unless both are valid.
+         * Entities are imported, if their bounding box overlaps with the region,
+         * or if it can't be known while parsing (inserts, texts, hatches, dimensions)
+         */
+        RS_Vector corner1;
+        RS_Vector corner2;
+        /**
+         * Read only the header variables (units, extents), the tables (layers)
+         * and the names of blocks, but no entities. Fast to index drawings.
+         */
+        bool probe = false;
+        /**
+         * Record the entities of blocks and create them only when the block is
+         * loaded, by the first insert referencing it, the block list or export.
+         * Drawings often carry many blocks which are never inserted.
+         */
+        bool lazyBlocks = true;
+        /**
+         * Create the geometry of the texts, hatches, splines and dimensions of the
+         * drawing only when they're first drawn, queried or exported. Their borders
+         * are estimated from the data in the file until then.
+         */
+        bool lazyRegeneration = true;
+    };
+    void setImportFilter(const ImportFilter& filter);
 
     // Methods from DRW_CreationInterface:
      void addHeader(const DRW_Header* data) override;
@@ -125,11 +184,13 @@ public:
 
      void add3dFace(const DRW_3Dface& data) override;
      void addComment(const char*) override;
+     bool readProgress(unsigned long long position, unsigned long long size) override;
 
      void addPlotSettings(const DRW_PlotSettings* data) override;
 
     // Export:
      bool fileExport(RS_Graphic& g, const QString& file, RS2::FormatType type) override;
+     bool bufferExport(RS_Graphic& g, std::string& data, RS2::FormatType type);
 
      void writeHeader(DRW_Header& data) override;
      void writeEntities() override;
@@ -197,7 +258,21 @@ public:
     static RS_FilterInterface* createFilter(){return new RS_FilterDXFRW();}
 
 private:
+    /** Whether an entity read from the file passes the import filter. */
+    bool isImported(const DRW_Entity& data, RS2::EntityType type) const;
+    bool isImported(const DRW_Entity& data, RS2::EntityType type,
+                    const RS_Vector& vMin, const RS_Vector& vMax) const;
+    DRW::Version setExportVersion(RS2::FormatType type);
     void prepareBlocks();
+    template<class T>
+    bool deferBlockEntity(void (RS_FilterDXFRW::*add)(const T&), const T& data);
+    template<class T>
+    bool deferBlockEntity(void (RS_FilterDXFRW::*add)(const T*), const T* data);
+    void loadLazyBlock(RS_EntityContainer* block, const std::vector<std::function<void(RS_FilterDXFRW&)>>& records);
+    void setLazyBlockLoaders();
+    bool deferUpdate(RS_EntityContainer* entity, const std::vector<RS_Vector>& points, double margin) const;
+    bool deferDimensionUpdate(RS_Dimension* dimension) const;
+    void writeContainerEntities(RS_EntityContainer* container);
     void writeEntity(RS_Entity* e);
 #ifdef DWGSUPPORT
     void printDwgError(int le);
@@ -209,6 +284,9 @@ private:
     RS_Graphic* graphic;
     /** File name. Used to find out the full path of images. */
     QString file;
+    /** Time since the last display of the entities read so far. */
+    QElapsedTimer progressTimer;
+    std::function<bool(int)> progressCallback;
     /** Pointer to current entity container (either block or graphic) */
     RS_EntityContainer* currentContainer;
     /** File codePage. Used to find the text coder. */
@@ -235,6 +313,30 @@ private:
     QHash<int, RS_EntityContainer*> blockHash;
     /** Pointer to entity container to store possible orphan entities like paper space */
     RS_EntityContainer* dummyContainer;
+    /** Parts of the drawing to import. */
+    ImportFilter importFilter;
+    /** DXF attributes of the last exported pen, entities come in runs of the same pen. */
+    struct ExportPen {
+        RS_Pen pen;
+        int color = 0;
+        int color24 = -1;
+        DRW_LW_Conv::lineWidth lWeight = DRW_LW_Conv::widthByLayer;
+        std::string lineType;
+    };
+    std::unique_ptr<ExportPen> exportPen;
+    /** DXF names of the exported layers. */
+    std::unordered_map<const RS_Layer*, std::string> exportLayerNames;
+    /** Last layer name checked by the import filter, entities come in runs of the same layer. */
+    mutable std::string filterLayer;
+    mutable bool filterLayerImported {true};
+    /** Layers and line types by their name in the file, entities share a few names. */
+    std::unordered_map<std::string, RS_Layer*> layerCache;
+    std::unordered_map<std::string, RS2::LineType> lineTypeCache;
+    /** Entities of the blocks imported lazily, replayed on a filter when the block is loaded. */
+    using BlockRecord = std::function<void(RS_FilterDXFRW&)>;
+    std::unordered_map<RS_EntityContainer*, std::vector<BlockRecord>> lazyBlocks;
+    /** Records of the current block, nullptr if its entities are created while reading. */
+    std::vector<BlockRecord>* lazyRecords {nullptr};
 };
 
 #endif
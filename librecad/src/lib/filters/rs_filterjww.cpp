@@ -24,6 +24,9 @@
 **
 **********************************************************************/
 
+#include <set>
+#include <thread>
+
 #include <QRegularExpression>
 #include <QStringConverter>
 #include "rs_filterjww.h"
@@ -47,6 +50,7 @@
 #include "rs_layer.h"
 #include "rs_leader.h"
 #include "rs_line.h"
+#include "rs_mtext.h"
 #include "rs_point.h"
 #include "rs_polyline.h"
 #include "rs_solid.h"
@@ -113,6 +117,7 @@ bool RS_FilterJWW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatTyp
         //graphic->setAutoUpdateBorders(false);
         RS_DEBUG->print("RS_FilterJWW::fileImport: reading file");
         bool success = jww.in((const char*)QFile::encodeName(file), this);
+        updateTexts();
         RS_DEBUG->print("RS_FilterJWW::fileImport: reading file: OK");
         //graphic->setAutoUpdateBorders(true);
 
@@ -547,7 +552,6 @@ void RS_FilterJWW::addMText(const DL_MTextData& data) {
         }
 
     mtext+=data.text.c_str();
-    mtext = toNativeString(mtext.toLocal8Bit().data(), getDXFEncoding());
 
         // use default style for the drawing:
         if (sty.isEmpty()) {
@@ -560,26 +564,78 @@ void RS_FilterJWW::addMText(const DL_MTextData& data) {
                 }
         }
 
-        RS_DEBUG->print("Text as unicode:");
-        RS_DEBUG->printUnicode(mtext);
-
+        // the text is converted and the entity updated by updateTexts()
         RS_MTextData d(ip, data.height, data.width,
                                   valign, halign,
                                   dir, lss,
                                   data.lineSpacingFactor,
-                                  mtext, sty, data.angle,
+                                  QString{}, sty, data.angle,
                                   RS2::NoUpdate);
         RS_MText* entity = new RS_MText(currentContainer, d);
 
         setEntityAttributes(entity, attributes);
-        entity->update();
         currentContainer->addEntity(entity);
+        pendingTexts.push_back({entity, mtext});
 
         mtext = "";
 }
 
 
 
+/**
+ * Converts the texts of the MTEXT entities added by the import and
+ * updates the entities. The conversion doesn't touch the drawing, for
+ * many texts it's split across worker threads. The entities are updated
+ * afterwards in order, as the update loads the fonts.
+ */
+void RS_FilterJWW::updateTexts() {
+    if (pendingTexts.empty()) {
+        return;
+    }
+
+    const QString encoding = getDXFEncoding();
+    auto convertTexts = [this, &encoding](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            QString& text = pendingTexts[i].text;
+            text = toNativeString(text.toLocal8Bit().data(), encoding);
+        }
+    };
+
+    const size_t count = pendingTexts.size();
+    const size_t threadCount = std::min<size_t>(std::thread::hardware_concurrency(),
+                                                count / parallelTextRange);
+    if (threadCount < 2) {
+        convertTexts(0, count);
+    } else {
+        const size_t range = (count + threadCount - 1) / threadCount;
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount);
+        for (size_t begin = 0; begin < count; begin += range) {
+            workers.emplace_back(convertTexts, begin, std::min(begin + range, count));
+        }
+        for (std::thread& t: workers) {
+            t.join();
+        }
+    }
+
+    // the entities were added before their text, so the borders and the
+    // spatial index of their containers are outdated
+    std::set<RS_EntityContainer*> containers;
+    for (PendingText& pending: pendingTexts) {
+        pending.entity->setText(pending.text);
+        pending.entity->update();
+        containers.insert(pending.entity->getParent());
+    }
+    pendingTexts.clear();
+
+    for (RS_EntityContainer* container: containers) {
+        container->invalidateSpatialIndex();
+        container->calculateBorders();
+    }
+}
+
+
+
 /**
  * Implementation of the method which handles
  * texts (TEXT).
@@ -2225,6 +2281,7 @@ void RS_FilterJWW::writeHatch(DL_WriterA& dw, RS_Hatch* h,
 
         // split hatch into atomic entities:
         if (jww.getVersion()==VER_R12) {
+                h->materializePattern();
                 writeAtomicEntities(dw, h, attrib, RS2::ResolveAll);
                 return;
         }
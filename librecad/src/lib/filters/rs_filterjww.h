@@ -28,6 +28,8 @@
 #ifndef RS_FILTERJWW_H
 #define RS_FILTERJWW_H
 
+#include <vector>
+
 #include "rs_filterinterface.h"
 
 #include "rs_color.h"
@@ -174,6 +176,7 @@ public:
 
     static QString toDxfString(const QString& string);
     QString toNativeString(const char* data, const QString& encoding);
+    void updateTexts();
     QString getDXFEncoding();
 
 public:
@@ -228,6 +231,15 @@ private:
     /** Pointer to current hatch loop or NULL. */
     RS_EntityContainer* hatchLoop = nullptr;
 
+    /** MTEXT entity, which text is converted by updateTexts(). */
+    struct PendingText {
+        RS_MText* entity = nullptr;
+        QString text;
+    };
+    /** MTEXT entities added during the import, in order. */
+    std::vector<PendingText> pendingTexts;
+    /** Minimum number of texts converted by each worker thread */
+    static constexpr size_t parallelTextRange = 256;
     DL_Jww jww;
     RS_VariableDict variables;
 };
@@ -26,6 +26,7 @@
 
 #include "lc_xmlwriterinterface.h"
 
+#include "lc_entityvisitor.h"
 #include "lc_splinepoints.h"
 #include "rs_arc.h"
 #include "rs_block.h"
@@ -78,6 +79,8 @@ bool LC_MakerCamSVG::generate(RS_Graphic* graphic) {
 
     write(graphic);
 
+    xmlWriter->endDocument();
+
     return true;
 }
 
@@ -222,62 +225,92 @@ void LC_MakerCamSVG::writeEntities(RS_Document* document, RS_Layer* layer) {
 
     RS_DEBUG->print("RS_MakerCamSVG::writeEntities: Writing entities from layer ...");
 
-	for (auto e: *document) {
+    // connected lines and arcs, written as a single path
+    std::string path;
+    RS_Entity* pathStart = nullptr;
+    RS_Vector pathEndpoint{false};
+    int pathSize = 0;
+
+    auto writePath = [&]() {
+        if (pathSize == 1) {
+            writeEntity(pathStart);
+        }
+        else if (pathSize > 1) {
+            if (pathEndpoint.distanceTo(pathStart->getStartpoint()) < RS_TOLERANCE) {
+                path += svgPathClose();
+            }
+            xmlWriter->addElement("path", NAMESPACE_URI_SVG);
+            xmlWriter->addAttribute("d", path);
+            xmlWriter->closeElement();
+        }
+        pathSize = 0;
+    };
 
-        if (e->getLayer() == layer) {
+    for (auto e: document->getLayerEntities(layer)) {
 
-            if (!(e->getFlag(RS2::FlagUndone))) {
+        if (!(e->getFlag(RS2::FlagUndone))) {
 
+            if (!isPathSegment(e)) {
+                writePath();
                 writeEntity(e);
+                continue;
             }
+
+            if (pathSize == 0 || e->getStartpoint().distanceTo(pathEndpoint) >= RS_TOLERANCE) {
+                writePath();
+                pathStart = e;
+                path = svgPathMoveTo(convertToSvg(e->getStartpoint()));
+            }
+            path += (e->rtti() == RS2::EntityArc) ? svgPathArc(static_cast<RS_Arc*>(e))
+                                                 : svgPathLineTo(convertToSvg(e->getEndpoint()));
+            pathEndpoint = e->getEndpoint();
+            pathSize++;
         }
     }
+    writePath();
+}
+
+bool LC_MakerCamSVG::isPathSegment(RS_Entity* entity) const {
+
+    switch (entity->rtti()) {
+        case RS2::EntityArc:
+            return true;
+        case RS2::EntityLine:
+            // baked line types are written as paths of their own, with their width
+            return !convertLineTypes || entity->getPen().getLineType() == RS2::SolidLine;
+        default:
+            return false;
+    }
 }
 
 void LC_MakerCamSVG::writeEntity(RS_Entity* entity) {
 
     RS_DEBUG->print("RS_MakerCamSVG::writeEntity: Found entity ...");
 
-    switch (entity->rtti()) {
-        case RS2::EntityInsert:
-            writeInsert((RS_Insert*)entity);
-            break;
-        case RS2::EntityPoint:
+    auto notImplemented = [](RS_Entity& e) {
+        RS_DEBUG->print(RS_Debug::D_NOTICE,
+                        "RS_MakerCamSVG::writeEntity: Entity with type '%d' not yet implemented",
+                        (int)e.rtti());
+    };
+
+    LC_EntityVisitor::visit(*entity, LC_Overloaded{
+        [this](RS_Insert& insert) { writeInsert(&insert); },
+        [this](RS_Point& point) {
             if (m_exportPoints) {
-                writePoint((RS_Point*)entity);
+                writePoint(&point);
             }
-            break;
-        case RS2::EntityLine:
-            writeLine((RS_Line*)entity);
-            break;
-        case RS2::EntityPolyline:
-            writePolyline((RS_Polyline*)entity);
-            break;
-        case RS2::EntityCircle:
-            writeCircle((RS_Circle*)entity);
-            break;
-        case RS2::EntityArc:
-            writeArc((RS_Arc*)entity);
-            break;
-        case RS2::EntityEllipse:
-            writeEllipse((RS_Ellipse*)entity);
-            break;
-        case RS2::EntitySpline:
-            writeSpline((RS_Spline*)entity);
-            break;
-        case RS2::EntitySplinePoints:
-            writeSplinepoints((LC_SplinePoints*)entity);
-            break;
-        case RS2::EntityImage:
-            writeImage((RS_Image*)entity);
-            break;
-
-        default:
-            RS_DEBUG->print(RS_Debug::D_NOTICE,
-                            "RS_MakerCamSVG::writeEntity: Entity with type '%d' not yet implemented",
-                            (int)entity->rtti());
-            break;
-    }
+        },
+        [this](RS_Line& line) { writeLine(&line); },
+        [this](RS_Polyline& polyline) { writePolyline(&polyline); },
+        [this](RS_Circle& circle) { writeCircle(&circle); },
+        [this](RS_Arc& arc) { writeArc(&arc); },
+        [this](RS_Ellipse& ellipse) { writeEllipse(&ellipse); },
+        [this](RS_Spline& spline) { writeSpline(&spline); },
+        [this](LC_SplinePoints& splinePoints) { writeSplinepoints(&splinePoints); },
+        [notImplemented](LC_Parabola& parabola) { notImplemented(parabola); },
+        [this](RS_Image& image) { writeImage(&image); },
+        notImplemented
+    });
 }
 
 void LC_MakerCamSVG::writeInsert(RS_Insert* insert) {
@@ -86,6 +86,11 @@ private:
 
     void writeEntities(RS_Document* document, RS_Layer* layer);
     void writeEntity(RS_Entity* entity);
+    /**
+     * @brief isPathSegment - whether the entity may be merged with the connected
+     * entities written before it, into a single path
+     */
+    bool isPathSegment(RS_Entity* entity) const;
 
     void writeInsert(RS_Insert* insert);
     void writePoint(RS_Point* point);
@@ -38,6 +38,12 @@ public:
 
     virtual void closeElement() = 0;
 
+    /**
+     * @brief endDocument - close the open elements. The document is complete
+     * after it, for writers writing to a file as elements are added.
+     */
+    virtual void endDocument() = 0;
+
     virtual std::string documentAsString() = 0;
 
 	LC_XMLWriterInterface() = default;
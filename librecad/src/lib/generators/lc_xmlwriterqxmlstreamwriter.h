@@ -28,11 +28,17 @@
 #include <memory>
 #include "lc_xmlwriterinterface.h"
 
+class QIODevice;
 class QXmlStreamWriter;
 
 class LC_XMLWriterQXmlStreamWriter : public LC_XMLWriterInterface {
 public:
 	LC_XMLWriterQXmlStreamWriter();
+    /**
+     * @brief LC_XMLWriterQXmlStreamWriter - write the document to the device as
+     * it's generated, instead of keeping it in memory for documentAsString()
+     */
+    explicit LC_XMLWriterQXmlStreamWriter(QIODevice* device);
 
     ~LC_XMLWriterQXmlStreamWriter() override;
 
@@ -46,6 +52,8 @@ public:
 
     void closeElement() override;
 
+    void endDocument() override;
+
     std::string documentAsString() override;
 
 private:
@@ -53,6 +61,8 @@ private:
 	std::unique_ptr<QXmlStreamWriter> xmlWriter;
 
     QString xml;
+
+    bool ended = false;
 };
 
 #endif
@@ -0,0 +1,128 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+
+#include "lc_clipping.h"
+
+namespace LC_Clipping
+{
+/**
+ * Liang-Barsky: the line is p1 + t (p2 - p1), the range of t within each pair of
+ * edges is narrowed, until the range [0, 1] is empty.
+ */
+bool clipLine(const QRectF& clip, QPointF& p1, QPointF& p2, double* start)
+{
+    const QPointF d = p2 - p1;
+    if (!std::isfinite(d.x()) || !std::isfinite(d.y()))
+        return false;
+    double t0 = 0.;
+    double t1 = 1.;
+    // the edge at distance q from p1, the line moving towards its outside by p per unit of t
+    auto clipEdge = [&t0, &t1](double p, double q) {
+        if (p == 0.)
+            return q >= 0.;
+        const double t = q / p;
+        if (p < 0.) {
+            if (t > t1)
+                return false;
+            t0 = std::max(t0, t);
+        } else {
+            if (t < t0)
+                return false;
+            t1 = std::min(t1, t);
+        }
+        return true;
+    };
+    if (!clipEdge(-d.x(), p1.x() - clip.left()) || !clipEdge(d.x(), clip.right() - p1.x())
+        || !clipEdge(-d.y(), p1.y() - clip.top()) || !clipEdge(d.y(), clip.bottom() - p1.y()))
+        return false;
+
+    if (t1 < 1.)
+        p2 = p1 + d * t1;
+    if (t0 > 0.)
+        p1 += d * t0;
+    if (start != nullptr)
+        *start = t0 * std::hypot(d.x(), d.y());
+    return true;
+}
+
+std::vector<std::pair<double, double>> clipArc(const QRectF& clip, const QPointF& center, double radius,
+                                               double a1, double a2)
+{
+    std::vector<std::pair<double, double>> parts;
+    if (!(radius > 0.) || !(a2 > a1) || !std::isfinite(center.x()) || !std::isfinite(center.y()))
+        return parts;
+    const QRectF bounds{center.x() - radius, center.y() - radius, 2. * radius, 2. * radius};
+    if (!clip.intersects(bounds))
+        return parts;
+    if (clip.contains(bounds)) {
+        parts.emplace_back(a1, a2);
+        return parts;
+    }
+
+    // the arc is split where the circle crosses the edges, the pieces are inside or outside
+    std::vector<double> angles{a1, a2};
+    auto addCrossing = [&angles, a1, a2](double dx, double dy) {
+        double a = std::fmod(std::atan2(-dy, dx) - a1, 2. * M_PI);
+        if (a < 0.)
+            a += 2. * M_PI;
+        if (a1 + a < a2)
+            angles.push_back(a1 + a);
+    };
+    for (const double x: {clip.left(), clip.right()}) {
+        const double dx = x - center.x();
+        if (std::abs(dx) > radius)
+            continue;
+        // the product is accurate where the edge almost touches the circle
+        const double dy = std::sqrt((radius - dx) * (radius + dx));
+        addCrossing(dx, dy);
+        addCrossing(dx, -dy);
+    }
+    for (const double y: {clip.top(), clip.bottom()}) {
+        const double dy = y - center.y();
+        if (std::abs(dy) > radius)
+            continue;
+        const double dx = std::sqrt((radius - dy) * (radius + dy));
+        addCrossing(dx, dy);
+        addCrossing(-dx, dy);
+    }
+    std::sort(angles.begin(), angles.end());
+
+    for (size_t i = 0; i + 1 < angles.size(); ++i) {
+        const double b1 = angles[i];
+        const double b2 = angles[i + 1];
+        if (!(b2 > b1))
+            continue;
+        const double middle = 0.5 * (b1 + b2);
+        if (!clip.contains(center.x() + radius * std::cos(middle), center.y() - radius * std::sin(middle)))
+            continue;
+        if (!parts.empty() && parts.back().second == b1)
+            parts.back().second = b2;
+        else
+            parts.emplace_back(b1, b2);
+    }
+    return parts;
+}
+}
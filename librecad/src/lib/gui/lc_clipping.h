@@ -0,0 +1,59 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_CLIPPING_H
+#define LC_CLIPPING_H
+
+#include <utility>
+#include <vector>
+
+#include <QPointF>
+#include <QRectF>
+
+/**
+ * Analytic clipping of lines and circular arcs to a rectangle, in painter coordinates.
+ *
+ * At deep zoom, entities map to coordinates far outside the view. Clipped first, only their
+ * visible parts are passed to QPainter, which is slow, and may overflow, with such coordinates.
+ */
+namespace LC_Clipping
+{
+/**
+ * @brief clipLine - clip the line from p1 to p2 to the rectangle, by moving its end points
+ * @param start - if set, the distance p1 moved by, to continue a dash pattern
+ * @return false, if no part of the line is in the rectangle
+ */
+bool clipLine(const QRectF& clip, QPointF& p1, QPointF& p2, double* start = nullptr);
+
+/**
+ * @brief clipArc - the parts of a circular arc within the rectangle
+ * The angles are counterclockwise on the screen, as for QPainterPath::arcTo(), but in radians:
+ * the point at angle a is center + radius * (cos a, -sin a).
+ * @param a1, a2 - the arc from a1 to a2, a1 <= a2 <= a1 + 2 pi
+ * @return the angle ranges of the visible parts, increasing
+ */
+std::vector<std::pair<double, double>> clipArc(const QRectF& clip, const QPointF& center, double radius,
+                                               double a1, double a2);
+}
+
+#endif // LC_CLIPPING_H
@@ -0,0 +1,138 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+
+#include <QPen>
+
+#include "lc_clipping.h"
+#include "lc_dashsegmenter.h"
+
+LC_DashSegmenter::LC_DashSegmenter(const QVector<qreal>& pattern, qreal offset, const QRectF& clip):
+    m_pattern{pattern}
+  , m_clip{clip}
+{
+    m_pattern.resize(m_pattern.size() - m_pattern.size() % 2);
+    for (qreal& length: m_pattern) {
+        length = std::abs(length);
+        m_period += length;
+    }
+    if (!isValid())
+        return;
+
+    m_remaining = m_pattern.front();
+    // negative offsets start before the pattern
+    offset = std::fmod(offset, m_period);
+    advance(offset < 0. ? offset + m_period : offset);
+}
+
+LC_DashSegmenter LC_DashSegmenter::forPen(const QPen& pen, const QRectF& clip)
+{
+    // cosmetic pens are one pixel wide
+    const qreal width = std::max(pen.widthF(), 1.);
+    QVector<qreal> pattern = pen.dashPattern();
+    for (qreal& length: pattern)
+        length *= width;
+    // the dashes are capped by the pen, with half the width at both ends
+    return {pattern, pen.dashOffset() * width, clip.adjusted(-width, -width, width, width)};
+}
+
+bool LC_DashSegmenter::isValid() const
+{
+    return !m_pattern.isEmpty() && m_period > 0. && std::isfinite(m_period);
+}
+
+void LC_DashSegmenter::advance(qreal length)
+{
+    if (length < m_remaining) {
+        m_remaining -= length;
+        return;
+    }
+    length -= m_remaining;
+    m_index = (m_index + 1) % m_pattern.size();
+    // whole periods don't change the pattern position
+    length = std::fmod(length, m_period);
+    while (length >= m_pattern[m_index]) {
+        length -= m_pattern[m_index];
+        m_index = (m_index + 1) % m_pattern.size();
+    }
+    m_remaining = m_pattern[m_index] - length;
+}
+
+QPainterPath LC_DashSegmenter::segment(const QPainterPath& path)
+{
+    if (!isValid())
+        return path;
+
+    QPainterPath dashes;
+    for (const QPolygonF& polygon: path.toSubpathPolygons()) {
+        // whether a dash is open in dashes, continued by the next segment
+        bool inDash = false;
+        for (int i = 1; i < polygon.size(); ++i) {
+            const QPointF& p1 = polygon[i - 1];
+            const QPointF& p2 = polygon[i];
+            const qreal length = std::hypot(p2.x() - p1.x(), p2.y() - p1.y());
+            if (!(length > 0.))
+                continue;
+            // only the part in the clip area is walked dash by dash, the rest moves along the pattern
+            QPointF start = p1;
+            QPointF end = p2;
+            qreal before = 0.;
+            if (!LC_Clipping::clipLine(m_clip, start, end, &before)) {
+                advance(length);
+                inDash = false;
+                continue;
+            }
+            if (before > 0.) {
+                advance(before);
+                inDash = false;
+            }
+
+            const QPointF direction = (p2 - p1) / length;
+            const qreal last = std::min(length, before + std::hypot(end.x() - start.x(), end.y() - start.y()));
+            qreal done = before;
+            while (done < last) {
+                const qreal step = std::min(last - done, m_remaining);
+                if (m_index % 2 == 0) {
+                    if (!inDash)
+                        dashes.moveTo(p1 + direction * done);
+                    dashes.lineTo(p1 + direction * (done + step));
+                    inDash = true;
+                }
+                done += step;
+                m_remaining -= step;
+                if (m_remaining <= 0.) {
+                    m_index = (m_index + 1) % m_pattern.size();
+                    m_remaining = m_pattern[m_index];
+                    inDash = false;
+                }
+            }
+            if (last < length) {
+                advance(length - last);
+                inDash = false;
+            }
+        }
+    }
+    return dashes;
+}
@@ -0,0 +1,72 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_DASHSEGMENTER_H
+#define LC_DASHSEGMENTER_H
+
+#include <QPainterPath>
+#include <QRectF>
+#include <QVector>
+
+class QPen;
+
+/**
+ * @brief The LC_DashSegmenter class, splits paths into the dashes of a dash pattern in one pass.
+ * Paths are flattened into polygons, and the pattern is continued along their cumulative length,
+ * across vertices and, when segmenting several paths, from one path to the next. Dashes are only
+ * emitted within the clip rectangle, the pattern is just advanced along the segments outside it,
+ * and along the parts of the segments clipped off by it.
+ * The dashes are drawn with a solid pen, with the cap and join style of the dashed pen.
+ */
+class LC_DashSegmenter {
+public:
+    /**
+     * @param pattern - alternating dash and gap lengths, starting with a dash
+     * @param offset - the distance into the pattern at which the first path starts
+     * @param clip - the area the dashes are drawn into
+     */
+    LC_DashSegmenter(const QVector<qreal>& pattern, qreal offset, const QRectF& clip);
+
+    /**
+     * @return a segmenter for the dash pattern of a pen, given in units of the pen width
+     */
+    static LC_DashSegmenter forPen(const QPen& pen, const QRectF& clip);
+
+    /** @return false, if the pattern has no length, and paths are drawn as they are */
+    bool isValid() const;
+
+    /** @return the dashes of the path, as open subpaths of line segments */
+    QPainterPath segment(const QPainterPath& path);
+
+private:
+    void advance(qreal length);
+
+    QVector<qreal> m_pattern;
+    qreal m_period = 0.;
+    QRectF m_clip;
+    // the current pattern element, and its length left
+    int m_index = 0;
+    qreal m_remaining = 0.;
+};
+
+#endif // LC_DASHSEGMENTER_H
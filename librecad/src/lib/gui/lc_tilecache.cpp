@@ -0,0 +1,174 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+
+#include <QPainter>
+
+#include "lc_tilecache.h"
+
+namespace {
+// floor division, canvas coordinates can be negative
+int tileIndex(int pixel)
+{
+    return pixel >= 0 ? pixel / LC_TileCache::tileSize
+                      : - ((- pixel - 1) / LC_TileCache::tileSize) - 1;
+}
+
+// whether all pixels of a premultiplied image are fully transparent
+bool isTransparent(const QImage& image)
+{
+    if (image.format() != QImage::Format_ARGB32_Premultiplied)
+        return false;
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* line = reinterpret_cast<const quint32*>(image.constScanLine(y));
+        if (std::any_of(line, line + image.width(), [](quint32 pixel) { return pixel != 0; }))
+            return false;
+    }
+    return true;
+}
+}
+
+bool LC_TileCache::Key::operator == (const Key& other) const
+{
+    return factorX == other.factorX && factorY == other.factorY
+            && panning == other.panning && draftMode == other.draftMode
+            && antialiasing == other.antialiasing && drawingMode == other.drawingMode
+            && printPreview == other.printPreview && paperScale == other.paperScale && lineWidthScaling == other.lineWidthScaling;
+}
+
+void LC_TileCache::setKey(const Key& key)
+{
+    if (key == m_key)
+        return;
+    m_key = key;
+    clear();
+}
+
+void LC_TileCache::clear()
+{
+    m_tiles.clear();
+}
+
+void LC_TileCache::invalidate(const QRect& canvasRect)
+{
+    if (canvasRect.isEmpty())
+        return;
+    const QRect range = tileRange(canvasRect);
+    for (auto it = m_tiles.begin(); it != m_tiles.end(); ) {
+        if (range.contains(it->first.first, it->first.second))
+            it = m_tiles.erase(it);
+        else
+            ++it;
+    }
+}
+
+QRect LC_TileCache::tileRange(const QRect& canvasRect)
+{
+    return QRect{QPoint{tileIndex(canvasRect.left()), tileIndex(canvasRect.top())},
+                 QPoint{tileIndex(canvasRect.right()), tileIndex(canvasRect.bottom())}};
+}
+
+QRect LC_TileCache::canvasRect(const QRect& tileRange)
+{
+    return {tileRange.left() * tileSize, tileRange.top() * tileSize,
+            tileRange.width() * tileSize, tileRange.height() * tileSize};
+}
+
+std::vector<QRect> LC_TileCache::missingBlocks(const QRect& tileRange) const
+{
+    // runs of missing tiles in each row, merged with the identical runs of the previous rows
+    std::vector<QRect> blocks;
+    std::vector<QRect> previousRow;
+    for (int row = tileRange.top(); row <= tileRange.bottom(); ++row) {
+        std::vector<QRect> currentRow;
+        for (int column = tileRange.left(); column <= tileRange.right(); ++column) {
+            if (contains(column, row))
+                continue;
+            const int first = column;
+            while (column < tileRange.right() && !contains(column + 1, row))
+                ++column;
+            QRect run{QPoint{first, row}, QPoint{column, row}};
+            for (const QRect& block: previousRow) {
+                if (block.left() == run.left() && block.right() == run.right()) {
+                    run.setTop(block.top());
+                    break;
+                }
+            }
+            currentRow.push_back(run);
+        }
+        // blocks not continued in this row are complete
+        for (const QRect& block: previousRow) {
+            auto continued = std::find_if(currentRow.cbegin(), currentRow.cend(), [&block](const QRect& run) {
+                return run.top() == block.top() && run.left() == block.left() && run.right() == block.right();
+            });
+            if (continued == currentRow.cend())
+                blocks.push_back(block);
+        }
+        previousRow = std::move(currentRow);
+    }
+    blocks.insert(blocks.end(), previousRow.cbegin(), previousRow.cend());
+    return blocks;
+}
+
+void LC_TileCache::store(const QRect& tileRange, const QImage& block)
+{
+    for (int row = tileRange.top(); row <= tileRange.bottom(); ++row) {
+        for (int column = tileRange.left(); column <= tileRange.right(); ++column) {
+            const QRect source{(column - tileRange.left()) * tileSize, (row - tileRange.top()) * tileSize,
+                               tileSize, tileSize};
+            QImage tile = block.copy(source);
+            // empty tiles are kept as null images, so sparse layers cost little memory
+            m_tiles[{column, row}] = isTransparent(tile) ? QImage{} : std::move(tile);
+        }
+    }
+}
+
+void LC_TileCache::paint(QPainter& painter, const QRect& canvasRect) const
+{
+    const QRect range = tileRange(canvasRect);
+    for (const auto& [index, tile]: m_tiles) {
+        if (tile.isNull() || !range.contains(index.first, index.second))
+            continue;
+        painter.drawImage(index.first * tileSize - canvasRect.left(),
+                          index.second * tileSize - canvasRect.top(), tile);
+    }
+}
+
+void LC_TileCache::prune(const QRect& tileRange)
+{
+    prune(std::vector<QRect>{tileRange});
+}
+
+void LC_TileCache::prune(const std::vector<QRect>& tileRanges)
+{
+    for (auto it = m_tiles.begin(); it != m_tiles.end(); ) {
+        const bool kept = std::any_of(tileRanges.cbegin(), tileRanges.cend(), [&it](const QRect& range) {
+            return range.contains(it->first.first, it->first.second);
+        });
+        if (kept)
+            ++it;
+        else
+            it = m_tiles.erase(it);
+    }
+}
@@ -0,0 +1,142 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_TILECACHE_H
+#define LC_TILECACHE_H
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <QImage>
+#include <QRect>
+
+class QPainter;
+
+/**
+ * @brief The LC_TileCache class, rendered square tiles of the drawing layer of a graphic view.
+ *
+ * Tiles are aligned to the canvas: the drawing in screen pixels at the current zoom factor, with
+ * the origin at the absolute zero. A canvas position doesn't depend on the view offset, so after
+ * a pan, the tiles still in view are reused, and only newly exposed tiles need to be rendered.
+ *
+ * Cached tiles are only valid for the rendering state given by the key. The whole cache is dropped
+ * when the key changes, for example, after zooming.
+ *
+ * Tiles are stored as images rather than pixmaps, so blocks may be rendered by worker threads.
+ * Fully transparent tiles are stored as null images.
+ */
+class LC_TileCache {
+public:
+    // tile width and height, in pixels
+    static constexpr int tileSize = 256;
+
+    // the rendering state tiles depend on
+    struct Key {
+        double factorX = 0.;
+        double factorY = 0.;
+        bool panning = false;
+        bool draftMode = false;
+        bool antialiasing = false;
+        int drawingMode = 0;
+        // line widths of the print preview depend on the paper scale
+        bool printPreview = false;
+        double paperScale = 1.;
+        bool lineWidthScaling = false;
+
+        bool operator == (const Key& other) const;
+        bool operator != (const Key& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * @brief setKey - set the current rendering state, clears the cache if it's different
+     */
+    void setKey(const Key& key);
+    void clear();
+    size_t size() const
+    {
+        return m_tiles.size();
+    }
+
+    /**
+     * @brief invalidate - drop tiles overlapping with an area
+     * @param canvasRect - the area in canvas pixels
+     */
+    void invalidate(const QRect& canvasRect);
+
+    /**
+     * @brief tileRange - tile indices covering an area in canvas pixels
+     */
+    static QRect tileRange(const QRect& canvasRect);
+    /**
+     * @brief canvasRect - the area in canvas pixels covered by a range of tile indices
+     */
+    static QRect canvasRect(const QRect& tileRange);
+
+    /**
+     * @brief missingBlocks - split missing tiles of a range into rectangular blocks of tiles,
+     * so each block can be rendered in one pass
+     * @param tileRange - tile indices
+     * @return ranges of tile indices
+     */
+    std::vector<QRect> missingBlocks(const QRect& tileRange) const;
+
+    /**
+     * @brief store - cache the tiles of a rendered block
+     * @param tileRange - tile indices of the block
+     * @param block - the rendered block, covering canvasRect(tileRange)
+     */
+    void store(const QRect& tileRange, const QImage& block);
+
+    /**
+     * @brief paint - draw cached tiles
+     * @param painter - painter of the target, with its origin at the top-left corner of the area
+     * @param canvasRect - the area in canvas pixels to draw
+     */
+    void paint(QPainter& painter, const QRect& canvasRect) const;
+
+    /**
+     * @brief prune - drop tiles outside of a range of tile indices
+     */
+    void prune(const QRect& tileRange);
+    /**
+     * @brief prune - drop tiles outside of all ranges of tile indices, of the views sharing the cache
+     */
+    void prune(const std::vector<QRect>& tileRanges);
+
+private:
+    bool contains(int column, int row) const
+    {
+        return m_tiles.count({column, row}) == 1;
+    }
+
+    Key m_key;
+    // indexed by (column, row)
+    std::map<std::pair<int, int>, QImage> m_tiles;
+};
+
+#endif // LC_TILECACHE_H
@@ -69,6 +69,8 @@ public:
 	bool requestHatchDialog(RS_Hatch*) override {return false;}
 	void requestOptionsGeneralDialog() override {}
 	void requestOptionsDrawingDialog(RS_Graphic&) override {}
+	void requestMemoryReportDialog(const LC_MemoryReport&) override {}
+	bool requestFindTextDialog(RS_Graphic&, RS_GraphicView&, LC_FindTextData&) override {return false;}
 	bool requestOptionsMakerCamDialog() override {return false;}
 	QString requestFileSaveAsDialog(const QString&, const QString&, const QString&, QString*) override {return {};}
 	void updateCoordinateWidget(const RS_Vector& , const RS_Vector& , bool =false) override {}
@@ -76,6 +78,7 @@ public:
 	void updateSelectionWidget(int, double) override {}
     void updateArcTangentialOptions(double, bool) override{}
 	void commandMessage(const QString&) override {}
+	bool updateImportProgress(const QString&, int) override {return true;}
         void command([[maybe_unused]]const QString& message) override{};
 	void setMouseWidget(QG_MouseWidget*) override {}
 	void setCoordinateWidget(QG_CoordinateWidget* ) override {}
@@ -36,6 +36,7 @@ class QG_CommandWidget;
 class QG_CoordinateWidget;
 class QG_MouseWidget;
 class QG_SelectionWidget;
+class LC_MemoryReport;
 class RS_ActionInterface;
 class RS_Block;
 class RS_BlockList;
@@ -55,6 +56,7 @@ class RS_Solid;
 class RS_Text;
 class RS_Vector;
 
+struct LC_FindTextData;
 struct RS_ArcData;
 struct RS_AttributesData;
 struct RS_BevelData;
@@ -381,6 +383,22 @@ public:
      */
     virtual void requestOptionsDrawingDialog(RS_Graphic& graphic) = 0;
 
+    /**
+     * This virtual method must be overwritten and must present
+     * a dialog showing the memory usage of a drawing.
+     */
+    virtual void requestMemoryReportDialog(const LC_MemoryReport& report) = 0;
+
+    /**
+     * This virtual method must be overwritten and must present
+     * a dialog to find texts in a drawing and zoom to them.
+     *
+     * @param data the text to find, set to the text and its replacement
+     * @return true, if the user chose to replace the text found.
+     */
+    virtual bool requestFindTextDialog(RS_Graphic& graphic, RS_GraphicView& view,
+                                       LC_FindTextData& data) = 0;
+
     /**
      * This virtual method must be overwritten and must present
      * a dialog for options how to export as MakeCAM SVG.
@@ -446,6 +464,17 @@ public:
     virtual void commandMessage(const QString& message) = 0;
     virtual void command(const QString& message) = 0;
 
+    /**
+     * This virtual method must be overwritten and should show the
+     * progress of reading a file, while the partially read drawing
+     * is displayed.
+     *
+     * @param fileName The file being read.
+     * @param percent Progress from 0 to 99, 100 ends the progress display.
+     * @return false, if the user canceled reading.
+     */
+    virtual bool updateImportProgress(const QString& fileName, int percent) = 0;
+
 	virtual void setMouseWidget(QG_MouseWidget*) = 0;
 	virtual void setCoordinateWidget(QG_CoordinateWidget* ) = 0;
 	virtual void setSelectionWidget(QG_SelectionWidget* ) = 0;
@@ -28,6 +28,7 @@
 #include <QAction>
 #include <QMouseEvent>
 #include "rs_eventhandler.h"
+#include "lc_actionprofiler.h"
 #include "rs_actioninterface.h"
 #include "rs_dialogfactory.h"
 #include "rs_commandevent.h"
@@ -100,13 +101,13 @@ RS_EventHandler::RS_EventHandler(QObject* parent) : QObject(parent)
  * Destructor.
  */
 RS_EventHandler::~RS_EventHandler() {
-    RS_DEBUG->print("RS_EventHandler::~RS_EventHandler");
+    LC_DEBUG_TRACE("RS_EventHandler::~RS_EventHandler");
     defaultAction.reset();
 
-    RS_DEBUG->print("RS_EventHandler::~RS_EventHandler: Deleting all actions..");
+    LC_DEBUG_TRACE("RS_EventHandler::~RS_EventHandler: Deleting all actions..");
     currentActions.clear();
-    RS_DEBUG->print("RS_EventHandler::~RS_EventHandler: Deleting all actions..: OK");
-    RS_DEBUG->print("RS_EventHandler::~RS_EventHandler: OK");
+    LC_DEBUG_TRACE("RS_EventHandler::~RS_EventHandler: Deleting all actions..: OK");
+    LC_DEBUG_TRACE("RS_EventHandler::~RS_EventHandler: OK");
 }
 
 
@@ -147,7 +148,7 @@ void RS_EventHandler::mousePressEvent(QMouseEvent* e) {
             defaultAction->mousePressEvent(e);
             e->accept();
         } else {
-            RS_DEBUG->print("currently no action defined");
+            LC_DEBUG_TRACE("currently no action defined");
             e->ignore();
         }
     }
@@ -162,7 +163,7 @@ void RS_EventHandler::mouseReleaseEvent(QMouseEvent* e) {
     if(hasAction()){
         //    if (actionIndex>=0 && currentActions[actionIndex] &&
         //            !currentActions[actionIndex]->isFinished()) {
-        RS_DEBUG->print("call action %s",
+        LC_DEBUG_TRACE("call action %s",
                         currentActions.last()->getName().toLatin1().data());
 
         currentActions.last()->mouseReleaseEvent(e);
@@ -193,11 +194,13 @@ void RS_EventHandler::mouseReleaseEvent(QMouseEvent* e) {
  */
 void RS_EventHandler::mouseMoveEvent(QMouseEvent* e)
 {
-    if(hasAction())
-        currentActions.last()->mouseMoveEvent(e);
-
-    else if (defaultAction)
-        defaultAction->mouseMoveEvent(e);
+    RS_ActionInterface* action = hasAction() ? currentActions.last() : defaultAction;
+    if (action == nullptr)
+        return;
+    if (LC_ActionProfiler::isEnabled())
+        LC_ActionProfiler::setAction(action->getName());
+    LC_ActionProfileScope profileScope{LC_ActionProfiler::MouseMove};
+    action->mouseMoveEvent(e);
 }
 
 /**
@@ -279,7 +282,7 @@ void RS_EventHandler::keyReleaseEvent(QKeyEvent* e) {
  * Handles command line events.
  */
 void RS_EventHandler::commandEvent(RS_CommandEvent* e) {
-    RS_DEBUG->print("RS_EventHandler::commandEvent");
+    LC_DEBUG_TRACE("RS_EventHandler::commandEvent");
     QString cmd = e->getCommand();
 
     if (coordinateInputEnabled) {
@@ -309,18 +312,18 @@ void RS_EventHandler::commandEvent(RS_CommandEvent* e) {
                 // handle absolute cartesian coordinate input:
                 if (!e->isAccepted() && cmd.contains(',') && cmd.at(0)!='@') {
                     int commaPos = cmd.indexOf(',');
-                    RS_DEBUG->print("RS_EventHandler::commandEvent: 001");
+                    LC_DEBUG_TRACE("RS_EventHandler::commandEvent: 001");
                     bool ok1, ok2;
-                    RS_DEBUG->print("RS_EventHandler::commandEvent: 002");
+                    LC_DEBUG_TRACE("RS_EventHandler::commandEvent: 002");
                     double x = RS_Math::eval(updateForFraction(cmd.left(commaPos)), &ok1);
-                    RS_DEBUG->print("RS_EventHandler::commandEvent: 003a");
+                    LC_DEBUG_TRACE("RS_EventHandler::commandEvent: 003a");
                     double y = RS_Math::eval(updateForFraction(cmd.mid(commaPos+1)), &ok2);
-                    RS_DEBUG->print("RS_EventHandler::commandEvent: 004");
+                    LC_DEBUG_TRACE("RS_EventHandler::commandEvent: 004");
 
                     if (ok1 && ok2) {
-                        RS_DEBUG->print("RS_EventHandler::commandEvent: 005");
+                        LC_DEBUG_TRACE("RS_EventHandler::commandEvent: 005");
                         RS_CoordinateEvent ce(RS_Vector(x,y));
-                        RS_DEBUG->print("RS_EventHandler::commandEvent: 006");
+                        LC_DEBUG_TRACE("RS_EventHandler::commandEvent: 006");
 						currentActions.last()->coordinateEvent(&ce);
 					} else
 						RS_DIALOGFACTORY->commandMessage(
@@ -403,7 +406,7 @@ void RS_EventHandler::commandEvent(RS_CommandEvent* e) {
         }
     }
 
-    RS_DEBUG->print("RS_EventHandler::commandEvent: OK");
+    LC_DEBUG_TRACE("RS_EventHandler::commandEvent: OK");
 }
 
 
@@ -467,12 +470,12 @@ void RS_EventHandler::setDefaultAction(RS_ActionInterface* action) {
  * Sets the current action.
  */
 void RS_EventHandler::setCurrentAction(RS_ActionInterface* action) {
-    RS_DEBUG->print("RS_EventHandler::setCurrentAction");
+    LC_DEBUG_TRACE("RS_EventHandler::setCurrentAction");
     if (action==nullptr) {
         return;
     }
 
-    RS_DEBUG->print("RS_EventHandler::setCurrentAction %s", action->getName().toLatin1().data());
+    LC_DEBUG_TRACE("RS_EventHandler::setCurrentAction %s", action->getName().toLatin1().data());
     // Predecessor of the new action or NULL:
     auto& predecessor = hasAction() ? currentActions.last() : defaultAction;
     // Suspend current action:
@@ -502,22 +505,22 @@ void RS_EventHandler::setCurrentAction(RS_ActionInterface* action) {
     //                    currentActions.last()->getName().toLatin1().data());
 
     // Initialisation of our new action:
-    RS_DEBUG->print("RS_EventHandler::setCurrentAction: init current action");
+    LC_DEBUG_TRACE("RS_EventHandler::setCurrentAction: init current action");
     action->init();
     // ## new:
     if (!action->isFinished()) {
-        RS_DEBUG->print("RS_EventHandler::setCurrentAction: show options");
+        LC_DEBUG_TRACE("RS_EventHandler::setCurrentAction: show options");
         action->showOptions();
-        RS_DEBUG->print("RS_EventHandler::setCurrentAction: set predecessor");
+        LC_DEBUG_TRACE("RS_EventHandler::setCurrentAction: set predecessor");
         action->setPredecessor(predecessor.get());
     }
 
-    RS_DEBUG->print("RS_EventHandler::setCurrentAction: cleaning up..");
+    LC_DEBUG_TRACE("RS_EventHandler::setCurrentAction: cleaning up..");
     cleanUp();
 
-    RS_DEBUG->print("RS_EventHandler::setCurrentAction: debugging actions");
+    LC_DEBUG_TRACE("RS_EventHandler::setCurrentAction: debugging actions");
     debugActions();
-    RS_DEBUG->print("RS_GraphicView::setCurrentAction: OK");
+    LC_DEBUG_TRACE("RS_GraphicView::setCurrentAction: OK");
     // For some actions: action->init() may call finish() within init()
     // If so, the q_action shouldn't be checked
     if (q_action){
@@ -557,7 +560,7 @@ void RS_EventHandler::killSelectActions() {
  */
 void RS_EventHandler::killAllActions()
 {
-	RS_DEBUG->print(__FILE__ ": %s: line %d: begin\n", __func__, __LINE__);
+	LC_DEBUG_TRACE(__FILE__ ": %s: line %d: begin\n", __func__, __LINE__);
 
     if (q_action)
     {
@@ -579,7 +582,7 @@ void RS_EventHandler::killAllActions()
         defaultAction->finish();
     }
 
-	RS_DEBUG->print(__FILE__ ": %s: line %d: begin\n", __func__, __LINE__);
+	LC_DEBUG_TRACE(__FILE__ ": %s: line %d: begin\n", __func__, __LINE__);
 	defaultAction->init(0);
 }
 
@@ -608,7 +611,7 @@ bool RS_EventHandler::hasAction()
  * Garbage collector for actions.
  */
 void RS_EventHandler::cleanUp() {
-    RS_DEBUG->print("RS_EventHandler::cleanUp");
+    LC_DEBUG_TRACE("RS_EventHandler::cleanUp");
 
     for (auto it=currentActions.begin(); it != currentActions.end();)
     {
@@ -628,7 +631,7 @@ void RS_EventHandler::cleanUp() {
             defaultAction->showOptions();
         }
     }
-    RS_DEBUG->print("RS_EventHandler::cleanUp: OK");
+    LC_DEBUG_TRACE("RS_EventHandler::cleanUp: OK");
 }
 
 
@@ -667,13 +670,13 @@ void RS_EventHandler::setSnapRestriction(RS2::SnapRestriction sr) {
 
 void RS_EventHandler::debugActions() const{
     //        std::cout<<"action queue size=:"<<currentActions.size()<<std::endl;
-    RS_DEBUG->print("---");
+    LC_DEBUG_TRACE("---");
     for(int i=0;i<currentActions.size();++i){
 
         if (i == currentActions.size() - 1 ) {
-            RS_DEBUG->print("Current");
+            LC_DEBUG_TRACE("Current");
         }
-        RS_DEBUG->print("Action %03d: %s [%s]",
+        LC_DEBUG_TRACE("Action %03d: %s [%s]",
                         i, currentActions.at(i)->getName().toLatin1().data(),
                         currentActions.at(i)->isFinished() ? "finished" : "active");
     }
@@ -34,6 +34,10 @@
 #include <QtAlgorithms>
 #include "rs_graphicview.h"
 
+#include "lc_snappointcache.h"
+#include "lc_spatialindex.h"
+#include "lc_tracing.h"
+
 #include "rs_color.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
@@ -43,15 +47,24 @@
 #include "rs_line.h"
 #include "rs_linetypepattern.h"
 #include "rs_math.h"
+#include "rs_mtext.h"
 #include "rs_painter.h"
 #include "rs_snapper.h"
 #include "rs_settings.h"
+#include "rs_text.h"
 #include "rs_units.h"
 
 #ifdef EMU_C99
 #include "emu_c99.h"
 #endif
 
+namespace {
+// in pixels, entities of a smaller extent are drawn as a point or a short line
+constexpr double minDetailSize = 2.;
+// in pixels, text of a smaller height is drawn as its bounding box
+constexpr double minTextHeight = 3.;
+}
+
 struct RS_GraphicView::ColorData {
     /** background color (any color) */
     RS_Color background;
@@ -87,6 +100,7 @@ RS_GraphicView::RS_GraphicView(QWidget* parent, Qt::WindowFlags f)
 	,eventHandler{new RS_EventHandler{this}}
     , m_colorData{std::make_unique<ColorData>()}
     ,grid{std::make_unique<RS_Grid>(this)}
+    ,snapPointCache{std::make_unique<LC_SnapPointCache>()}
     ,defaultSnapMode{std::make_unique<RS_SnapMode>()}
 	,drawingMode(RS2::ModeFull)
 	,savedViews(16)
@@ -625,7 +639,8 @@ void RS_GraphicView::restoreView() {
 	adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	// the drawing tiles are kept if the zoom factor didn't change, e.g. for another number of pages
+	redraw(RS2::RedrawPan);
 }
 
 
@@ -797,7 +812,7 @@ void RS_GraphicView::zoomPan(int dx, int dy) {
 	//adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawPan);
 }
 
 
@@ -824,7 +839,7 @@ void RS_GraphicView::zoomScroll(RS2::Direction direction) {
 	adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawPan);
 }
 
 
@@ -907,6 +922,7 @@ void RS_GraphicView::drawWindow_DEPRECATED(RS_Vector v1, RS_Vector v2) {
  *
  */
 void RS_GraphicView::drawLayer1(RS_Painter *painter) {
+    LC_TRACE_SCOPE("RS_GraphicView::drawLayer1");
 
 	// drawing paper border:
 	if (isPrintPreview()) {
@@ -958,16 +974,20 @@ void RS_GraphicView::drawLayer1(RS_Painter *painter) {
 
 void RS_GraphicView::drawLayer2(RS_Painter *painter)
 {
+    LC_TRACE_SCOPE("RS_GraphicView::drawLayer2");
+	painter->beginBatch();
 	drawEntity(painter, container);	//	Draw all entities.
+	painter->endBatch();
 
 	//	If not in print preview, draw the absolute zero reference.
 	//	----------------------------------------------------------
-	if (!isPrintPreview())
+	if (!isPrintPreview() && !layerPass)
 		drawAbsoluteZero(painter);
 }
 
 
 void RS_GraphicView::drawLayer3(RS_Painter *painter) {
+    LC_TRACE_SCOPE("RS_GraphicView::drawLayer3");
 	// drawing zero points:
 	if (!isPrintPreview()) {
 		drawRelativeZero(painter);
@@ -996,15 +1016,22 @@ void RS_GraphicView::drawLayer3(RS_Painter *painter) {
  */
 
 void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& patternOffset)
+{
+	// Getting pen from entity (or layer)
+	setPenForEntity(painter, e, e->getPen(true), patternOffset);
+}
+
+/**
+ * Sets the painter pen from a resolved pen, with the selection and
+ * highlighting state of the given entity
+ */
+void RS_GraphicView::setPenForEntity(RS_Painter *painter, RS_Entity *e, RS_Pen pen, double& patternOffset)
 {
 	if (draftMode) {
         painter->setPen(RS_Pen(m_colorData->foreground,
 							   RS2::Width00, RS2::SolidLine));
 	}
 
-	// Getting pen from entity (or layer)
-	RS_Pen pen = e->getPen(true);
-
     // Avoid negative widths
     int w = std::max(static_cast<int>(pen.getWidth()), 0);
 
@@ -1063,7 +1090,8 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& p
 
     pen.setDashOffset(patternOffset);
 
-    if (!isPrinting() && !isPrintPreview())
+    // deleting draws the plain entity in the background color
+    if (!isPrinting() && !isPrintPreview() && !painter->shouldIgnoreSelection() && !getDeleteMode())
     {
         // this entity is selected:
         if (e->isSelected()) {
@@ -1075,7 +1103,7 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& p
         // this entity is highlighted:
         if (e->isHighlighted()) {
             // Glowing effects on mouse hovering: use the "selected" color
-            if (e->getParent() == overlayEntities[RS2::OverlayEffects])
+            if (e->getParent() == overlayEntities.value(RS2::OverlayEffects))
             {
                 // for glowing effects on mouse hovering, draw solid lines
                 pen.setColor(m_colorData->selectedColor);
@@ -1096,30 +1124,31 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e, double& p
 
 
 /**
- * Draws an entity. Might be recursively called e.g. for polylines.
- * If the class wide painter is nullptr a new painter will be created
- * and destroyed afterwards.
- *
- * @param patternOffset Offset of line pattern (used for connected
- *        lines e.g. in splines).
- * @param db Double buffering on (recommended) / off
- */
-void RS_GraphicView::drawEntity(RS_Entity* /*e*/, double& /*patternOffset*/) {
-	RS_DEBUG->print("RS_GraphicView::drawEntity(RS_Entity*,patternOffset) not supported anymore");
-	// RVT_PORT this needs to be optimized
-	// One way to do is to send a RS2::RedrawSelected, then the draw routine will only draw all selected entities
-	// Dis-advantage is that we still need to iterate over all entities, but
-	// this might be very fast
-	// For now we just redraw the drawing until we are going to optimize drawing
-	redraw(RS2::RedrawDrawing);
+ * Redraws an entity, by redrawing the area covered by the entity.
+ * The drawing is updated in the next paint event.
+ */
+void RS_GraphicView::drawEntity(RS_Entity* e, double& /*patternOffset*/) {
+	drawEntity(e);
 }
-void RS_GraphicView::drawEntity(RS_Entity* /*e*/ /*patternOffset*/) {
-	RS_DEBUG->print("RS_GraphicView::drawEntity(RS_Entity*,patternOffset) not supported anymore");
-	// RVT_PORT this needs to be optimized
-	// One way to do is to send a RS2::RedrawSelected, then the draw routine will only draw all selected entities
-	// Dis-advantage is that we still need to iterate over all entities, but
-	// this might be very fast
-	// For now we just redraw the drawing until we are going to optimize drawing
+void RS_GraphicView::drawEntity(RS_Entity* e) {
+	// entities without valid borders may be anywhere on the screen
+	if (e == nullptr || !LC_SpatialIndex::hasValidBox(*e)) {
+		redraw(RS2::RedrawDrawing);
+		return;
+	}
+	// reference point handles may lie outside of the borders, e.g. arc centers
+	LC_Rect area{e->getMin(), e->getMax()};
+	for (const RS_Vector& vp: e->getRefPoints())
+		if (vp.valid)
+			area = area.merge(vp);
+	redrawArea(area);
+}
+
+/**
+ * Requests to redraw an area of the drawing, e.g. after an entity in the
+ * area changed. This implementation redraws the whole drawing.
+ */
+void RS_GraphicView::redrawArea(const LC_Rect& /*area*/) {
 	redraw(RS2::RedrawDrawing);
 }
 void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e) {
@@ -1133,11 +1162,16 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 	if (!e) {
 		return;
 	}
+	++renderStats.visited;
 
 	// entity is not visible:
 	if (!e->isVisible()) {
 		return;
 	}
+	// drawn by the pass of another layer
+	if (layerPass && e->getParent() == container && e->getLayer() != passLayer) {
+		return;
+	}
 	if( isPrintPreview() || isPrinting() ) {
 		// do not draw construction layer on print preview or print
 		if( ! e->isPrint()
@@ -1145,20 +1179,44 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
         return;
 	}
 
-    // test if the entity is in the viewport
-    if (!isPrinting() &&
-        e->rtti() != RS2::EntityGraphic &&
-        e->rtti() != RS2::EntityLine &&
-       (toGuiX(e->getMax().x)<0 || toGuiX(e->getMin().x)>getWidth() ||
-        toGuiY(e->getMin().y)<0 || toGuiY(e->getMax().y)>getHeight())) {
+    // test if the entity is in the viewport, or on the printed page
+    // construction lines are infinite, their borders are only the defining points
+    if (e->rtti() != RS2::EntityGraphic &&
+        e->rtti() != RS2::EntityConstructionLine &&
+       (toGuiX(e->getMax().x) < -viewportMargin || toGuiX(e->getMin().x) > getWidth() + viewportMargin ||
+        toGuiY(e->getMin().y) < -viewportMargin || toGuiY(e->getMax().y) > getHeight() + viewportMargin)) {
+        ++renderStats.culled;
         return;
     }
 
+	// not drawn by this pass: no need to set up the pen
+	if (!e->isContainer() && !isDrawnBy(painter, e)) {
+		return;
+	}
+
 	// set pen (color):
     setPenForEntity(painter, e, patternOffset);
 
+    ++renderStats.drawn;
+    switch (e->rtti()) {
+    case RS2::EntityMText:
+    case RS2::EntityText:
+        ++renderStats.texts;
+        break;
+    case RS2::EntityHatch:
+        ++renderStats.hatches;
+        break;
+    case RS2::EntityInsert:
+        ++renderStats.inserts;
+        break;
+    default:
+        break;
+    }
+
 	//RS_DEBUG->print("draw plain");
-	if (isDraftMode()) {
+	if (drawEntityLowDetail(painter, e)) {
+		// drawn simplified
+	} else if (isDraftMode()) {
         switch(e->rtti()){
         case RS2::EntityMText:
         case RS2::EntityText:
@@ -1179,7 +1237,7 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 	}
 
 	// draw reference points:
-	if (e->isSelected() && !(isPrinting() || isPrintPreview())) {
+	if (e->isSelected() && !painter->shouldIgnoreSelection() && !(isPrinting() || isPrintPreview())) {
 		if (!e->isParentSelected()) {
 			RS_VectorSolutions const& s = e->getRefPoints();
 
@@ -1208,6 +1266,51 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 }
 
 
+bool RS_GraphicView::isDrawnBy(RS_Painter *painter, const RS_Entity* e) const {
+	if (painter->shouldIgnoreSelection())
+		return true;
+	return (e->isSelected() || e->isHighlighted()) == painter->shouldDrawSelected();
+}
+
+bool RS_GraphicView::drawEntityLowDetail(RS_Painter *painter, RS_Entity* e) {
+	if (isPrinting() || !isDrawnBy(painter, e))
+		return false;
+
+	switch (e->rtti()) {
+	// cheap to draw, or of no meaningful extent
+	case RS2::EntityGraphic:
+	case RS2::EntityConstructionLine:
+	case RS2::EntityLine:
+	case RS2::EntityPoint:
+		return false;
+	case RS2::EntityText:
+	case RS2::EntityMText: {
+		const double height = e->rtti() == RS2::EntityText
+				? static_cast<RS_Text*>(e)->getHeight()
+				: static_cast<RS_MText*>(e)->getHeight();
+		if (toGuiDY(height) >= minTextHeight || !LC_SpatialIndex::hasValidBox(*e))
+			return false;
+		painter->drawRect(toGui(e->getMin()), toGui(e->getMax()));
+		return true;
+	}
+	default:
+		break;
+	}
+
+	if (!LC_SpatialIndex::hasValidBox(*e))
+		return false;
+	const RS_Vector vpMin = toGui(e->getMin());
+	const RS_Vector vpMax = toGui(e->getMax());
+	if (std::abs(vpMax.x - vpMin.x) >= minDetailSize || std::abs(vpMax.y - vpMin.y) >= minDetailSize)
+		return false;
+	// a zero length line may not be painted
+	if (vpMin.distanceTo(vpMax) < 1.)
+		painter->drawLine(vpMin, vpMin + RS_Vector{1., 0.});
+	else
+		painter->drawLine(vpMin, vpMax);
+	return true;
+}
+
 /**
  * Draws an entity.
  * The painter must be initialized and all the attributes (pen) must be set.
@@ -1217,7 +1320,7 @@ void RS_GraphicView::drawEntityPlain(RS_Painter *painter, RS_Entity* e, double&
 		return;
 	}
 
-	if (!e->isContainer() && (e->isSelected()!=painter->shouldDrawSelected())) {
+	if (!e->isContainer() && !isDrawnBy(painter, e)) {
 		return;
 	}
 
@@ -1229,7 +1332,7 @@ void RS_GraphicView::drawEntityPlain(RS_Painter *painter, RS_Entity* e) {
 		return;
 	}
 
-	if (!e->isContainer() && (e->isSelected()!=painter->shouldDrawSelected())) {
+	if (!e->isContainer() && !isDrawnBy(painter, e)) {
 		return;
 	}
 	double patternOffset(0.);
@@ -1243,22 +1346,16 @@ void RS_GraphicView::drawEntityHighlighted(RS_Entity* e, bool highlighted)
     if (e->isHighlighted() != highlighted)
     {
         e->setHighlighted(highlighted);
-        drawEntity(e);
+        redraw(RS2::RedrawSelection);
     }
 }
 
 /**
- * Deletes an entity with the background color.
- * Might be recursively called e.g. for polylines.
+ * Removes an entity from the screen, by redrawing the area covered by the entity.
  */
 void RS_GraphicView::deleteEntity(RS_Entity* e) {
-
-	// RVT_PORT When we delete a single entity, we can do this but we need to remove this then also from containerEntities
-	RS_DEBUG->print("RS_GraphicView::deleteEntity will for now redraw the whole screen instead of just deleting the entity");
-	setDeleteMode(true);
+	// the area is redrawn when painting, after the entity is removed or changed
 	drawEntity(e);
-	setDeleteMode(false);
-	redraw(RS2::RedrawDrawing);
 }
 
 
@@ -1444,9 +1541,12 @@ void RS_GraphicView::drawGrid(RS_Painter *painter) {
 
 	//grid->updatePointArray();
 	auto const& pts = grid->getPoints();
+	std::vector<RS_Vector> guiPoints;
+	guiPoints.reserve(pts.size());
 	for(auto const& v: pts){
-		painter->drawGridPoint(toGui(v));
+		guiPoints.push_back(toGui(v));
 	}
+	painter->drawGridPoints(guiPoints);
 
 	// draw grid info:
 	//painter->setPen(Qt::white);
@@ -1746,6 +1846,10 @@ RS_Grid* RS_GraphicView::getGrid() const{
 	return grid.get();
 }
 
+LC_SnapPointCache& RS_GraphicView::getSnapPointCache() const{
+    return *snapPointCache;
+}
+
 RS_EventHandler* RS_GraphicView::getEventHandler() const{
     return eventHandler;
 }
@@ -1930,6 +2034,37 @@ void RS_GraphicView::setPanning(bool state) {
     panning = state;
 }
 
+void RS_GraphicView::setDrawingState(const RS_GraphicView& view) {
+    container = view.container;
+    *m_colorData = *view.m_colorData;
+    drawingMode = view.drawingMode;
+    deleteMode = view.deleteMode;
+    draftMode = view.draftMode;
+    factor = view.factor;
+    offsetX = view.offsetX;
+    offsetY = view.offsetY;
+    printPreview = view.printPreview;
+    printing = view.printing;
+    panning = view.panning;
+    scaleLineWidth = view.scaleLineWidth;
+}
+
+void RS_GraphicView::setLayerPass(bool enable, const RS_Layer* layer) {
+    layerPass = enable;
+    passLayer = enable ? layer : nullptr;
+}
+
+RS_GraphicView::RenderStats& RS_GraphicView::RenderStats::operator += (const RenderStats& other) {
+    visited += other.visited;
+    culled += other.culled;
+    drawn += other.drawn;
+    texts += other.texts;
+    hatches += other.hatches;
+    inserts += other.inserts;
+    primitives += other.primitives;
+    return *this;
+}
+
 
 
 /* Sets the color for the relative-zero marker. */
@@ -42,6 +42,7 @@ class QDateTime;
 class QMouseEvent;
 class QKeyEvent;
 
+class LC_SnapPointCache;
 class RS_ActionInterface;
 class RS_Entity;
 class RS_EntityContainer;
@@ -50,7 +51,9 @@ class RS_Color;
 class RS_CommandEvent;
 class RS_Graphic;
 class RS_Grid;
+class RS_Layer;
 class RS_Painter;
+class RS_Pen;
 
 struct RS_LineTypePattern;
 struct RS_SnapMode;
@@ -72,6 +75,9 @@ public:
     RS_GraphicView(QWidget * parent = nullptr, Qt::WindowFlags f = {});
 	virtual ~RS_GraphicView();
 
+    // in pixels, entities this close to the viewport are still drawn
+    static constexpr int viewportMargin = 8;
+
     void cleanUp();
 
 	/**
@@ -266,9 +272,23 @@ public:
 	virtual void drawEntity(RS_Painter *painter, RS_Entity* e);
 	virtual void drawEntity(RS_Entity* e, double& patternOffset);
 	virtual void drawEntity(RS_Entity* e);
+	virtual void redrawArea(const LC_Rect& area);
 	virtual void drawEntityPlain(RS_Painter *painter, RS_Entity* e);
 	virtual void drawEntityPlain(RS_Painter *painter, RS_Entity* e, double& patternOffset);
+	/**
+	 * @brief drawEntityLowDetail - level of detail: draws an entity too small on screen to
+	 * show its shape as a point or a short line, and small text as its bounding box
+	 * @return true, if the entity has been drawn
+	 */
+	bool drawEntityLowDetail(RS_Painter *painter, RS_Entity* e);
+	/**
+	 * @brief isDrawnBy - whether an entity belongs to the current pass of a painter:
+	 * unselected entities are drawn first, selected and highlighted entities on top
+	 * of them, see RS_Painter::setDrawSelectedOnly() and RS_Painter::setIgnoreSelection()
+	 */
+	bool isDrawnBy(RS_Painter *painter, const RS_Entity* e) const;
     virtual void setPenForEntity(RS_Painter *painter, RS_Entity* e, double& patternOffset);
+    void setPenForEntity(RS_Painter *painter, RS_Entity* e, RS_Pen pen, double& patternOffset);
     virtual void drawEntityHighlighted(RS_Entity* e, bool highlighted = true);
     virtual RS_Vector getMousePosition() const = 0;
 
@@ -287,6 +307,8 @@ public:
     virtual void drawDraftSign(RS_Painter *painter);
 
 	RS_Grid* getGrid() const;
+    /** The snap points around the visible area, shared by the snappers of this view */
+    LC_SnapPointCache& getSnapPointCache() const;
     virtual void updateGridStatusWidget(QString) = 0;
 
 	void setDefaultSnapMode(RS_SnapMode sm);
@@ -388,6 +410,44 @@ public:
 
     void setTypeToSelect(RS2::EntityType mType);
 
+    /**
+     * @brief setDrawingState - copy the state used to draw entities from another view: the container,
+     * the zoom factor and offset, colors and drawing modes. The view size and view rect are not copied.
+     */
+    void setDrawingState(const RS_GraphicView& view);
+
+    /**
+     * @brief setLayerPass - restrict drawing of the top level entities of the container to those on
+     * a layer, to render the drawing of each layer separately. The absolute zero is not drawn by a
+     * layer pass.
+     * @param enable - whether entities are restricted to a layer
+     * @param layer - the layer to draw, nullptr for the entities without a layer
+     */
+    void setLayerPass(bool enable, const RS_Layer* layer = nullptr);
+
+    /**
+     * Counters of drawEntity(), for the render statistics overlay: the entities
+     * visited, those culled by the viewport test and those drawn, by type.
+     */
+    struct RenderStats {
+        unsigned long visited = 0;
+        unsigned long culled = 0;
+        unsigned long drawn = 0;
+        unsigned long texts = 0;
+        unsigned long hatches = 0;
+        unsigned long inserts = 0;
+        // primitives submitted to the painters, see RS_Painter::getPrimitiveCount()
+        unsigned long primitives = 0;
+
+        RenderStats& operator += (const RenderStats& other);
+    };
+    RenderStats& getRenderStats() {
+        return renderStats;
+    }
+    void resetRenderStats() {
+        renderStats = {};
+    }
+
 protected:
 
     RS_EntityContainer* container = nullptr; // Holds a pointer to all the enties
@@ -398,6 +458,8 @@ protected:
     std::unique_ptr<ColorData> m_colorData;
 	/** Grid */
 	std::unique_ptr<RS_Grid> grid;
+    /** Snap points of the visible area, dropped with each redraw of the drawing */
+    std::unique_ptr<LC_SnapPointCache> snapPointCache;
 	/**
 		 * Current default snap mode for this graphic view. Used for new
 		 * actions.
@@ -455,6 +517,13 @@ private:
 
     bool scaleLineWidth = false;
 
+    // see setLayerPass()
+    bool layerPass = false;
+    const RS_Layer* passLayer = nullptr;
+
+    // see getRenderStats(), kept per view as each rendering thread has its own view
+    RenderStats renderStats;
+
     RS2::EntityType typeToSelect = RS2::EntityType::EntityUnknown;
 
 signals:
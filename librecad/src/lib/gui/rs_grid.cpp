@@ -50,7 +50,29 @@ const double minimumGridWidth=1.0e-8;
 RS_Grid::RS_Grid(RS_GraphicView* graphicView)
     :graphicView(graphicView)
     ,baseGrid(false)
-{}
+{
+	loadSettings();
+}
+
+void RS_Grid::loadSettings() {
+	RS_SETTINGS->beginGroup("/Appearance");
+	settings.scaleGrid = (bool)RS_SETTINGS->readNumEntry("/ScaleGrid", 1);
+	settings.isometric = (bool)RS_SETTINGS->readNumEntry("/IsometricGrid", 0);
+	settings.crosshairType=static_cast<RS2::CrosshairType>(RS_SETTINGS->readNumEntry("/CrosshairType",0));
+	settings.userGrid.x = RS_SETTINGS->readEntry("/GridSpacingX",QString("-1")).toDouble();
+	settings.userGrid.y = RS_SETTINGS->readEntry("/GridSpacingY",QString("-1")).toDouble();
+	settings.minGridSpacing = RS_SETTINGS->readNumEntry("/MinGridSpacing", 10);
+	RS_SETTINGS->endGroup();
+	settingsRevision = RS_SETTINGS->revision();
+	pointsValid = false;
+}
+
+bool RS_Grid::PointKey::operator == (const PointKey& other) const {
+	return left == other.left && bottom == other.bottom
+			&& right == other.right && top == other.top
+			&& gridWidth.x == other.gridWidth.x && gridWidth.y == other.gridWidth.y
+			&& isometric == other.isometric;
+}
 
 /**
  * find the closest grid point
@@ -77,12 +99,13 @@ RS_Vector RS_Grid::snapGrid(const RS_Vector& coord) const {
  */
 void RS_Grid::updatePointArray() {
 	if (!graphicView->isGridOn()) return;
+	if (settingsRevision != RS_SETTINGS->revision())
+		loadSettings();
 
 	RS_Graphic* graphic = graphicView->getGraphic();
 
 	// auto scale grid?
-	RS_SETTINGS->beginGroup("/Appearance");
-	bool scaleGrid = (bool)RS_SETTINGS->readNumEntry("/ScaleGrid", 1);
+	bool scaleGrid = settings.scaleGrid;
 	// get grid setting
 	RS_Vector userGrid;
 	if (graphic) {
@@ -92,17 +115,14 @@ void RS_Grid::updatePointArray() {
 		userGrid = graphic->getVariableVector("$GRIDUNIT",
 											 RS_Vector(-1.0, -1.0));
 	}else {
-		isometric = (bool)RS_SETTINGS->readNumEntry("/IsometricGrid", 0);
-		crosshairType=static_cast<RS2::CrosshairType>(RS_SETTINGS->readNumEntry("/CrosshairType",0));
-		userGrid.x = RS_SETTINGS->readEntry("/GridSpacingX",QString("-1")).toDouble();
-		userGrid.y = RS_SETTINGS->readEntry("/GridSpacingY",QString("-1")).toDouble();
+		isometric = settings.isometric;
+		crosshairType = settings.crosshairType;
+		userGrid = settings.userGrid;
 	}
-	int minGridSpacing = RS_SETTINGS->readNumEntry("/MinGridSpacing", 10);
-	RS_SETTINGS->endGroup();
+	int minGridSpacing = settings.minGridSpacing;
 
 	// std::cout<<"Grid userGrid="<<userGrid<<std::endl;
 
-	pt.clear();
 	metaX.clear();
 	metaY.clear();
 
@@ -166,15 +186,28 @@ void RS_Grid::updatePointArray() {
 		//top/bottom is reversed with RectF definition
 		LC_Rect const rect{{left, bottom}, {right, top}};
 
+		// the grid points only depend on the covered grid cells: panning
+		// within a cell or redrawing the same view keeps the current points
+		PointKey const key{left, bottom, right, top, gridWidth, isometric};
+		bool const createPoints = !(pointsValid && key == pointKey);
+		if (createPoints) {
+			pt.clear();
+			pointKey = key;
+			pointsValid = true;
+		}
+
 		// populate grid points and metaGrid line positions: pts, metaX, metaY
 		if(isometric){
-			createIsometricGrid(rect, gridWidth);
+			createIsometricGrid(rect, gridWidth, createPoints);
 		}else{
-			createOrthogonalGrid(rect, gridWidth);
+			createOrthogonalGrid(rect, gridWidth, createPoints);
 
 		}
 
 		// RS_DEBUG->print("RS_Grid::update: 015");
+	} else {
+		pt.clear();
+		pointsValid = false;
 	}
 
 	// RS_DEBUG->print("RS_Grid::update: OK");
@@ -363,7 +396,7 @@ RS_Vector RS_Grid::getImperialGridWidth(RS_Vector const& userGrid, bool scaleGri
 }
 
 
-void RS_Grid::createOrthogonalGrid(LC_Rect const& rect, RS_Vector const& gridWidth)
+void RS_Grid::createOrthogonalGrid(LC_Rect const& rect, RS_Vector const& gridWidth, bool createPoints)
 {
 	double const left=rect.minP().x;
 	double const right=rect.maxP().x;
@@ -382,17 +415,19 @@ void RS_Grid::createOrthogonalGrid(LC_Rect const& rect, RS_Vector const& gridWid
 
 	if (number<=0 || number>maxGridPoints) return;
 
-	pt.resize(number);
+	if (createPoints) {
+		pt.resize(number);
 
-	int i=0;
-	RS_Vector bp0(baseGrid);
-	for (int y=0; y<numberY; ++y) {
-		RS_Vector bp1(bp0);
-		for (int x=0; x<numberX; ++x) {
-			pt[i++] = bp1;
-			bp1.x += gridWidth.x;
+		int i=0;
+		RS_Vector bp0(baseGrid);
+		for (int y=0; y<numberY; ++y) {
+			RS_Vector bp1(bp0);
+			for (int x=0; x<numberX; ++x) {
+				pt[i++] = RS_Vector2D{bp1};
+				bp1.x += gridWidth.x;
+			}
+			bp0.y += gridWidth.y;
 		}
-		bp0.y += gridWidth.y;
 	}
 	// find meta grid boundaries
 	if (metaGridWidth.x>minimumGridWidth && metaGridWidth.y>minimumGridWidth &&
@@ -433,7 +468,7 @@ void RS_Grid::createOrthogonalGrid(LC_Rect const& rect, RS_Vector const& gridWid
 	}
 }
 
-void RS_Grid::createIsometricGrid(LC_Rect const& rect, RS_Vector const& gridWidth)
+void RS_Grid::createIsometricGrid(LC_Rect const& rect, RS_Vector const& gridWidth, bool createPoints)
 {
 	double const left=rect.minP().x;
 	double const right=rect.maxP().x;
@@ -451,18 +486,20 @@ void RS_Grid::createIsometricGrid(LC_Rect const& rect, RS_Vector const& gridWidt
 
 	if (number<=0 || number>maxGridPoints) return;
 
-	pt.resize(number);
+	if (createPoints) {
+		pt.resize(number);
 
-	int i=0;
-	RS_Vector bp0(baseGrid),dbp1(hdx,hdy);
-	for (int y=0; y<numberY; ++y) {
-		RS_Vector bp1(bp0);
-		for (int x=0; x<numberX; ++x) {
-			pt[i++] = bp1;
-			pt[i++] = bp1+dbp1;
-			bp1.x += dx;
+		int i=0;
+		RS_Vector bp0(baseGrid),dbp1(hdx,hdy);
+		for (int y=0; y<numberY; ++y) {
+			RS_Vector bp1(bp0);
+			for (int x=0; x<numberX; ++x) {
+				pt[i++] = RS_Vector2D{bp1};
+				pt[i++] = RS_Vector2D{bp1+dbp1};
+				bp1.x += dx;
+			}
+			bp0.y += gridWidth.y;
 		}
-		bp0.y += gridWidth.y;
 	}
 	//find metaGrid
 	if (metaGridWidth.y>minimumGridWidth &&
@@ -495,7 +532,7 @@ QString RS_Grid::getInfo() const{
 	return QString("%1 / %2").arg(spacing).arg(metaSpacing);
 }
 
-std::vector<RS_Vector> const& RS_Grid::getPoints() const{
+std::vector<RS_Vector2D> const& RS_Grid::getPoints() const{
 	return pt;
 }
 
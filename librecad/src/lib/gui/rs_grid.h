@@ -53,12 +53,18 @@ class RS_Grid
 public:
 	RS_Grid(RS_GraphicView* graphicView);
 
+	/**
+	 * Reloads the grid related application settings. Called on
+	 * construction and whenever the application options changed.
+	 */
+	void loadSettings();
+
 	void updatePointArray();
 
 	/**
 		 * @return Array of all visible grid points.
 		 */
-	std::vector<RS_Vector> const& getPoints() const;
+	std::vector<RS_Vector2D> const& getPoints() const;
 
 	/**
 	* \brief the closest grid point
@@ -99,8 +105,8 @@ private:
 	RS_Grid(RS_Grid const&) = delete;
 	RS_Grid& operator = (RS_Grid const&) = delete;
 	//! \{ \brief create grid points
-	void createOrthogonalGrid(LC_Rect const& rect, RS_Vector const& gridWidth);
-	void createIsometricGrid(LC_Rect const& rect, RS_Vector const& gridWidth);
+	void createOrthogonalGrid(LC_Rect const& rect, RS_Vector const& gridWidth, bool createPoints);
+	void createIsometricGrid(LC_Rect const& rect, RS_Vector const& gridWidth, bool createPoints);
 	//! \}
 
 	//! \{ \brief determine grid width
@@ -117,7 +123,7 @@ private:
     double metaSpacing = 0.;
 
     //! Pointer to array of grid points
-    std::vector<RS_Vector> pt;
+    std::vector<RS_Vector2D> pt;
     RS_Vector baseGrid; // the left-bottom grid point
     RS_Vector cellV;    // (dx,dy)
     RS_Vector metaGridWidth;
@@ -128,6 +134,31 @@ private:
     bool isometric = false;
     RS2::CrosshairType crosshairType = RS2::LeftCrosshair;
 
+    //! Application settings, cached by loadSettings()
+    struct Settings {
+        bool scaleGrid = true;
+        bool isometric = false;
+        RS2::CrosshairType crosshairType = RS2::LeftCrosshair;
+        RS_Vector userGrid{-1., -1.};
+        int minGridSpacing = 10;
+    } settings;
+
+    //! The grid the points in pt were created for, the points are reused
+    //! as long as the view still covers the same grid cells
+    struct PointKey {
+        double left = 0.;
+        double bottom = 0.;
+        double right = 0.;
+        double top = 0.;
+        RS_Vector gridWidth{0., 0.};
+        bool isometric = false;
+
+        bool operator == (const PointKey& other) const;
+    } pointKey;
+    bool pointsValid = false;
+    //! RS_Settings::revision() of the settings cached
+    unsigned settingsRevision = 0;
+
 };
 
 #endif
@@ -25,13 +25,16 @@
 **********************************************************************/
 #include<cmath>
 
+#include<QBrush>
 #include<QPainterPath>
 #include<QPolygon>
+#include<QTransform>
 
 #include "rs_color.h"
 #include "rs_debug.h"
 #include "rs_math.h"
 #include "rs_painter.h"
+#include "rs_pen.h"
 
 void RS_Painter::createArc(QPolygon& pa,
                              const RS_Vector& cp, double radius,
@@ -140,6 +143,26 @@ void RS_Painter::createEllipse(QPolygon& pa,
            toScreenY(vp.y));
 }
 
+void RS_Painter::drawGridPoints(const std::vector<RS_Vector>& points) {
+    for (const RS_Vector& p: points)
+        drawGridPoint(p);
+}
+
+void RS_Painter::fillPath(const QPainterPath& path) {
+    const QBrush saved = brush();
+    setBrush(getPen().getColor());
+    drawPath(path);
+    setBrush(saved);
+}
+
+void RS_Painter::drawSharedPath(const QPainterPath& path, const QTransform& transform, bool filled) {
+    const QPainterPath mapped = transform.map(path);
+    if (filled)
+        fillPath(mapped);
+    else
+        drawPath(mapped);
+}
+
 void RS_Painter::drawRect(const RS_Vector& p1, const RS_Vector& p2) {
     drawPolygon(QRect(int(p1.x+0.5), int(p1.y+0.5), int(p2.x - p1.x+0.5), int(p2.y - p1.y+0.5)));
 //    drawLine(RS_Vector(p1.x, p1.y), RS_Vector(p2.x, p1.y));
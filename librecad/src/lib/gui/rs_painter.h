@@ -37,6 +37,7 @@ class RS_Pen;
 class RS_Polyline;
 class RS_Spline;
 class QPainterPath;
+class QTransform;
 class QRect;
 class QRectF;
 class QPolygon;
@@ -71,16 +72,31 @@ public:
         drawingMode = m;
     }
 
-    // When set to true, only entities that are selected will be drawn
+    // When set to true, only entities that are selected or highlighted will be drawn
     void setDrawSelectedOnly(bool dso) {
         drawSelectedEntities=dso;
     }
 
-    // When true, only selected items will be draw
+    // When true, only selected or highlighted items will be draw
     bool shouldDrawSelected() {
         return drawSelectedEntities;
     }
 
+    // When set to true, all entities are drawn as neither selected nor highlighted,
+    // for views drawing the selection on a layer of its own
+    void setIgnoreSelection(bool ignore) {
+        ignoreSelection=ignore;
+    }
+
+    bool shouldIgnoreSelection() const {
+        return ignoreSelection;
+    }
+
+    // the number of primitives submitted to the painter, for render statistics
+    unsigned long getPrimitiveCount() const {
+        return primitiveCount;
+    }
+
     /**
      * @return Current drawing mode.
      */
@@ -88,10 +104,24 @@ public:
         return drawingMode;
     }
 
+    /**
+     * Starts collecting primitives: a painter may defer them and submit
+     * primitives of the same pen together, keeping the drawing order.
+     */
+    virtual void beginBatch() {}
+    /**
+     * Draws all deferred primitives and stops collecting.
+     */
+    virtual void endBatch() {}
+
     virtual void moveTo(int x, int y) = 0;
     virtual void lineTo(int x, int y) = 0;
 
     virtual void drawGridPoint(const RS_Vector& p) = 0;
+    /**
+     * Draws all grid points in one go, the default draws them one by one.
+     */
+    virtual void drawGridPoints(const std::vector<RS_Vector>& points);
     virtual void drawPoint(const RS_Vector& p, int pdmode, int pdsize) = 0;
     virtual void drawLine(const RS_Vector& p1, const RS_Vector& p2) = 0;
     virtual void drawRect(const RS_Vector& p1, const RS_Vector& p2);
@@ -138,6 +168,14 @@ public:
                               const RS_Vector& p3) = 0;
 
     virtual void drawPath ( const QPainterPath & path ) = 0;
+    //! draws a path filled with the pen color, like fillTriangle()
+    void fillPath(const QPainterPath& path);
+    /**
+     * draws a path shared by several entities through the transform of each one, like the
+     * paths of a block drawn by its inserts. Painters of devices with reusable content may
+     * write the path once.
+     */
+    virtual void drawSharedPath(const QPainterPath& path, const QTransform& transform, bool filled);
     virtual void drawHandle(const RS_Vector& p, const RS_Color& c, int size=-1);
 
     virtual RS_Pen getPen() const = 0;
@@ -175,6 +213,10 @@ protected:
 
     // When set to true, only selected entities should be drawn
     bool drawSelectedEntities = false;
+    // When set to true, the selection state of entities is ignored
+    bool ignoreSelection = false;
+    // counted by the implementations, see getPrimitiveCount()
+    unsigned long primitiveCount = 0;
 
 
 };
@@ -24,11 +24,14 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
 
 #include "dxf_format.h"
+#include "lc_clipping.h"
+#include "lc_dashsegmenter.h"
 #include "lc_splinepoints.h"
 #include "rs_arc.h"
 #include "rs_debug.h"
@@ -51,6 +54,13 @@ QVector<qreal> rsToQDashPattern(RS2::LineType t, double screenWidth, double dpmm
     double k = dpmm / std::max(screenWidth, 1.);
 
     const std::vector<double>& pattern = RS_LineTypePattern::getPattern(t)->pattern;
+    // dashes denser than the pixels are drawn as a solid line, instead of as a dash per pixel
+    constexpr double minDashPeriod = 2.;
+    double period = 0.;
+    for (double d: pattern)
+        period += std::abs(d) * dpmm;
+    if (period < minDashPeriod)
+        return {};
     QVector<qreal> dashPattern;
     std::transform(pattern.cbegin(), pattern.cend(), std::back_inserter(dashPattern), [k](double d) {
         return std::max(k * std::abs(d), 1.);
@@ -142,6 +152,45 @@ QPainterPath getEllipticArcClipping(const RS_Vector& origin,
     return path;
 }
 
+// Points of a circular arc at a constant angle step: the radius vector is rotated by the step,
+// so sin/cos are evaluated once per arc, instead of once per point
+class ArcStepper {
+public:
+    ArcStepper(double radius, double angle, double step):
+        m_x{radius * std::cos(angle)}
+      , m_y{radius * std::sin(angle)}
+      , m_cos{std::cos(step)}
+      , m_sin{std::sin(step)}
+    {}
+
+    // advances by one step: returns the offset from the center
+    RS_Vector next()
+    {
+        const double x = m_x * m_cos - m_y * m_sin;
+        m_y = m_x * m_sin + m_y * m_cos;
+        m_x = x;
+        return {m_x, m_y};
+    }
+
+private:
+    double m_x = 0.;
+    double m_y = 0.;
+    const double m_cos = 1.;
+    const double m_sin = 0.;
+};
+
+// whether setting the pen again would change nothing, unlike RS_Pen::operator==
+// all attributes used by RS_PainterQt::setPen() and the dash setup are compared
+bool isSamePen(const RS_Pen& a, const RS_Pen& b)
+{
+    return a.getLineType() == b.getLineType()
+            && a.getWidth() == b.getWidth()
+            && a.getColor() == b.getColor()
+            && a.getScreenWidth() == b.getScreenWidth()
+            && a.getAlpha() == b.getAlpha()
+            && a.dashOffset() == b.dashOffset();
+}
+
 // RAII style saving and restore QPainter states
 class PainterGuard {
 public:
@@ -194,6 +243,29 @@ private:
     QPainter& m_painter;
 };
 
+// Adds a part of a circular arc, in radians counterclockwise on the screen, as a new subpath.
+// QPainterPath::arcTo() is inaccurate for huge radii, those arcs are added as chords instead
+void addArcPart(QPainterPath& path, const QPointF& center, double radius, double a1, double a2)
+{
+    constexpr double maxArcToRadius = 1e5;
+    if (radius <= maxArcToRadius) {
+        const QRectF rect{center.x() - radius, center.y() - radius, 2. * radius, 2. * radius};
+        path.arcMoveTo(rect, a1 * 180. / M_PI);
+        path.arcTo(rect, a1 * 180. / M_PI, (a2 - a1) * 180. / M_PI);
+        return;
+    }
+    // chords a quarter of a pixel from the arc at most
+    const double maxStep = std::sqrt(2. / radius);
+    const int steps = std::clamp(int(std::ceil((a2 - a1) / maxStep)), 1, 10000);
+    const double step = (a2 - a1) / steps;
+    auto point = [&center, radius](double a) {
+        return QPointF{center.x() + radius * std::cos(a), center.y() - radius * std::sin(a)};
+    };
+    path.moveTo(point(a1));
+    for (int i = 1; i <= steps; ++i)
+        path.lineTo(point(a1 + i * step));
+}
+
 void drawArc(QPainterPath& path, const RS_Arc& arc, const LC_Rect& viewRect, const std::function<QPointF(const RS_Vector&)>& mapping)
 {
     auto mapingRs=[&mapping](const RS_Vector& vp) -> RS_Vector {
@@ -208,10 +280,11 @@ void drawArc(QPainterPath& path, const RS_Arc& arc, const LC_Rect& viewRect, con
         double a1 = arc.isReversed() ? a0 - arc.getAngleLength() : a0 + arc.getAngleLength();
         int steps = int(arc.getAngleLength()/(M_PI/36.)) + 2;
         double dA = (a1-a0)/steps;
-        for (int i=0; i<= steps; ++i) {
-            double a = a0 + dA * i;
-            path.lineTo(mapping(arc.getCenter() + RS_Vector{a} * arc.getRadius()));
-        }
+        path.lineTo(mapping(arc.getStartpoint()));
+        ArcStepper stepper{arc.getRadius(), a0, dA};
+        for (int i=1; i< steps; ++i)
+            path.lineTo(mapping(arc.getCenter() + stepper.next()));
+        path.lineTo(mapping(arc.getEndpoint()));
     } else {
         double a0 = arc.getAngle1();
         QPointF center = mapping(arc.getCenter());
@@ -231,23 +304,8 @@ void drawArc(QPainterPath& path, const RS_Arc& arc, const LC_Rect& viewRect, con
     }
 }
 
-void drawPolylineSegment(QPainterPath& path, RS_Entity* entity, const LC_Rect& viewRect, const std::function<QPointF(const RS_Vector&)>& mapping)
-{
-    if (entity == nullptr)
-        return;
-    switch(entity->rtti()) {
-    case RS2::EntityLine:
-        path.lineTo(mapping(entity->getEndpoint()));
-        break;
-    case RS2::EntityArc:
-        drawArc(path, *static_cast<RS_Arc*>(entity), viewRect, mapping);
-        break;
-    default:
-        LC_ERR<<"Polyline may contain lines/arcs only: found rtti() ="<<entity->rtti();
-    }
-}
-
-QPainterPath createPolyline(const RS_Polyline& polyline, const RS_GraphicView& view)
+// the polyline, clipped to the rectangle if clip is set
+QPainterPath createPolyline(const RS_Polyline& polyline, const RS_GraphicView& view, const QRectF* clip)
 {
     QPainterPath path;
     if (polyline.isEmpty())
@@ -261,10 +319,57 @@ QPainterPath createPolyline(const RS_Polyline& polyline, const RS_GraphicView& v
         return {point.x(), point.y()};
     };
     LC_Rect viewRect{mapingRs(view.getViewRect().minP()), mapingRs(view.getViewRect().maxP())};
-    path.moveTo(toGui(static_cast<RS_AtomicEntity*>(*polyline.begin())->getStartpoint()));
 
-    for(RS_Entity* entity: polyline)
-        drawPolylineSegment(path, entity, viewRect, toGui);
+    // line segments are drawn from the vertex array, arcs from their entities
+    const std::shared_ptr<const std::vector<RS_PolylineVertex>> vertexArray = polyline.getVertices();
+    const std::vector<RS_PolylineVertex>& vertices = *vertexArray;
+    if (vertices.empty())
+        return path;
+    if (clip != nullptr && clip->contains(QRectF{toGui(polyline.getMin()), toGui(polyline.getMax())}.normalized()))
+        clip = nullptr;
+    auto segment = polyline.begin();
+    if (clip == nullptr) {
+        path.moveTo(toGui(vertices.front().point));
+        for (size_t i = 0; i + 1 < vertices.size(); ++i, ++segment) {
+            if ((*segment)->rtti() == RS2::EntityArc)
+                drawArc(path, *static_cast<RS_Arc*>(*segment), viewRect, toGui);
+            else
+                path.lineTo(toGui(vertices[i + 1].point));
+        }
+        return path;
+    }
+
+    // only the visible parts are added, the path just continues where they meet
+    bool atVertex = false;
+    for (size_t i = 0; i + 1 < vertices.size(); ++i, ++segment) {
+        if ((*segment)->rtti() == RS2::EntityArc) {
+            const RS_Arc& arc = *static_cast<RS_Arc*>(*segment);
+            const QPointF center = toGui(arc.getCenter());
+            const QPointF rightMost = toGui(arc.getCenter() + RS_Vector{arc.getRadius(), 0.});
+            const double r = std::hypot(center.x() - rightMost.x(), center.y() - rightMost.y());
+            double a1 = arc.getAngle1();
+            if (arc.isReversed())
+                a1 -= arc.getAngleLength();
+            const double a2 = a1 + arc.getAngleLength();
+            const auto parts = LC_Clipping::clipArc(*clip, center, r, a1, a2);
+            for (const auto& [b1, b2]: parts)
+                addArcPart(path, center, r, b1, b2);
+            atVertex = !parts.empty() && !arc.isReversed() && parts.back().second == a2;
+            continue;
+        }
+        const QPointF from = toGui(vertices[i].point);
+        const QPointF to = toGui(vertices[i + 1].point);
+        QPointF start = from;
+        QPointF end = to;
+        if (!LC_Clipping::clipLine(*clip, start, end)) {
+            atVertex = false;
+            continue;
+        }
+        if (!atVertex || start != from)
+            path.moveTo(start);
+        path.lineTo(end);
+        atVertex = end == to;
+    }
 
     return path;
 }
@@ -277,6 +382,47 @@ QPainterPath createPolyline(const RS_Polyline& polyline, const RS_GraphicView& v
 RS_PainterQt::RS_PainterQt( QPaintDevice* pd)
         : QPainter{pd} {}
 
+RS_PainterQt::~RS_PainterQt()
+{
+    endBatch();
+}
+
+/**
+ * Starts collecting solid lines: consecutive lines of the same pen are
+ * drawn by a single QPainter::drawLines() call, instead of saving and
+ * restoring the painter state for each line. Any other primitive draws
+ * the collected lines first, so the drawing order is kept.
+ */
+void RS_PainterQt::beginBatch()
+{
+    batching = true;
+}
+
+void RS_PainterQt::endBatch()
+{
+    flushBatch();
+    batching = false;
+}
+
+void RS_PainterQt::flushBatch()
+{
+    if (batchLines.empty())
+        return;
+    if (isActive()) {
+        save();
+        QPainter::setPen(batchPen);
+        QPainter::drawLines(batchLines.data(), int(batchLines.size()));
+        restore();
+    }
+    batchLines.clear();
+}
+
+void RS_PainterQt::submitPrimitive()
+{
+    ++primitiveCount;
+    flushBatch();
+}
+
 void RS_PainterQt::moveTo(int x, int y) {
         //RVT_PORT changed from QPainter::moveTo(x,y);
         rememberX=x;
@@ -285,6 +431,7 @@ void RS_PainterQt::moveTo(int x, int y) {
 
 
 void RS_PainterQt::lineTo(int x, int y) {
+        submitPrimitive();
         // RVT_PORT changed from QPainter::lineTo(x, y);
         QPainterPath path;
         path.moveTo(rememberX,rememberY);
@@ -298,15 +445,29 @@ void RS_PainterQt::lineTo(int x, int y) {
  * Draws a grid point at (x1, y1).
  */
 void RS_PainterQt::drawGridPoint(const RS_Vector& p) {
+    submitPrimitive();
     QPainter::drawPoint(toScreenX(p.x), toScreenY(p.y));
 }
 
+/**
+ * Draws all grid points with a single call, which lets the paint engine
+ * batch them instead of setting up each point separately.
+ */
+void RS_PainterQt::drawGridPoints(const std::vector<RS_Vector>& points) {
+    submitPrimitive();
+    QPolygon polygon(int(points.size()));
+    for (size_t i = 0; i < points.size(); ++i)
+        polygon[int(i)] = QPoint(toScreenX(points[i].x), toScreenY(points[i].y));
+    QPainter::drawPoints(polygon);
+}
+
 
 
 /**
  * Draws a point at (x1, y1).
  */
 void RS_PainterQt::drawPoint(const RS_Vector& p, int pdmode, int pdsize) {
+    submitPrimitive();
 	int screenX = toScreenX(p.x);
 	int screenY = toScreenY(p.y);
 	int halfPDSize = pdsize/2;
@@ -395,9 +556,33 @@ void RS_PainterQt::drawPoint(const RS_Vector& p, int pdmode, int pdsize) {
  */
 void RS_PainterQt::drawLine(const RS_Vector& p1, const RS_Vector& p2)
 {
+    // clipped before the points are rounded to the screen, far away points overflow it
+    QPointF start{offset.x + p1.x, offset.y + p1.y};
+    QPointF end{offset.x + p2.x, offset.y + p2.y};
+    double dashStart = 0.;
+    if (!LC_Clipping::clipLine(clipArea(), start, end, &dashStart))
+        return;
+    const QPointF screen1(RS_Math::round(start.x()), RS_Math::round(start.y()));
+    const QPointF screen2(RS_Math::round(end.x()), RS_Math::round(end.y()));
+
+    if (batching && lpen.getLineType() == RS2::SolidLine) {
+        // the pen PainterGuard would set up for a solid line
+        QPen solid = pen();
+        solid.setStyle(Qt::SolidLine);
+        solid.setColor(lpen.getColor());
+        if (!batchLines.empty() && solid != batchPen)
+            flushBatch();
+        batchPen = solid;
+        batchLines.emplace_back(screen1, screen2);
+        ++primitiveCount;
+        return;
+    }
+    submitPrimitive();
     PainterGuard painterGuard{*this};
-    QPainter::drawLine(toScreenX(p1.x), toScreenY(p1.y),
-                       toScreenX(p2.x), toScreenY(p2.y));
+    QPainterPath path;
+    path.moveTo(screen1);
+    path.lineTo(screen2);
+    strokePath(path, dashStart);
 }
 
 
@@ -441,6 +626,7 @@ void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
                            double a1, double a2,
                            const RS_Vector& p1, const RS_Vector& p2,
                            bool reversed) {
+    submitPrimitive();
     /*
     QPainter::drawArc(cx-radius, cy-radius,
                       2*radius, 2*radius,
@@ -482,9 +668,11 @@ void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
             int i=0;
             pa.resize(i+1);
             pa.setPoint(i++, toScreenX(p1.x), toScreenY(p1.y));
+            ArcStepper stepper{radius, a1, aStep};
             for(a=a1+aStep; a<=a2; a+=aStep) {
-                cix = toScreenX(cp.x+std::cos(a)*radius);
-                ciy = toScreenY(cp.y-std::sin(a)*radius);
+                const RS_Vector offset = stepper.next();
+                cix = toScreenX(cp.x+offset.x);
+                ciy = toScreenY(cp.y-offset.y);
                 //lineTo(cix, ciy);
                 pa.resize(i+1);
                 pa.setPoint(i++, cix, ciy);
@@ -503,9 +691,11 @@ void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
             pa.resize(i+1);
             pa.setPoint(i++, toScreenX(p1.x), toScreenY(p1.y));
             //moveTo(toScreenX(p1.x), toScreenY(p1.y));
+            ArcStepper stepper{radius, a1, -aStep};
             for(a=a1-aStep; a>=a2; a-=aStep) {
-                cix = toScreenX(cp.x+std::cos(a)*radius);
-                ciy = toScreenY(cp.y-std::sin(a)*radius);
+                const RS_Vector offset = stepper.next();
+                cix = toScreenX(cp.x+offset.x);
+                ciy = toScreenY(cp.y-offset.y);
                 //lineTo(cix, ciy);
                 pa.resize(i+1);
                 pa.setPoint(i++, cix, ciy);
@@ -536,6 +726,7 @@ void RS_PainterQt::drawArc( const RS_Vector& cp,
                             double a2,
                             [[maybe_unused]] bool reversed)
 {
+    submitPrimitive();
     if (radius <= 0.5)
     {
         drawGridPoint(cp);
@@ -553,12 +744,21 @@ void RS_PainterQt::drawArc( const RS_Vector& cp,
         // shift a2 - a1 to the range of 0 to 2 pi
         a2 = a1+ M_PI + std::remainder(a2 - a1 - M_PI, 2. * M_PI);
 
-        QPainter::drawArc( toScreenX(cp.x - radius), 
-                           toScreenY(cp.y - radius), 
-                           2.0 * radius, 
-                           2.0 * radius, 
-                           a1  * 16.0 * 180.0 / M_PI, 
-                       (a2-a1) * 16.0 * 180.0 / M_PI);
+        const QPointF center{offset.x + cp.x, offset.y + cp.y};
+        const QRectF clip = clipArea();
+        if (!clip.contains(QRectF{center.x() - radius, center.y() - radius, 2. * radius, 2. * radius})) {
+            strokeClippedArc(center, radius, a1, a2);
+            return;
+        }
+
+        const QRectF rect{double(toScreenX(cp.x - radius)),
+                          double(toScreenY(cp.y - radius)),
+                          2.0 * radius,
+                          2.0 * radius};
+        QPainterPath path;
+        path.arcMoveTo(rect, a1 * 180.0 / M_PI);
+        path.arcTo(rect, a1 * 180.0 / M_PI, (a2 - a1) * 180.0 / M_PI);
+        strokePath(path);
     }
 }
 
@@ -576,6 +776,7 @@ void RS_PainterQt::drawArc( const RS_Vector& cp,
 void RS_PainterQt::drawArcMac(const RS_Vector& cp, double radius,
                            double a1, double a2,
                            bool reversed) {
+        submitPrimitive();
         RS_DEBUG->print("RS_PainterQt::drawArcMac");
     if(radius<=0.5) {
         drawGridPoint(cp);
@@ -614,9 +815,11 @@ void RS_PainterQt::drawArcMac(const RS_Vector& cp, double radius,
                   if(a1>a2-1.0e-10) {
                       a2+=2*M_PI;
                   }
+                  ArcStepper stepper{radius, a1, aStep};
                   for(a=a1+aStep; a<=a2; a+=aStep) {
-                      cix = cp.x+std::cos(a)*radius;
-                      ciy = cp.y-std::sin(a)*radius;
+                      const RS_Vector offset = stepper.next();
+                      cix = cp.x+offset.x;
+                      ciy = cp.y-offset.y;
                       //lineTo(cix, ciy);
                                           drawLine(RS_Vector(ox, oy), RS_Vector(cix, ciy));
                                           ox = cix;
@@ -629,9 +832,11 @@ void RS_PainterQt::drawArcMac(const RS_Vector& cp, double radius,
                   if(a1<a2+1.0e-10) {
                       a2-=2*M_PI;
                   }
+                  ArcStepper stepper{radius, a1, -aStep};
                   for(a=a1-aStep; a>=a2; a-=aStep) {
-                      cix = cp.x+std::cos(a)*radius;
-                      ciy = cp.y-std::sin(a)*radius;
+                      const RS_Vector offset = stepper.next();
+                      cix = cp.x+offset.x;
+                      ciy = cp.y-offset.y;
                       drawLine(RS_Vector(ox, oy), RS_Vector(cix, ciy));
                                           ox = cix;
                                           oy = ciy;
@@ -662,9 +867,17 @@ void RS_PainterQt::drawArcMac(const RS_Vector& cp, double radius,
  */
 void RS_PainterQt::drawCircle(const RS_Vector& cp, double radius)
 {
+    submitPrimitive();
     // RAII style: setting and restoring QPen dashPattern
     PainterGuard painterGuard{*this};
-    QPainter::drawEllipse(QPointF(cp.x, cp.y), radius, radius);
+    const QPointF center{cp.x, cp.y};
+    if (!clipArea().contains(QRectF{center.x() - radius, center.y() - radius, 2. * radius, 2. * radius})) {
+        strokeClippedArc(center, radius, 0., 2. * M_PI);
+        return;
+    }
+    QPainterPath path;
+    path.addEllipse(center, radius, radius);
+    strokePath(path);
 }
 
 
@@ -677,6 +890,7 @@ void RS_PainterQt::drawEllipse(const RS_Vector& cp,
                                double angle,
                                double a1, double a2,
                                bool reversed) {
+    submitPrimitive();
 
     if (reversed)
         std::swap(a1, a2);
@@ -711,28 +925,34 @@ void RS_PainterQt::drawEllipse(const RS_Vector& cp,
 
 void RS_PainterQt::drawSplinePoints(const LC_SplinePointsData& splineData)
 {
+    submitPrimitive();
     // RAII style QPainter state saving/restoring
     PainterGuard painterGuard{*this};
-    drawPath(createSplinePoints(splineData));
+    strokePath(createSplinePoints(splineData));
 }
 
 void RS_PainterQt::drawPolyline(const RS_Polyline& polyline, const RS_GraphicView& view)
 {
+    submitPrimitive();
     // RAII style QPainter state saving/restoring
     PainterGuard painterGuard{*this};
-    drawPath(createPolyline(polyline, view));
+    // dashed paths are clipped by LC_DashSegmenter, along with their pattern
+    const QRectF clip = clipArea();
+    strokePath(createPolyline(polyline, view, pen().style() == Qt::CustomDashLine ? nullptr : &clip));
 }
 
 void RS_PainterQt::drawSpline(const RS_Spline& spline, const RS_GraphicView& view)
 {
+    submitPrimitive();
     // RAII style QPainter state saving/restoring
     PainterGuard painterGuard{*this};
-    drawPath(createSpline(spline, view));
+    strokePath(createSpline(spline, view));
 }
 
 
 void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
                            const RS_Vector& uVector, const RS_Vector& vVector, const RS_Vector& factor) {
+    submitPrimitive();
     save();
 
     // Render smooth only at close zooms
@@ -767,6 +987,7 @@ void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
 void RS_PainterQt::drawTextH(int x1, int y1,
                              int x2, int y2,
                              const QString& text) {
+    submitPrimitive();
     QPainter::drawText(x1, y1, x2, y2,
              Qt::AlignRight|Qt::AlignVCenter,
              text);
@@ -777,6 +998,7 @@ void RS_PainterQt::drawTextH(int x1, int y1,
 void RS_PainterQt::drawTextV(int x1, int y1,
                              int x2, int y2,
                              const QString& text) {
+    submitPrimitive();
     save();
     QTransform wm = worldTransform();
     wm.rotate(-90.0);
@@ -791,6 +1013,7 @@ void RS_PainterQt::drawTextV(int x1, int y1,
 
 void RS_PainterQt::fillRect(int x1, int y1, int w, int h,
                             const RS_Color& col) {
+    submitPrimitive();
     QPainter::fillRect(x1, y1, w, h, col);
 }
 
@@ -798,6 +1021,7 @@ void RS_PainterQt::fillRect(int x1, int y1, int w, int h,
 void RS_PainterQt::fillTriangle(const RS_Vector& p1,
                                 const RS_Vector& p2,
                                 const RS_Vector& p3) {
+    submitPrimitive();
 
     QPolygon arr(3);
     QBrush brushSaved=brush();
@@ -812,6 +1036,7 @@ void RS_PainterQt::fillTriangle(const RS_Vector& p1,
 
 
 void RS_PainterQt::erase() {
+    flushBatch();
     QPainter::eraseRect(0,0,getWidth(),getHeight());
 }
 
@@ -849,6 +1074,13 @@ RS_Pen RS_PainterQt::getPen() const{
 }
 
 void RS_PainterQt::setPen(const RS_Pen& pen) {
+    // entities mostly come in runs of the same pen
+    if (requestedPenValid && drawingMode == requestedMode && isSamePen(pen, requestedPen))
+        return;
+    requestedPen = pen;
+    requestedMode = drawingMode;
+    requestedPenValid = true;
+
     lpen = pen;
     switch (drawingMode) {
     case RS2::ModeBW:
@@ -866,7 +1098,16 @@ void RS_PainterQt::setPen(const RS_Pen& pen) {
     QColor pColor { lpen.getColor() };
 
     pColor.setAlphaF(pen.getAlpha());
-    QPen p(pColor, RS_Math::round(lpen.getScreenWidth()),
+    const int width = RS_Math::round(lpen.getScreenWidth());
+    // entities share few pens, don't rebuild dash patterns for each entity
+    const auto key = std::make_tuple(pColor.rgba(), width, static_cast<int>(lpen.getLineType()));
+    auto it = penCache.find(key);
+    if (it != penCache.end()) {
+        QPainter::setPen(it->second);
+        return;
+    }
+
+    QPen p(pColor, width,
            rsToQtLineType(lpen.getLineType()));
     if (p.style() == Qt::CustomDashLine)
     {
@@ -880,10 +1121,15 @@ void RS_PainterQt::setPen(const RS_Pen& pen) {
     }
     p.setJoinStyle(Qt::RoundJoin);
     p.setCapStyle(Qt::RoundCap);
+    // bounded, in case of drawings with many true colors
+    if (penCache.size() >= 1024)
+        penCache.clear();
+    penCache.emplace(key, p);
     QPainter::setPen(p);
 }
 
 void RS_PainterQt::setPen(const RS_Color& color) {
+    requestedPenValid = false;
     switch (drawingMode) {
     case RS2::ModeBW:
         lpen.setColor( RS_Color( Qt::black));
@@ -919,6 +1165,7 @@ void RS_PainterQt::setPen(int r, int g, int b) {
 }
 
 void RS_PainterQt::disablePen() {
+    requestedPenValid = false;
     lpen = RS_Pen(RS2::FlagInvalid);
     QPainter::setPen(Qt::NoPen);
 }
@@ -944,24 +1191,78 @@ void RS_PainterQt::setBrush(const QBrush& color) {
 }
 
 void RS_PainterQt::drawPolygon(const QPolygon& a, Qt::FillRule rule) {
+    submitPrimitive();
     QPainter::drawPolygon(a,rule);
 }
 
 void RS_PainterQt::drawPath ( const QPainterPath & path ) {
+    submitPrimitive();
     QPainter::drawPath(path);
 }
 
 
+void RS_PainterQt::strokePath(const QPainterPath& path, double dashStart) {
+    const QPen original = pen();
+    if (original.style() != Qt::CustomDashLine) {
+        QPainter::drawPath(path);
+        return;
+    }
+    // the offset is in units of the pen width
+    QPen dashed = original;
+    if (dashStart > 0.)
+        dashed.setDashOffset(dashed.dashOffset() + dashStart / std::max(dashed.widthF(), 1.));
+    const QRectF viewport = transform().inverted().mapRect(QRectF(0., 0., getWidth(), getHeight()));
+    LC_DashSegmenter segmenter = LC_DashSegmenter::forPen(dashed, viewport);
+    if (!segmenter.isValid()) {
+        QPainter::drawPath(path);
+        return;
+    }
+
+    // the dashes are lines only
+    const QBrush fill = brush();
+    if (fill.style() != Qt::NoBrush)
+        QPainter::fillPath(path, fill);
+    QPen solid = dashed;
+    solid.setStyle(Qt::SolidLine);
+    QPainter::setPen(solid);
+    QPainter::setBrush(Qt::NoBrush);
+    QPainter::drawPath(segmenter.segment(path));
+    QPainter::setBrush(fill);
+    QPainter::setPen(original);
+}
+
+QRectF RS_PainterQt::clipArea() const
+{
+    // caps and joins reach out by the pen width
+    const double margin = std::max(pen().widthF(), 1.) + 2.;
+    const QRectF device{-margin, -margin, getWidth() + 2. * margin, getHeight() + 2. * margin};
+    const QTransform& t = transform();
+    return t.isIdentity() ? device : t.inverted().mapRect(device);
+}
+
+void RS_PainterQt::strokeClippedArc(const QPointF& center, double radius, double a1, double a2)
+{
+    // each part continues the dash pattern from the start of the arc
+    for (const auto& [b1, b2]: LC_Clipping::clipArc(clipArea(), center, radius, a1, a2)) {
+        QPainterPath path;
+        addArcPart(path, center, radius, b1, b2);
+        strokePath(path, radius * (b1 - a1));
+    }
+}
+
 void RS_PainterQt::setClipRect(int x, int y, int w, int h) {
+    flushBatch();
     QPainter::setClipRect(x, y, w, h);
     setClipping(true);
 }
 
 void RS_PainterQt::resetClipping() {
+    flushBatch();
     setClipping(false);
 }
 
 void RS_PainterQt::fillRect ( const QRectF & rectangle, const RS_Color & color ) {
+        submitPrimitive();
 
         double x1=rectangle.left();
         double x2=rectangle.right();
@@ -971,6 +1272,7 @@ void RS_PainterQt::fillRect ( const QRectF & rectangle, const RS_Color & color )
         QPainter::fillRect(toScreenX(x1),toScreenY(y1),toScreenX(x2)-toScreenX(x1),toScreenY(y2)-toScreenX(y1), color);
 }
 void RS_PainterQt::fillRect ( const QRectF & rectangle, const QBrush & brush ) {
+        submitPrimitive();
         double x1=rectangle.left();
         double x2=rectangle.right();
         double y1=rectangle.top();
@@ -1082,20 +1384,20 @@ QPainterPath RS_PainterQt::createSpline(const RS_Spline& spline, const RS_Graphi
         return {vGui.x, vGui.y};
     };
 
-    RS_Entity* e=spline.firstEntity(RS2::ResolveNone);
-    do {
-        auto line = dynamic_cast<RS_Line*>(e);
-        if (line == nullptr)
-            break;
+    // a quarter pixel tolerance
+    const auto vertices = spline.getTessellation(0.25 * std::abs(view.toGraphDX(1)));
+    for (const RS_Vector& vp: *vertices) {
         if (path.isEmpty())
-            path.moveTo(toGui(line->getStartpoint()));
-        path.lineTo(toGui(line->getEndpoint()));
-    } while ((e = spline.nextEntity(RS2::ResolveNone)) != nullptr);
+            path.moveTo(toGui(vp));
+        else
+            path.lineTo(toGui(vp));
+    }
     return path;
 }
 
 void RS_PainterQt::drawText(const QRect& rect, const QString& text, QRect* boundingBox)
 {
+    submitPrimitive();
     QPainter::drawText(rect, Qt::AlignTop | Qt::AlignLeft | Qt::TextDontClip, text, boundingBox);
 }
 
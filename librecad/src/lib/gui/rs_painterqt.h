@@ -28,6 +28,10 @@
 #ifndef RS_PAINTERQT_H
 #define RS_PAINTERQT_H
 
+#include <map>
+#include <tuple>
+#include <vector>
+
 #include <QPainter>
 #include <QPainterPath>
 
@@ -46,11 +50,15 @@ class RS_PainterQt: public QPainter, public RS_Painter {
 
 public:
     RS_PainterQt( QPaintDevice* pd);
-    virtual ~RS_PainterQt()=default;
+    virtual ~RS_PainterQt();
+
+    void beginBatch() override;
+    void endBatch() override;
 
     void moveTo(int x, int y) override;
     void lineTo(int x, int y) override;
     void drawGridPoint(const RS_Vector& p) override;
+    void drawGridPoints(const std::vector<RS_Vector>& points) override;
     void drawPoint(const RS_Vector& p, int pdmode, int pdsize) override;
     void drawLine(const RS_Vector& p1, const RS_Vector& p2) override;
     //virtual void drawRect(const RS_Vector& p1, const RS_Vector& p2);
@@ -121,7 +129,29 @@ protected:
 
     QPainterPath createSplinePoints(const LC_SplinePointsData& data) const;
     QPainterPath createSpline(const RS_Spline& spline, const RS_GraphicView& view) const;
+    // draws the outline of the path, dashed paths by LC_DashSegmenter. The dash pattern starts at
+    // the distance dashStart, for paths clipped from a longer outline
+    void strokePath(const QPainterPath& path, double dashStart = 0.);
+    // the area drawn into, in painter coordinates, grown by the pen width: entities far outside the
+    // view at deep zoom are clipped to it before they're passed to QPainter, see LC_Clipping
+    QRectF clipArea() const;
+    // strokes the parts of the circular arc from a1 to a2 within clipArea()
+    void strokeClippedArc(const QPointF& center, double radius, double a1, double a2);
+    // draws the lines collected while batching
+    void flushBatch();
+    // counts a primitive, drawing the collected lines before it
+    void submitPrimitive();
     RS_Pen lpen;
+    // QPen objects created by setPen(const RS_Pen&), by color, screen width and line type
+    std::map<std::tuple<unsigned, int, int>, QPen> penCache;
+    // the pen last set by setPen(const RS_Pen&), to skip setting it again
+    RS_Pen requestedPen;
+    RS2::DrawingMode requestedMode = RS2::ModeFull;
+    bool requestedPenValid = false;
+    // solid lines collected while batching, all drawn by batchPen
+    bool batching = false;
+    std::vector<QLineF> batchLines;
+    QPen batchPen;
     long rememberX = 0; // Used for the moment because QPainter doesn't support moveTo anymore, thus we need to remember ourselves the moveTo positions
     long rememberY = 0;
 };
@@ -78,3 +78,9 @@ void RS_StaticGraphicView::paint() {
     RS_DEBUG->print("RS_StaticGraphicView::paint end");
 }
 
+void RS_StaticGraphicView::setViewport(int w, int h, int ox, int oy) {
+    width = w;
+    height = h;
+    setOffset(ox, oy);
+    view_rect = LC_Rect(toGraph(0, 0), toGraph(width, height));
+}
@@ -49,6 +49,13 @@ public:
 
     void paint();
 
+    /**
+     * @brief setViewport - resize the view and move the drawing, for rendering a part of another view
+     * @param w, h - the new size in pixels
+     * @param ox, oy - the new offset
+     */
+    void setViewport(int w, int h, int ox, int oy);
+
 private:
     //! Width
     int width = 0;
@@ -0,0 +1,139 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+
+#include "lc_intersections.h"
+#include "lc_spatialindex.h"
+#include "rs_entity.h"
+#include "rs_information.h"
+#include "rs_math.h"
+
+namespace {
+
+// an entity taking part in the sweep, with its bounding box grown by the tolerance
+struct SweepItem {
+    RS_Entity* entity = nullptr;
+    // the input set of the entity, 0 or 1
+    int set = 0;
+    // the position in the input set
+    size_t index = 0;
+    double minX = 0.;
+    double maxX = 0.;
+    double minY = 0.;
+    double maxY = 0.;
+};
+
+SweepItem makeItem(RS_Entity* entity, int set, size_t index)
+{
+    const RS_Vector min = entity->getMin();
+    const RS_Vector max = entity->getMax();
+    return {entity, set, index,
+            min.x - RS_TOLERANCE, max.x + RS_TOLERANCE,
+            min.y - RS_TOLERANCE, max.y + RS_TOLERANCE};
+}
+
+void intersect(const SweepItem& item0, const SweepItem& item1, std::vector<LC_Intersection>& result)
+{
+    // keep the pairs ordered by the input sets, and the input order within a set
+    const bool swapped = item0.set != item1.set ? item0.set > item1.set : item0.index > item1.index;
+    const SweepItem& first = swapped ? item1 : item0;
+    const SweepItem& second = swapped ? item0 : item1;
+
+    RS_VectorSolutions sol = RS_Information::getIntersection(first.entity, second.entity, true);
+    if (sol.hasValid())
+        result.push_back({first.entity, second.entity, std::move(sol)});
+}
+
+/**
+ * Sweeps the boxes of the entities along x. An entity is tested against the active entities, whose
+ * x range reaches its minimum x, and which either come from the other set, or from the same set for
+ * all pairs queries.
+ */
+std::vector<LC_Intersection> sweep(const std::vector<RS_Entity*>& entities1,
+                                   const std::vector<RS_Entity*>& entities2,
+                                   bool allPairs)
+{
+    std::vector<LC_Intersection> result;
+    std::vector<SweepItem> items;
+    std::vector<SweepItem> unbounded;
+    items.reserve(entities1.size() + entities2.size());
+
+    const std::vector<RS_Entity*>* sets[2] = {&entities1, &entities2};
+    for (int set = 0; set < (allPairs ? 1 : 2); ++set) {
+        for (size_t i = 0; i < sets[set]->size(); ++i) {
+            RS_Entity* entity = (*sets[set])[i];
+            if (entity == nullptr)
+                continue;
+            if (LC_SpatialIndex::hasValidBox(*entity))
+                items.push_back(makeItem(entity, set, i));
+            else
+                unbounded.push_back({entity, set, i});
+        }
+    }
+
+    auto isPair = [allPairs](const SweepItem& item0, const SweepItem& item1) {
+        return allPairs || item0.set != item1.set;
+    };
+
+    // entities without a box are paired with everything else
+    for (size_t i = 0; i < unbounded.size(); ++i) {
+        for (const SweepItem& item: items) {
+            if (isPair(unbounded[i], item))
+                intersect(unbounded[i], item, result);
+        }
+        for (size_t j = i + 1; j < unbounded.size(); ++j) {
+            if (isPair(unbounded[i], unbounded[j]))
+                intersect(unbounded[i], unbounded[j], result);
+        }
+    }
+
+    std::sort(items.begin(), items.end(), [](const SweepItem& item0, const SweepItem& item1) {
+        return item0.minX < item1.minX;
+    });
+
+    std::vector<const SweepItem*> active;
+    for (const SweepItem& item: items) {
+        active.erase(std::remove_if(active.begin(), active.end(), [&item](const SweepItem* other) {
+            return other->maxX < item.minX;
+        }), active.end());
+        for (const SweepItem* other: active) {
+            if (isPair(item, *other) && other->minY <= item.maxY && item.minY <= other->maxY)
+                intersect(item, *other, result);
+        }
+        active.push_back(&item);
+    }
+    return result;
+}
+}
+
+std::vector<LC_Intersection> LC_Intersections::findAll(const std::vector<RS_Entity*>& entities)
+{
+    return sweep(entities, {}, true);
+}
+
+std::vector<LC_Intersection> LC_Intersections::findBetween(const std::vector<RS_Entity*>& entities1,
+                                                           const std::vector<RS_Entity*>& entities2)
+{
+    return sweep(entities1, entities2, false);
+}
@@ -0,0 +1,66 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_INTERSECTIONS_H
+#define LC_INTERSECTIONS_H
+
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+
+/**
+ * @brief The LC_Intersection struct, the intersection points of two entities
+ */
+struct LC_Intersection {
+    RS_Entity* first = nullptr;
+    RS_Entity* second = nullptr;
+    RS_VectorSolutions points;
+};
+
+/**
+ * @brief The LC_Intersections class, intersections of sets of entities in one call.
+ *
+ * The bounding boxes of the entities are swept in the x direction, so only pairs, whose boxes
+ * overlap, are passed to RS_Information::getIntersection(). Entities without a valid bounding
+ * box, like construction lines, are paired with all other entities. Intersections are always
+ * found on the entities.
+ */
+class LC_Intersections {
+public:
+    /**
+     * @brief findAll - the intersections of all pairs of the given entities
+     * @return pairs with at least one valid intersection point, first is before second in the input
+     */
+    static std::vector<LC_Intersection> findAll(const std::vector<RS_Entity*>& entities);
+
+    /**
+     * @brief findBetween - the intersections of the entities of one set with the entities of the other
+     * @return pairs with at least one valid intersection point, first is from entities1, second from entities2
+     */
+    static std::vector<LC_Intersection> findBetween(const std::vector<RS_Entity*>& entities1,
+                                                    const std::vector<RS_Entity*>& entities2);
+};
+
+#endif // LC_INTERSECTIONS_H
@@ -0,0 +1,103 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+
+#include "lc_preparedcontour.h"
+#include "lc_spatialindex.h"
+#include "rs_entitycontainer.h"
+#include "rs_information.h"
+#include "rs_line.h"
+#include "rs_math.h"
+
+namespace {
+// the number of bands is limited, as entities spanning many bands are stored in all of them
+constexpr size_t maxBandCount = 256;
+}
+
+LC_PreparedContour::LC_PreparedContour(RS_EntityContainer& contour):
+    m_contour{contour}
+    , m_min{contour.getMin()}
+    , m_max{contour.getMax()}
+    // the same ray length as RS_Information::isPointInsideContour()
+    , m_rayLength{(contour.getSize().x + 1.0) * 10.0}
+{
+    std::vector<RS_Entity*> entities;
+    for (RS_Entity* e = contour.firstEntity(RS2::ResolveAll); e; e = contour.nextEntity(RS2::ResolveAll))
+        entities.push_back(e);
+
+    const double height = m_max.y - m_min.y;
+    const size_t bandCount = std::isfinite(height) && height > RS_TOLERANCE
+            ? std::clamp<size_t>(entities.size(), 1, maxBandCount) : 1;
+    m_bandHeight = bandCount > 1 ? height / bandCount : 0.;
+    m_bands.resize(bandCount);
+
+    for (RS_Entity* e: entities) {
+        if (!LC_SpatialIndex::hasValidBox(*e)) {
+            for (auto& band: m_bands)
+                band.push_back({e, RS_MAXDOUBLE});
+            continue;
+        }
+        // the boxes are grown by the tolerance of the bounding box check of the intersection
+        const size_t first = getBand(e->getMin().y - RS_TOLERANCE);
+        const size_t last = getBand(e->getMax().y + RS_TOLERANCE);
+        for (size_t i = first; i <= last; ++i)
+            m_bands[i].push_back({e, e->getMax().x + RS_TOLERANCE});
+    }
+}
+
+size_t LC_PreparedContour::getBand(double y) const
+{
+    if (m_bandHeight <= 0.)
+        return 0;
+    const double band = std::floor((y - m_min.y) / m_bandHeight);
+    return size_t(std::clamp(band, 0., double(m_bands.size() - 1)));
+}
+
+bool LC_PreparedContour::isInside(const RS_Vector& point, bool* onContour) const
+{
+    if (point.x < m_min.x || point.x > m_max.x ||
+            point.y < m_min.y || point.y > m_max.y) {
+        return false;
+    }
+
+    const RS_Line ray{point, point + RS_Vector{m_rayLength, 0.}};
+    bool sure = true;
+    int counter = 0;
+    if (onContour)
+        *onContour = false;
+
+    for (const Edge& edge: m_bands[getBand(point.y)]) {
+        // the ray can't reach entities left of the point
+        if (edge.maxX < point.x)
+            continue;
+        counter += RS_Information::getRayCrossings(ray, point, edge.entity, sure, onContour);
+    }
+
+    if (!sure) {
+        std::lock_guard<std::mutex> lock(m_fallbackMutex);
+        return RS_Information::isPointInsideContour(point, &m_contour, onContour);
+    }
+    return (counter % 2) == 1;
+}
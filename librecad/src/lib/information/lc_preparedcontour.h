@@ -0,0 +1,69 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_PREPAREDCONTOUR_H
+#define LC_PREPAREDCONTOUR_H
+
+#include <mutex>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_EntityContainer;
+
+/**
+ * @brief The LC_PreparedContour class, a contour prepared for many point inside queries.
+ *
+ * The atomic entities of the contour are bucketed into horizontal bands by their bounding boxes.
+ * A query casts a horizontal ray, as RS_Information::isPointInsideContour() does first, and only
+ * tests the entities in the band of the point. When the ray isn't conclusive, the query falls back
+ * to RS_Information::isPointInsideContour(), so both always agree.
+ *
+ * The contour must not change while it's prepared. Queries may run concurrently, the fallbacks,
+ * iterating the contour, are serialized.
+ */
+class LC_PreparedContour {
+public:
+    explicit LC_PreparedContour(RS_EntityContainer& contour);
+
+    bool isInside(const RS_Vector& point, bool* onContour = nullptr) const;
+
+private:
+    struct Edge {
+        RS_Entity* entity = nullptr;
+        double maxX = 0.;
+    };
+
+    size_t getBand(double y) const;
+
+    RS_EntityContainer& m_contour;
+    RS_Vector m_min;
+    RS_Vector m_max;
+    double m_rayLength = 0.;
+    double m_bandHeight = 0.;
+    std::vector<std::vector<Edge>> m_bands;
+    mutable std::mutex m_fallbackMutex;
+};
+
+#endif // LC_PREPAREDCONTOUR_H
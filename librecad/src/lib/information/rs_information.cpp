@@ -42,6 +42,98 @@
 #include "lc_rect.h"
 #include "rs_debug.h"
 
+namespace {
+/**
+ * Entity types with a specialised intersection solver. The line segments
+ * of splines are lines.
+ */
+enum CurveKind {
+    KindLine,
+    KindArc,
+    KindCircle,
+    KindEllipse,
+    KindCount
+};
+
+int curveKind(RS_Entity const* e) {
+    switch (e->rtti()) {
+    case RS2::EntityLine:
+        return KindLine;
+    case RS2::EntityArc:
+        return KindArc;
+    case RS2::EntityCircle:
+        return KindCircle;
+    case RS2::EntityEllipse:
+        return KindEllipse;
+    default:
+        return KindCount;
+    }
+}
+
+using IntersectionSolver = RS_VectorSolutions (*)(RS_Entity const*, RS_Entity const*);
+
+RS_VectorSolutions lineLine(RS_Entity const* e1, RS_Entity const* e2) {
+    return RS_Information::getIntersectionLineLine(static_cast<RS_Line const*>(e1),
+                                                   static_cast<RS_Line const*>(e2));
+}
+
+RS_VectorSolutions lineArc(RS_Entity const* e1, RS_Entity const* e2) {
+    return RS_Information::getIntersectionLineArc(static_cast<RS_Line const*>(e1), e2);
+}
+
+RS_VectorSolutions arcLine(RS_Entity const* e1, RS_Entity const* e2) {
+    return lineArc(e2, e1);
+}
+
+RS_VectorSolutions lineEllipse(RS_Entity const* e1, RS_Entity const* e2) {
+    return RS_Information::getIntersectionEllipseLine(static_cast<RS_Line const*>(e1),
+                                                      static_cast<RS_Ellipse const*>(e2));
+}
+
+RS_VectorSolutions ellipseLine(RS_Entity const* e1, RS_Entity const* e2) {
+    return lineEllipse(e2, e1);
+}
+
+RS_VectorSolutions arcArc(RS_Entity const* e1, RS_Entity const* e2) {
+    return RS_Information::getIntersectionArcArc(e1, e2);
+}
+
+RS_VectorSolutions arcEllipse(RS_Entity const* e1, RS_Entity const* e2) {
+    return RS_Information::getIntersectionArcEllipse(static_cast<RS_Arc const*>(e1),
+                                                     static_cast<RS_Ellipse const*>(e2));
+}
+
+RS_VectorSolutions ellipseArc(RS_Entity const* e1, RS_Entity const* e2) {
+    return arcEllipse(e2, e1);
+}
+
+RS_VectorSolutions circleEllipse(RS_Entity const* e1, RS_Entity const* e2) {
+    return RS_Information::getIntersectionCircleEllipse(static_cast<RS_Circle const*>(e1),
+                                                        static_cast<RS_Ellipse const*>(e2));
+}
+
+RS_VectorSolutions ellipseCircle(RS_Entity const* e1, RS_Entity const* e2) {
+    return circleEllipse(e2, e1);
+}
+
+RS_VectorSolutions ellipseEllipse(RS_Entity const* e1, RS_Entity const* e2) {
+    return RS_Information::getIntersectionEllipseEllipse(static_cast<RS_Ellipse const*>(e1),
+                                                         static_cast<RS_Ellipse const*>(e2));
+}
+
+/**
+ * Solvers by the curve kinds of both entities, so a pair is dispatched by
+ * a single lookup instead of building two general conics.
+ */
+constexpr IntersectionSolver intersectionSolvers[KindCount][KindCount] = {
+    // KindLine    KindArc      KindCircle     KindEllipse
+    {lineLine,    lineArc,     lineArc,       lineEllipse},    // KindLine
+    {arcLine,     arcArc,      arcArc,        arcEllipse},     // KindArc
+    {arcLine,     arcArc,      arcArc,        circleEllipse},  // KindCircle
+    {ellipseLine, ellipseArc,  ellipseCircle, ellipseEllipse}  // KindEllipse
+};
+}
+
 /**
  * Default constructor.
  *
@@ -267,17 +359,13 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
 	else
 	{
 		// issue #484 , quadratic intersection solver is not robust enough for quadratic-quadratic
-		// TODO, implement a robust algorithm for quadratic based solvers, and detecting entity type
-		// circles/arcs can be removed
-		auto isArc = [](RS_Entity const* e) {
-			auto type = e->rtti();
-			return type == RS2::EntityCircle || type == RS2::EntityArc;
-		};
-
-		if(isArc(e1) && isArc(e2)){
-			//use specialized arc-arc intersection solver
-			ret=getIntersectionArcArc(e1, e2);
-		}else{
+		// use the specialized solvers for lines, arcs, circles and ellipses, general conics
+		// are only built for the other entity types
+		const int kind1 = curveKind(e1);
+		const int kind2 = curveKind(e2);
+		if (kind1 != KindCount && kind2 != KindCount) {
+			ret = intersectionSolvers[kind1][kind2](e1, e2);
+		} else {
 			const auto qf1=e1->getQuadratic();
 			const auto qf2=e2->getQuadratic();
 			ret=LC_Quadratic::getIntersection(qf1,qf2);
@@ -337,8 +425,8 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
 /**
  * @return Intersection between two lines.
  */
-RS_VectorSolutions RS_Information::getIntersectionLineLine(RS_Line* e1,
-        RS_Line* e2) {
+RS_VectorSolutions RS_Information::getIntersectionLineLine(RS_Line const* e1,
+        RS_Line const* e2) {
 
     RS_VectorSolutions ret;
 
@@ -375,10 +463,10 @@ RS_VectorSolutions RS_Information::getIntersectionLineLine(RS_Line* e1,
 
 
 /**
- * @return One or two intersection points between given entities.
+ * @return One or two intersection points between a line and an arc or circle.
  */
-RS_VectorSolutions RS_Information::getIntersectionLineArc(RS_Line* line,
-        RS_Arc* arc) {
+RS_VectorSolutions RS_Information::getIntersectionLineArc(RS_Line const* line,
+        RS_Entity const* arc) {
 
     RS_VectorSolutions ret;
 
@@ -647,8 +735,8 @@ RS_VectorSolutions RS_Information::getIntersectionEllipseEllipse(
 }
 
 //wrapper to do Circle-Ellipse and Arc-Ellipse using Ellipse-Ellipse intersection
-RS_VectorSolutions RS_Information::getIntersectionCircleEllipse(RS_Circle* c1,
-        RS_Ellipse* e1) {
+RS_VectorSolutions RS_Information::getIntersectionCircleEllipse(RS_Circle const* c1,
+        RS_Ellipse const* e1) {
     RS_VectorSolutions ret;
 	if (!(c1 && e1)) return ret;
 
@@ -660,8 +748,8 @@ RS_VectorSolutions RS_Information::getIntersectionCircleEllipse(RS_Circle* c1,
 	return getIntersectionEllipseEllipse(e1, &e2);
 }
 
-RS_VectorSolutions RS_Information::getIntersectionArcEllipse(RS_Arc * a1,
-        RS_Ellipse* e1) {
+RS_VectorSolutions RS_Information::getIntersectionArcEllipse(RS_Arc const* a1,
+        RS_Ellipse const* e1) {
     RS_VectorSolutions ret;
 	if (!(a1 && e1)) {
         return ret;
@@ -682,8 +770,8 @@ RS_VectorSolutions RS_Information::getIntersectionArcEllipse(RS_Arc * a1,
 /**
  * @return One or two intersection points between given entities.
  */
-RS_VectorSolutions RS_Information::getIntersectionEllipseLine(RS_Line* line,
-        RS_Ellipse* ellipse) {
+RS_VectorSolutions RS_Information::getIntersectionEllipseLine(RS_Line const* line,
+        RS_Ellipse const* ellipse) {
 
     RS_VectorSolutions ret;
 
@@ -708,6 +796,10 @@ RS_VectorSolutions RS_Information::getIntersectionEllipseLine(RS_Line* line,
     RS_Vector a2 = line->getEndpoint().rotate(center, angleVector);
 //    RS_Vector origin = a1;
     RS_Vector dir = a2-a1;
+    if (dir.squared() < RS_TOLERANCE2) {
+        //degenerate line
+        return ret;
+    }
     RS_Vector diff = a1 - center;
     RS_Vector mDir = RS_Vector(dir.x/(rx*rx), dir.y/(ry*ry));
     RS_Vector mDiff = RS_Vector(diff.x/(rx*rx), diff.y/(ry*ry));
@@ -779,123 +871,13 @@ bool RS_Information::isPointInsideContour(const RS_Vector& point,
 		RS_Vector v = RS_Vector::polar(width*10.0, rayAngle);
 		RS_Line ray{point, point+v};
         counter = 0;
-        RS_VectorSolutions sol;
 
 		if (onContour) {
             *onContour = false;
         }
 
-        for (RS_Entity* e = contour->firstEntity(RS2::ResolveAll);
-				e;
-                e = contour->nextEntity(RS2::ResolveAll)) {
-
-            // intersection(s) from ray with contour entity:
-            sol = RS_Information::getIntersection(&ray, e, true);
-
-            for (int i=0; i<=1; ++i) {
-                RS_Vector p = sol.get(i);
-
-                if (p.valid) {
-                    // point is on the contour itself
-                    if (p.distanceTo(point)<1.0e-5) {
-						if (onContour) {
-                            *onContour = true;
-                        }
-                    } else {
-                        if (e->rtti()==RS2::EntityLine) {
-                            RS_Line* line = (RS_Line*)e;
-
-                            // ray goes through startpoint of line:
-                            if (p.distanceTo(line->getStartpoint())<1.0e-4) {
-                                if (RS_Math::correctAngle(line->getAngle1())<M_PI) {
-                                    sure = false;
-                                }
-                            }
-
-                            // ray goes through endpoint of line:
-                            else if (p.distanceTo(line->getEndpoint())<1.0e-4) {
-                                if (RS_Math::correctAngle(line->getAngle2())<M_PI) {
-                                    sure = false;
-                                }
-                            }
-                            // else: ray goes through the line
-
-
-                                counter++;
-                            
-                        } else if (e->rtti()==RS2::EntityArc) {
-                            RS_Arc* arc = (RS_Arc*)e;
-
-                            if (p.distanceTo(arc->getStartpoint())<1.0e-4) {
-                                double dir = arc->getDirection1();
-                                if ((dir<M_PI && dir>=1.0e-5) ||
-                                        ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                         arc->getCenter().y>p.y)) {
-                                    counter++;
-                                    sure = false;
-                                }
-                            }
-                            else if (p.distanceTo(arc->getEndpoint())<1.0e-4) {
-                                double dir = arc->getDirection2();
-                                if ((dir<M_PI && dir>=1.0e-5) ||
-                                        ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                         arc->getCenter().y>p.y)) {
-                                    counter++;
-                                    sure = false;
-                                }
-                            } else {
-                                counter++;
-                            }
-                        } else if (e->rtti()==RS2::EntityCircle) {
-                            // tangent:
-                            if (i==0 && sol.get(1).valid==false) {
-                                if (!sol.isTangent()) {
-                                    counter++;
-                                } else {
-                                    sure = false;
-                                }
-                            } else if (i==1 || sol.get(1).valid==true) {
-                                counter++;
-                            }
-                        } else if (e->rtti()==RS2::EntityEllipse) {
-                            RS_Ellipse* ellipse=static_cast<RS_Ellipse*>(e);
-                            if(ellipse->isArc()){
-                                if (p.distanceTo(ellipse->getStartpoint())<1.0e-4) {
-                                    double dir = ellipse->getDirection1();
-                                    if ((dir<M_PI && dir>=1.0e-5) ||
-                                            ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                             ellipse->getCenter().y>p.y)) {
-                                        counter++;
-                                        sure = false;
-                                    }
-                                }
-                                else if (p.distanceTo(ellipse->getEndpoint())<1.0e-4) {
-                                    double dir = ellipse->getDirection2();
-                                    if ((dir<M_PI && dir>=1.0e-5) ||
-                                            ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
-                                             ellipse->getCenter().y>p.y)) {
-                                        counter++;
-                                        sure = false;
-                                    }
-                                } else {
-                                    counter++;
-                                }
-                            }else{
-                                // tangent:
-                                if (i==0 && sol.get(1).valid==false) {
-                                    if (!sol.isTangent()) {
-                                        counter++;
-                                    } else {
-                                        sure = false;
-                                    }
-                                } else if (i==1 || sol.get(1).valid==true) {
-                                    counter++;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+        for (RS_Entity* e: contour->getEntityRange(RS2::ResolveAll)) {
+            counter += getRayCrossings(ray, point, e, sure, onContour);
         }
 
         rayAngle+=0.02;
@@ -932,6 +914,123 @@ bool RS_Information::isPointInsideContour(const RS_Vector& point,
 }
 
 
+/**
+ * @return the number of crossings of a ray from a point with one entity of a contour.
+ */
+int RS_Information::getRayCrossings(const RS_Line& ray, const RS_Vector& point,
+									RS_Entity* e, bool& sure, bool* onContour) {
+    // intersection(s) from ray with contour entity:
+    RS_VectorSolutions sol = RS_Information::getIntersection(&ray, e, true);
+    int counter = 0;
+
+    for (int i=0; i<=1; ++i) {
+        RS_Vector p = sol.get(i);
+
+        if (p.valid) {
+            // point is on the contour itself
+            if (p.distanceTo(point)<1.0e-5) {
+				if (onContour) {
+                    *onContour = true;
+                }
+            } else {
+                if (e->rtti()==RS2::EntityLine) {
+                    RS_Line* line = (RS_Line*)e;
+
+                    // ray goes through startpoint of line:
+                    if (p.distanceTo(line->getStartpoint())<1.0e-4) {
+                        if (RS_Math::correctAngle(line->getAngle1())<M_PI) {
+                            sure = false;
+                        }
+                    }
+
+                    // ray goes through endpoint of line:
+                    else if (p.distanceTo(line->getEndpoint())<1.0e-4) {
+                        if (RS_Math::correctAngle(line->getAngle2())<M_PI) {
+                            sure = false;
+                        }
+                    }
+                    // else: ray goes through the line
+
+
+                        counter++;
+                    
+                } else if (e->rtti()==RS2::EntityArc) {
+                    RS_Arc* arc = (RS_Arc*)e;
+
+                    if (p.distanceTo(arc->getStartpoint())<1.0e-4) {
+                        double dir = arc->getDirection1();
+                        if ((dir<M_PI && dir>=1.0e-5) ||
+                                ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                 arc->getCenter().y>p.y)) {
+                            counter++;
+                            sure = false;
+                        }
+                    }
+                    else if (p.distanceTo(arc->getEndpoint())<1.0e-4) {
+                        double dir = arc->getDirection2();
+                        if ((dir<M_PI && dir>=1.0e-5) ||
+                                ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                 arc->getCenter().y>p.y)) {
+                            counter++;
+                            sure = false;
+                        }
+                    } else {
+                        counter++;
+                    }
+                } else if (e->rtti()==RS2::EntityCircle) {
+                    // tangent:
+                    if (i==0 && sol.get(1).valid==false) {
+                        if (!sol.isTangent()) {
+                            counter++;
+                        } else {
+                            sure = false;
+                        }
+                    } else if (i==1 || sol.get(1).valid==true) {
+                        counter++;
+                    }
+                } else if (e->rtti()==RS2::EntityEllipse) {
+                    RS_Ellipse* ellipse=static_cast<RS_Ellipse*>(e);
+                    if(ellipse->isArc()){
+                        if (p.distanceTo(ellipse->getStartpoint())<1.0e-4) {
+                            double dir = ellipse->getDirection1();
+                            if ((dir<M_PI && dir>=1.0e-5) ||
+                                    ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                     ellipse->getCenter().y>p.y)) {
+                                counter++;
+                                sure = false;
+                            }
+                        }
+                        else if (p.distanceTo(ellipse->getEndpoint())<1.0e-4) {
+                            double dir = ellipse->getDirection2();
+                            if ((dir<M_PI && dir>=1.0e-5) ||
+                                    ((dir>2*M_PI-1.0e-5 || dir<1.0e-5) &&
+                                     ellipse->getCenter().y>p.y)) {
+                                counter++;
+                                sure = false;
+                            }
+                        } else {
+                            counter++;
+                        }
+                    }else{
+                        // tangent:
+                        if (i==0 && sol.get(1).valid==false) {
+                            if (!sol.isTangent()) {
+                                counter++;
+                            } else {
+                                sure = false;
+                            }
+                        } else if (i==1 || sol.get(1).valid==true) {
+                            counter++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return counter;
+}
+
+
 RS_VectorSolutions RS_Information::createQuadrilateral(const RS_EntityContainer& container)
 {
 	RS_VectorSolutions ret;
@@ -70,11 +70,11 @@ public:
 			RS_Entity const* e2,
             bool onEntities = false);
 
-    static RS_VectorSolutions getIntersectionLineLine(RS_Line* e1,
-            RS_Line* e2);
+    static RS_VectorSolutions getIntersectionLineLine(RS_Line const* e1,
+            RS_Line const* e2);
 
-    static RS_VectorSolutions getIntersectionLineArc(RS_Line* line,
-            RS_Arc* arc);
+    static RS_VectorSolutions getIntersectionLineArc(RS_Line const* line,
+            RS_Entity const* arc);
 
 	static RS_VectorSolutions getIntersectionArcArc(RS_Entity const* e1,
 			RS_Entity const* e2);
@@ -82,13 +82,13 @@ public:
 	static RS_VectorSolutions getIntersectionEllipseEllipse(
 			RS_Ellipse const* e1,
 			RS_Ellipse const* e2);
-    static RS_VectorSolutions getIntersectionArcEllipse(RS_Arc* e1,
-            RS_Ellipse* e2);
-    static RS_VectorSolutions getIntersectionCircleEllipse(RS_Circle* e1,
-            RS_Ellipse* e2);
+    static RS_VectorSolutions getIntersectionArcEllipse(RS_Arc const* e1,
+            RS_Ellipse const* e2);
+    static RS_VectorSolutions getIntersectionCircleEllipse(RS_Circle const* e1,
+            RS_Ellipse const* e2);
     
-	static RS_VectorSolutions getIntersectionEllipseLine(RS_Line* line,
-            RS_Ellipse* ellipse);
+	static RS_VectorSolutions getIntersectionEllipseLine(RS_Line const* line,
+            RS_Ellipse const* ellipse);
 	/**
 	 * @brief createQuadrilateral form quadrilateral from 4 straight lines
 	 * @param container contains 4 straight lines
@@ -99,6 +99,14 @@ public:
     static bool isPointInsideContour(const RS_Vector& point,
                                      RS_EntityContainer* contour,
 									 bool* onContour=nullptr);
+	/**
+	 * @brief getRayCrossings the number of times a ray from a point crosses a contour entity
+	 * @param ray the ray, starting at point
+	 * @param sure set to false, if the ray passes an end point or touches the entity
+	 * @param onContour set to true, if the point is on the entity
+	 */
+	static int getRayCrossings(const RS_Line& ray, const RS_Vector& point,
+							   RS_Entity* e, bool& sure, bool* onContour);
 	
 private:
     RS_EntityContainer* container = nullptr;
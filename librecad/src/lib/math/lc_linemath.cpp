@@ -19,7 +19,9 @@ You should have received a copy of the GNU General Public License
 along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 **********************************************************************/
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
 #include "lc_linemath.h"
 #include "rs.h"
@@ -343,3 +345,53 @@ RS_Vector LC_LineMath::getIntersectionLineLine(const RS_Vector& s1, const RS_Vec
     RS_VectorSolutions sol = RS_Information::getIntersectionLineLine(&line1, &line2);
     return sol.empty() ? RS_Vector{false} : sol.at(0);
 }
+
+/**
+ * Simplifies a polyline by the Douglas-Peucker algorithm: vertices closer than the tolerance
+ * to the simplified polyline are removed. The first and the last vertex are always kept.
+ * @param points vertices of the polyline
+ * @param tolerance the maximum distance of removed vertices to the simplified polyline
+ * @return the kept vertices, in their original order
+ */
+std::vector<RS_Vector> LC_LineMath::simplifyPolyline(const std::vector<RS_Vector>& points, double tolerance){
+    if (points.size() < 3)
+        return points;
+    std::vector<bool> kept(points.size(), false);
+    kept.front() = kept.back() = true;
+    // ranges of vertices still to simplify, iterative to avoid deep recursion on long strokes
+    std::vector<std::pair<size_t, size_t>> ranges{{0, points.size() - 1}};
+    while (!ranges.empty()) {
+        const auto [first, last] = ranges.back();
+        ranges.pop_back();
+        const RS_Vector& start = points[first];
+        const RS_Vector direction = points[last] - start;
+        const double length2 = direction.squared();
+        double maxDistance = tolerance;
+        size_t farthest = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            // the distance to the segment, or to its start point, if it's degenerated
+            const RS_Vector offset = points[i] - start;
+            double t = length2 > RS_TOLERANCE2 ? RS_Vector::dotP(offset, direction) / length2 : 0.;
+            t = std::min(std::max(t, 0.), 1.);
+            const double distance = (offset - direction * t).magnitude();
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                farthest = i;
+            }
+        }
+        if (farthest == first)
+            continue;
+        kept[farthest] = true;
+        if (farthest - first > 1)
+            ranges.emplace_back(first, farthest);
+        if (last - farthest > 1)
+            ranges.emplace_back(farthest, last);
+    }
+
+    std::vector<RS_Vector> simplified;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (kept[i])
+            simplified.push_back(points[i]);
+    }
+    return simplified;
+}
@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef LC_LINEMATH_H
 #define LC_LINEMATH_H
 
+#include <vector>
+
 #include "rs_vector.h"
 #include "rs_line.h"
 
@@ -69,5 +71,7 @@ namespace LC_LineMath {
     RS_LineData createParallel(const RS_Vector& start, const RS_Vector& end, double distance);
     bool isMeaningfulDistance(const RS_Vector &v1, const RS_Vector &v2);
     bool isNotMeaningfulDistance(const RS_Vector &v1, const RS_Vector &v2);
+
+    std::vector<RS_Vector> simplifyPolyline(const std::vector<RS_Vector>& points, double tolerance);
 }
 #endif // LC_LINEMATH_H
@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <algorithm>
 #include <cfloat>
+#include <iostream>
 #include <numeric>
 #include <QDebug>
 #include "rs_math.h"
@@ -42,8 +43,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
 LC_Quadratic::LC_Quadratic():
-    m_mQuad(2,2),
-    m_vLinear(2),
+	m_bIsQuadratic(false),
 	m_bValid(false)
 {}
 
@@ -60,10 +60,8 @@ LC_Quadratic::LC_Quadratic(const LC_Quadratic& lc0):
 LC_Quadratic& LC_Quadratic::operator = (const LC_Quadratic& lc0)
 {
     if(lc0.isQuadratic()){
-        m_mQuad.resize(2,2,false);
         m_mQuad=lc0.getQuad();
     }
-    m_vLinear.resize(2);
     m_vLinear=lc0.getLinear();
     m_dConst=lc0.m_dConst;
     m_bIsQuadratic=lc0.isQuadratic();
@@ -72,9 +70,7 @@ LC_Quadratic& LC_Quadratic::operator = (const LC_Quadratic& lc0)
 }
 
 
-LC_Quadratic::LC_Quadratic(std::vector<double> ce):
-    m_mQuad(2,2),
-    m_vLinear(2)
+LC_Quadratic::LC_Quadratic(std::vector<double> ce)
 {
     if(ce.size()==6){
         //quadratic
@@ -107,9 +103,7 @@ LC_Quadratic::LC_Quadratic(std::vector<double> ce):
 *@return, a path of center tangential circles which pass the point
 */
 LC_Quadratic::LC_Quadratic(const RS_AtomicEntity* circle, const RS_Vector& point)
-    : m_mQuad(2,2)
-    ,m_vLinear(2)
-    ,m_bIsQuadratic(true)
+    : m_bIsQuadratic(true)
     ,m_bValid(true)
 {
 	if(circle==nullptr) {
@@ -233,22 +227,22 @@ bool LC_Quadratic::operator != (bool valid) const
 	return m_bValid != valid;
 }
 
-boost::numeric::ublas::vector<double>& LC_Quadratic::getLinear()
+LC_Quadratic::Vector2& LC_Quadratic::getLinear()
 {
 	return m_vLinear;
 }
 
-const boost::numeric::ublas::vector<double>& LC_Quadratic::getLinear() const
+const LC_Quadratic::Vector2& LC_Quadratic::getLinear() const
 {
 	return m_vLinear;
 }
 
-boost::numeric::ublas::matrix<double>& LC_Quadratic::getQuad()
+LC_Quadratic::Matrix2& LC_Quadratic::getQuad()
 {
 	return m_mQuad;
 }
 
-const boost::numeric::ublas::matrix<double>& LC_Quadratic::getQuad() const
+const LC_Quadratic::Matrix2& LC_Quadratic::getQuad() const
 {
 	return m_mQuad;
 }
@@ -268,8 +262,7 @@ double& LC_Quadratic::constTerm()
 LC_Quadratic::LC_Quadratic(const RS_AtomicEntity* circle0,
                            const RS_AtomicEntity* circle1,
                            bool mirror):
-    m_mQuad(2,2)
-    ,m_vLinear(2)
+    m_bIsQuadratic(false)
     ,m_bValid(false)
 {
 //    DEBUG_HEADER
@@ -437,13 +430,11 @@ LC_Quadratic LC_Quadratic::move(const RS_Vector& v)
 
 LC_Quadratic LC_Quadratic::rotate(const double& angle)
 {
-    using namespace boost::numeric::ublas;
-	auto m=rotationMatrix(angle);
-	auto t=trans(m);
-    m_vLinear = prod(t, m_vLinear);
+	const Matrix2 m=rotationMatrix(angle);
+	const Matrix2 t=m.transposed();
+    m_vLinear = t * m_vLinear;
     if(m_bIsQuadratic){
-        m_mQuad=prod(m_mQuad,m);
-        m_mQuad=prod(t, m_mQuad);
+        m_mQuad = t * (m_mQuad * m);
     }
     return *this;
 }
@@ -624,14 +615,11 @@ RS_VectorSolutions LC_Quadratic::getIntersection(const LC_Quadratic& l1, const L
    cos x, sin x
    -sin x, cos x
    */
-boost::numeric::ublas::matrix<double> LC_Quadratic::rotationMatrix(const double& angle)
+LC_Quadratic::Matrix2 LC_Quadratic::rotationMatrix(const double& angle)
 {
-    boost::numeric::ublas::matrix<double> ret(2,2);
-    ret(0,0)=cos(angle);
-    ret(0,1)=sin(angle);
-    ret(1,0)=-ret(0,1);
-    ret(1,1)=ret(0,0);
-    return ret;
+    const double c=cos(angle);
+    const double s=sin(angle);
+    return {c, s, -s, c};
 }
 
 /**
@@ -26,9 +26,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #define LC_QUADRATIC_H
 
 
+#include <array>
 #include "rs_vector.h"
-#include <boost/numeric/ublas/matrix.hpp>
-#include <boost/numeric/ublas/io.hpp>
 
 class RS_VectorSolutions;
 class RS_AtomicEntity;
@@ -41,6 +40,57 @@ class RS_AtomicEntity;
  */
 class LC_Quadratic {
 public:
+    /**
+     * 2x2 matrix on the stack, accessed by (row, column) like ublas
+     */
+    class Matrix2 {
+    public:
+        constexpr Matrix2() = default;
+        constexpr Matrix2(double m00, double m01, double m10, double m11):
+            m_data{{m00, m01, m10, m11}}
+        {}
+        constexpr double& operator () (size_t row, size_t column) {
+            return m_data[2 * row + column];
+        }
+        constexpr double operator () (size_t row, size_t column) const {
+            return m_data[2 * row + column];
+        }
+        constexpr Matrix2 transposed() const {
+            return {m_data[0], m_data[2], m_data[1], m_data[3]};
+        }
+        constexpr Matrix2 operator * (const Matrix2& m) const {
+            return {m_data[0]*m.m_data[0] + m_data[1]*m.m_data[2],
+                    m_data[0]*m.m_data[1] + m_data[1]*m.m_data[3],
+                    m_data[2]*m.m_data[0] + m_data[3]*m.m_data[2],
+                    m_data[2]*m.m_data[1] + m_data[3]*m.m_data[3]};
+        }
+    private:
+        std::array<double, 4> m_data{};
+    };
+
+    /**
+     * 2D column vector on the stack
+     */
+    class Vector2 {
+    public:
+        constexpr Vector2() = default;
+        constexpr Vector2(double v0, double v1):
+            m_data{{v0, v1}}
+        {}
+        constexpr double& operator () (size_t i) {
+            return m_data[i];
+        }
+        constexpr double operator () (size_t i) const {
+            return m_data[i];
+        }
+        friend constexpr Vector2 operator * (const Matrix2& m, const Vector2& v) {
+            return {m(0,0)*v.m_data[0] + m(0,1)*v.m_data[1],
+                    m(1,0)*v.m_data[0] + m(1,1)*v.m_data[1]};
+        }
+    private:
+        std::array<double, 2> m_data{};
+    };
+
     explicit LC_Quadratic();
     LC_Quadratic(const LC_Quadratic& lc0);
     LC_Quadratic& operator = (const LC_Quadratic& lc0);
@@ -86,10 +136,10 @@ public:
 	bool operator == (bool valid) const;
 	bool operator != (bool valid) const;
 
-	boost::numeric::ublas::vector<double>& getLinear();
-	 const boost::numeric::ublas::vector<double>& getLinear() const;
-	 boost::numeric::ublas::matrix<double>& getQuad();
-	 const boost::numeric::ublas::matrix<double>& getQuad() const;
+	Vector2& getLinear();
+	 const Vector2& getLinear() const;
+	 Matrix2& getQuad();
+	 const Matrix2& getQuad() const;
 	 double const& constTerm()const;
 	 double& constTerm();
 
@@ -106,7 +156,7 @@ public:
     LC_Quadratic getDualCurve() const;
 
     /** the matrix of rotation by angle **/
-    static boost::numeric::ublas::matrix<double> rotationMatrix(const double& angle);
+    static Matrix2 rotationMatrix(const double& angle);
 
     static RS_VectorSolutions getIntersection(const LC_Quadratic& l1, const LC_Quadratic& l2);
 
@@ -114,9 +164,9 @@ public:
 
 private:
     // the equation form: {x, y}.m_mQuad.{{x},{y}} + m_vLinear.{{x},{y}}+m_dConst=0
-    boost::numeric::ublas::matrix<double> m_mQuad;
-    boost::numeric::ublas::vector<double> m_vLinear;
-    double m_dConst;
+    Matrix2 m_mQuad;
+    Vector2 m_vLinear;
+    double m_dConst = 0.;
     bool m_bIsQuadratic;
     /** whether this quadratic form is valid */
     bool m_bValid;
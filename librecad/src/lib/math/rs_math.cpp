@@ -29,6 +29,8 @@
 #include <boost/math/special_functions/ellint_2.hpp>
 
 #include <cmath>
+#include <memory>
+#include <unordered_map>
 #include <muParser.h>
 #include <QString>
 #include <QRegularExpression>
@@ -62,6 +64,45 @@ const QRegularExpression unitreg(
                 R"((?:(?P<numer>\d+)\/(?P<denom>\d+))?)"                // rational inches
         R"((?:inches|inch|in|"))?$)))"
 	);
+
+/**
+ * Parsers of recently evaluated expressions, by the expression string. A parser compiles its
+ * expression to bytecode at the first evaluation, so repeated evaluations neither derationalize
+ * nor parse the expression again.
+ */
+class ExpressionCache {
+public:
+    mu::Parser* parser(const QString& expr)
+    {
+        auto it = m_parsers.find(expr);
+        if (it != m_parsers.end())
+            return it->second.get();
+        // option widgets evaluate few distinct expressions, start over instead of keeping usage
+        if (m_parsers.size() >= capacity)
+            m_parsers.clear();
+        auto p = std::make_unique<mu::Parser>();
+        p->DefineConst(_T("pi"),M_PI);
+        const QString derationalized = RS_Math::derationalize(expr);
+#ifdef _UNICODE
+        p->SetExpr(derationalized.toStdWString());
+#else
+        p->SetExpr(derationalized.toStdString());
+#endif
+        return m_parsers.emplace(expr, std::move(p)).first->second.get();
+    }
+
+    void remove(const QString& expr)
+    {
+        m_parsers.erase(expr);
+    }
+
+private:
+    static constexpr size_t capacity = 64;
+    std::unordered_map<QString, std::unique_ptr<mu::Parser>> m_parsers;
+};
+
+// parsers aren't thread safe
+thread_local ExpressionCache expressionCache;
 }
 
 /**
@@ -344,24 +385,18 @@ double RS_Math::eval(const QString& expr, bool* ok) {
         return 0.0;
     }
 
-    QString derationalized = derationalize(expr);
     //expr = normalizedUnitsExpression(expr);
 
     double ret(0.);
     try{
-        mu::Parser p;
-        p.DefineConst(_T("pi"),M_PI);
-#ifdef _UNICODE
-        p.SetExpr(derationalized.toStdWString());
-#else
-        p.SetExpr(derationalized.toStdString());
-#endif
-        ret=p.Eval();
+        ret=expressionCache.parser(expr)->Eval();
         *ok=true;
     }
     catch (mu::Parser::exception_type &e)
     {
         mu::console() << e.GetMsg() << std::endl;
+        // invalid expressions are parsed again, to report the error again
+        expressionCache.remove(expr);
         *ok=false;
     }
     return ret;
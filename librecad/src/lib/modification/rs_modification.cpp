@@ -23,6 +23,10 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <unordered_map>
 #include<cmath>
 
 #include <QSet>
@@ -35,9 +39,11 @@
 #include "rs_clipboard.h"
 #include "rs_creation.h"
 #include "rs_debug.h"
+#include "rs_dimension.h"
 #include "rs_ellipse.h"
 #include "rs_graphicview.h"
 #include "rs_graphic.h"
+#include "rs_hatch.h"
 #include "rs_information.h"
 #include "rs_insert.h"
 #include "rs_layer.h"
@@ -47,7 +53,11 @@
 #include "rs_polyline.h"
 #include "rs_text.h"
 #include "rs_units.h"
+#include "lc_attributeschange.h"
+#include "lc_parallel.h"
+#include "lc_spatialindex.h"
 #include "lc_splinepoints.h"
+#include "lc_transformchange.h"
 #include "lc_undosection.h"
 
 #ifdef EMU_C99
@@ -56,6 +66,122 @@
 
 namespace {
 
+// number of entities offset by a worker thread at once
+constexpr size_t offsetChunkSize = 16;
+// number of entities cloned and transformed by a worker thread at once
+constexpr size_t transformChunkSize = 64;
+// number of added entities, from which the spatial index is rebuilt instead of updated
+constexpr size_t bulkAddMinimum = 1024;
+
+// whether the entity is transformed by its geometry only, without shared data like fonts, blocks or
+// hatch patterns, so its clones can be transformed concurrently
+bool isPlainGeometry(const RS_Entity& entity)
+{
+    return (entity.isAtomic() && entity.rtti() != RS2::EntityImage) || entity.rtti() == RS2::EntityPolyline;
+}
+
+/**
+ * @brief transformClones - clones of the entities, transformed for each copy
+ * @param transform - called with a clone and the copy number, starting at 1
+ * @return the clones of all entities of the first copy, then of the second copy, and so on
+ */
+template<typename Transform>
+std::vector<RS_Entity*> transformClones(const std::vector<RS_Entity*>& originals, int copies,
+                                        Transform transform)
+{
+    std::vector<RS_Entity*> clones(originals.size() * size_t(std::max(copies, 0)), nullptr);
+    auto transformClone = [&originals, &clones, &transform](size_t i) {
+        RS_Entity* ec = originals[i % originals.size()]->clone();
+        transform(*ec, int(i / originals.size()) + 1);
+        clones[i] = ec;
+    };
+    LC_Parallel::forEach(clones.size(), transformChunkSize, [&originals, &transformClone](size_t i) {
+        if (isPlainGeometry(*originals[i % originals.size()]))
+            transformClone(i);
+    });
+    for (size_t i = 0; i < clones.size(); ++i) {
+        if (clones[i] == nullptr)
+            transformClone(i);
+    }
+    return clones;
+}
+
+/**
+ * Geometry of a line, arc or circle, or the carrier line of a line, quantised by a tolerance, so
+ * entities equal within the tolerance have the same key, unless they straddle a quantisation step
+ */
+struct OverkillKey {
+    RS2::EntityType type = RS2::EntityUnknown;
+    const RS_Layer* layer = nullptr;
+    std::array<long long, 6> values{};
+
+    bool operator == (const OverkillKey& other) const
+    {
+        return type == other.type && layer == other.layer && values == other.values;
+    }
+};
+
+struct OverkillKeyHash {
+    size_t operator () (const OverkillKey& key) const
+    {
+        size_t seed = std::hash<int>{}(key.type) ^ (std::hash<const void*>{}(key.layer) << 1);
+        for (long long value: key.values)
+            seed ^= std::hash<long long>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+long long quantise(double value, double tolerance)
+{
+    return std::llround(value / tolerance);
+}
+
+// the key of a line, arc or circle, the same for reversed lines and arcs
+OverkillKey duplicateKey(const RS_Entity& entity, double tolerance)
+{
+    OverkillKey key{entity.rtti(), entity.getLayer(false), {}};
+    auto setPoint = [&key, tolerance](size_t i, const RS_Vector& point) {
+        key.values[i] = quantise(point.x, tolerance);
+        key.values[i + 1] = quantise(point.y, tolerance);
+    };
+    switch (entity.rtti()) {
+    case RS2::EntityLine: {
+        setPoint(0, entity.getStartpoint());
+        setPoint(2, entity.getEndpoint());
+        const std::array<long long, 2> start{key.values[0], key.values[1]};
+        const std::array<long long, 2> end{key.values[2], key.values[3]};
+        if (end < start) {
+            setPoint(0, entity.getEndpoint());
+            setPoint(2, entity.getStartpoint());
+        }
+        break;
+    }
+    case RS2::EntityArc: {
+        const auto& arc = static_cast<const RS_Arc&>(entity);
+        // counterclockwise from the start to the end point
+        setPoint(0, arc.getCenter());
+        setPoint(2, arc.isReversed() ? arc.getEndpoint() : arc.getStartpoint());
+        setPoint(4, arc.isReversed() ? arc.getStartpoint() : arc.getEndpoint());
+        break;
+    }
+    default:
+        setPoint(0, entity.getCenter());
+        key.values[2] = quantise(entity.getRadius(), tolerance);
+        break;
+    }
+    return key;
+}
+
+// a line, and the range it covers along its carrier line
+struct CollinearSpan {
+    RS_Line* line = nullptr;
+    size_t penIndex = 0;
+    double from = 0.;
+    double to = 0.;
+    RS_Vector fromPoint;
+    RS_Vector toPoint;
+};
+
 /**
  * @brief getPasteScale - find scaling factor for pasting
  * @param const RS_PasteData& data - RS_PasteData
@@ -268,7 +394,7 @@ void RS_Modification::remove()
     LC_UndoSection undo(document);
     bool invalidContainer {true};
 	// not safe (?)
-    for (auto* e : *container)
+    for (auto* e : container->getSelectedEntities())
     {
         if (e != nullptr && e->isSelected())
         {
@@ -339,7 +465,7 @@ void RS_Modification::revertDirection() {
 
 	std::vector<RS_Entity*> addList;
     bool invalidContainer {true};
-    for(auto e: *container) {
+    for(auto e: container->getSelectedEntities()) {
 		if (e && e->isSelected()) {
 			RS_Entity* ec = e->clone();
 			ec->revertDirection();
@@ -377,10 +503,11 @@ bool RS_Modification::changeAttributes(
     }
 
     LC_UndoSection  undo(document);
-    QList<RS_Entity*> clones;
+    // the entities are changed in place, the undo cycle keeps their previous attributes only
+    auto change = std::make_unique<LC_AttributesChange>();
     QSet<RS_Block*> blocks;
 
-    for (auto en: *cont) {
+    for (auto en: cont->getSelectedEntities()) {
         if (!en) continue;
         if (!en->isSelected()) continue;
 
@@ -389,11 +516,11 @@ bool RS_Modification::changeAttributes(
             blocks << bl;
         }
 
-        RS_Entity* cl = en->clone();
-        RS_Pen pen = cl->getPen(false);
+        change->add(en);
+        RS_Pen pen = en->getPen(false);
 
         if (data.changeLayer==true) {
-            cl->setLayer(data.layer);
+            en->setLayer(data.layer);
         }
 
         if (data.changeColor==true) {
@@ -405,21 +532,9 @@ bool RS_Modification::changeAttributes(
         if (data.changeWidth==true) {
             pen.setWidth(data.pen.getWidth());
         }
-        cl->setPen(pen);
-
-        if (graphicView) {
-            graphicView->deleteEntity(en);
-        }
-
+        en->setPen(pen);
         en->setSelected(false);
-        cl->setSelected(false);
-
-        clones << cl;
-
-        if (!graphic) continue;
-
-        en->setUndoState(true);
-        graphic->addUndoable(en);
+        LC_AttributesChange::applied(en);
     }
 
     for (auto bl: blocks.values()) {
@@ -430,23 +545,16 @@ bool RS_Modification::changeAttributes(
         changeAttributes(data, (RS_EntityContainer*)bl);
     }
 
-    for (auto cl: clones) {
-        cont->addEntity(cl);
-
-        if (graphicView) {;
-            graphicView->drawEntity(cl);
-        }
-
-        if (graphic) {
-            graphic->addUndoable(cl);
-        }
-    }
+    if (!change->isEmpty())
+        undo.addOwnedUndoable(std::move(change));
 
-    if (graphic) {
+    if (graphic && !blocks.isEmpty()) {
         graphic->updateInserts();
     }
 
-    cont->calculateBorders();
+    if (graphicView) {
+        graphicView->redraw(RS2::RedrawDrawing);
+    }
 
     return true;
 }
@@ -483,7 +591,7 @@ void RS_Modification::copy(const RS_Vector& ref, const bool cut) {
 
     bool invalidContainer {true};
 	// copy entities / layers / blocks
-	for(auto e: *container){
+	for(auto e: container->getSelectedEntities()){
         //for (unsigned i=0; i<container->count(); ++i) {
         //RS_Entity* e = container->entityAt(i);
         if (e && e->isSelected()) {
@@ -607,6 +715,9 @@ void RS_Modification::copyLayers(RS_Entity* e) {
             RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Modification::copyLayers: could not find block for insert entity");
             return;
         }
+        // the layers of blocks copied already are in the clipboard
+        if (RS_CLIPBOARD->hasBlock(b->getName()))
+            return;
         for(auto e2: *b) {
             //for (unsigned i=0; i<b->count(); ++i) {
             //RS_Entity* e2 = b->entityAt(i);
@@ -647,10 +758,11 @@ void RS_Modification::copyBlocks(RS_Entity* e) {
     }
     // add block of an insert
     QString bn = b->getName();
-    if (!RS_CLIPBOARD->hasBlock(bn)) {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::copyBlocks: add block name: %s", bn.toLatin1().data());
-        RS_CLIPBOARD->addBlock((RS_Block*)b->clone());
-    }
+    // the nested blocks of blocks copied already are in the clipboard
+    if (RS_CLIPBOARD->hasBlock(bn))
+        return;
+    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::copyBlocks: add block name: %s", bn.toLatin1().data());
+    RS_CLIPBOARD->addBlock((RS_Block*)b->clone());
     //find insert into insert
     for(auto e2: *b) {
         //call copyBlocks only if entity are insert
@@ -710,6 +822,13 @@ void RS_Modification::paste(const RS_PasteData& data, RS_Graphic* source) {
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::paste: selected layer: %s", layer->getName().toLatin1().data());
     graphic->activateLayer(layer);
 
+    // pasted in place, without a paste block to explode
+    if (!data.asInsert) {
+        if (!pasteEntities(*source, vfactor, ip))
+            RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Modification::paste: unable to paste due to entity paste error");
+        return;
+    }
+
     // hash for renaming duplicated blocks
     QHash<QString, QString> blocksDict;
 
@@ -764,20 +883,8 @@ void RS_Modification::paste(const RS_PasteData& data, RS_Graphic* source) {
     i->update();
     i->setSelected(false);
 
-    // unblock all entities if not pasting as a new block by demand
     LC_UndoSection undo(document, handleUndo);
-    if (!data.asInsert) {
-        // no inserts should be selected except from paste block and insert
-        container->setSelected(false);
-        i->setSelected(true);
-        explode(false);
-        document->removeEntity(i);
-        b->clear();
-        // if this call a destructor for the block?
-        graphic->removeBlock(b);
-    } else {
-        undo.addUndoable(i);
-    }
+    undo.addUndoable(i);
 
 
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::paste: OK");
@@ -951,6 +1058,74 @@ bool RS_Modification::pasteEntity(RS_Entity* entity, RS_EntityContainer* contain
 
 
 
+/**
+ * Pastes the entities of the source in place, with the same result as exploding an
+ * insert of the paste block on the active layer with the active pen. The entities are
+ * cloned once, instead of into a paste block, the entities of its insert and the
+ * exploded entities.
+ *
+ * @param factor Scale factor, e.g. for the unit conversion.
+ * @param insertionPoint Where the origin of the source is pasted.
+ */
+bool RS_Modification::pasteEntities(RS_Graphic& source, const RS_Vector& factor, const RS_Vector& insertionPoint) {
+
+    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::pasteEntities");
+
+    // hash for renaming duplicated blocks
+    QHash<QString, QString> blocksDict;
+    // the pasted entities are collected without taking their ownership
+    RS_EntityContainer pasted{document, false};
+    for(auto e: source) {
+        if (!e) {
+            RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Modification::pasteEntities: nullptr entity in source");
+            continue;
+        }
+        const bool pastedEntity = e->rtti() == RS2::EntityInsert
+                ? pasteContainer(e, &pasted, blocksDict, RS_Vector(0.0, 0.0))
+                : pasteEntity(e, &pasted);
+        if (!pastedEntity) {
+            pasted.setOwner(true);
+            return false;
+        }
+        e->setSelected(false);
+    }
+
+    // layer and pen of the paste block insert, see RS_Insert::createEntities()
+    RS_Layer* layer = graphic->getActiveLayer();
+    const RS_Pen activePen = document->getActivePen();
+    std::vector<RS_Entity*> addList;
+    addList.reserve(pasted.count());
+    for (RS_Entity* e: pasted) {
+        if (e->getLayer() != nullptr && e->getLayer()->getName() == "0")
+            e->setLayer(layer);
+        RS_Pen pen = e->getPen(false);
+        if (pen.getColor() == RS_Color(RS2::FlagByBlock))
+            pen.setColor(activePen.getColor());
+        if (pen.getWidth() == RS2::WidthByBlock)
+            pen.setWidth(activePen.getWidth());
+        if (pen.getLineType() == RS2::LineByBlock)
+            pen.setLineType(activePen.getLineType());
+        e->setPen(pen);
+
+        e->move(insertionPoint);
+        e->scale(insertionPoint, factor);
+        e->reparent(container);
+        e->setSelected(false);
+        e->update();
+        addList.push_back(e);
+    }
+
+    LC_UndoSection undo(document, handleUndo);
+    // as after exploding the paste block
+    container->setSelected(false);
+    addNewEntities(addList);
+
+    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::pasteEntities: OK");
+    return true;
+}
+
+
+
 /**
  * Splits a polyline into two leaving out a gap.
  *
@@ -1912,34 +2087,30 @@ bool RS_Modification::move(RS_MoveData& data) {
         return false;
     }
 
-	std::vector<RS_Entity*> addList;
+    if (isTransformedInPlace(data.number, data.useCurrentLayer, data.useCurrentAttributes)) {
+        // since 2.0.4.0: keep selection
+        transformInPlace(LC_TransformChange::move(container->getSelectedEntities(), data.offset));
+        return true;
+    }
 
     // Create new entities
-    for (int num=1;
-            num<=data.number || (data.number==0 && num<=1);
-            num++) {
-        // too slow:
-        //for (unsigned i=0; i<container->count(); ++i) {
-		//RS_Entity* e = container->entityAt(i);
-		for(auto e: *container){
-			if (e && e->isSelected()) {
-                RS_Entity* ec = e->clone();
-
-                ec->move(data.offset*num);
-                if (data.useCurrentLayer) {
-                    ec->setLayerToActive();
-                }
-                if (data.useCurrentAttributes) {
-                    ec->setPenToActive();
-                }
-                if (ec->rtti()==RS2::EntityInsert) {
-                    ((RS_Insert*)ec)->update();
-                }
-                // since 2.0.4.0: keep selection
-                ec->setSelected(true);
-				addList.push_back(ec);
-            }
+    const int copies = (data.number == 0) ? 1 : data.number;
+	std::vector<RS_Entity*> addList = transformClones(container->getSelectedEntities(), copies,
+                                                      [&data](RS_Entity& ec, int num) {
+        ec.move(data.offset*num);
+    });
+    for (RS_Entity* ec: addList) {
+        if (data.useCurrentLayer) {
+            ec->setLayerToActive();
+        }
+        if (data.useCurrentAttributes) {
+            ec->setPenToActive();
         }
+        if (ec->rtti()==RS2::EntityInsert) {
+            ((RS_Insert*)ec)->update();
+        }
+        // since 2.0.4.0: keep selection
+        ec->setSelected(true);
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
@@ -1962,37 +2133,38 @@ bool RS_Modification::offset(const RS_OffsetData& data) {
         return false;
     }
 
-	std::vector<RS_Entity*> addList;
+    const std::vector<RS_Entity*> selected = container->getSelectedEntities();
+    const size_t copies = (data.number == 0) ? 1 : std::max(data.number, 0);
 
-    // Create new entities
-    for (int num=1;
-            num<=data.number || (data.number==0 && num<=1);
-            num++) {
-        // too slow:
-		for(auto e: *container){
-			if (e && e->isSelected()) {
-                RS_Entity* ec = e->clone();
-				//highlight is used by trim actions. do not carry over flag
-				ec->setHighlighted(false);
+    // the offsets of entities and copies are independent: computed by worker threads
+    std::vector<RS_Entity*> offsets(copies * selected.size(), nullptr);
+    LC_Parallel::forEach(offsets.size(), offsetChunkSize, [&selected, &offsets, &data](size_t i) {
+        const int num = int(i / selected.size()) + 1;
+        RS_Entity* ec = selected[i % selected.size()]->clone();
+        //highlight is used by trim actions. do not carry over flag
+        ec->setHighlighted(false);
+        if (ec->offset(data.coord, num*data.distance))
+            offsets[i] = ec;
+        else
+            delete ec;
+    });
 
-				if (!ec->offset(data.coord, num*data.distance)) {
-                    delete ec;
-                    continue;
-                }
-                if (data.useCurrentLayer) {
-                    ec->setLayerToActive();
-                }
-                if (data.useCurrentAttributes) {
-                    ec->setPenToActive();
-                }
-                if (ec->rtti()==RS2::EntityInsert) {
-					static_cast<RS_Insert*>(ec)->update();
-                }
-                // since 2.0.4.0: keep selection
-                ec->setSelected(true);
-				addList.push_back(ec);
-            }
+	std::vector<RS_Entity*> addList;
+    for (RS_Entity* ec: offsets) {
+        if (ec == nullptr)
+            continue;
+        if (data.useCurrentLayer) {
+            ec->setLayerToActive();
         }
+        if (data.useCurrentAttributes) {
+            ec->setPenToActive();
+        }
+        if (ec->rtti()==RS2::EntityInsert) {
+            static_cast<RS_Insert*>(ec)->update();
+        }
+        // since 2.0.4.0: keep selection
+        ec->setSelected(true);
+        addList.push_back(ec);
     }
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
@@ -2015,32 +2187,22 @@ bool RS_Modification::rotate(RS_RotateData& data) {
         return false;
     }
 
-	std::vector<RS_Entity*> addList;
-
     // Create new entities
-    for (int num=1;
-            num<=data.number || (data.number==0 && num<=1);
-			num++) {
-		for(auto e: *container){
-            //for (unsigned i=0; i<container->count(); ++i) {
-            //RS_Entity* e = container->entityAt(i);
-
-            if (e && e->isSelected()) {
-                RS_Entity* ec = e->clone();
-                ec->setSelected(false);
-
-                ec->rotate(data.center, data.angle*num);
-                if (data.useCurrentLayer) {
-                    ec->setLayerToActive();
-                }
-                if (data.useCurrentAttributes) {
-                    ec->setPenToActive();
-                }
-                if (ec->rtti()==RS2::EntityInsert) {
-                    ((RS_Insert*)ec)->update();
-                }
-				addList.push_back(ec);
-            }
+    const int copies = (data.number == 0) ? 1 : data.number;
+	std::vector<RS_Entity*> addList = transformClones(container->getSelectedEntities(), copies,
+                                                      [&data](RS_Entity& ec, int num) {
+        ec.rotate(data.center, data.angle*num);
+    });
+    for (RS_Entity* ec: addList) {
+        ec->setSelected(false);
+        if (data.useCurrentLayer) {
+            ec->setLayerToActive();
+        }
+        if (data.useCurrentAttributes) {
+            ec->setPenToActive();
+        }
+        if (ec->rtti()==RS2::EntityInsert) {
+            ((RS_Insert*)ec)->update();
         }
     }
 
@@ -2066,7 +2228,7 @@ bool RS_Modification::scale(RS_ScaleData& data) {
 
 	std::vector<RS_Entity*> selectedList,addList;
 
-	for(auto ec: *container){
+	for(auto ec: container->getSelectedEntities()){
         if (ec->isSelected() ) {
             if ( !data.isotropicScaling ) {
                     if ( ec->rtti() == RS2::EntityCircle ) {
@@ -2094,32 +2256,20 @@ bool RS_Modification::scale(RS_ScaleData& data) {
     }
 
     // Create new entities
-    for (int num=1;
-            num<=data.number || (data.number==0 && num<=1);
-            num++) {
-
-		for(RS_Entity* e: selectedList) {
-            //for (RS_Entity* e=container->firstEntity();
-            //        e;
-            //        e=container->nextEntity()) {
-            //for (unsigned i=0; i<container->count(); ++i) {
-            //RS_Entity* e = container->entityAt(i);
-			if (e) {
-                RS_Entity* ec = e->clone();
-                ec->setSelected(false);
-
-                ec->scale(data.referencePoint, RS_Math::pow(data.factor, num));
-                if (data.useCurrentLayer) {
-                    ec->setLayerToActive();
-                }
-                if (data.useCurrentAttributes) {
-                    ec->setPenToActive();
-                }
-                if (ec->rtti()==RS2::EntityInsert) {
-                    ((RS_Insert*)ec)->update();
-                }
-				addList.push_back(ec);
-            }
+    const int copies = (data.number == 0) ? 1 : data.number;
+    addList = transformClones(selectedList, copies, [&data](RS_Entity& ec, int num) {
+        ec.scale(data.referencePoint, RS_Math::pow(data.factor, num));
+    });
+    for (RS_Entity* ec: addList) {
+        ec->setSelected(false);
+        if (data.useCurrentLayer) {
+            ec->setLayerToActive();
+        }
+        if (data.useCurrentAttributes) {
+            ec->setPenToActive();
+        }
+        if (ec->rtti()==RS2::EntityInsert) {
+            ((RS_Insert*)ec)->update();
         }
     }
 
@@ -2143,32 +2293,21 @@ bool RS_Modification::mirror(RS_MirrorData& data) {
         return false;
     }
 
-	std::vector<RS_Entity*> addList;
-
-    // Create new entities
-    for (int num=1;
-            num<=(int)data.copy || (data.copy==false && num<=1);
-			++num) {
-		for(auto e: *container){
-            //for (unsigned i=0; i<container->count(); ++i) {
-            //RS_Entity* e = container->entityAt(i);
-
-            if (e && e->isSelected()) {
-                RS_Entity* ec = e->clone();
-                ec->setSelected(false);
-
-                ec->mirror(data.axisPoint1, data.axisPoint2);
-                if (data.useCurrentLayer) {
-                    ec->setLayerToActive();
-                }
-                if (data.useCurrentAttributes) {
-                    ec->setPenToActive();
-                }
-                if (ec->rtti()==RS2::EntityInsert) {
-                    ((RS_Insert*)ec)->update();
-                }
-				addList.push_back(ec);
-            }
+    // Create new entities, a single mirrored copy
+	std::vector<RS_Entity*> addList = transformClones(container->getSelectedEntities(), 1,
+                                                      [&data](RS_Entity& ec, int /*num*/) {
+        ec.mirror(data.axisPoint1, data.axisPoint2);
+    });
+    for (RS_Entity* ec: addList) {
+        ec->setSelected(false);
+        if (data.useCurrentLayer) {
+            ec->setLayerToActive();
+        }
+        if (data.useCurrentAttributes) {
+            ec->setPenToActive();
+        }
+        if (ec->rtti()==RS2::EntityInsert) {
+            ((RS_Insert*)ec)->update();
         }
     }
 
@@ -2198,7 +2337,7 @@ bool RS_Modification::rotate2(RS_Rotate2Data& data) {
             num<=data.number || (data.number==0 && num<=1);
             num++) {
 
-		for(auto e: *container){
+		for(auto e: container->getSelectedEntities()){
             //for (unsigned i=0; i<container->count(); ++i) {
             //RS_Entity* e = container->entityAt(i);
 
@@ -2250,7 +2389,7 @@ bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
     for (int num=1;
             num<=data.number || (data.number==0 && num<=1);
 			++num) {
-		for(auto e: *container){
+		for(auto e: container->getSelectedEntities()){
             //for (unsigned i=0; i<container->count(); ++i) {
             //RS_Entity* e = container->entityAt(i);
 
@@ -2292,8 +2431,9 @@ bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
 void RS_Modification::deselectOriginals(bool remove)
 {
     LC_UndoSection undo( document, handleUndo);
+    std::vector<RS_Entity*> removed;
 
-    for (auto e: *container) {
+    for (auto e: container->getSelectedEntities()) {
 
         //for (unsigned i=0; i<container->count(); ++i) {
         //RS_Entity* e = container->entityAt(i);
@@ -2324,7 +2464,7 @@ void RS_Modification::deselectOriginals(bool remove)
                     //    graphicView->deleteEntity(e);
                     //}
                     e->changeUndoState();
-                    undo.addUndoable(e);
+                    removed.push_back(e);
                 } else {
                     //if (graphicView) {
                     //    graphicView->drawEntity(e);
@@ -2333,6 +2473,33 @@ void RS_Modification::deselectOriginals(bool remove)
             }
         }
     }
+    undo.addUndoables(removed);
+}
+
+
+
+bool RS_Modification::isTransformedInPlace(int copies, bool useCurrentLayer, bool useCurrentAttributes) const
+{
+    // the undo cycle of the caller would only know about copies
+    return copies == 0 && handleUndo && !useCurrentLayer && !useCurrentAttributes;
+}
+
+/**
+ * Moves the selected entities in place, they stay selected. The undo cycle keeps the offset only,
+ * instead of the original entities and their moved copies.
+ */
+void RS_Modification::transformInPlace(std::unique_ptr<LC_TransformChange> change)
+{
+    if (change->getEntities().empty())
+        return;
+    change->apply();
+
+    LC_UndoSection undo( document, handleUndo);
+    undo.addOwnedUndoable(std::move(change));
+
+    if (graphicView) {
+        graphicView->redraw(RS2::RedrawDrawing);
+    }
 }
 
 
@@ -2347,12 +2514,15 @@ void RS_Modification::addNewEntities(std::vector<RS_Entity*>& addList)
 {
     LC_UndoSection undo( document, handleUndo);
 
+    // many entities are indexed faster by rebuilding the index once, on the next query
+    if (addList.size() >= bulkAddMinimum && addList.size() * 4 >= container->count())
+        container->invalidateSpatialIndex();
     for (RS_Entity* e: addList) {
         if (e) {
             container->addEntity(e);
-            undo.addUndoable(e);
         }
     }
+    undo.addUndoables(addList);
 
     container->calculateBorders();
 
@@ -2522,6 +2692,102 @@ bool RS_Modification::trim(const RS_Vector& trimCoord,
 
 
 
+bool RS_Modification::trimToBoundaries(const RS_Vector& trimCoord,
+                                       const std::vector<RS_AtomicEntity*>& targets,
+                                       const std::vector<RS_Entity*>& boundaries)
+{
+    if (boundaries.empty())
+        return false;
+
+    // intersections are within the bounding box of the boundary they are on
+    LC_SpatialIndex index;
+    index.build(boundaries);
+
+    std::vector<std::pair<RS_AtomicEntity*, RS_AtomicEntity*>> trimmed;
+    for (RS_AtomicEntity* target: targets) {
+        if (target == nullptr || target->isLocked() || !target->isVisible())
+            continue;
+
+        RS_VectorSolutions sol;
+        auto addIntersections = [target, &sol](RS_Entity* boundary) {
+            if (boundary == target)
+                return;
+            // only points on the boundaries themselves, not on their extensions
+            for (const RS_Vector& vp: findIntersection(*target, *boundary)) {
+                if (vp.valid && (!boundary->isAtomic() || boundary->isPointOnEntity(vp, 1e-4)))
+                    sol.push_back(vp);
+            }
+        };
+        // trimming: the boundaries crossing the target are within its bounding box
+        for (RS_Entity* boundary: index.queryWindow(target->getMin(), target->getMax()))
+            addIntersections(boundary);
+        // extending: the boundaries may be anywhere along the extension
+        if (!sol.hasValid()) {
+            for (RS_Entity* boundary: boundaries)
+                addIntersections(boundary);
+        }
+
+        //if intersection are in start or end point can't trim/extend in this point
+        if (target->rtti() == RS2::EntityLine) {
+            RS_VectorSolutions inner;
+            for (const RS_Vector& vp: sol) {
+                if (vp != target->getStartpoint() && vp != target->getEndpoint())
+                    inner.push_back(vp);
+            }
+            sol = inner;
+        }
+        if (!sol.hasValid())
+            continue;
+
+        RS_AtomicEntity* copy = nullptr;
+        if (target->rtti() == RS2::EntityCircle) {
+            // convert a circle into a trimmable arc, need to start from intersections
+            copy = trimCircle(static_cast<RS_Circle*>(target), trimCoord, sol);
+        } else {
+            copy = static_cast<RS_AtomicEntity*>(target->clone());
+            copy->setHighlighted(false);
+        }
+
+        const RS_Vector is = target->trimmable() ? copy->prepareTrim(trimCoord, sol) : sol.getClosest(trimCoord);
+        switch (copy->getTrimPoint(trimCoord, is)) {
+        case RS2::EndingStart:
+            copy->trimStartpoint(is);
+            break;
+        case RS2::EndingEnd:
+            copy->trimEndpoint(is);
+            break;
+        default:
+            break;
+        }
+        trimmed.emplace_back(target, copy);
+    }
+    if (trimmed.empty())
+        return false;
+
+    for (const auto& [target, copy]: trimmed) {
+        if (graphicView) {
+            graphicView->deleteEntity(target);
+        }
+        container->addEntity(copy);
+        if (graphicView) {
+            graphicView->drawEntity(copy);
+        }
+    }
+
+    if (handleUndo) {
+        LC_UndoSection undo( document);
+        for (const auto& [target, copy]: trimmed) {
+            undo.addUndoable(copy);
+            target->setUndoState(true);
+            undo.addUndoable(target);
+        }
+    }
+
+    return true;
+}
+
+
+
 /**
  * Trims or extends the given trimEntity by the given amount.
  *
@@ -2727,8 +2993,14 @@ bool RS_Modification::stretch(const RS_Vector& firstCorner,
 
 	std::vector<RS_Entity*> addList;
 
+    // only entities with bounding boxes overlapping the window can be stretched
+    const LC_SpatialIndex* index = container->getSpatialIndex();
+    const std::vector<RS_Entity*> candidates = (index != nullptr)
+            ? index->queryWindow(firstCorner, secondCorner)
+            : std::vector<RS_Entity*>{container->begin(), container->end()};
+
 	// Create new entities
-	for(auto e: *container){
+	for(auto e: candidates){
 		if (e &&
                 e->isVisible() &&
                 !e->isLocked() ) {
@@ -3311,7 +3583,7 @@ bool RS_Modification::explode(const bool remove /*= true*/)
 
 	std::vector<RS_Entity*> addList;
 
-    for(auto e: *container){
+    for(auto e: container->getSelectedEntities()){
         //for (unsigned i=0; i<container->count(); ++i) {
         //RS_Entity* e = container->entityAt(i);
 
@@ -3329,6 +3601,13 @@ bool RS_Modification::explode(const bool remove /*= true*/)
                 bool resolvePen;
                 bool resolveLayer;
 
+                // hatches drawn from their pattern definition have no pattern lines yet
+                if (ec->rtti() == RS2::EntityHatch)
+                    static_cast<RS_Hatch*>(ec)->materializePattern();
+                // dimensions outdated by a style change have old subentities
+                else if (RS_Information::isDimension(ec->rtti()))
+                    static_cast<RS_Dimension*>(ec)->updateOutdatedDim();
+
                 switch (ec->rtti()) {
                 case RS2::EntityMText:
                 case RS2::EntityText:
@@ -3364,6 +3643,22 @@ bool RS_Modification::explode(const bool remove /*= true*/)
                     break;
                 }
 
+                if (ec->rtti() == RS2::EntityInsert) {
+                    // the entities of an insert are transformed copies of its block already:
+                    // they are moved out, instead of copied once more
+                    auto* insert = static_cast<RS_Insert*>(ec);
+                    for (RS_Entity* e2: insert->releaseEntities()) {
+                        e2->setSelected(false);
+                        e2->reparent(container);
+                        addList.push_back(e2);
+                        update_exploded_children_recursively(ec, e2, e2,
+                                rl, resolveLayer, resolvePen);
+                    }
+                    if (!remove)
+                        insert->update();
+                    continue;
+                }
+
                 for (RS_Entity* e2 = ec->firstEntity(rl); e2;
                         e2 = ec->nextEntity(rl)) {
 
@@ -3426,7 +3721,7 @@ bool RS_Modification::explodeTextIntoLetters() {
 
 	std::vector<RS_Entity*> addList;
 
-	for(auto e: *container){
+	for(auto e: container->getSelectedEntities()){
         if (e && e->isSelected()) {
             if (e->rtti()==RS2::EntityMText) {
                 // add letters of text:
@@ -3571,7 +3866,7 @@ bool RS_Modification::moveRef(RS_MoveRefData& data) {
 	std::vector<RS_Entity*> addList;
 
     // Create new entities
-	for(auto e: *container){
+	for(auto e: container->getSelectedEntities()){
 		if (e && e->isSelected()) {
             RS_Entity* ec = e->clone();
 
@@ -3589,4 +3884,150 @@ bool RS_Modification::moveRef(RS_MoveRefData& data) {
     return true;
 }
 
+
+/**
+ * Removes the selected lines, arcs and circles, which duplicate another selected entity of the
+ * same layer and pen, and replaces overlapping or touching collinear lines by one line.
+ *
+ * The geometry is hashed, quantised by the tolerance, so the cost grows linearly with the
+ * number of selected entities.
+ */
+bool RS_Modification::overkill(const RS_OverkillData& data, RS_OverkillStats* stats)
+{
+    if (!container) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_Modification::overkill: no valid container");
+        return false;
+    }
+    if(container->isLocked() || ! container->isVisible()) return false;
+
+    const double tolerance = std::max(data.tolerance, RS_TOLERANCE);
+    RS_OverkillStats counts;
+    std::vector<RS_Entity*> removed;
+
+    // duplicates: the first entity of each geometry and pen is kept
+    std::unordered_map<OverkillKey, std::vector<RS_Entity*>, OverkillKeyHash> kept;
+    std::vector<RS_Line*> lines;
+    for (RS_Entity* e: container->getSelectedEntities()) {
+        if (e == nullptr || !e->isSelected() || e->isLocked())
+            continue;
+        const RS2::EntityType type = e->rtti();
+        if (type != RS2::EntityLine && type != RS2::EntityArc && type != RS2::EntityCircle)
+            continue;
+        ++counts.inspected;
+
+        std::vector<RS_Entity*>& same = kept[duplicateKey(*e, tolerance)];
+        const RS_Pen pen = e->getPen(false);
+        if (std::any_of(same.cbegin(), same.cend(), [&pen](const RS_Entity* k) {
+            return k->getPen(false) == pen;
+        })) {
+            removed.push_back(e);
+            ++counts.duplicates;
+            continue;
+        }
+        same.push_back(e);
+        if (type == RS2::EntityLine)
+            lines.push_back(static_cast<RS_Line*>(e));
+    }
+
+    std::vector<RS_Entity*> addList;
+    if (data.mergeCollinear) {
+        // lines grouped by their carrier line, in drawing order
+        std::vector<RS_Pen> pens;
+        std::unordered_map<OverkillKey, size_t, OverkillKeyHash> carrierIndex;
+        std::vector<std::vector<CollinearSpan>> carriers;
+        for (RS_Line* line: lines) {
+            RS_Vector direction = line->getEndpoint() - line->getStartpoint();
+            const double length = direction.magnitude();
+            if (length < tolerance)
+                continue;
+            direction /= length;
+            // the same direction for both orientations
+            if (direction.x < 0. || (direction.x == 0. && direction.y < 0.))
+                direction = -direction;
+
+            OverkillKey key{RS2::EntityLine, line->getLayer(false), {}};
+            key.values[0] = quantise(std::atan2(direction.y, direction.x), tolerance);
+            // signed distance of the carrier line from the origin
+            const RS_Vector& start = line->getStartpoint();
+            key.values[1] = quantise(direction.x * start.y - direction.y * start.x, tolerance);
+            auto [it, isNew] = carrierIndex.emplace(key, carriers.size());
+            if (isNew)
+                carriers.emplace_back();
+
+            const RS_Pen pen = line->getPen(false);
+            const auto penIt = std::find(pens.cbegin(), pens.cend(), pen);
+            CollinearSpan span{line, size_t(penIt - pens.cbegin()),
+                               direction.dotP(line->getStartpoint()), direction.dotP(line->getEndpoint()),
+                               line->getStartpoint(), line->getEndpoint()};
+            if (penIt == pens.cend())
+                pens.push_back(pen);
+            if (span.from > span.to) {
+                std::swap(span.from, span.to);
+                std::swap(span.fromPoint, span.toPoint);
+            }
+            carriers[it->second].push_back(span);
+        }
+
+        for (std::vector<CollinearSpan>& spans: carriers) {
+            if (spans.size() < 2)
+                continue;
+            std::sort(spans.begin(), spans.end(), [](const CollinearSpan& a, const CollinearSpan& b) {
+                return a.penIndex < b.penIndex || (a.penIndex == b.penIndex && a.from < b.from);
+            });
+            for (size_t i = 0; i < spans.size();) {
+                // the overlapping spans i to j - 1, starting with the leftmost one
+                size_t last = i;
+                size_t j = i + 1;
+                for (; j < spans.size() && spans[j].penIndex == spans[i].penIndex
+                     && spans[j].from <= spans[last].to + tolerance; ++j) {
+                    if (spans[j].to > spans[last].to)
+                        last = j;
+                }
+                if (j - i > 1) {
+                    // keep a line covering all others, instead of adding a new one
+                    size_t covering = j;
+                    for (size_t k = i; k < j; ++k) {
+                        if (spans[k].from <= spans[i].from + tolerance && spans[k].to >= spans[last].to - tolerance) {
+                            covering = k;
+                            break;
+                        }
+                    }
+                    if (covering == j) {
+                        auto* merged = static_cast<RS_Line*>(spans[i].line->clone());
+                        merged->setStartpoint(spans[i].fromPoint);
+                        merged->setEndpoint(spans[last].toPoint);
+                        addList.push_back(merged);
+                        ++counts.added;
+                    }
+                    for (size_t k = i; k < j; ++k) {
+                        if (k != covering) {
+                            removed.push_back(spans[k].line);
+                            ++counts.mergedLines;
+                        }
+                    }
+                }
+                i = j;
+            }
+        }
+    }
+
+    RS_DEBUG->print("RS_Modification::overkill: %d inspected, %d duplicates, %d lines merged into %d",
+                    counts.inspected, counts.duplicates, counts.mergedLines, counts.added);
+    if (stats)
+        *stats = counts;
+    if (removed.empty())
+        return false;
+
+    LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
+    for (RS_Entity* e: removed) {
+        e->setSelected(false);
+        e->changeUndoState();
+    }
+    undo.addUndoables(removed);
+    addNewEntities(addList);
+
+    return true;
+}
+
 // EOF
@@ -27,10 +27,13 @@
 #ifndef RS_MODIFICATION_H
 #define RS_MODIFICATION_H
 
+#include <memory>
+
 #include <QHash>
 #include "rs_pen.h"
 #include "rs_vector.h"
 
+class LC_TransformChange;
 class RS_AtomicEntity;
 class RS_Entity;
 class RS_EntityContainer;
@@ -179,6 +182,32 @@ struct RS_AttributesData {
 };
 
 
+/**
+ * Holds the data needed for removing duplicated geometry.
+ */
+struct RS_OverkillData {
+    //! Distances and angles (in rad) below this are considered equal.
+    double tolerance = 1.0e-6;
+    //! Merge overlapping or touching collinear lines into one line.
+    bool mergeCollinear = true;
+};
+
+
+/**
+ * Counts the entities removed or merged by RS_Modification::overkill().
+ */
+struct RS_OverkillStats {
+    //! Lines, arcs and circles inspected.
+    int inspected = 0;
+    //! Exact copies of another entity, removed.
+    int duplicates = 0;
+    //! Collinear lines, replaced by a merged line.
+    int mergedLines = 0;
+    //! Merged lines added.
+    int added = 0;
+};
+
+
 /**
  * Holds the data needed for pasting.
  */
@@ -244,6 +273,23 @@ public:
               bool both);
     bool trimAmount(const RS_Vector& trimCoord, RS_AtomicEntity* trimEntity,
                     double dist);
+    /**
+     * @brief trimToBoundaries - trims or extends all targets to the boundaries in one undo cycle
+     * @param trimCoord - selects the trimmed end of each target, as for trim()
+     * @param targets - the entities to trim or extend
+     * @param boundaries - the cutting edges. Targets are trimmed at their intersections with the
+     *  boundaries, or extended to them, if they don't intersect any boundary
+     * @return true, if any target has been trimmed
+     */
+    bool trimToBoundaries(const RS_Vector& trimCoord, const std::vector<RS_AtomicEntity*>& targets,
+                          const std::vector<RS_Entity*>& boundaries);
+    /**
+     * @brief overkill - removes the selected lines, arcs and circles which duplicate another one
+     *  with the same layer and pen, and merges overlapping collinear lines, in one undo cycle
+     * @param stats - if not nullptr, receives the counts of removed and merged entities
+     * @return true, if any entity has been removed
+     */
+    bool overkill(const RS_OverkillData& data, RS_OverkillStats* stats = nullptr);
     bool offset(const RS_OffsetData& data);
     bool cut(const RS_Vector& cutCoord, RS_AtomicEntity* cutEntity);
     bool stretch(const RS_Vector& firstCorner,
@@ -289,8 +335,12 @@ private:
     bool pasteLayers(RS_Graphic* source);
     bool pasteContainer(RS_Entity* entity, RS_EntityContainer* container, QHash<QString, QString>blocksDict, RS_Vector insertionPoint);
     bool pasteEntity(RS_Entity* entity, RS_EntityContainer* container);
+    bool pasteEntities(RS_Graphic& source, const RS_Vector& factor, const RS_Vector& insertionPoint);
     void deselectOriginals(bool remove);
 	void addNewEntities(std::vector<RS_Entity*>& addList);
+    // whether the selection is moved in place, instead of being replaced by moved copies
+    bool isTransformedInPlace(int copies, bool useCurrentLayer, bool useCurrentAttributes) const;
+    void transformInPlace(std::unique_ptr<LC_TransformChange> change);
 	bool explodeTextIntoLetters(RS_MText* text, std::vector<RS_Entity*>& addList);
 	bool explodeTextIntoLetters(RS_Text* text, std::vector<RS_Entity*>& addList);
 
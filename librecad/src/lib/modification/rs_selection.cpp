@@ -25,13 +25,21 @@
 **********************************************************************/
 
 
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "qc_applicationwindow.h"
 
 #include "qg_dialogfactory.h"
 
+#include "lc_endpointindex.h"
+#include "lc_intersections.h"
 #include "rs_block.h"
 #include "rs_dialogfactory.h"
 #include "rs_entity.h"
+#include "rs_graphic.h"
 #include "rs_graphicview.h"
 #include "rs_information.h"
 #include "rs_insert.h"
@@ -65,13 +73,11 @@ void RS_Selection::selectSingle(RS_Entity* e)
 	if (e && (! (e->getLayer() && e->getLayer()->isLocked())))
     {
 
-        if (graphicView) graphicView->deleteEntity(e);
-
        	e->toggleSelected();
 
         if (graphicView)
         {
-            graphicView->drawEntity(e);
+            graphicView->redraw(RS2::RedrawSelection);
 
             if (e->isSelected() && (e->rtti() == RS2::EntityInsert))
             {
@@ -122,7 +128,7 @@ void RS_Selection::selectAll(bool select) {
 
 	if (graphicView) {
         //graphicView->drawEntity(container);
-		graphicView->redraw();
+		graphicView->redraw(RS2::RedrawSelection);
     }
 }
 
@@ -147,7 +153,7 @@ void RS_Selection::invertSelection() {
 
     if (graphicView) {
         //graphicView->drawEntity(container);
-		graphicView->redraw();
+		graphicView->redraw(RS2::RedrawSelection);
     }
 }
 
@@ -166,7 +172,7 @@ void RS_Selection::selectWindow(enum RS2::EntityType typeToSelect,const RS_Vecto
     container->selectWindow(typeToSelect,v1, v2, select, cross);
 
     if (graphicView) {
-		graphicView->redraw();
+		graphicView->redraw(RS2::RedrawSelection);
     }
 }
 
@@ -183,50 +189,36 @@ void RS_Selection::selectIntersected(const RS_Vector& v1, const RS_Vector& v2,
                                      bool select) {
 
 	RS_Line line{v1, v2};
-    bool inters;
 
+    // the visible entities, containers / groups by their atomic entities:
+    std::vector<RS_Entity*> entities;
+    std::unordered_map<RS_Entity*, RS_Entity*> owners;
 	for(auto e: *container){
-    //for (unsigned i=0; i<container->count(); ++i) {
-        //RS_Entity* e = container->entityAt(i);
-
         if (e && e->isVisible()) {
-
-            inters = false;
-
-            // select containers / groups:
             if (e->isContainer()) {
                 RS_EntityContainer* ec = (RS_EntityContainer*)e;
 
-                for (RS_Entity* e2=ec->firstEntity(RS2::ResolveAll); e2;
-                        e2=ec->nextEntity(RS2::ResolveAll)) {
-
-                    RS_VectorSolutions sol =
-                        RS_Information::getIntersection(&line, e2, true);
-
-                    if (sol.hasValid()) {
-                        inters = true;
-                    }
+                for (RS_Entity* e2: ec->getEntityRange(RS2::ResolveAll)) {
+                    entities.push_back(e2);
+                    owners.emplace(e2, e);
                 }
             } else {
-
-                RS_VectorSolutions sol =
-                    RS_Information::getIntersection(&line, e, true);
-
-                if (sol.hasValid()) {
-                    inters = true;
-                }
+                entities.push_back(e);
+                owners.emplace(e, e);
             }
+        }
+    }
 
-            if (inters) {
-                if (graphicView) {
-                    graphicView->deleteEntity(e);
-                }
+    std::unordered_set<RS_Entity*> intersected;
+    for (const LC_Intersection& crossing: LC_Intersections::findBetween({&line}, entities))
+        intersected.insert(owners.at(crossing.second));
 
-                e->setSelected(select);
+	for(auto e: *container){
+        if (intersected.count(e) > 0) {
+            e->setSelected(select);
 
-                if (graphicView) {
-                    graphicView->drawEntity(e);
-                }
+            if (graphicView) {
+                graphicView->redraw(RS2::RedrawSelection);
             }
         }
     }
@@ -251,71 +243,64 @@ void RS_Selection::selectContour(RS_Entity* e) {
     }
 
     bool select = !e->isSelected();
-    RS_AtomicEntity* ae = (RS_AtomicEntity*)e;
-    RS_Vector p1 = ae->getStartpoint();
-    RS_Vector p2 = ae->getEndpoint();
-    bool found = false;
+    RS_Vector p1 = e->getStartpoint();
+    RS_Vector p2 = e->getEndpoint();
 
     // (de)select 1st entity:
-    if (graphicView) {
-        graphicView->deleteEntity(e);
-    }
     e->setSelected(select);
     if (graphicView) {
-        graphicView->drawEntity(e);
+        graphicView->redraw(RS2::RedrawSelection);
     }
 
-    do {
-        found = false;
-
-		for(auto en: *container){
-        //for (unsigned i=0; i<container->count(); ++i) {
-            //RS_Entity* en = container->entityAt(i);
-
-            if (en && en->isVisible() && 
-				en->isAtomic() && en->isSelected()!=select && 
-				(!(en->getLayer() && en->getLayer()->isLocked()))) {
-
-                ae = (RS_AtomicEntity*)en;
-                bool doit = false;
-
-                // startpoint connects to 1st point
-                if (ae->getStartpoint().distanceTo(p1)<1.0e-4) {
-                    doit = true;
-                    p1 = ae->getEndpoint();
-                }
-
-                // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p1)<1.0e-4) {
-                    doit = true;
-                    p1 = ae->getStartpoint();
-                }
-
-                // startpoint connects to 2nd point
-                else if (ae->getStartpoint().distanceTo(p2)<1.0e-4) {
-                    doit = true;
-                    p2 = ae->getEndpoint();
-                }
-
-                // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p2)<1.0e-4) {
-                    doit = true;
-                    p2 = ae->getStartpoint();
-                }
+    // the connected entities are found by their endpoints, in the index kept by the drawing,
+    // so following the contour takes time proportional to its length
+    constexpr double contourTolerance = RS_Graphic::endpointTolerance;
+    RS_Graphic* graphic = container->getGraphic();
+    std::unique_ptr<LC_EndpointIndex> containerEndpoints;
+    const LC_EndpointIndex* endpoints = nullptr;
+    if (graphic != nullptr && graphic == container) {
+        endpoints = &graphic->getEndpointIndex();
+    } else {
+        containerEndpoints = std::make_unique<LC_EndpointIndex>(contourTolerance);
+        for (auto en: *container) {
+            if (en && en->isAtomic())
+                containerEndpoints->insert(en);
+        }
+        endpoints = containerEndpoints.get();
+    }
 
-                if (doit) {
-                    if (graphicView) {
-                        graphicView->deleteEntity(ae);
-                    }
-                    ae->setSelected(select);
-                    if (graphicView) {
-                        graphicView->drawEntity(ae);
-                    }
-                    found = true;
+    auto isCandidate = [select](const RS_Entity* en) {
+        return en->isVisible() && en->isAtomic() && en->isSelected() != select
+                && !(en->getLayer() && en->getLayer()->isLocked());
+    };
+
+    // (de)selects the connected entities from an end point of the contour
+    auto follow = [this, endpoints, &isCandidate, select](RS_Vector point) {
+        for (;;) {
+            // the nearest candidate endpoint, ties are resolved by the container order
+            RS_Entity* next = nullptr;
+            double minDist = RS_MAXDOUBLE;
+            for (RS_Entity* en: endpoints->getConnected(point)) {
+                if (!isCandidate(en))
+                    continue;
+                const double dist = std::min(en->getStartpoint().distanceTo(point),
+                                             en->getEndpoint().distanceTo(point));
+                if (dist < minDist) {
+                    next = en;
+                    minDist = dist;
                 }
             }
+            if (next == nullptr)
+                break;
+            point = (next->getStartpoint().distanceTo(point) < contourTolerance) ? next->getEndpoint() : next->getStartpoint();
+            next->setSelected(select);
+            if (graphicView) {
+                graphicView->redraw(RS2::RedrawSelection);
+            }
         }
-    } while(found);
+    };
+    follow(p1);
+    follow(p2);
 }
 
 
@@ -345,25 +330,22 @@ void RS_Selection::selectLayer(RS_Entity* e) {
  */
 void RS_Selection::selectLayer(const QString& layerName, bool select) {
 
-	for(auto en: *container){
-
-        if (en && en->isVisible() && 
-				en->isSelected()!=select && 
-				(!(en->getLayer() && en->getLayer()->isLocked()))) {
-
-            RS_Layer* l = en->getLayer(true);
+    RS_Graphic* graphic = container->getGraphic();
+    RS_Layer* layer = (graphic != nullptr) ? graphic->findLayer(layerName) : nullptr;
+    if (layer == nullptr || layer->isLocked())
+        return;
 
-            if (l != nullptr && l->getName()==layerName) {
-                if (graphicView) {
-                    graphicView->deleteEntity(en);
-                }
-                en->setSelected(select);
-                if (graphicView) {
-                    graphicView->drawEntity(en);
-                }
-            }
+    // only the entities on the layer are visited
+    bool changed = false;
+    for(auto en: container->getLayerEntities(layer)){
+        if (en->isVisible() && en->isSelected()!=select) {
+            en->setSelected(select);
+            changed = true;
         }
     }
+    if (changed && graphicView) {
+        graphicView->redraw(RS2::RedrawSelection);
+    }
 }
 
 // EOF
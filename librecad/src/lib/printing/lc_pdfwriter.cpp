@@ -0,0 +1,586 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_pdfwriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QPaintEngine>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QTransform>
+
+namespace {
+// objects written first, referenced by all pages
+constexpr int catalogObject = 1;
+constexpr int pagesObject = 2;
+constexpr int resourcesObject = 3;
+
+// digits of page coordinates in device pixels, and of form coordinates in drawing units
+constexpr int pagePrecision = 3;
+constexpr int formPrecision = 6;
+
+// a number in the PDF syntax, which has no exponents
+QByteArray number(double value, int precision = pagePrecision)
+{
+    QByteArray text = QByteArray::number(value, 'f', precision);
+    if (text.contains('.')) {
+        while (text.endsWith('0'))
+            text.chop(1);
+        if (text.endsWith('.'))
+            text.chop(1);
+    }
+    return text == "-0" ? QByteArray{"0"} : text;
+}
+
+QByteArray matrix(const QTransform& transform, int precision = formPrecision)
+{
+    return number(transform.m11(), precision) + ' ' + number(transform.m12(), precision) + ' '
+         + number(transform.m21(), precision) + ' ' + number(transform.m22(), precision) + ' '
+         + number(transform.dx()) + ' ' + number(transform.dy());
+}
+
+QByteArray pathOperators(const QPainterPath& path, int precision)
+{
+    QByteArray ops;
+    auto point = [&ops, precision](const QPainterPath::Element& e) {
+        ops += number(e.x, precision) + ' ' + number(e.y, precision) + ' ';
+    };
+    for (int i = 0; i < path.elementCount(); i++) {
+        const QPainterPath::Element& e = path.elementAt(i);
+        switch (e.type) {
+        case QPainterPath::MoveToElement:
+            point(e);
+            ops += "m\n";
+            break;
+        case QPainterPath::LineToElement:
+            point(e);
+            ops += "l\n";
+            break;
+        case QPainterPath::CurveToElement:
+            if (i + 2 >= path.elementCount())
+                return ops;
+            point(e);
+            point(path.elementAt(i + 1));
+            point(path.elementAt(i + 2));
+            ops += "c\n";
+            i += 2;
+            break;
+        default:
+            break;
+        }
+    }
+    return ops;
+}
+
+// the scale of a transform, by the square root of its area factor
+double scaleOf(const QTransform& transform)
+{
+    return std::sqrt(std::abs(transform.m11() * transform.m22() - transform.m12() * transform.m21()));
+}
+
+// zlib compressed contents, for the FlateDecode filter
+QByteArray compressed(const QByteArray& data)
+{
+    // qCompress() prefixes the zlib stream with the uncompressed size
+    return qCompress(data).mid(4);
+}
+}
+
+/**
+ * The engine writing the pages of LC_PdfWriter. Every drawing operation is written with its own
+ * graphics state, between q and Q operators, in device coordinates; the page content maps device
+ * pixels to points.
+ */
+class LC_PdfPaintEngine : public QPaintEngine {
+public:
+    LC_PdfPaintEngine(const QString& fileName, const QSizeF& pageSize, int resolution):
+        QPaintEngine{QPaintEngine::AllFeatures}
+      , m_file{fileName}
+        // mm to points
+      , m_pageSize{pageSize * 72. / 25.4}
+      , m_resolution{resolution}
+    {}
+
+    bool begin(QPaintDevice* /*device*/) override
+    {
+        if (!m_file.open(QIODevice::WriteOnly))
+            return false;
+        m_offsets.assign(resourcesObject + 1, 0);
+        m_file.write("%PDF-1.4\n%\xe2\xe3\xcf\xd3\n");
+        startPage();
+        return true;
+    }
+
+    bool end() override
+    {
+        if (!m_file.isOpen())
+            return false;
+        finishPage();
+
+        QByteArray resources = "<< /ProcSet [/PDF /ImageC /ImageB] /XObject <<";
+        for (const QByteArray& reference: std::as_const(m_xObjects))
+            resources += ' ' + reference;
+        resources += " >> >>";
+        writeObject(resourcesObject, resources);
+
+        QByteArray pages = "<< /Type /Pages /Kids [";
+        for (int page: std::as_const(m_pages))
+            pages += ' ' + QByteArray::number(page) + " 0 R";
+        pages += " ] /Count " + QByteArray::number(m_pages.size()) + " >>";
+        writeObject(pagesObject, pages);
+        writeObject(catalogObject, "<< /Type /Catalog /Pages 2 0 R >>");
+
+        const qint64 xref = m_file.pos();
+        QByteArray table = "xref\n0 " + QByteArray::number(m_offsets.size()) + "\n0000000000 65535 f \n";
+        for (size_t i = 1; i < m_offsets.size(); i++)
+            table += QByteArray::number(m_offsets[i]).rightJustified(10, '0') + " 00000 n \n";
+        table += "trailer\n<< /Size " + QByteArray::number(m_offsets.size()) + " /Root 1 0 R >>\nstartxref\n"
+                 + QByteArray::number(xref) + "\n%%EOF\n";
+        m_file.write(table);
+        const bool ok = m_file.error() == QFileDevice::NoError;
+        m_file.close();
+        return ok;
+    }
+
+    void updateState(const QPaintEngineState& state) override
+    {
+        const DirtyFlags flags = state.state();
+        if (flags & DirtyPen)
+            m_pen = state.pen();
+        if (flags & DirtyBrush)
+            m_brush = state.brush();
+        if (flags & DirtyTransform)
+            m_transform = state.transform();
+        if (flags & DirtyClipEnabled) {
+            m_clipEnabled = state.isClipEnabled();
+            m_clipDirty = true;
+        }
+        if (flags & (DirtyClipPath | DirtyClipRegion)) {
+            QPainterPath clip;
+            if (flags & DirtyClipPath) {
+                clip = state.transform().map(state.clipPath());
+            } else {
+                clip.addRegion(state.clipRegion());
+                clip = state.transform().map(clip);
+            }
+            switch (state.clipOperation()) {
+            case Qt::NoClip:
+                m_clipEnabled = false;
+                break;
+            case Qt::IntersectClip:
+                m_clip = m_clipEnabled ? m_clip.intersected(clip) : clip;
+                m_clipEnabled = true;
+                break;
+            default:
+                m_clip = clip;
+                m_clipEnabled = true;
+                break;
+            }
+            m_clipDirty = true;
+        }
+    }
+
+    void drawPath(const QPainterPath& path) override
+    {
+        paint(path, m_brush.style() != Qt::NoBrush);
+    }
+
+    void drawPolygon(const QPointF* points, int pointCount, PolygonDrawMode mode) override
+    {
+        if (pointCount < 2)
+            return;
+        QPainterPath path{points[0]};
+        for (int i = 1; i < pointCount; i++)
+            path.lineTo(points[i]);
+        if (mode == PolylineMode) {
+            paint(path, false);
+            return;
+        }
+        path.closeSubpath();
+        path.setFillRule(mode == OddEvenMode ? Qt::OddEvenFill : Qt::WindingFill);
+        paint(path, m_brush.style() != Qt::NoBrush);
+    }
+
+    void drawPixmap(const QRectF& rect, const QPixmap& pixmap, const QRectF& source) override
+    {
+        drawImage(rect, pixmap.toImage(), source, Qt::AutoColor);
+    }
+
+    void drawImage(const QRectF& rect, const QImage& image, const QRectF& source,
+                   Qt::ImageConversionFlags /*flags*/) override
+    {
+        if (image.isNull() || rect.isEmpty())
+            return;
+        const bool whole = source.toRect() == image.rect();
+        const QImage drawn = whole ? image : image.copy(source.toRect());
+        // images drawn again are written once, parts of images are written each time
+        QByteArray name = whole ? m_images.value(image.cacheKey()) : QByteArray{};
+        if (name.isEmpty()) {
+            name = writeImage(drawn);
+            if (whole)
+                m_images.insert(image.cacheKey(), name);
+        }
+
+        beginClip();
+        // the unit square of the image, its first row on top
+        const QTransform placement = QTransform{rect.width(), 0., 0., -rect.height(),
+                                                rect.left(), rect.top() + rect.height()} * m_transform;
+        m_content += "q\n" + matrix(placement) + " cm\n/" + name + " Do\nQ\n";
+    }
+
+    Type type() const override
+    {
+        return QPaintEngine::User;
+    }
+
+    void setGrayscale(bool grayscale)
+    {
+        m_grayscale = grayscale;
+    }
+
+    /**
+     * @brief setSharedPath - the next path drawn is the path, drawn through the transform,
+     * and is written as a form XObject
+     */
+    void setSharedPath(const QPainterPath* path, const QTransform& transform)
+    {
+        m_sharedPath = path;
+        m_sharedTransform = transform;
+    }
+
+    bool newPage()
+    {
+        if (!m_file.isOpen())
+            return false;
+        finishPage();
+        startPage();
+        return true;
+    }
+
+private:
+    // a form XObject of a shared path
+    struct Form {
+        // the copy keeps the path data alive, so another path at the same address is a new path
+        QPainterPath path;
+        QByteArray paintOperator;
+        QByteArray name;
+        // the margin of the bounding box, for half the line width
+        double margin = 0.;
+    };
+
+    int allocateObject()
+    {
+        m_offsets.push_back(0);
+        return int(m_offsets.size()) - 1;
+    }
+
+    void writeObject(int object, const QByteArray& body)
+    {
+        m_offsets[object] = m_file.pos();
+        m_file.write(QByteArray::number(object) + " 0 obj\n" + body + "\nendobj\n");
+    }
+
+    void writeStream(int object, const QByteArray& dictionary, const QByteArray& data)
+    {
+        const QByteArray stream = compressed(data);
+        writeObject(object, "<< " + dictionary + " /Filter /FlateDecode /Length " + QByteArray::number(stream.size())
+                            + " >>\nstream\n" + stream + "\nendstream");
+    }
+
+    QByteArray addXObject(int object)
+    {
+        const QByteArray name = "X" + QByteArray::number(m_xObjects.size() + 1);
+        m_xObjects.push_back(name + ' ' + QByteArray::number(object) + " 0 R");
+        return name;
+    }
+
+    QByteArray writeImage(const QImage& image)
+    {
+        const QImage pixels = image.convertToFormat(m_grayscale ? QImage::Format_Grayscale8 : QImage::Format_RGB888);
+        const int rowSize = pixels.width() * (m_grayscale ? 1 : 3);
+        QByteArray data;
+        data.reserve(rowSize * pixels.height());
+        for (int y = 0; y < pixels.height(); y++)
+            data.append(reinterpret_cast<const char*>(pixels.constScanLine(y)), rowSize);
+
+        const int object = allocateObject();
+        writeStream(object, "/Type /XObject /Subtype /Image /Width " + QByteArray::number(pixels.width())
+                            + " /Height " + QByteArray::number(pixels.height())
+                            + (m_grayscale ? " /ColorSpace /DeviceGray" : " /ColorSpace /DeviceRGB")
+                            + " /BitsPerComponent 8", data);
+        return addXObject(object);
+    }
+
+    QByteArray color(const QColor& color, bool stroking) const
+    {
+        if (m_grayscale)
+            return number(qGray(color.rgb()) / 255.) + (stroking ? " G\n" : " g\n");
+        return number(color.redF()) + ' ' + number(color.greenF()) + ' ' + number(color.blueF())
+               + (stroking ? " RG\n" : " rg\n");
+    }
+
+    // the stroking state, with lengths divided by the scale of the coordinates they're used in
+    QByteArray strokeState(double scale) const
+    {
+        double width = m_pen.widthF();
+        if (!m_pen.isCosmetic())
+            width *= scaleOf(m_transform);
+        QByteArray state = color(m_pen.color(), true) + number(width / scale, formPrecision) + " w\n";
+
+        switch (m_pen.capStyle()) {
+        case Qt::FlatCap:
+            state += "0 J ";
+            break;
+        case Qt::RoundCap:
+            state += "1 J ";
+            break;
+        default:
+            state += "2 J ";
+            break;
+        }
+        switch (m_pen.joinStyle()) {
+        case Qt::RoundJoin:
+            state += "1 j\n";
+            break;
+        case Qt::BevelJoin:
+            state += "2 j\n";
+            break;
+        default:
+            state += "0 j\n";
+            break;
+        }
+
+        if (m_pen.style() != Qt::SolidLine) {
+            // Qt dash patterns are in units of the pen width
+            const double unit = std::max(width, 1.) / scale;
+            state += '[';
+            for (double dash: m_pen.dashPattern())
+                state += ' ' + number(dash * unit, formPrecision);
+            state += " ] " + number(m_pen.dashOffset() * unit, formPrecision) + " d\n";
+        }
+        return state;
+    }
+
+    void paint(const QPainterPath& path, bool fill)
+    {
+        const QPainterPath* shared = m_sharedPath;
+        m_sharedPath = nullptr;
+
+        const bool stroke = m_pen.style() != Qt::NoPen;
+        if ((!stroke && !fill) || path.isEmpty())
+            return;
+        const bool oddEven = path.fillRule() == Qt::OddEvenFill;
+        const QByteArray paintOperator = stroke && fill ? (oddEven ? "B*" : "B")
+                                       : fill ? (oddEven ? "f*" : "f") : "S";
+
+        beginClip();
+        m_content += "q\n";
+        if (fill)
+            m_content += color(m_brush.color(), false);
+
+        if (shared != nullptr) {
+            const QTransform transform = m_sharedTransform * m_transform;
+            const double scale = scaleOf(transform);
+            if (scale > 0.) {
+                if (stroke)
+                    m_content += strokeState(scale);
+                const Form* form = findForm(*shared, paintOperator, stroke ? 0.5 * m_pen.widthF() / scale : 0.);
+                m_content += matrix(transform) + " cm\n/" + form->name + " Do\nQ\n";
+                return;
+            }
+        }
+
+        if (stroke)
+            m_content += strokeState(1.);
+        m_content += pathOperators(m_transform.map(path), pagePrecision) + paintOperator + "\nQ\n";
+    }
+
+    // the form drawing the path, with a margin for strokes of the half width
+    const Form* findForm(const QPainterPath& path, const QByteArray& paintOperator, double halfWidth)
+    {
+        auto range = m_forms.equal_range(&path);
+        for (auto it = range.first; it != range.second; ++it) {
+            // the same path data is compared in constant time
+            if (it->paintOperator == paintOperator && it->margin >= halfWidth && it->path == path)
+                return &*it;
+        }
+
+        const QRectF box = path.controlPointRect();
+        Form form{path, paintOperator, {}, std::max({halfWidth * 2., box.width(), box.height(), 1.})};
+        const QRectF bounds = box.adjusted(-form.margin, -form.margin, form.margin, form.margin);
+        const int object = allocateObject();
+        writeStream(object, "/Type /XObject /Subtype /Form /BBox [" + number(bounds.left(), formPrecision) + ' '
+                            + number(bounds.top(), formPrecision) + ' ' + number(bounds.right(), formPrecision) + ' '
+                            + number(bounds.bottom(), formPrecision) + "] /Resources << >>",
+                    pathOperators(path, formPrecision) + paintOperator + '\n');
+        form.name = addXObject(object);
+        return &*m_forms.insert(&path, form);
+    }
+
+    // clipping paths enclose the drawing operations until they change
+    void beginClip()
+    {
+        if (!m_clipDirty)
+            return;
+        m_clipDirty = false;
+        if (m_clipOpen)
+            m_content += "Q\n";
+        m_clipOpen = m_clipEnabled;
+        if (m_clipEnabled) {
+            m_content += "q\n" + pathOperators(m_clip, pagePrecision)
+                         + (m_clip.fillRule() == Qt::OddEvenFill ? "W* n\n" : "W n\n");
+        }
+    }
+
+    void startPage()
+    {
+        // device pixels, y down, to points, y up
+        const double pointsPerPixel = 72. / m_resolution;
+        m_content = number(pointsPerPixel, formPrecision) + " 0 0 " + number(-pointsPerPixel, formPrecision)
+                    + " 0 " + number(m_pageSize.height()) + " cm\n";
+        m_clipOpen = false;
+        m_clipDirty = true;
+    }
+
+    void finishPage()
+    {
+        if (m_clipOpen)
+            m_content += "Q\n";
+        const int contents = allocateObject();
+        writeStream(contents, {}, m_content);
+        m_content.clear();
+
+        const int page = allocateObject();
+        writeObject(page, "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " + number(m_pageSize.width()) + ' '
+                          + number(m_pageSize.height()) + "] /Resources 3 0 R /Contents "
+                          + QByteArray::number(contents) + " 0 R >>");
+        m_pages.push_back(page);
+    }
+
+    QFile m_file;
+    QSizeF m_pageSize;
+    int m_resolution = 1200;
+    bool m_grayscale = false;
+
+    // file offsets of the objects, by object number
+    std::vector<qint64> m_offsets;
+    std::vector<int> m_pages;
+    // XObject names and references, for the shared resources
+    std::vector<QByteArray> m_xObjects;
+    QMultiHash<const QPainterPath*, Form> m_forms;
+    QHash<qint64, QByteArray> m_images;
+    QByteArray m_content;
+
+    QPen m_pen;
+    QBrush m_brush;
+    QTransform m_transform;
+    QPainterPath m_clip;
+    bool m_clipEnabled = false;
+    bool m_clipDirty = true;
+    bool m_clipOpen = false;
+
+    const QPainterPath* m_sharedPath = nullptr;
+    QTransform m_sharedTransform;
+};
+
+LC_PdfWriter::LC_PdfWriter(const QString& fileName, const QSizeF& pageSize, int resolution):
+    m_engine{std::make_unique<LC_PdfPaintEngine>(fileName, pageSize, resolution)}
+  , m_pageSize{pageSize}
+  , m_resolution{resolution}
+{}
+
+LC_PdfWriter::~LC_PdfWriter() = default;
+
+QPaintEngine* LC_PdfWriter::paintEngine() const
+{
+    return m_engine.get();
+}
+
+void LC_PdfWriter::setGrayscale(bool grayscale)
+{
+    m_engine->setGrayscale(grayscale);
+}
+
+bool LC_PdfWriter::newPage()
+{
+    return m_engine->newPage();
+}
+
+int LC_PdfWriter::metric(PaintDeviceMetric metric) const
+{
+    switch (metric) {
+    case PdmWidth:
+        return qRound(m_pageSize.width() * m_resolution / 25.4);
+    case PdmHeight:
+        return qRound(m_pageSize.height() * m_resolution / 25.4);
+    case PdmWidthMM:
+        return qRound(m_pageSize.width());
+    case PdmHeightMM:
+        return qRound(m_pageSize.height());
+    case PdmDpiX:
+    case PdmDpiY:
+    case PdmPhysicalDpiX:
+    case PdmPhysicalDpiY:
+        return m_resolution;
+    case PdmNumColors:
+        return std::numeric_limits<int>::max();
+    case PdmDepth:
+        return 32;
+    default:
+        return QPaintDevice::metric(metric);
+    }
+}
+
+LC_PdfPainter::LC_PdfPainter(LC_PdfWriter* writer):
+    RS_PainterQt{writer}
+  , m_writer{writer}
+{}
+
+void LC_PdfPainter::drawSharedPath(const QPainterPath& path, const QTransform& transform, bool filled)
+{
+    // forms are scaled uniformly, with their line widths
+    const bool similarity = std::abs(transform.m11() * transform.m11() + transform.m12() * transform.m12()
+                                     - transform.m21() * transform.m21() - transform.m22() * transform.m22())
+                                <= 1e-9 * (transform.m11() * transform.m11() + transform.m12() * transform.m12())
+                            && std::abs(transform.m11() * transform.m21() + transform.m12() * transform.m22())
+                                <= 1e-9 * (transform.m11() * transform.m11() + transform.m12() * transform.m12());
+    if (!similarity || !QPainter::isActive()) {
+        RS_PainterQt::drawSharedPath(path, transform, filled);
+        return;
+    }
+    // batched lines are drawn before the shared path is set
+    flushBatch();
+    m_writer->m_engine->setSharedPath(&path, transform);
+    if (filled)
+        RS_Painter::fillPath(path);
+    else
+        drawPath(path);
+    m_writer->m_engine->setSharedPath(nullptr, {});
+}
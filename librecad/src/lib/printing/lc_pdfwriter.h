@@ -0,0 +1,88 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_PDFWRITER_H
+#define LC_PDFWRITER_H
+
+#include <memory>
+
+#include <QPaintDevice>
+#include <QSizeF>
+#include <QString>
+
+#include "rs_painterqt.h"
+
+class LC_PdfPaintEngine;
+
+/**
+ * @brief The LC_PdfWriter class, a paint device writing vector PDF files.
+ *
+ * Painted with LC_PdfPainter, the paths shared by several entities, like the geometry of a block drawn
+ * by its inserts, are written once as form XObjects, and each insert only references the form with its
+ * own transform. Images are written once too, however many times they are drawn.
+ *
+ * Pens and brushes are written as solid colors: gradients, patterns and transparency are not supported.
+ */
+class LC_PdfWriter : public QPaintDevice {
+public:
+    /**
+     * @param pageSize - the size of the pages in mm
+     * @param resolution - the resolution of the device coordinates, in dots per inch
+     */
+    LC_PdfWriter(const QString& fileName, const QSizeF& pageSize, int resolution);
+    ~LC_PdfWriter() override;
+
+    QPaintEngine* paintEngine() const override;
+
+    // write colors as gray levels
+    void setGrayscale(bool grayscale);
+    // start the next page, while painting
+    bool newPage();
+
+protected:
+    int metric(PaintDeviceMetric metric) const override;
+
+private:
+    friend class LC_PdfPainter;
+
+    std::unique_ptr<LC_PdfPaintEngine> m_engine;
+    QSizeF m_pageSize;
+    int m_resolution = 1200;
+};
+
+/**
+ * @brief The LC_PdfPainter class, draws the shared paths of blocks to an LC_PdfWriter as form XObjects.
+ * Paths drawn through transforms which aren't similarities are written as they are, so their line widths
+ * aren't distorted.
+ */
+class LC_PdfPainter : public RS_PainterQt {
+public:
+    explicit LC_PdfPainter(LC_PdfWriter* writer);
+
+    void drawSharedPath(const QPainterPath& path, const QTransform& transform, bool filled) override;
+
+private:
+    LC_PdfWriter* m_writer = nullptr;
+};
+
+#endif // LC_PDFWRITER_H
@@ -0,0 +1,550 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <QColor>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QtCore>
+
+#include "main.h"
+
+#include "console_batchedit.h"
+#include "lc_textindex.h"
+#include "rs_block.h"
+#include "rs_blocklist.h"
+#include "rs_debug.h"
+#include "rs_filterdxfrw.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+#include "rs_modification.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_system.h"
+
+namespace {
+
+// the edits given on the command line, in the order they are applied
+struct BatchEdit {
+    //! layers renamed, or merged into an existing layer of the new name
+    std::vector<std::pair<QString, QString>> layers;
+    //! the layer of the entities whose attributes are changed, all entities if empty
+    QString onLayer;
+    RS_AttributesData attributes;
+    std::vector<LC_FindTextData> texts;
+    bool purgeBlocks = false;
+
+    bool changesAttributes() const
+    {
+        return attributes.changeLayer || attributes.changeColor
+            || attributes.changeLineType || attributes.changeWidth;
+    }
+};
+
+struct EditStats {
+    int layers = 0;
+    int entities = 0;
+    int texts = 0;
+    int blocks = 0;
+};
+
+bool parseEdit(const QCommandLineParser& parser, BatchEdit& edit);
+bool editFile(const QString& dxfFile, const QString& outFile, const BatchEdit& edit, bool dryRun,
+              QTextStream* manifest);
+int runWorkers(const QStringList& dxfFiles, const QStringList& workerArgs, int jobs, QTextStream* manifest);
+
+// splits "old=new" at the first '='
+bool parsePair(const QString& value, QString& first, QString& second)
+{
+    const int separator = value.indexOf('=');
+    if (separator <= 0)
+        return false;
+    first = value.left(separator);
+    second = value.mid(separator + 1);
+    return true;
+}
+}
+
+/////////
+/// \brief console_batchedit is called if librecad is run
+/// as console batchedit tool for editing DXF files.
+/// \param argc
+/// \param argv
+/// \return
+///
+int console_batchedit(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    // no gui, the drawings are neither shown nor printed
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString librecad;
+    if (prgInfo.baseName() != "batchedit")
+        librecad = prgInfo.filePath() + " batchedit";
+    QString appDesc = "\nApply the same edits to DXF files, in this order: layers renamed or merged,";
+    appDesc += "\nattributes changed, texts replaced and unused blocks purged.";
+    appDesc += "\n\n";
+    appDesc += "Examples:\n\n";
+    appDesc += "  " + librecad + " --rename-layer WALLS=A-WALL -o migrated *.dxf";
+    appDesc += "    -- rename a layer, merged into A-WALL where it exists.\n";
+    appDesc += "  " + librecad + " --on-layer DIM --color 256 --width bylayer --in-place *.dxf";
+    appDesc += "    -- set the entities of a layer to the color and width of the layer.\n";
+    appDesc += "  " + librecad + " -j 16 --replace-text 'REV A=REV B' --purge-blocks --manifest edits.tsv --in-place *.dxf";
+    appDesc += "    -- replace a text and purge blocks, 16 files at a time.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption renameLayerOpt(QStringList() << "rename-layer",
+        "Rename a layer, or merge it into the layer of the new name if it exists. May be repeated.",
+        "old=new");
+    parser.addOption(renameLayerOpt);
+
+    QCommandLineOption onLayerOpt(QStringList() << "on-layer",
+        "Change the attributes of the entities of this layer only, instead of all entities.", "layer");
+    parser.addOption(onLayerOpt);
+
+    QCommandLineOption toLayerOpt(QStringList() << "to-layer",
+        "Move the entities to this layer, which is added if needed.", "layer");
+    parser.addOption(toLayerOpt);
+
+    QCommandLineOption colorOpt(QStringList() << "color",
+        "Set the color of the entities: a color number (0 by block, 256 by layer), a name or #rrggbb.", "color");
+    parser.addOption(colorOpt);
+
+    QCommandLineOption lineTypeOpt(QStringList() << "linetype",
+        "Set the line type of the entities, e.g. BYLAYER or DASHED.", "name");
+    parser.addOption(lineTypeOpt);
+
+    QCommandLineOption widthOpt(QStringList() << "width",
+        "Set the line width of the entities: bylayer, byblock, default or hundredths of a mm.", "width");
+    parser.addOption(widthOpt);
+
+    QCommandLineOption replaceTextOpt(QStringList() << "replace-text",
+        "Replace a text in texts, multi line texts and dimension labels. May be repeated.", "old=new");
+    parser.addOption(replaceTextOpt);
+
+    QCommandLineOption caseSensitiveOpt(QStringList() << "case-sensitive",
+        "Replace texts of the same case only.");
+    parser.addOption(caseSensitiveOpt);
+
+    QCommandLineOption purgeBlocksOpt(QStringList() << "purge-blocks",
+        "Remove the blocks which are not inserted, also by other blocks.");
+    parser.addOption(purgeBlocksOpt);
+
+    QCommandLineOption outDirOpt(QStringList() << "o" << "outdir",
+        "Write the edited files to this directory.", "dir");
+    parser.addOption(outDirOpt);
+
+    QCommandLineOption inPlaceOpt(QStringList() << "in-place",
+        "Overwrite the files edited.");
+    parser.addOption(inPlaceOpt);
+
+    QCommandLineOption dryRunOpt(QStringList() << "dry-run",
+        "Count the changes as usual, without writing any file.");
+    parser.addOption(dryRunOpt);
+
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        "Edit files in parallel worker processes, each one holding one drawing at a time.", "integer");
+    parser.addOption(jobsOpt);
+
+    QCommandLineOption manifestOpt(QStringList() << "manifest",
+        "Write a tab separated line per file: dxf file, output file, status, layers, entities, "
+        "texts and blocks changed, time in ms.",
+        "file");
+    parser.addOption(manifestOpt);
+
+    parser.addPositionalArgument("<dxf_files>", "Input DXF files");
+
+    parser.process(app);
+
+    QStringList dxfFiles;
+    for (const QString& arg: parser.positionalArguments()) {
+        if (QFileInfo(arg).suffix().toLower() == "dxf")
+            dxfFiles.append(arg);
+    }
+    if (dxfFiles.isEmpty())
+        parser.showHelp(EXIT_FAILURE);
+
+    BatchEdit edit;
+    if (!parseEdit(parser, edit))
+        return EXIT_FAILURE;
+
+    const bool dryRun = parser.isSet(dryRunOpt);
+    const QString outDir = parser.value(outDirOpt);
+    if (!dryRun && outDir.isEmpty() == !parser.isSet(inPlaceOpt)) {
+        qDebug() << "ERROR: Give either an output directory or --in-place";
+        return EXIT_FAILURE;
+    }
+    if (!outDir.isEmpty() && !QDir().mkpath(outDir)) {
+        qDebug() << "ERROR: Cannot create" << outDir;
+        return EXIT_FAILURE;
+    }
+
+    QFile manifestFile(parser.value(manifestOpt));
+    QTextStream manifest(&manifestFile);
+    if (parser.isSet(manifestOpt) && !manifestFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "ERROR: Cannot write manifest" << manifestFile.fileName();
+        return EXIT_FAILURE;
+    }
+
+    bool jobsOk = false;
+    const int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+    if (jobsOk && jobs > 1 && dxfFiles.size() > 1) {
+        // workers are started with the same edits and output
+        QStringList workerArgs;
+        if (prgInfo.baseName() != "batchedit")
+            workerArgs << "batchedit";
+        for (const QCommandLineOption* option: {&renameLayerOpt, &onLayerOpt, &toLayerOpt, &colorOpt,
+             &lineTypeOpt, &widthOpt, &replaceTextOpt, &caseSensitiveOpt, &purgeBlocksOpt,
+             &outDirOpt, &inPlaceOpt, &dryRunOpt}) {
+            if (!parser.isSet(*option))
+                continue;
+            const QString name = "--" + option->names().last();
+            if (option->valueName().isEmpty()) {
+                workerArgs << name;
+                continue;
+            }
+            for (const QString& value: parser.values(*option))
+                workerArgs << name << value;
+        }
+        return runWorkers(dxfFiles, workerArgs, jobs, manifestFile.isOpen() ? &manifest : nullptr);
+    }
+
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    bool ok = true;
+    for (const QString& dxfFile: dxfFiles) {
+        const QString out = outDir.isEmpty() ? dxfFile
+                          : QDir(outDir).filePath(QFileInfo(dxfFile).fileName());
+        ok = editFile(dxfFile, out, edit, dryRun, manifestFile.isOpen() ? &manifest : nullptr) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+namespace {
+
+bool parseEdit(const QCommandLineParser& parser, BatchEdit& edit)
+{
+    for (const QString& value: parser.values("rename-layer")) {
+        QString from, to;
+        if (!parsePair(value, from, to) || to.isEmpty()) {
+            qDebug() << "ERROR: Invalid layer rename" << value;
+            return false;
+        }
+        edit.layers.emplace_back(from, to);
+    }
+
+    edit.onLayer = parser.value("on-layer");
+    RS_AttributesData& attributes = edit.attributes;
+    if (parser.isSet("to-layer")) {
+        attributes.layer = parser.value("to-layer");
+        attributes.changeLayer = !attributes.layer.isEmpty();
+    }
+    if (parser.isSet("color")) {
+        const QString value = parser.value("color");
+        bool isNumber = false;
+        const int number = value.toInt(&isNumber);
+        const QColor color(value);
+        if (isNumber && number >= 0 && number <= 256) {
+            attributes.pen.setColor(RS_FilterDXFRW::numberToColor(number));
+        } else if (!isNumber && color.isValid()) {
+            attributes.pen.setColor(RS_Color(color));
+        } else {
+            qDebug() << "ERROR: Invalid color" << value;
+            return false;
+        }
+        attributes.changeColor = true;
+    }
+    if (parser.isSet("linetype")) {
+        attributes.pen.setLineType(RS_FilterDXFRW::nameToLineType(parser.value("linetype")));
+        attributes.changeLineType = true;
+    }
+    if (parser.isSet("width")) {
+        const QString value = parser.value("width").toLower();
+        bool isNumber = false;
+        const int number = value.toInt(&isNumber);
+        if (value == "bylayer") {
+            attributes.pen.setWidth(RS2::WidthByLayer);
+        } else if (value == "byblock") {
+            attributes.pen.setWidth(RS2::WidthByBlock);
+        } else if (value == "default") {
+            attributes.pen.setWidth(RS2::WidthDefault);
+        } else if (isNumber && number >= 0) {
+            attributes.pen.setWidth(RS2::intToLineWidth(number));
+        } else {
+            qDebug() << "ERROR: Invalid line width" << value;
+            return false;
+        }
+        attributes.changeWidth = true;
+    }
+
+    const Qt::CaseSensitivity cs = parser.isSet("case-sensitive") ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    for (const QString& value: parser.values("replace-text")) {
+        LC_FindTextData data;
+        if (!parsePair(value, data.text, data.replacement)) {
+            qDebug() << "ERROR: Invalid text replacement" << value;
+            return false;
+        }
+        data.cs = cs;
+        edit.texts.push_back(std::move(data));
+    }
+
+    edit.purgeBlocks = parser.isSet("purge-blocks");
+
+    if (edit.layers.empty() && !edit.changesAttributes() && edit.texts.empty() && !edit.purgeBlocks) {
+        qDebug() << "ERROR: No edits given";
+        return false;
+    }
+    return true;
+}
+
+// the blocks whose entities are edited, external references belong to other files
+std::vector<RS_Block*> ownBlocks(RS_Graphic& graphic)
+{
+    std::vector<RS_Block*> blocks;
+    for (RS_Block* block: *graphic.getBlockList()) {
+        if (block == nullptr || block->isXref())
+            continue;
+        block->load();
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+// renames the layer, or moves its entities to the existing layer of the new name
+bool renameLayer(RS_Graphic& graphic, const QString& from, const QString& to)
+{
+    RS_Layer* source = graphic.findLayer(from);
+    if (source == nullptr || from == to)
+        return false;
+
+    RS_Layer* target = graphic.findLayer(to);
+    if (target == nullptr) {
+        RS_Layer renamed = *source;
+        renamed.setName(to);
+        graphic.editLayer(source, renamed);
+        return true;
+    }
+
+    // merged, entities in the undo history move as well
+    for (RS_Entity* e: graphic) {
+        if (e->getLayer() == source)
+            e->setLayer(target);
+    }
+    for (RS_Block* block: ownBlocks(graphic)) {
+        bool changed = false;
+        for (RS_Entity* e: *block) {
+            if (e->getLayer() == source) {
+                e->setLayer(target);
+                changed = true;
+            }
+        }
+        if (changed)
+            block->setChanged();
+    }
+    // layer "0" is kept, without entities
+    graphic.removeLayer(source);
+    return true;
+}
+
+// changes the attributes of the entities of the drawing, as the gui does for the selection
+int changeAttributes(RS_Graphic& graphic, const BatchEdit& edit)
+{
+    RS_AttributesData data = edit.attributes;
+    if (data.changeLayer && graphic.findLayer(data.layer) == nullptr)
+        graphic.addLayer(new RS_Layer(data.layer));
+
+    int selected = 0;
+    for (RS_Entity* e: graphic) {
+        if (e->isUndone())
+            continue;
+        if (!edit.onLayer.isEmpty() && (e->getLayer() == nullptr || e->getLayer()->getName() != edit.onLayer))
+            continue;
+        e->setSelected(true);
+        selected++;
+    }
+    if (selected > 0)
+        RS_Modification(graphic, nullptr, false).changeAttributes(data);
+    return selected;
+}
+
+// removes the blocks which are not inserted, until the blocks they inserted are purged as well
+int purgeBlocks(RS_Graphic& graphic)
+{
+    RS_BlockList* blockList = graphic.getBlockList();
+    int purged = 0;
+    for (bool removed = true; removed;) {
+        removed = false;
+        const QList<RS_Block*> blocks{blockList->begin(), blockList->end()};
+        for (RS_Block* block: blocks) {
+            // the model and paper spaces
+            if (block->getName().startsWith('*') || blockList->isUsed(block->getName()))
+                continue;
+            graphic.removeBlock(block);
+            purged++;
+            removed = true;
+        }
+    }
+    return purged;
+}
+
+// edits a dxf file, and writes its line of the manifest
+bool editFile(const QString& dxfFile, const QString& outFile, const BatchEdit& edit, bool dryRun,
+              QTextStream* manifest)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // read by the filter directly, errors are reported here instead of message boxes
+    RS_Graphic graphic;
+    graphic.beginOpen(dxfFile);
+    RS_FilterDXFRW filter;
+    bool ret = filter.fileImport(graphic, dxfFile, RS2::FormatDXFRW);
+
+    EditStats stats;
+    if (!ret) {
+        qDebug() << "ERROR: Cannot open" << dxfFile << filter.lastError();
+    } else {
+        for (const auto& [from, to]: edit.layers) {
+            if (renameLayer(graphic, from, to))
+                stats.layers++;
+        }
+        if (!edit.layers.empty())
+            graphic.updateInserts();
+        if (edit.changesAttributes())
+            stats.entities = changeAttributes(graphic, edit);
+        for (const LC_FindTextData& data: edit.texts)
+            stats.texts += graphic.replaceText(data);
+        if (edit.purgeBlocks)
+            stats.blocks = purgeBlocks(graphic);
+
+        if (!dryRun) {
+            ret = graphic.saveAs(outFile, RS2::FormatDXFRW, true);
+            if (!ret)
+                qDebug() << "ERROR: Cannot write" << outFile;
+        }
+        qDebug() << "Edited" << dxfFile << (dryRun ? QString{} : "to " + outFile) << (ret ? "Done" : "Failed");
+    }
+
+    if (manifest != nullptr) {
+        *manifest << dxfFile << '\t' << (dryRun ? QString{} : outFile) << '\t' << (ret ? "ok" : "failed")
+                  << '\t' << stats.layers << '\t' << stats.entities << '\t' << stats.texts
+                  << '\t' << stats.blocks << '\t' << timer.elapsed() << '\n';
+        manifest->flush();
+    }
+    return ret;
+}
+
+// The documents are not thread safe, fonts, patterns and settings are shared
+// by all of them. Files are edited in parallel by worker processes instead,
+// each one editing a batch of files one after another, so at most one drawing
+// per job is open.
+int runWorkers(const QStringList& dxfFiles, const QStringList& workerArgs, int jobs, QTextStream* manifest)
+{
+    // smaller batches for the last files, to keep all workers busy
+    constexpr int maxBatchSize = 32;
+
+    QTemporaryDir manifestDir;
+    // manifests of the batches, in the order of the dxf files
+    QStringList manifests;
+    QEventLoop loop;
+    int nextFile = 0;
+    int running = 0;
+    bool ok = true;
+
+    std::function<void()> startWorker = [&]() {
+        const int remaining = dxfFiles.size() - nextFile;
+        if (remaining <= 0)
+            return;
+        const int batchSize = std::clamp(remaining / jobs, 1, maxBatchSize);
+        const QString batchManifest = manifestDir.filePath(QString::number(manifests.size()));
+        manifests << batchManifest;
+
+        QStringList args = workerArgs;
+        args << "--manifest" << batchManifest << "--" << dxfFiles.mid(nextFile, batchSize);
+        nextFile += batchSize;
+
+        auto* worker = new QProcess(&loop);
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        auto workerDone = [&, worker](bool succeeded) {
+            ok = ok && succeeded;
+            worker->deleteLater();
+            running--;
+            startWorker();
+            if (running == 0)
+                loop.quit();
+        };
+        QObject::connect(worker, &QProcess::finished, &loop,
+                         [workerDone](int exitCode, QProcess::ExitStatus exitStatus) {
+            workerDone(exitStatus == QProcess::NormalExit && exitCode == EXIT_SUCCESS);
+        });
+        QObject::connect(worker, &QProcess::errorOccurred, &loop, [worker, workerDone](QProcess::ProcessError error) {
+            if (error != QProcess::FailedToStart)
+                return;
+            qDebug() << "ERROR: Failed to start worker for" << worker->arguments();
+            workerDone(false);
+        });
+        running++;
+        worker->start(QCoreApplication::applicationFilePath(), args);
+    };
+
+    for (int i = 0; i < std::min(jobs, static_cast<int>(dxfFiles.size())); i++)
+        startWorker();
+    if (running > 0)
+        loop.exec();
+
+    if (manifest != nullptr) {
+        for (const QString& batchManifest: std::as_const(manifests)) {
+            QFile file(batchManifest);
+            if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+                *manifest << file.readAll();
+        }
+        manifest->flush();
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+}
@@ -0,0 +1,34 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef CONSOLE_BATCHEDIT_H
+#define CONSOLE_BATCHEDIT_H
+
+/**
+ * Applies the same edits to many DXF files without the gui, as the console
+ * tool "librecad batchedit": layers renamed or merged, attributes changed,
+ * texts replaced and unused blocks purged.
+ */
+int console_batchedit(int argc, char* argv[]);
+
+#endif // CONSOLE_BATCHEDIT_H
@@ -0,0 +1,495 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtCore>
+
+#include "main.h"
+
+#include "console_benchmark.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_debug.h"
+#include "rs_fileio.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_information.h"
+#include "rs_layer.h"
+#include "rs_line.h"
+#include "rs_math.h"
+#include "rs_modification.h"
+#include "rs_painterqt.h"
+#include "rs_patternlist.h"
+#include "rs_selection.h"
+#include "rs_settings.h"
+#include "rs_staticgraphicview.h"
+#include "rs_system.h"
+#include "rs_text.h"
+
+namespace {
+
+// the size of the generated drawings is given by their number of entities,
+// placed in square cells of this size
+constexpr double cellSize = 10.;
+// snap and selection queries of each measured run
+constexpr int queryCount = 1000;
+// entity pairs intersected by each measured run
+constexpr unsigned intersectionPairs = 100000;
+// the size of the rendered view, in pixels
+const QSize viewSize{1920, 1080};
+
+struct BenchmarkResult {
+    QString name;
+    // the DXF file measured, empty for generated drawings
+    QString drawing;
+    unsigned entities = 0;
+    // the time of each run, in ms
+    std::vector<double> times;
+};
+
+struct BenchmarkOptions {
+    std::vector<unsigned> sizes;
+    int repeat = 5;
+    unsigned seed = 1;
+    QStringList only;
+};
+
+/**
+ * Generates a drawing of lines, arcs, circles and texts on four layers. The
+ * entities are placed cell by cell, so entities close in the entity list are
+ * close in the drawing, and the density is the same for all sizes.
+ */
+std::unique_ptr<RS_Graphic> createDrawing(unsigned size, unsigned seed)
+{
+    auto graphic = std::make_unique<RS_Graphic>();
+    graphic->newDoc();
+    std::vector<RS_Layer*> layers;
+    for (const char* name: {"lines", "arcs", "circles", "texts"}) {
+        layers.push_back(new RS_Layer(name));
+        graphic->addLayer(layers.back());
+    }
+
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<double> unit{0., 1.};
+    const unsigned columns = std::max(1u, unsigned(std::sqrt(double(size))));
+    for (unsigned i = 0; i < size; ++i) {
+        const RS_Vector corner{cellSize * (i % columns), cellSize * (i / columns)};
+        const RS_Vector p1 = corner + RS_Vector{unit(generator), unit(generator)} * cellSize;
+        const RS_Vector p2 = corner + RS_Vector{unit(generator), unit(generator)} * cellSize;
+        const double kind = unit(generator);
+        RS_Entity* e = nullptr;
+        if (kind < 0.7) {
+            e = new RS_Line(graphic.get(), p1, p2);
+            e->setLayer(layers[0]);
+        } else if (kind < 0.85) {
+            const double a1 = unit(generator) * 2. * M_PI;
+            e = new RS_Arc(graphic.get(), RS_ArcData(p1, 0.5 * cellSize * unit(generator) + 0.1,
+                                                     a1, a1 + unit(generator) * M_PI + 0.1, false));
+            e->setLayer(layers[1]);
+        } else if (kind < 0.98) {
+            e = new RS_Circle(graphic.get(), RS_CircleData(p1, 0.5 * cellSize * unit(generator) + 0.1));
+            e->setLayer(layers[2]);
+        } else {
+            e = new RS_Text(graphic.get(), RS_TextData(p1, p1, 0.1 * cellSize, 1.,
+                                                       RS_TextData::VABaseline, RS_TextData::HALeft,
+                                                       RS_TextData::None, QString("T%1").arg(i),
+                                                       "standard", 0.));
+            e->setLayer(layers[3]);
+        }
+        graphic->addEntity(e);
+    }
+    graphic->calculateBorders();
+    return graphic;
+}
+
+/**
+ * Query points within the extents of a drawing, the same ones for each run.
+ */
+std::vector<RS_Vector> queryPoints(const RS_Graphic& graphic, int count, unsigned seed)
+{
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<double> x{graphic.getMin().x, graphic.getMax().x};
+    std::uniform_real_distribution<double> y{graphic.getMin().y, graphic.getMax().y};
+    std::vector<RS_Vector> points;
+    for (int i = 0; i < count; ++i)
+        points.emplace_back(x(generator), y(generator));
+    return points;
+}
+
+// RS_Selection::selectAll() needs a graphic view
+void selectAll(RS_EntityContainer& container, bool select)
+{
+    for (RS_Entity* e: container)
+        if (e->isVisible())
+            e->setSelected(select);
+}
+
+/**
+ * Runs a benchmark, once to warm up caches and indices, then the given
+ * number of times. The setup of each run isn't measured.
+ */
+BenchmarkResult measure(const QString& name, unsigned entities, int repeat,
+                        const std::function<void()>& run,
+                        const std::function<void()>& setup = {})
+{
+    BenchmarkResult result{name, {}, entities, {}};
+    QElapsedTimer timer;
+    for (int i = 0; i <= repeat; ++i) {
+        if (setup)
+            setup();
+        timer.start();
+        run();
+        const double ms = timer.nsecsElapsed() * 1e-6;
+        if (i > 0)
+            result.times.push_back(ms);
+    }
+    qDebug().noquote() << QString("%1 %2: %3 ms").arg(name, -24).arg(entities, 8)
+                          .arg(*std::min_element(result.times.cbegin(), result.times.cend()), 0, 'f', 2);
+    return result;
+}
+
+/**
+ * Loads a DXF file, as those of the dxfgen tool, to be measured instead of a
+ * generated drawing.
+ */
+std::unique_ptr<RS_Graphic> loadDrawing(const QString& file)
+{
+    auto graphic = std::make_unique<RS_Graphic>();
+    graphic->newDoc();
+    if (!RS_FileIO::instance()->fileImport(*graphic, file, RS2::FormatUnknown))
+        return {};
+    graphic->calculateBorders();
+    return graphic;
+}
+
+// the drawing is given by a DXF file or generated
+void runBenchmarks(std::unique_ptr<RS_Graphic> graphic, const QString& drawing,
+                   const BenchmarkOptions& options, const QString& tempDir,
+                   std::vector<BenchmarkResult>& results)
+{
+    const size_t first = results.size();
+    const unsigned size = graphic->count();
+    // the typical distance of entities, a cell of generated drawings
+    const RS_Vector extents = graphic->getMax() - graphic->getMin();
+    const double cell = std::max(extents.x, extents.y) / std::max(1., std::sqrt(double(size)));
+    const auto enabled = [&options](const QString& name) {
+        return options.only.isEmpty() || options.only.contains(name);
+    };
+    const auto add = [&results](BenchmarkResult result) {
+        results.push_back(std::move(result));
+    };
+
+    const QString dxfFile = tempDir + QString("/benchmark_%1.dxf").arg(first);
+
+    if (enabled("dxf_save") || enabled("dxf_load")) {
+        add(measure("dxf_save", size, options.repeat, [&] {
+            RS_FileIO::instance()->fileExport(*graphic, dxfFile, RS2::FormatDXFRW);
+        }));
+    }
+    if (enabled("dxf_load")) {
+        std::unique_ptr<RS_Graphic> loaded;
+        add(measure("dxf_load", size, options.repeat, [&] {
+            RS_FileIO::instance()->fileImport(*loaded, dxfFile, RS2::FormatDXFRW);
+        }, [&] {
+            loaded = std::make_unique<RS_Graphic>();
+            loaded->newDoc();
+        }));
+    }
+
+    if (enabled("redraw")) {
+        RS_StaticGraphicView view(viewSize.width(), viewSize.height(), nullptr);
+        view.setContainer(graphic.get());
+        view.zoomAuto(false);
+        QImage image(viewSize, QImage::Format_ARGB32_Premultiplied);
+        add(measure("redraw", size, options.repeat, [&] {
+            RS_PainterQt painter(&image);
+            painter.beginBatch();
+            view.drawEntity(&painter, graphic.get());
+            painter.endBatch();
+            painter.end();
+        }, [&] {
+            image.fill(Qt::white);
+        }));
+    }
+
+    const std::vector<RS_Vector> points = queryPoints(*graphic, queryCount, options.seed);
+    if (enabled("snap_endpoint")) {
+        add(measure("snap_endpoint", size, options.repeat, [&] {
+            for (const RS_Vector& p: points)
+                graphic->getNearestEndpoint(p);
+        }));
+    }
+    if (enabled("snap_entity")) {
+        add(measure("snap_entity", size, options.repeat, [&] {
+            for (const RS_Vector& p: points)
+                graphic->getNearestPointOnEntity(p);
+        }));
+    }
+
+    if (enabled("select_window")) {
+        // windows of a tenth of the drawing extents
+        const RS_Vector window = (graphic->getMax() - graphic->getMin()) * 0.1;
+        RS_Selection selection(*graphic);
+        add(measure("select_window", size, options.repeat, [&] {
+            for (const RS_Vector& p: points)
+                selection.selectWindow(RS2::EntityUnknown, p, p + window);
+        }, [&] {
+            selectAll(*graphic, false);
+        }));
+        selectAll(*graphic, false);
+    }
+
+    if (enabled("intersections")) {
+        std::vector<RS_Entity*> entities{graphic->begin(), graphic->end()};
+        add(measure("intersections", size, options.repeat, [&] {
+            // neighbours in the entity list are placed next to each other
+            for (unsigned i = 0; i < intersectionPairs && entities.size() > 3; ++i) {
+                const size_t first = i % (entities.size() - 3);
+                RS_Information::getIntersection(entities[first], entities[first + 1 + i % 3], true);
+            }
+        }));
+    }
+
+    if (enabled("hatch_regen")) {
+        // a hatch of the whole drawing, with a pattern line per cell
+        const RS_Vector& min = graphic->getMin();
+        const RS_Vector& max = graphic->getMax();
+        RS_Graphic hatchGraphic;
+        hatchGraphic.newDoc();
+        auto* hatch = new RS_Hatch(&hatchGraphic, RS_HatchData(false, cell / 3.175, 0., "ANSI31"));
+        auto* loop = new RS_EntityContainer(hatch);
+        loop->setPen(RS_Pen(RS2::FlagInvalid));
+        const RS_Vector corners[] = {min, {max.x, min.y}, max, {min.x, max.y}};
+        for (int i = 0; i < 4; ++i)
+            loop->addEntity(new RS_Line(loop, corners[i], corners[(i + 1) % 4]));
+        hatch->addEntity(loop);
+        hatchGraphic.addEntity(hatch);
+        hatch->update();
+        if (hatch->getUpdateError() == RS_Hatch::HATCH_OK)
+            add(measure("hatch_regen", size, options.repeat, [&] {
+                hatch->update();
+            }));
+        else
+            qDebug() << "WARNING: Skipping hatch_regen, the hatch can't be updated, error" << hatch->getUpdateError();
+    }
+
+    if (enabled("move_undo_redo")) {
+        // moves all entities at once, as one undo cycle; the moved entities are
+        // undone before each run, and their originals selected again
+        RS_MoveData data;
+        data.offset = {cell, 0.};
+        add(measure("move", size, options.repeat, [&] {
+            RS_Modification(*graphic).move(data);
+        }, [&] {
+            graphic->undo();
+            selectAll(*graphic, true);
+        }));
+        add(measure("undo", size, options.repeat, [&] {
+            graphic->undo();
+        }, [&] {
+            graphic->redo();
+        }));
+        add(measure("redo", size, options.repeat, [&] {
+            graphic->redo();
+        }, [&] {
+            graphic->undo();
+        }));
+    }
+
+    for (size_t i = first; i < results.size(); ++i)
+        results[i].drawing = drawing;
+}
+
+std::vector<unsigned> parseSizes(const QString& arg)
+{
+    std::vector<unsigned> sizes;
+    for (const QString& size: arg.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const unsigned value = size.trimmed().toUInt(&ok);
+        if (ok && value > 0)
+            sizes.push_back(value);
+        else
+            qDebug() << "WARNING: Ignoring incorrect drawing size:" << size;
+    }
+    return sizes;
+}
+
+// the results with the minimum, median and mean time of the runs of each benchmark
+QJsonDocument toJson(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options)
+{
+    QJsonArray benchmarks;
+    for (const BenchmarkResult& result: results) {
+        std::vector<double> times = result.times;
+        std::sort(times.begin(), times.end());
+        const double mean = std::accumulate(times.cbegin(), times.cend(), 0.) / times.size();
+        benchmarks.append(QJsonObject{
+            {"name", result.name},
+            {"drawing", result.drawing},
+            {"entities", qint64(result.entities)},
+            {"runs", int(times.size())},
+            {"min_ms", times.front()},
+            {"median_ms", times[times.size() / 2]},
+            {"mean_ms", mean}
+        });
+    }
+    return QJsonDocument{QJsonObject{
+        {"version", XSTR(LC_VERSION)},
+        {"qt", qVersion()},
+        {"threads", int(std::thread::hardware_concurrency())},
+        {"seed", qint64(options.seed)},
+        {"results", benchmarks}
+    }};
+}
+}
+
+/**
+ * Measures the engine hot paths on generated drawings of given sizes, or on
+ * the given DXF files: DXF
+ * saving and loading, rendering the whole drawing, snapping, window selection,
+ * intersections, hatch updates, and moving all entities with undo and redo.
+ * The generated drawings only depend on the seed, so results of different
+ * builds can be compared.
+ */
+int console_benchmark(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString librecad;
+    if (prgInfo.baseName() != "benchmark")
+        librecad = prgInfo.filePath() + " benchmark";
+    QString appDesc = "\nMeasure the engine on generated drawings or DXF files.";
+    appDesc += "\n\n";
+    appDesc += "Benchmarks: dxf_save, dxf_load, redraw, snap_endpoint, snap_entity, select_window,\n";
+    appDesc += "intersections, hatch_regen, move_undo_redo.\n\n";
+    appDesc += "Examples:\n\n";
+    appDesc += "  " + librecad + " -o results.json";
+    appDesc += "    -- run all benchmarks on drawings of 10k, 100k and 1M entities.\n";
+    appDesc += "  " + librecad + " -s 100000 --only redraw,snap_entity";
+    appDesc += "    -- run two benchmarks on a drawing of 100k entities.\n";
+    appDesc += "  " + librecad + " large.dxf";
+    appDesc += "    -- run all benchmarks on a drawing created by the dxfgen tool.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Write the results as JSON.", "file");
+    parser.addOption(outFileOpt);
+
+    QCommandLineOption sizesOpt(QStringList() << "s" << "sizes",
+        "Comma separated numbers of entities of the drawings, 10000,100000,1000000 by default.", "list");
+    parser.addOption(sizesOpt);
+
+    QCommandLineOption repeatOpt(QStringList() << "r" << "repeat",
+        "Measured runs of each benchmark, 5 by default.", "integer");
+    parser.addOption(repeatOpt);
+
+    QCommandLineOption seedOpt(QStringList() << "seed",
+        "Seed of the generated drawings, 1 by default.", "integer");
+    parser.addOption(seedOpt);
+
+    QCommandLineOption onlyOpt(QStringList() << "only",
+        "Comma separated names of the benchmarks to run.", "list");
+    parser.addOption(onlyOpt);
+
+    parser.addPositionalArgument("<dxf_files>", "Drawings to measure instead of generated ones.");
+
+    parser.process(app);
+
+    BenchmarkOptions options;
+    options.sizes = parseSizes(parser.isSet(sizesOpt) ? parser.value(sizesOpt) : "10000,100000,1000000");
+    if (options.sizes.empty())
+        parser.showHelp(EXIT_FAILURE);
+    if (parser.isSet(repeatOpt))
+        options.repeat = std::max(1, parser.value(repeatOpt).toInt());
+    if (parser.isSet(seedOpt))
+        options.seed = parser.value(seedOpt).toUInt();
+    if (parser.isSet(onlyOpt))
+        options.only = parser.value(onlyOpt).split(',', Qt::SkipEmptyParts);
+
+    QFile outFile(parser.value(outFileOpt));
+    if (parser.isSet(outFileOpt) && !outFile.open(QIODevice::WriteOnly)) {
+        qDebug() << "ERROR: Cannot write results" << outFile.fileName();
+        return EXIT_FAILURE;
+    }
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "ERROR: Cannot create a temporary directory";
+        return EXIT_FAILURE;
+    }
+
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    std::vector<BenchmarkResult> results;
+    const QStringList files = parser.positionalArguments();
+    for (const QString& file: files) {
+        std::unique_ptr<RS_Graphic> graphic = loadDrawing(file);
+        if (!graphic) {
+            qDebug() << "ERROR: Cannot load" << file;
+            return EXIT_FAILURE;
+        }
+        runBenchmarks(std::move(graphic), QFileInfo(file).fileName(), options, tempDir.path(), results);
+    }
+    if (files.isEmpty()) {
+        for (unsigned size: options.sizes)
+            runBenchmarks(createDrawing(size, options.seed), {}, options, tempDir.path(), results);
+    }
+
+    if (outFile.isOpen())
+        outFile.write(toJson(results, options).toJson());
+    return EXIT_SUCCESS;
+}
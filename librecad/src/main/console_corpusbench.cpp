@@ -0,0 +1,371 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtCore>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "main.h"
+
+#include "console_corpusbench.h"
+#include "lc_tracing.h"
+#include "rs_blocklist.h"
+#include "rs_debug.h"
+#include "rs_filterdxfrw.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_layerlist.h"
+#include "rs_painterqt.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_staticgraphicview.h"
+#include "rs_system.h"
+
+namespace {
+
+struct CorpusResult {
+    QString file;
+    qint64 fileSize = 0;
+    // empty if the drawing was measured
+    QString error;
+    // the phases of loading, in ms
+    double parse = 0.;
+    double create = 0.;
+    double update = 0.;
+    double load = 0.;
+    double render = 0.;
+    double save = 0.;
+    // in kB, negative if unknown
+    qint64 peakMemory = -1;
+    unsigned entities = 0;
+    unsigned entitiesDeep = 0;
+    unsigned blocks = 0;
+    unsigned layers = 0;
+};
+
+#ifdef Q_OS_LINUX
+// the peak resident size of this process is reset for each file
+constexpr bool peakMemoryPerFile = true;
+#else
+// the peak resident size of this process since it started
+constexpr bool peakMemoryPerFile = false;
+#endif
+
+void resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile clearRefs("/proc/self/clear_refs");
+    if (clearRefs.open(QIODevice::WriteOnly))
+        clearRefs.write("5");
+#endif
+}
+
+// the peak resident size, in kB, or -1 if it can't be found on this platform
+qint64 getPeakMemory()
+{
+#if defined(Q_OS_LINUX)
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+    for (QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine()) {
+        if (line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+    }
+    return -1;
+#elif defined(Q_OS_UNIX)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef Q_OS_MACOS
+    // in bytes
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+double totalMs(const std::map<std::string, LC_Tracing::Total>& totals, const char* name, bool self = false)
+{
+    const auto it = totals.find(name);
+    if (it == totals.cend())
+        return 0.;
+    return (self ? it->second.self : it->second.duration) * 1e-3;
+}
+
+/**
+ * Finds the DXF and DWG files of the given files and directories, in the
+ * alphabetical order of each directory, so runs of different builds list
+ * the files in the same order.
+ */
+QStringList findDrawings(const QStringList& paths)
+{
+    QStringList drawings;
+    for (const QString& path: paths) {
+        if (!QFileInfo(path).isDir()) {
+            drawings << path;
+            continue;
+        }
+        QStringList found;
+        QDirIterator it(path, {"*.dxf", "*.dwg"}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            found << it.next();
+        found.sort();
+        drawings << found;
+    }
+    return drawings;
+}
+
+/**
+ * Loads a drawing, as the document loader does, then renders the whole
+ * drawing and saves it as DXF. The parse time is the time spent reading the
+ * file, not in the filter creating the entities, traced by LC_TraceScope; the
+ * update time covers the inserts and the borders of the loaded drawing.
+ */
+CorpusResult measureDrawing(const QString& file, QSize viewSize, const QString& tempDir)
+{
+    CorpusResult result;
+    result.file = file;
+    result.fileSize = QFileInfo(file).size();
+
+    resetPeakMemory();
+    LC_Tracing::clear();
+
+    const RS2::FormatType format = file.endsWith(".dwg", Qt::CaseInsensitive) ? RS2::FormatDWG
+                                                                              : RS2::FormatDXFRW;
+    auto graphic = std::make_unique<RS_Graphic>();
+    graphic->beginOpen(file);
+    QElapsedTimer timer;
+    timer.start();
+    bool imported = false;
+    {
+        RS_FilterDXFRW filter;
+        imported = filter.fileImport(*graphic, file, format);
+        if (!imported)
+            result.error = filter.lastError();
+    }
+    if (!imported) {
+        if (result.error.isEmpty())
+            result.error = "Cannot load the drawing";
+        return result;
+    }
+    graphic->calculateBorders();
+    result.load = timer.nsecsElapsed() * 1e-6;
+
+    const std::map<std::string, LC_Tracing::Total> totals = LC_Tracing::totals();
+    const double read = totalMs(totals, "dxfRW::read") + totalMs(totals, "dwgR::read");
+    result.parse = totalMs(totals, "dxfRW::read", true) + totalMs(totals, "dwgR::read", true);
+    result.create = read - result.parse;
+    result.update = result.load - read;
+
+    {
+        RS_StaticGraphicView view(viewSize.width(), viewSize.height(), nullptr);
+        view.setContainer(graphic.get());
+        view.zoomAuto(false);
+        QImage image(viewSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        timer.start();
+        RS_PainterQt painter(&image);
+        painter.beginBatch();
+        view.drawEntity(&painter, graphic.get());
+        painter.endBatch();
+        painter.end();
+        result.render = timer.nsecsElapsed() * 1e-6;
+    }
+
+    const QString dxfFile = tempDir + "/corpusbench.dxf";
+    timer.start();
+    if (!RS_FilterDXFRW().fileExport(*graphic, dxfFile, RS2::FormatDXFRW))
+        result.error = "Cannot save the drawing";
+    result.save = timer.nsecsElapsed() * 1e-6;
+    QFile::remove(dxfFile);
+
+    // lazily loaded blocks and entities are created by now
+    result.entities = graphic->count();
+    result.entitiesDeep = graphic->countDeep();
+    result.blocks = unsigned(graphic->getBlockList()->count());
+    result.layers = graphic->getLayerList()->count();
+    result.peakMemory = getPeakMemory();
+    return result;
+}
+
+QJsonDocument toJson(const std::vector<CorpusResult>& results, QSize viewSize)
+{
+    QJsonArray drawings;
+    for (const CorpusResult& result: results) {
+        QJsonObject drawing{
+            {"file", result.file},
+            {"file_size", result.fileSize}
+        };
+        if (!result.error.isEmpty())
+            drawing.insert("error", result.error);
+        if (result.load > 0.) {
+            drawing.insert("parse_ms", result.parse);
+            drawing.insert("create_ms", result.create);
+            drawing.insert("update_ms", result.update);
+            drawing.insert("load_ms", result.load);
+            drawing.insert("render_ms", result.render);
+            drawing.insert("save_ms", result.save);
+            drawing.insert("entities", qint64(result.entities));
+            drawing.insert("entities_deep", qint64(result.entitiesDeep));
+            drawing.insert("blocks", qint64(result.blocks));
+            drawing.insert("layers", qint64(result.layers));
+        }
+        if (result.peakMemory >= 0)
+            drawing.insert("peak_memory_kb", result.peakMemory);
+        drawings.append(drawing);
+    }
+    return QJsonDocument{QJsonObject{
+        {"version", XSTR(LC_VERSION)},
+        {"qt", qVersion()},
+        {"threads", int(std::thread::hardware_concurrency())},
+        {"view", QString("%1x%2").arg(viewSize.width()).arg(viewSize.height())},
+        {"peak_memory_per_file", peakMemoryPerFile},
+        {"drawings", drawings}
+    }};
+}
+}
+
+/**
+ * Measures each drawing of a corpus of DXF and DWG files: the time of the
+ * load phases, rendering the whole drawing and saving it as DXF, the peak
+ * memory and the entity counts. Real drawings catch regressions, which the
+ * generated drawings of the benchmark tool miss.
+ */
+int console_corpusbench(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    QString prgDir(prgInfo.absolutePath());
+    RS_SETTINGS->init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+        XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+    QCommandLineParser parser;
+
+    QString librecad;
+    if (prgInfo.baseName() != "corpusbench")
+        librecad = prgInfo.filePath() + " corpusbench";
+    QString appDesc = "\nMeasure loading, rendering and saving the DXF and DWG files of a corpus.";
+    appDesc += "\n\n";
+    appDesc += "Records per file the parse, entity creation and update times of loading,\n";
+    appDesc += "the render and save times, the peak memory and the entity counts, as JSON.\n\n";
+    appDesc += "Examples:\n\n";
+    appDesc += "  " + librecad + " -o results.json drawings/";
+    appDesc += "    -- measure all drawings in the directory and its subdirectories.\n";
+    appDesc += "  " + librecad + " plan.dxf site.dwg";
+    appDesc += "    -- measure two drawings, printing the JSON.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Write the results as JSON to the file instead of the standard output.", "file");
+    parser.addOption(outFileOpt);
+
+    QCommandLineOption viewOpt(QStringList() << "s" << "size",
+        "Size of the rendered view, 1920x1080 by default.", "WxH");
+    parser.addOption(viewOpt);
+
+    parser.addPositionalArgument("<paths>", "DXF or DWG files, or directories of them.");
+
+    parser.process(app);
+
+    const QStringList drawings = findDrawings(parser.positionalArguments());
+    if (drawings.isEmpty())
+        parser.showHelp(EXIT_FAILURE);
+
+    QSize viewSize{1920, 1080};
+    if (parser.isSet(viewOpt)) {
+        const QStringList size = parser.value(viewOpt).split('x');
+        const int width = size.value(0).toInt();
+        const int height = size.value(1).toInt();
+        if (size.size() != 2 || width <= 0 || height <= 0) {
+            qDebug() << "ERROR: Incorrect view size:" << parser.value(viewOpt);
+            return EXIT_FAILURE;
+        }
+        viewSize = {width, height};
+    }
+
+    QFile outFile(parser.value(outFileOpt));
+    if (parser.isSet(outFileOpt) ? !outFile.open(QIODevice::WriteOnly)
+                                 : !outFile.open(stdout, QIODevice::WriteOnly)) {
+        qDebug() << "ERROR: Cannot write results" << outFile.fileName();
+        return EXIT_FAILURE;
+    }
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "ERROR: Cannot create a temporary directory";
+        return EXIT_FAILURE;
+    }
+
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    // the load phases are found from the traced scopes
+    LC_Tracing::setEnabled(true);
+
+    std::vector<CorpusResult> results;
+    for (const QString& file: drawings) {
+        results.push_back(measureDrawing(file, viewSize, tempDir.path()));
+        const CorpusResult& result = results.back();
+        if (result.load > 0.)
+            qDebug().noquote() << QString("%1: load %2 ms, render %3 ms, save %4 ms, %5 entities")
+                                  .arg(file).arg(result.load, 0, 'f', 1).arg(result.render, 0, 'f', 1)
+                                  .arg(result.save, 0, 'f', 1).arg(result.entitiesDeep);
+        else
+            qDebug().noquote() << QString("%1: ERROR: %2").arg(file, result.error);
+    }
+    LC_Tracing::setEnabled(false);
+
+    outFile.write(toJson(results, viewSize).toJson());
+    return EXIT_SUCCESS;
+}
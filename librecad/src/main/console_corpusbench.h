@@ -0,0 +1,33 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef CONSOLE_CORPUSBENCH_H
+#define CONSOLE_CORPUSBENCH_H
+
+/**
+ * Measures loading, rendering and saving the DXF and DWG files of a
+ * drawing corpus, as the console tool "librecad corpusbench".
+ */
+int console_corpusbench(int argc, char* argv[]);
+
+#endif // CONSOLE_CORPUSBENCH_H
@@ -0,0 +1,644 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QtCore>
+
+#include "main.h"
+
+#include "console_dwg2dxf.h"
+#include "libdwgr.h"
+#include "libdxfrw.h"
+#include "rs_debug.h"
+
+namespace {
+
+/**
+ * Keeps a drawing as read from a DWG file, in the objects of libdxfrw, and
+ * writes it back to the DXF writer. The writer asks for the sections in the
+ * order of the DXF file, and the DWG reader decodes the whole file first,
+ * so the drawing is kept in memory, without the LibreCAD document for it.
+ */
+class DwgConverter: public DRW_Interface {
+public:
+    bool convert(const QString& dwgFile, const QString& dxfFile, DRW::Version dxfVersion, bool binary);
+
+    QString lastError() const { return error; }
+    DRW::Version dwgVersion() const { return version; }
+    int countEntities() const { return entityCount; }
+
+    // reading
+    void addHeader(const DRW_Header* data) override { header = *data; }
+    void addLType(const DRW_LType& data) override { lineTypes.push_back(data); }
+    void addLayer(const DRW_Layer& data) override { layers.push_back(data); }
+    void addDimStyle(const DRW_Dimstyle& data) override { dimStyles.push_back(data); }
+    void addVport(const DRW_Vport& data) override { vports.push_back(data); }
+    void addTextStyle(const DRW_Textstyle& data) override { textStyles.push_back(data); }
+    void addAppId(const DRW_AppId& data) override { appIds.push_back(data); }
+    void addBlock(const DRW_Block& data) override;
+    void setBlock(const int handle) override;
+    void endBlock() override { current = &entities; }
+
+    void addPoint(const DRW_Point& data) override { add(data); }
+    void addLine(const DRW_Line& data) override { add(data); }
+    void addRay(const DRW_Ray& data) override { add(data); }
+    void addXline(const DRW_Xline& data) override { add(data); }
+    void addArc(const DRW_Arc& data) override { add(data); }
+    void addCircle(const DRW_Circle& data) override { add(data); }
+    void addEllipse(const DRW_Ellipse& data) override { add(data); }
+    void addLWPolyline(const DRW_LWPolyline& data) override { add(data); }
+    void addPolyline(const DRW_Polyline& data) override { add(data); }
+    void addSpline(const DRW_Spline* data) override { add(*data); }
+    // the knots are in the spline
+    void addKnot(const DRW_Entity&) override {}
+    void addInsert(const DRW_Insert& data) override { add(data); }
+    void addTrace(const DRW_Trace& data) override { add(data); }
+    void add3dFace(const DRW_3Dface& data) override { add(data); }
+    void addSolid(const DRW_Solid& data) override { add(data); }
+    void addMText(const DRW_MText& data) override { add(data); }
+    void addText(const DRW_Text& data) override { add(data); }
+    void addDimAlign(const DRW_DimAligned* data) override { add(*data); }
+    void addDimLinear(const DRW_DimLinear* data) override { add(*data); }
+    void addDimRadial(const DRW_DimRadial* data) override { add(*data); }
+    void addDimDiametric(const DRW_DimDiametric* data) override { add(*data); }
+    void addDimAngular(const DRW_DimAngular* data) override { add(*data); }
+    void addDimAngular3P(const DRW_DimAngular3p* data) override { add(*data); }
+    void addDimOrdinate(const DRW_DimOrdinate* data) override { add(*data); }
+    void addLeader(const DRW_Leader* data) override { add(*data); }
+    void addHatch(const DRW_Hatch* data) override { add(*data); }
+    void addViewport(const DRW_Viewport& data) override { add(data); }
+    void addImage(const DRW_Image* data) override { add(*data); }
+    void linkImage(const DRW_ImageDef* data) override { imageDefs.emplace(data->handle, *data); }
+    void addComment(const char*) override {}
+    void addPlotSettings(const DRW_PlotSettings* data) override { plotSettings = std::make_unique<DRW_PlotSettings>(*data); }
+
+    // writing
+    void writeHeader(DRW_Header& data) override { data = header; }
+    void writeBlocks() override;
+    void writeBlockRecords() override;
+    void writeEntities() override;
+    void writeLTypes() override;
+    void writeLayers() override;
+    void writeTextstyles() override;
+    void writeVports() override;
+    void writeDimstyles() override;
+    void writeObjects() override;
+    void writeAppId() override;
+
+private:
+    using Entities = std::vector<std::unique_ptr<DRW_Entity>>;
+
+    struct Block {
+        DRW_Block data;
+        Entities entities;
+    };
+
+    template<class T>
+    void add(const T& data)
+    {
+        current->push_back(std::make_unique<T>(data));
+    }
+    void writeEntity(DRW_Entity* entity);
+
+    DRW_Header header;
+    // table entries are copied by construction only, they own their extended data
+    std::vector<DRW_LType> lineTypes;
+    std::vector<DRW_Layer> layers;
+    std::vector<DRW_Dimstyle> dimStyles;
+    std::vector<DRW_Vport> vports;
+    std::vector<DRW_Textstyle> textStyles;
+    std::vector<DRW_AppId> appIds;
+    std::vector<std::unique_ptr<Block>> blocks;
+    //! the entities of the model and paper spaces, the space is kept in the entities
+    Entities entities;
+    //! the entities of the blocks, by the handle of their block record
+    std::map<int, Entities*> containers;
+    Entities* current = &entities;
+    std::map<duint32, DRW_ImageDef> imageDefs;
+    std::unique_ptr<DRW_PlotSettings> plotSettings;
+
+    dxfRW* writer = nullptr;
+    DRW::Version version = DRW::UNKNOWNV;
+    int entityCount = 0;
+    QString error;
+};
+
+QString dwgErrorText(DRW::error error)
+{
+    switch (error) {
+    case DRW::BAD_OPEN:
+        return "cannot open the file";
+    case DRW::BAD_VERSION:
+        return "unsupported version";
+    case DRW::BAD_READ_METADATA:
+        return "cannot read the metadata";
+    case DRW::BAD_READ_FILE_HEADER:
+        return "cannot read the file header";
+    case DRW::BAD_READ_HEADER:
+        return "cannot read the header variables";
+    case DRW::BAD_READ_HANDLES:
+        return "cannot read the object map";
+    case DRW::BAD_READ_CLASSES:
+        return "cannot read the classes";
+    case DRW::BAD_READ_TABLES:
+        return "cannot read the tables";
+    case DRW::BAD_READ_BLOCKS:
+        return "cannot read the blocks";
+    case DRW::BAD_READ_ENTITIES:
+        return "cannot read the entities";
+    case DRW::BAD_READ_OBJECTS:
+        return "cannot read the objects";
+    default:
+        return "unknown error";
+    }
+}
+
+QString versionText(DRW::Version version)
+{
+    switch (version) {
+    case DRW::AC1009:
+        return "R12";
+    case DRW::AC1012:
+        return "R13";
+    case DRW::AC1014:
+        return "R14";
+    case DRW::AC1015:
+        return "2000";
+    case DRW::AC1018:
+        return "2004";
+    case DRW::AC1021:
+        return "2007";
+    case DRW::AC1024:
+        return "2010";
+    case DRW::AC1027:
+        return "2013";
+    case DRW::AC1032:
+        return "2018";
+    default:
+        return "unknown";
+    }
+}
+
+bool convertFile(const QString& dwgFile, const QString& dxfFile, DRW::Version dxfVersion, bool binary,
+                 QTextStream* manifest);
+int runWorkers(const QStringList& dwgFiles, const QStringList& workerArgs, int jobs, QTextStream* manifest);
+}
+
+/////////
+/// \brief console_dwg2dxf is called if librecad is run
+/// as console dwg2dxf tool for converting DWG files.
+/// \param argc
+/// \param argv
+/// \return
+///
+int console_dwg2dxf(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    // neither fonts nor settings are needed, the drawings are only copied
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+
+    QCommandLineParser parser;
+
+    QString librecad;
+    if (prgInfo.baseName() != "dwg2dxf")
+        librecad = prgInfo.filePath() + " dwg2dxf";
+    QString appDesc = "\nConvert DWG files to DXF.";
+    appDesc += "\n\n";
+    appDesc += "Examples:\n\n";
+    appDesc += "  " + librecad + " *.dwg";
+    appDesc += "    -- convert each file to a DXF file next to it.\n";
+    appDesc += "  " + librecad + " -j 8 --dxf-version R12 -t dxf --manifest convert.tsv *.dwg";
+    appDesc += "    -- convert to R12, 8 files at a time.\n";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption versionOpt(QStringList() << "dxf-version",
+        "Version of the DXF files: 2007 (default), 2004, 2000, R14 or R12.", "version");
+    parser.addOption(versionOpt);
+
+    QCommandLineOption binaryOpt(QStringList() << "b" << "binary",
+        "Write binary DXF files.");
+    parser.addOption(binaryOpt);
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Output DXF file, for a single DWG file.", "file");
+    parser.addOption(outFileOpt);
+
+    QCommandLineOption outDirOpt(QStringList() << "t" << "directory",
+        "Write the DXF files to this directory, instead of next to the DWG files.", "dir");
+    parser.addOption(outDirOpt);
+
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        "Convert files in parallel worker processes, each one holding one drawing at a time.", "integer");
+    parser.addOption(jobsOpt);
+
+    QCommandLineOption manifestOpt(QStringList() << "manifest",
+        "Write a tab separated line per file: dwg file, dxf file, status, DWG version, "
+        "number of entities, time in ms.",
+        "file");
+    parser.addOption(manifestOpt);
+
+    parser.addPositionalArgument("<dwg_files>", "Input DWG files");
+
+    parser.process(app);
+
+    QStringList dwgFiles;
+    for (const QString& arg: parser.positionalArguments()) {
+        if (QFileInfo(arg).suffix().toLower() == "dwg")
+            dwgFiles.append(arg);
+    }
+    if (dwgFiles.isEmpty())
+        parser.showHelp(EXIT_FAILURE);
+
+    const QString outFile = parser.value(outFileOpt);
+    if (!outFile.isEmpty() && dwgFiles.size() > 1) {
+        qDebug() << "ERROR: An output file is given for more than one DWG file";
+        return EXIT_FAILURE;
+    }
+
+    static const std::map<QString, DRW::Version> dxfVersions{
+        {"2007", DRW::AC1021}, {"2004", DRW::AC1018}, {"2000", DRW::AC1015},
+        {"R14", DRW::AC1014}, {"R12", DRW::AC1009}};
+    DRW::Version dxfVersion = DRW::AC1021;
+    if (parser.isSet(versionOpt)) {
+        const auto it = dxfVersions.find(parser.value(versionOpt).toUpper());
+        if (it == dxfVersions.end()) {
+            qDebug() << "ERROR: Unknown DXF version" << parser.value(versionOpt);
+            return EXIT_FAILURE;
+        }
+        dxfVersion = it->second;
+    }
+
+    const QString outDir = parser.value(outDirOpt);
+    if (!outDir.isEmpty() && !QDir().mkpath(outDir)) {
+        qDebug() << "ERROR: Cannot create" << outDir;
+        return EXIT_FAILURE;
+    }
+
+    QFile manifestFile(parser.value(manifestOpt));
+    QTextStream manifest(&manifestFile);
+    if (parser.isSet(manifestOpt) && !manifestFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "ERROR: Cannot write manifest" << manifestFile.fileName();
+        return EXIT_FAILURE;
+    }
+
+    bool jobsOk = false;
+    const int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+    if (jobsOk && jobs > 1 && dwgFiles.size() > 1) {
+        // workers are started with the same version and output
+        QStringList workerArgs;
+        if (prgInfo.baseName() != "dwg2dxf")
+            workerArgs << "dwg2dxf";
+        for (const QCommandLineOption* option: {&versionOpt, &binaryOpt, &outDirOpt}) {
+            if (!parser.isSet(*option))
+                continue;
+            workerArgs << "--" + option->names().last();
+            if (!option->valueName().isEmpty())
+                workerArgs << parser.value(*option);
+        }
+        return runWorkers(dwgFiles, workerArgs, jobs, manifestFile.isOpen() ? &manifest : nullptr);
+    }
+
+    const bool binary = parser.isSet(binaryOpt);
+    bool ok = true;
+    for (const QString& dwgFile: dwgFiles) {
+        QFileInfo dwgInfo(dwgFile);
+        QString dxfFile = outFile;
+        if (dxfFile.isEmpty()) {
+            const QString name = dwgInfo.completeBaseName() + ".dxf";
+            dxfFile = outDir.isEmpty() ? dwgInfo.dir().filePath(name) : QDir(outDir).filePath(name);
+        }
+        ok = convertFile(dwgFile, dxfFile, dxfVersion, binary, manifestFile.isOpen() ? &manifest : nullptr) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+namespace {
+
+bool DwgConverter::convert(const QString& dwgFile, const QString& dxfFile, DRW::Version dxfVersion, bool binary)
+{
+    dwgR reader(QFile::encodeName(dwgFile));
+    reader.setParallel(true);
+    const bool read = reader.read(this, true);
+    version = reader.getVersion();
+    if (!read) {
+        error = dwgErrorText(reader.getError());
+        return false;
+    }
+
+    dxfRW dxf(QFile::encodeName(dxfFile));
+    writer = &dxf;
+    const bool written = dxf.write(this, dxfVersion, binary);
+    writer = nullptr;
+    if (!written)
+        error = "cannot write " + dxfFile;
+    return written;
+}
+
+void DwgConverter::addBlock(const DRW_Block& data)
+{
+    // the entities of the model and paper spaces are written as entities
+    const QString name = QString::fromUtf8(data.name.c_str()).mid(1, 11).toLower();
+    if (name == "model_space" || name == "paper_space") {
+        containers[data.parentHandle] = &entities;
+        current = &entities;
+        return;
+    }
+    blocks.push_back(std::make_unique<Block>(Block{data, {}}));
+    current = &blocks.back()->entities;
+    containers[data.parentHandle] = current;
+}
+
+void DwgConverter::setBlock(const int handle)
+{
+    const auto it = containers.find(handle);
+    current = it != containers.end() ? it->second : &entities;
+}
+
+void DwgConverter::writeBlockRecords()
+{
+    for (const auto& block: blocks)
+        writer->writeBlockRecord(block->data.name);
+}
+
+void DwgConverter::writeBlocks()
+{
+    for (const auto& block: blocks) {
+        writer->writeBlock(&block->data);
+        for (const auto& entity: block->entities)
+            writeEntity(entity.get());
+    }
+}
+
+void DwgConverter::writeEntities()
+{
+    for (const auto& entity: entities)
+        writeEntity(entity.get());
+}
+
+void DwgConverter::writeEntity(DRW_Entity* entity)
+{
+    entityCount++;
+    switch (entity->eType) {
+    case DRW::POINT:
+        writer->writePoint(static_cast<DRW_Point*>(entity));
+        break;
+    case DRW::LINE:
+        writer->writeLine(static_cast<DRW_Line*>(entity));
+        break;
+    case DRW::RAY:
+        writer->writeRay(static_cast<DRW_Ray*>(entity));
+        break;
+    case DRW::XLINE:
+        writer->writeXline(static_cast<DRW_Xline*>(entity));
+        break;
+    case DRW::CIRCLE:
+        writer->writeCircle(static_cast<DRW_Circle*>(entity));
+        break;
+    case DRW::ARC:
+        writer->writeArc(static_cast<DRW_Arc*>(entity));
+        break;
+    case DRW::ELLIPSE:
+        writer->writeEllipse(static_cast<DRW_Ellipse*>(entity));
+        break;
+    case DRW::TRACE:
+        writer->writeTrace(static_cast<DRW_Trace*>(entity));
+        break;
+    case DRW::SOLID:
+        writer->writeSolid(static_cast<DRW_Solid*>(entity));
+        break;
+    case DRW::E3DFACE:
+        writer->write3dface(static_cast<DRW_3Dface*>(entity));
+        break;
+    case DRW::LWPOLYLINE:
+        writer->writeLWPolyline(static_cast<DRW_LWPolyline*>(entity));
+        break;
+    case DRW::POLYLINE:
+        writer->writePolyline(static_cast<DRW_Polyline*>(entity));
+        break;
+    case DRW::SPLINE:
+        writer->writeSpline(static_cast<DRW_Spline*>(entity));
+        break;
+    case DRW::INSERT:
+        writer->writeInsert(static_cast<DRW_Insert*>(entity));
+        break;
+    case DRW::MTEXT:
+        writer->writeMText(static_cast<DRW_MText*>(entity));
+        break;
+    case DRW::TEXT:
+        writer->writeText(static_cast<DRW_Text*>(entity));
+        break;
+    case DRW::HATCH:
+        writer->writeHatch(static_cast<DRW_Hatch*>(entity));
+        break;
+    case DRW::VIEWPORT:
+        writer->writeViewport(static_cast<DRW_Viewport*>(entity));
+        break;
+    case DRW::LEADER:
+        writer->writeLeader(static_cast<DRW_Leader*>(entity));
+        break;
+    case DRW::DIMALIGNED:
+    case DRW::DIMLINEAR:
+    case DRW::DIMRADIAL:
+    case DRW::DIMDIAMETRIC:
+    case DRW::DIMANGULAR:
+    case DRW::DIMANGULAR3P:
+    case DRW::DIMORDINATE:
+        writer->writeDimension(static_cast<DRW_Dimension*>(entity));
+        break;
+    case DRW::IMAGE: {
+        auto* image = static_cast<DRW_Image*>(entity);
+        const auto it = imageDefs.find(image->ref);
+        if (it == imageDefs.end())
+            break;
+        const DRW_ImageDef& def = it->second;
+        DRW_ImageDef* written = writer->writeImage(image, def.name);
+        if (written != nullptr) {
+            written->u = def.u;
+            written->v = def.v;
+            written->up = def.up;
+            written->vp = def.vp;
+            written->loaded = def.loaded;
+            written->resolution = def.resolution;
+        }
+        break;
+    }
+    default:
+        entityCount--;
+        break;
+    }
+}
+
+void DwgConverter::writeLTypes()
+{
+    for (DRW_LType& lineType: lineTypes)
+        writer->writeLineType(&lineType);
+}
+
+void DwgConverter::writeLayers()
+{
+    for (DRW_Layer& layer: layers)
+        writer->writeLayer(&layer);
+}
+
+void DwgConverter::writeTextstyles()
+{
+    for (DRW_Textstyle& textStyle: textStyles)
+        writer->writeTextstyle(&textStyle);
+}
+
+void DwgConverter::writeVports()
+{
+    for (DRW_Vport& vport: vports)
+        writer->writeVport(&vport);
+}
+
+void DwgConverter::writeDimstyles()
+{
+    for (DRW_Dimstyle& dimStyle: dimStyles)
+        writer->writeDimstyle(&dimStyle);
+}
+
+void DwgConverter::writeObjects()
+{
+    if (plotSettings != nullptr)
+        writer->writePlotSettings(plotSettings.get());
+}
+
+void DwgConverter::writeAppId()
+{
+    for (DRW_AppId& appId: appIds)
+        writer->writeAppId(&appId);
+}
+
+// converts a dwg file, and writes its line of the manifest
+bool convertFile(const QString& dwgFile, const QString& dxfFile, DRW::Version dxfVersion, bool binary,
+                 QTextStream* manifest)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    DwgConverter converter;
+    const bool ret = converter.convert(dwgFile, dxfFile, dxfVersion, binary);
+    if (ret)
+        qDebug() << "Converted" << dwgFile << "to" << dxfFile;
+    else
+        qDebug() << "ERROR: Cannot convert" << dwgFile << converter.lastError();
+
+    if (manifest != nullptr) {
+        *manifest << dwgFile << '\t' << (ret ? dxfFile : QString{}) << '\t' << (ret ? "ok" : "failed")
+                  << '\t' << versionText(converter.dwgVersion()) << '\t' << converter.countEntities()
+                  << '\t' << timer.elapsed() << '\n';
+        manifest->flush();
+    }
+    return ret;
+}
+
+// The DWG reader decodes the sections of a file on worker threads already.
+// Files are converted in parallel by worker processes, each one converting a
+// batch of files one after another, so at most one drawing per job is held.
+int runWorkers(const QStringList& dwgFiles, const QStringList& workerArgs, int jobs, QTextStream* manifest)
+{
+    // smaller batches for the last files, to keep all workers busy
+    constexpr int maxBatchSize = 32;
+
+    QTemporaryDir manifestDir;
+    // manifests of the batches, in the order of the dwg files
+    QStringList manifests;
+    QEventLoop loop;
+    int nextFile = 0;
+    int running = 0;
+    bool ok = true;
+
+    std::function<void()> startWorker = [&]() {
+        const int remaining = dwgFiles.size() - nextFile;
+        if (remaining <= 0)
+            return;
+        const int batchSize = std::clamp(remaining / jobs, 1, maxBatchSize);
+        const QString batchManifest = manifestDir.filePath(QString::number(manifests.size()));
+        manifests << batchManifest;
+
+        QStringList args = workerArgs;
+        args << "--manifest" << batchManifest << "--" << dwgFiles.mid(nextFile, batchSize);
+        nextFile += batchSize;
+
+        auto* worker = new QProcess(&loop);
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        auto workerDone = [&, worker](bool succeeded) {
+            ok = ok && succeeded;
+            worker->deleteLater();
+            running--;
+            startWorker();
+            if (running == 0)
+                loop.quit();
+        };
+        QObject::connect(worker, &QProcess::finished, &loop,
+                         [workerDone](int exitCode, QProcess::ExitStatus exitStatus) {
+            workerDone(exitStatus == QProcess::NormalExit && exitCode == EXIT_SUCCESS);
+        });
+        QObject::connect(worker, &QProcess::errorOccurred, &loop, [worker, workerDone](QProcess::ProcessError error) {
+            if (error != QProcess::FailedToStart)
+                return;
+            qDebug() << "ERROR: Failed to start worker for" << worker->arguments();
+            workerDone(false);
+        });
+        running++;
+        worker->start(QCoreApplication::applicationFilePath(), args);
+    };
+
+    for (int i = 0; i < std::min(jobs, static_cast<int>(dwgFiles.size())); i++)
+        startWorker();
+    if (running > 0)
+        loop.exec();
+
+    if (manifest != nullptr) {
+        for (const QString& batchManifest: std::as_const(manifests)) {
+            QFile file(batchManifest);
+            if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+                *manifest << file.readAll();
+        }
+        manifest->flush();
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+}
@@ -76,6 +76,12 @@ int console_dxf2pdf(int argc, char* argv[])
     appDesc << "";
     appDesc << "  " + librecad + QObject::tr( " -o some.pdf *.dxf");
     appDesc << "    " + QObject::tr( "-- print all dxf files to 'some.pdf' file.");
+    appDesc << "";
+    appDesc << "  " + librecad + QObject::tr( " -j 8 *.dxf");
+    appDesc << "    " + QObject::tr( "-- print all dxf files to pdf files, 8 files at a time.");
+    appDesc << "";
+    appDesc << "  " + librecad + QObject::tr( " -b plan.dxf");
+    appDesc << "    " + QObject::tr( "-- print a dxf file to a pdf file, writing repeated blocks once.");
     parser.setApplicationDescription( appDesc.join( "\n"));
 
     parser.addHelpOption();
@@ -125,6 +131,14 @@ int console_dxf2pdf(int argc, char* argv[])
         QObject::tr( "Target output directory."), "path");
     parser.addOption(outDirOpt);
 
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        QObject::tr( "Print files in parallel worker processes, one pdf file per dxf file."), "integer");
+    parser.addOption(jobsOpt);
+
+    QCommandLineOption blocksOpt(QStringList() << "b" << "blocks",
+        QObject::tr( "Write the geometry of each block once, and reference it from its inserts."));
+    parser.addOption(blocksOpt);
+
     parser.addPositionalArgument(QObject::tr( "<dxf_files>"), QObject::tr( "Input DXF file(s)"));
 
     parser.process(app);
@@ -140,6 +154,7 @@ int console_dxf2pdf(int argc, char* argv[])
     params.centerOnPage = parser.isSet(centerOpt);
     params.grayscale = parser.isSet(grayOpt);
     params.monochrome = parser.isSet(monoOpt);
+    params.sharedBlocks = parser.isSet(blocksOpt);
     params.pageSize = parsePageSizeArg(parser.value(pageSizeOpt));
 
     bool resOk;
@@ -158,6 +173,23 @@ int console_dxf2pdf(int argc, char* argv[])
     params.outFile = parser.value(outFileOpt);
     params.outDir = parser.value(outDirOpt);
 
+    bool jobsOk;
+    int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+    if (jobsOk && jobs > 0)
+        params.jobs = jobs;
+
+    // workers are started with the same options, except the number of jobs
+    if (prgInfo.baseName() != "dxf2pdf")
+        params.workerArgs << "dxf2pdf";
+    for (const QCommandLineOption& option : {fitOpt, centerOpt, grayOpt, monoOpt, pageSizeOpt, resOpt,
+                                             scaleOpt, marginsOpt, pagesNumOpt, outDirOpt, blocksOpt}) {
+        if (!parser.isSet(option))
+            continue;
+        params.workerArgs << "--" + option.names().last();
+        if (!option.valueName().isEmpty())
+            params.workerArgs << parser.value(option);
+    }
+
     for (auto arg : args) {
         QFileInfo dxfFileInfo(arg);
         if (dxfFileInfo.suffix().toLower() != "dxf")
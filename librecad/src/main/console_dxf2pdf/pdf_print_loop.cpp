@@ -22,11 +22,15 @@
 **
 ******************************************************************************/
 
+#include <algorithm>
+#include <memory>
+
 #include <QtCore>
 
 #include "rs.h"
 #include "rs_graphic.h"
 #include "rs_painterqt.h"
+#include "lc_pdfwriter.h"
 #include "lc_printing.h"
 #include "rs_staticgraphicview.h"
 #include "rs_units.h"
@@ -37,11 +41,18 @@
 static bool openDocAndSetGraphic(RS_Document**, RS_Graphic**, const QString&);
 static void touchGraphic(RS_Graphic*, PdfPrintParams&);
 static void setupPrinterAndPaper(RS_Graphic*, QPrinter&, PdfPrintParams&);
-static void drawPage(RS_Graphic*, QPrinter&, RS_PainterQt&);
+static std::unique_ptr<LC_PdfWriter> createPdfWriter(RS_Graphic*, PdfPrintParams&);
+template<class Device>
+static void drawPage(RS_Graphic*, Device&, RS_PainterQt&);
 
 void PdfPrintLoop::run()
 {
     if (params.outFile.isEmpty()) {
+        if (params.jobs > 1 && params.dxfFiles.size() > 1) {
+            // finished() is emitted by the last worker
+            runWorkers();
+            return;
+        }
         for (auto &&f : params.dxfFiles) {
             printOneDxfToOnePdf(f);
         }
@@ -53,6 +64,59 @@ void PdfPrintLoop::run()
 }
 
 
+// The documents are not thread safe, fonts, patterns and settings are shared
+// by all of them. Files are printed in parallel by worker processes instead,
+// each one printing a batch of files one after another, so a worker holds one
+// drawing at a time.
+void PdfPrintLoop::runWorkers()
+{
+    const int workers = std::min(params.jobs, static_cast<int>(params.dxfFiles.size()));
+    for (int i = 0; i < workers; i++)
+        startWorker();
+}
+
+
+bool PdfPrintLoop::startWorker()
+{
+    // smaller batches for the last files, to keep all workers busy
+    constexpr int maxBatchSize = 32;
+    const int remaining = params.dxfFiles.size() - nextFile;
+    if (remaining <= 0)
+        return false;
+    const int batchSize = std::clamp(remaining / params.jobs, 1, maxBatchSize);
+
+    QStringList args = params.workerArgs;
+    args << params.dxfFiles.mid(nextFile, batchSize);
+    nextFile += batchSize;
+
+    auto* worker = new QProcess(this);
+    worker->setProcessChannelMode(QProcess::ForwardedChannels);
+    auto workerDone = [this, worker]() {
+        worker->deleteLater();
+        runningWorkers--;
+        if (!startWorker() && runningWorkers == 0)
+            emit finished();
+    };
+    connect(worker, &QProcess::finished, this,
+            [worker, workerDone](int exitCode, QProcess::ExitStatus exitStatus) {
+        if (exitStatus != QProcess::NormalExit || exitCode != EXIT_SUCCESS)
+            qDebug() << "ERROR: Worker failed printing" << worker->arguments();
+        workerDone();
+    });
+    connect(worker, &QProcess::errorOccurred, this,
+            [worker, workerDone](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return;
+        qDebug() << "ERROR: Failed to start worker for" << worker->arguments();
+        workerDone();
+    });
+
+    runningWorkers++;
+    worker->start(QCoreApplication::applicationFilePath(), args);
+    return true;
+}
+
+
 void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
 
     // Main code logic and flow for this method is originally stolen from
@@ -74,18 +138,27 @@ void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
 
     touchGraphic(graphic, params);
 
-    QPrinter printer(QPrinter::HighResolution);
+    if (params.sharedBlocks) {
+        std::unique_ptr<LC_PdfWriter> writer = createPdfWriter(graphic, params);
+        LC_PdfPainter painter(writer.get());
+        if (params.monochrome)
+            painter.setDrawingMode(RS2::ModeBW);
+        drawPage(graphic, *writer, painter);
+        painter.end();
+    } else {
+        QPrinter printer(QPrinter::HighResolution);
 
-    setupPrinterAndPaper(graphic, printer, params);
+        setupPrinterAndPaper(graphic, printer, params);
 
-    RS_PainterQt painter(&printer);
+        RS_PainterQt painter(&printer);
 
-    if (params.monochrome)
-        painter.setDrawingMode(RS2::ModeBW);
+        if (params.monochrome)
+            painter.setDrawingMode(RS2::ModeBW);
 
-    drawPage(graphic, printer, painter);
+        drawPage(graphic, printer, painter);
 
-    painter.end();
+        painter.end();
+    }
 
     qDebug() << "Printing" << dxfFile << "to" << params.outFile << "DONE";
 
@@ -95,77 +168,62 @@ void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
 
 void PdfPrintLoop::printManyDxfToOnePdf() {
 
-    struct DxfPage {
-        RS_Document* doc;
-        RS_Graphic* graphic;
-        QString dxfFile;
-        QPageSize::PageSizeId paperSize;
-    };
-
     if (!params.outDir.isEmpty()) {
         QFileInfo outFileInfo(params.outFile);
         params.outFile = params.outDir + "/" + outFileInfo.fileName();
     }
 
-    QVector<DxfPage> pages;
-    int nrPages = 0;
+    QPrinter printer(QPrinter::HighResolution);
+    std::unique_ptr<LC_PdfWriter> writer;
+    std::unique_ptr<RS_PainterQt> painter;
 
-    // FIXME: Should probably open and print all dxf files in one 'for' loop.
-    // Tried but failed to do this. It looks like some 'chicken and egg'
-    // situation for the QPrinter and RS_PainterQt. Therefore, first open
-    // all dxf files and apply required actions. Then run another 'for'
-    // loop for actual printing.
+    // Pages are printed as the dxf files are opened, one document at a time.
+    // The printer must be set up before the painter is created, so the data
+    // of the first opened dxf file is used for all pages.
     for (auto dxfFile : params.dxfFiles) {
 
-        DxfPage page;
+        RS_Document *doc;
+        RS_Graphic *graphic;
 
-        page.dxfFile = dxfFile;
-
-        if (!openDocAndSetGraphic(&page.doc, &page.graphic, dxfFile))
+        if (!openDocAndSetGraphic(&doc, &graphic, dxfFile))
             continue;
 
         qDebug() << "Opened" << dxfFile;
 
-        touchGraphic(page.graphic, params);
-
-        pages.append(page);
-
-        nrPages++;
-    }
-
-    QPrinter printer(QPrinter::HighResolution);
-
-    if (nrPages > 0) {
-        // FIXME: Is it possible to set up printer and paper for every
-        // opened dxf file and tie them with painter? For now just using
-        // data extracted from the first opened dxf file for all pages.
-        setupPrinterAndPaper(pages.at(0).graphic, printer, params);
-    }
-
-    RS_PainterQt painter(&printer);
-
-    if (params.monochrome)
-        painter.setDrawingMode(RS2::ModeBW);
-
-    // And now it's time to actually print all previously opened dxf files.
-    for (auto page : pages) {
-        nrPages--;
+        touchGraphic(graphic, params);
+
+        if (painter == nullptr) {
+            if (params.sharedBlocks) {
+                writer = createPdfWriter(graphic, params);
+                painter = std::make_unique<LC_PdfPainter>(writer.get());
+            } else {
+                setupPrinterAndPaper(graphic, printer, params);
+                painter = std::make_unique<RS_PainterQt>(&printer);
+            }
+            if (params.monochrome)
+                painter->setDrawingMode(RS2::ModeBW);
+        } else if (writer != nullptr) {
+            writer->newPage();
+        } else {
+            printer.newPage();
+        }
 
-        qDebug() << "Printing" << page.dxfFile
+        qDebug() << "Printing" << dxfFile
                  << "to" << params.outFile << ">>>>";
 
-        drawPage(page.graphic, printer, painter);
+        if (writer != nullptr)
+            drawPage(graphic, *writer, *painter);
+        else
+            drawPage(graphic, printer, *painter);
 
-        qDebug() << "Printing" << page.dxfFile
+        qDebug() << "Printing" << dxfFile
                  << "to" << params.outFile << "DONE";
 
-        delete page.doc;
-
-        if (nrPages > 0)
-            printer.newPage();
+        delete doc;
     }
 
-    painter.end();
+    if (painter != nullptr)
+        painter->end();
 }
 
 
@@ -252,7 +310,35 @@ static void setupPrinterAndPaper(RS_Graphic* graphic, QPrinter& printer,
 }
 
 
-static void drawPage(RS_Graphic* graphic, QPrinter& printer,
+// the page size of the vector writer, as set up by setupPrinterAndPaper()
+static std::unique_ptr<LC_PdfWriter> createPdfWriter(RS_Graphic* graphic,
+    PdfPrintParams& params)
+{
+    bool landscape = false;
+
+    RS2::PaperFormat pf = graphic->getPaperFormat(&landscape);
+    QPageSize::PageSizeId paperSize = LC_Printing::rsToQtPaperFormat(pf);
+
+    QSizeF size;
+    if (paperSize == QPageSize::Custom){
+        RS_Vector s = RS_Units::convert(graphic->getPaperSize(), graphic->getUnit(),
+            RS2::Millimeter);
+        size = QSizeF{s.x, s.y};
+    } else {
+        size = QPageSize{paperSize}.size(QPageSize::Millimeter);
+    }
+    if (landscape)
+        size.transpose();
+
+    auto writer = std::make_unique<LC_PdfWriter>(params.outFile, size, params.resolution);
+    writer->setGrayscale(params.grayscale);
+    return writer;
+}
+
+
+// The device is a QPrinter or an LC_PdfWriter
+template<class Device>
+static void drawPage(RS_Graphic* graphic, Device& printer,
     RS_PainterQt& painter)
 {
     double printerFx = (double)printer.width() / printer.widthMM();
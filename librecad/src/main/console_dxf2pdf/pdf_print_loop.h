@@ -39,6 +39,7 @@ struct PdfPrintParams {
         bool fitToPage=false;
         bool monochrome=false;
         bool grayscale=false;
+        bool sharedBlocks=false; // Write blocks once, with LC_PdfWriter.
         double scale = 0.0;  // If scale <= 0.0, use value from dxf file.
         RS_Vector pageSize;  // If zeros, use value from dxf file.
         struct {
@@ -49,6 +50,8 @@ struct PdfPrintParams {
         } margins;           // If margin < 0.0, use value from dxf file.
         int pagesH = 0;      // If number of pages < 1,
         int pagesV = 0;      // use value from dxf file.
+        int jobs = 1;        // Worker processes, for one pdf file per dxf file.
+        QStringList workerArgs; // Arguments of the worker processes, without the dxf files.
 };
 
 
@@ -77,6 +80,12 @@ private:
 
     void printOneDxfToOnePdf(const QString&);
     void printManyDxfToOnePdf();
+    void runWorkers();
+    bool startWorker();
+
+    // next dxf file to hand to a worker process
+    int nextFile = 0;
+    int runningWorkers = 0;
 };
 
 #endif
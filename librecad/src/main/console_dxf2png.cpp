@@ -22,8 +22,11 @@
 **
 ******************************************************************************/
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <set>
+#include <utility>
 
 #include <QApplication>
 #include <QCoreApplication>
@@ -37,6 +40,7 @@
 #include "qg_dialogfactory.h"
 
 #include "lc_actionfileexportmakercam.h"
+#include "lc_tiffstripwriter.h"
 #include "rs.h"
 #include "rs_debug.h"
 #include "rs_document.h"
@@ -70,11 +74,19 @@ bool slotFileExport(RS_Graphic* graphic,
                     bool bw=true);
 
 namespace {
+bool convertFile(const QString& dxfFile, const QString& outFile, QSize pngSize, QTextStream* manifest);
+int runWorkers(const QStringList& dxfFiles, const QStringList& workerArgs, int jobs, QTextStream* manifest);
+int serve(const QString& extension, QSize pngSize);
+bool exportTiff(RS_Graphic* graphic, const QString& name, QSize size, QSize borders, bool black, bool bw);
+
 // find the image format from the file extension; default to png
 QString getFormatFromFile(const QString& fileName)
 {
     QList<QByteArray> supportedImageFormats = QImageWriter::supportedImageFormats();
     supportedImageFormats.push_back("svg"); // add svg
+    // written by exportTiff()
+    supportedImageFormats.push_back("tif");
+    supportedImageFormats.push_back("tiff");
 
     for (QString format: supportedImageFormats) {
         format = format.toLower();
@@ -122,7 +134,13 @@ int console_dxf2png(int argc, char* argv[])
     appDesc += "\n\n";
     appDesc += "Examples:\n\n";
     appDesc += "  " + librecad + " dxf2png *.dxf";
-    appDesc += "    -- print a dxf file to a png file with the same name.\n";
+    appDesc += "    -- print dxf files to png files with the same names.\n";
+    appDesc += "  " + librecad + " dxf2png -j 32 --manifest thumbnails.tsv *.dxf";
+    appDesc += "    -- print dxf files to png files, 32 files at a time.\n";
+    appDesc += "  " + librecad + " dxf2png -r 40000x30000 -o plot.tif plan.dxf";
+    appDesc += "    -- print a large format raster, rendered in strips.\n";
+    appDesc += "  find . -name '*.dxf' | " + librecad + " dxf2svg --serve";
+    appDesc += "    -- print dxf files read from the standard input to svg files.\n";
     parser.setApplicationDescription(appDesc);
 
     parser.addHelpOption();
@@ -136,12 +154,33 @@ int console_dxf2png(int argc, char* argv[])
         "Output PNG size (Width x Height) in pixels.", "WxH");
     parser.addOption(pngSizeOpt);
 
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        "Convert files in parallel worker processes, each one holding one drawing at a time.", "integer");
+    parser.addOption(jobsOpt);
+
+    QCommandLineOption manifestOpt(QStringList() << "manifest",
+        "Write a tab separated line per file: dxf file, output file, status, entities, open and export times in ms.",
+        "file");
+    parser.addOption(manifestOpt);
+
+    QCommandLineOption serveOpt(QStringList() << "serve",
+        "Keep running and convert the files read from the standard input, one line per file: "
+        "the dxf file, optionally followed by a tab and the output file. "
+        "A manifest line is written to the standard output for each file.");
+    parser.addOption(serveOpt);
+
     parser.addPositionalArgument("<dxf_files>", "Input DXF file");
 
     parser.process(app);
 
     const QStringList args = parser.positionalArguments();
 
+    if (parser.isSet(serveOpt)) {
+        const QString tool = allowed.count(prgInfo.baseName()) != 0 ? prgInfo.baseName()
+                           : args.isEmpty() ? QString{"dxf2png"} : args[0];
+        return serve(tool.right(3), parsePngSizeArg(parser.value(pngSizeOpt)));
+    }
+
     if (args.isEmpty() || (args.size() == 1 && (args[0] == "dxf2png" || args[0] == "dxf2svg")))
         parser.showHelp(EXIT_FAILURE);
     // Set PNG size from user input
@@ -159,64 +198,244 @@ int console_dxf2png(int argc, char* argv[])
     if (dxfFiles.isEmpty())
         parser.showHelp(EXIT_FAILURE);
 
-    // Output setup
+    // the output format is the name of the tool
+    const QString tool = allowed.count(prgInfo.baseName()) == 0 ? args[0] : prgInfo.baseName();
+    const QString extension = tool.right(3);
 
-    QString& dxfFile = dxfFiles[0];
+    // Set output filename from user input if present, for a single file
+    QString outFile = parser.value(outFileOpt);
+    if (!outFile.isEmpty() && dxfFiles.size() > 1) {
+        qDebug() << "WARNING: Ignoring output file for multiple dxf files:" << outFile;
+        outFile.clear();
+    }
 
-    QFileInfo dxfFileInfo(dxfFile);
-    QString fn = dxfFileInfo.completeBaseName(); // original DXF file name
-    if(fn.isEmpty())
-        fn = "unnamed";
+    QFile manifestFile(parser.value(manifestOpt));
+    QTextStream manifest(&manifestFile);
+    if (parser.isSet(manifestOpt) && !manifestFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "ERROR: Cannot write manifest" << manifestFile.fileName();
+        return EXIT_FAILURE;
+    }
 
-    // Set output filename from user input if present
-    QString outFile = parser.value(outFileOpt);
-    if (outFile.isEmpty()) {
-        outFile = dxfFileInfo.path() + "/" + fn + "." + args[0].mid(args[0].size()-3);
-    } else {
-        outFile = dxfFileInfo.path() + "/" + outFile;
+    bool jobsOk = false;
+    const int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+    if (jobsOk && jobs > 1 && dxfFiles.size() > 1) {
+        // workers are started with the same options, except the number of jobs
+        QStringList workerArgs;
+        if (allowed.count(prgInfo.baseName()) == 0)
+            workerArgs << tool;
+        if (parser.isSet(pngSizeOpt))
+            workerArgs << "--resolution" << parser.value(pngSizeOpt);
+        return runWorkers(dxfFiles, workerArgs, jobs, manifestFile.isOpen() ? &manifest : nullptr);
+    }
+
+    bool ok = true;
+    for (const QString& dxfFile: dxfFiles) {
+        QFileInfo dxfFileInfo(dxfFile);
+        QString fn = dxfFileInfo.completeBaseName(); // original DXF file name
+        if(fn.isEmpty())
+            fn = "unnamed";
+        const QString out = dxfFileInfo.path() + "/" + (outFile.isEmpty() ? fn + "." + extension : outFile);
+        ok = convertFile(dxfFile, out, pngSize, manifestFile.isOpen() ? &manifest : nullptr) && ok;
     }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+namespace {
+
+// converts a dxf file, and writes its line of the manifest
+bool convertFile(const QString& dxfFile, const QString& outFile, QSize pngSize, QTextStream* manifest)
+{
+    QElapsedTimer timer;
+    timer.start();
 
     // Open the file and process the graphics
 
     std::unique_ptr<RS_Document> doc = openDocAndSetGraphic(dxfFile);
+    const qint64 openTime = timer.restart();
+
+    bool ret = false;
+    unsigned entities = 0;
+    if (doc != nullptr && doc->getGraphic() != nullptr) {
+        RS_Graphic *graphic = doc->getGraphic();
+        entities = graphic->count();
 
-    if (doc == nullptr || doc->getGraphic() == nullptr)
-        return 1;
-    RS_Graphic *graphic = doc->getGraphic();
+        LC_LOG << "Printing" << dxfFile << "to" << outFile << ">>>>";
 
-    LC_LOG << "Printing" << dxfFile << "to" << outFile << ">>>>";
+        touchGraphic(graphic);
 
-    touchGraphic(graphic);
+        // Start of the actual conversion
 
-    // Start of the actual conversion
+        LC_LOG<< "QC_ApplicationWindow::slotFileExport()";
 
-    LC_LOG<< "QC_ApplicationWindow::slotFileExport()";
+        // read default settings:
+        auto groupGuard = RS_SETTINGS->beginGroupGuard("/Export");
 
-    // read default settings:
-    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Export");
-    QString defDir = dxfFileInfo.path();
+        // find out extension:
+        QString format = getFormatFromFile(outFile).toUpper();
 
-    // find out extension:
-    QString format = getFormatFromFile(outFile).toUpper();
+        if (format.compare("SVG", Qt::CaseInsensitive) == 0) {
+            ret = LC_ActionFileExportMakerCam::writeSvg(outFile, *graphic);
+        } else if (format.startsWith("TIF")) {
+            ret = exportTiff(graphic, outFile, pngSize, QSize(5, 5), false, false);
+        } else {
+            QSize borders = QSize(5, 5);
+            bool black = false;
+            bool bw = false;
+            ret = slotFileExport(graphic, outFile, format, pngSize, borders,
+                           black, bw);
+        }
 
-    // append extension to file:
-    if (!QFileInfo(fn).fileName().contains(".")) {
-        fn.push_back("." + format.toLower());
+        qDebug() << "Printing" << dxfFile << "to" << outFile << (ret ? "Done" : "Failed");
     }
 
-    bool ret = false;
-    if (format.compare("SVG", Qt::CaseInsensitive) == 0) {
-        ret = LC_ActionFileExportMakerCam::writeSvg(outFile, *graphic);
-    } else {
-        QSize borders = QSize(5, 5);
-        bool black = false;
-        bool bw = false;
-        ret = slotFileExport(graphic, outFile, format, pngSize, borders,
-                       black, bw);
+    if (manifest != nullptr) {
+        *manifest << dxfFile << '\t' << outFile << '\t' << (ret ? "ok" : "failed") << '\t' << entities
+                  << '\t' << openTime << '\t' << timer.elapsed() << '\n';
+        manifest->flush();
+    }
+    return ret;
+}
+
+// The documents are not thread safe, fonts, patterns and settings are shared
+// by all of them, and pixmaps are painted in the gui thread only. Files are
+// converted in parallel by worker processes instead, each one converting a
+// batch of files one after another, so at most one drawing per job is open.
+int runWorkers(const QStringList& dxfFiles, const QStringList& workerArgs, int jobs, QTextStream* manifest)
+{
+    // smaller batches for the last files, to keep all workers busy
+    constexpr int maxBatchSize = 32;
+
+    QTemporaryDir manifestDir;
+    // manifests of the batches, in the order of the dxf files
+    QStringList manifests;
+    QEventLoop loop;
+    int nextFile = 0;
+    int running = 0;
+    bool ok = true;
+
+    std::function<void()> startWorker = [&]() {
+        const int remaining = dxfFiles.size() - nextFile;
+        if (remaining <= 0)
+            return;
+        const int batchSize = std::clamp(remaining / jobs, 1, maxBatchSize);
+        const QString batchManifest = manifestDir.filePath(QString::number(manifests.size()));
+        manifests << batchManifest;
+
+        QStringList args = workerArgs;
+        args << "--manifest" << batchManifest << dxfFiles.mid(nextFile, batchSize);
+        nextFile += batchSize;
+
+        auto* worker = new QProcess(&loop);
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        auto workerDone = [&, worker](bool succeeded) {
+            ok = ok && succeeded;
+            worker->deleteLater();
+            running--;
+            startWorker();
+            if (running == 0)
+                loop.quit();
+        };
+        QObject::connect(worker, &QProcess::finished, &loop,
+                         [workerDone](int exitCode, QProcess::ExitStatus exitStatus) {
+            workerDone(exitStatus == QProcess::NormalExit && exitCode == EXIT_SUCCESS);
+        });
+        QObject::connect(worker, &QProcess::errorOccurred, &loop, [worker, workerDone](QProcess::ProcessError error) {
+            if (error != QProcess::FailedToStart)
+                return;
+            qDebug() << "ERROR: Failed to start worker for" << worker->arguments();
+            workerDone(false);
+        });
+        running++;
+        worker->start(QCoreApplication::applicationFilePath(), args);
+    };
+
+    for (int i = 0; i < std::min(jobs, static_cast<int>(dxfFiles.size())); i++)
+        startWorker();
+    if (running > 0)
+        loop.exec();
+
+    if (manifest != nullptr) {
+        for (const QString& batchManifest: std::as_const(manifests)) {
+            QFile file(batchManifest);
+            if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+                *manifest << file.readAll();
+        }
+        manifest->flush();
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Renders the drawing in strips of rows written one after another, so large
+// format rasters are exported without holding the whole image in memory
+bool exportTiff(RS_Graphic* graphic, const QString& name, QSize size, QSize borders, bool black, bool bw)
+{
+    constexpr int stripHeight = 256;
+
+    LC_TiffStripWriter writer(name, size);
+    if (!writer.open()) {
+        qDebug() << "ERROR: Cannot write" << name << writer.errorString();
+        return false;
     }
 
-    qDebug() << "Printing" << dxfFile << "to" << outFile << (ret ? "Done" : "Failed");
-    return 0;
+    // the view of the whole image, moved to each strip
+    RS_StaticGraphicView gv(size.width(), size.height(), nullptr, &borders);
+    gv.setBackground(black ? Qt::black : Qt::white);
+    gv.setContainer(graphic);
+    gv.zoomAuto(false);
+    const int offsetX = gv.getOffsetX();
+    const int offsetY = gv.getOffsetY();
+
+    for (int top = 0; top < size.height(); top += stripHeight) {
+        const int height = std::min(stripHeight, size.height() - top);
+        gv.setViewport(size.width(), height, offsetX, offsetY + top + height - size.height());
+
+        QImage strip(size.width(), height, QImage::Format_RGB32);
+        RS_PainterQt painter(&strip);
+        painter.setBackground(black ? Qt::black : Qt::white);
+        if (bw)
+            painter.setDrawingMode(black ? RS2::ModeWB : RS2::ModeBW);
+        painter.eraseRect(0, 0, size.width(), height);
+        gv.drawEntity(&painter, gv.getContainer());
+        painter.end();
+
+        if (!writer.writeStrip(strip)) {
+            qDebug() << "ERROR: Cannot write" << name << writer.errorString();
+            return false;
+        }
+    }
+    if (!writer.close()) {
+        qDebug() << "ERROR: Cannot write" << name << writer.errorString();
+        return false;
+    }
+    return true;
+}
+
+// Fonts, patterns and settings are loaded once, for all the jobs read from
+// the standard input, until the end of the input
+int serve(const QString& extension, QSize pngSize)
+{
+    QTextStream jobs(stdin);
+    QTextStream manifest(stdout);
+    bool ok = true;
+    QString job;
+    while (jobs.readLineInto(&job)) {
+        const QStringList fields = job.split('\t');
+        const QString& dxfFile = fields.first();
+        if (dxfFile.trimmed().isEmpty())
+            continue;
+        QString outFile = fields.size() > 1 ? fields[1] : QString{};
+        if (outFile.isEmpty()) {
+            QFileInfo dxfFileInfo(dxfFile);
+            QString fn = dxfFileInfo.completeBaseName();
+            if (fn.isEmpty())
+                fn = "unnamed";
+            outFile = dxfFileInfo.path() + "/" + fn + "." + extension;
+        }
+        ok = convertFile(dxfFile, outFile, pngSize, &manifest) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 }
 
 
@@ -24,10 +24,17 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <set>
+
 #include <QEventLoop>
 #include <QList>
 #include <QInputDialog>
 #include <QFileInfo>
+#include <QProgressDialog>
+#include <QTimer>
 
 #include "doc_plugin_interface.h"
 #include "intern/qc_actiongetent.h"
@@ -42,6 +49,7 @@
 #include "rs_debug.h"
 #include "rs_ellipse.h"
 #include "rs_eventhandler.h"
+#include "rs_graphic.h"
 #include "rs_graphicview.h"
 #include "rs_image.h"
 #include "rs_insert.h"
@@ -137,6 +145,233 @@ QString convLTW::intColor2str(int col){
 
 convLTW Converter;
 
+namespace {
+
+/**
+ * Progress of a Plug_Task, written by the worker and polled by the GUI thread.
+ */
+class PluginProgress: public Plug_Progress {
+public:
+    void setProgress(int value, int maximum) override
+    {
+        m_value = value;
+        m_maximum = maximum;
+    }
+    bool isCanceled() const override
+    {
+        return m_canceled;
+    }
+    void cancel()
+    {
+        m_canceled = true;
+    }
+    int value() const
+    {
+        return m_value;
+    }
+    int maximum() const
+    {
+        return m_maximum;
+    }
+
+private:
+    std::atomic<int> m_value{0};
+    std::atomic<int> m_maximum{0};
+    std::atomic<bool> m_canceled{false};
+};
+DPI::ETYPE pluginType(RS2::EntityType type)
+{
+    switch (type) {
+    case RS2::EntityLine: return DPI::LINE;
+    case RS2::EntityPoint: return DPI::POINT;
+    case RS2::EntityArc: return DPI::ARC;
+    case RS2::EntityCircle: return DPI::CIRCLE;
+    case RS2::EntityEllipse: return DPI::ELLIPSE;
+    case RS2::EntitySolid: return DPI::SOLID;
+    case RS2::EntityConstructionLine: return DPI::CONSTRUCTIONLINE;
+    case RS2::EntityImage: return DPI::IMAGE;
+    case RS2::EntityOverlayBox: return DPI::OVERLAYBOX;
+    case RS2::EntityInsert: return DPI::INSERT;
+    case RS2::EntityMText: return DPI::MTEXT;
+    case RS2::EntityText: return DPI::TEXT;
+    case RS2::EntityHatch: return DPI::HATCH;
+    case RS2::EntitySpline: return DPI::SPLINE;
+    case RS2::EntitySplinePoints: return DPI::SPLINEPOINTS;
+    case RS2::EntityPolyline: return DPI::POLYLINE;
+    case RS2::EntityDimAligned: return DPI::DIMALIGNED;
+    case RS2::EntityDimLinear: return DPI::DIMLINEAR;
+    case RS2::EntityDimRadial: return DPI::DIMRADIAL;
+    case RS2::EntityDimDiametric: return DPI::DIMDIAMETRIC;
+    case RS2::EntityDimAngular: return DPI::DIMANGULAR;
+    case RS2::EntityDimLeader: return DPI::DIMLEADER;
+    default: return DPI::UNKNOWN;
+    }
+}
+
+/**
+ * Appends the data of an entity to the arrays, with the same values as Plugin_Entity::getData().
+ * @param layerIndices indices of the layers in data.layerNames
+ */
+void appendEntityData(Plug_EntityArrays& data, RS_Entity* entity, QHash<const RS_Layer*, int>& layerIndices)
+{
+    const RS_Layer* layer = entity->getLayer();
+    int layerIndex = -1;
+    if (layer != nullptr) {
+        auto it = layerIndices.constFind(layer);
+        if (it == layerIndices.cend()) {
+            it = layerIndices.insert(layer, data.layerNames.size());
+            data.layerNames.append(layer->getName());
+        }
+        layerIndex = it.value();
+    }
+
+    const RS_Pen pen = entity->getPen(false);
+    data.ids.push_back(entity->getId());
+    data.types.push_back(pluginType(entity->rtti()));
+    data.layers.push_back(layerIndex);
+    data.colors.push_back(pen.getColor().toIntColor());
+    data.lineTypes.push_back(pen.getLineType());
+    data.lineWidths.push_back(pen.getWidth());
+
+    RS_Vector start{0., 0.};
+    RS_Vector end{0., 0.};
+    double radius = 0.;
+    switch (entity->rtti()) {
+    case RS2::EntityLine: {
+        auto line = static_cast<RS_Line*>(entity);
+        start = line->getStartpoint();
+        end = line->getEndpoint();
+        break;}
+    case RS2::EntityPoint:
+        start = static_cast<RS_Point*>(entity)->getPos();
+        break;
+    case RS2::EntityArc:
+    case RS2::EntityCircle:
+        start = entity->getCenter();
+        radius = entity->getRadius();
+        break;
+    case RS2::EntityEllipse: {
+        auto ellipse = static_cast<RS_Ellipse*>(entity);
+        start = ellipse->getCenter();
+        end = ellipse->getMajorP();
+        radius = ellipse->getRatio();
+        break;}
+    case RS2::EntityImage: {
+        const RS_ImageData& d = static_cast<RS_Image*>(entity)->getData();
+        start = d.insertionPoint;
+        end = d.uVector;
+        break;}
+    case RS2::EntityInsert:
+        start = static_cast<RS_Insert*>(entity)->getInsertionPoint();
+        break;
+    case RS2::EntityMText: {
+        auto text = static_cast<RS_MText*>(entity);
+        start = text->getInsertionPoint();
+        radius = text->getHeight();
+        break;}
+    case RS2::EntityText: {
+        auto text = static_cast<RS_Text*>(entity);
+        start = text->getInsertionPoint();
+        radius = text->getHeight();
+        break;}
+    default:
+        break;
+    }
+    data.startPoints.emplace_back(start.x, start.y);
+    data.endPoints.emplace_back(end.x, end.y);
+    data.radii.push_back(radius);
+}
+
+/**
+ * Sets an entity to the values of a row of the arrays, the reverse of appendEntityData().
+ */
+void applyEntityData(RS_Entity* entity, const Plug_EntityArrays& data, size_t row)
+{
+    const int layerIndex = data.layers[row];
+    if (layerIndex >= 0 && layerIndex < data.layerNames.size())
+        entity->setLayer(data.layerNames.at(layerIndex));
+
+    RS_Pen pen = entity->getPen(false);
+    RS_Color color;
+    color.fromIntColor(data.colors[row]);
+    pen.setColor(color);
+    pen.setLineType(static_cast<RS2::LineType>(data.lineTypes[row]));
+    pen.setWidth(static_cast<RS2::LineWidth>(data.lineWidths[row]));
+    entity->setPen(pen);
+
+    const RS_Vector start{data.startPoints[row].x(), data.startPoints[row].y()};
+    const RS_Vector end{data.endPoints[row].x(), data.endPoints[row].y()};
+    const double radius = data.radii[row];
+    switch (entity->rtti()) {
+    case RS2::EntityLine: {
+        auto line = static_cast<RS_Line*>(entity);
+        line->setStartpoint(start);
+        line->setEndpoint(end);
+        break;}
+    case RS2::EntityPoint:
+        static_cast<RS_Point*>(entity)->setPos(start);
+        break;
+    case RS2::EntityArc: {
+        auto arc = static_cast<RS_Arc*>(entity);
+        arc->setCenter(start);
+        arc->setRadius(radius);
+        break;}
+    case RS2::EntityCircle: {
+        auto circle = static_cast<RS_Circle*>(entity);
+        circle->setCenter(start);
+        circle->setRadius(radius);
+        break;}
+    case RS2::EntityEllipse: {
+        auto ellipse = static_cast<RS_Ellipse*>(entity);
+        ellipse->setCenter(start);
+        ellipse->setMajorP(end);
+        ellipse->setRatio(radius);
+        break;}
+    case RS2::EntityImage: {
+        auto image = static_cast<RS_Image*>(entity);
+        image->setInsertionPoint(start);
+        image->updateData(RS_Vector(image->getWidth(), image->getHeight()), end, image->getVVector());
+        break;}
+    case RS2::EntityInsert:
+        static_cast<RS_Insert*>(entity)->setInsertionPoint(start);
+        break;
+    case RS2::EntityMText: {
+        auto text = static_cast<RS_MText*>(entity);
+        text->move(start - text->getInsertionPoint());
+        text->setHeight(radius);
+        break;}
+    case RS2::EntityText: {
+        auto text = static_cast<RS_Text*>(entity);
+        text->move(start - text->getInsertionPoint());
+        text->setHeight(radius);
+        break;}
+    default:
+        break;
+    }
+    entity->update();
+}
+
+/**
+ * @return true, if the row of the arrays holds other values than the entity
+ */
+bool entityDataDiffers(RS_Entity* entity, const Plug_EntityArrays& data, size_t row)
+{
+    Plug_EntityArrays current;
+    QHash<const RS_Layer*, int> layerIndices;
+    appendEntityData(current, entity, layerIndices);
+    const int layerIndex = data.layers[row];
+    const bool layerDiffers = layerIndex >= 0 && layerIndex < data.layerNames.size()
+            && (current.layerNames.isEmpty() || current.layerNames.front() != data.layerNames.at(layerIndex));
+    return layerDiffers
+            || current.colors.front() != data.colors[row]
+            || current.lineTypes.front() != data.lineTypes[row]
+            || current.lineWidths.front() != data.lineWidths[row]
+            || current.startPoints.front() != data.startPoints[row]
+            || current.endPoints.front() != data.endPoints[row]
+            || current.radii.front() != data.radii[row];
+}
+}
+
 
 Plugin_Entity::Plugin_Entity(RS_Entity* ent, Doc_plugin_interface* d):
     entity(ent)
@@ -770,6 +1005,28 @@ doc(d)
 {
 }
 
+Doc_plugin_interface::~Doc_plugin_interface()
+{
+    // a plugin which forgot to commit its batch still gets its entities
+    if (batching)
+        commitBatch();
+}
+
+/**
+ * Adds a newly created entity to the document and the undo cycle, or queues
+ * it until commitBatch() while a batch is open.
+ */
+void Doc_plugin_interface::addNewEntity(RS_Entity* entity)
+{
+    if (batching) {
+        batchEntities.push_back(entity);
+        return;
+    }
+    doc->addEntity(entity);
+    LC_UndoSection undo(doc);
+    undo.addUndoable(entity);
+}
+
 bool Doc_plugin_interface::addToUndo(RS_Entity* current, RS_Entity* modified,
 				     DPI::Disposition how) {
     if (doc) {
@@ -799,9 +1056,7 @@ void Doc_plugin_interface::addPoint(QPointF *start){
     RS_Vector v1(start->x(), start->y());
     if (doc) {
         RS_Point* entity = new RS_Point(doc, RS_PointData(v1));
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addPoint: currentContainer is nullptr");
 }
@@ -812,9 +1067,7 @@ void Doc_plugin_interface::addLine(QPointF *start, QPointF *end){
     RS_Vector v2(end->x(), end->y());
     if (doc) {
 		RS_Line* entity = new RS_Line{doc, v1, v2};
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addLine: currentContainer is nullptr");
 }
@@ -833,9 +1086,7 @@ void Doc_plugin_interface::addMText(QString txt, QString sty, QPointF *start,
                   txt, sty, angle, RS2::Update);
         RS_MText* entity = new RS_MText(doc, d);
 
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addMtext: currentContainer is nullptr");
 }
@@ -853,9 +1104,7 @@ void Doc_plugin_interface::addText(QString txt, QString sty, QPointF *start,
                   RS_TextData::None, txt, sty, angle, RS2::Update);
         RS_Text* entity = new RS_Text(doc, d);
 
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addText: currentContainer is nullptr");
 }
@@ -866,9 +1115,7 @@ void Doc_plugin_interface::addCircle(QPointF *start, qreal radius){
         RS_CircleData d(v, radius);
         RS_Circle* entity = new RS_Circle(doc, d);
 
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addCircle: currentContainer is nullptr");
 }
@@ -881,9 +1128,7 @@ void Doc_plugin_interface::addArc(QPointF *start, qreal radius, qreal a1, qreal
 				 RS_Math::deg2rad(a2),
                  false);
         RS_Arc* entity = new RS_Arc(doc, d);
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addArc: currentContainer is nullptr");
 }
@@ -896,9 +1141,7 @@ void Doc_plugin_interface::addEllipse(QPointF *start, QPointF *end, qreal ratio,
 		RS_EllipseData ed{v1, v2, ratio, a1, a2, false};
         RS_Ellipse* entity = new RS_Ellipse(doc, ed);
 
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addEllipse: currentContainer is nullptr");
 }
@@ -908,27 +1151,115 @@ void Doc_plugin_interface::addLines(std::vector<QPointF> const& points, bool clo
     if (doc) {
         RS_LineData data;
 
-        LC_UndoSection undo(doc);
         data.endpoint=RS_Vector(points.front().x(), points.front().y());
 
         for(size_t i=1; i<points.size(); ++i){
             data.startpoint=data.endpoint;
             data.endpoint=RS_Vector(points[i].x(), points[i].y());
-            RS_Line* line=new RS_Line(doc, data);
-            doc->addEntity(line);
-            undo.addUndoable(line);
+            addNewEntity(new RS_Line(doc, data));
         }
         if(closed){
             data.startpoint=data.endpoint;
             data.endpoint=RS_Vector(points.front().x(), points.front().y());
-            RS_Line* line=new RS_Line(doc, data);
-            doc->addEntity(line);
-            undo.addUndoable(line);
+            addNewEntity(new RS_Line(doc, data));
         }
     } else
 		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
 }
 
+void Doc_plugin_interface::addPoints(std::vector<QPointF> const& points)
+{
+    if (doc) {
+        for (const QPointF& p: points)
+            addNewEntity(new RS_Point(doc, RS_PointData(RS_Vector(p.x(), p.y()))));
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addLineSegments(std::vector<QPointF> const& starts,
+                                           std::vector<QPointF> const& ends)
+{
+    if (doc) {
+        const size_t count = std::min(starts.size(), ends.size());
+        for (size_t i = 0; i < count; ++i)
+            addNewEntity(new RS_Line{doc, RS_Vector(starts[i].x(), starts[i].y()),
+                                     RS_Vector(ends[i].x(), ends[i].y())});
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::beginBatch()
+{
+    if (doc)
+        batching = true;
+}
+
+void Doc_plugin_interface::commitBatch()
+{
+    if (!batching)
+        return;
+    batching = false;
+    if (!batchEntities.empty()) {
+        LC_UndoSection undo(doc);
+        for (RS_Entity* entity: batchEntities) {
+            doc->addEntity(entity);
+            undo.addUndoable(entity);
+        }
+        batchEntities.clear();
+    }
+    if (gView) {
+        gView->getContainer()->calculateBorders();
+        gView->redraw(RS2::RedrawDrawing);
+    }
+}
+
+bool Doc_plugin_interface::runTask(Plug_Task *task, const QString& message)
+{
+    if (task == nullptr)
+        return false;
+
+    PluginProgress progress;
+    QProgressDialog dialog(message.isEmpty() ? QObject::tr("Running plugin...") : message,
+                           QObject::tr("Cancel"), 0, 0, main_window);
+    dialog.setWindowModality(Qt::WindowModal);
+    dialog.setMinimumDuration(500);
+
+    // the document stays untouched by the worker, the data it works on was
+    // copied by the plugin before
+    std::future<void> result = std::async(std::launch::async, [task, &progress]() {
+        task->run(&progress);
+    });
+
+    QEventLoop loop;
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, &loop, [&]() {
+        if (result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            loop.quit();
+            return;
+        }
+        if (dialog.wasCanceled())
+            progress.cancel();
+        dialog.setMaximum(progress.maximum());
+        dialog.setValue(progress.value());
+    });
+    timer.start(50);
+    loop.exec();
+    timer.stop();
+
+    try {
+        result.get();
+    } catch (const std::exception& e) {
+        RS_DEBUG->print(RS_Debug::D_ERROR, "%s: plugin task failed: %s", __func__, e.what());
+        return false;
+    }
+    if (progress.isCanceled() || dialog.wasCanceled())
+        return false;
+    dialog.reset();
+
+    task->apply(this);
+    return true;
+}
+
 void Doc_plugin_interface::addPolyline(std::vector<Plug_VertexData> const& points, bool closed)
 {
     if (doc) {
@@ -937,13 +1268,15 @@ void Doc_plugin_interface::addPolyline(std::vector<Plug_VertexData> const& point
             data.setFlag(RS2::FlagClosed);
         RS_Polyline* entity = new RS_Polyline(doc, data);
 
+        // appended at once, the polyline is ended once only
+        std::vector<std::pair<RS_Vector, double>> vertices;
+        vertices.reserve(points.size());
         for(auto const& pt: points){
-            entity->addVertex(RS_Vector(pt.point.x(), pt.point.y()), pt.bulge);
+            vertices.emplace_back(RS_Vector(pt.point.x(), pt.point.y()), pt.bulge);
         }
+        entity->appendVertexs(vertices);
 
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
 }
@@ -958,9 +1291,7 @@ void Doc_plugin_interface::addSplinePoints(std::vector<QPointF> const& points, b
 
         LC_SplinePoints* entity = new LC_SplinePoints(doc, data);
 
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
 }
@@ -984,9 +1315,7 @@ void Doc_plugin_interface::addImage(int handle, QPointF *start, QPointF *uvr, QP
                          con,
                          fade));
 
-        doc->addEntity(image);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(image);
+        addNewEntity(image);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addImage: currentContainer is nullptr");
 }
@@ -999,9 +1328,7 @@ void Doc_plugin_interface::addInsert(QString name, QPointF ins, QPointF scale, q
         RS_InsertData id(name, ip, sp, rot, 1, 1, RS_Vector(0.0, 0.0));
         RS_Insert* entity = new RS_Insert(doc, id);
 
-        doc->addEntity(entity);
-        LC_UndoSection undo(doc);
-        undo.addUndoable(entity);
+        addNewEntity(entity);
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addInsert: currentContainer is nullptr");
 }
@@ -1056,9 +1383,7 @@ void Doc_plugin_interface::addEntity(Plug_Entity *handle){
     if (doc) {
         RS_Entity *ent = (reinterpret_cast<Plugin_Entity*>(handle))->getEnt();
 		if (ent) {
-            doc->addEntity(ent);
-            LC_UndoSection undo(doc);
-            undo.addUndoable(ent);
+            addNewEntity(ent);
         }
     } else
 		RS_DEBUG->print("Doc_plugin_interface::addEntity: currentContainer is nullptr");
@@ -1315,6 +1640,131 @@ bool Doc_plugin_interface::getAllEntities(QList<Plug_Entity *> *sel, bool visibl
     return status;
 }
 
+Plug_Entity *Doc_plugin_interface::getEntity(qulonglong id){
+    RS_Entity* e = doc->findEntityById(id);
+    if (e == nullptr)
+        return nullptr;
+    return reinterpret_cast<Plug_Entity*>(new Plugin_Entity(e, this));
+}
+
+bool Doc_plugin_interface::findText(QList<Plug_Entity *> *sel, const QString& text, bool caseSensitive){
+    if (docGr == nullptr)
+        return false;
+    std::set<RS_Entity*> found;
+    const auto append = [this, sel, &found](RS_Entity* e) {
+        if (found.insert(e).second)
+            sel->append(reinterpret_cast<Plug_Entity*>(new Plugin_Entity(e, this)));
+    };
+    for (const LC_TextIndex::Match& match: docGr->findText(text, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive)) {
+        if (match.block == nullptr) {
+            append(match.entity);
+            continue;
+        }
+        // the inserts of the drawing, not those nested in other blocks
+        for (RS_Insert* insert: match.inserts) {
+            if (insert->getParent() == doc)
+                append(insert);
+        }
+    }
+    return !found.empty();
+}
+
+void Doc_plugin_interface::zoomToEntity(Plug_Entity *ent){
+    RS_Entity* e = ent != nullptr ? reinterpret_cast<Plugin_Entity*>(ent)->getEnt() : nullptr;
+    if (e == nullptr || gView == nullptr)
+        return;
+    const RS_Vector min = e->getMin();
+    const RS_Vector max = e->getMax();
+    if (!min.valid || !max.valid)
+        return;
+    // the entity with some of its surroundings
+    const RS_Vector margin = RS_Vector{1., 1.} * std::max((max - min).magnitude(), 1.);
+    gView->zoomWindow(min - margin, max + margin);
+    gView->redraw();
+}
+
+bool Doc_plugin_interface::getAllEntitiesData(Plug_EntityArrays *data, bool visible){
+    data->clear();
+    QHash<const RS_Layer*, int> layerIndices;
+    for(auto e: *doc){
+        if (e->isVisible() || !visible)
+            appendEntityData(*data, e, layerIndices);
+    }
+    return true;
+}
+
+void Doc_plugin_interface::updateEntitiesData(Plug_EntityArrays const& data){
+    if (!doc) {
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+        return;
+    }
+    const size_t count = std::min({data.ids.size(), data.types.size(), data.layers.size(),
+                                   data.colors.size(), data.lineTypes.size(), data.lineWidths.size(),
+                                   data.startPoints.size(), data.endPoints.size(), data.radii.size()});
+    LC_UndoSection undo(doc);
+    for (size_t i = 0; i < count; ++i) {
+        // the ids are found by the index of the document
+        RS_Entity* org = doc->findEntityById(data.ids[i]);
+        if (org == nullptr || org->isUndone() || pluginType(org->rtti()) != data.types[i]
+                || !entityDataDiffers(org, data, i))
+            continue;
+        RS_Entity* modified = org->clone();
+        applyEntityData(modified, data, i);
+        doc->addEntity(modified);
+        undo.addUndoable(modified);
+        org->setSelected(false);
+        undo.addUndoable(org);
+        org->setUndoState(true);
+    }
+    if (gView)
+        gView->redraw(RS2::RedrawDrawing);
+}
+
+void Doc_plugin_interface::removeEntities(std::vector<qulonglong> const& ids){
+    if (!doc) {
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+        return;
+    }
+    LC_UndoSection undo(doc);
+    for (qulonglong id: ids) {
+        RS_Entity* e = doc->findEntityById(id);
+        if (e == nullptr || e->isUndone())
+            continue;
+        e->setSelected(false);
+        e->changeUndoState();
+        undo.addUndoable(e);
+    }
+    if (gView)
+        gView->redraw(RS2::RedrawDrawing);
+}
+
+bool Doc_plugin_interface::getSelectData(Plug_EntityArrays *data, const QString& message){
+    data->clear();
+    QC_ActionGetSelect* a = new QC_ActionGetSelect(*doc, *gView);
+    if (!(message.isEmpty()) )
+        a->setMessage(message);
+    gView->killAllActions();
+    gView->setCurrentAction(a);
+    QEventLoop ev;
+    while (!a->isCompleted())
+    {
+        ev.processEvents ();
+        if (!gView->getEventHandler()->hasAction())
+            break;
+    }
+    bool status = false;
+    RS_EventHandler* eh = gView->getEventHandler();
+    if (eh && eh->isValid(a) ) {
+        // the selected entities are found without wrapping each of them
+        QHash<const RS_Layer*, int> layerIndices;
+        for (RS_Entity* e: doc->getSelectedEntities())
+            appendEntityData(*data, e, layerIndices);
+        status = true;
+    }
+    gView->killAllActions();
+    return status;
+}
+
 void Doc_plugin_interface::unselectEntities() {
     QC_ActionGetSelect* a = new QC_ActionGetSelect(*doc, *gView);
     a->unselectEntities();
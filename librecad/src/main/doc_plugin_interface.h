@@ -26,6 +26,8 @@
 #ifndef DOC_PLUGIN_INTERFACE_H
 #define DOC_PLUGIN_INTERFACE_H
 
+#include <vector>
+
 #include <QObject>
 
 #include "document_interface.h"
@@ -76,6 +78,7 @@ class Doc_plugin_interface : public Document_Interface
 {
 public:
     Doc_plugin_interface(RS_Document *d, RS_GraphicView* gv, QWidget* parent);
+    ~Doc_plugin_interface() override;
     void updateView() override;
     void addPoint(QPointF *start) override;
     void addLine(QPointF *start, QPointF *end) override;
@@ -115,6 +118,7 @@ public:
     bool getSelect(QList<Plug_Entity *> *sel, const QString& message) override;
     bool getSelectByType(QList<Plug_Entity *> *sel, enum DPI::ETYPE type, const QString& message) override;
     bool getAllEntities(QList<Plug_Entity *> *sel, bool visible = false) override;
+    Plug_Entity *getEntity(qulonglong id) override;
 
     void unselectEntities() override;
 
@@ -128,13 +132,31 @@ public:
     bool getString(QString *txt, const QString& message, const QString& title) override;
     QString realToStr(const qreal num, const int units = 0, const int prec = 0) override;
 
+    bool getSelectData(Plug_EntityArrays *data, const QString& message) override;
+    bool getAllEntitiesData(Plug_EntityArrays *data, bool visible = false) override;
+
+    void beginBatch() override;
+    void commitBatch() override;
+    void addPoints(std::vector<QPointF> const& points) override;
+    void addLineSegments(std::vector<QPointF> const& starts, std::vector<QPointF> const& ends) override;
+    bool runTask(Plug_Task *task, const QString& message) override;
+    bool findText(QList<Plug_Entity *> *sel, const QString& text, bool caseSensitive = false) override;
+    void zoomToEntity(Plug_Entity *ent) override;
+    void updateEntitiesData(Plug_EntityArrays const& data) override;
+    void removeEntities(std::vector<qulonglong> const& ids) override;
+
     //method to handle undo in Plugin_Entity 
     bool addToUndo(RS_Entity* current, RS_Entity* modified, DPI::Disposition how);
 private:
+    void addNewEntity(RS_Entity* entity);
+
     RS_Document *doc;
     RS_Graphic *docGr;
     RS_GraphicView *gView;
     QWidget* main_window;
+    //! entities created since beginBatch(), added by commitBatch()
+    std::vector<RS_Entity*> batchEntities;
+    bool batching = false;
 };
 
 /*void addArc(QPointF *start);			->Without start
@@ -0,0 +1,224 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <thread>
+
+#include <QFileInfo>
+#include <QProgressDialog>
+#include <QScopedValueRollback>
+
+#include "lc_documentloader.h"
+#include "lc_filtersnapshot.h"
+#include "lc_imagecache.h"
+#include "rs_debug.h"
+#include "rs_filterdxfrw.h"
+#include "rs_graphic.h"
+#include "rs_settings.h"
+
+struct LC_DocumentLoader::Job {
+    QString fileName;
+    std::unique_ptr<RS_Graphic> graphic;
+    //! the percentage read and the request to cancel, shared with the worker
+    std::atomic<int> percent{0};
+    std::atomic<bool> canceled{false};
+    //! written by the worker, read once the result is ready
+    QString error;
+    //! declared last, so that the worker is waited for before the rest is destroyed
+    std::future<bool> result;
+};
+
+LC_DocumentLoader::LC_DocumentLoader(QWidget* parent)
+    : QObject(parent)
+    , m_parent{parent}
+{
+    connect(&m_timer, &QTimer::timeout, this, &LC_DocumentLoader::poll);
+}
+
+LC_DocumentLoader::~LC_DocumentLoader() {
+    for (const auto& job: m_jobs)
+        job->canceled = true;
+}
+
+bool LC_DocumentLoader::isBusy() const {
+    return !m_jobs.empty();
+}
+
+void LC_DocumentLoader::load(const QStringList& fileNames) {
+    for (const QString& fileName: fileNames) {
+        auto job = std::make_unique<Job>();
+        job->fileName = fileName;
+        m_jobs.push_back(std::move(job));
+        m_total++;
+    }
+
+    if (m_panel == nullptr) {
+        m_panel = new QProgressDialog(m_parent);
+        m_panel->setWindowTitle(tr("Opening Drawings"));
+        m_panel->setWindowModality(Qt::NonModal);
+        m_panel->setAutoClose(false);
+        m_panel->setAutoReset(false);
+        m_panel->setMinimumDuration(0);
+        connect(m_panel, &QProgressDialog::canceled, this, &LC_DocumentLoader::cancel);
+    }
+    startJobs();
+    updatePanel();
+    m_panel->show();
+    m_timer.start(100);
+}
+
+void LC_DocumentLoader::cancel() {
+    // queued files are dropped, running ones stop at their next progress report
+    const auto queued = std::remove_if(m_jobs.begin(), m_jobs.end(), [](const std::unique_ptr<Job>& job) {
+        return !job->result.valid();
+    });
+    m_total -= static_cast<int>(std::distance(queued, m_jobs.end()));
+    m_jobs.erase(queued, m_jobs.end());
+    for (const auto& job: m_jobs)
+        job->canceled = true;
+    if (m_panel != nullptr)
+        m_panel->setLabelText(tr("Canceling..."));
+}
+
+void LC_DocumentLoader::startJobs() {
+    // each file is parsed by several threads itself, see dxfRW::setParallelEntities()
+    const int limit = static_cast<int>(std::max(1u, std::thread::hardware_concurrency() / 2));
+    int running = static_cast<int>(std::count_if(m_jobs.begin(), m_jobs.end(), [](const std::unique_ptr<Job>& job) {
+        return job->result.valid();
+    }));
+    if (running >= limit || running == static_cast<int>(m_jobs.size()))
+        return;
+
+    // the settings are read by the singletons when they are used first,
+    // which is safe on this thread only
+    const bool cached = LC_FilterSnapshot::isCacheEnabled();
+    RS_SETTINGS->snapshot();
+    LC_ImageCache::instance();
+
+    for (const auto& job: m_jobs) {
+        if (running >= limit)
+            break;
+        if (job->result.valid())
+            continue;
+
+        // the drawing is created here, its constructor reads the settings
+        job->graphic = std::make_unique<RS_Graphic>();
+        job->graphic->beginOpen(job->fileName);
+
+        Job* worker = job.get();
+        job->result = std::async(std::launch::async, [worker, cached]() {
+            try {
+                if (cached && LC_FilterSnapshot().importCache(*worker->graphic, worker->fileName))
+                    return true;
+
+                RS_FilterDXFRW filter;
+                filter.setProgressCallback([worker](int percent) {
+                    worker->percent = percent;
+                    return !worker->canceled;
+                });
+                bool imported = filter.fileImport(*worker->graphic, worker->fileName, RS2::FormatDXFRW);
+                if (imported && cached)
+                    LC_FilterSnapshot().exportCache(*worker->graphic, worker->fileName);
+                if (!imported)
+                    worker->error = filter.lastError();
+                return imported;
+            } catch (const std::exception& e) {
+                worker->error = QString::fromUtf8(e.what());
+                return false;
+            }
+        });
+        running++;
+    }
+}
+
+void LC_DocumentLoader::poll() {
+    // the receivers of the signals may process events
+    if (m_polling)
+        return;
+    QScopedValueRollback<bool> guard(m_polling, true);
+
+    std::vector<std::unique_ptr<Job>> ready;
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if ((*it)->result.valid()
+                && (*it)->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            ready.push_back(std::move(*it));
+            it = m_jobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_done += static_cast<int>(ready.size());
+    startJobs();
+    updatePanel();
+
+    for (const auto& job: ready) {
+        if (job->result.get()) {
+            job->graphic->endOpen(job->fileName, RS2::FormatDXFRW);
+            RS_DEBUG->print("LC_DocumentLoader: read %s", job->fileName.toLatin1().data());
+            emit loaded(job->graphic.release(), job->fileName);
+        } else if (!job->canceled) {
+            RS_DEBUG->print(RS_Debug::D_WARNING, "LC_DocumentLoader: cannot read %s",
+                            job->fileName.toLatin1().data());
+            emit failed(job->fileName, job->error);
+        }
+    }
+
+    if (m_jobs.empty() && m_timer.isActive()) {
+        m_timer.stop();
+        m_panel->reset();
+        m_panel->hide();
+        m_total = 0;
+        m_done = 0;
+        emit finished();
+    }
+}
+
+void LC_DocumentLoader::updatePanel() {
+    if (m_panel == nullptr)
+        return;
+
+    int value = m_done * 100;
+    int queued = 0;
+    QStringList lines;
+    lines << tr("%1 of %2 drawings opened").arg(m_done).arg(m_total);
+    for (const auto& job: m_jobs) {
+        if (!job->result.valid()) {
+            queued++;
+            continue;
+        }
+        value += job->percent;
+        lines << tr("%1: %2%").arg(QFileInfo(job->fileName).fileName()).arg(job->percent.load());
+    }
+    if (queued > 0)
+        lines << tr("%n drawing(s) waiting", "", queued);
+
+    m_panel->setMaximum(std::max(m_total, 1) * 100);
+    m_panel->setValue(std::min(value, m_panel->maximum()));
+    if (!m_panel->wasCanceled())
+        m_panel->setLabelText(lines.join('\n'));
+}
@@ -0,0 +1,84 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#ifndef LC_DOCUMENTLOADER_H
+#define LC_DOCUMENTLOADER_H
+
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+class QProgressDialog;
+class QWidget;
+class RS_Graphic;
+
+/**
+ * Opens several DXF files at once. Each file is imported by a worker
+ * thread into a drawing which isn't shown yet, and handed over with
+ * loaded() when it's complete. A single progress panel shows the files
+ * being read, and cancels all of them.
+ *
+ * The drawings are created and finished on the GUI thread, the workers
+ * only parse the files.
+ */
+class LC_DocumentLoader : public QObject {
+    Q_OBJECT
+public:
+    explicit LC_DocumentLoader(QWidget* parent);
+    /** Cancels the files still being read and waits for their workers. */
+    ~LC_DocumentLoader() override;
+
+    /** Adds files to read, while others may still be read. */
+    void load(const QStringList& fileNames);
+    bool isBusy() const;
+    void cancel();
+
+signals:
+    /** A drawing was read, the receiver takes ownership of it. */
+    void loaded(RS_Graphic* graphic, const QString& fileName);
+    void failed(const QString& fileName, const QString& error);
+    /** All files added were read, failed or canceled. */
+    void finished();
+
+private:
+    struct Job;
+
+    void startJobs();
+    void poll();
+    void updatePanel();
+
+    //! queued and running jobs, in the order the files were added
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    QTimer m_timer;
+    QProgressDialog* m_panel = nullptr;
+    QWidget* m_parent = nullptr;
+    int m_total = 0;
+    int m_done = 0;
+    bool m_polling = false;
+};
+
+#endif // LC_DOCUMENTLOADER_H
@@ -0,0 +1,213 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_tiffstripwriter.h"
+
+#include <limits>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QImage>
+#include <QObject>
+
+namespace {
+// baseline TIFF tags, in the ascending order of the image directory
+enum Tag : quint16 {
+    ImageWidth = 256,
+    ImageLength = 257,
+    BitsPerSample = 258,
+    Compression = 259,
+    PhotometricInterpretation = 262,
+    StripOffsets = 273,
+    SamplesPerPixel = 277,
+    RowsPerStrip = 278,
+    StripByteCounts = 279,
+    XResolution = 282,
+    YResolution = 283,
+    ResolutionUnit = 296
+};
+
+enum Type : quint16 {
+    Short = 3,
+    Long = 4,
+    Rational = 5
+};
+
+constexpr quint16 packBitsCompression = 32773;
+constexpr quint16 rgbPhotometric = 2;
+constexpr quint16 inchUnit = 2;
+constexpr quint32 dotsPerInch = 72;
+
+/**
+ * PackBits compression of a row: runs of a repeated byte, and literal bytes in between
+ */
+void packBits(const uchar* data, int size, QByteArray& packed)
+{
+    constexpr int maxLength = 128;
+    int i = 0;
+    while (i < size) {
+        int run = 1;
+        while (i + run < size && run < maxLength && data[i + run] == data[i])
+            run++;
+        if (run >= 2) {
+            packed.append(char(1 - run));
+            packed.append(char(data[i]));
+            i += run;
+            continue;
+        }
+        const int start = i;
+        while (i < size && i - start < maxLength && (i + 1 == size || data[i] != data[i + 1]))
+            i++;
+        packed.append(char(i - start - 1));
+        packed.append(reinterpret_cast<const char*>(data + start), i - start);
+    }
+}
+}
+
+LC_TiffStripWriter::LC_TiffStripWriter(const QString& fileName, QSize size):
+    m_file{fileName}
+  , m_size{size}
+{}
+
+bool LC_TiffStripWriter::open()
+{
+    if (m_size.isEmpty())
+        return fail(QObject::tr("Invalid image size"));
+    if (!m_file.open(QIODevice::WriteOnly))
+        return fail(m_file.errorString());
+
+    // little endian header, the offset of the directory is written by close()
+    QDataStream out(&m_file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData("II", 2);
+    out << quint16(42) << quint32(0);
+    return out.status() == QDataStream::Ok || fail(m_file.errorString());
+}
+
+bool LC_TiffStripWriter::writeStrip(const QImage& strip)
+{
+    if (!m_file.isOpen())
+        return false;
+    if (strip.width() != m_size.width() || m_rows + strip.height() > m_size.height())
+        return fail(QObject::tr("Strip out of the image"));
+    if (m_rowsPerStrip == 0)
+        m_rowsPerStrip = strip.height();
+    else if (m_rows % m_rowsPerStrip != 0 || strip.height() > m_rowsPerStrip)
+        return fail(QObject::tr("Strips of different heights"));
+
+    const QImage rgb = strip.convertToFormat(QImage::Format_RGB888);
+    QByteArray packed;
+    for (int y = 0; y < rgb.height(); y++)
+        packBits(rgb.constScanLine(y), 3 * rgb.width(), packed);
+
+    // offsets are 32 bits
+    if (m_file.pos() + packed.size() > std::numeric_limits<quint32>::max())
+        return fail(QObject::tr("Image larger than 4 GiB"));
+    m_stripOffsets.push_back(quint32(m_file.pos()));
+    m_stripByteCounts.push_back(quint32(packed.size()));
+    if (m_file.write(packed) != packed.size())
+        return fail(m_file.errorString());
+    m_rows += strip.height();
+    return true;
+}
+
+bool LC_TiffStripWriter::close()
+{
+    if (!m_file.isOpen())
+        return false;
+    if (m_rows != m_size.height())
+        return fail(QObject::tr("Missing image rows"));
+
+    QDataStream out(&m_file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    // values of more than 4 bytes are stored out of the directory, at word boundaries
+    auto align = [this, &out]() {
+        if (m_file.pos() % 2 != 0)
+            out << quint8(0);
+        return quint32(m_file.pos());
+    };
+
+    const quint32 bitsOffset = align();
+    out << quint16(8) << quint16(8) << quint16(8);
+    const quint32 resolutionOffset = align();
+    out << dotsPerInch << quint32(1);
+
+    const bool oneStrip = m_stripOffsets.size() == 1;
+    quint32 offsetsOffset = m_stripOffsets.front();
+    quint32 countsOffset = m_stripByteCounts.front();
+    if (!oneStrip) {
+        offsetsOffset = align();
+        for (quint32 offset: m_stripOffsets)
+            out << offset;
+        countsOffset = align();
+        for (quint32 count: m_stripByteCounts)
+            out << count;
+    }
+
+    const quint32 directoryOffset = align();
+    if (m_file.pos() > std::numeric_limits<quint32>::max() - 256)
+        return fail(QObject::tr("Image larger than 4 GiB"));
+    const quint32 strips = quint32(m_stripOffsets.size());
+    auto entry = [&out](Tag tag, Type type, quint32 count, quint32 value) {
+        out << quint16(tag) << quint16(type) << count;
+        // a single short is left aligned in the value
+        if (type == Short && count == 1)
+            out << quint16(value) << quint16(0);
+        else
+            out << value;
+    };
+    out << quint16(12);
+    entry(ImageWidth, Long, 1, quint32(m_size.width()));
+    entry(ImageLength, Long, 1, quint32(m_size.height()));
+    entry(BitsPerSample, Short, 3, bitsOffset);
+    entry(Compression, Short, 1, packBitsCompression);
+    entry(PhotometricInterpretation, Short, 1, rgbPhotometric);
+    entry(StripOffsets, Long, strips, offsetsOffset);
+    entry(SamplesPerPixel, Short, 1, 3);
+    entry(RowsPerStrip, Long, 1, quint32(m_rowsPerStrip));
+    entry(StripByteCounts, Long, strips, countsOffset);
+    entry(XResolution, Rational, 1, resolutionOffset);
+    entry(YResolution, Rational, 1, resolutionOffset);
+    entry(ResolutionUnit, Short, 1, inchUnit);
+    out << quint32(0);
+
+    m_file.seek(4);
+    out << directoryOffset;
+    if (out.status() != QDataStream::Ok)
+        return fail(m_file.errorString());
+    m_file.close();
+    return true;
+}
+
+QString LC_TiffStripWriter::errorString() const
+{
+    return m_error;
+}
+
+bool LC_TiffStripWriter::fail(const QString& error)
+{
+    m_error = error;
+    if (m_file.isOpen())
+        m_file.close();
+    return false;
+}
@@ -0,0 +1,69 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_TIFFSTRIPWRITER_H
+#define LC_TIFFSTRIPWRITER_H
+
+#include <vector>
+
+#include <QFile>
+#include <QSize>
+#include <QString>
+
+class QImage;
+
+/**
+ * @brief The LC_TiffStripWriter class, writes an RGB TIFF file strip by strip, so an image
+ * larger than the memory can be written while it's rendered. Strips are PackBits compressed,
+ * and all of them but the last one must be of the height of the first one.
+ */
+class LC_TiffStripWriter {
+public:
+    LC_TiffStripWriter(const QString& fileName, QSize size);
+
+    bool open();
+    /**
+     * @brief writeStrip - append the next rows of the image
+     * @param strip - rows of the width of the image
+     */
+    bool writeStrip(const QImage& strip);
+    /**
+     * @brief close - write the image directory, once all rows are written
+     */
+    bool close();
+
+    QString errorString() const;
+
+private:
+    bool fail(const QString& error);
+
+    QFile m_file;
+    QSize m_size;
+    int m_rows = 0;
+    int m_rowsPerStrip = 0;
+    std::vector<quint32> m_stripOffsets;
+    std::vector<quint32> m_stripByteCounts;
+    QString m_error;
+};
+
+#endif
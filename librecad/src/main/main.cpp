@@ -44,10 +44,15 @@
 #include "qg_dlginitial.h"
 
 #include "lc_application.h"
+#include "lc_tracing.h"
 #include "qc_applicationwindow.h"
 #include "rs_debug.h"
 
 #include "console_dxf2pdf.h"
+#include "console_benchmark.h"
+#include "console_corpusbench.h"
+#include "console_batchedit.h"
+#include "console_dwg2dxf.h"
 #include "console_dxf2png.h"
 
 namespace
@@ -82,6 +87,18 @@ int main(int argc, char** argv)
         if (arg.compare("dxf2png") == 0 || arg == "dxf2svg") {
             return console_dxf2png(argc, argv);
         }
+        if (arg.compare("benchmark") == 0) {
+            return console_benchmark(argc, argv);
+        }
+        if (arg.compare("corpusbench") == 0) {
+            return console_corpusbench(argc, argv);
+        }
+        if (arg.compare("batchedit") == 0) {
+            return console_batchedit(argc, argv);
+        }
+        if (arg.compare("dwg2dxf") == 0) {
+            return console_dwg2dxf(argc, argv);
+        }
     }
 
     RS_DEBUG->setLevel(RS_Debug::D_WARNING);
@@ -101,6 +118,8 @@ int main(int argc, char** argv)
 
     const QString lpDebugSwitch0("-d"),lpDebugSwitch1("--debug") ;
     const QString help0("-h"), help1("--help");
+    const QString traceSwitch("--trace");
+    QString traceFile;
     bool allowOptions=true;
     QList<int> argClean;
     for (int i=0; i<argc; i++)
@@ -121,11 +140,16 @@ int main(int argc, char** argv)
             qDebug()<<"  dxf2pdf\tRun librecad as console dxf2pdf tool. Use -h for help.";
             qDebug()<<"  dxf2png\tRun librecad as console dxf2png tool. Use -h for help.";
             qDebug()<<"  dxf2svg\tRun librecad as console dxf2svg tool. Use -h for help.";
+            qDebug()<<"  benchmark\tMeasure the engine on generated drawings. Use -h for help.";
+            qDebug()<<"  corpusbench\tMeasure loading, rendering and saving DXF/DWG files. Use -h for help.";
+            qDebug()<<"  batchedit\tApply the same edits to many DXF files. Use -h for help.";
+            qDebug()<<"  dwg2dxf\tConvert DWG files to DXF. Use -h for help.";
             qDebug()<<"";
             qDebug()<<"Options:";
             qDebug()<<"";
             qDebug()<<"  -h, --help\tdisplay this message";
             qDebug()<<"  -d, --debug <level>";
+            qDebug()<<"  --trace <file>\trecord performance traces, saved as Chrome trace JSON on exit";
             qDebug()<<"";
             RS_DEBUG->print( RS_Debug::D_NOTHING, "possible debug levels:");
             RS_DEBUG->print( RS_Debug::D_NOTHING, "    %d Nothing", RS_Debug::D_NOTHING);
@@ -137,6 +161,18 @@ int main(int argc, char** argv)
             RS_DEBUG->print( RS_Debug::D_NOTHING, "    %d Debugging", RS_Debug::D_DEBUGGING);
             exit(0);
         }
+        if (allowOptions && traceSwitch.compare(argstr, Qt::CaseInsensitive)==0)
+        {
+            argClean<<i;
+            if (i+1<argc)
+            {
+                ++i;
+                argClean<<i;
+                traceFile = QFile::decodeName(argv[i]);
+                LC_Tracing::setEnabled(true);
+            }
+            continue;
+        }
         if ( allowOptions&& (argstr.startsWith(lpDebugSwitch0, Qt::CaseInsensitive) ||
                              argstr.startsWith(lpDebugSwitch1, Qt::CaseInsensitive) ))
         {
@@ -386,6 +422,9 @@ int main(int argc, char** argv)
 
     RS_DEBUG->print("main: exited Qt event loop");
 
+    if (!traceFile.isEmpty())
+        LC_Tracing::exportChromeTrace(traceFile);
+
     // Destroy the singleton
     QC_ApplicationWindow::getAppWindow().reset();
 
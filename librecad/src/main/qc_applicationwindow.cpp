@@ -66,6 +66,7 @@
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_document.h"
+#include "rs_grid.h"
 #include "rs_painterqt.h"
 #include "rs_pen.h"
 #include "rs_settings.h"
@@ -76,9 +77,12 @@
 
 #include "lc_actionfactory.h"
 #include "lc_actiongroupmanager.h"
+#include "lc_actionprofiler.h"
 #include "lc_centralwidget.h"
+#include "lc_documentloader.h"
 #include "lc_penwizard.h"
 #include "lc_printing.h"
+#include "lc_tracing.h"
 #include "lc_widgetfactory.h"
 #include "lc_widgetoptionsdialog.h"
 #include "lc_undosection.h"
@@ -364,8 +368,8 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     //emit windowsChanged(false);
 
     RS_COMMANDS->updateAlias();
-    //plugin load
-    loadPlugins();
+    //plugin load, once the window is shown
+    QTimer::singleShot(0, this, &QC_ApplicationWindow::loadPlugins);
 
     statusBar()->showMessage(qApp->applicationName() + " Ready", 2000);
 }
@@ -808,14 +812,15 @@ void QC_ApplicationWindow::dropEvent(QDropEvent* event)
     event->acceptProposedAction();
 
     //limit maximum number of dropped files to be opened
-    unsigned counts=0;
+    QStringList fileNames;
     for(QUrl const& url: event->mimeData()->urls()) {
         const QString &fileName = url.toLocalFile();
         if(QFileInfo(fileName).exists() && fileName.endsWith(R"(.dxf)", Qt::CaseInsensitive)){
-            slotFileOpen(fileName);
-            if(++counts>32) return;
+            fileNames << fileName;
+            if(fileNames.size()>32) break;
         }
     }
+    slotFilesOpen(fileNames);
 }
 
 void 	QC_ApplicationWindow::dragEnterEvent(QDragEnterEvent * event)
@@ -1082,6 +1087,9 @@ void QC_ApplicationWindow::slotWindowActivated(QMdiSubWindow* w, bool forced)
 
         blockWidget->setBlockList(m->getDocument()->getBlockList());
 
+        // external references whose files were modified meanwhile
+        if (m->getGraphic() != nullptr)
+            m->getGraphic()->reloadXrefs();
         // Update all inserts in this graphic (blocks might have changed):
         m->getDocument()->updateInserts();
         // whether to enable undo/redo buttons
@@ -1532,11 +1540,20 @@ QC_MDIWindow* QC_ApplicationWindow::slotFileNew(RS_Document* doc) {
     int aa = RS_SETTINGS->readNumEntry("/Antialiasing", 0);
     int scrollbars = RS_SETTINGS->readNumEntry("/ScrollBars", 1);
     int cursor_hiding = RS_SETTINGS->readNumEntry("/cursor_hiding", 0);
+    bool layerCaching = RS_SETTINGS->readNumEntry("/LayerCaching", 0) == 1;
+    bool progressiveRendering = RS_SETTINGS->readNumEntry("/ProgressiveRendering", 1) == 1;
+    bool zoomPreview = RS_SETTINGS->readNumEntry("/ZoomPreview", 1) == 1;
+    bool interactionQuality = RS_SETTINGS->readNumEntry("/InteractionQuality", 1) == 1;
     RS_SETTINGS->endGroup();
 
     QG_GraphicView* view = w->getGraphicView();
 
     view->setAntialiasing(aa);
+    view->setLayerCaching(layerCaching);
+    view->setProgressiveRendering(progressiveRendering);
+    view->setZoomPreview(zoomPreview);
+    view->setInteractionQuality(interactionQuality);
+    view->setRenderStatistics(renderStatistics);
     view->setCursorHiding(cursor_hiding);
     view->device = settings.value("Hardware/Device", "Mouse").toString();
     if (scrollbars) view->addScrollbars();
@@ -1865,8 +1882,6 @@ void QC_ApplicationWindow::
 {
     RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen(..)");
 
-    QSettings settings;
-
     QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
 
     if ( QFileInfo(fileName).exists())
@@ -1932,88 +1947,152 @@ void QC_ApplicationWindow::
                return;
         }
 
-		slotWindowActivated(w);
-
         RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: open file: OK");
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update recent file menu: 1");
+        showOpenedDocument(w, fileName);
 
-        // update recent files menu:
-        recentFiles->add(fileName);
-        openedFiles.push_back(fileName);
-        layerWidget->slotUpdateLayerList();
-        if (layerTreeWidget != nullptr)
-            layerTreeWidget->slotFilteringMaskChanged();
+	} else {
+		QG_DIALOGFACTORY->commandMessage(tr("File '%1' does not exist. Opening aborted").arg(fileName));
+        statusBar()->showMessage(tr("Opening aborted"), 2000);
+    }
 
-        auto graphic = w->getGraphic();
-        if (graphic)
-        {
-            if (int objects_removed = graphic->clean())
-            {
-                auto msg = QObject::tr("Invalid objects removed:");
-                commandWidget->appendHistory(msg + " " + QString::number(objects_removed));
-            }
-            emit(gridChanged(graphic->isGridOn()));
+    QApplication::restoreOverrideCursor();
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen(..) OK");
+}
+
+void QC_ApplicationWindow::slotFileOpen(const QString& fileName) {
+    slotFileOpen(fileName, RS2::FormatUnknown);
+}
+
+/**
+ * Opens several files in the background. The files are parsed in parallel,
+ * and shown in their windows in the order they were read.
+ * A single file is opened at once, as by slotFileOpen().
+ */
+void QC_ApplicationWindow::slotFilesOpen(const QStringList& fileNames)
+{
+    if (fileNames.size() == 1 && (documentLoader == nullptr || !documentLoader->isBusy())) {
+        slotFileOpen(fileNames.first());
+        return;
+    }
+    if (fileNames.isEmpty())
+        return;
+
+    for (const QString& fileName: fileNames) {
+        if (openedFiles.indexOf(fileName) >=0) {
+            QString message=tr("Warning: File already opened : ")+fileName;
+            commandWidget->appendHistory(message);
         }
+    }
 
-        recentFiles->updateRecentFilesMenu();
+    if (documentLoader == nullptr) {
+        documentLoader = new LC_DocumentLoader(this);
+        connect(documentLoader, &LC_DocumentLoader::loaded,
+                this, &QC_ApplicationWindow::slotDocumentLoaded);
+        connect(documentLoader, &LC_DocumentLoader::failed,
+                this, [this](const QString& fileName, const QString& error) {
+            commandWidget->appendHistory(tr("Cannot open %1: %2").arg(fileName, error));
+            loadFailures << QStringLiteral("%1: %2").arg(QDir::toNativeSeparators(fileName), error);
+        });
+        connect(documentLoader, &LC_DocumentLoader::finished, this, [this]() {
+            statusBar()->showMessage(tr("Opening drawings finished"), 2000);
+            if (loadFailures.isEmpty())
+                return;
+            // a single message for all files which failed
+            const QString message = tr("Import error:", "fileImport") + "\n" + loadFailures.join("\n");
+            loadFailures.clear();
+            QMessageBox::critical(this, tr("Error", "fileImport"), message);
+        });
+    }
+    statusBar()->showMessage(tr("Opening %n drawing(s)...", "", fileNames.size()));
+    documentLoader->load(fileNames);
+}
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: set caption");
+void QC_ApplicationWindow::slotDocumentLoaded(RS_Graphic* graphic, const QString& fileName)
+{
+    RS_DEBUG->print("QC_ApplicationWindow::slotDocumentLoaded(%s)", fileName.toLatin1().data());
 
+    QC_MDIWindow* w = slotFileNew(graphic);
+    w->setOwner(true);
+    w->getGraphicView()->redraw();
 
-                /*	Format and set caption.
-                 *	----------------------- */
-        w->setWindowTitle(format_filename_caption(fileName) + "[*]");
+    showOpenedDocument(w, fileName);
+}
 
-		if (mdiAreaCAD->viewMode() == QMdiArea::TabbedView) {
-			QList<QTabBar *> tabBarList = mdiAreaCAD->findChildren<QTabBar*>();
-			QTabBar *tabBar = tabBarList.at(0);
-			if (tabBar) {
-				tabBar->setExpanding(false);
-				tabBar->setTabToolTip(tabBar->currentIndex(), fileName);
-			}
-		}
-		else
-			doArrangeWindows(RS2::CurrentMode);
+/**
+ * Shows a document just opened in its window, and adds it to the recent files.
+ */
+void QC_ApplicationWindow::showOpenedDocument(QC_MDIWindow* w, const QString& fileName)
+{
+    QSettings settings;
 
-		RS_SETTINGS->beginGroup("/CADPreferences");
-		if (RS_SETTINGS->readNumEntry("/AutoZoomDrawing"))
-			w->getGraphicView()->zoomAuto(false);
-		RS_SETTINGS->endGroup();
+    slotWindowActivated(w);
+
+    RS_DEBUG->print("QC_ApplicationWindow::showOpenedDocument: update recent file menu: 1");
+
+    // update recent files menu:
+    recentFiles->add(fileName);
+    openedFiles.push_back(fileName);
+    layerWidget->slotUpdateLayerList();
+    if (layerTreeWidget != nullptr)
+        layerTreeWidget->slotFilteringMaskChanged();
 
-        if (settings.value("Appearance/DraftMode", 0).toBool())
+    auto graphic = w->getGraphic();
+    if (graphic)
+    {
+        if (int objects_removed = graphic->clean())
         {
-            QString draft_string = " ["+tr("Draft Mode")+"]";
-            w->getGraphicView()->setDraftMode(true);
-            w->getGraphicView()->redraw();
-            QString title = w->windowTitle();
-            w->setWindowTitle(title + draft_string);
+            auto msg = QObject::tr("Invalid objects removed:");
+            commandWidget->appendHistory(msg + " " + QString::number(objects_removed));
         }
+        emit(gridChanged(graphic->isGridOn()));
+    }
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: set caption: OK");
+    recentFiles->updateRecentFilesMenu();
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update coordinate widget");
-        // update coordinate widget format:
-        RS_DIALOGFACTORY->updateCoordinateWidget(RS_Vector(0.0,0.0),
-                RS_Vector(0.0,0.0),
-                true);
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update coordinate widget: OK");
+    RS_DEBUG->print("QC_ApplicationWindow::showOpenedDocument: set caption");
 
-        QString message=tr("Loaded document: ")+fileName;
-        commandWidget->appendHistory(message);
-        statusBar()->showMessage(message, 2000);
+    /*	Format and set caption.
+     *	----------------------- */
+    w->setWindowTitle(format_filename_caption(fileName) + "[*]");
 
-	} else {
-		QG_DIALOGFACTORY->commandMessage(tr("File '%1' does not exist. Opening aborted").arg(fileName));
-        statusBar()->showMessage(tr("Opening aborted"), 2000);
+	if (mdiAreaCAD->viewMode() == QMdiArea::TabbedView) {
+		QList<QTabBar *> tabBarList = mdiAreaCAD->findChildren<QTabBar*>();
+		QTabBar *tabBar = tabBarList.at(0);
+		if (tabBar) {
+			tabBar->setExpanding(false);
+			tabBar->setTabToolTip(tabBar->currentIndex(), fileName);
+		}
+	}
+	else
+		doArrangeWindows(RS2::CurrentMode);
+
+	RS_SETTINGS->beginGroup("/CADPreferences");
+	if (RS_SETTINGS->readNumEntry("/AutoZoomDrawing"))
+		w->getGraphicView()->zoomAuto(false);
+	RS_SETTINGS->endGroup();
+
+    if (settings.value("Appearance/DraftMode", 0).toBool())
+    {
+        QString draft_string = " ["+tr("Draft Mode")+"]";
+        w->getGraphicView()->setDraftMode(true);
+        w->getGraphicView()->redraw();
+        QString title = w->windowTitle();
+        w->setWindowTitle(title + draft_string);
     }
 
-    QApplication::restoreOverrideCursor();
-    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen(..) OK");
-}
+    RS_DEBUG->print("QC_ApplicationWindow::showOpenedDocument: set caption: OK");
 
-void QC_ApplicationWindow::slotFileOpen(const QString& fileName) {
-    slotFileOpen(fileName, RS2::FormatUnknown);
+    RS_DEBUG->print("QC_ApplicationWindow::showOpenedDocument: update coordinate widget");
+    // update coordinate widget format:
+    RS_DIALOGFACTORY->updateCoordinateWidget(RS_Vector(0.0,0.0),
+            RS_Vector(0.0,0.0),
+            true);
+    RS_DEBUG->print("QC_ApplicationWindow::showOpenedDocument: update coordinate widget: OK");
+
+    QString message=tr("Loaded document: ")+fileName;
+    commandWidget->appendHistory(message);
+    statusBar()->showMessage(message, 2000);
 }
 
 
@@ -2924,6 +3003,10 @@ void QC_ApplicationWindow::slotOptionsGeneral() {
     RS_SETTINGS->beginGroup("/Appearance");
     int antialiasing = RS_SETTINGS->readNumEntry("/Antialiasing");
     bool hideRelativeZero = RS_SETTINGS->readNumEntry("/hideRelativeZero", 0) == 1;
+    bool layerCaching = RS_SETTINGS->readNumEntry("/LayerCaching", 0) == 1;
+    bool progressiveRendering = RS_SETTINGS->readNumEntry("/ProgressiveRendering", 1) == 1;
+    bool zoomPreview = RS_SETTINGS->readNumEntry("/ZoomPreview", 1) == 1;
+    bool interactionQuality = RS_SETTINGS->readNumEntry("/InteractionQuality", 1) == 1;
     RS_SETTINGS->endGroup();
 
     emit signalEnableRelativeZeroSnaps(!hideRelativeZero);
@@ -2945,6 +3028,11 @@ void QC_ApplicationWindow::slotOptionsGeneral() {
                 gv->setRelativeZeroColor(relativeZeroColor);
                 gv->setRelativeZeroHiddenState(hideRelativeZero);
                 gv->setAntialiasing(antialiasing);
+                gv->setLayerCaching(layerCaching);
+                gv->setProgressiveRendering(progressiveRendering);
+                gv->setZoomPreview(zoomPreview);
+                gv->setInteractionQuality(interactionQuality);
+                gv->getGrid()->loadSettings();
                 gv->redraw(RS2::RedrawGrid);
             }
         }
@@ -3789,6 +3877,68 @@ void QC_ApplicationWindow::invokeLicenseWindow()
     dlg.exec();
 }
 
+/**
+ * Starts recording performance traces, or stops it and saves the
+ * recorded events as a Chrome trace file.
+ */
+void QC_ApplicationWindow::slotTracing(bool on)
+{
+    if (on) {
+        LC_Tracing::clear();
+        LC_Tracing::setEnabled(true);
+        RS_DIALOGFACTORY->commandMessage(tr("Performance tracing started"));
+        return;
+    }
+    LC_Tracing::setEnabled(false);
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Performance Trace"),
+                                                    RS_SYSTEM->getHomeDir() + "/librecad_trace.json",
+                                                    tr("Chrome Trace (*.json)"));
+    if (fileName.isEmpty())
+        return;
+    if (LC_Tracing::exportChromeTrace(fileName))
+        RS_DIALOGFACTORY->commandMessage(tr("Performance trace saved to %1").arg(fileName));
+    else
+        QMessageBox::warning(this, tr("Warning"), tr("Cannot write the file %1").arg(fileName));
+}
+
+/**
+ * Starts timing the stages of the interactive actions, or stops it and saves
+ * the timings, aggregated per action, as a CSV file.
+ */
+void QC_ApplicationWindow::slotActionProfiling(bool on)
+{
+    if (on) {
+        LC_ActionProfiler::clear();
+        LC_ActionProfiler::setEnabled(true);
+        RS_DIALOGFACTORY->commandMessage(tr("Action profiling started"));
+        return;
+    }
+    LC_ActionProfiler::setEnabled(false);
+    RS_DEBUG->print(RS_Debug::D_INFORMATIONAL, "%s", LC_ActionProfiler::toText().toLocal8Bit().constData());
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save Action Profile"),
+                                                    RS_SYSTEM->getHomeDir() + "/librecad_actions.csv",
+                                                    tr("CSV (*.csv)"));
+    if (fileName.isEmpty())
+        return;
+    if (LC_ActionProfiler::exportCsv(fileName))
+        RS_DIALOGFACTORY->commandMessage(tr("Action profile saved to %1").arg(fileName));
+    else
+        QMessageBox::warning(this, tr("Warning"), tr("Cannot write the file %1").arg(fileName));
+}
+
+/**
+ * Shows or hides the render statistics overlay of all graphic views.
+ */
+void QC_ApplicationWindow::slotRenderStatistics(bool on)
+{
+    renderStatistics = on;
+    for (QC_MDIWindow* w: window_list) {
+        if (w != nullptr && w->getGraphicView() != nullptr)
+            w->getGraphicView()->setRenderStatistics(on);
+    }
+}
+
+
 
 QC_MDIWindow* QC_ApplicationWindow::getWindowWithDoc(const RS_Document* doc)
 {
@@ -42,6 +42,7 @@
 
 class LC_ActionGroupManager;
 class LC_CustomToolbar;
+class LC_DocumentLoader;
 class LC_PenWizard;
 class LC_PenPaletteWidget;
 class LC_SimpleTests;
@@ -66,6 +67,7 @@ class QMdiArea;
 class QMdiSubWindow;
 class RS_Block;
 class RS_Document;
+class RS_Graphic;
 class RS_GraphicView;
 class RS_Pen;
 class TwoStackedLabels;
@@ -159,6 +161,12 @@ public slots:
      */
     void slotFileOpen(const QString& fileName, RS2::FormatType type);
     void slotFileOpen(const QString& fileName); // Assume Unknown type
+    /**
+     * opens several DXF files at once, each read by a worker thread.
+     */
+    void slotFilesOpen(const QStringList& fileNames);
+    /** shows a drawing read by a worker thread, the window takes ownership */
+    void slotDocumentLoaded(RS_Graphic* graphic, const QString& fileName);
     void slotFileOpenRecent(QAction* action);
     /** saves a document */
     void slotFileSave();
@@ -239,6 +247,9 @@ public slots:
     void updateMenu(const QString& menu_name);
 
     void invokeLicenseWindow();
+    void slotTracing(bool on);
+    void slotActionProfiling(bool on);
+    void slotRenderStatistics(bool on);
 
 
 signals:
@@ -346,6 +357,7 @@ private:
     QString format_filename_caption(const QString &qstring_in);
     /** Helper function for Menu file -> New & New.... */
 	bool slotFileNewHelper(QString fileName, QC_MDIWindow* w = nullptr);
+    void showOpenedDocument(QC_MDIWindow* w, const QString& fileName);
 	// more helpers
 	void doArrangeWindows(RS2::SubWindowMode mode, bool actuallyDont = false);
 	void setTabLayout(RS2::TabShape s, RS2::TabPosition p);
@@ -389,6 +401,10 @@ private:
 
     /** Recent files list */
     QG_RecentFiles* recentFiles {nullptr};
+    /** Reads dropped files in the background */
+    LC_DocumentLoader* documentLoader {nullptr};
+    /** Files the document loader failed to read */
+    QStringList loadFailures;
 
     // --- Dockwidgets ---
     //! toggle actions for the dock areas
@@ -448,6 +464,7 @@ private:
     bool previousZoomEnable{false};
     bool undoEnable{false};
     bool redoEnable{false};
+    bool renderStatistics{false};
 
     // --- Lists ---
     QList<QC_PluginInterface*> loadedPlugins;
@@ -78,6 +78,10 @@ public:
 	
     /** @return Pointer to graphic or NULL */
 	RS_Graphic* getGraphic() const;
+    /** The window deletes a document it owns, when it's closed. */
+    void setOwner(bool owner) {
+        m_owner = owner;
+    }
 
 	/** @return Pointer to current event handler */
 	RS_EventHandler* getEventHandler() const;
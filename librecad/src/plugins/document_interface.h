@@ -28,10 +28,12 @@
 
 #include <QPointF>
 #include <QHash>
+#include <QStringList>
 #include <QVariant>
 #include<vector>
 //#include <QColor>
 class QString;
+class Document_Interface;
 
 namespace DPI {
     //! Vertical alignments.
@@ -197,6 +199,77 @@ public:
     double bulge;
 };
 
+//! Data of many entities, as arrays.
+ /*!
+ *  Filled by Document_Interface::getSelectData() and getAllEntitiesData() without
+ *  creating a Plug_Entity and a QHash for each entity. The element i of all arrays
+ *  is for the same entity:
+ *  - startPoints: DPI::STARTX, DPI::STARTY, the start point of lines, the position of
+ *    points, the center of circles, arcs and ellipses, the insertion point of
+ *    inserts, texts and images.
+ *  - endPoints: DPI::ENDX, DPI::ENDY, the end point of lines, the major axis of
+ *    ellipses, the U-vector of images, (0, 0) if unused.
+ *  - radii: DPI::RADIUS of circles and arcs, DPI::HEIGHT of texts, the ratio of
+ *    ellipses, 0 if unused.
+ */
+class Plug_EntityArrays
+{
+public:
+    std::vector<qulonglong> ids;        //!< DPI::EID
+    std::vector<int> types;             //!< enum DPI::ETYPE
+    std::vector<int> layers;            //!< index in layerNames, -1 for no layer
+    std::vector<int> colors;            //!< DPI::COLOR
+    std::vector<int> lineTypes;         //!< enum DPI::LineType
+    std::vector<int> lineWidths;        //!< enum DPI::LineWidth
+    std::vector<QPointF> startPoints;
+    std::vector<QPointF> endPoints;
+    std::vector<double> radii;
+    QStringList layerNames;
+
+    size_t size() const {
+        return ids.size();
+    }
+    void clear() {
+        ids.clear();
+        types.clear();
+        layers.clear();
+        colors.clear();
+        lineTypes.clear();
+        lineWidths.clear();
+        startPoints.clear();
+        endPoints.clear();
+        radii.clear();
+        layerNames.clear();
+    }
+};
+
+//! Progress and cancel channel of a Plug_Task.
+/*! Safe to use from the worker thread running Plug_Task::run().
+*/
+class Plug_Progress
+{
+public:
+    virtual ~Plug_Progress() = default;
+    //! Report the progress, a maximum of 0 shows a busy indicator.
+    virtual void setProgress(int value, int maximum) = 0;
+    //! true once the user canceled the task, run() should return soon.
+    virtual bool isCanceled() const = 0;
+};
+
+//! Long running plugin computation, see Document_Interface::runTask().
+/*! The plugin collects the data it needs from the document, for instance with
+* getSelectData(), before running the task. run() is called in a worker thread
+* and must not access the document, it keeps the edits it computes. apply()
+* is called afterwards on the GUI thread to add them to the document.
+*/
+class Plug_Task
+{
+public:
+    virtual ~Plug_Task() = default;
+    virtual void run(Plug_Progress *progress) = 0;
+    virtual void apply(Document_Interface *doc) = 0;
+};
+
 //! Wrapper for access entities from plugins.
  /*!
  *  Wrapper class for create, access and modify entities from plugins.
@@ -503,6 +576,13 @@ public:
     */
     virtual bool getAllEntities(QList<Plug_Entity *> *sel, bool visible = false) = 0;
 
+    //! Gets an entity of the document by its identifier.
+    /*! You can delete the Plug_Entity wen no more needed.
+    * \param id the DPI::EID of the entity.
+    * \return a Plug_Entity handle the entity or NULL if there is none.
+    */
+    virtual Plug_Entity *getEntity(qulonglong id) = 0;
+
     virtual void unselectEntities() = 0;
 
     virtual bool getVariableInt(const QString& key, int *num) = 0;
@@ -525,6 +605,81 @@ public:
     * \return a string with the converted number.
     */
     virtual QString realToStr(const qreal num, const int units = 0, const int prec = 0) = 0;
+
+    //! Gets the data of an entities selection.
+    /*! Prompt message or an default message to the user asking for a selection, like
+    * getSelect(), but the data of the selected entities is returned as arrays.
+    * \param data replaced by the data of the selected entities.
+    * \param message an optional QString with prompt message.
+    * \return true if success.
+    * \return false if fail, i.e. user cancel.
+    */
+    virtual bool getSelectData(Plug_EntityArrays *data, const QString& message = "") = 0;
+
+    //! Gets the data of all entities in document.
+    /*! Like getAllEntities(), but the data of the entities is returned as arrays.
+    * \param data replaced by the data of the entities.
+    * \param visible if true, only the visible entities are included.
+    * \return true if success.
+    */
+    virtual bool getAllEntitiesData(Plug_EntityArrays *data, bool visible = false) = 0;
+
+    //! Starts a batch of entity creation.
+    /*! Entities added until commitBatch() are queued and added to the document
+    * together, in one undo cycle and with a single redraw.
+    */
+    virtual void beginBatch() = 0;
+
+    //! Adds the entities queued since beginBatch() and redraws the drawing.
+    virtual void commitBatch() = 0;
+
+    //! Add a point entity for each of the given points.
+    virtual void addPoints(std::vector<QPointF> const& points) = 0;
+
+    //! Add line entities from starts[i] to ends[i].
+    /*! Extra points in the longer of both vectors are ignored.
+    */
+    virtual void addLineSegments(std::vector<QPointF> const& starts, std::vector<QPointF> const& ends) = 0;
+
+    //! Runs a plugin task without blocking the user interface.
+    /*! Shows a progress dialog while task->run() works in a worker thread,
+    * then calls task->apply() unless the user canceled it.
+    * \param task the task to run, owned by the caller.
+    * \param message an optional QString shown in the progress dialog.
+    * \return true if the task was applied.
+    * \return false if fail, i.e. user cancel.
+    */
+    virtual bool runTask(Plug_Task *task, const QString& message = "") = 0;
+
+    //! Finds the texts, multi line texts and dimensions showing a text.
+    /*! Uses the text index of the drawing instead of reading every entity.
+    * Texts of blocks are returned as the inserts showing them, once per insert.
+    * \param sel a QList of pointers to Plug_Entity handled by plugin.
+    * \param text the text to find, a part of the text shown by the entities.
+    * \param caseSensitive compare the case of letters too.
+    * \return true if any entity was found.
+    */
+    virtual bool findText(QList<Plug_Entity *> *sel, const QString& text, bool caseSensitive = false) = 0;
+
+    //! Zooms the view to an entity, e.g. one found by findText().
+    /*! \param ent the entity to show.
+    */
+    virtual void zoomToEntity(Plug_Entity *ent) = 0;
+
+    //! Sets entities to the data of the arrays.
+    /*! Takes the arrays as filled by getAllEntitiesData() or getSelectData(), with
+    * changed values; the entities are found by their ids. Rows with another type
+    * than the entity, or with unchanged values, are skipped. All entities are
+    * changed in one undo cycle and with a single redraw.
+    * A layer index of -1 keeps the layer of the entity.
+    * \param data the arrays, with the new values.
+    */
+    virtual void updateEntitiesData(Plug_EntityArrays const& data) = 0;
+
+    //! Removes the entities with the given ids, in one undo cycle.
+    /*! \param ids DPI::EID of the entities, unknown ids are skipped.
+    */
+    virtual void removeEntities(std::vector<qulonglong> const& ids) = 0;
 };
 
 
@@ -19,6 +19,7 @@ GENERATED_DIR = ../../generated/librecad
 include(../../common.pri)
 include(./boost.pri)
 include(./muparser.pri)
+include(../../libraries/libdxfrw/compression.pri)
 
 CONFIG += qt \
     warn_on \
@@ -137,6 +138,8 @@ HEADERS += \
     actions/lc_actiondrawstar.h \
     actions/lc_actioninfopickcoordinates.h \
     actions/lc_actioninfoproperties.h \
+    actions/lc_actioninfomemoryusage.h \
+    actions/lc_actioneditfindtext.h \
     actions/lc_actionmodifybreakdivide.h \
     actions/lc_actionmodifyduplicate.h \
     actions/lc_actionmodifylinegap.h \
@@ -156,9 +159,15 @@ HEADERS += \
     lib/actions/rs_preview.h \
     lib/actions/rs_previewactioninterface.h \
     lib/actions/rs_snapper.h \
+    lib/actions/lc_snapengine.h \
+    lib/actions/lc_snappointcache.h \
     lib/creation/rs_creation.h \
+    lib/creation/lc_librarypartcache.h \
     lib/debug/rs_debug.h \
+    lib/debug/lc_tracing.h \
+    lib/debug/lc_actionprofiler.h \
     lib/engine/lc_looputils.h \
+    lib/engine/lc_memoryreport.h \
     lib/engine/lc_parabola.h \
     lib/engine/rs.h \
     lib/engine/rs_arc.h \
@@ -188,6 +197,11 @@ HEADERS += \
     lib/engine/rs_graphic.h \
     lib/engine/rs_hatch.h \
     lib/engine/lc_hyperbola.h \
+    lib/engine/lc_imagecache.h \
+    lib/engine/lc_textindex.h \
+    lib/engine/lc_xrefcache.h \
+    lib/engine/lc_parallel.h \
+    lib/engine/lc_endpointindex.h \
     lib/engine/rs_insert.h \
     lib/engine/rs_image.h \
     lib/engine/rs_layer.h \
@@ -218,12 +232,15 @@ HEADERS += \
     lib/engine/rs_variabledict.h \
     lib/engine/rs_vector.h \
     lib/fileio/rs_fileio.h \
+    lib/fileio/lc_drawingjournal.h \
     lib/filters/rs_filtercxf.h \
     lib/filters/rs_filterdxfrw.h \
     lib/filters/rs_filterdxf1.h \
     lib/filters/rs_filterjww.h \
     lib/filters/rs_filterlff.h \
+    lib/filters/lc_filtersnapshot.h \
     lib/filters/rs_filterinterface.h \
+    lib/gui/lc_tilecache.h \
     lib/gui/rs_commandevent.h \
     lib/gui/rs_coordinateevent.h \
     lib/gui/rs_dialogfactory.h \
@@ -236,9 +253,13 @@ HEADERS += \
     lib/gui/rs_mainwindowinterface.h \
     lib/gui/rs_painter.h \
     lib/gui/rs_painterqt.h \
+    lib/gui/lc_dashsegmenter.h \
+    lib/gui/lc_clipping.h \
     lib/gui/rs_staticgraphicview.h \
     lib/information/rs_locale.h \
     lib/information/rs_information.h \
+    lib/information/lc_intersections.h \
+    lib/information/lc_preparedcontour.h \
     lib/information/rs_infoarea.h \
     lib/math/lc_linemath.h \
     lib/modification/rs_modification.h \
@@ -247,14 +268,30 @@ HEADERS += \
     lib/math/lc_quadratic.h \
     actions/lc_actiondrawcircle2pr.h \
     main/console_dxf2png.h \
+    main/console_benchmark.h \
+    main/console_corpusbench.h \
+    main/console_batchedit.h \
+    main/console_dwg2dxf.h \
+    main/lc_tiffstripwriter.h \
     test/lc_simpletests.h \
     lib/generators/lc_makercamsvg.h \
     lib/generators/lc_xmlwriterinterface.h \
     lib/generators/lc_xmlwriterqxmlstreamwriter.h \
     actions/lc_actionfileexportmakercam.h \
+    lib/engine/lc_blockdrawlist.h \
+    lib/engine/lc_imagepyramid.h \
+    lib/engine/lc_entitypool.h \
+    lib/engine/lc_framearena.h \
+    lib/engine/lc_pentable.h \
     lib/engine/lc_rect.h \
+    lib/engine/lc_spatialindex.h \
     lib/engine/lc_undosection.h \
+    lib/engine/lc_attributeschange.h \
+    lib/engine/lc_transformchange.h \
+    lib/engine/lc_documentsnapshot.h \
+    lib/engine/lc_entityvisitor.h \
     lib/printing/lc_printing.h \
+    lib/printing/lc_pdfwriter.h \
     actions/lc_actiondrawlinepolygon3.h \
     main/lc_application.h \
     ui/generic/lc_flexlayout.h \
@@ -314,6 +351,8 @@ SOURCES += \
     actions/lc_actiondrawstar.cpp \
     actions/lc_actioninfopickcoordinates.cpp \
     actions/lc_actioninfoproperties.cpp \
+    actions/lc_actioninfomemoryusage.cpp \
+    actions/lc_actioneditfindtext.cpp \
     actions/lc_actionmodifybreakdivide.cpp \
     actions/lc_actionmodifyduplicate.cpp \
     actions/lc_actionmodifylinegap.cpp \
@@ -325,9 +364,15 @@ SOURCES += \
     lib/actions/rs_preview.cpp \
     lib/actions/rs_previewactioninterface.cpp \
     lib/actions/rs_snapper.cpp \
+    lib/actions/lc_snapengine.cpp \
+    lib/actions/lc_snappointcache.cpp \
     lib/creation/rs_creation.cpp \
+    lib/creation/lc_librarypartcache.cpp \
     lib/debug/rs_debug.cpp \
+    lib/debug/lc_tracing.cpp \
+    lib/debug/lc_actionprofiler.cpp \
     lib/engine/lc_looputils.cpp \
+    lib/engine/lc_memoryreport.cpp \
     lib/engine/lc_parabola.cpp \
     lib/engine/rs_arc.cpp \
     lib/engine/rs_block.cpp \
@@ -351,6 +396,10 @@ SOURCES += \
     lib/engine/rs_graphic.cpp \
     lib/engine/rs_hatch.cpp \
     lib/engine/lc_hyperbola.cpp \
+    lib/engine/lc_imagecache.cpp \
+    lib/engine/lc_textindex.cpp \
+    lib/engine/lc_xrefcache.cpp \
+    lib/engine/lc_endpointindex.cpp \
     lib/engine/rs_insert.cpp \
     lib/engine/rs_image.cpp \
     lib/engine/rs_layer.cpp \
@@ -377,11 +426,14 @@ SOURCES += \
     lib/engine/rs_variabledict.cpp \
     lib/engine/rs_vector.cpp \
     lib/fileio/rs_fileio.cpp \
+    lib/fileio/lc_drawingjournal.cpp \
     lib/filters/rs_filtercxf.cpp \
     lib/filters/rs_filterdxfrw.cpp \
     lib/filters/rs_filterdxf1.cpp \
     lib/filters/rs_filterjww.cpp \
     lib/filters/rs_filterlff.cpp \
+    lib/filters/lc_filtersnapshot.cpp \
+    lib/gui/lc_tilecache.cpp \
     lib/gui/rs_dialogfactory.cpp \
     lib/gui/rs_eventhandler.cpp \
     lib/gui/rs_graphicview.cpp \
@@ -389,9 +441,13 @@ SOURCES += \
     lib/gui/rs_linetypepattern.cpp \
     lib/gui/rs_painter.cpp \
     lib/gui/rs_painterqt.cpp \
+    lib/gui/lc_dashsegmenter.cpp \
+    lib/gui/lc_clipping.cpp \
     lib/gui/rs_staticgraphicview.cpp \
     lib/information/rs_locale.cpp \
     lib/information/rs_information.cpp \
+    lib/information/lc_intersections.cpp \
+    lib/information/lc_preparedcontour.cpp \
     lib/information/rs_infoarea.cpp \
     lib/math/lc_linemath.cpp \
     lib/math/rs_math.cpp \
@@ -402,6 +458,11 @@ SOURCES += \
     lib/engine/rs_pen.cpp \
     actions/lc_actiondrawcircle2pr.cpp \
     main/console_dxf2png.cpp \
+    main/console_benchmark.cpp \
+    main/console_corpusbench.cpp \
+    main/console_batchedit.cpp \
+    main/console_dwg2dxf.cpp \
+    main/lc_tiffstripwriter.cpp \
     test/lc_simpletests.cpp \
     lib/generators/lc_xmlwriterqxmlstreamwriter.cpp \
     lib/generators/lc_makercamsvg.cpp \
@@ -409,10 +470,20 @@ SOURCES += \
     lib/engine/rs_atomicentity.cpp \
     lib/engine/rs_undocycle.cpp \
     lib/engine/rs_flags.cpp \
+    lib/engine/lc_blockdrawlist.cpp \
+    lib/engine/lc_imagepyramid.cpp \
+    lib/engine/lc_entitypool.cpp \
+    lib/engine/lc_framearena.cpp \
+    lib/engine/lc_pentable.cpp \
     lib/engine/lc_rect.cpp \
+    lib/engine/lc_spatialindex.cpp \
     lib/engine/lc_undosection.cpp \
+    lib/engine/lc_attributeschange.cpp \
+    lib/engine/lc_transformchange.cpp \
+    lib/engine/lc_documentsnapshot.cpp \
     lib/engine/rs.cpp \
     lib/printing/lc_printing.cpp \
+    lib/printing/lc_pdfwriter.cpp \
     actions/lc_actiondrawlinepolygon3.cpp \
     main/lc_application.cpp \
     ui/forms/LC_DlgParabola.cpp \
@@ -757,6 +828,7 @@ HEADERS += ui/lc_actionfactory.h \
     ui/qg_layerbox.h \
     ui/qg_layerwidget.h \
     ui/qg_librarywidget.h \
+    ui/lc_thumbnailservice.h \
     ui/qg_linetypebox.h \
     ui/qg_mainwindowinterface.h \
     ui/qg_patternbox.h \
@@ -836,6 +908,8 @@ HEADERS += ui/lc_actionfactory.h \
     ui/qg_commandhistory.h \
     ui/lc_dockwidget.h \
     ui/forms/lc_dlgsplinepoints.h \
+    ui/forms/lc_dlgmemoryreport.h \
+    ui/forms/lc_dlgfindtext.h \
     ui/forms/lc_widgetoptionsdialog.h \
     ui/forms/qg_snaptoolbar.h \
     ui/forms/qg_activelayername.h \
@@ -863,6 +937,7 @@ SOURCES += ui/lc_actionfactory.cpp \
     ui/qg_layerbox.cpp \
     ui/qg_layerwidget.cpp \
     ui/qg_librarywidget.cpp \
+    ui/lc_thumbnailservice.cpp \
     ui/qg_linetypebox.cpp \
     ui/qg_patternbox.cpp \
     ui/qg_pentoolbar.cpp \
@@ -940,6 +1015,8 @@ SOURCES += ui/lc_actionfactory.cpp \
     ui/qg_commandhistory.cpp \
     ui/lc_dockwidget.cpp \
     ui/forms/lc_dlgsplinepoints.cpp \
+    ui/forms/lc_dlgmemoryreport.cpp \
+    ui/forms/lc_dlgfindtext.cpp \
     ui/forms/lc_widgetoptionsdialog.cpp \
     ui/forms/qg_snaptoolbar.cpp \
     ui/forms/qg_activelayername.cpp \
@@ -1041,6 +1118,8 @@ FORMS = ui/forms/qg_commandwidget.ui \
     ui/forms/qg_snaptoolbar.ui \
     ui/forms/qg_activelayername.ui \
     ui/forms/lc_dlgsplinepoints.ui \
+    ui/forms/lc_dlgmemoryreport.ui \
+    ui/forms/lc_dlgfindtext.ui \
     ui/forms/lc_widgetoptionsdialog.ui \
     ui/lc_deviceoptions.ui \
     ui/generic/comboboxoption.ui \
@@ -1059,6 +1138,7 @@ HEADERS += \
     main/qc_applicationwindow.h \
     main/qc_dialogfactory.h \
     main/qc_mdiwindow.h \
+    main/lc_documentloader.h \
     main/doc_plugin_interface.h \
     plugins/document_interface.h \
     plugins/qc_plugininterface.h \
@@ -1074,6 +1154,7 @@ SOURCES += \
     main/qc_applicationwindow.cpp \
     main/qc_dialogfactory.cpp \
     main/qc_mdiwindow.cpp \
+    main/lc_documentloader.cpp \
     main/doc_plugin_interface.cpp \
     plugins/intern/qc_actiongetpoint.cpp \
     plugins/intern/qc_actiongetselect.cpp \
@@ -0,0 +1,141 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+
+#include <QApplication>
+#include <QPushButton>
+
+#include "lc_dlgfindtext.h"
+#include "lc_memoryreport.h"
+#include "rs_block.h"
+#include "rs_graphic.h"
+#include "rs_graphicview.h"
+#include "rs_layer.h"
+#include "ui_lc_dlgfindtext.h"
+
+LC_DlgFindText::LC_DlgFindText(QWidget* parent)
+    : QDialog(parent)
+    , ui(std::make_unique<Ui::DlgFindText>())
+{
+    ui->setupUi(this);
+
+    m_find = ui->buttonBox->addButton(tr("&Find"), QDialogButtonBox::ActionRole);
+    m_zoom = ui->buttonBox->addButton(tr("&Zoom"), QDialogButtonBox::ActionRole);
+    m_replace = ui->buttonBox->addButton(tr("&Replace All"), QDialogButtonBox::AcceptRole);
+    m_find->setDefault(true);
+    ui->twResults->setHeaderLabels({tr("Text"), tr("Type"), tr("Place"), tr("Layer")});
+
+    connect(m_find, &QPushButton::clicked, this, &LC_DlgFindText::find);
+    connect(m_zoom, &QPushButton::clicked, this, &LC_DlgFindText::zoomToCurrent);
+    connect(m_replace, &QPushButton::clicked, this, &QDialog::accept);
+    connect(ui->twResults, &QTreeWidget::itemDoubleClicked, this, &LC_DlgFindText::zoomToCurrent);
+    connect(ui->twResults, &QTreeWidget::currentItemChanged, this, &LC_DlgFindText::updateButtons);
+    connect(ui->leFind, &QLineEdit::textChanged, this, &LC_DlgFindText::updateButtons);
+    updateButtons();
+}
+
+LC_DlgFindText::~LC_DlgFindText() = default;
+
+void LC_DlgFindText::languageChange()
+{
+    ui->retranslateUi(this);
+}
+
+void LC_DlgFindText::setGraphic(RS_Graphic& graphic, RS_GraphicView& view)
+{
+    m_graphic = &graphic;
+    m_view = &view;
+}
+
+void LC_DlgFindText::setData(const LC_FindTextData& data)
+{
+    ui->leFind->setText(data.text);
+    ui->leReplace->setText(data.replacement);
+    ui->cbCaseSensitive->setChecked(data.cs == Qt::CaseSensitive);
+    ui->leFind->selectAll();
+}
+
+LC_FindTextData LC_DlgFindText::getData() const
+{
+    return {ui->leFind->text(), ui->leReplace->text(),
+            ui->cbCaseSensitive->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive};
+}
+
+void LC_DlgFindText::find()
+{
+    ui->twResults->clear();
+    m_matches.clear();
+    if (m_graphic == nullptr || ui->leFind->text().isEmpty())
+        return;
+
+    const LC_FindTextData data = getData();
+    // indexing the words of the drawing on the first search takes a moment
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_matches = m_graphic->findText(data.text, data.cs);
+    QApplication::restoreOverrideCursor();
+
+    for (size_t i = 0; i < m_matches.size(); ++i) {
+        const LC_TextIndex::Match& match = m_matches[i];
+        auto* item = new QTreeWidgetItem(ui->twResults);
+        item->setText(0, LC_TextIndex::getText(match.entity).simplified());
+        item->setText(1, LC_MemoryReport::typeName(match.entity->rtti()));
+        if (match.block == nullptr)
+            item->setText(2, tr("Drawing"));
+        else
+            item->setText(2, tr("Block %1, inserted %n time(s)", "", int(match.inserts.size()))
+                          .arg(match.block->getName()));
+        RS_Layer* layer = match.entity->getLayer();
+        item->setText(3, layer != nullptr ? layer->getName() : QString{});
+        item->setData(0, Qt::UserRole, qulonglong(i));
+    }
+    for (int i = 0; i < ui->twResults->columnCount(); ++i)
+        ui->twResults->resizeColumnToContents(i);
+    ui->lCount->setText(tr("Texts found: %1").arg(m_matches.size()));
+    if (!m_matches.empty())
+        ui->twResults->setCurrentItem(ui->twResults->topLevelItem(0));
+    updateButtons();
+}
+
+void LC_DlgFindText::zoomToCurrent()
+{
+    QTreeWidgetItem* item = ui->twResults->currentItem();
+    if (item == nullptr || m_view == nullptr)
+        return;
+    const size_t i = item->data(0, Qt::UserRole).toULongLong();
+    RS_Vector min, max;
+    if (i >= m_matches.size() || !m_matches[i].getBorders(min, max))
+        return;
+    // the text with some of its surroundings
+    const RS_Vector margin = RS_Vector{1., 1.} * std::max((max - min).magnitude(), 1.);
+    m_view->zoomWindow(min - margin, max + margin);
+    m_view->redraw();
+}
+
+void LC_DlgFindText::updateButtons()
+{
+    const bool searchable = !ui->leFind->text().isEmpty();
+    m_find->setEnabled(searchable);
+    m_replace->setEnabled(searchable);
+    m_zoom->setEnabled(ui->twResults->currentItem() != nullptr);
+}
@@ -0,0 +1,76 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_DLGFINDTEXT_H
+#define LC_DLGFINDTEXT_H
+
+#include <memory>
+#include <vector>
+
+#include <QDialog>
+
+#include "lc_textindex.h"
+
+class QPushButton;
+class QTreeWidgetItem;
+class RS_Graphic;
+class RS_GraphicView;
+
+namespace Ui {
+class DlgFindText;
+}
+
+/**
+ * Finds the texts, multi line texts and dimension labels of a drawing and
+ * its blocks, and zooms to the one chosen. Accepted to replace the text
+ * found in all of them.
+ */
+class LC_DlgFindText : public QDialog
+{
+    Q_OBJECT
+public:
+    LC_DlgFindText(QWidget* parent = nullptr);
+    ~LC_DlgFindText() override;
+
+    void setGraphic(RS_Graphic& graphic, RS_GraphicView& view);
+    void setData(const LC_FindTextData& data);
+    LC_FindTextData getData() const;
+
+protected slots:
+    virtual void languageChange();
+
+private:
+    void find();
+    void zoomToCurrent();
+    void updateButtons();
+
+    RS_Graphic* m_graphic = nullptr;
+    RS_GraphicView* m_view = nullptr;
+    std::vector<LC_TextIndex::Match> m_matches;
+    QPushButton* m_find = nullptr;
+    QPushButton* m_zoom = nullptr;
+    QPushButton* m_replace = nullptr;
+    std::unique_ptr<Ui::DlgFindText> ui;
+};
+
+#endif // LC_DLGFINDTEXT_H
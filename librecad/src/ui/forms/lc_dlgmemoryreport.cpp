@@ -0,0 +1,153 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+
+#include <QApplication>
+#include <QClipboard>
+#include <QLocale>
+#include <QPushButton>
+
+#include "lc_dlgmemoryreport.h"
+#include "lc_memoryreport.h"
+#include "ui_lc_dlgmemoryreport.h"
+
+namespace {
+
+// items sorted by their numbers, not their text
+class NumericItem : public QTreeWidgetItem {
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+    bool operator < (const QTreeWidgetItem& other) const override {
+        const int column = treeWidget()->sortColumn();
+        if (column == 0)
+            return QTreeWidgetItem::operator < (other);
+        return data(column, Qt::UserRole).toULongLong() < other.data(column, Qt::UserRole).toULongLong();
+    }
+};
+
+QString formatKiB(size_t bytes)
+{
+    return QLocale().toString(bytes / 1024., 'f', 1);
+}
+
+void setColumns(QTreeWidget* tree, const QStringList& headers)
+{
+    tree->clear();
+    tree->setColumnCount(headers.size());
+    tree->setHeaderLabels(headers);
+}
+
+// a row of a name, a count and sizes in KiB
+void addRow(QTreeWidget* tree, const QString& name, size_t count, std::initializer_list<size_t> bytes)
+{
+    auto* item = new NumericItem(tree);
+    item->setText(0, name);
+    item->setText(1, QLocale().toString(qulonglong(count)));
+    item->setData(1, Qt::UserRole, qulonglong(count));
+    item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+    int column = 2;
+    for (size_t b: bytes) {
+        item->setText(column, formatKiB(b));
+        item->setData(column, Qt::UserRole, qulonglong(b));
+        item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        ++column;
+    }
+}
+
+void finishTable(QTreeWidget* tree)
+{
+    // the largest first
+    tree->sortByColumn(2, Qt::DescendingOrder);
+    for (int i = 0; i < tree->columnCount(); ++i)
+        tree->resizeColumnToContents(i);
+}
+}
+
+LC_DlgMemoryReport::LC_DlgMemoryReport(QWidget* parent)
+    : QDialog(parent)
+    , ui(std::make_unique<Ui::DlgMemoryReport>())
+{
+    ui->setupUi(this);
+
+    QPushButton* copy = ui->buttonBox->addButton(tr("&Copy"), QDialogButtonBox::ActionRole);
+    connect(copy, &QPushButton::clicked, this, &LC_DlgMemoryReport::copyReport);
+}
+
+LC_DlgMemoryReport::~LC_DlgMemoryReport() = default;
+
+void LC_DlgMemoryReport::languageChange()
+{
+    ui->retranslateUi(this);
+}
+
+void LC_DlgMemoryReport::setReport(const LC_MemoryReport& report)
+{
+    m_text = report.toText();
+    ui->lTotal->setText(tr("Approximate memory used by the drawing: %1 KiB")
+                        .arg(formatKiB(report.totalBytes())));
+
+    using Usage = LC_MemoryReport::Usage;
+    setColumns(ui->twSummary, {tr("Part"), tr("Entities"), tr("KiB")});
+    addRow(ui->twSummary, tr("Model space"), report.modelSpace().count, {report.modelSpace().bytes});
+    addRow(ui->twSummary, tr("Block definitions"), report.blockDefinitions().count,
+           {report.blockDefinitions().bytes});
+    addRow(ui->twSummary, tr("Undone entities"), report.undoneEntities().count,
+           {report.undoneEntities().bytes});
+    addRow(ui->twSummary, tr("Undo cycles"), report.undoCycles().count, {report.undoCycles().bytes});
+    addRow(ui->twSummary, tr("Image cache, all drawings"), 0, {report.imageCacheBytes()});
+    finishTable(ui->twSummary);
+
+    // the top level entities of each type, with the children they hold
+    setColumns(ui->twTypes, {tr("Type"), tr("Count"), tr("KiB"), tr("Top level count"),
+                             tr("KiB with children")});
+    for (const auto& [type, usage]: report.types()) {
+        const auto it = report.topLevelTypes().find(type);
+        const Usage topLevel = it != report.topLevelTypes().cend() ? it->second : Usage{};
+        auto* item = new NumericItem(ui->twTypes);
+        item->setText(0, LC_MemoryReport::typeName(type));
+        const size_t values[] = {usage.count, usage.bytes, topLevel.count, topLevel.bytes};
+        for (int i = 0; i < 4; ++i) {
+            const bool bytes = i % 2 == 1;
+            item->setText(i + 1, bytes ? formatKiB(values[i]) : QLocale().toString(qulonglong(values[i])));
+            item->setData(i + 1, Qt::UserRole, qulonglong(values[i]));
+            item->setTextAlignment(i + 1, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+    finishTable(ui->twTypes);
+
+    setColumns(ui->twLayers, {tr("Layer"), tr("Entities"), tr("KiB")});
+    for (const auto& [name, usage]: report.layers())
+        addRow(ui->twLayers, name, usage.count, {usage.bytes});
+    finishTable(ui->twLayers);
+
+    setColumns(ui->twBlocks, {tr("Block"), tr("Entities"), tr("KiB")});
+    for (const auto& [name, usage]: report.blocks())
+        addRow(ui->twBlocks, name, usage.count, {usage.bytes});
+    finishTable(ui->twBlocks);
+}
+
+void LC_DlgMemoryReport::copyReport()
+{
+    QApplication::clipboard()->setText(m_text);
+}
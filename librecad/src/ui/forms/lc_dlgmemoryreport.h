@@ -0,0 +1,62 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_DLGMEMORYREPORT_H
+#define LC_DLGMEMORYREPORT_H
+
+#include <memory>
+
+#include <QDialog>
+
+class LC_MemoryReport;
+class QTreeWidget;
+
+namespace Ui {
+class DlgMemoryReport;
+}
+
+/**
+ * Shows the approximate memory used by a drawing, by entity type, layer
+ * and block, and by the undo history.
+ */
+class LC_DlgMemoryReport : public QDialog
+{
+    Q_OBJECT
+public:
+    LC_DlgMemoryReport(QWidget* parent = nullptr);
+    ~LC_DlgMemoryReport() override;
+
+    void setReport(const LC_MemoryReport& report);
+
+protected slots:
+    virtual void languageChange();
+
+private:
+    void copyReport();
+
+    // the report as text, for the clipboard
+    QString m_text;
+    std::unique_ptr<Ui::DlgMemoryReport> ui;
+};
+
+#endif // LC_DLGMEMORYREPORT_H
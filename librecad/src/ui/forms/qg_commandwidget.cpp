@@ -62,6 +62,8 @@ QG_CommandWidget::QG_CommandWidget(QWidget* parent, const char* name, Qt::Window
     connect(leCommand, SIGNAL(clearCommandsHistory()), teHistory, SLOT(clear()));
     connect(leCommand, SIGNAL(message(QString)), this, SLOT(appendHistory(QString)));
     connect(leCommand, &QG_CommandEdit::keycode, this, &QG_CommandWidget::handleKeycode);
+    connect(leCommand, &QG_CommandEdit::scriptStarted, this, &QG_CommandWidget::startScript);
+    connect(leCommand, &QG_CommandEdit::scriptFinished, this, &QG_CommandWidget::finishScript);
 
     auto a1 = new QAction(QObject::tr("Keycode mode"), this);
     a1->setObjectName("keycode_action");
@@ -84,6 +86,11 @@ QG_CommandWidget::QG_CommandWidget(QWidget* parent, const char* name, Qt::Window
     connect(a3, &QAction::triggered, leCommand, &QG_CommandEdit::modifiedPaste);
     options_button->addAction(a3);
 
+    m_scriptUndo = new QAction(QObject::tr("Undo multiple commands at once"), this);
+    m_scriptUndo->setCheckable(true);
+    m_scriptUndo->setChecked(settings.value("Widgets/ScriptSingleUndo", false).toBool());
+    options_button->addAction(m_scriptUndo);
+
     options_button->setStyleSheet("QToolButton::menu-indicator { image: none; }");
 
     // For convenience of re-docking a floating command widget. Without this button,
@@ -104,6 +111,7 @@ QG_CommandWidget::~QG_CommandWidget()
     QSettings settings;
     auto action = findChild<QAction*>("keycode_action");
     settings.setValue("Widgets/KeycodeMode", action->isChecked());
+    settings.setValue("Widgets/ScriptSingleUndo", m_scriptUndo->isChecked());
 }
 
 /*
@@ -319,6 +327,28 @@ void QG_CommandWidget::chooseCommandFile()
     }
 }
 
+/**
+ * Commands of a command file or of multiple pasted commands are run as one
+ * script: the drawing is redrawn once at the end.
+ */
+void QG_CommandWidget::startScript()
+{
+    // a command file may contain multiple commands per line
+    if (scriptDepth++ > 0 || actionHandler == nullptr)
+        return;
+    scriptHandler = actionHandler;
+    scriptHandler->beginScript(m_scriptUndo->isChecked());
+}
+
+void QG_CommandWidget::finishScript()
+{
+    if (scriptDepth == 0 || --scriptDepth > 0)
+        return;
+    if (scriptHandler != nullptr)
+        scriptHandler->endScript();
+    scriptHandler = nullptr;
+}
+
 void QG_CommandWidget::handleKeycode(QString code)
 {
     if (actionHandler->keycode(code))
@@ -66,9 +66,15 @@ protected slots:
 
 private slots:
     virtual void dockingButtonTriggered(bool);
+    void startScript();
+    void finishScript();
 
 private:
     QG_ActionHandler* actionHandler = nullptr;
+    // handler running the current command script
+    QG_ActionHandler* scriptHandler = nullptr;
+    int scriptDepth = 0;
+    QAction* m_scriptUndo = nullptr;
     QAction* m_docking = nullptr;
 
 };
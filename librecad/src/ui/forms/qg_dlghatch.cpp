@@ -163,7 +163,6 @@ void QG_DlgHatch::updatePreview() {
     double angle = RS_Math::deg2rad(RS_Math::eval(leAngle->text(), 0.0));
 	double prevSize = 100.0;
     if (pattern) {
-        pattern->calculateBorders();
 		prevSize = std::max(prevSize, pattern->getSize().magnitude());
 	}
 
@@ -1201,6 +1201,14 @@ void LC_ActionFactory::fillActionContainer(QMap<QString, QAction*>& a_map, LC_Ac
     a_map["OptionsDrawing"] = action;
     connect( main_window, &QC_ApplicationWindow::windowsChanged, action, &QAction::setEnabled);
 
+    action = new QAction(tr("&Memory Usage"), agm->info);
+    action->setToolTip(tr("Memory used by the drawing, by entity type, layer and block"));
+    connect(action, SIGNAL(triggered()),
+    action_handler, SLOT(slotInfoMemoryUsage()));
+    action->setObjectName("InfoMemoryUsage");
+    a_map["InfoMemoryUsage"] = action;
+    connect( main_window, &QC_ApplicationWindow::windowsChanged, action, &QAction::setEnabled);
+
     action = new QAction(tr("Widget Options"), agm->options);
     action->setObjectName("WidgetOptions");
     a_map["WidgetOptions"] = action;
@@ -1497,6 +1505,13 @@ void LC_ActionFactory::commonActions(QMap<QString, QAction*>& a_map, LC_ActionGr
     action->setObjectName("EditPaste");
     a_map["EditPaste"] = action;
 
+    action = new QAction(tr("&Find and Replace Text..."), agm->edit);
+    action->setToolTip(tr("Find texts and dimension labels, also in blocks, and replace them"));
+    connect(action, SIGNAL(triggered()),
+    action_handler, SLOT(slotEditFindText()));
+    action->setObjectName("EditFindText");
+    a_map["EditFindText"] = action;
+
     // <[~ Zoom ~]>
 
     action = new QAction(tr("Zoom &In"), agm->view);
@@ -45,6 +45,7 @@ QStringList filtersStringList = {
     "Drawing Exchange DXF 2000 (*.dxf)",
     "Drawing Exchange DXF R14 (*.dxf)",
     "Drawing Exchange DXF R12 (*.dxf)",
+    "Drawing Exchange DXF 2007 Binary (*.dxf)",
 
     #ifdef DWGSUPPORT
     "DWG Drawing (*.dwg)",
@@ -66,6 +67,7 @@ QList<RS2::FormatType> filtersTypeList =
     RS2::FormatDXFRW2000,
     RS2::FormatDXFRW14,
     RS2::FormatDXFRW12,
+    RS2::FormatDXFRWBinary,
 
     #ifdef DWGSUPPORT
     RS2::FormatDWG,
@@ -23,6 +23,7 @@
 **********************************************************************/
 
 #include <QColor>
+#include <QSet>
 
 #include "lc_layertreemodel.h"
 #include "rs_debug.h"
@@ -173,6 +174,39 @@ void LC_LayerTreeModel::setLayerList(RS_LayerList* ll) {
 
     emitDataChanged();
 }
+/**
+ * Updates the items of layers with changed attributes, and the flags of the
+ * virtual layers above them, without rebuilding the model.
+ * @param layers changed layers
+ */
+void LC_LayerTreeModel::updateLayers(const QList<RS_Layer*> &layers){
+    // flags of virtual layers are calculated from their children
+    rootItem->updateCalculatedFlagsForDescendentVirtualLayers();
+
+    QSet<RS_Layer*> changedLayers(layers.cbegin(), layers.cend());
+    // virtual layers have no layer of their own
+    changedLayers.remove(nullptr);
+    QList<LC_LayerTreeItem*> items;
+    LC_LayerTreeItemAcceptor acceptAll;
+    rootItem->collectDescendantChildren(items, &acceptAll, false);
+
+    const int lastColumn = columnCount(QModelIndex()) - 1;
+    QSet<LC_LayerTreeItem*> updatedItems;
+    for (LC_LayerTreeItem* item: items) {
+        if (!changedLayers.contains(item->getLayer())){
+            continue;
+        }
+        for (LC_LayerTreeItem* i = item; i != nullptr && i != rootItem; i = i->parent()) {
+            if (updatedItems.contains(i)){
+                break;
+            }
+            updatedItems.insert(i);
+            const int row = i->row();
+            emit dataChanged(createIndex(row, 0, i), createIndex(row, lastColumn, i));
+        }
+    }
+}
+
 /**
  * utility method to force reset view indexes - avoiding of "collapseSecondary" flickering
  * @brief LC_LayerTreeModel::reset
@@ -57,6 +57,7 @@ public:
     QModelIndex parent(const QModelIndex &index) const override;
     QModelIndex index(int row, int column, const QModelIndex &parent) const override;
     void setLayerList(RS_LayerList *ll);
+    void updateLayers(const QList<RS_Layer *> &layers);
     void proceedActiveLayerChanged(RS_LayerList *ll);
     QList<RS_Layer *> collectLayers(LC_LayerTreeItemAcceptor *acceptor);
     QModelIndexList getPersistentIndexList();
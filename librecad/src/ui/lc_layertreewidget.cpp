@@ -1029,21 +1029,40 @@ void LC_LayerTreeWidget::layerRemoved(RS_Layer *){
     activateLayer(layerList->at(0));
 }
 
-void LC_LayerTreeWidget::layerToggled(RS_Layer *){
+void LC_LayerTreeWidget::layerToggled(RS_Layer *layer){
     RS_DEBUG->print("LC_LayerTreeWidget::layerToggled()");
-    update();
+    updateLayer(layer);
 }
 
-void LC_LayerTreeWidget::layerToggledLock(RS_Layer *){
-    update();
+void LC_LayerTreeWidget::layerToggledLock(RS_Layer *layer){
+    updateLayer(layer);
 }
 
-void LC_LayerTreeWidget::layerToggledPrint(RS_Layer *){
-    update();
+void LC_LayerTreeWidget::layerToggledPrint(RS_Layer *layer){
+    updateLayer(layer);
 }
 
-void LC_LayerTreeWidget::layerToggledConstruction(RS_Layer *){
-    update();
+void LC_LayerTreeWidget::layerToggledConstruction(RS_Layer *layer){
+    updateLayer(layer);
+}
+
+void LC_LayerTreeWidget::layersToggled(const QList<RS_Layer *> &layers){
+    RS_DEBUG->print("LC_LayerTreeWidget::layersToggled()");
+    if (layerList != nullptr){
+        layerTreeModel->updateLayers(layers);
+    }
+}
+
+/**
+ * Toggled attributes of a layer don't change the tree, only the items of the
+ * layer and its parents are updated. All items are rebuilt for nullptr.
+ */
+void LC_LayerTreeWidget::updateLayer(RS_Layer *layer){
+    if (layer == nullptr || layerList == nullptr){
+        update();
+    } else {
+        layerTreeModel->updateLayers({layer});
+    }
 }
 // --------- Drag & Drop support ---
 /**
@@ -1440,8 +1459,8 @@ void LC_LayerTreeWidget::deselectEntitiesOnLockedLayer(RS_Layer *layer){
     if (!layer) return;
     if (!layer->isLocked()) return;
 
-    for (auto e: *document) {
-        if (e && e->isVisible() && e->getLayer() == layer){
+    for (auto e: document->getLayerEntities(layer)) {
+        if (e->isVisible()){
             if (view){
                 view->deleteEntity(e);
             }
@@ -1459,8 +1478,8 @@ void LC_LayerTreeWidget::deselectEntitiesOnLockedLayer(RS_Layer *layer){
 void LC_LayerTreeWidget::deselectEntities(RS_Layer *layer){
     if (!layer) return;
 
-    for (auto e: *document) {
-        if (e && e->isVisible() && e->getLayer() == layer){
+    for (auto e: document->getLayerEntities(layer)) {
+        if (e->isVisible()){
             if (view){
                 view->deleteEntity(e);
             }
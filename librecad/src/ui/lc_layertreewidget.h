@@ -69,6 +69,7 @@ public:
     void layerToggledLock(RS_Layer *) override;
     void layerToggledPrint(RS_Layer *) override;
     void layerToggledConstruction(RS_Layer *) override;
+    void layersToggled(const QList<RS_Layer *> &layers) override;
     void onDragEnterEvent(QModelIndex dropIndex);
     void onDropEvent(QModelIndex dropIndex, DropIndicatorPosition position);
     void set_view(RS_GraphicView *gview){view = gview;}
@@ -125,6 +126,8 @@ protected:
     void duplicateSelectionToLayer();
 
 private:
+    void updateLayer(RS_Layer *layer);
+
     RS_LayerList *layerList = nullptr;
     QLineEdit *matchLayerName = nullptr;
     QCheckBox *matchModeCheckBox = nullptr;
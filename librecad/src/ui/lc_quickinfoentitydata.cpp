@@ -41,12 +41,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "lc_peninforegistry.h"
 #include "lc_quickinfoentitydata.h"
 
+#include <algorithm>
+
 #include <rs_units.h>
 
 LC_QuickInfoEntityData::LC_QuickInfoEntityData():LC_QuickInfoBaseData(){}
 
 LC_QuickInfoEntityData::~LC_QuickInfoEntityData(){
     clear();
+    clearCache();
 }
 
 /**
@@ -72,7 +75,10 @@ bool LC_QuickInfoEntityData::processEntity(RS_Entity *en){
         shouldUpdate = true;
     }
     if (shouldUpdate){
-        clear();
+        releaseEntity();
+        if (restoreCached(en->getId())){
+            return true;
+        }
 
         // collecting some generic common properties of all entities
         collectGenericProperties(en);
@@ -1015,6 +1021,72 @@ void LC_QuickInfoEntityData::clear(){
     entityName = "";
 }
 
+/**
+ * Stops showing the current entity, keeping its properties in the cache, so
+ * they are restored without collecting them again if the entity is processed
+ * again later
+ */
+void LC_QuickInfoEntityData::releaseEntity(){
+    if (entityId == 0){
+        return;
+    }
+    CachedEntity entry;
+    entry.entityId = entityId;
+    entry.coordinatesMode = coordinatesMode;
+    if (graphicView != nullptr){
+        entry.relativeZero = graphicView->getRelativeZero();
+    }
+    entry.entityName = entityName;
+    entry.properties.swap(properties);
+    cache.push_front(std::move(entry));
+    if (cache.size() > maxCachedEntities){
+        qDeleteAll(cache.back().properties);
+        cache.pop_back();
+    }
+    entityId = 0;
+    entityName = "";
+}
+
+/**
+ * Restores properties of given entity from the cache
+ * @param id entity id
+ * @return true if properties were restored
+ */
+bool LC_QuickInfoEntityData::restoreCached(unsigned long id){
+    auto it = std::find_if(cache.begin(), cache.end(), [id](const CachedEntity& entry){
+        return entry.entityId == id;
+    });
+    if (it == cache.end()){
+        return false;
+    }
+    // formatted coordinates depend on mode and relative zero
+    bool upToDate = it->coordinatesMode == coordinatesMode;
+    if (upToDate && coordinatesMode == COORD_RELATIVE && graphicView != nullptr){
+        upToDate = it->relativeZero == graphicView->getRelativeZero();
+    }
+    if (upToDate){
+        clear();
+        entityId = it->entityId;
+        entityName = it->entityName;
+        properties.swap(it->properties);
+    }
+    else{
+        qDeleteAll(it->properties);
+    }
+    cache.erase(it);
+    return upToDate;
+}
+
+/**
+ * Removes all cached properties, e.g. after formatting options were changed
+ */
+void LC_QuickInfoEntityData::clearCache(){
+    for (CachedEntity& entry: cache){
+        qDeleteAll(entry.properties);
+    }
+    cache.clear();
+}
+
 /**
  * Formatting double value
  * @param x
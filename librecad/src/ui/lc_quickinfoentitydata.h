@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef LC_QUICKINFOENTITYDATA_H
 #define LC_QUICKINFOENTITYDATA_H
 
+#include <list>
+
 #include <QString>
 #include <QCoreApplication>
 #include "rs_vector.h"
@@ -101,6 +103,8 @@ public:
     bool updateForCoordinateViewMode(int mode) override;
     bool processEntity(RS_Entity *en);
     void clear() override;
+    void releaseEntity();
+    void clearCache();
     bool hasData() const override;
     void setOptions(LC_QuickInfoOptions *opt);
 protected:
@@ -117,6 +121,25 @@ protected:
      */
     QVector<PropertyInfo*> properties;
 
+    /**
+     * Properties of an entity shown recently
+     */
+    struct CachedEntity{
+        unsigned long entityId = 0;
+        int coordinatesMode = COORD_ABSOLUTE;
+        RS_Vector relativeZero{false};
+        QString entityName;
+        QVector<PropertyInfo*> properties;
+    };
+
+    /**
+     * Recently shown entities, most recent first. Modifications of an entity
+     * replace it by a clone with a new id, so the id identifies also the
+     * state of the entity.
+     */
+    std::list<CachedEntity> cache;
+    static constexpr size_t maxCachedEntities = 32;
+
     /**
      * Options
      */
@@ -127,6 +150,7 @@ protected:
      */
     LC_PenInfoRegistry* penRegistry = LC_PenInfoRegistry::instance();
 
+    bool restoreCached(unsigned long id);
     void addProperty(const char* name, const QString &valueStr, PropertyType type);
     void collectLineProperties(RS_Line* line);
     void collectCircleProperties(RS_Circle *circle);
@@ -107,6 +107,14 @@ LC_QuickInfoWidget::LC_QuickInfoWidget(QWidget *parent, QMap<QString, QAction *>
     pointsData.setCoordinatesMode(RS_SETTINGS->readNumEntry("/PointsCoordinatesMode", LC_QuickInfoBaseData::COORD_ABSOLUTE));
     RS_SETTINGS->endGroup();
 
+    entityViewTimer.setSingleShot(true);
+    entityViewTimer.setInterval(entityViewDelay);
+    connect(&entityViewTimer, &QTimer::timeout, this, [this](){
+        if (widgetMode == MODE_ENTITY_INFO){
+            updateEntityInfoView();
+        }
+    });
+
     // initial message
     showNoDataMessage();
 }
@@ -122,14 +130,22 @@ LC_QuickInfoWidget::~LC_QuickInfoWidget(){
  * @param en entity
  */
 void LC_QuickInfoWidget::processEntity(RS_Entity *en){
-    setWidgetMode(MODE_ENTITY_INFO);
+    if (widgetMode != MODE_ENTITY_INFO){
+        setWidgetMode(MODE_ENTITY_INFO);
+    }
     if (en == nullptr){
-        clearEntityInfo();
+        // keep the properties, the mouse may return to the entity soon
+        if (entityData.hasData()){
+            entityData.releaseEntity();
+            entityViewTimer.start();
+        }
     }
     else { // just delegate action processing to entity data
         bool updated = entityData.processEntity(en);
         if (updated){
-            updateEntityInfoView();
+            // hovering over dense drawings changes the entity on each mouse move,
+            // so the view is generated only once the entity stays the same for a moment
+            entityViewTimer.start();
         }
     }
  }
@@ -170,6 +186,7 @@ void LC_QuickInfoWidget::setCollectedPointsCoordinateViewMode(int mode){
  * Cleanup of collected entity information
  */
 void LC_QuickInfoWidget::clearEntityInfo(){
+    entityViewTimer.stop();
     entityData.clear();
     showNoDataMessage();
 }
@@ -187,6 +204,8 @@ void LC_QuickInfoWidget::updateCollectedPointsView(bool forceUpdate){
 
 void LC_QuickInfoWidget::updateEntityInfoView(bool forceUpdate, bool updateView){
     if (forceUpdate){
+        // cached properties may be formatted by outdated options
+        entityData.clearCache();
         if (entityData.hasData()){
             unsigned long entityId = entityData.getEntityId();
             RS_Entity *entity = findEntityById(entityId);
@@ -197,6 +216,7 @@ void LC_QuickInfoWidget::updateEntityInfoView(bool forceUpdate, bool updateView)
         }
     }
     if (updateView){
+        entityViewTimer.stop();
         if (entityData.hasData()){
             QString data = entityData.generateView();
             ui->pteInfo->setHtml(data);
@@ -632,16 +652,9 @@ void LC_QuickInfoWidget::onSelectEntity(){
  * @return
  */
 RS_Entity* LC_QuickInfoWidget::findEntityById(unsigned long entityId) const{
-    RS_Entity* foundEntity = nullptr;
-    for (RS_Entity *e: *document) {
-        unsigned long eId = e->getId();
-        if (eId == entityId){
-            if (e->isVisible()){
-                foundEntity = e;
-                break;
-            }
-        }
-    }
+    RS_Entity* foundEntity = document->findEntityById(entityId);
+    if (foundEntity != nullptr && !foundEntity->isVisible())
+        return nullptr;
     return foundEntity;
 }
 
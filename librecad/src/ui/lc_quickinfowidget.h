@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <QWidget>
 #include <QDockWidget>
+#include <QTimer>
 #include "qg_graphicview.h"
 #include "rs_units.h"
 #include "lc_quickinfopointsdata.h"
@@ -123,6 +124,12 @@ private:
      */
     bool hasOwnPreview = false;
 
+    /**
+     * delays generation of entity view while the hovered entity changes
+     */
+    QTimer entityViewTimer;
+    static constexpr int entityViewDelay = 50;
+
     void clearEntityInfo();
     void updateEntityInfoView(bool forceUpdate=false, bool updateView = true);
     RS_Entity* findEntityById(unsigned long entityId) const;
@@ -0,0 +1,151 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include "lc_thumbnailservice.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+
+#include "rs_debug.h"
+
+LC_ThumbnailService::LC_ThumbnailService(QObject* parent):
+    QObject{parent}
+{}
+
+LC_ThumbnailService::~LC_ThumbnailService()
+{
+    if (m_process != nullptr) {
+        // end of input stops the server
+        m_process->disconnect(this);
+        m_process->closeWriteChannel();
+        if (!m_process->waitForFinished(1000))
+            m_process->kill();
+    }
+}
+
+QString LC_ThumbnailService::cachePath(const QString& dxfPath)
+{
+    const QFileInfo info{dxfPath};
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(info.size()));
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/iconCache/"
+           + QString::fromLatin1(hash.result().toHex()) + ".png";
+}
+
+QString LC_ThumbnailService::thumbnail(const QString& dxfPath)
+{
+    const QString pngPath = cachePath(dxfPath);
+    if (QFileInfo::exists(pngPath))
+        return pngPath;
+    if (!m_requested.contains(dxfPath)) {
+        m_requested.insert(dxfPath);
+        m_pending.push_back(dxfPath);
+        sendNext();
+    }
+    return {};
+}
+
+void LC_ThumbnailService::cancelPending()
+{
+    for (const QString& dxfPath: m_pending)
+        m_requested.remove(dxfPath);
+    m_pending.clear();
+}
+
+void LC_ThumbnailService::startProcess()
+{
+    QDir().mkpath(QFileInfo{cachePath({})}.path());
+
+    m_process = new QProcess(this);
+    m_process->setProcessChannelMode(QProcess::SeparateChannels);
+    m_process->setStandardErrorFile(QProcess::nullDevice());
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &LC_ThumbnailService::readResults);
+    connect(m_process, &QProcess::finished, this, &LC_ThumbnailService::processFinished);
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return;
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_ThumbnailService: cannot start dxf2png");
+        m_unavailable = true;
+        cancelPending();
+        processFinished();
+    });
+    const QString size = QString::number(thumbnailSize);
+    m_process->start(QCoreApplication::applicationFilePath(),
+                     {"dxf2png", "--serve", "--resolution", size + "x" + size});
+}
+
+// one file is sent at a time, so pending requests can still be cancelled
+void LC_ThumbnailService::sendNext()
+{
+    if (!m_rendering.isEmpty() || m_pending.empty() || m_unavailable)
+        return;
+    if (m_process == nullptr)
+        startProcess();
+
+    m_rendering = m_pending.front();
+    m_pending.pop_front();
+    m_process->write((m_rendering + '\t' + cachePath(m_rendering) + '\n').toUtf8());
+}
+
+void LC_ThumbnailService::readResults()
+{
+    // the manifest line of the file: dxf file, png file, status, ...
+    while (m_process->canReadLine()) {
+        const QStringList fields = QString::fromUtf8(m_process->readLine()).trimmed().split('\t');
+        if (fields.size() < 3)
+            continue;
+        const QString dxfPath = fields[0];
+        if (dxfPath == m_rendering)
+            m_rendering.clear();
+        if (fields[2] == "ok")
+            emit thumbnailReady(dxfPath, fields[1]);
+        else
+            RS_DEBUG->print(RS_Debug::D_WARNING, "LC_ThumbnailService: cannot render '%s'",
+                            dxfPath.toLatin1().data());
+    }
+    sendNext();
+}
+
+// the file being rendered made the process fail, the next files are rendered by a new process
+void LC_ThumbnailService::processFinished()
+{
+    if (m_process == nullptr)
+        return;
+    m_process->disconnect(this);
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    if (!m_rendering.isEmpty()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_ThumbnailService: cannot render '%s'",
+                        m_rendering.toLatin1().data());
+        m_rendering.clear();
+    }
+    sendNext();
+}
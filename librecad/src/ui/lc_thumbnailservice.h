@@ -0,0 +1,82 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_THUMBNAILSERVICE_H
+#define LC_THUMBNAILSERVICE_H
+
+#include <deque>
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class QProcess;
+
+/**
+ * @brief The LC_ThumbnailService class, renders thumbnails of dxf files in the background.
+ *
+ * Thumbnails are cached as PNG files in the application data, named by the path, the
+ * modification time and the size of the dxf file, so they're rendered again only when the file
+ * changed. Missing thumbnails are rendered one after another by a "dxf2png --serve" process,
+ * started once and kept running, since drawings can't be loaded by the GUI thread without
+ * freezing it, and can't be loaded by other threads.
+ */
+class LC_ThumbnailService : public QObject {
+    Q_OBJECT
+public:
+    // width and height of the thumbnails, in pixels
+    static constexpr int thumbnailSize = 128;
+
+    explicit LC_ThumbnailService(QObject* parent = nullptr);
+    ~LC_ThumbnailService() override;
+
+    /**
+     * @return the cached thumbnail of the dxf file, if it's up to date.
+     * Otherwise an empty string, and the thumbnail is rendered: thumbnailReady() is emitted.
+     */
+    QString thumbnail(const QString& dxfPath);
+    // drop the requests not rendered yet, e.g. for another library directory
+    void cancelPending();
+
+    static QString cachePath(const QString& dxfPath);
+
+signals:
+    void thumbnailReady(const QString& dxfPath, const QString& pngPath);
+
+private:
+    void startProcess();
+    void sendNext();
+    void readResults();
+    void processFinished();
+
+    QProcess* m_process = nullptr;
+    std::deque<QString> m_pending;
+    // files rendered, pending or failed, which are not requested again
+    QSet<QString> m_requested;
+    // the dxf file being rendered by the process
+    QString m_rendering;
+    // the process can't be started, thumbnails are not rendered
+    bool m_unavailable = false;
+};
+
+#endif // LC_THUMBNAILSERVICE_H
@@ -744,6 +744,8 @@ void LC_WidgetFactory::createMenus(QMenuBar* menu_bar)
     edit_menu->addAction(a_map["EditCopy"]);
     edit_menu->addAction(a_map["EditPaste"]);
     edit_menu->addAction(a_map["ModifyDeleteQuick"]);
+    edit_menu->addSeparator();
+    edit_menu->addAction(a_map["EditFindText"]);
 
     // <[~ Plugins ~]>
 
@@ -842,6 +844,8 @@ void LC_WidgetFactory::createMenus(QMenuBar* menu_bar)
     info_menu->setObjectName("Info");
     info_menu->setTearOffEnabled(true);
     info_menu->addActions(info_actions);
+    info_menu->addSeparator();
+    info_menu->addAction(a_map["InfoMemoryUsage"]);
 
     // <[~ Order ~]>
 
@@ -954,6 +958,24 @@ void LC_WidgetFactory::createMenus(QMenuBar* menu_bar)
     connect(license, SIGNAL(triggered()), main_window, SLOT(invokeLicenseWindow()));
     help_menu->addAction(license);
 
+    QAction* tracing = new QAction(QC_ApplicationWindow::tr("Performance &Tracing"), main_window);
+    tracing->setObjectName("PerformanceTracing");
+    tracing->setCheckable(true);
+    connect(tracing, &QAction::toggled, main_window, &QC_ApplicationWindow::slotTracing);
+    help_menu->addAction(tracing);
+
+    QAction* actionProfiling = new QAction(QC_ApplicationWindow::tr("&Action Profiling"), main_window);
+    actionProfiling->setObjectName("ActionProfiling");
+    actionProfiling->setCheckable(true);
+    connect(actionProfiling, &QAction::toggled, main_window, &QC_ApplicationWindow::slotActionProfiling);
+    help_menu->addAction(actionProfiling);
+
+    QAction* renderStatistics = new QAction(QC_ApplicationWindow::tr("Render &Statistics"), main_window);
+    renderStatistics->setObjectName("RenderStatistics");
+    renderStatistics->setCheckable(true);
+    connect(renderStatistics, &QAction::toggled, main_window, &QC_ApplicationWindow::slotRenderStatistics);
+    help_menu->addAction(renderStatistics);
+
     QAction* donate = new QAction( QC_ApplicationWindow::tr( "&Donate"), main_window);
     connect(donate, &QAction::triggered, main_window, [=](){
         QDesktopServices::openUrl( QUrl( "https://librecad.org/donate.html"));
@@ -177,6 +177,7 @@
 
 #include "qg_snaptoolbar.h"
 #include "rs_debug.h"
+#include "lc_undosection.h"
 #include "rs_graphicview.h"
 #include "rs_layer.h"
 #include "rs_settings.h"
@@ -198,6 +199,8 @@
 #include "lc_actionmodifylinegap.h"
 #include "lc_actioninfoproperties.h"
 #include "lc_actioninfopickcoordinates.h"
+#include "lc_actioneditfindtext.h"
+#include "lc_actioninfomemoryusage.h"
 
 /**
  * Constructor
@@ -209,6 +212,8 @@ QG_ActionHandler::QG_ActionHandler(QObject* parent)
     RS_DEBUG->print("QG_ActionHandler::QG_ActionHandler: OK");
 }
 
+QG_ActionHandler::~QG_ActionHandler() = default;
+
 /**
  * Kills all running selection actions. Called when a selection action
   * is launched to reduce confusion.
@@ -327,6 +332,9 @@ RS_ActionInterface* QG_ActionHandler::setCurrentAction(RS2::ActionType id) {
     case RS2::ActionEditPaste:
         a = new RS_ActionEditPaste(*document, *view);
         break;
+    case RS2::ActionEditFindText:
+        a = new LC_ActionEditFindText(*document, *view);
+        break;
     case RS2::ActionOrderBottom:
         orderType = RS2::ActionOrderBottom;
         if(!document->countSelected()){
@@ -964,6 +972,9 @@ RS_ActionInterface* QG_ActionHandler::setCurrentAction(RS2::ActionType id) {
         case RS2::ActionInfoPickCoordinates:
             a = new LC_ActionInfoPickCoordinates(*document, *view);
             break;
+        case RS2::ActionInfoMemoryUsage:
+            a = new LC_ActionInfoMemoryUsage(*document, *view);
+            break;
 
 
             // Layer actions:
@@ -1417,6 +1428,10 @@ void QG_ActionHandler::slotEditPaste() {
     setCurrentAction(RS2::ActionEditPaste);
 }
 
+void QG_ActionHandler::slotEditFindText() {
+    setCurrentAction(RS2::ActionEditFindText);
+}
+
 void QG_ActionHandler::slotOrderBottom() {
     setCurrentAction(RS2::ActionOrderBottom);
 }
@@ -2047,6 +2062,10 @@ void QG_ActionHandler::slotInfoArea() {
     setCurrentAction(RS2::ActionInfoArea);
 }
 
+void QG_ActionHandler::slotInfoMemoryUsage() {
+    setCurrentAction(RS2::ActionInfoMemoryUsage);
+}
+
 void QG_ActionHandler::slotEntityInfo() {
     setCurrentAction(RS2::ActionInfoProperties);
 }
@@ -2200,6 +2219,30 @@ void QG_ActionHandler::slotPenSyncFromLayer(){
 //    penPaletteWidget->updatePenToolbarByActiveLayer();
 }
 
+void QG_ActionHandler::beginScript(bool singleUndo)
+{
+    if (scriptDepth++ > 0)
+        return;
+    scriptView = view;
+    // redraw requests only accumulate until the end of the script
+    if (scriptView != nullptr)
+        scriptView->setUpdatesEnabled(false);
+    if (singleUndo && document != nullptr)
+        scriptUndo = std::make_unique<LC_UndoSection>(document);
+}
+
+void QG_ActionHandler::endScript()
+{
+    if (scriptDepth == 0 || --scriptDepth > 0)
+        return;
+    scriptUndo.reset();
+    if (scriptView != nullptr) {
+        scriptView->setUpdatesEnabled(true);
+        scriptView->redraw(RS2::RedrawAll);
+    }
+    scriptView.clear();
+}
+
 void QG_ActionHandler::set_view(RS_GraphicView* gview)
 {
     view = gview;
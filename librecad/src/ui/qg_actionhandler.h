@@ -28,8 +28,13 @@
 #ifndef QG_ACTIONHANDLER_H
 #define QG_ACTIONHANDLER_H
 
+#include <memory>
+
+#include <QPointer>
+
 #include "rs_actioninterface.h"
 
+class LC_UndoSection;
 class QG_SnapToolBar;
 class RS_Layer;
 
@@ -41,7 +46,7 @@ class QG_ActionHandler : public QObject {
 
 public:
 	QG_ActionHandler(QObject* parent);
-	virtual ~QG_ActionHandler() = default;
+	virtual ~QG_ActionHandler();
 
 	RS_ActionInterface* getCurrentAction();
 	RS_ActionInterface* setCurrentAction(RS2::ActionType id);
@@ -61,6 +66,13 @@ public:
 	//return true if handled
 	bool commandLineActions(RS2::ActionType id);
 	bool command(const QString& cmd);
+	/**
+	 * Brackets a stream of commands, e.g. from a command file: the view is
+	 * painted once after endScript(), and with singleUndo all commands form
+	 * one undo cycle. Calls may be nested.
+	 */
+	void beginScript(bool singleUndo);
+	void endScript();
 	QStringList getAvailableCommands();
 	RS_SnapMode getSnaps();
 	RS2::SnapRestriction getSnapRestriction();
@@ -99,6 +111,7 @@ public slots:
 	void slotEditCut();
 	void slotEditCopy();
 	void slotEditPaste();
+	void slotEditFindText();
 	void slotOrderBottom();
 	void slotOrderLower();
 	void slotOrderRaise();
@@ -247,6 +260,7 @@ public slots:
 	void slotInfoAngle();
 	void slotInfoTotalLength();
 	void slotInfoArea();
+	void slotInfoMemoryUsage();
  void slotEntityInfo();
  void slotPickCoordinates();
 
@@ -302,6 +316,10 @@ private:
     QG_SnapToolBar* snap_toolbar{nullptr};
     RS_GraphicView* view{nullptr};
     RS_Document*    document{nullptr};
+    // running command script, see beginScript()
+    int scriptDepth{0};
+    QPointer<RS_GraphicView> scriptView;
+    std::unique_ptr<LC_UndoSection> scriptUndo;
 };
 
 #endif
@@ -33,22 +33,71 @@
 #include <QToolButton>
 #include <QMenu>
 #include <QBoxLayout>
+#include <QElapsedTimer>
 #include <QLabel>
 #include <QLineEdit>
 #include <QContextMenuEvent>
+#include <QPixmap>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTimer>
 
 #include "qg_actionhandler.h"
 #include "qg_blockwidget.h"
+#include "rs_block.h"
 #include "rs_blocklist.h"
 #include "rs_debug.h"
+#include "rs_painterqt.h"
+#include "rs_settings.h"
+#include "rs_staticgraphicview.h"
+
+namespace {
+// rows added to the model each time the view scrolls to its end
+constexpr int g_fetchSize = 256;
+// smaller block lists are filtered without a worker thread
+constexpr int g_asyncFilterMinimum = 2000;
+// maximum number of blocks waiting for a preview
+constexpr int g_maxPendingPreviews = 128;
+// time spent rendering previews before the event loop gets back control
+constexpr qint64 g_previewSliceMs = 15;
+
+bool blockLessThan(const RS_Block *s1, const RS_Block *s2) {
+     return s1->getName() < s2->getName();
+}
+
+QIcon renderPreview(RS_Block* block, int size) {
+    QPixmap pixmap(size, size);
+    pixmap.fill(Qt::white);
+    RS_PainterQt painter(&pixmap);
+    painter.setBackground(Qt::white);
+    painter.setDrawingMode(RS2::ModeBW);
+
+    const QSize borders(2, 2);
+    RS_StaticGraphicView view(size, size, &painter, &borders);
+    view.setBackground(Qt::white);
+    view.setContainer(block);
+    view.zoomAuto(false);
+    view.drawEntity(&painter, block);
+    painter.end();
+    return QIcon(pixmap);
+}
+}
 
 QG_BlockModel::QG_BlockModel(QObject * parent) : QAbstractTableModel(parent) {
     blockVisible = QIcon(":/icons/visible.svg");
     blockHidden = QIcon(":/icons/invisible.svg");
+
+    previewTimer = new QTimer(this);
+    previewTimer->setInterval(0);
+    connect(previewTimer, &QTimer::timeout, this, &QG_BlockModel::renderPreviews);
+}
+
+QG_BlockModel::~QG_BlockModel() {
+    waitForFilter();
 }
 
 int QG_BlockModel::rowCount ( const QModelIndex & /*parent*/ ) const {
-    return listBlock.size();
+    return loadedRows;
 }
 
 QModelIndex QG_BlockModel::parent ( const QModelIndex & /*index*/ ) const {
@@ -56,52 +105,175 @@ QModelIndex QG_BlockModel::parent ( const QModelIndex & /*index*/ ) const {
 }
 
 QModelIndex QG_BlockModel::index ( int row, int column, const QModelIndex & /*parent*/ ) const {
-    if ( row >= listBlock.size() || row < 0)
+    if ( row >= loadedRows || row < 0)
         return QModelIndex();
     return createIndex ( row, column);
 }
 
-bool blockLessThan(const RS_Block *s1, const RS_Block *s2) {
-     return s1->getName() < s2->getName();
+bool QG_BlockModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && loadedRows < listBlock.size();
+}
+
+void QG_BlockModel::fetchMore(const QModelIndex &parent) {
+    if (!canFetchMore(parent))
+        return;
+    const int rows = std::min<int>(g_fetchSize, listBlock.size() - loadedRows);
+    beginInsertRows(QModelIndex(), loadedRows, loadedRows + rows - 1);
+    loadedRows += rows;
+    endInsertRows();
 }
 
 void QG_BlockModel::setBlockList(RS_BlockList* bl) {
-    /* since 4.6 the recommended way is to use begin/endResetModel()
-     * TNick <nicu.tofan@gmail.com>
-     */
-    beginResetModel();
-    listBlock.clear();
-    if (bl == nullptr){
-        endResetModel();
+    // results of a running filter refer to the old blocks
+    ++filterGeneration;
+    allBlocks.clear();
+    pendingPreviews.clear();
+    if (bl != nullptr) {
+        for (int i=0; i<bl->count(); ++i) {
+            if ( !bl->at(i)->isUndone() )
+                allBlocks.append(bl->at(i));
+        }
+        setActiveBlock(bl->getActive());
+        std::sort( allBlocks.begin(), allBlocks.end(), blockLessThan);
+    }
+
+    // forget previews of removed blocks
+    const QSet<RS_Block*> blocks(allBlocks.cbegin(), allBlocks.cend());
+    for (auto it = previews.begin(); it != previews.end();) {
+        if (blocks.contains(it.key()))
+            ++it;
+        else
+            it = previews.erase(it);
+    }
+
+    if (filter.isEmpty()) {
+        std::vector<int> matching(allBlocks.size());
+        for (size_t i = 0; i < matching.size(); ++i)
+            matching[i] = int(i);
+        setMatchingBlocks(matching);
+        return;
+    }
+
+    QStringList names;
+    names.reserve(allBlocks.size());
+    for (RS_Block* blk: allBlocks)
+        names.append(blk->getName());
+    const unsigned current = filterGeneration;
+    setMatchingBlocks(matchNames(names, filter, filterGeneration, current));
+}
+
+/**
+ * Shows the blocks with names matching the wildcard pattern. The names of
+ * large block lists are matched by a worker thread, the rows stay unchanged
+ * until filterApplied() is emitted.
+ */
+void QG_BlockModel::setFilter(const QString& pattern) {
+    filter = pattern;
+    const unsigned current = ++filterGeneration;
+
+    QStringList names;
+    names.reserve(allBlocks.size());
+    for (RS_Block* blk: allBlocks)
+        names.append(blk->getName());
+
+    if (allBlocks.size() < g_asyncFilterMinimum) {
+        setMatchingBlocks(matchNames(names, filter, filterGeneration, current));
+        emit filterApplied();
         return;
     }
-    for (int i=0; i<bl->count(); ++i) {
-        if ( !bl->at(i)->isUndone() )
-            listBlock.append(bl->at(i));
+
+    // a running filter is cancelled by the new generation
+    waitForFilter();
+    pendingFilter = std::async(std::launch::async, [this, names, pattern, current]() {
+        std::vector<int> matching = matchNames(names, pattern, filterGeneration, current);
+        if (filterGeneration != current)
+            return;
+        QMetaObject::invokeMethod(this, [this, matching, current]() {
+            if (filterGeneration != current)
+                return;
+            setMatchingBlocks(matching);
+            emit filterApplied();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void QG_BlockModel::waitForFilter() {
+    if (pendingFilter.valid())
+        pendingFilter.wait();
+}
+
+/**
+ * @return indices of the names matching the pattern, or an empty list when
+ * the filter generation changes before all names are matched
+ */
+std::vector<int> QG_BlockModel::matchNames(const QStringList& names, const QString& pattern,
+                                           const std::atomic<unsigned>& generation, unsigned current) {
+    std::vector<int> matching;
+    const QRegularExpression rx{QRegularExpression::wildcardToRegularExpression(pattern)};
+    for (int i = 0; i < names.size(); ++i) {
+        if (i % g_fetchSize == 0 && generation != current)
+            return {};
+        if (pattern.isEmpty() || names.at(i).indexOf(rx) == 0)
+            matching.push_back(i);
     }
-    setActiveBlock(bl->getActive());
-    std::sort( listBlock.begin(), listBlock.end(), blockLessThan);
+    return matching;
+}
 
-    //called to force redraw
+/**
+ * Replaces the rows by the given blocks.
+ * @param matching indices into allBlocks in ascending order
+ */
+void QG_BlockModel::setMatchingBlocks(const std::vector<int>& matching) {
+    beginResetModel();
+    for (RS_Block* blk: allBlocks)
+        blk->visibleInBlockList(false);
+    listBlock.clear();
+    listBlock.reserve(int(matching.size()));
+    for (int i: matching) {
+        RS_Block* blk = allBlocks.at(i);
+        blk->visibleInBlockList(true);
+        listBlock.append(blk);
+    }
+    loadedRows = std::min<int>(g_fetchSize, listBlock.size());
     endResetModel();
 }
 
-
 RS_Block *QG_BlockModel::getBlock( int row ){
-    if ( row >= listBlock.size() || row < 0)
+    if ( row >= loadedRows || row < 0)
         return nullptr;
     return listBlock.at(row);
 }
 
+/**
+ * @return row of the block in listBlock, or -1
+ */
+int QG_BlockModel::getRow(RS_Block* blk) const {
+    if (blk == nullptr)
+        return -1;
+    // listBlock is sorted by the unique block names
+    auto it = std::lower_bound(listBlock.cbegin(), listBlock.cend(), blk, blockLessThan);
+    if (it != listBlock.cend() && *it == blk)
+        return int(it - listBlock.cbegin());
+    return listBlock.indexOf(blk);
+}
+
+/**
+ * @return index of the block, rows are fetched up to the block if needed
+ */
 QModelIndex QG_BlockModel::getIndex (RS_Block * blk){
-    int row = listBlock.indexOf(blk);
+    int row = getRow(blk);
     if (row<0)
         return QModelIndex();
+    if (row >= loadedRows) {
+        beginInsertRows(QModelIndex(), loadedRows, row);
+        loadedRows = row + 1;
+        endInsertRows();
+    }
     return createIndex ( row, NAME);
 }
 
 QVariant QG_BlockModel::data ( const QModelIndex & index, int role ) const {
-    if (!index.isValid() || index.row() >= listBlock.size())
+    if (!index.isValid() || index.row() >= loadedRows)
         return QVariant();
 
     RS_Block* blk = listBlock.at(index.row());
@@ -113,6 +285,9 @@ QVariant QG_BlockModel::data ( const QModelIndex & index, int role ) const {
             return blockHidden;
         }
     }
+    if (role ==Qt::DecorationRole && index.column() == NAME && previewShown) {
+        return getPreview(blk);
+    }
     if (role ==Qt::DisplayRole && index.column() == NAME) {
         return blk->getName();
     }
@@ -127,6 +302,65 @@ QVariant QG_BlockModel::data ( const QModelIndex & index, int role ) const {
     return QVariant();
 }
 
+void QG_BlockModel::setPreviewShown(bool shown) {
+    if (previewShown == shown)
+        return;
+    previewShown = shown;
+    if (!shown) {
+        previews.clear();
+        pendingPreviews.clear();
+        previewTimer->stop();
+    }
+    if (loadedRows > 0)
+        emit dataChanged(index(0, NAME), index(loadedRows - 1, NAME), {Qt::DecorationRole});
+}
+
+int QG_BlockModel::previewSize() {
+    return 32;
+}
+
+/**
+ * @return the cached preview of the block. Missing or outdated previews are
+ * queued for rendering, an outdated one is returned until then.
+ */
+QVariant QG_BlockModel::getPreview(RS_Block* blk) const {
+    auto it = previews.constFind(blk);
+    if (it != previews.cend() && it->count == blk->count()
+            && it->min == blk->getMin() && it->max == blk->getMax())
+        return it->icon;
+
+    pendingPreviews.removeOne(blk);
+    pendingPreviews.append(blk);
+    if (pendingPreviews.size() > g_maxPendingPreviews)
+        pendingPreviews.removeFirst();
+    previewTimer->start();
+    return it != previews.cend() ? QVariant(it->icon) : QVariant();
+}
+
+/**
+ * Renders queued previews for a time slice, the blocks painted last first.
+ */
+void QG_BlockModel::renderPreviews() {
+    QElapsedTimer timer;
+    timer.start();
+    while (!pendingPreviews.isEmpty() && timer.elapsed() < g_previewSliceMs) {
+        RS_Block* blk = pendingPreviews.takeLast();
+        Preview preview;
+        preview.icon = renderPreview(blk, previewSize());
+        // borders are calculated by rendering
+        preview.count = blk->count();
+        preview.min = blk->getMin();
+        preview.max = blk->getMax();
+        previews.insert(blk, preview);
+
+        const int row = getRow(blk);
+        if (row >= 0 && row < loadedRows)
+            emit dataChanged(index(row, NAME), index(row, NAME), {Qt::DecorationRole});
+    }
+    if (pendingPreviews.isEmpty())
+        previewTimer->stop();
+}
+
  /**
  * Constructor.
  */
@@ -150,6 +384,13 @@ QG_BlockWidget::QG_BlockWidget(QG_ActionHandler* ah, QWidget* parent,
     blockView->verticalHeader()->hide();
     blockView->horizontalHeader()->setStretchLastSection(true);
     blockView->horizontalHeader()->hide();
+    blockView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    blockView->setIconSize(QSize(QG_BlockModel::previewSize(), QG_BlockModel::previewSize()));
+    {
+        auto groupGuard = RS_SETTINGS->beginGroupGuard("/Appearance");
+        blockModel->setPreviewShown(RS_SETTINGS->readNumEntry("/ShowBlockPreviews", 0) == 1);
+    }
+    updateRowHeight();
 
     QVBoxLayout* lay = new QVBoxLayout(this);
     lay->setSpacing ( 0 );
@@ -238,6 +479,7 @@ QG_BlockWidget::QG_BlockWidget(QG_ActionHandler* ah, QWidget* parent,
     lay->addWidget(blockView);
 
     connect(blockView, &QTableView::clicked, this, &QG_BlockWidget::slotActivated);
+    connect(blockModel, &QG_BlockModel::filterApplied, this, &QG_BlockWidget::slotFilterApplied);
     connect(blockView->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &QG_BlockWidget::slotSelectionChanged);
 }
@@ -251,6 +493,7 @@ void QG_BlockWidget::update() {
 
     if (blockList==nullptr) {
         RS_DEBUG->print("QG_BlockWidget::update(): blockList is nullptr");
+        blockModel->setBlockList(nullptr);
         blockModel->setActiveBlock(nullptr);
         return;
     }
@@ -262,7 +505,6 @@ void QG_BlockWidget::update() {
     RS_Block* b = lastBlock;
     activateBlock(activeBlock);
     lastBlock = b;
-    blockView->resizeRowsToContents();
 
     restoreSelections();
 
@@ -270,8 +512,22 @@ void QG_BlockWidget::update() {
 }
 
 
+/**
+ * Rows have a fixed height, so the view doesn't query the data of all rows.
+ */
+void QG_BlockWidget::updateRowHeight() {
+    int height = blockView->fontMetrics().height() + 6;
+    if (blockModel->isPreviewShown())
+        height = std::max(height, QG_BlockModel::previewSize() + 4);
+    blockView->verticalHeader()->setDefaultSectionSize(height);
+}
+
+
 void QG_BlockWidget::restoreSelections() {
 
+    if (blockList == nullptr)
+        return;
+
     QItemSelectionModel* selectionModel = blockView->selectionModel();
 
     for (auto block: *blockList) {
@@ -404,6 +660,10 @@ void QG_BlockWidget::contextMenuEvent(QContextMenuEvent *e) {
     addActionFunc(tr("&Edit Block"), &QG_ActionHandler::slotBlocksEdit);
     addActionFunc(tr("&Insert Block"), &QG_ActionHandler::slotBlocksInsert);
     addActionFunc(tr("&Create New Block"), &QG_ActionHandler::slotBlocksCreate);
+    contextMenu->addSeparator();
+    QAction* previewAction = contextMenu->addAction(tr("Show &Previews"), this, &QG_BlockWidget::slotTogglePreview);
+    previewAction->setCheckable(true);
+    previewAction->setChecked(blockModel->isPreviewShown());
     contextMenu->exec(QCursor::pos());
 
     e->accept();
@@ -428,10 +688,8 @@ void QG_BlockWidget::keyPressEvent(QKeyEvent* e) {
 
 
 void QG_BlockWidget::blockAdded(RS_Block*) {
+    // the model keeps the filter of the block list
     update();
-    if (! matchBlockName->text().isEmpty()) {
-        slotUpdateBlockList();
-    }
 }
 
 
@@ -444,19 +702,33 @@ void QG_BlockWidget::slotUpdateBlockList() {
         return;
     }
 
-    QRegularExpression rx{ QRegularExpression::wildcardToRegularExpression(matchBlockName->text())};
+    blockModel->setFilter(matchBlockName->text());
+}
 
-    for (int i = 0; i < blockList->count(); i++) {
-        RS_Block* block = blockModel->getBlock(i);
-        if (!block) continue;
-        if (block->getName().indexOf(rx) == 0) {
-            blockView->showRow(i);
-            blockModel->getBlock(i)->visibleInBlockList(true);
-        } else {
-            blockView->hideRow(i);
-            blockModel->getBlock(i)->visibleInBlockList(false);
-        }
-    }
 
+/**
+ * Called when the rows matching the filter are shown
+ */
+void QG_BlockWidget::slotFilterApplied() {
+    if (blockList == nullptr) {
+        return;
+    }
+    RS_Block* active = blockList->getActive();
+    if (active != nullptr && active->isVisibleInBlockList()) {
+        blockView->setCurrentIndex(blockModel->getIndex(active));
+    }
     restoreSelections();
 }
+
+
+/**
+ * Shows or hides the previews in the block list
+ */
+void QG_BlockWidget::slotTogglePreview() {
+    const bool shown = !blockModel->isPreviewShown();
+    blockModel->setPreviewShown(shown);
+    updateRowHeight();
+
+    auto groupGuard = RS_SETTINGS->beginGroupGuard("/Appearance");
+    RS_SETTINGS->writeEntry("/ShowBlockPreviews", shown ? 1 : 0);
+}
@@ -27,22 +27,36 @@
 #ifndef QG_BLOCKWIDGET_H
 #define QG_BLOCKWIDGET_H
 
+#include <atomic>
+#include <future>
+#include <vector>
+
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QIcon>
 #include <QItemSelection>
 #include <QWidget>
 
 #include "rs_blocklistlistener.h"
+#include "rs_vector.h"
 
 class QG_ActionHandler;
 class QTableView;
 class QLineEdit;
+class QTimer;
 
 
 /**
- * Implementation of a model to use in QG_BlockWidget
+ * Implementation of a model to use in QG_BlockWidget.
+ *
+ * Rows are created in batches while the view is scrolled, names are
+ * matched against the filter on a worker thread for large block lists,
+ * and optional block previews are rendered in the background of the
+ * event loop and cached.
  */
 class QG_BlockModel: public QAbstractTableModel {
+    Q_OBJECT
+
 public:
     enum {
         VISIBLE,
@@ -50,6 +64,7 @@ public:
         LAST
     };
     QG_BlockModel(QObject * parent = 0);
+    ~QG_BlockModel() override;
     Qt::ItemFlags flags ( const QModelIndex & /*index*/ ) const override {
             return Qt::ItemIsSelectable|Qt::ItemIsEnabled;}
     int columnCount(const QModelIndex &/*parent*/) const  override {return LAST;}
@@ -57,18 +72,57 @@ public:
     QVariant data ( const QModelIndex & index, int role = Qt::DisplayRole ) const override;
     QModelIndex parent ( const QModelIndex & index ) const override;
     QModelIndex index ( int row, int column, const QModelIndex & parent = QModelIndex() ) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     void setBlockList(RS_BlockList* bl);
+    void setFilter(const QString& pattern);
     RS_Block *getBlock( int row );
     QModelIndex getIndex (RS_Block * blk);
 
     RS_Block* getActiveBlock() const { return activeBlock; }
     void setActiveBlock(RS_Block* b) { activeBlock = b; }
 
+    bool isPreviewShown() const { return previewShown; }
+    void setPreviewShown(bool shown);
+    static int previewSize();
+
+signals:
+    /** Emitted when the rows matching a new filter are shown. */
+    void filterApplied();
+
 private:
+    struct Preview {
+        QIcon icon;
+        unsigned count = 0;
+        RS_Vector min;
+        RS_Vector max;
+    };
+
+    int getRow(RS_Block* blk) const;
+    void setMatchingBlocks(const std::vector<int>& matching);
+    void waitForFilter();
+    QVariant getPreview(RS_Block* blk) const;
+    void renderPreviews();
+    static std::vector<int> matchNames(const QStringList& names, const QString& pattern,
+                                       const std::atomic<unsigned>& generation, unsigned current);
+
+    /** all blocks of the block list sorted by name */
+    QList<RS_Block*> allBlocks;
+    /** blocks matching the filter, the first loadedRows of them are rows of the model */
     QList<RS_Block*> listBlock;
+    int loadedRows = 0;
+    QString filter;
+    std::atomic<unsigned> filterGeneration{0};
+    std::future<void> pendingFilter;
     QIcon blockVisible;
     QIcon blockHidden;
     RS_Block* activeBlock {nullptr};
+
+    bool previewShown = false;
+    mutable QHash<RS_Block*, Preview> previews;
+    /** blocks waiting for a preview, the most recently painted last */
+    mutable QList<RS_Block*> pendingPreviews;
+    QTimer* previewTimer = nullptr;
 };
 
 
@@ -116,6 +170,8 @@ public slots:
         const QItemSelection &selected,
         const QItemSelection &deselected);
     void slotUpdateBlockList();
+    void slotFilterApplied();
+    void slotTogglePreview();
 
 protected:
     void contextMenuEvent(QContextMenuEvent *e) override;
@@ -131,6 +187,7 @@ private:
     QG_ActionHandler* actionHandler = nullptr;
 
     void restoreSelections();
+    void updateRowHeight();
 };
 
 #endif
@@ -220,6 +220,7 @@ void QG_CommandEdit::processInput(QString input)
     {
         if (input.contains(";"))
         {
+            emit scriptStarted();
             foreach (auto str, input.split(";"))
             {
                 if (str.contains("\\"))
@@ -227,6 +228,7 @@ void QG_CommandEdit::processInput(QString input)
                 else
                     emit command(str);
             }
+            emit scriptFinished();
         }
         else
         {
@@ -237,6 +239,8 @@ void QG_CommandEdit::processInput(QString input)
         }
 
         historyList.append(input);
+        if (historyList.size() > maxHistory)
+            historyList.removeFirst();
         it = historyList.end();
     } else if (input == "") {
         emit command("");
@@ -376,6 +380,7 @@ void QG_CommandEdit::readCommandFile(const QString& path)
 
     QTextStream txt_stream(&file);
     QString line;
+    emit scriptStarted();
     while (!txt_stream.atEnd())
     {
         line = txt_stream.readLine();
@@ -383,6 +388,7 @@ void QG_CommandEdit::readCommandFile(const QString& path)
         if (!line.startsWith("#"))
             processInput(line);
     }
+    emit scriptFinished();
 }
 
 void QG_CommandEdit::modifiedPaste()
@@ -70,6 +70,9 @@ signals:
     void command(QString cmd);
     void message(QString msg);
     void keycode(QString code);
+    //! brackets several commands from one input, e.g. a command file
+    void scriptStarted();
+    void scriptFinished();
 
 private:
     /**
@@ -78,6 +81,8 @@ private:
       * @return an empty string, if calculation is performed; the input string, otherwise
       */
     QString filterCliCal(const QString& cmd);
+    //! number of commands kept for the up/down keys
+    static constexpr int maxHistory = 1000;
     QStringList historyList;
     QStringList::const_iterator it = historyList.cbegin();
     bool acceptCoordinates = false;
@@ -27,6 +27,7 @@
 #include "qg_commandhistory.h"
 #include <QAction>
 #include <QMouseEvent>
+#include <QTextDocument>
 
 // -- commandline history (output) widget --
 
@@ -52,6 +53,10 @@ QG_CommandHistory::QG_CommandHistory(QWidget* parent) :
     addAction(clear);
 
     setStyleSheet("selection-color: white; selection-background-color: green;");
+
+    // drop the oldest lines, so that long (scripted) sessions neither grow the
+    // document nor its layout without bounds
+    document()->setMaximumBlockCount(maxLines);
 }
 
 void QG_CommandHistory::mouseReleaseEvent(QMouseEvent* event)
@@ -66,6 +71,6 @@ void QG_CommandHistory::mouseReleaseEvent(QMouseEvent* event)
 void QG_CommandHistory::slotTextChanged()
 {
 	//only show the selectAll item when there is text
-	m_pSelectAll->setVisible(! toPlainText().isEmpty());
+	m_pSelectAll->setVisible(! document()->isEmpty());
 }
 
@@ -46,6 +46,8 @@ private slots:
 	void slotTextChanged();
 
 private:
+    /*number of lines kept in the history*/
+    static constexpr int maxLines = 5000;
 	/*menu item for Copy*/
     QAction* m_pCopy = nullptr;
 	/*menu item for Select All*/
@@ -31,11 +31,14 @@
 #include <QFileDialog>
 #include <QImageReader>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QString>
 #include <QRegularExpression>
 #include <QToolBar>
 
 #include "LC_DlgParabola.h"
+#include "lc_dlgfindtext.h"
+#include "lc_dlgmemoryreport.h"
 #include "lc_dlgsplinepoints.h"
 #include "lc_parabola.h"
 #include "lc_splinepoints.h"
@@ -194,6 +197,7 @@ QG_DialogFactory::QG_DialogFactory(QWidget* parent, QToolBar* ow)
  */
 QG_DialogFactory::~QG_DialogFactory() {
     RS_DEBUG->print("QG_DialogFactory::~QG_DialogFactory");
+    delete importProgress;
     RS_DEBUG->print("QG_DialogFactory::~QG_DialogFactory: OK");
 }
 
@@ -1707,6 +1711,28 @@ void QG_DialogFactory::requestOptionsDrawingDialog(RS_Graphic& graphic) {
     dlg.exec();
 }
 
+/**
+ * Shows the memory usage of a drawing.
+ */
+void QG_DialogFactory::requestMemoryReportDialog(const LC_MemoryReport& report) {
+    LC_DlgMemoryReport dlg(parent);
+    dlg.setReport(report);
+    dlg.exec();
+}
+
+/**
+ * Finds texts in a drawing, and asks for a replacement.
+ */
+bool QG_DialogFactory::requestFindTextDialog(RS_Graphic& graphic, RS_GraphicView& view,
+                                             LC_FindTextData& data) {
+    LC_DlgFindText dlg(parent);
+    dlg.setGraphic(graphic, view);
+    dlg.setData(data);
+    const bool replace = dlg.exec() == QDialog::Accepted;
+    data = dlg.getData();
+    return replace;
+}
+
 bool QG_DialogFactory::requestOptionsMakerCamDialog() {
 
     QG_DlgOptionsMakerCam dlg(parent);
@@ -1777,6 +1803,30 @@ void QG_DialogFactory::commandMessage(const QString& message) {
     RS_DEBUG->print("QG_DialogFactory::commandMessage: OK");
 
 }
+/**
+ * Shows a window modal progress dialog while a file is imported.
+ * Setting the progress processes the pending events, so the views
+ * repaint the drawing read so far.
+ */
+bool QG_DialogFactory::updateImportProgress(const QString& fileName, int percent) {
+    if (percent >= 100) {
+        delete importProgress;
+        importProgress = nullptr;
+        return true;
+    }
+
+    if (importProgress == nullptr) {
+        importProgress = new QProgressDialog(QObject::tr("Opening %1").arg(QFileInfo(fileName).fileName()),
+                                             QObject::tr("Cancel"), 0, 100, parent);
+        importProgress->setWindowModality(Qt::WindowModal);
+        importProgress->setMinimumDuration(0);
+        importProgress->setAutoReset(false);
+    }
+    importProgress->setValue(percent);
+
+    return !importProgress->wasCanceled();
+}
+
 void QG_DialogFactory::command(const QString& message) {
     RS_DEBUG->print("QG_DialogFactory::command");
     if (commandWidget) {
@@ -43,6 +43,7 @@ class QG_ArcTangentialOptions;
 class QG_PrintPreviewOptions;
 //class PrintPreviewOptions;
 class QG_CommandWidget;
+class QProgressDialog;
 class RS_Document;
 class QG_LineAngleOptions;
 class RS_Vector;
@@ -220,6 +221,8 @@ public:
 	bool requestHatchDialog(RS_Hatch* hatch) override;
 	void requestOptionsGeneralDialog() override;
 	void requestOptionsDrawingDialog(RS_Graphic& graphic) override;
+	void requestMemoryReportDialog(const LC_MemoryReport& report) override;
+	bool requestFindTextDialog(RS_Graphic& graphic, RS_GraphicView& view, LC_FindTextData& data) override;
 	bool requestOptionsMakerCamDialog() override;
 
 	QString requestFileSaveAsDialog(const QString& caption = QString(),
@@ -238,6 +241,7 @@ public:
 	void updateSelectionWidget(int num, double length) override;//updated for total number of selected, and total length of selected
 	void commandMessage(const QString& message) override;
  void command(const QString& message) override;
+	bool updateImportProgress(const QString& fileName, int percent) override;
 
 	static QString extToFormat(const QString& ext);
  void updateArcTangentialOptions(double d, bool byRadius) override;
@@ -266,6 +270,8 @@ private:
     QG_SnapDistOptions* snapDistOptions = nullptr;
     QG_ModifyOffsetOptions* modifyOffsetOptions = nullptr;
     QG_LineAngleOptions* m_pLineAngleOptions = nullptr;
+    //! shown while a file is imported
+    QProgressDialog* importProgress = nullptr;
 };
 
 #endif
@@ -53,6 +53,8 @@ void QG_FileDialog::getType(const QString filter)
         ftype = RS2::FormatDXFRW14;
     } else if (filter == fDxfrw12) {
         ftype = RS2::FormatDXFRW12;
+    } else if (filter == fDxfrwBinary) {
+        ftype = RS2::FormatDXFRWBinary;
 #ifdef DWGSUPPORT
     } else if (filter == fDwg) {
         ftype = RS2::FormatDWG;
@@ -89,7 +91,8 @@ QG_FileDialog::QG_FileDialog(QWidget* parent, Qt::WindowFlags f, FileType type)
     fDxfrw2000 = tr("Drawing Exchange DXF 2000 %1").arg("(*.dxf)");
     fDxfrw14 = tr("Drawing Exchange DXF R14 %1").arg("(*.dxf)");
     fDxfrw12 = tr("Drawing Exchange DXF R12 %1").arg("(*.dxf)");
-    fDxfrw = tr("Drawing Exchange %1").arg("(*.dxf)");
+    fDxfrwBinary = tr("Drawing Exchange DXF 2007 Binary %1").arg("(*.dxf)");
+    fDxfrw = tr("Drawing Exchange %1").arg("(*.dxf *.dxf.gz *.dxf.zst)");
 
     fLff = tr("LFF Font %1").arg("(*.lff)");
 #ifdef DWGSUPPORT
@@ -208,9 +211,9 @@ QString QG_FileDialog::getSaveFile(RS2::FormatType* type){
     QStringList filters;
 
 #ifdef JWW_WRITE_SUPPORT
-    filters << fDxfrw2007 << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fJww << fLff << fCxf;
+    filters << fDxfrw2007 << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fDxfrwBinary << fJww << fLff << fCxf;
 #else
-    filters << fDxfrw2007 << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fLff << fCxf;
+    filters << fDxfrw2007 << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fDxfrwBinary << fLff << fCxf;
 #endif
 
     ftype = RS2::FormatDXFRW;
@@ -256,8 +259,10 @@ QString QG_FileDialog::getSaveFile(RS2::FormatType* type){
     if (type)
         *type = ftype;
 
-    // append default extension:
-    if (!fi.fileName().endsWith(".dxf",Qt::CaseInsensitive))
+    // append default extension, compressed dxf files keep theirs:
+    if (!fi.fileName().endsWith(".dxf",Qt::CaseInsensitive)
+        && !fi.fileName().endsWith(".dxf.gz",Qt::CaseInsensitive)
+        && !fi.fileName().endsWith(".dxf.zst",Qt::CaseInsensitive))
         fn += getExtension(ftype);
 
     // store new default settings:
@@ -302,6 +307,7 @@ QString QG_FileDialog::getSaveFileName(QWidget* parent, RS2::FormatType* type) {
     filters.append("Drawing Exchange DXF 2000 (*.dxf)");
     filters.append("Drawing Exchange DXF R14 (*.dxf)");
     filters.append("Drawing Exchange DXF R12 (*.dxf)");
+    filters.append("Drawing Exchange DXF 2007 Binary (*.dxf)");
     filters.append("LFF Font (*.lff)");
     filters.append("Font (*.cxf)");
     filters.append("JWW (*.jww)");
@@ -351,6 +357,8 @@ QString QG_FileDialog::getSaveFileName(QWidget* parent, RS2::FormatType* type) {
                     *type = RS2::FormatDXFRW14;
                 } else if (fileDlg->selectedNameFilter()=="Drawing Exchange DXF R12 (*.dxf)") {
                     *type = RS2::FormatDXFRW12;
+                } else if (fileDlg->selectedNameFilter()=="Drawing Exchange DXF 2007 Binary (*.dxf)") {
+                    *type = RS2::FormatDXFRWBinary;
                 } else if (fileDlg->selectedNameFilter()=="JWW (*.jww)") {
                     *type = RS2::FormatJWW;
                 } else {
@@ -61,6 +61,7 @@ private:
     QString fDxfrw2000;
     QString fDxfrw14;
     QString fDxfrw12;
+    QString fDxfrwBinary;
     QString fDxfrw;
 #ifdef DWGSUPPORT
     QString fDwg;
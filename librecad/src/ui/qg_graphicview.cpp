@@ -24,18 +24,29 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <future>
 #include <iostream>
+#include <thread>
 
+#include <QDeadlineTimer>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QGridLayout>
 #include <QLabel>
 #include <QMenu>
+#include <QMouseEvent>
 #include <QNativeGestureEvent>
 #include <QPoint>
 #include <QPointingDevice>
+#include <QScreen>
 #include <QTimer>
 
+#include "lc_actionprofiler.h"
+#include "lc_snappointcache.h"
+#include "lc_tilecache.h"
 #include "qc_applicationwindow.h"
 
 #include "qg_blockwidget.h"
@@ -57,15 +68,70 @@
 #include "rs_eventhandler.h"
 #include "rs_graphic.h"
 #include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_math.h"
 #include "rs_modification.h"
 #include "rs_painterqt.h"
 #include "rs_settings.h"
+#include "rs_staticgraphicview.h"
 
 #ifdef EMU_C99
 #include "emu_c99.h"
 #endif
 
+namespace {
+// drawings with fewer entities are rendered by the GUI thread only
+constexpr unsigned parallelRenderingMinimumSize = 2048;
+// with more visible layers, the drawing is cached as a whole
+constexpr size_t maxCachedLayers = 64;
+// the maximum width of a parallel rendering task, in tiles
+constexpr int maxTaskColumns = 2;
+// with progressive rendering, no more tiles are started after this time of a frame
+constexpr int frameRenderBudget = 30; // ms
+
+/**
+ * Splits blocks of tiles into rows of up to maxTaskColumns tiles, so tasks are of
+ * similar sizes and are balanced between rendering threads.
+ */
+std::vector<QRect> splitBlocks(const std::vector<QRect>& blocks)
+{
+    std::vector<QRect> tasks;
+    for (const QRect& block: blocks)
+        for (int row = block.top(); row <= block.bottom(); ++row)
+            for (int column = block.left(); column <= block.right(); column += maxTaskColumns)
+                tasks.emplace_back(QPoint{column, row},
+                                   QPoint{std::min(column + maxTaskColumns - 1, block.right()), row});
+    return tasks;
+}
+
+/**
+ * Renders a block of drawing tiles. The view is resized and moved to the block,
+ * so viewport culling and clipping apply to the block.
+ */
+QImage renderTiles(RS_StaticGraphicView& view, const QRect& tileRange, bool antialiasing)
+{
+    const QRect canvasRect = LC_TileCache::canvasRect(tileRange);
+    view.setViewport(canvasRect.width(), canvasRect.height(),
+                     -canvasRect.left(), canvasRect.top() + canvasRect.height());
+
+    QImage block(canvasRect.size(), QImage::Format_ARGB32_Premultiplied);
+    block.fill(Qt::transparent);
+    RS_PainterQt painter2(&block);
+    if (antialiasing)
+    {
+        painter2.setRenderHint(QPainter::Antialiasing);
+    }
+    painter2.setDrawingMode(view.getDrawingMode());
+    // the selection is drawn on a layer of its own, see QG_GraphicView::renderSelection()
+    painter2.setIgnoreSelection(true);
+    view.drawLayer2((RS_Painter*)&painter2);
+    painter2.end();
+    view.getRenderStats().primitives += painter2.getPrimitiveCount();
+    return block;
+}
+}
+
 // Issue #1765: set default cursor size: 32x32
 constexpr int g_cursorSize=32;
 // Issue #1787: cursor hot spot at center by using hotX=hotY=-1
@@ -246,6 +312,125 @@ struct QG_GraphicView::AutoPanData
     const RS_Vector probedAreaOffset = {50 /* pixels */, 50 /* pixels */};
 };
 
+// Zoom previews: the drawing layer as last completely rendered, with the view it was rendered for
+struct QG_GraphicView::ZoomPreviewData
+{
+    // rendering the drawing waits until there was no zooming for this time
+    static constexpr int settleInterval = 150; // ms
+    // drawings rendered faster than this are rendered for each zoom step
+    static constexpr double slowRendering = 20.; // ms
+
+    bool enabled = true;
+    // the time to render all tiles of the view, estimated from the last frame rendering tiles
+    double renderTime = 0.;
+
+    std::unique_ptr<QTimer> settleTimer;
+    // the drawing shown scaled during the preview
+    QPixmap source;
+    bool active = false;
+
+    // the last complete drawing layer, kept while progressive frames render the next one
+    std::unique_ptr<QPixmap> completed;
+    // whether the drawing layer is complete, see QG_GraphicView::setProgressiveRendering()
+    bool drawingComplete = false;
+
+    // the view of the last complete drawing
+    bool rendered = false;
+    RS_Vector factor;
+    int offsetX = 0;
+    int offsetY = 0;
+    int height = 0;
+};
+
+// The render statistics overlay
+struct QG_GraphicView::RenderStatsData
+{
+    bool visible = false;
+    // the milliseconds spent on the pixmaps of the grid, the drawing, the selection and the overlay
+    enum Pixmap {Grid, Drawing, Selection, Overlay, PixmapCount};
+    double frameTimes[PixmapCount] = {};
+    // entities drawn by the tile views for the drawing pixmap, and by the view for the selection pixmap
+    RS_GraphicView::RenderStats drawing;
+    RS_GraphicView::RenderStats selection;
+    // tiles painted from the caches, and those of them rendered first
+    unsigned long tilesPainted = 0;
+    unsigned long tilesRendered = 0;
+};
+
+// The cached drawing of a layer
+struct QG_GraphicView::LayerTiles
+{
+    LC_TileCache cache;
+    // inserts may show entities of other layers, their tiles depend on the visibility of those
+    bool hasInserts = false;
+};
+
+// The cached drawing of a container, shared by its views with the same tile key
+struct QG_GraphicView::SharedTiles
+{
+    const RS_EntityContainer* container = nullptr;
+    LC_TileCache::Key key;
+    bool layerCaching = false;
+    LC_TileCache cache;
+    std::map<const RS_Layer*, std::unique_ptr<LayerTiles>> layerTiles;
+    // the tiles kept around each of the sharing views
+    std::map<const QG_GraphicView*, QRect> keptRanges;
+
+    // drop the tiles, which are not kept by any of the sharing views
+    void prune(const QG_GraphicView* view, const QRect& keptRange)
+    {
+        keptRanges[view] = keptRange;
+        std::vector<QRect> ranges;
+        for (const auto& [sharing, range]: keptRanges)
+            ranges.push_back(range);
+        cache.prune(ranges);
+        for (auto& [layer, tiles]: layerTiles)
+            tiles->cache.prune(ranges);
+    }
+
+    // sets the tiles of the view to the tiles of another view with the same key, if any
+    static void acquire(QG_GraphicView& view, const LC_TileCache::Key& key, bool layerCaching)
+    {
+        const std::shared_ptr<SharedTiles>& current = view.m_tiles;
+        if (current != nullptr && current->container == view.container
+                && current->key == key && current->layerCaching == layerCaching)
+            return;
+        release(view);
+
+        // views are widgets, only used by the GUI thread
+        static std::vector<std::weak_ptr<SharedTiles>> sharedTiles;
+        sharedTiles.erase(std::remove_if(sharedTiles.begin(), sharedTiles.end(),
+                                         [](const std::weak_ptr<SharedTiles>& tiles) { return tiles.expired(); }),
+                          sharedTiles.end());
+        for (const std::weak_ptr<SharedTiles>& shared: sharedTiles)
+        {
+            std::shared_ptr<SharedTiles> tiles = shared.lock();
+            if (tiles->container == view.container && tiles->key == key && tiles->layerCaching == layerCaching)
+            {
+                view.m_tiles = std::move(tiles);
+                return;
+            }
+        }
+        // the tiles of the view alone are rendered again for the new key
+        if (current == nullptr || current.use_count() > 1)
+        {
+            view.m_tiles = std::make_shared<SharedTiles>();
+            sharedTiles.push_back(view.m_tiles);
+        }
+        view.m_tiles->container = view.container;
+        view.m_tiles->key = key;
+        view.m_tiles->layerCaching = layerCaching;
+        view.m_tiles->cache.clear();
+        view.m_tiles->layerTiles.clear();
+    }
+
+    static void release(QG_GraphicView& view)
+    {
+        if (view.m_tiles != nullptr)
+            view.m_tiles->keptRanges.erase(&view);
+    }
+};
+
 
 /**
  * Constructor.
@@ -261,6 +446,8 @@ QG_GraphicView::QG_GraphicView(QWidget* parent, Qt::WindowFlags f, RS_Document*
     ,redrawMethod(RS2::RedrawAll)
     ,isSmoothScrolling(false)
     , m_panData{std::make_unique<AutoPanData>()}
+    , m_zoomPreview{std::make_unique<ZoomPreviewData>()}
+    , m_renderStats{std::make_unique<RenderStatsData>()}
 {
     RS_DEBUG->print("QG_GraphicView::QG_GraphicView()..");
 
@@ -291,6 +478,7 @@ QG_GraphicView::QG_GraphicView(QWidget* parent, Qt::WindowFlags f, RS_Document*
  */
 QG_GraphicView::~QG_GraphicView() {
 	cleanUp();
+    SharedTiles::release(*this);
 }
 
 
@@ -428,6 +616,9 @@ void QG_GraphicView::updateGridStatusWidget(QString text)
  * Redraws the widget.
  */
 void QG_GraphicView::redraw(RS2::RedrawMethod method) {
+        // the drawing or the zoom changed
+        if (method & RS2::RedrawDrawing)
+            getSnapPointCache().invalidate();
         redrawMethod=(RS2::RedrawMethod ) (redrawMethod | method);
         update(); // Paint when reeady to pain
 //	repaint(); //Paint immediate
@@ -452,11 +643,14 @@ void QG_GraphicView::mousePressEvent(QMouseEvent* event)
     {
         setCurrentAction(new RS_ActionZoomPan(*container, *this));
     }
+    // actions see the cursor where it is pressed
+    processPendingMouseMove();
     eventHandler->mousePressEvent(event);
 }
 
 void QG_GraphicView::mouseDoubleClickEvent(QMouseEvent* e)
 {
+    processPendingMouseMove();
     switch(e->button())
     {
         default:
@@ -484,6 +678,7 @@ void QG_GraphicView::mouseReleaseEvent(QMouseEvent* event)
     RS_DEBUG->print("QG_GraphicView::mouseReleaseEvent");
 
     event->accept();
+    processPendingMouseMove();
 
     switch (event->button())
     {
@@ -584,7 +779,36 @@ void QG_GraphicView::mouseMoveEvent(QMouseEvent* event)
     m_panData->panTimer.reset();
     // handle auto-panning
     event->accept();
-    eventHandler->mouseMoveEvent(event);
+    // actions following the path of the cursor, like drawing freehand, get every move
+    RS_ActionInterface* action = eventHandler->getCurrentAction();
+    if (action != nullptr && action->handlesEveryMouseMove()) {
+        processPendingMouseMove();
+        eventHandler->mouseMoveEvent(event);
+        m_mouseMoveTimer.start();
+        return;
+    }
+    // snapping can be slower than the mouse on large drawings, and mice report moves faster than
+    // the screen shows frames. Only the latest move is handled, once per frame, and once the
+    // events queued before it are processed
+    const bool scheduled = m_pendingMouseMove != nullptr;
+    m_pendingMouseMove = std::make_unique<QMouseEvent>(event->type(), event->position(), event->globalPosition(),
+                                                       event->button(), event->buttons(), event->modifiers());
+    if (scheduled)
+        return;
+    const qreal refreshRate = screen() != nullptr ? screen()->refreshRate() : 60.;
+    const int frame = static_cast<int>(std::lround(1000. / std::max(refreshRate, qreal(1.))));
+    const qint64 elapsed = m_mouseMoveTimer.isValid() ? m_mouseMoveTimer.elapsed() : frame;
+    const int delay = static_cast<int>(std::max<qint64>(frame - elapsed, 0));
+    QTimer::singleShot(delay, this, &QG_GraphicView::processPendingMouseMove);
+}
+
+void QG_GraphicView::processPendingMouseMove()
+{
+    if (m_pendingMouseMove == nullptr)
+        return;
+    std::unique_ptr<QMouseEvent> event = std::move(m_pendingMouseMove);
+    eventHandler->mouseMoveEvent(event.get());
+    m_mouseMoveTimer.start();
 }
 
 bool QG_GraphicView::event(QEvent *event)
@@ -744,6 +968,7 @@ void QG_GraphicView::tabletEvent(QTabletEvent* e) {
 void QG_GraphicView::leaveEvent(QEvent* e) {
     // stop auto-panning
     m_panData->panTimer.reset();
+    m_pendingMouseMove.reset();
 
     eventHandler->mouseLeaveEvent();
     QWidget::leaveEvent(e);
@@ -806,9 +1031,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
         {
             if (e->modifiers()==Qt::ControlModifier)
             {
-                RS_SETTINGS->beginGroup("/Defaults");
-                bool invZoom = (RS_SETTINGS->readNumEntry("/InvertZoomDirection", 0) == 1);
-                RS_SETTINGS->endGroup();
+                bool invZoom = RS_SETTINGS->snapshot().invertZoomDirection;
 
                 // Hold ctrl to zoom. 1 % per pixel
                 double v = (invZoom) ? (numPixels.y() / zoomWheelDivisor) : (-numPixels.y() / zoomWheelDivisor);
@@ -826,10 +1049,8 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
             }
             else
             {
-                RS_SETTINGS->beginGroup("/Defaults");
-                bool inv_h = (RS_SETTINGS->readNumEntry("/WheelScrollInvertH", 0) == 1);
-                bool inv_v = (RS_SETTINGS->readNumEntry("/WheelScrollInvertV", 0) == 1);
-                RS_SETTINGS->endGroup();
+                bool inv_h = RS_SETTINGS->snapshot().wheelScrollInvertH;
+                bool inv_v = RS_SETTINGS->snapshot().wheelScrollInvertV;
 
                 int hDelta = (inv_h) ? -numPixels.x() : numPixels.x();
                 int vDelta = (inv_v) ? -numPixels.y() : numPixels.y();
@@ -846,7 +1067,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
                                                              *container, *this));
                 }
             }
-            redraw();
+            redraw(RS2::RedrawPan);
         }
         e->accept();
         return;
@@ -888,10 +1109,8 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
     if (scroll && scrollbars) {
 		//scroll by scrollbars: issue #479
 
-        RS_SETTINGS->beginGroup("/Defaults");
-        bool inv_h = (RS_SETTINGS->readNumEntry("/WheelScrollInvertH", 0) == 1);
-        bool inv_v = (RS_SETTINGS->readNumEntry("/WheelScrollInvertV", 0) == 1);
-        RS_SETTINGS->endGroup();
+        bool inv_h = RS_SETTINGS->snapshot().wheelScrollInvertH;
+        bool inv_v = RS_SETTINGS->snapshot().wheelScrollInvertV;
 
         int delta = 0;
 
@@ -912,8 +1131,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
 
     // zoom in / out:
     else if (e->modifiers()==0) {
-        auto groupGuard = RS_SETTINGS->beginGroupGuard("/Defaults");
-        bool invZoom = RS_SETTINGS->readNumEntry("/InvertZoomDirection", 0) == 1;
+        bool invZoom = RS_SETTINGS->snapshot().invertZoomDirection;
 
         RS2::ZoomDirection zoomDirection = ((e->angleDelta().y() > 0) != invZoom) ? RS2::In : RS2::Out;
 
@@ -936,6 +1154,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
 #endif
             Qt::NoButton, Qt::NoButton, Qt::NoModifier
     };
+    m_pendingMouseMove.reset();
     eventHandler->mouseMoveEvent(&event);
 
     e->accept();
@@ -947,6 +1166,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
         if (container == nullptr) {
             return;
         }
+        processPendingMouseMove();
 
         bool scroll = false;
         RS2::Direction direction = RS2::Up;
@@ -1075,6 +1295,17 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
  */
 void QG_GraphicView::adjustZoomControls() {}
 
+/**
+ * Zooms with a preview: a sequence of zoom steps scales the last complete
+ * drawing, and the drawing is rendered for the latest view once they paused.
+ */
+void QG_GraphicView::zoomIn(double f, const RS_Vector& center)
+{
+    startZoomPreview();
+    viewMoved();
+    RS_GraphicView::zoomIn(f, center);
+}
+
 
 /**
  * Slot for horizontal scroll events.
@@ -1094,7 +1325,7 @@ void QG_GraphicView::slotHScrolled(int value) {
     }
     //if (isUpdateEnabled()) {
 //         updateGrid();
-    redraw();
+    redraw(RS2::RedrawPan);
 }
 
 
@@ -1118,7 +1349,7 @@ void QG_GraphicView::slotVScrolled(int value) {
     }
     //if (isUpdateEnabled()) {
   //  updateGrid();
-    redraw();
+    redraw(RS2::RedrawPan);
 }
 /**
  * @brief setOffset
@@ -1128,9 +1359,12 @@ void QG_GraphicView::slotVScrolled(int value) {
 void QG_GraphicView::setOffset(int ox, int oy) {
 //    DEBUG_HEADER
 //    qDebug()<<"adjusting offset from ("<<getOffsetX()<<","<<getOffsetY()<<") to ("<<ox<<" , "<<oy<<")";
+    const bool moved = ox != getOffsetX() || oy != getOffsetY();
     RS_GraphicView::setOffset(ox, oy);
     // need to adjust offset control for scrollbars when setting graphicview offset
     adjustOffsetControls();
+    if (moved)
+        viewMoved();
 }
 
 RS_Vector QG_GraphicView::getMousePosition() const
@@ -1213,63 +1447,613 @@ void QG_GraphicView::paintEvent(QPaintEvent *)
     // Re-Create or get the layering pixmaps
     getPixmapForView(PixmapLayer1);
     getPixmapForView(PixmapLayer2);
+    getPixmapForView(PixmapLayerSelection);
     getPixmapForView(PixmapLayer3);
 
+    QElapsedTimer frameTimer;
+    const auto elapsed = [&frameTimer] {
+        return frameTimer.nsecsElapsed() * 1e-6;
+    };
+
     // Draw Layer 1
     if (redrawMethod & RS2::RedrawGrid)
     {
+        frameTimer.start();
         PixmapLayer1->fill(getBackground());
         RS_PainterQt painter1(PixmapLayer1.get());
         drawLayer1((RS_Painter*)&painter1);
         painter1.end();
+        m_renderStats->frameTimes[RenderStatsData::Grid] = elapsed();
     }
 
+    // Draw layer 2 from cached tiles
+    constexpr unsigned drawingMethods = RS2::RedrawDrawing | RS2::RedrawTiles | RS2::RedrawRemainingTiles;
+    if ((redrawMethod & drawingMethods) && paintZoomPreview())
+    {
+        // the drawing is rendered again once zooming paused
+        redrawMethod = (RS2::RedrawMethod) (redrawMethod & ~(drawingMethods | RS2::RedrawSelection));
+    }
     if (redrawMethod & RS2::RedrawDrawing)
     {
+        if (m_tiles != nullptr)
+        {
+            m_tiles->cache.clear();
+            m_tiles->layerTiles.clear();
+        }
+        m_dirtyAreas.clear();
+    }
+    if (redrawMethod & drawingMethods)
+    {
+        frameTimer.start();
+        const QDeadlineTimer deadline = m_progressiveRendering
+                ? QDeadlineTimer{frameRenderBudget}
+                : QDeadlineTimer{QDeadlineTimer::Forever};
+        bool complete = true;
+        m_renderStats->drawing = {};
+        m_renderStats->tilesPainted = 0;
+        m_renderStats->tilesRendered = 0;
+
+        LC_TileCache::Key key;
+        key.factorX = getFactor().x;
+        key.factorY = getFactor().y;
+        key.panning = isPanning();
+        key.draftMode = isDraftMode();
+        key.antialiasing = isAntialiased();
+        key.drawingMode = drawingMode;
+        key.printPreview = isPrintPreview();
+        if (isPrintPreview() && container != nullptr && container->getGraphic() != nullptr)
+            key.paperScale = container->getGraphic()->getPaperScale();
+        key.lineWidthScaling = getLineWidthScaling();
+
+        // the visible area in canvas pixels
+        const QRect canvasRect{-getOffsetX(), getOffsetY() - getHeight(), getWidth(), getHeight()};
+        // tiles of changed entities, with a margin for line widths and handles
+        std::vector<QRect> dirtyRects;
+        for (const LC_Rect& area: m_dirtyAreas)
+        {
+            const RS_Vector v1 = toGui(area.minP());
+            const RS_Vector v2 = toGui(area.maxP());
+            const QPoint topLeft{int(std::floor(std::min(v1.x, v2.x))) - viewportMargin,
+                                 int(std::floor(std::min(v1.y, v2.y))) - viewportMargin};
+            const QPoint bottomRight{int(std::ceil(std::max(v1.x, v2.x))) + viewportMargin,
+                                     int(std::ceil(std::max(v1.y, v2.y))) + viewportMargin};
+            dirtyRects.push_back(QRect{topLeft, bottomRight}.translated(canvasRect.topLeft()));
+        }
+        m_dirtyAreas.clear();
+        const QRect tileRange = LC_TileCache::tileRange(canvasRect);
+        // keep a ring of tiles around the view for small pans
+        const QRect keptRange = tileRange.adjusted(-1, -1, 1, 1);
+
         view_rect = LC_Rect(toGraph(0, 0),
                             toGraph(getWidth(), getHeight()));
-        // DRaw layer 2
+        // render into the other buffer, the complete drawing is kept for zoom previews
+        if (m_zoomPreview->drawingComplete)
+        {
+            std::swap(PixmapLayer2, m_zoomPreview->completed);
+            getPixmapForView(PixmapLayer2);
+        }
         PixmapLayer2->fill(Qt::transparent);
-        RS_PainterQt painter2(PixmapLayer2.get());
-        if (antialiasing)
+        QPainter painter2(PixmapLayer2.get());
+
+        std::vector<const RS_Layer*> layers;
+        const bool layerCaching = getCachedLayers(layers);
+        SharedTiles::acquire(*this, key, layerCaching);
+        if (layerCaching)
+        {
+            // tiles of hidden layers are kept for showing them again
+            for (auto& [layer, tiles]: m_tiles->layerTiles)
+            {
+                tiles->cache.setKey(key);
+                for (const QRect& rect: dirtyRects)
+                    tiles->cache.invalidate(rect);
+            }
+            for (const RS_Layer* layer: layers)
+            {
+                std::unique_ptr<LayerTiles>& tiles = m_tiles->layerTiles[layer];
+                if (tiles == nullptr)
+                {
+                    tiles = std::make_unique<LayerTiles>();
+                    tiles->cache.setKey(key);
+                }
+                if (!tiles->cache.missingBlocks(tileRange).empty())
+                {
+                    const std::vector<RS_Entity*> entities = container->getLayerEntities(layer);
+                    tiles->hasInserts = tiles->hasInserts || std::any_of(entities.cbegin(), entities.cend(),
+                            [](const RS_Entity* e) { return e->rtti() == RS2::EntityInsert; });
+                    complete = renderMissingTiles(tiles->cache, tileRange, deadline, true, layer) && complete;
+                }
+                tiles->cache.paint(painter2, canvasRect);
+                m_renderStats->tilesPainted += tileRange.width() * tileRange.height();
+            }
+            m_tiles->prune(this, keptRange);
+            painter2.end();
+
+            // not drawn by the layer passes
+            if (!isPrintPreview())
+            {
+                RS_PainterQt painterZero(PixmapLayer2.get());
+                drawAbsoluteZero(&painterZero);
+                painterZero.end();
+            }
+        }
+        else
         {
-            painter2.setRenderHint(QPainter::Antialiasing);
+            m_tiles->cache.setKey(key);
+            for (const QRect& rect: dirtyRects)
+                m_tiles->cache.invalidate(rect);
+            complete = renderMissingTiles(m_tiles->cache, tileRange, deadline);
+            m_tiles->prune(this, keptRange);
+            m_tiles->cache.paint(painter2, canvasRect);
+            m_renderStats->tilesPainted += tileRange.width() * tileRange.height();
+            painter2.end();
         }
-        painter2.setDrawingMode(drawingMode);
-        painter2.setDrawSelectedOnly(false);
-        drawLayer2((RS_Painter*)&painter2);
-        painter2.setDrawSelectedOnly(true);
-        drawLayer2((RS_Painter*)&painter2);
-        painter2.end();
+
+        if (m_renderStats->tilesRendered > 0)
+            m_zoomPreview->renderTime = elapsed() * m_renderStats->tilesPainted / m_renderStats->tilesRendered;
+        m_zoomPreview->drawingComplete = complete;
+        if (complete)
+        {
+            m_zoomPreview->rendered = true;
+            m_zoomPreview->factor = getFactor();
+            m_zoomPreview->offsetX = getOffsetX();
+            m_zoomPreview->offsetY = getOffsetY();
+            m_zoomPreview->height = getHeight();
+        }
+        m_renderStats->frameTimes[RenderStatsData::Drawing] = elapsed();
+
+        if (m_renderStats->visible)
+            redrawMethod = (RS2::RedrawMethod) (redrawMethod | RS2::RedrawOverlay);
+        // the next frame continues after the pending events, for the view as it is then
+        if (!complete && !m_renderRemaining)
+        {
+            m_renderRemaining = true;
+            QTimer::singleShot(0, this, [this]() {
+                m_renderRemaining = false;
+                redraw(RS2::RedrawRemainingTiles);
+            });
+        }
+    }
+
+    // Draw the selection over the drawing, the tiles don't depend on the selection
+    if (redrawMethod & (RS2::RedrawDrawing | RS2::RedrawTiles | RS2::RedrawSelection))
+    {
+        frameTimer.start();
+        renderSelection();
+        m_renderStats->frameTimes[RenderStatsData::Selection] = elapsed();
+        // show the new statistics
+        if (m_renderStats->visible)
+            redrawMethod = (RS2::RedrawMethod) (redrawMethod | RS2::RedrawOverlay);
     }
 
     if (redrawMethod & RS2::RedrawOverlay)
     {
+        LC_ActionProfileScope profileScope{LC_ActionProfiler::Overlay};
+        frameTimer.start();
         PixmapLayer3->fill(Qt::transparent);
         RS_PainterQt painter3(PixmapLayer3.get());
-        if (antialiasing)
+        if (isAntialiased())
         {
             painter3.setRenderHint(QPainter::Antialiasing);
         }
         drawLayer3((RS_Painter*)&painter3);
         painter3.end();
+        m_renderStats->frameTimes[RenderStatsData::Overlay] = elapsed();
     }
 
     // Finally paint the layers back on the screen, bitblk to the rescue!
     RS_PainterQt wPainter(this);
     wPainter.drawPixmap(0,0,*PixmapLayer1);
     wPainter.drawPixmap(0,0,*PixmapLayer2);
+    wPainter.drawPixmap(0,0,*PixmapLayerSelection);
     wPainter.drawPixmap(0,0,*PixmapLayer3);
     wPainter.end();
 
     redrawMethod=RS2::RedrawNone;
 }
 
+/**
+ * Renders the selected and highlighted entities on top of the drawing layer, so
+ * changing the selection or the highlighting doesn't render the drawing again.
+ * The entities are first drawn in the background color, to hide them as drawn
+ * on the drawing layer.
+ */
+void QG_GraphicView::renderSelection()
+{
+    PixmapLayerSelection->fill(Qt::transparent);
+    resetRenderStats();
+    m_renderStats->selection = {};
+    if (container == nullptr || isPrintPreview())
+        return;
+
+    RS_PainterQt painter(PixmapLayerSelection.get());
+    if (isAntialiased())
+    {
+        painter.setRenderHint(QPainter::Antialiasing);
+    }
+    painter.setDrawingMode(getDrawingMode());
+    painter.setDrawSelectedOnly(true);
+    painter.beginBatch();
+    const bool deleteMode = getDeleteMode();
+    if (!deleteMode)
+    {
+        setDeleteMode(true);
+        drawEntity(&painter, container);
+        setDeleteMode(false);
+    }
+    drawEntity(&painter, container);
+    painter.endBatch();
+    painter.end();
+    m_renderStats->selection = getRenderStats();
+    m_renderStats->selection.primitives += painter.getPrimitiveCount();
+}
+
+/**
+ * Starts or extends a zoom preview. Rendering a large drawing takes longer
+ * than the interval of wheel or gesture events, so the drawing is not
+ * rendered for each zoom step: the last complete drawing is scaled instead,
+ * and rendered again when zooming paused. Tiles of a progressive rendering
+ * still missing are not rendered for the old view.
+ */
+void QG_GraphicView::startZoomPreview()
+{
+    ZoomPreviewData& preview = *m_zoomPreview;
+    if (!preview.enabled || !preview.rendered || PixmapLayer2 == nullptr)
+        return;
+    // zooming shows the drawing rendered, if that's fast enough
+    if (!preview.active && preview.renderTime < ZoomPreviewData::slowRendering)
+        return;
+    if (!preview.active)
+    {
+        const bool inProgress = !preview.drawingComplete && preview.completed != nullptr;
+        preview.source = inProgress ? *preview.completed : *PixmapLayer2;
+        if (PixmapLayerSelection != nullptr)
+        {
+            QPainter painter{&preview.source};
+            painter.drawPixmap(0, 0, *PixmapLayerSelection);
+        }
+        preview.active = true;
+    }
+    if (preview.settleTimer == nullptr)
+    {
+        preview.settleTimer = std::make_unique<QTimer>(this);
+        preview.settleTimer->setSingleShot(true);
+        connect(preview.settleTimer.get(), &QTimer::timeout, this, [this]() {
+            m_zoomPreview->active = false;
+            m_zoomPreview->source = QPixmap{};
+            redraw(RS2::RedrawDrawing);
+        });
+    }
+    preview.settleTimer->start(ZoomPreviewData::settleInterval);
+}
+
+/**
+ * Draws the last complete drawing, mapped to the current view.
+ *
+ * @return false, if no zoom preview is active
+ */
+bool QG_GraphicView::paintZoomPreview()
+{
+    ZoomPreviewData& preview = *m_zoomPreview;
+    if (!preview.active || preview.source.isNull()
+            || preview.factor.x < RS_TOLERANCE || preview.factor.y < RS_TOLERANCE)
+        return false;
+
+    // keep the complete drawing, the preview is drawn into the other buffer
+    if (preview.drawingComplete)
+    {
+        std::swap(PixmapLayer2, preview.completed);
+        getPixmapForView(PixmapLayer2);
+        preview.drawingComplete = false;
+    }
+
+    // from the rendered view to the current one: x=(gx-offsetX)/factor.x and
+    // y=(height-offsetY-gy)/factor.y are the same graph coordinates in both views
+    const double sx = getFactor().x / preview.factor.x;
+    const double sy = getFactor().y / preview.factor.y;
+    const QTransform transform{sx, 0., 0., sy,
+                               getOffsetX() - sx * preview.offsetX,
+                               getHeight() - getOffsetY() - sy * (preview.height - preview.offsetY)};
+
+    // the preview shows the selection too
+    PixmapLayerSelection->fill(Qt::transparent);
+    PixmapLayer2->fill(Qt::transparent);
+    QPainter painter2(PixmapLayer2.get());
+    painter2.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter2.setTransform(transform);
+    painter2.drawPixmap(0, 0, preview.source);
+    painter2.end();
+    return true;
+}
+
+/**
+ * Redraws an area of the drawing, by rendering again the tiles covering the area.
+ */
+void QG_GraphicView::redrawArea(const LC_Rect& area)
+{
+    getSnapPointCache().invalidate();
+    // too many changes to track individually
+    if (m_dirtyAreas.size() >= maxDirtyAreas)
+    {
+        m_dirtyAreas.clear();
+        redraw(RS2::RedrawDrawing);
+        return;
+    }
+    m_dirtyAreas.push_back(area);
+    redraw(RS2::RedrawTiles);
+}
+
+/**
+ * Renders the missing tiles of a range into the tile cache. Large drawings are
+ * rendered by several threads, each with its own view and painter: the GUI
+ * thread takes part and waits for the others, so the document is only read
+ * while the tiles are rendered.
+ *
+ * Once the deadline expired, no more tasks are started; at least one task is
+ * rendered, so each frame makes progress. With a deadline, tiles closest to the
+ * center of the range are rendered first.
+ */
+bool QG_GraphicView::renderMissingTiles(LC_TileCache& cache, const QRect& tileRange,
+                                        const QDeadlineTimer& deadline,
+                                        bool layerPass, const RS_Layer* layer)
+{
+    std::vector<QRect> blocks = cache.missingBlocks(tileRange);
+    if (blocks.empty())
+        return true;
+
+    const bool parallel = container != nullptr && container->count() >= parallelRenderingMinimumSize;
+    const bool budgeted = !deadline.isForever();
+    size_t threadCount = 1;
+    if (parallel || budgeted)
+        blocks = splitBlocks(blocks);
+    if (parallel)
+        threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), blocks.size());
+    if (budgeted)
+    {
+        // the center of the view first, in rings around it
+        const QPointF center = QRectF{tileRange}.center();
+        const auto distance = [&center](const QRect& block) {
+            const QPointF d = QRectF{block}.center() - center;
+            return d.x() * d.x() + d.y() * d.y();
+        };
+        std::stable_sort(blocks.begin(), blocks.end(), [&distance](const QRect& a, const QRect& b) {
+            return distance(a) < distance(b);
+        });
+    }
+
+    // views are widgets, so they are only created by the GUI thread
+    while (m_tileViews.size() < threadCount)
+        m_tileViews.push_back(std::make_unique<RS_StaticGraphicView>(0, 0, nullptr));
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_tileViews[i]->setDrawingState(*this);
+        m_tileViews[i]->setLayerPass(layerPass, layer);
+        m_tileViews[i]->resetRenderStats();
+    }
+
+    if (threadCount == 1)
+    {
+        size_t rendered = 0;
+        for (; rendered < blocks.size() && (rendered == 0 || !deadline.hasExpired()); ++rendered)
+        {
+            const QRect& block = blocks[rendered];
+            cache.store(block, renderTiles(*m_tileViews.front(), block, isAntialiased()));
+            m_renderStats->tilesRendered += block.width() * block.height();
+        }
+        m_renderStats->drawing += m_tileViews.front()->getRenderStats();
+        return rendered == blocks.size();
+    }
+
+    // entities regenerated on demand are created by the GUI thread, before they are drawn by several threads
+    QRect renderedRange;
+    for (const QRect& block: blocks)
+        renderedRange |= block;
+    const QRect renderedRect = LC_TileCache::canvasRect(renderedRange);
+    RS_StaticGraphicView& firstView = *m_tileViews.front();
+    firstView.setViewport(renderedRect.width(), renderedRect.height(),
+                          -renderedRect.left(), renderedRect.top() + renderedRect.height());
+    container->prepareDraw(firstView);
+
+    // build the spatial index before the container is shared
+    container->getSpatialIndex();
+
+    std::vector<QImage> images(blocks.size());
+    // the tasks started before the deadline, empty images are transparent tiles
+    std::vector<char> rendered(blocks.size(), 0);
+    std::atomic<size_t> next{0};
+    const bool antialiased = isAntialiased();
+    auto render = [&blocks, &images, &rendered, &next, &deadline, antialiased](RS_StaticGraphicView* view) {
+        for (size_t i = next++; i < blocks.size() && (i == 0 || !deadline.hasExpired()); i = next++)
+        {
+            images[i] = renderTiles(*view, blocks[i], antialiased);
+            rendered[i] = 1;
+        }
+    };
+    std::vector<std::future<void>> workers;
+    for (size_t i = 1; i < threadCount; ++i)
+        workers.push_back(std::async(std::launch::async, render, m_tileViews[i].get()));
+    render(m_tileViews.front().get());
+    for (std::future<void>& worker: workers)
+        worker.get();
+    for (size_t i = 0; i < threadCount; ++i)
+        m_renderStats->drawing += m_tileViews[i]->getRenderStats();
+
+    bool complete = true;
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (!rendered[i])
+        {
+            complete = false;
+            continue;
+        }
+        cache.store(blocks[i], images[i]);
+        m_renderStats->tilesRendered += blocks[i].width() * blocks[i].height();
+    }
+    return complete;
+}
+
+/**
+ * Collects the layers cached separately: the entities without a layer, and
+ * the visible layers in the order of the layer list.
+ */
+bool QG_GraphicView::getCachedLayers(std::vector<const RS_Layer*>& layers) const
+{
+    if (!m_layerCaching || container == nullptr || isPrintPreview())
+        return false;
+    RS_Graphic* graphic = container->getGraphic();
+    if (graphic == nullptr || graphic->getLayerList() == nullptr)
+        return false;
+
+    layers.push_back(nullptr);
+    for (const RS_Layer* layer: *graphic->getLayerList())
+    {
+        if (layer != nullptr && !layer->isFrozen())
+            layers.push_back(layer);
+    }
+    return layers.size() <= maxCachedLayers;
+}
+
+void QG_GraphicView::layerToggled(RS_Layer*)
+{
+    if (!m_layerCaching)
+    {
+        redraw(RS2::RedrawDrawing);
+        return;
+    }
+    // the visible layers are composited again
+    if (m_tiles != nullptr)
+    {
+        for (auto& [layer, tiles]: m_tiles->layerTiles)
+        {
+            if (tiles->hasInserts)
+                tiles->cache.clear();
+        }
+    }
+    getSnapPointCache().invalidate();
+    redraw(RS2::RedrawTiles);
+}
+
 void QG_GraphicView::setAntialiasing(bool state)
 {
 	antialiasing = state;
 }
 
+void QG_GraphicView::setLayerCaching(bool state)
+{
+    if (m_layerCaching == state)
+        return;
+    m_layerCaching = state;
+    redraw(RS2::RedrawDrawing);
+}
+
+void QG_GraphicView::setZoomPreview(bool state)
+{
+    m_zoomPreview->enabled = state;
+}
+
+void QG_GraphicView::setProgressiveRendering(bool state)
+{
+    m_progressiveRendering = state;
+}
+
+void QG_GraphicView::setInteractionQuality(bool state)
+{
+    m_interactionQuality = state;
+    if (!state && m_interacting)
+    {
+        m_interacting = false;
+        redraw(RS2::RedrawTiles);
+    }
+}
+
+/**
+ * A single move of the view, like zooming to a window, is rendered in full
+ * quality. Once moves follow each other within the settle interval, the view
+ * renders without antialiasing, until it stopped moving for that interval.
+ */
+void QG_GraphicView::viewMoved()
+{
+    if (!m_interactionQuality || !antialiasing)
+        return;
+    if (m_interactionTimer == nullptr)
+    {
+        m_interactionTimer = std::make_unique<QTimer>(this);
+        m_interactionTimer->setSingleShot(true);
+        connect(m_interactionTimer.get(), &QTimer::timeout, this, [this]() {
+            if (!m_interacting)
+                return;
+            // the tile key changes, so the tiles are rendered again
+            m_interacting = false;
+            redraw(RS2::RedrawTiles);
+        });
+    }
+    if (m_interactionTimer->isActive())
+        m_interacting = true;
+    m_interactionTimer->start(ZoomPreviewData::settleInterval);
+}
+
+bool QG_GraphicView::isAntialiased() const
+{
+    return antialiasing && !m_interacting;
+}
+
+void QG_GraphicView::setRenderStatistics(bool state)
+{
+    if (m_renderStats->visible == state)
+        return;
+    m_renderStats->visible = state;
+    redraw(RS2::RedrawOverlay);
+}
+
+void QG_GraphicView::drawLayer3(RS_Painter *painter)
+{
+    RS_GraphicView::drawLayer3(painter);
+    if (m_renderStats->visible)
+        drawRenderStatistics(painter);
+}
+
+/**
+ * Draws the statistics of the last frame at the top left corner of the view:
+ * the times of the pixmaps, the entities and primitives drawn into the drawing
+ * and selection pixmaps, and the share of tiles reused from the tile caches.
+ * The overlay time shown is the one of the previous overlay.
+ */
+void QG_GraphicView::drawRenderStatistics(RS_Painter *painter)
+{
+    const RenderStatsData& data = *m_renderStats;
+    RenderStats entities = data.drawing;
+    entities += data.selection;
+    const unsigned long cached = data.tilesPainted - std::min(data.tilesPainted, data.tilesRendered);
+    const int hitRate = data.tilesPainted > 0 ? int(std::lround(100. * cached / data.tilesPainted)) : 0;
+
+    const QStringList lines{
+        tr("Frame: grid %1 ms, drawing %2 ms, selection %3 ms, overlay %4 ms")
+            .arg(data.frameTimes[RenderStatsData::Grid], 0, 'f', 1)
+            .arg(data.frameTimes[RenderStatsData::Drawing], 0, 'f', 1)
+            .arg(data.frameTimes[RenderStatsData::Selection], 0, 'f', 1)
+            .arg(data.frameTimes[RenderStatsData::Overlay], 0, 'f', 1),
+        tr("Entities: %1 visited, %2 culled, %3 drawn")
+            .arg(entities.visited).arg(entities.culled).arg(entities.drawn),
+        tr("Drawn: %1 texts, %2 hatches, %3 inserts")
+            .arg(entities.texts).arg(entities.hatches).arg(entities.inserts),
+        tr("Primitives: %1").arg(entities.primitives),
+        tr("Tile cache: %1 of %2 tiles reused (%3%)")
+            .arg(cached).arg(data.tilesPainted).arg(hitRate)
+    };
+
+    constexpr int margin = 4;
+    const QFontMetrics metrics{font()};
+    int width = 0;
+    for (const QString& line: lines)
+        width = std::max(width, metrics.horizontalAdvance(line));
+    const int lineHeight = metrics.height();
+
+    painter->fillRect(QRectF(0, 0, width + 2 * margin, lineHeight * lines.size() + 2 * margin),
+                      QBrush(QColor(0, 0, 0, 160)));
+    painter->setPen(RS_Color(Qt::white));
+    for (int i = 0; i < lines.size(); ++i)
+        painter->drawText(QRect(margin, margin + i * lineHeight, width, lineHeight), lines.at(i), nullptr);
+}
+
 void QG_GraphicView::addScrollbars()
 {
     scrollbars = true;
@@ -1419,8 +2203,7 @@ bool QG_GraphicView::isAutoPan(QMouseEvent *event) const
 {
     if (event == nullptr)
         return false;
-    RS_SETTINGS->beginGroupGuard("/Appearance");
-    const bool autopanEnabled = (bool) RS_SETTINGS->readNumEntry("/Autopanning", 0);
+    const bool autopanEnabled = RS_SETTINGS->snapshot().autopanning;
 
     if (!autopanEnabled)
         return false;
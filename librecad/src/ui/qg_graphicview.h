@@ -27,17 +27,26 @@
 #ifndef QG_GRAPHICVIEW_H
 #define QG_GRAPHICVIEW_H
 
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QElapsedTimer>
 #include <QWidget>
 
 #include "rs_blocklistlistener.h"
 #include "rs_graphicview.h"
 #include "rs_layerlistlistener.h"
 
+class QDeadlineTimer;
 class QGridLayout;
 class QLabel;
 class QMenu;
+class QTimer;
 class QEnterEvent;
 class QG_ScrollBar;
+class LC_TileCache;
+class RS_StaticGraphicView;
 
 /**
  * This is the Qt implementation of a widget which can view a 
@@ -61,9 +70,12 @@ public:
 	void redraw(RS2::RedrawMethod method=RS2::RedrawAll) override;
 	void adjustOffsetControls() override;
 	void adjustZoomControls() override;
+	// zoomOut() zooms by zoomIn() too
+	void zoomIn(double f=1.5, const RS_Vector& center=RS_Vector(false)) override;
 	void setBackground(const RS_Color& bg) override;
 	void setMouseCursor(RS2::CursorType c) override;
 	void updateGridStatusWidget(QString text) override;
+	void redrawArea(const LC_Rect& area) override;
 
 	virtual	void getPixmapForView(std::unique_ptr<QPixmap>& pm);
 		
@@ -74,9 +86,7 @@ public:
 	void layerRemoved(RS_Layer*) override{
         redraw(RS2::RedrawDrawing); 
     }
-	void layerToggled(RS_Layer*) override{
-        redraw(RS2::RedrawDrawing); 
-    }
+	void layerToggled(RS_Layer*) override;
 	void layerActivated(RS_Layer *) override;
     /**
      * @brief setOffset
@@ -92,6 +102,32 @@ public:
 	RS_Vector getMousePosition() const override;
 
     void setAntialiasing(bool state);
+    /**
+     * @brief setLayerCaching - keep the rendered drawing of each layer, so showing and hiding layers
+     * composites the cached layers instead of rendering the drawing again. Overlapping entities of
+     * different layers are drawn in the order of the layer list.
+     */
+    void setLayerCaching(bool state);
+    /**
+     * @brief setZoomPreview - while zoom steps follow each other, show the last rendered drawing
+     * scaled around the zoom center, and render the drawing once they paused. Only drawings
+     * slow to render are previewed.
+     */
+    void setZoomPreview(bool state);
+    /**
+     * @brief setProgressiveRendering - render the drawing within a time budget per frame, the tiles
+     * closest to the view center first. The remaining tiles are rendered by the following frames, so
+     * events are handled between them; tiles no longer in view after a pan or zoom are not rendered.
+     */
+    void setProgressiveRendering(bool state);
+    /**
+     * @brief setInteractionQuality - while the view moves, e.g. panning, scrolling or zooming step by
+     * step, render the drawing without antialiasing, and render it antialiased again once the view
+     * stopped moving. Only affects views with antialiasing on.
+     */
+    void setInteractionQuality(bool state);
+    // shows counters and timings of the rendering over the drawing
+    void setRenderStatistics(bool state);
     void setCursorHiding(bool state);
     void addScrollbars();
     bool hasScrollbars();
@@ -120,6 +156,7 @@ protected:
 	bool event(QEvent * e) override;
 
 	void paintEvent(QPaintEvent *)override;
+	void drawLayer3(RS_Painter *painter) override;
 	void resizeEvent(QResizeEvent* e) override;
 
     QList<QAction*> recent_actions;
@@ -150,6 +187,7 @@ protected:
 	// Used for buffering different paint layers
 	std::unique_ptr<QPixmap> PixmapLayer1;  // Used for grids and absolute 0
     std::unique_ptr<QPixmap> PixmapLayer2;  // Used for the actual CAD drawing
+    std::unique_ptr<QPixmap> PixmapLayerSelection;  // Used for selected and highlighted entities
     std::unique_ptr<QPixmap> PixmapLayer3;  // Used for crosshair and actionitems
 	
 	RS2::RedrawMethod redrawMethod;
@@ -172,6 +210,58 @@ private:
     struct AutoPanData;
     std::unique_ptr<AutoPanData> m_panData;
 
+    // handle the latest mouse move, if not handled yet
+    void processPendingMouseMove();
+    // the latest mouse move; moves arriving while one is still waiting replace it
+    std::unique_ptr<QMouseEvent> m_pendingMouseMove;
+    // since the last mouse move handled; at most one is handled per frame of the screen
+    QElapsedTimer m_mouseMoveTimer;
+
+    // render the missing tiles of a range of tile indices into a cache, of a single layer if layerPass is set.
+    // Returns false if tiles are still missing once the deadline expired
+    bool renderMissingTiles(LC_TileCache& cache, const QRect& tileRange, const QDeadlineTimer& deadline,
+                            bool layerPass = false, const RS_Layer* layer = nullptr);
+    // the visible layers cached separately, false if layers are not cached
+    bool getCachedLayers(std::vector<const RS_Layer*>& layers) const;
+    // render the selected and highlighted entities of the view
+    void renderSelection();
+    // tiles of the drawing layer reused while panning, and of each layer if layers are cached,
+    // see setLayerCaching(). Views of the same container rendering it the same way share them
+    struct LayerTiles;
+    struct SharedTiles;
+    std::shared_ptr<SharedTiles> m_tiles;
+    bool m_layerCaching = false;
+    bool m_progressiveRendering = true;
+    // a frame rendering the remaining tiles is scheduled
+    bool m_renderRemaining = false;
+    // views rendering tile blocks, one per rendering thread
+    std::vector<std::unique_ptr<RS_StaticGraphicView>> m_tileViews;
+    // areas of changed entities, in graph coordinates, not redrawn yet
+    std::vector<LC_Rect> m_dirtyAreas;
+    static constexpr size_t maxDirtyAreas = 1024;
+
+    // While zooming interactively, the last rendered drawing is shown scaled,
+    // until the zooming has paused long enough to render the drawing again
+    void startZoomPreview();
+    // draws the scaled drawing, if a zoom preview is active
+    bool paintZoomPreview();
+    struct ZoomPreviewData;
+    std::unique_ptr<ZoomPreviewData> m_zoomPreview;
+
+    // the view moved: moves following each other quickly render in the interaction quality
+    void viewMoved();
+    // antialiasing, unless the view is moving
+    bool isAntialiased() const;
+    bool m_interactionQuality = true;
+    bool m_interacting = false;
+    // runs from a move of the view until the view stopped moving
+    std::unique_ptr<QTimer> m_interactionTimer;
+
+    // counters and timings of the last frame, see setRenderStatistics()
+    void drawRenderStatistics(RS_Painter *painter);
+    struct RenderStatsData;
+    std::unique_ptr<RenderStatsData> m_renderStats;
+
 
 signals:
     void xbutton1_released();
@@ -26,6 +26,8 @@
 **********************************************************************/
 
 
+#include <algorithm>
+
 #include <QBitmap>
 #include <QBoxLayout>
 #include <QContextMenuEvent>
@@ -100,6 +102,95 @@ void QG_LayerModel::setLayerList(RS_LayerList* ll) {
 
 
 
+/**
+ * Inserts the row of a layer added to the layer list.
+ */
+void QG_LayerModel::addLayer(RS_Layer* layer) {
+    if (layer == nullptr || getRow(layer) >= 0)
+        return;
+    const int row = getInsertRow(layer);
+    beginInsertRows(QModelIndex(), row, row);
+    listLayer.insert(row, layer);
+    endInsertRows();
+}
+
+/**
+ * Removes the row of a layer removed from the layer list.
+ */
+void QG_LayerModel::removeLayer(RS_Layer* layer) {
+    const int row = listLayer.indexOf(layer);
+    if (row < 0)
+        return;
+    beginRemoveRows(QModelIndex(), row, row);
+    listLayer.removeAt(row);
+    if (activeLayer == layer)
+        activeLayer = nullptr;
+    endRemoveRows();
+}
+
+/**
+ * Updates the row of a changed layer, which is moved if it was renamed.
+ */
+void QG_LayerModel::updateLayer(RS_Layer* layer) {
+    int row = getRow(layer);
+    if (row < 0) {
+        // renamed
+        removeLayer(layer);
+        addLayer(layer);
+        return;
+    }
+    emit dataChanged(index(row, 0), index(row, LAST - 1));
+}
+
+/**
+ * Updates the rows of layers, whose attributes were changed at once.
+ */
+void QG_LayerModel::updateLayers(const QList<RS_Layer*>& layers) {
+    int first = listLayer.size();
+    int last = -1;
+    for (RS_Layer* layer: layers) {
+        const int row = getRow(layer);
+        if (row >= 0) {
+            first = std::min(first, row);
+            last = std::max(last, row);
+        }
+    }
+    if (first <= last)
+        emit dataChanged(index(first, 0), index(last, LAST - 1));
+}
+
+/**
+ * @return the row of the layer by a binary search for its name, -1 if the layer
+ * isn't in the model or was renamed
+ */
+int QG_LayerModel::getRow(RS_Layer* layer) const {
+    if (layer == nullptr)
+        return -1;
+    const QString& name = layer->getName();
+    auto it = std::lower_bound(listLayer.cbegin(), listLayer.cend(), name,
+                               [](const RS_Layer* l, const QString& n) {
+        return l->getName() < n;
+    });
+    for (; it != listLayer.cend() && (*it)->getName() == name; ++it) {
+        if (*it == layer)
+            return int(it - listLayer.cbegin());
+    }
+    return -1;
+}
+
+/**
+ * @return the row, where the layer is inserted by its name
+ */
+int QG_LayerModel::getInsertRow(RS_Layer* layer) const {
+    auto it = std::upper_bound(listLayer.cbegin(), listLayer.cend(), layer->getName(),
+                               [](const QString& n, const RS_Layer* l) {
+        return n < l->getName();
+    });
+    return int(it - listLayer.cbegin());
+}
+
+
+
 RS_Layer *QG_LayerModel::getLayer(int row) const {
     if ( row >= listLayer.size() || row < 0)
         return nullptr;
@@ -315,12 +406,53 @@ void QG_LayerWidget::setLayerList(RS_LayerList* layerList, bool showByBlock) {
 
 void QG_LayerWidget::layerAdded(RS_Layer* layer)
 {
-    update();   // 1st apply the new layer to the view
+    layerModel->addLayer(layer);
     if (! matchLayerName->text().isEmpty()) {
         slotUpdateLayerList();
     }
     activateLayer(layer);
-    update();   // update again, if new layer is last row, the height was wrong
+}
+
+
+
+void QG_LayerWidget::layerEdited(RS_Layer* layer)
+{
+    if (layer == nullptr) {
+        update();
+        return;
+    }
+    updateLayer(layer);
+    if (! matchLayerName->text().isEmpty()) {
+        slotUpdateLayerList();
+    }
+}
+
+
+
+void QG_LayerWidget::layerRemoved(RS_Layer* layer)
+{
+    layerModel->removeLayer(layer);
+    activateLayer(layerList->at(0));
+}
+
+
+
+void QG_LayerWidget::layersToggled(const QList<RS_Layer*>& layers)
+{
+    layerModel->updateLayers(layers);
+}
+
+
+
+/**
+ * Updates the row of a layer, all rows for nullptr.
+ */
+void QG_LayerWidget::updateLayer(RS_Layer* layer)
+{
+    if (layer == nullptr)
+        update();
+    else
+        layerModel->updateLayer(layer);
 }
 
 
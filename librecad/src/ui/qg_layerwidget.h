@@ -73,6 +73,10 @@ public:
     QModelIndex parent ( const QModelIndex & index ) const override;
     QModelIndex index ( int row, int column, const QModelIndex & parent = QModelIndex() ) const override;
     void setLayerList(RS_LayerList* ll);
+    void addLayer(RS_Layer* layer);
+    void removeLayer(RS_Layer* layer);
+    void updateLayer(RS_Layer* layer);
+    void updateLayers(const QList<RS_Layer*>& layers);
     RS_Layer *getLayer( int row ) const;
     QModelIndex getIndex (RS_Layer * lay) const;
 
@@ -86,6 +90,10 @@ public:
     }
 
 private:
+    int getRow(RS_Layer* layer) const;
+    int getInsertRow(RS_Layer* layer) const;
+
+    //! the layers sorted by name
     QList<RS_Layer*> listLayer;
     QIcon layerVisible;
     QIcon layerHidden;
@@ -118,23 +126,21 @@ public:
 
   void layerActivated(RS_Layer *layer) override { activateLayer(layer);}
   void layerAdded(RS_Layer *layer) override;
-  void layerEdited(RS_Layer *) override { update(); }
-  void layerRemoved(RS_Layer *) override {
-        update();
-        activateLayer(layerList->at(0));
-    }
-    void layerToggled(RS_Layer*) override {
-        update();
+  void layerEdited(RS_Layer *layer) override;
+  void layerRemoved(RS_Layer *layer) override;
+    void layerToggled(RS_Layer* layer) override {
+        updateLayer(layer);
     }
-    void layerToggledLock(RS_Layer*) override {
-        update();
+    void layerToggledLock(RS_Layer* layer) override {
+        updateLayer(layer);
     }
-    void layerToggledPrint(RS_Layer*) override {
-        update();
+    void layerToggledPrint(RS_Layer* layer) override {
+        updateLayer(layer);
     }
-    void layerToggledConstruction(RS_Layer*) override {
-        update();
+    void layerToggledConstruction(RS_Layer* layer) override {
+        updateLayer(layer);
     }
+    void layersToggled(const QList<RS_Layer*>& layers) override;
 
     QLineEdit* getMatchLayerName() {
         return matchLayerName;
@@ -170,6 +176,7 @@ private:
     QG_ActionHandler* actionHandler = nullptr;
 
     void restoreSelections();
+    void updateLayer(RS_Layer* layer);
 };
 
 #endif
@@ -25,46 +25,25 @@
 **
 **********************************************************************/
 
-#include <QApplication>
 #include <QDateTime>
 #include <QDesktopServices>
-#include <QImageWriter>
 #include <QListView>
 #include <QModelIndex>
 #include <QMouseEvent>
 #include <QPushButton>
 #include <QStandardItemModel>
-#include <QStandardPaths>
 #include <QTreeView>
 #include <QVBoxLayout>
 
 #include "qg_librarywidget.h"
 
+#include "lc_thumbnailservice.h"
 #include "qg_actionhandler.h"
 #include "rs_actionlibraryinsert.h"
 #include "rs_debug.h"
-#include "rs_painterqt.h"
 #include "rs_settings.h"
-#include "rs_staticgraphicview.h"
 #include "rs_system.h"
 
-namespace {
-    void writePng(const QString& pngPath, QPixmap pixmap)
-    {
-        QImageWriter iio;
-        QImage img = pixmap.toImage();
-        img = img.scaled(64,64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-        // iio.setImage(img);
-        iio.setFileName(pngPath);
-        iio.setFormat("PNG");
-        if (!iio.write(img)) {
-            RS_DEBUG->print(RS_Debug::D_ERROR,
-                            "QG_LibraryWidget::getPathToPixmap: Cannot write thumbnail: '%s'",
-                            pngPath.toLatin1().data());
-        }
-    }
-}
-
 /*
  *  Constructs a QG_LibraryWidget as a child of 'parent', with the
  *  name 'name' and widget flags set to 'f'.
@@ -97,6 +76,9 @@ QG_LibraryWidget::QG_LibraryWidget(QWidget* parent, const char* name, Qt::Window
     refreshButtonsLayout->addWidget(bRebuild);
     vboxLayout->addLayout(refreshButtonsLayout);
 
+    thumbnails = new LC_ThumbnailService(this);
+    connect(thumbnails, &LC_ThumbnailService::thumbnailReady, this, &QG_LibraryWidget::slotThumbnailReady);
+
     buildTree();
 
     connect(dirView, SIGNAL(expanded(QModelIndex)), this, SLOT(expandView(QModelIndex)));
@@ -195,6 +177,7 @@ void QG_LibraryWidget::scanTree() {
  */
 void QG_LibraryWidget::buildTree() {
     dirModel = std::make_unique<QStandardItemModel>();
+    itemsWithoutIcon.clear();
     iconModel = std::make_unique<QStandardItemModel>();
     scanTree();
     dirView->setModel(dirModel.get());
@@ -275,11 +258,12 @@ void QG_LibraryWidget::updatePreview(QModelIndex idx) {
     if (item == nullptr)
         return;
 
-    QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
-
     // dir from the point of view of the library browser (e.g. /mechanical/screws)
     QString directory = getItemDir(item); //RLZ change to do-while
     iconModel->clear();
+    // thumbnails of the previous directory aren't needed anymore
+    itemsWithoutIcon.clear();
+    thumbnails->cancelPending();
 
     // List of all directories that contain part libraries:
     QStringList directoryList = RS_SYSTEM->getDirectoryList("library");
@@ -308,8 +292,9 @@ void QG_LibraryWidget::updatePreview(QModelIndex idx) {
         QIcon icon = getIcon(directory, QFileInfo(itemPathList.at(i)).fileName(), itemPathList.at(i));
         auto newItem = new QStandardItem(icon, label);
         iconModel->setItem(i, newItem);
+        if (icon.isNull())
+            itemsWithoutIcon.insert(itemPathList.at(i), newItem);
     }
-    QApplication::restoreOverrideCursor();
 }
 
  //RLZ change to do-while
@@ -369,35 +354,33 @@ QIcon QG_LibraryWidget::getIcon(const QString& dir, const QString& dxfFile,
     QFileInfo fiPng(pngFile);
 
     // found existing thumbnail:
-    if (fiPng.isFile()) {
+    if (!pngFile.isEmpty() && fiPng.isFile()) {
         return QIcon(pngFile);
     }
-    // default thumbnail:
+    // no thumbnail yet, it's being rendered:
     else {
-        return QIcon(QPixmap(64,64));
+        return {};
     }
 }
 
 
 
 /**
- * @return Path to the thumbnail of the given DXF file. If no thumbnail exists, one is
- * created in the user's home. If no thumbnail can be created, an empty string is returned.
+ * @return Path to the thumbnail of the given DXF file. Thumbnails provided by the part
+ * libraries are used if they're newer than the DXF file, otherwise the thumbnail cached
+ * by the thumbnail service. If it isn't rendered yet, an empty string is returned, and
+ * the icon is updated by slotThumbnailReady().
  */
 QString QG_LibraryWidget::getPathToPixmap(const QString& dir,
         const QString& dxfFile,
         const QString& dxfPath) {
 
-    // the thumbnail must be created in the user's home.
-    QString iconCacheLocation=QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + "iconCache" + QDir::separator();
-
     RS_DEBUG->print("QG_LibraryWidget::getPathToPixmap: "
                     "dir: '%s' dxfFile: '%s' dxfPath: '%s'",
                     dir.toLatin1().data(), dxfFile.toLatin1().data(), dxfPath.toLatin1().data());
 
     // List of all directories that contain part libraries:
     QStringList directoryList = RS_SYSTEM->getDirectoryList("library");
-    directoryList.prepend(iconCacheLocation);
 
     QFileInfo fiDxf(dxfPath);
 
@@ -425,43 +408,14 @@ QString QG_LibraryWidget::getPathToPixmap(const QString& dir,
         }
     }
 
-    // create all directories needed:
-    RS_SYSTEM->createPaths(iconCacheLocation + dir);
-
-    QString pngPath = iconCacheLocation + dir + QDir::separator() + fiDxf.baseName() + ".png";
-
-    QPixmap buffer(128,128);
-    RS_PainterQt painter(&buffer);
-    painter.setBackground(RS_Color(255,255,255));
-    painter.eraseRect(0,0, 128,128);
-
-    RS_StaticGraphicView gv(128,128, &painter);
-    RS_Graphic graphic;
-    if (graphic.open(dxfPath, RS2::FormatUnknown)) {
-        gv.setContainer(&graphic);
-        gv.zoomAuto(false);
-        // gv.drawEntity(&graphic, true);
-
-        for (RS_Entity* e=graphic.firstEntity(RS2::ResolveAll);
-                e; e=graphic.nextEntity(RS2::ResolveAll)) {
-            if (e->rtti() != RS2::EntityHatch){
-                RS_Pen pen = e->getPen();
-                pen.setColor(Qt::black);
-                e->setPen(pen);
-            }
-            gv.drawEntity(&painter, e);
-        }
-
-        // Write to PNG
-        writePng(pngPath, std::move(buffer));
-    } else {
-        RS_DEBUG->print(RS_Debug::D_ERROR,
-                        "QG_LibraryWidget::getPathToPixmap: Cannot open file: '%s'",
-                        dxfPath.toLatin1().data());
-    }
-
-    // GraphicView deletes painter
-    painter.end();
+    return thumbnails->thumbnail(dxfPath);
+}
 
-    return pngPath;
+/**
+ * Sets the icon of the item of a DXF file, once its thumbnail is rendered.
+ */
+void QG_LibraryWidget::slotThumbnailReady(const QString& dxfPath, const QString& pngPath) {
+    QStandardItem* item = itemsWithoutIcon.take(dxfPath);
+    if (item != nullptr)
+        item->setIcon(QIcon(pngPath));
 }
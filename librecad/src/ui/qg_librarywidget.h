@@ -28,9 +28,11 @@
 
 #include <memory>
 
+#include <QHash>
 #include <QWidget>
 #include <QModelIndex>
 
+class LC_ThumbnailService;
 class QG_ActionHandler;
 class QListView;
 class QModelIndex;
@@ -71,6 +73,7 @@ public slots:
     virtual void updatePreview( QModelIndex idx );
     virtual void expandView( QModelIndex idx );
     virtual void collapseView( QModelIndex idx );
+    void slotThumbnailReady(const QString& dxfPath, const QString& pngPath);
 
 signals:
     void escape();
@@ -83,6 +86,9 @@ private:
     QListView *ivPreview = nullptr;
     QPushButton *bRefresh = nullptr;
     QPushButton *bRebuild = nullptr;
+    LC_ThumbnailService* thumbnails = nullptr;
+    // items of the icon view waiting for their thumbnail, by dxf path
+    QHash<QString, QStandardItem*> itemsWithoutIcon;
 };
 
 #endif // QG_LIBRARYWIDGET_H
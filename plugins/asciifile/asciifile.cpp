@@ -11,6 +11,7 @@
 /*****************************************************************************/
 
 #include <cmath>
+#include <vector>
 
 #include <QtPlugin>
 #include <QPicture>
@@ -374,6 +375,7 @@ void dibPunto::procesFile(Document_Interface *doc)
     infile.close ();
     QString currlay = currDoc->getCurrentLayer();
 
+    currDoc->beginBatch();
     if (pt2d->checkOn() == true)
         draw2D();
     if (pt3d->checkOn() == true)
@@ -389,6 +391,7 @@ void dibPunto::procesFile(Document_Interface *doc)
     /* draw lines in current layer */
     if ( connectPoints->isChecked() )
         drawLine();
+    currDoc->commitBatch();
 
     currDoc = nullptr;
 
@@ -420,16 +423,15 @@ void dibPunto::drawLine()
 
 void dibPunto::draw2D()
 {
-    QPointF pt;
+    std::vector<QPointF> points;
+    points.reserve(dataList.size());
     currDoc->setLayer(pt2d->getLayer());
     for (int i = 0; i < dataList.size(); ++i) {
         PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            pt.setX(pd->x.toDouble());
-            pt.setY(pd->y.toDouble());
-            currDoc->addPoint(&pt);
-        }
+        if (!pd->x.isEmpty() && !pd->y.isEmpty())
+            points.emplace_back(pd->x.toDouble(), pd->y.toDouble());
     }
+    currDoc->addPoints(points);
 }
 void dibPunto::draw3D()
 {
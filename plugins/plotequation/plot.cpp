@@ -5,6 +5,12 @@
 
 
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
 #include "document_interface.h"
 #include "plot.h"
 #include "plotdialog.h"
@@ -20,6 +26,156 @@ mu::string_type toMUPString(const QString &str)
 #endif
 }
 
+namespace {
+
+// samples evaluated by a thread at least
+constexpr size_t minSamplesPerThread = 16384;
+// passes of adaptive sampling, each halves the intervals where the curve bends
+constexpr int maxRefinements = 8;
+// the tolerance of adaptive sampling, relative to the size of the plot
+constexpr double refinementTolerance = 1e-4;
+
+void setupParser(mu::Parser& p, const QString& expression, double* variable)
+{
+    p.DefineConst(_T("pi"),M_PI);
+    p.DefineConst(_T("e"),M_E);
+    p.DefineVar(_T("x"), variable);
+    p.DefineVar(_T("t"), variable);
+    p.SetExpr(toMUPString(expression));
+}
+
+/**
+ * Evaluates an expression for all values of its variable, in muParser's bulk mode: the
+ * expression is compiled once, and the variables are taken from the value array by the index
+ * of the evaluated result. Large arrays are split across threads, each with its own parser.
+ */
+std::vector<double> evaluate(const QString& expression, std::vector<double>& values)
+{
+    std::vector<double> results(values.size());
+    if (values.empty())
+        return results;
+    const size_t threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                            values.size() / minSamplesPerThread + 1);
+    if (threads == 1) {
+        mu::Parser p;
+        setupParser(p, expression, values.data());
+        p.Eval(results.data(), int(values.size()));
+        return results;
+    }
+
+    // parser errors are reported by the calling thread, before the workers start
+    {
+        mu::Parser p;
+        setupParser(p, expression, values.data());
+        p.Eval();
+    }
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> workers;
+    const size_t chunk = (values.size() + threads - 1) / threads;
+    for (size_t begin = 0; begin < values.size(); begin += chunk) {
+        const size_t count = std::min(chunk, values.size() - begin);
+        workers.emplace_back([&expression, &values, &results, &failed, begin, count] {
+            try {
+                mu::Parser p;
+                setupParser(p, expression, values.data() + begin);
+                p.Eval(results.data() + begin, int(count));
+            } catch (mu::Parser::exception_type&) {
+                failed = true;
+            }
+        });
+    }
+    for (std::thread& worker: workers)
+        worker.join();
+    if (failed)
+        throw mu::Parser::exception_type(_T("bulk evaluation failed"));
+    return results;
+}
+
+/**
+ * The points of the plot for the parameter values: (t, equation1(t)), or
+ * (equation1(t), equation2(t)) in the parametric form.
+ */
+void evaluatePoints(const QString& equation1, const QString& equation2, std::vector<double>& t,
+                    std::vector<double>& xs, std::vector<double>& ys)
+{
+    if (equation2.isEmpty()) {
+        xs = t;
+        ys = evaluate(equation1, t);
+    } else {
+        xs = evaluate(equation1, t);
+        ys = evaluate(equation2, t);
+    }
+}
+
+double distanceToChord(double x, double y, double x0, double y0, double x1, double y1)
+{
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+    const double length = std::hypot(dx, dy);
+    if (length < 1e-300)
+        return std::hypot(x - x0, y - y0);
+    return std::abs((x - x0) * dy - (y - y0) * dx) / length;
+}
+
+/**
+ * Adaptive sampling: intervals are halved where the midpoint of the curve is off the chord by
+ * more than the tolerance, i.e. where the curve bends. Only the new midpoints are evaluated,
+ * in bulk, for each pass.
+ */
+void refine(const QString& equation1, const QString& equation2, std::vector<double>& t,
+            std::vector<double>& xs, std::vector<double>& ys)
+{
+    if (t.size() < 2)
+        return;
+    const auto [minX, maxX] = std::minmax_element(xs.cbegin(), xs.cend());
+    const auto [minY, maxY] = std::minmax_element(ys.cbegin(), ys.cend());
+    const double size = std::hypot(*maxX - *minX, *maxY - *minY);
+    if (!std::isfinite(size) || size <= 0.)
+        return;
+    const double tolerance = size * refinementTolerance;
+
+    // intervals which may need refining, by the index of their first point
+    std::vector<size_t> pending(t.size() - 1);
+    for (size_t i = 0; i < pending.size(); ++i)
+        pending[i] = i;
+    for (int pass = 0; pass < maxRefinements && !pending.empty(); ++pass) {
+        std::vector<double> midT(pending.size());
+        for (size_t i = 0; i < pending.size(); ++i)
+            midT[i] = 0.5 * (t[pending[i]] + t[pending[i] + 1]);
+        std::vector<double> midX, midY;
+        evaluatePoints(equation1, equation2, midT, midX, midY);
+
+        std::vector<double> newT, newX, newY;
+        newT.reserve(t.size() + pending.size());
+        newX.reserve(t.size() + pending.size());
+        newY.reserve(t.size() + pending.size());
+        std::vector<size_t> nextPending;
+        size_t next = 0;
+        for (size_t i = 0; i < t.size(); ++i) {
+            newT.push_back(t[i]);
+            newX.push_back(xs[i]);
+            newY.push_back(ys[i]);
+            if (next == pending.size() || pending[next] != i)
+                continue;
+            const double deviation = distanceToChord(midX[next], midY[next], xs[i], ys[i], xs[i + 1], ys[i + 1]);
+            // not finite: a singularity, which refining doesn't resolve
+            if (std::isfinite(deviation) && deviation > tolerance) {
+                nextPending.push_back(newT.size() - 1);
+                nextPending.push_back(newT.size());
+                newT.push_back(midT[next]);
+                newX.push_back(midX[next]);
+                newY.push_back(midY[next]);
+            }
+            ++next;
+        }
+        t = std::move(newT);
+        xs = std::move(newX);
+        ys = std::move(newY);
+        pending = std::move(nextPending);
+    }
+}
+}
+
 plot::plot(QObject *parent) :
     QObject(parent)
 {
@@ -49,9 +205,9 @@ void plot::execComm(Document_Interface *doc, QWidget *parent, QString cmd)
     QString endValue;
     double stepSize;
 
-    QList<double> xValues;
-    QList<double> yValues1;
-    QList<double> yValues2;
+    std::vector<double> tValues;
+    std::vector<double> xpoints;
+    std::vector<double> ypoints;
     plotDialog::EntityType lineType=plotDialog::Polyline;
 
     plotDialog plotDlg(parent);
@@ -66,45 +222,39 @@ void plot::execComm(Document_Interface *doc, QWidget *parent, QString cmd)
 
         try{
             mu::Parser p;
-            p.DefineConst(_T("pi"),M_PI);
-            p.DefineConst(_T("e"),M_E);
-            p.DefineVar(_T("x"), &equationVariable);
-            p.DefineVar(_T("t"), &equationVariable);
-            p.SetExpr(toMUPString(startValue));
+            setupParser(p, startValue, &equationVariable);
             startVal = p.Eval();
 
             p.SetExpr(toMUPString(endValue));
             endVal = p.Eval();
 
-            p.SetExpr(toMUPString(equation1));
-
-            for(equationVariable = startVal; equationVariable <= endVal; equationVariable += stepSize)
-            {//calculate the values of the first equation
-                xValues.append(equationVariable);
-                yValues1.append(p.Eval());
+            // the samples are computed from their index, adding up the steps accumulates errors
+            if (stepSize > 0.0 && endVal >= startVal) {
+                const size_t count = size_t(std::floor((endVal - startVal) / stepSize * (1.0 + 1e-12))) + 1;
+                tValues.resize(count);
+                for (size_t i = 0; i < count; ++i)
+                    tValues[i] = startVal + stepSize * double(i);
             }
 
-            if(!equation2.isEmpty())
-            {//calculate the values of the second equation
-                p.SetExpr(toMUPString(equation2));
-                for(int i = 0; i < xValues.size(); ++i)
-                {
-                    equationVariable = xValues.at(i);
-                    yValues2.append(p.Eval());
-                }
-            }
+            evaluatePoints(equation1, equation2, tValues, xpoints, ypoints);
+            if (plotDlg.isAdaptive())
+                refine(equation1, equation2, tValues, xpoints, ypoints);
         }
         catch (mu::Parser::exception_type &e)
         {
             mu::console() << e.GetMsg() << std::endl;
+            // nothing is plotted, if evaluating an equation failed
+            return;
         }
+        if (xpoints.size() < 2)
+            return;
 
-        QList<double> const& xpoints=(equation2.isEmpty())?xValues:yValues1;
-        QList<double> const& ypoints=(equation2.isEmpty())?yValues1:yValues2;
-
+        // the plot is added as a whole, in one undo cycle
+        doc->beginBatch();
         if (lineType == plotDialog::LineSegments || lineType == plotDialog::SplinePoints){
             std::vector<QPointF> points;
-            for(int i=0; i< xpoints.size(); ++i){
+            points.reserve(xpoints.size());
+            for(size_t i=0; i< xpoints.size(); ++i){
                 points.emplace_back(QPointF(xpoints[i], ypoints[i]));
             }
             if (lineType == plotDialog::SplinePoints){
@@ -115,12 +265,13 @@ void plot::execComm(Document_Interface *doc, QWidget *parent, QString cmd)
                 doc->addLines(points, false);
         } else { //default plotDialog::Polyline
             std::vector<Plug_VertexData> points;
-            for(int i=0; i< xpoints.size(); ++i){
+            points.reserve(xpoints.size());
+            for(size_t i=0; i< xpoints.size(); ++i){
                 points.emplace_back(Plug_VertexData(QPointF(xpoints[i], ypoints[i]), 0.0));
             }
             doc->addPolyline(points, false);
         }
-
+        doc->commitBatch();
     }
 
 }
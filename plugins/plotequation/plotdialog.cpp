@@ -5,6 +5,7 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QDebug>
 
 Q_DECLARE_METATYPE(plotDialog::EntityType)
@@ -63,6 +64,11 @@ plotDialog::plotDialog(QWidget *parent) :
 
     mainLayout->addWidget(m_pTypeSelection, 7, 0);
 
+    m_pAdaptive = new QCheckBox(tr("Adaptive sampling"), this);
+    m_pAdaptive->setToolTip(tr("Refine the steps where the curve bends"));
+    m_pAdaptive->setChecked(true);
+    mainLayout->addWidget(m_pAdaptive, 7, 1);
+
     buttonLayout->addWidget(btnAccept);
     buttonLayout->addWidget(btnCancel);
 
@@ -81,6 +87,11 @@ plotDialog::EntityType plotDialog::getEntityType() const
     return m_pTypeSelection->itemData(m_pTypeSelection->currentIndex()).value<plotDialog::EntityType>();
 }
 
+bool plotDialog::isAdaptive() const
+{
+    return m_pAdaptive->isChecked();
+}
+
 //get the valuew that the user entered
 void plotDialog::getValues(QString& eq1, QString& eq2, QString& start, QString& end, double& step) const
 {
@@ -0,0 +1,38 @@
+#-------------------------------------------------
+#
+# dxfgen: synthetic DXF drawings for benchmarks
+#
+#-------------------------------------------------
+
+include(../../common.pri)
+include(../../libraries/libdxfrw/compression.pri)
+
+QT -= core gui svg
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+GENERATED_DIR = ../../generated/tools/dxfgen
+SOURCES += main.cpp
+
+INCLUDEPATH += ../../libraries/libdxfrw/src
+GEN_LIB_DIR = ../../generated/lib
+LIBS += -L$$GEN_LIB_DIR -ldxfrw
+msvc {
+	PRE_TARGETDEPS += $$GEN_LIB_DIR/dxfrw.lib
+} else {
+	PRE_TARGETDEPS += $$GEN_LIB_DIR/libdxfrw.a
+}
+
+unix {
+    macx {
+        TARGET = ../../LibreCAD.app/Contents/MacOS/dxfgen
+    } else {
+        TARGET = ../../unix/dxfgen
+    }
+}
+
+win32 {
+    TARGET = ../../../windows/dxfgen
+}
@@ -0,0 +1,555 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** dxfgen: generates large synthetic DXF drawings, to measure and to
+** reproduce performance problems without real drawings.
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+**********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libdxfrw.h"
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+// hatch patterns of the LibreCAD pattern library
+const char* const patterns[] = {"ANSI31", "ANSI37", "BRICK", "CROSS", "HEX", "HONEYCOMB"};
+
+struct Options {
+    unsigned lines = 0;
+    unsigned arcs = 0;
+    unsigned circles = 0;
+    unsigned polylines = 0;
+    unsigned hatches = 0;
+    unsigned inserts = 0;
+    unsigned dimensions = 0;
+    unsigned texts = 0;
+    unsigned layers = 16;
+    // levels of nested blocks, and blocks per level
+    unsigned depth = 3;
+    unsigned blocks = 8;
+    // the size of the drawing; entities are about extent / sqrt(count) long
+    double extent = 0.;
+    bool uniform = false;
+    unsigned seed = 1;
+    DRW::Version version = DRW::AC1015;
+};
+
+/**
+ * Writes the entities of the options while libdxfrw writes the file, so
+ * drawings of millions of entities are not held in memory. The entities only
+ * depend on the options, using the same seed gives the same drawing.
+ *
+ * Entities are placed around cluster centers, like the details of a plan, or
+ * uniformly with -u. Their sizes are log-normal: many small entities, with
+ * some large ones. A few layers hold most of the entities.
+ */
+class DxfGenerator : public DRW_Interface {
+public:
+    DxfGenerator(const Options& options, dxfRW& writer)
+        : options(options)
+        , writer(writer)
+        , generator(options.seed)
+    {
+        const unsigned total = options.lines + options.arcs + options.circles + options.polylines
+                + options.hatches + options.inserts + options.dimensions + options.texts;
+        extent = options.extent > 0. ? options.extent : 10. * std::sqrt(double(std::max(total, 1u)));
+        size = extent / std::sqrt(double(std::max(total, 1u)));
+        std::uniform_real_distribution<double> unit{0., extent};
+        const unsigned clusterCount = std::max(1u, total / 2000);
+        for (unsigned i = 0; i < clusterCount; ++i)
+            clusters.push_back({unit(generator), unit(generator)});
+        spread = extent / (2. * std::sqrt(double(clusterCount)));
+    }
+
+    void writeHeader(DRW_Header& data) override {
+        data.addCoord("$EXTMIN", DRW_Coord(0., 0., 0.), 10);
+        data.addCoord("$EXTMAX", DRW_Coord(extent, extent, 0.), 10);
+        data.addInt("$INSUNITS", 4, 70);
+    }
+
+    void writeLayers() override {
+        DRW_Layer layer;
+        for (unsigned i = 0; i < options.layers; ++i) {
+            layer.reset();
+            layer.name = layerName(i);
+            layer.color = 1 + i % 255;
+            writer.writeLayer(&layer);
+        }
+    }
+
+    void writeBlockRecords() override {
+        for (unsigned level = 0; level < levels(); ++level)
+            for (unsigned i = 0; i < options.blocks; ++i)
+                writer.writeBlockRecord(blockName(level, i));
+    }
+
+    /**
+     * Blocks of level 0 hold primitives in a unit square, the blocks of the
+     * other levels four inserts of the level below and a frame.
+     */
+    void writeBlocks() override {
+        std::uniform_real_distribution<double> unit{0., 1.};
+        for (unsigned level = 0; level < levels(); ++level) {
+            for (unsigned i = 0; i < options.blocks; ++i) {
+                DRW_Block block;
+                block.name = blockName(level, i);
+                block.basePoint = DRW_Coord(0., 0., 0.);
+                writer.writeBlock(&block);
+                if (level == 0) {
+                    for (int j = 0; j < 16; ++j)
+                        writeLine({unit(generator), unit(generator)}, {unit(generator), unit(generator)}, "0");
+                    writeCircle({0.5, 0.5}, 0.1 + 0.3 * unit(generator), "0");
+                    writeArc({0.5, 0.5}, 0.45, 0., pi * (1. + unit(generator)), "0");
+                } else {
+                    writeRectangle({0., 0.}, {1., 1.}, "0");
+                    for (int j = 0; j < 4; ++j) {
+                        DRW_Insert insert;
+                        insert.layer = "0";
+                        insert.name = blockName(level - 1, pick(options.blocks));
+                        insert.basePoint = DRW_Coord(0.05 + 0.5 * (j % 2), 0.05 + 0.5 * (j / 2), 0.);
+                        insert.xscale = insert.yscale = insert.zscale = 0.4;
+                        insert.angle = 0.;
+                        writer.writeInsert(&insert);
+                    }
+                }
+            }
+        }
+    }
+
+    void writeEntities() override {
+        std::uniform_real_distribution<double> unit{0., 1.};
+        for (unsigned i = 0; i < options.lines; ++i) {
+            const DRW_Coord p = position();
+            const double angle = angleOf();
+            const double length = sizeOf();
+            writeLine(p, {p.x + length * std::cos(angle), p.y + length * std::sin(angle)}, layer());
+        }
+        for (unsigned i = 0; i < options.arcs; ++i) {
+            const double start = 2. * pi * unit(generator);
+            writeArc(position(), 0.5 * sizeOf(), start, start + pi * (0.1 + 1.5 * unit(generator)), layer());
+        }
+        for (unsigned i = 0; i < options.circles; ++i)
+            writeCircle(position(), 0.5 * sizeOf(), layer());
+        for (unsigned i = 0; i < options.polylines; ++i)
+            writePolyline();
+        for (unsigned i = 0; i < options.hatches; ++i)
+            writeHatch();
+        for (unsigned i = 0; i < options.inserts && levels() > 0; ++i) {
+            DRW_Insert insert;
+            insert.layer = layer();
+            insert.name = blockName(levels() - 1, pick(options.blocks));
+            insert.basePoint = position();
+            insert.xscale = insert.yscale = insert.zscale = 2. * sizeOf();
+            insert.angle = angleOf();
+            writer.writeInsert(&insert);
+        }
+        for (unsigned i = 0; i < options.dimensions; ++i)
+            writeDimension(i % 2 == 0);
+        for (unsigned i = 0; i < options.texts; ++i) {
+            DRW_Text text;
+            text.layer = layer();
+            text.basePoint = position();
+            text.secPoint = text.basePoint;
+            text.height = 0.1 * sizeOf() + 0.01 * size;
+            text.text = "Text " + std::to_string(i);
+            text.style = "Standard";
+            text.angle = unit(generator) < 0.8 ? 0. : 90.;
+            writer.writeText(&text);
+        }
+    }
+
+    // libdxfrw writes the default line types and text style
+    void writeLTypes() override {}
+    void writeTextstyles() override {}
+    void writeVports() override {
+        DRW_Vport vport;
+        vport.name = "*Active";
+        vport.center = DRW_Coord(0.5 * extent, 0.5 * extent, 0.);
+        vport.height = extent;
+        vport.ratio = 1.;
+        writer.writeVport(&vport);
+    }
+    void writeDimstyles() override {
+        DRW_Dimstyle style;
+        style.name = "Standard";
+        style.dimasz = style.dimtxt = 0.1 * size;
+        style.dimexe = style.dimexo = style.dimgap = 0.05 * size;
+        writer.writeDimstyle(&style);
+    }
+    void writeObjects() override {}
+    void writeAppId() override {}
+
+    // nothing is read
+    void addHeader(const DRW_Header*) override {}
+    void addLType(const DRW_LType&) override {}
+    void addLayer(const DRW_Layer&) override {}
+    void addDimStyle(const DRW_Dimstyle&) override {}
+    void addVport(const DRW_Vport&) override {}
+    void addTextStyle(const DRW_Textstyle&) override {}
+    void addAppId(const DRW_AppId&) override {}
+    void addBlock(const DRW_Block&) override {}
+    void setBlock(const int) override {}
+    void endBlock() override {}
+    void addPoint(const DRW_Point&) override {}
+    void addLine(const DRW_Line&) override {}
+    void addRay(const DRW_Ray&) override {}
+    void addXline(const DRW_Xline&) override {}
+    void addArc(const DRW_Arc&) override {}
+    void addCircle(const DRW_Circle&) override {}
+    void addEllipse(const DRW_Ellipse&) override {}
+    void addLWPolyline(const DRW_LWPolyline&) override {}
+    void addPolyline(const DRW_Polyline&) override {}
+    void addSpline(const DRW_Spline*) override {}
+    void addKnot(const DRW_Entity&) override {}
+    void addInsert(const DRW_Insert&) override {}
+    void addTrace(const DRW_Trace&) override {}
+    void add3dFace(const DRW_3Dface&) override {}
+    void addSolid(const DRW_Solid&) override {}
+    void addMText(const DRW_MText&) override {}
+    void addText(const DRW_Text&) override {}
+    void addDimAlign(const DRW_DimAligned*) override {}
+    void addDimLinear(const DRW_DimLinear*) override {}
+    void addDimRadial(const DRW_DimRadial*) override {}
+    void addDimDiametric(const DRW_DimDiametric*) override {}
+    void addDimAngular(const DRW_DimAngular*) override {}
+    void addDimAngular3P(const DRW_DimAngular3p*) override {}
+    void addDimOrdinate(const DRW_DimOrdinate*) override {}
+    void addLeader(const DRW_Leader*) override {}
+    void addHatch(const DRW_Hatch*) override {}
+    void addViewport(const DRW_Viewport&) override {}
+    void addImage(const DRW_Image*) override {}
+    void linkImage(const DRW_ImageDef*) override {}
+    void addComment(const char*) override {}
+    void addPlotSettings(const DRW_PlotSettings*) override {}
+
+private:
+    unsigned levels() const {
+        return options.inserts > 0 ? options.depth : 0;
+    }
+
+    static std::string layerName(unsigned i) {
+        char name[16];
+        std::snprintf(name, sizeof(name), "layer_%03u", i);
+        return name;
+    }
+
+    static std::string blockName(unsigned level, unsigned i) {
+        return "block_" + std::to_string(level) + "_" + std::to_string(i);
+    }
+
+    unsigned pick(unsigned count) {
+        return std::uniform_int_distribution<unsigned>{0, count - 1}(generator);
+    }
+
+    // most entities are on the first layers
+    std::string layer() {
+        if (options.layers == 0)
+            return "0";
+        const double u = std::uniform_real_distribution<double>{0., 1.}(generator);
+        return layerName(std::min(options.layers - 1, unsigned(options.layers * u * u * u)));
+    }
+
+    DRW_Coord position() {
+        if (options.uniform) {
+            std::uniform_real_distribution<double> unit{0., extent};
+            return DRW_Coord(unit(generator), unit(generator), 0.);
+        }
+        const DRW_Coord& center = clusters[pick(unsigned(clusters.size()))];
+        std::normal_distribution<double> offset{0., spread};
+        return DRW_Coord(std::clamp(center.x + offset(generator), 0., extent),
+                         std::clamp(center.y + offset(generator), 0., extent), 0.);
+    }
+
+    double sizeOf() {
+        return size * std::lognormal_distribution<double>{0., 0.8}(generator);
+    }
+
+    // mostly axis aligned, as in drawings of buildings and parts
+    double angleOf() {
+        std::uniform_real_distribution<double> unit{0., 1.};
+        if (unit(generator) < 0.7)
+            return 0.5 * pi * pick(4);
+        return 2. * pi * unit(generator);
+    }
+
+    void writeLine(const DRW_Coord& p1, const DRW_Coord& p2, const std::string& layer) {
+        DRW_Line line;
+        line.layer = layer;
+        line.basePoint = p1;
+        line.secPoint = p2;
+        writer.writeLine(&line);
+    }
+
+    void writeArc(const DRW_Coord& center, double radius, double a1, double a2, const std::string& layer) {
+        DRW_Arc arc;
+        arc.layer = layer;
+        arc.basePoint = center;
+        arc.radious = radius;
+        arc.staangle = a1;
+        arc.endangle = a2;
+        writer.writeArc(&arc);
+    }
+
+    void writeCircle(const DRW_Coord& center, double radius, const std::string& layer) {
+        DRW_Circle circle;
+        circle.layer = layer;
+        circle.basePoint = center;
+        circle.radious = radius;
+        writer.writeCircle(&circle);
+    }
+
+    void writeRectangle(const DRW_Coord& p1, const DRW_Coord& p2, const std::string& layer) {
+        DRW_LWPolyline polyline;
+        polyline.layer = layer;
+        polyline.flags = 1;
+        polyline.addVertex(DRW_Vertex2D(p1.x, p1.y, 0.));
+        polyline.addVertex(DRW_Vertex2D(p2.x, p1.y, 0.));
+        polyline.addVertex(DRW_Vertex2D(p2.x, p2.y, 0.));
+        polyline.addVertex(DRW_Vertex2D(p1.x, p2.y, 0.));
+        writer.writeLWPolyline(&polyline);
+    }
+
+    // a walk of 3 to 40 segments turning by right angles, some of them arcs
+    void writePolyline() {
+        std::uniform_real_distribution<double> unit{0., 1.};
+        DRW_LWPolyline polyline;
+        polyline.layer = layer();
+        DRW_Coord p = position();
+        double angle = angleOf();
+        const int vertices = 4 + int(pick(38));
+        for (int i = 0; i < vertices; ++i) {
+            polyline.addVertex(DRW_Vertex2D(p.x, p.y, unit(generator) < 0.1 ? 0.4 : 0.));
+            const double length = sizeOf();
+            p.x += length * std::cos(angle);
+            p.y += length * std::sin(angle);
+            angle += unit(generator) < 0.5 ? 0.5 * pi : -0.5 * pi;
+        }
+        polyline.flags = unit(generator) < 0.3 ? 1 : 0;
+        writer.writeLWPolyline(&polyline);
+    }
+
+    // rectangles and regular polygons, solid or by pattern
+    void writeHatch() {
+        std::uniform_real_distribution<double> unit{0., 1.};
+        DRW_Hatch hatch;
+        hatch.layer = layer();
+        hatch.solid = unit(generator) < 0.2 ? 1 : 0;
+        hatch.name = hatch.solid ? "SOLID" : patterns[pick(sizeof(patterns) / sizeof(patterns[0]))];
+        hatch.scale = 0.05 * size * (1. + unit(generator));
+        hatch.angle = 0.;
+        hatch.loopsnum = 1;
+
+        auto loop = std::make_shared<DRW_HatchLoop>(0);
+        const DRW_Coord center = position();
+        const double radius = sizeOf();
+        const int sides = unit(generator) < 0.5 ? 4 : 3 + int(pick(6));
+        const double start = angleOf();
+        for (int i = 0; i < sides; ++i) {
+            const double a1 = start + 2. * pi * i / sides;
+            const double a2 = start + 2. * pi * (i + 1) / sides;
+            auto edge = std::make_shared<DRW_Line>();
+            edge->basePoint = DRW_Coord(center.x + radius * std::cos(a1), center.y + radius * std::sin(a1), 0.);
+            edge->secPoint = DRW_Coord(center.x + radius * std::cos(a2), center.y + radius * std::sin(a2), 0.);
+            loop->objlist.push_back(edge);
+        }
+        loop->update();
+        hatch.appendLoop(loop);
+        writer.writeHatch(&hatch);
+    }
+
+    void writeDimension(bool aligned) {
+        const DRW_Coord p1 = position();
+        const double angle = angleOf();
+        const double length = sizeOf();
+        const DRW_Coord p2{p1.x + length * std::cos(angle), p1.y + length * std::sin(angle), 0.};
+        // the dimension line at a distance from the measured points
+        const double distance = 0.3 * length;
+        const DRW_Coord line{p2.x - distance * std::sin(angle), p2.y + distance * std::cos(angle), 0.};
+
+        std::unique_ptr<DRW_DimAligned> dimension;
+        if (aligned) {
+            dimension = std::make_unique<DRW_DimAligned>();
+            dimension->type = 1 + 32;
+        } else {
+            auto linear = std::make_unique<DRW_DimLinear>();
+            linear->type = 0 + 32;
+            linear->setAngle(angle * 180. / pi);
+            linear->setOblique(0.);
+            dimension = std::move(linear);
+        }
+        dimension->layer = layer();
+        dimension->setDef1Point(p1);
+        dimension->setDef2Point(p2);
+        dimension->setDefPoint(line);
+        dimension->setTextPoint(DRW_Coord(0.5 * (p1.x + p2.x) - distance * std::sin(angle),
+                                          0.5 * (p1.y + p2.y) + distance * std::cos(angle), 0.));
+        dimension->setStyle("Standard");
+        dimension->setAlign(5);
+        dimension->setTextLineStyle(1);
+        dimension->setTextLineFactor(1.);
+        writer.writeDimension(dimension.get());
+    }
+
+    const Options& options;
+    dxfRW& writer;
+    std::mt19937 generator;
+    double extent = 0.;
+    // the median size of entities
+    double size = 1.;
+    std::vector<DRW_Coord> clusters;
+    double spread = 0.;
+};
+
+void usage(int eval) {
+    std::cout << "Usage: dxfgen <options> <dxf file>\n";
+    std::cout << "  dxf file: The DXF file to create\n";
+    std::cout << "options are:\n";
+    std::cout << "  -n count                 Total number of entities, split as by a typical drawing,\n";
+    std::cout << "                           the options of entity types below set their numbers instead\n";
+    std::cout << "  --lines count            Number of lines\n";
+    std::cout << "  --arcs count             Number of arcs\n";
+    std::cout << "  --circles count          Number of circles\n";
+    std::cout << "  --polylines count        Number of polylines\n";
+    std::cout << "  --hatches count          Number of hatches\n";
+    std::cout << "  --inserts count          Number of inserts of nested blocks\n";
+    std::cout << "  --dimensions count       Number of linear and aligned dimensions\n";
+    std::cout << "  --texts count            Number of texts\n";
+    std::cout << "  --layers count           Number of layers, default 16\n";
+    std::cout << "  --depth levels           Levels of nested blocks, default 3\n";
+    std::cout << "  --blocks count           Blocks per level, default 8\n";
+    std::cout << "  -e extent                Size of the drawing, by default growing with the entities\n";
+    std::cout << "  -u                       Place entities uniformly instead of in clusters\n";
+    std::cout << "  -s seed                  Seed of the random numbers, default 1\n";
+    std::cout << "  -v version               DXF version: R12, R2000, R2004, R2007, R2010 (default R2000)\n";
+    std::exit(eval);
+}
+
+unsigned toCount(const char* arg) {
+    return unsigned(std::strtoul(arg, nullptr, 10));
+}
+}
+
+
+/**
+ * Main.
+ */
+int main(int argc, char* argv[]) {
+    Options options;
+    long total = -1;
+    struct Count {
+        const char* name;
+        unsigned Options::* count;
+        // share of a typical drawing, in per mille
+        unsigned share;
+        bool set;
+    } counts[] = {
+        {"--lines", &Options::lines, 600, false},
+        {"--arcs", &Options::arcs, 100, false},
+        {"--circles", &Options::circles, 60, false},
+        {"--polylines", &Options::polylines, 100, false},
+        {"--hatches", &Options::hatches, 20, false},
+        {"--inserts", &Options::inserts, 40, false},
+        {"--dimensions", &Options::dimensions, 30, false},
+        {"--texts", &Options::texts, 50, false},
+    };
+
+    int i;
+    for (i = 1; i < argc - 1; ++i) {
+        bool found = false;
+        for (Count& count: counts) {
+            if (!strcmp(argv[i], count.name)) {
+                options.*count.count = toCount(argv[++i]);
+                count.set = found = true;
+            }
+        }
+        if (found)
+            continue;
+        if (!strcmp(argv[i], "-n")) {
+            total = long(toCount(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--layers")) {
+            options.layers = toCount(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--depth")) {
+            options.depth = std::max(1u, toCount(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--blocks")) {
+            options.blocks = std::max(1u, toCount(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "-e")) {
+            options.extent = std::atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-u")) {
+            options.uniform = true;
+        }
+        else if (!strcmp(argv[i], "-s")) {
+            options.seed = toCount(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-v")) {
+            const std::string version = argv[++i];
+            if (version == "R12")
+                options.version = DRW::AC1009;
+            else if (version == "R2000")
+                options.version = DRW::AC1015;
+            else if (version == "R2004")
+                options.version = DRW::AC1018;
+            else if (version == "R2007")
+                options.version = DRW::AC1021;
+            else if (version == "R2010")
+                options.version = DRW::AC1024;
+            else
+                usage(1);
+        }
+        else if (!strcmp(argv[i], "-h")) {
+            usage(0);
+        }
+        else {
+            usage(1);
+        }
+    }
+    if (i != argc - 1)
+        usage(1);
+
+    bool anySet = false;
+    for (const Count& count: counts)
+        anySet = anySet || count.set;
+    if (total < 0 && !anySet)
+        total = 10000;
+    // the types without a count of their own share the total
+    if (total >= 0) {
+        for (const Count& count: counts)
+            if (!count.set)
+                options.*count.count = unsigned(total * count.share / 1000);
+    }
+
+    dxfRW dxf(argv[i]);
+    DxfGenerator generator(options, dxf);
+    if (!dxf.write(&generator, options.version, false)) {
+        std::cerr << "Cannot write " << argv[i] << "\n";
+        return 1;
+    }
+    return 0;
+}